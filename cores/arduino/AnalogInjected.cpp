@@ -0,0 +1,232 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "AnalogInjected.h"
+#include "HardwareTimer.h"
+#include "pwm.h"
+#include "pins_arduino.h"
+
+/*!
+    \brief      AnalogInjected object construct
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+AnalogInjected::AnalogInjected(void)
+{
+    this->count = 0;
+    this->sampleTime = ADC_SAMPLETIME_7POINT5;
+    this->adcPeriph = (uint32_t)NC;
+    this->callback = NULL;
+    this->running = false;
+}
+
+/*!
+    \brief      stop conversions, the ADC interrupt must not call into a destroyed object
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+AnalogInjected::~AnalogInjected(void)
+{
+    end();
+}
+
+/*!
+    \brief      append a pin to the inserted group, all pins have to belong to the same ADC
+    \param[in]  pin: analog pin
+    \param[out] none
+    \retval     false if the group is full or the pin is on another ADC
+*/
+bool AnalogInjected::addPin(uint32_t pin)
+{
+    PinName pinname = DIGITAL_TO_PINNAME(pin);
+    uint32_t periph = pinmap_peripheral(pinname, PinMap_ADC);
+
+    if (this->running || (this->count >= ADC_INSERTED_MAX_CHANNELS) || ((uint32_t)NC == periph)) {
+        return false;
+    }
+    if ((this->count != 0U) && (periph != this->adcPeriph)) {
+        return false;
+    }
+    this->adcPeriph = periph;
+    this->pins[this->count++] = pinname;
+    return true;
+}
+
+/*!
+    \brief      remove all pins from the inserted group
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void AnalogInjected::clearPins(void)
+{
+    end();
+    this->count = 0;
+    this->adcPeriph = (uint32_t)NC;
+}
+
+/*!
+    \brief      get the number of pins in the inserted group
+    \param[in]  none
+    \param[out] none
+    \retval     number of pins
+*/
+uint8_t AnalogInjected::pinCount(void)
+{
+    return this->count;
+}
+
+/*!
+    \brief      set the sample time used for every pin, takes effect with the next begin(). Keep it
+                short so all pins are converted while the switching noise has settled
+    \param[in]  sampleTime: ADC_SAMPLETIME_x
+    \param[out] none
+    \retval     none
+*/
+void AnalogInjected::setSampleTime(uint32_t sampleTime)
+{
+    this->sampleTime = sampleTime;
+}
+
+/*!
+    \brief      ADC callback, hands the results to the user callback
+    \param[in]  arg: the AnalogInjected object
+    \param[in]  values: one result per pin
+    \param[in]  count: number of results
+    \param[out] none
+    \retval     none
+*/
+void AnalogInjected::adcIrq(void *arg, const uint16_t *values, uint8_t count)
+{
+    AnalogInjected *injected = (AnalogInjected *)arg;
+
+    if (injected->callback != NULL) {
+        injected->callback(values, count);
+    }
+}
+
+/*!
+    \brief      start converting the group on every trigger event of a timer
+    \param[in]  timer: TIMERx
+    \param[in]  callback: called from the ADC interrupt once all pins are converted
+    \param[out] none
+    \retval     false if there are no pins, the ADC is scanning or the timer cannot trigger this ADC
+*/
+bool AnalogInjected::start(uint32_t timer, analogInjectedCallback_t callback)
+{
+    if ((this->count == 0U) || (timer == 0U)) {
+        return false;
+    }
+    end();
+    this->callback = callback;
+    this->running = adc_inserted_start(this->pins, this->count, this->sampleTime, timer,
+                                       (callback != NULL) ? adcIrq : NULL, this) != 0;
+    return this->running;
+}
+
+/*!
+    \brief      convert the group on every update of a timer, or on a spare compare channel if the
+                ADC cannot be triggered by its TRGO. The timer keeps its own period and is started
+                by the sketch
+    \param[in]  timer: e.g. TIMER0 for ADC0, see the ADC inserted group trigger table
+    \param[in]  callback: called from the ADC interrupt once all pins are converted
+    \param[out] none
+    \retval     false if there are no pins, the ADC is scanning or the timer cannot trigger this ADC
+*/
+bool AnalogInjected::begin(HardwareTimer &timer, analogInjectedCallback_t callback)
+{
+    return start(timer.getInstance(), callback);
+}
+
+/*!
+    \brief      convert the group on every update of the timer of a pwm group. A center aligned
+                timer updates at the top and at the bottom of the period, use the repetition counter
+                of TIMER0/TIMER7 to sample only once per period
+    \param[in]  group: started pwm group, all its channels share one timer
+    \param[in]  callback: called from the ADC interrupt once all pins are converted
+    \param[out] none
+    \retval     false if there are no pins, the ADC is scanning or the timer cannot trigger this ADC
+*/
+bool AnalogInjected::begin(PWMGroup &group, analogInjectedCallback_t callback)
+{
+    return start(group.getTimer(), callback);
+}
+
+/*!
+    \brief      convert the group on every update of the timer driving a pwm pin
+    \param[in]  pwm: pwm output
+    \param[in]  callback: called from the ADC interrupt once all pins are converted
+    \param[out] none
+    \retval     false if there are no pins, the ADC is scanning or the timer cannot trigger this ADC
+*/
+bool AnalogInjected::begin(PWM &pwm, analogInjectedCallback_t callback)
+{
+    return start(pwm.getTimer(), callback);
+}
+
+/*!
+    \brief      stop converting the group
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void AnalogInjected::end(void)
+{
+    if (!this->running) {
+        return;
+    }
+    adc_inserted_stop(this->adcPeriph);
+    this->callback = NULL;
+    this->running = false;
+}
+
+/*!
+    \brief      check if conversions are running
+    \param[in]  none
+    \param[out] none
+    \retval     true while converting on the timer events
+*/
+bool AnalogInjected::isRunning(void)
+{
+    return this->running;
+}
+
+/*!
+    \brief      get the last result of a pin without waiting for the interrupt
+    \param[in]  rank: index of the pin in the order it was added
+    \param[out] none
+    \retval     conversion result, 0 if not running
+*/
+uint16_t AnalogInjected::read(uint8_t rank)
+{
+    if (!this->running || (rank >= this->count)) {
+        return 0;
+    }
+    return adc_inserted_read(this->adcPeriph, rank);
+}
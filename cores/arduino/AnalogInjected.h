@@ -0,0 +1,73 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef ANALOGINJECTED_H
+#define ANALOGINJECTED_H
+
+#include "analog.h"
+
+class HardwareTimer;
+class PWM;
+class PWMGroup;
+
+/* values holds one result per pin in the order the pins were added */
+typedef void(*analogInjectedCallback_t)(const uint16_t *values, uint8_t count);
+
+/* Converts up to four analog pins as the ADC inserted group on every update (TRGO) or compare
+   event of a timer, e.g. to sample phase currents at a fixed point of the PWM period. The
+   inserted group preempts analogRead() on the same ADC instead of blocking it */
+class AnalogInjected
+{
+    public:
+        AnalogInjected(void);                                                     //AnalogInjected object construct
+        ~AnalogInjected(void);                                                    //stop conversions
+        bool addPin(uint32_t pin);                                                //append pin to the inserted group
+        void clearPins(void);                                                     //remove all pins
+        uint8_t pinCount(void);                                                   //get number of pins in the group
+        void setSampleTime(uint32_t sampleTime);                                  //set ADC_SAMPLETIME_x of every pin
+        bool begin(HardwareTimer &timer,
+                   analogInjectedCallback_t callback = NULL);                     //convert on every event of a timer
+        bool begin(PWMGroup &group,
+                   analogInjectedCallback_t callback = NULL);                     //convert on every event of a pwm timer
+        bool begin(PWM &pwm,
+                   analogInjectedCallback_t callback = NULL);                     //convert on every event of a pwm timer
+        void end(void);                                                           //stop conversions
+        bool isRunning(void);                                                     //check if conversions are running
+        uint16_t read(uint8_t rank);                                              //get last result of a pin
+
+    private:
+        bool start(uint32_t timer, analogInjectedCallback_t callback);
+        static void adcIrq(void *arg, const uint16_t *values, uint8_t count);
+        PinName pins[ADC_INSERTED_MAX_CHANNELS];
+        uint8_t count;
+        uint32_t sampleTime;
+        uint32_t adcPeriph;
+        analogInjectedCallback_t callback;
+        bool running;
+};
+
+#endif /* ANALOGINJECTED_H */
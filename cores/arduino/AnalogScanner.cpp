@@ -0,0 +1,456 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "AnalogScanner.h"
+#include "HardwareTimer.h"
+#include "pins_arduino.h"
+
+/*!
+    \brief      AnalogScanner object construct
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+AnalogScanner::AnalogScanner(void)
+{
+    this->count = 0;
+    this->sampleTime = ADC_SAMPLETIME_55POINT5;
+    this->adcPeriph = (uint32_t)NC;
+    this->triggerTimer = 0;
+    this->buffer = NULL;
+    this->length = 0;
+    this->callback = NULL;
+    this->running = false;
+}
+
+/*!
+    \brief      stop scanning, the DMA must not write to the buffer of a destroyed object
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+AnalogScanner::~AnalogScanner(void)
+{
+    end();
+}
+
+/*!
+    \brief      append a pin to the conversion sequence, all pins have to belong to the same ADC
+    \param[in]  pin: analog pin
+    \param[out] none
+    \retval     false if the sequence is full or the pin is on another ADC
+*/
+bool AnalogScanner::addPin(uint32_t pin)
+{
+    PinName pinname = DIGITAL_TO_PINNAME(pin);
+    uint32_t periph = pinmap_peripheral(pinname, PinMap_ADC);
+
+    if (this->running || (this->count >= ADC_SCAN_MAX_CHANNELS) || ((uint32_t)NC == periph)) {
+        return false;
+    }
+    if ((this->count != 0U) && (periph != this->adcPeriph)) {
+        return false;
+    }
+    this->adcPeriph = periph;
+    this->pins[this->count++] = pinname;
+    return true;
+}
+
+/*!
+    \brief      remove all pins from the conversion sequence
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void AnalogScanner::clearPins(void)
+{
+    end();
+    this->count = 0;
+    this->adcPeriph = (uint32_t)NC;
+}
+
+/*!
+    \brief      get the number of pins in the conversion sequence
+    \param[in]  none
+    \param[out] none
+    \retval     number of pins
+*/
+uint8_t AnalogScanner::pinCount(void)
+{
+    return this->count;
+}
+
+/*!
+    \brief      set the sample time used for every pin, takes effect with the next begin()
+    \param[in]  sampleTime: ADC_SAMPLETIME_x
+    \param[out] none
+    \retval     none
+*/
+void AnalogScanner::setSampleTime(uint32_t sampleTime)
+{
+    this->sampleTime = sampleTime;
+}
+
+/*!
+    \brief      convert the sequence once per period of a timer instead of back to back, takes
+                effect with the next begin(). The timer keeps its own period and is started by
+                the sketch; TRGO or a spare compare channel of it is set up as the ADC trigger
+    \param[in]  timer: e.g. TIMER2 or TIMER0 for ADC0, see the ADC external trigger table
+    \param[out] none
+    \retval     none
+*/
+void AnalogScanner::setTrigger(HardwareTimer &timer)
+{
+    this->triggerTimer = timer.getInstance();
+}
+
+/*!
+    \brief      convert the sequence back to back again, takes effect with the next begin()
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void AnalogScanner::clearTrigger(void)
+{
+    this->triggerTimer = 0;
+}
+
+/*!
+    \brief      DMA callback, hands each filled half of the buffer to the user callback
+    \param[in]  arg: the AnalogScanner object
+    \param[in]  flags: DMA_CALLBACK_FLAG_x
+    \param[out] none
+    \retval     none
+*/
+void AnalogScanner::dmaIrq(void *arg, uint32_t flags)
+{
+    AnalogScanner *scanner = (AnalogScanner *)arg;
+    size_t half = scanner->length / 2;
+
+    if (scanner->callback == NULL) {
+        return;
+    }
+    if (flags & DMA_CALLBACK_FLAG_HTF) {
+        scanner->callback(scanner->buffer, half);
+    }
+    if (flags & DMA_CALLBACK_FLAG_FTF) {
+        scanner->callback(scanner->buffer + half, scanner->length - half);
+    }
+}
+
+/*!
+    \brief      start converting the sequence over and over into a ring buffer
+    \param[in]  buffer: ring buffer of results, must stay valid while scanning
+    \param[in]  length: number of results in buffer, a multiple of twice the pin count so both
+                halves hold complete sequences
+    \param[in]  callback: called from the DMA interrupt with each half of the buffer once it is filled
+    \param[out] none
+    \retval     false if there are no pins, length does not fit, the ADC has no DMA request or
+                the trigger timer cannot trigger this ADC
+*/
+bool AnalogScanner::begin(uint16_t *buffer, size_t length, analogScanCallback_t callback)
+{
+    if ((this->count == 0U) || (buffer == NULL) || (length == 0U)
+            || ((length % (2U * this->count)) != 0U)) {
+        return false;
+    }
+    end();
+    this->buffer = buffer;
+    this->length = length;
+    this->callback = callback;
+    this->running = adc_scan_start(this->pins, this->count, buffer, length, this->sampleTime,
+                                   this->triggerTimer, (callback != NULL) ? dmaIrq : NULL, this) != 0;
+    return this->running;
+}
+
+/*!
+    \brief      stop scanning, analogRead() can use the ADC again afterwards
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void AnalogScanner::end(void)
+{
+    if (!this->running) {
+        return;
+    }
+    adc_scan_stop(this->adcPeriph);
+    this->callback = NULL;
+    this->running = false;
+}
+
+/*!
+    \brief      check if a scan is running
+    \param[in]  none
+    \param[out] none
+    \retval     true while scanning
+*/
+bool AnalogScanner::isRunning(void)
+{
+    return this->running;
+}
+
+/*!
+    \brief      get the buffer index the next result is written to
+    \param[in]  none
+    \param[out] none
+    \retval     index into the sample buffer
+*/
+size_t AnalogScanner::bufferIndex(void)
+{
+    size_t remaining;
+
+    if (!this->running) {
+        return 0;
+    }
+    remaining = adc_scan_remaining(this->adcPeriph);
+    return (remaining == 0U) ? 0U : this->length - remaining;
+}
+
+/*!
+    \brief      AnalogDualScanner object construct
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+AnalogDualScanner::AnalogDualScanner(void)
+{
+    this->count = 0;
+    this->mode = ADC_DUAL_SIMULTANEOUS;
+    this->sampleTime = ADC_SAMPLETIME_55POINT5;
+    this->triggerTimer = 0;
+    this->buffer = NULL;
+    this->length = 0;
+    this->callback = NULL;
+    this->running = false;
+}
+
+/*!
+    \brief      stop scanning, the DMA must not write to the buffer of a destroyed object
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+AnalogDualScanner::~AnalogDualScanner(void)
+{
+    end();
+}
+
+/*!
+    \brief      append a pair of pins sampled at the same instant, pin0 by ADC0 and pin1 by ADC1
+    \param[in]  pin0: analog pin on a channel shared by ADC0 and ADC1
+    \param[in]  pin1: analog pin on a channel shared by ADC0 and ADC1
+    \param[out] none
+    \retval     false if the sequence is full, a pin has no ADC channel or an interleaved pin is set
+*/
+bool AnalogDualScanner::addPair(uint32_t pin0, uint32_t pin1)
+{
+    PinName pinname0 = DIGITAL_TO_PINNAME(pin0);
+    PinName pinname1 = DIGITAL_TO_PINNAME(pin1);
+
+    if (this->running || (this->count >= ADC_SCAN_MAX_CHANNELS) || (this->mode != ADC_DUAL_SIMULTANEOUS)
+            || ((uint32_t)NC == pinmap_peripheral(pinname0, PinMap_ADC))
+            || ((uint32_t)NC == pinmap_peripheral(pinname1, PinMap_ADC))) {
+        return false;
+    }
+    this->pins0[this->count] = pinname0;
+    this->pins1[this->count] = pinname1;
+    this->count++;
+    return true;
+}
+
+/*!
+    \brief      sample a single pin with ADC0 and ADC1 alternately, each buffer word holds two
+                successive samples. Replaces the pairs added so far
+    \param[in]  pin: analog pin on a channel shared by ADC0 and ADC1
+    \param[out] none
+    \retval     false if the pin has no ADC channel
+*/
+bool AnalogDualScanner::setInterleaved(uint32_t pin)
+{
+    PinName pinname = DIGITAL_TO_PINNAME(pin);
+
+    if (this->running || ((uint32_t)NC == pinmap_peripheral(pinname, PinMap_ADC))) {
+        return false;
+    }
+    this->pins0[0] = pinname;
+    this->pins1[0] = pinname;
+    this->count = 1;
+    this->mode = ADC_DUAL_INTERLEAVED;
+    return true;
+}
+
+/*!
+    \brief      remove all pins and go back to simultaneous sampling of pairs
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void AnalogDualScanner::clearPins(void)
+{
+    end();
+    this->count = 0;
+    this->mode = ADC_DUAL_SIMULTANEOUS;
+}
+
+/*!
+    \brief      get the number of words written per sequence
+    \param[in]  none
+    \param[out] none
+    \retval     number of pairs, 1 when interleaved
+*/
+uint8_t AnalogDualScanner::pairCount(void)
+{
+    return this->count;
+}
+
+/*!
+    \brief      set the sample time used for every pin, takes effect with the next begin(). When
+                interleaved it has to be shorter than 7 ADC clocks for the conversions not to overlap
+    \param[in]  sampleTime: ADC_SAMPLETIME_x
+    \param[out] none
+    \retval     none
+*/
+void AnalogDualScanner::setSampleTime(uint32_t sampleTime)
+{
+    this->sampleTime = sampleTime;
+}
+
+/*!
+    \brief      convert the sequence once per period of a timer instead of back to back, takes
+                effect with the next begin(). The timer triggers ADC0, ADC1 follows it
+    \param[in]  timer: e.g. TIMER2 or TIMER0, see the ADC0 external trigger table
+    \param[out] none
+    \retval     none
+*/
+void AnalogDualScanner::setTrigger(HardwareTimer &timer)
+{
+    this->triggerTimer = timer.getInstance();
+}
+
+/*!
+    \brief      convert the sequence back to back again, takes effect with the next begin()
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void AnalogDualScanner::clearTrigger(void)
+{
+    this->triggerTimer = 0;
+}
+
+/*!
+    \brief      DMA callback, hands each filled half of the buffer to the user callback
+    \param[in]  arg: the AnalogDualScanner object
+    \param[in]  flags: DMA_CALLBACK_FLAG_x
+    \param[out] none
+    \retval     none
+*/
+void AnalogDualScanner::dmaIrq(void *arg, uint32_t flags)
+{
+    AnalogDualScanner *scanner = (AnalogDualScanner *)arg;
+    size_t half = scanner->length / 2;
+
+    if (scanner->callback == NULL) {
+        return;
+    }
+    if (flags & DMA_CALLBACK_FLAG_HTF) {
+        scanner->callback(scanner->buffer, half);
+    }
+    if (flags & DMA_CALLBACK_FLAG_FTF) {
+        scanner->callback(scanner->buffer + half, scanner->length - half);
+    }
+}
+
+/*!
+    \brief      start converting the sequence over and over into a ring buffer
+    \param[in]  buffer: ring buffer of result words, must stay valid while scanning
+    \param[in]  length: number of words in buffer, a multiple of twice the pair count
+    \param[in]  callback: called from the DMA interrupt with each half of the buffer once it is filled
+    \param[out] none
+    \retval     false if there are no pins, length does not fit, the part has no dual ADC mode
+                or ADC0/ADC1 are in use by another scan
+*/
+bool AnalogDualScanner::begin(uint32_t *buffer, size_t length, analogDualScanCallback_t callback)
+{
+    if ((this->count == 0U) || (buffer == NULL) || (length == 0U)
+            || ((length % (2U * this->count)) != 0U)) {
+        return false;
+    }
+    end();
+    this->buffer = buffer;
+    this->length = length;
+    this->callback = callback;
+    this->running = adc_dual_start(this->mode, this->pins0, this->pins1, this->count, buffer, length,
+                                   this->sampleTime, this->triggerTimer,
+                                   (callback != NULL) ? dmaIrq : NULL, this) != 0;
+    return this->running;
+}
+
+/*!
+    \brief      stop scanning, ADC0 and ADC1 work independently again
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void AnalogDualScanner::end(void)
+{
+    if (!this->running) {
+        return;
+    }
+    adc_dual_stop();
+    this->callback = NULL;
+    this->running = false;
+}
+
+/*!
+    \brief      check if a scan is running
+    \param[in]  none
+    \param[out] none
+    \retval     true while scanning
+*/
+bool AnalogDualScanner::isRunning(void)
+{
+    return this->running;
+}
+
+/*!
+    \brief      get the buffer index the next result word is written to
+    \param[in]  none
+    \param[out] none
+    \retval     index into the sample buffer
+*/
+size_t AnalogDualScanner::bufferIndex(void)
+{
+    size_t remaining;
+
+    if (!this->running) {
+        return 0;
+    }
+    remaining = adc_dual_remaining();
+    return (remaining == 0U) ? 0U : this->length - remaining;
+}
@@ -0,0 +1,108 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef ANALOGSCANNER_H
+#define ANALOGSCANNER_H
+
+#include "analog.h"
+
+class HardwareTimer;
+
+/* data points at the half of the sample buffer that was just filled, count is a multiple of the pin count */
+typedef void(*analogScanCallback_t)(const uint16_t *data, size_t count);
+
+/* Converts a sequence of analog pins back to back or once per period of a trigger timer,
+   DMA stores the results pin after pin in a ring buffer */
+class AnalogScanner
+{
+    public:
+        AnalogScanner(void);                                                      //AnalogScanner object construct
+        ~AnalogScanner(void);                                                     //stop scanning
+        bool addPin(uint32_t pin);                                                //append pin to the sequence
+        void clearPins(void);                                                     //remove all pins
+        uint8_t pinCount(void);                                                   //get number of pins in the sequence
+        void setSampleTime(uint32_t sampleTime);                                  //set ADC_SAMPLETIME_x of every pin
+        void setTrigger(HardwareTimer &timer);                                    //convert once per timer period
+        void clearTrigger(void);                                                  //convert back to back
+        bool begin(uint16_t *buffer, size_t length,
+                   analogScanCallback_t callback = NULL);                         //start scanning into buffer
+        void end(void);                                                           //stop scanning
+        bool isRunning(void);                                                     //check if a scan is running
+        size_t bufferIndex(void);                                                 //get index of the next result
+
+    private:
+        static void dmaIrq(void *arg, uint32_t flags);
+        PinName pins[ADC_SCAN_MAX_CHANNELS];
+        uint8_t count;
+        uint32_t sampleTime;
+        uint32_t adcPeriph;
+        uint32_t triggerTimer;
+        uint16_t *buffer;
+        size_t length;
+        analogScanCallback_t callback;
+        bool running;
+};
+
+/* data points at the half of the sample buffer that was just filled, see ADC_DUAL_VALUE0/1 */
+typedef void(*analogDualScanCallback_t)(const uint32_t *data, size_t count);
+
+/* Converts pairs of analog pins on ADC0 and ADC1 at the same instant, or one pin on both ADCs
+   alternately at twice the rate. DMA stores both results of each step in one 32-bit word.
+   Only available where ADC0 and ADC1 can be synchronised (GD32F30x, GD32E50x) */
+class AnalogDualScanner
+{
+    public:
+        AnalogDualScanner(void);                                                  //AnalogDualScanner object construct
+        ~AnalogDualScanner(void);                                                 //stop scanning
+        bool addPair(uint32_t pin0, uint32_t pin1);                               //append pins sampled together
+        bool setInterleaved(uint32_t pin);                                        //sample one pin on both ADCs in turn
+        void clearPins(void);                                                     //remove all pins
+        uint8_t pairCount(void);                                                  //get number of steps in the sequence
+        void setSampleTime(uint32_t sampleTime);                                  //set ADC_SAMPLETIME_x of every pin
+        void setTrigger(HardwareTimer &timer);                                    //convert once per timer period
+        void clearTrigger(void);                                                  //convert back to back
+        bool begin(uint32_t *buffer, size_t length,
+                   analogDualScanCallback_t callback = NULL);                     //start scanning into buffer
+        void end(void);                                                           //stop scanning
+        bool isRunning(void);                                                     //check if a scan is running
+        size_t bufferIndex(void);                                                 //get index of the next result
+
+    private:
+        static void dmaIrq(void *arg, uint32_t flags);
+        PinName pins0[ADC_SCAN_MAX_CHANNELS];
+        PinName pins1[ADC_SCAN_MAX_CHANNELS];
+        uint8_t count;
+        uint8_t mode;
+        uint32_t sampleTime;
+        uint32_t triggerTimer;
+        uint32_t *buffer;
+        size_t length;
+        analogDualScanCallback_t callback;
+        bool running;
+};
+
+#endif /* ANALOGSCANNER_H */
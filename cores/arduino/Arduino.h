@@ -45,6 +45,18 @@ using namespace arduino;
 #ifdef __cplusplus
 /* include outside of extern C block, this is basically a C++ library */
 #include "pwm.h"
+#include "AnalogScanner.h"
+#include "AnalogInjected.h"
+#include "DACStream.h"
+#include "HardwareCRC.h"
+#include "FastPin.h"
+#include "PulseCapture.h"
+#include "PortSampler.h"
+#include "PortPattern.h"
+#include "KeyScanner.h"
+#include "HighResPWM.h"
+#include "ITMStream.h"
+#include "FixedPool.h"
 
 extern "C" {
 #endif /* __cplusplus */
@@ -52,9 +64,22 @@ extern "C" {
 #include "analog.h"
 #include "wiring_analog_extra.h"
 #include "wiring_digital_extra.h"
+#include "wiring_time_extra.h"
 #include "gd32/gpio_interrupt.h"
 #include "gd32/timer.h"
 #include "gd32/rtc.h"
+#include "gd32/deferred.h"
+#include "gd32/clock.h"
+#include "gd32/soft_timer.h"
+#include "gd32/dma_copy.h"
+#include "gd32/fast_math.h"
+#include "gd32/exmc.h"
+#include "gd32/irq_profile.h"
+#include "gd32/memory.h"
+#include "gd32/crash.h"
+#include "gd32/pool.h"
+#include "gd32/critical.h"
+#include "gd32/irq_priority.h"
 
 #ifdef __cplusplus
 }
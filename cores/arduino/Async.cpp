@@ -0,0 +1,194 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+#include "Async.h"
+
+#if ASYNC_COROUTINES
+
+#include "gd32/critical.h"
+#include "gd32/pool.h"
+
+AsyncExecutor Async;
+
+static union {
+    pool_block_t link;
+    alignas(8) uint8_t frame[ASYNC_FRAME_SIZE];
+} async_frame_storage[ASYNC_FRAME_COUNT];
+static pool_t async_frames = POOL_INIT(async_frame_storage, sizeof(async_frame_storage[0]), ASYNC_FRAME_COUNT);
+static volatile uint32_t async_frame_misses = 0;
+
+/*!
+    \brief      allocate a coroutine frame from the frame pool
+    \param[in]  size: bytes the compiler needs for the frame
+    \param[out] none
+    \retval     the frame, nullptr if it is too large or the pool is empty
+*/
+void *AsyncTask::promise_type::operator new(size_t size) noexcept
+{
+    void *frame = (size <= ASYNC_FRAME_SIZE) ? pool_alloc(&async_frames) : nullptr;
+
+    if (frame == nullptr) {
+        async_frame_misses = async_frame_misses + 1U;
+    }
+    return frame;
+}
+
+void AsyncTask::promise_type::operator delete(void *frame) noexcept
+{
+    pool_free(&async_frames, frame);
+}
+
+AsyncTask &AsyncTask::operator=(AsyncTask &&other)
+{
+    if (this != &other) {
+        if (handle) {
+            handle.destroy();
+        }
+        handle = other.handle;
+        other.handle = nullptr;
+    }
+    return *this;
+}
+
+AsyncTask::~AsyncTask(void)
+{
+    if (handle) {
+        handle.destroy();
+    }
+}
+
+/*!
+    \brief      take over a task and run it from the next poll() on
+    \param[in]  task: the task, as returned by calling the coroutine
+    \param[out] none
+    \retval     false if the task is empty or no slot is free, it is destroyed then
+*/
+bool AsyncExecutor::spawn(AsyncTask task)
+{
+    if (!task) {
+        return false;
+    }
+    for (async_slot_t i = 0; i < ASYNC_MAX_TASKS; i++) {
+        if (!slots[i].task) {
+            slots[i].task = task.handle;
+            slots[i].resume = task.handle;
+            slots[i].ready = nullptr;
+            task.handle = nullptr;
+            wake(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!
+    \brief      resume every task that was woken or whose polled awaitable is ready, once
+    \param[in]  none
+    \param[out] none
+    \retval     true while tasks are left
+*/
+bool AsyncExecutor::poll(void)
+{
+    uint32_t state = critical_enter();
+    uint32_t woken = readyMask;
+    bool left = false;
+
+    readyMask = 0U;
+    critical_exit(state);
+
+    for (async_slot_t i = 0; i < ASYNC_MAX_TASKS; i++) {
+        Slot &slot = slots[i];
+        if (!slot.task) {
+            continue;
+        }
+        if ((woken & (1UL << i)) || ((slot.ready != nullptr) && slot.ready(slot.arg))) {
+            slot.ready = nullptr;
+            running = i;
+            slot.resume.resume();
+            running = ASYNC_NO_SLOT;
+            if (slot.task.done()) {
+                slot.task.destroy();
+                slot.task = nullptr;
+                continue;
+            }
+        }
+        left = true;
+    }
+    return left;
+}
+
+uint8_t AsyncExecutor::tasks(void)
+{
+    uint8_t count = 0;
+
+    for (async_slot_t i = 0; i < ASYNC_MAX_TASKS; i++) {
+        if (slots[i].task) {
+            count++;
+        }
+    }
+    return count;
+}
+
+uint32_t AsyncExecutor::frameMisses(void)
+{
+    return async_frame_misses;
+}
+
+/*!
+    \brief      park the running task until its operation completes
+    \param[in]  handle: the coroutine to resume, the task or a subroutine of it
+    \param[in]  ready: checked on every poll() instead of waiting for wake(), nullptr for none
+    \param[in]  arg: passed to ready
+    \param[out] none
+    \retval     the slot the completion wakes, ASYNC_NO_SLOT if no task is running
+*/
+async_slot_t AsyncExecutor::suspend(std::coroutine_handle<> handle, bool (*ready)(void *), void *arg)
+{
+    if (running == ASYNC_NO_SLOT) {
+        return ASYNC_NO_SLOT;
+    }
+    slots[running].resume = handle;
+    slots[running].ready = ready;
+    slots[running].arg = arg;
+    return running;
+}
+
+/*!
+    \brief      mark a task ready, safe in interrupts
+    \param[in]  slot: what suspend() returned
+    \param[out] none
+    \retval     none
+*/
+void AsyncExecutor::wake(async_slot_t slot)
+{
+    if (slot < ASYNC_MAX_TASKS) {
+        uint32_t state = critical_enter();
+        readyMask = readyMask | (1UL << slot);
+        critical_exit(state);
+    }
+}
+
+#endif /* ASYNC_COROUTINES */
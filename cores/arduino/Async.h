@@ -0,0 +1,322 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef ASYNC_H
+#define ASYNC_H
+
+/*
+ * C++20 coroutines over the asynchronous drivers, for protocol code that
+ * reads top to bottom but never blocks:
+ *
+ *   AsyncTask poll_sensor(void)
+ *   {
+ *       uint8_t reg = 0x00, value[2];
+ *       for (;;) {
+ *           if (co_await Wire.transferAsync(0x48, &reg, 1, value, 2) == 0) {
+ *               ...
+ *           }
+ *           co_await asyncDelay(100);
+ *       }
+ *   }
+ *
+ *   void setup() { Wire.begin(); Async.spawn(poll_sensor()); }
+ *   void loop() { Async.poll(); }
+ *
+ * Async.poll() resumes the tasks whose operation has completed, in
+ * thread mode; the interrupt that completes an operation only stores the
+ * result and marks its task ready. A task may co_await another AsyncTask
+ * as a subroutine. Coroutine frames come from a static pool of
+ * ASYNC_FRAME_COUNT blocks of ASYNC_FRAME_SIZE bytes, never the heap: a
+ * coroutine whose frame does not fit yields an empty AsyncTask, which
+ * spawn() refuses and co_await skips; frameMisses() counts them.
+ *
+ * Only built when the compiler has coroutines: GCC 10 or later with
+ * -std=gnu++20 (or -fcoroutines), see the C++ standard menu. The bundled
+ * GCC 9 has none and ASYNC_COROUTINES stays 0.
+ */
+#if defined(__cplusplus) && defined(__cpp_impl_coroutine)
+#define ASYNC_COROUTINES 1
+#else
+#define ASYNC_COROUTINES 0
+#endif
+
+#if ASYNC_COROUTINES
+
+#include <coroutine>
+#include <stddef.h>
+#include <stdint.h>
+#include "api/Common.h"
+#include "wiring_analog_extra.h"
+
+/* tasks spawned at the same time, at most 32 */
+#ifndef ASYNC_MAX_TASKS
+#define ASYNC_MAX_TASKS 4
+#endif
+/* coroutine frames, spawned tasks and the subroutines they are awaiting together */
+#ifndef ASYNC_FRAME_COUNT
+#define ASYNC_FRAME_COUNT 8
+#endif
+/* bytes of a frame: the locals that live across a co_await, the awaitables, a few words more */
+#ifndef ASYNC_FRAME_SIZE
+#define ASYNC_FRAME_SIZE 256
+#endif
+
+/* the slot of a task, what its operations are completed to */
+typedef uint8_t async_slot_t;
+#define ASYNC_NO_SLOT   0xFFU
+
+class AsyncTask
+{
+    public:
+        struct promise_type {
+            std::coroutine_handle<> continuation;   //the coroutine awaiting this one, if any
+
+            AsyncTask get_return_object(void)
+            {
+                return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+            static AsyncTask get_return_object_on_allocation_failure(void)
+            {
+                return AsyncTask();
+            }
+            std::suspend_always initial_suspend(void) noexcept
+            {
+                return {};
+            }
+            /* go on with the awaiting coroutine; a spawned task stays suspended for poll() to destroy */
+            struct FinalAwaiter {
+                bool await_ready(void) noexcept
+                {
+                    return false;
+                }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                {
+                    std::coroutine_handle<> next = handle.promise().continuation;
+                    return next ? next : std::noop_coroutine();
+                }
+                void await_resume(void) noexcept {}
+            };
+            FinalAwaiter final_suspend(void) noexcept
+            {
+                return {};
+            }
+            void return_void(void) {}
+            void unhandled_exception(void) {}
+
+            static void *operator new(size_t size) noexcept;
+            static void operator delete(void *frame) noexcept;
+        };
+
+        AsyncTask(void) : handle(nullptr) {}
+        AsyncTask(AsyncTask &&other) : handle(other.handle)
+        {
+            other.handle = nullptr;
+        }
+        AsyncTask &operator=(AsyncTask &&other);
+        ~AsyncTask(void);
+
+        /* false if the frame could not be allocated */
+        explicit operator bool(void) const
+        {
+            return (bool)handle;
+        }
+
+        /* co_await runs the task to its end as a subroutine of the awaiting one */
+        bool await_ready(void) const noexcept
+        {
+            return !handle || handle.done();
+        }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+        {
+            handle.promise().continuation = awaiting;
+            return handle;
+        }
+        void await_resume(void) noexcept {}
+
+    private:
+        explicit AsyncTask(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+        std::coroutine_handle<promise_type> handle;
+
+        friend class AsyncExecutor;
+
+        AsyncTask(const AsyncTask &) = delete;
+        AsyncTask &operator=(const AsyncTask &) = delete;
+};
+
+class AsyncExecutor
+{
+    public:
+        /* start task on the next poll(), false if it is empty or all ASYNC_MAX_TASKS slots are taken */
+        bool spawn(AsyncTask task);
+        /* resume the ready tasks once each, from loop(). Returns false once no task is left */
+        bool poll(void);
+        /* tasks spawned and not finished */
+        uint8_t tasks(void);
+        /* coroutines that found the frame pool empty or their frame too large */
+        uint32_t frameMisses(void);
+
+        /* For awaitables: park the running task at handle until wake(), or until ready(arg)
+         * returns true when a poll() asks. Returns the slot to wake, ASYNC_NO_SLOT outside a task */
+        async_slot_t suspend(std::coroutine_handle<> handle, bool (*ready)(void *) = nullptr,
+                             void *arg = nullptr);
+        /* mark the task in slot ready, from an interrupt or thread mode */
+        void wake(async_slot_t slot);
+
+    private:
+        struct Slot {
+            std::coroutine_handle<> task;      //the spawned coroutine, null while the slot is free
+            std::coroutine_handle<> resume;    //where it is suspended, itself or a subroutine
+            bool (*ready)(void *);             //polled instead of woken, nullptr if not
+            void *arg;
+        };
+        static_assert(ASYNC_MAX_TASKS > 0 && ASYNC_MAX_TASKS <= 32, "ASYNC_MAX_TASKS is 1 to 32");
+
+        Slot slots[ASYNC_MAX_TASKS];
+        volatile uint32_t readyMask = 0;
+        async_slot_t running = ASYNC_NO_SLOT;
+};
+
+extern AsyncExecutor Async;
+
+/*
+ * Base of the awaitables an interrupt completes. Derived::start() begins
+ * the operation, its completion callback calls complete() with the
+ * result; start() returns false if the operation could not begin, with
+ * result already set to say why.
+ */
+template <typename Derived, typename T>
+class AsyncOperation
+{
+    public:
+        bool await_ready(void) noexcept
+        {
+            return false;
+        }
+        bool await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            slot = Async.suspend(handle);
+            if (slot == ASYNC_NO_SLOT) {
+                return false;
+            }
+            return static_cast<Derived *>(this)->start();
+        }
+        T await_resume(void) noexcept
+        {
+            return result;
+        }
+
+    protected:
+        explicit AsyncOperation(T failed) : result(failed) {}
+
+        void complete(T value)
+        {
+            result = value;
+            Async.wake(slot);
+        }
+
+        volatile T result;
+        async_slot_t slot = ASYNC_NO_SLOT;
+};
+
+/*
+ * Base of the awaitables that are checked from poll() instead, for
+ * operations without a completion interrupt. Derived::ready() is called
+ * in thread mode and returns true once done; Derived::value() is the
+ * result co_await gives.
+ */
+template <typename Derived>
+class AsyncPoll
+{
+    public:
+        bool await_ready(void) noexcept
+        {
+            return static_cast<Derived *>(this)->ready();
+        }
+        bool await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            return Async.suspend(handle, &AsyncPoll::poll, this) != ASYNC_NO_SLOT;
+        }
+        auto await_resume(void) noexcept
+        {
+            return static_cast<Derived *>(this)->value();
+        }
+
+    private:
+        static bool poll(void *arg)
+        {
+            return static_cast<Derived *>((AsyncPoll *)arg)->ready();
+        }
+};
+
+/* co_await asyncDelay(ms) lets the other tasks run for ms milliseconds */
+class AsyncDelay : public AsyncPoll<AsyncDelay>
+{
+    public:
+        explicit AsyncDelay(uint32_t ms) : start(millis()), ms(ms) {}
+        bool ready(void)
+        {
+            return (millis() - start) >= ms;
+        }
+        void value(void) {}
+
+    private:
+        uint32_t start;
+        uint32_t ms;
+};
+
+inline AsyncDelay asyncDelay(uint32_t ms)
+{
+    return AsyncDelay(ms);
+}
+
+/* co_await asyncAnalogRead(pin) gives what analogRead(pin) would, -1 if the conversion could not start */
+class AsyncAnalogRead : public AsyncPoll<AsyncAnalogRead>
+{
+    public:
+        explicit AsyncAnalogRead(uint32_t pin) : started(analogReadStart(pin) != 0) {}
+        bool ready(void)
+        {
+            return !started || analogReadReady();
+        }
+        int value(void)
+        {
+            return started ? analogReadResult() : -1;
+        }
+
+    private:
+        bool started;
+};
+
+inline AsyncAnalogRead asyncAnalogRead(uint32_t pin)
+{
+    return AsyncAnalogRead(pin);
+}
+
+#endif /* ASYNC_COROUTINES */
+
+#endif /* ASYNC_H */
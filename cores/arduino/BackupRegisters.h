@@ -0,0 +1,122 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef _GD_BACKUPREGISTERS_H_
+#define _GD_BACKUPREGISTERS_H_
+
+#include "Arduino.h"
+#include "gd32/backup.h"
+
+/*
+ * The backup data registers as 32-bit words, kept through resets and
+ * standby, and with a battery through power loss too. A write costs a
+ * register store, no erase and no wear, so counters can be saved every
+ * time they change. BACKUP_WORDS words, see gd32/backup.h.
+ */
+class BackupRegistersClass
+{
+    public:
+        void begin(void);                                                 //enable writes
+        uint32_t read(uint32_t index)                                     //word, 0 out of range
+        {
+            return backup_read(index);
+        }
+        void write(uint32_t index, uint32_t value)                        //one or two register stores
+        {
+            backup_write(index, value);
+        }
+        uint32_t increment(uint32_t index, uint32_t delta = 1)            //add, returns the new value
+        {
+            return backup_add(index, delta);
+        }
+        uint32_t length(void)                                             //number of words
+        {
+            return BACKUP_WORDS;
+        }
+};
+
+/*
+ * The backup registers with the interface of EEPROM, BACKUP_SIZE bytes.
+ * Writes take effect at once, commit() has nothing to do.
+ */
+class BackupEEPROMClass
+{
+    public:
+        template<typename T>
+        T& get(uint32_t offset, T& t)
+        {
+            uint8_t *p = (uint8_t *)&t;
+
+            for (uint32_t i = 0; i < sizeof(T); i++) {
+                p[i] = backup_read_byte(offset + i);
+            }
+            return t;
+        }
+        template<typename T>
+        const T& put(uint32_t offset, const T& t)
+        {
+            const uint8_t *p = (const uint8_t *)&t;
+
+            for (uint32_t i = 0; i < sizeof(T); i++) {
+                backup_write_byte(offset + i, p[i]);
+            }
+            return t;
+        }
+
+        uint8_t read(uint32_t offset)
+        {
+            return backup_read_byte(offset);
+        }
+        void write(uint32_t offset, uint8_t val)
+        {
+            backup_write_byte(offset, val);
+        }
+        void update(uint32_t offset, uint8_t val)
+        {
+            if (read(offset) != val)
+                write(offset, val);
+        }
+
+        void commit()
+        {
+        }
+
+        void begin()
+        {
+            backup_begin();
+        }
+
+        uint32_t length()
+        {
+            return BACKUP_SIZE;
+        }
+};
+
+extern BackupRegistersClass BackupRegisters;
+extern BackupEEPROMClass BackupEEPROM;
+
+#endif /* _GD_BACKUPREGISTERS_H_ */
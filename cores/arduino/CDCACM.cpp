@@ -3,19 +3,17 @@
 
 #include "USBCore.h"
 
-const uint8_t ACM_EP_MAXLEN = 0x10;
+extern "C" {
+#include "gd32/usb.h"
+}
 
-static uint8_t IN_ENDPOINT = 0;
+const uint8_t ACM_EP_MAXLEN = 0x10;
 
-static uint8_t cdc_flush_sof(usb_dev *usbd) {
-    USB_Flush(IN_ENDPOINT);
-    return 0;
+static void cdc_flush_sof()
+{
+    CDCACM().sof();
 }
 
-usbd_int_cb_struct usb_inthandler = {
-    cdc_flush_sof,
-};
-
 CDCACM_::CDCACM_(uint8_t firstInterface, uint8_t firstEndpoint)
 {
     this->acmInterface = firstInterface;
@@ -23,7 +21,6 @@ CDCACM_::CDCACM_(uint8_t firstInterface, uint8_t firstEndpoint)
     this->acmEndpoint = firstEndpoint;
     this->outEndpoint = firstEndpoint + 1;
     this->inEndpoint = firstEndpoint + 2;
-    IN_ENDPOINT = this->inEndpoint;
 
     *(EPDesc*)epBuffer(this->acmEndpoint) = EPDesc(USB_TRX_IN, USB_ENDPOINT_TYPE_INTERRUPT, ACM_EP_MAXLEN);
     *(EPDesc*)epBuffer(this->outEndpoint) = EPDesc(USB_TRX_OUT, USB_ENDPOINT_TYPE_BULK);
@@ -78,9 +75,11 @@ bool CDCACM_::setup(arduino::USBSetup& setup)
             this->lineState = setup.wValueL;
             if (this->lineState > 0) {
                 // setup a better handler that does automatic flushing
-                usbd_int_fops = &usb_inthandler;
+                USBCore().attachSOF(cdc_flush_sof);
             } else {
-                usbd_int_fops = nullptr;
+                USBCore().attachSOF(nullptr);
+                // Nobody is listening any more.
+                this->txTail = this->txHead;
             }
         }
         return true;
@@ -95,7 +94,9 @@ void CDCACM_::begin(uint32_t baud)
 
 void CDCACM_::begin(uint32_t baud, uint8_t config)
 {
-    this->peekBuffer = -1;
+    (void)baud;
+    (void)config;
+    USBCore().connect();
 }
 
 void CDCACM_::end()
@@ -104,39 +105,190 @@ void CDCACM_::end()
 
 CDCACM_::operator bool()
 {
+    USBCore().connect();
     return this->lineState > 0;
 }
 
 int CDCACM_::available()
 {
-    if (this->peekBuffer < 0) {
-        return USB_Available(this->outEndpoint);
-    }
-    return 1 + USB_Available(this->outEndpoint);
+    USBCore().connect();
+    this->rxPull();
+    return this->rxPending() + USB_Available(this->outEndpoint);
 }
 
 int CDCACM_::peek()
 {
-    if (this->peekBuffer < 0) {
-        this->peekBuffer = USB_Recv(this->outEndpoint);
+    USBCore().connect();
+    this->rxPull();
+    if (this->rxPending() == 0) {
+        return -1;
     }
-    return this->peekBuffer;
+    return this->rxBuffer[this->rxTail];
 }
 
 int CDCACM_::read()
 {
-    if (this->peekBuffer < 0) {
-        return USB_Recv(this->outEndpoint);
+    uint8_t c;
+    if (this->rxRead(&c, sizeof(c)) == 0) {
+        return -1;
+    }
+    return c;
+}
+
+// Like ‘Stream::readBytes’, but takes whatever is buffered at once
+// instead of one octet per call.
+size_t CDCACM_::readBytes(char* buffer, size_t length)
+{
+    size_t count = 0;
+    auto start = millis();
+    while (count < length) {
+        auto n = this->rxRead((uint8_t*)buffer + count, length - count);
+        if (n > 0) {
+            count += n;
+            start = millis();
+        } else if (millis() - start >= this->_timeout) {
+            break;
+        } else {
+            yield();
+        }
+    }
+    return count;
+}
+
+// The unread part of the ring up to its end; the rest, once the ring
+// wraps, comes with the next call after ‘consume’.
+size_t CDCACM_::peekSpan(const uint8_t** data)
+{
+    USBCore().connect();
+    this->rxPull();
+    uint16_t head = this->rxHead;
+    uint16_t tail = this->rxTail;
+    *data = &this->rxBuffer[tail];
+    if (head >= tail) {
+        return head - tail;
     }
+    return CDC_RX_BUFFER_SIZE - tail;
+}
+
+size_t CDCACM_::consume(size_t n)
+{
+    n = min(n, this->rxPending());
+    this->rxTail = (this->rxTail + n) % CDC_RX_BUFFER_SIZE;
+    // The room may let a waiting packet in.
+    this->rxPull();
+    return n;
+}
+
+size_t CDCACM_::rxPending()
+{
+    uint16_t head = this->rxHead;
+    uint16_t tail = this->rxTail;
+    return (head + CDC_RX_BUFFER_SIZE - tail) % CDC_RX_BUFFER_SIZE;
+}
 
-    auto rc = this->peekBuffer;
-    this->peekBuffer = -1;
-    return rc;
+size_t CDCACM_::rxSpace()
+{
+    return CDC_RX_BUFFER_SIZE - 1 - this->rxPending();
+}
+
+// Move whatever the OUT endpoint holds into the ring. Once the
+// packet is used up ‘EPBuffer::pop’ re-arms the endpoint.
+//
+// Runs from both the USB interrupt and ‘read’, when the ring was too
+// full to take a whole packet.
+void CDCACM_::rxPull()
+{
+    auto& ep = EPBuffers().buf(this->outEndpoint);
+    if (ep.available() == 0) {
+        // Nothing to copy, but a zero length packet still has to
+        // free the endpoint.
+        if (!ep.rxWaiting) {
+            usb_disable_interrupts();
+            ep.enableOutEndpoint();
+            usb_enable_interrupts();
+        }
+        return;
+    }
+
+    usb_disable_interrupts();
+    if (this->rxPulling) {
+        usb_enable_interrupts();
+        return;
+    }
+    this->rxPulling = true;
+    usb_enable_interrupts();
+
+    const rx_sink_t* sink = this->rxSink;
+    for (;;) {
+        if (sink != nullptr) {
+            // Through a bounce buffer, the packet memory can't be
+            // handed out directly.
+            uint8_t chunk[USB_EP_SIZE] __attribute__((aligned(4)));
+            size_t n = min(min(ep.available(), sink->space(sink->arg)), sizeof(chunk));
+            if (n == 0) {
+                break;
+            }
+            ep.pop(chunk, n);
+            sink->write(sink->arg, chunk, n);
+            continue;
+        }
+        size_t n = min(ep.available(), this->rxSpace());
+        if (n == 0) {
+            break;
+        }
+        uint16_t head = this->rxHead;
+        n = min(n, (size_t)(CDC_RX_BUFFER_SIZE - head));
+        ep.pop(&this->rxBuffer[head], n);
+        this->rxHead = (head + n) % CDC_RX_BUFFER_SIZE;
+    }
+
+    this->rxPulling = false;
+
+    // A packet that came in while we were busy bounced off
+    // ‘rxPulling’.
+    size_t room = sink != nullptr ? sink->space(sink->arg) : this->rxSpace();
+    if (ep.available() > 0 && room > 0) {
+        this->rxPull();
+    }
+}
+
+void CDCACM_::setRxSink(const rx_sink_t* sink)
+{
+    this->rxSink = sink;
+    this->rxSinkReady();
+}
+
+// The sink made room, take what waits on the endpoint.
+void CDCACM_::rxSinkReady()
+{
+    this->rxPull();
+}
+
+// Copy up to ‘len’ octets out of the ring, topping it up from the
+// endpoint as room frees up.
+size_t CDCACM_::rxRead(uint8_t* d, size_t len)
+{
+    USBCore().connect();
+    size_t r = 0;
+    this->rxPull();
+    while (r < len) {
+        size_t n = min(this->rxPending(), len - r);
+        if (n == 0) {
+            break;
+        }
+        uint16_t tail = this->rxTail;
+        n = min(n, (size_t)(CDC_RX_BUFFER_SIZE - tail));
+        memcpy(d + r, &this->rxBuffer[tail], n);
+        this->rxTail = (tail + n) % CDC_RX_BUFFER_SIZE;
+        r += n;
+        this->rxPull();
+    }
+    return r;
 }
 
 int CDCACM_::availableForWrite()
 {
-    return USB_SendSpace(this->inEndpoint);
+    return this->txSpace();
 }
 
 size_t CDCACM_::write(uint8_t c)
@@ -146,22 +298,153 @@ size_t CDCACM_::write(uint8_t c)
 
 size_t CDCACM_::write(const uint8_t* d, size_t len)
 {
+    USBCore().connect();
     if (this->lineState <= 0) {
         this->setWriteError();
         return 0;
     }
 
-    auto w = USB_Send(this->inEndpoint, d, len);
-    if (w <= 0) {
+    size_t wrote = 0;
+    while (wrote < len) {
+        auto seen = EPBuffers().events();
+        auto space = this->txSpace();
+        if (space == 0) {
+            // Full, wait for the host to take a packet.
+            this->txKick(false);
+            if (!EPBuffers().waitForEvent(seen) || this->lineState <= 0) {
+                break;
+            }
+            continue;
+        }
+
+        // Only this side moves the head, so copy without masking
+        // interrupts and publish the new head afterwards.
+        uint16_t head = this->txHead;
+        auto n = min(space, len - wrote);
+        for (size_t i = 0; i < n; i++) {
+            this->txBuffer[head] = d[wrote + i];
+            head = (head + 1) % CDC_TX_BUFFER_SIZE;
+        }
+        this->txHead = head;
+        this->txIdleFrames = 0;
+        wrote += n;
+
+        // Full packets go out at once, the rest waits for more data
+        // or the idle flush.
+        this->txKick(false);
+    }
+
+    if (wrote == 0) {
         this->setWriteError();
-        return 0;
     }
-    return w;
+    return wrote;
 }
 
+// Send everything queued, returning once it is all in the endpoint.
 void CDCACM_::flush()
 {
-    USB_Flush(this->inEndpoint);
+    for (;;) {
+        auto seen = EPBuffers().events();
+        if (this->txPending() == 0 || this->lineState <= 0) {
+            return;
+        }
+        this->txKick(true);
+        if (this->txPending() > 0 && !EPBuffers().waitForEvent(seen)) {
+            return;
+        }
+    }
+}
+
+void CDCACM_::setIdleFlush(uint16_t ms)
+{
+    this->txIdleFlush = ms;
+}
+
+size_t CDCACM_::txPending()
+{
+    uint16_t head = this->txHead;
+    uint16_t tail = this->txTail;
+    return (head + CDC_TX_BUFFER_SIZE - tail) % CDC_TX_BUFFER_SIZE;
+}
+
+// One slot stays empty to tell a full ring from an empty one.
+size_t CDCACM_::txSpace()
+{
+    return CDC_TX_BUFFER_SIZE - 1 - this->txPending();
+}
+
+// Move queued data into the IN endpoint while it has a free buffer.
+// Unless ‘partial’ is set, only full packets are sent.
+//
+// Runs from both ‘write’ and the USB interrupt, whichever gets here
+// first does the work.
+void CDCACM_::txKick(bool partial)
+{
+    usb_disable_interrupts();
+    if (this->txKicking) {
+        usb_enable_interrupts();
+        return;
+    }
+    this->txKicking = true;
+    usb_enable_interrupts();
+
+    auto& ep = EPBuffers().buf(this->inEndpoint);
+    for (;;) {
+        auto pending = this->txPending();
+        if (pending == 0 || ep.txWaiting) {
+            break;
+        }
+        if (pending < USB_EP_SIZE && !partial) {
+            break;
+        }
+        // Don’t run off the end of the ring, the rest follows in
+        // the next transfer. Where one transfer carries several packets
+        // (USBFS), keep it to whole ones unless ‘partial’.
+        uint16_t tail = this->txTail;
+        size_t chunk = min(min(pending, (size_t)USB_XFER_SIZE), (size_t)(CDC_TX_BUFFER_SIZE - tail));
+        if (!partial && chunk > USB_EP_SIZE) {
+            chunk -= chunk % USB_EP_SIZE;
+        }
+        USB_Send(this->inEndpoint | TRANSFER_RELEASE, &this->txBuffer[tail], chunk);
+        this->txTail = (tail + chunk) % CDC_TX_BUFFER_SIZE;
+    }
+
+    this->txKicking = false;
+
+    // An IN complete that came in while we were busy bounced off
+    // ‘txKicking’, so pick up its work here.
+    if (!ep.txWaiting && this->txPending() >= (partial ? 1U : USB_EP_SIZE)) {
+        this->txKick(partial);
+    }
+}
+
+// A packet came in on the OUT endpoint, make room for the next one.
+void CDCACM_::transcOut(uint8_t ep)
+{
+    if (ep == this->outEndpoint) {
+        this->rxPull();
+    }
+}
+
+// A packet went out on the IN endpoint, send the next one.
+void CDCACM_::transcIn(uint8_t ep)
+{
+    if (ep == this->inEndpoint) {
+        this->txKick(false);
+    }
+}
+
+// Flush a partial packet nobody has added to for a while.
+void CDCACM_::sof()
+{
+    if (this->txPending() == 0) {
+        return;
+    }
+    if (this->txIdleFrames >= this->txIdleFlush) {
+        this->txKick(true);
+    } else {
+        this->txIdleFrames++;
+    }
 }
 
 CDCACM_& CDCACM()
@@ -2,6 +2,7 @@
 #ifdef USBD_USE_CDC
 #include "api/ArduinoAPI.h"
 #include "USBDefs.h"
+#include "gd32/rx_sink.h"
 
 /*
  * TODO: abstract the interfaces/endpoints
@@ -11,6 +12,30 @@
 #define CDC_ENDPOINT_OUT (CDC_FIRST_ENDPOINT+1)
 #define CDC_ENDPOINT_IN (CDC_FIRST_ENDPOINT+2)
 
+/*
+ * Octets ‘write’ can queue before it has to wait for the host.
+ */
+#ifndef CDC_TX_BUFFER_SIZE
+#define CDC_TX_BUFFER_SIZE 256
+#endif
+
+/*
+ * Octets received from the host that can wait for ‘read’. Once a
+ * packet is copied in here the OUT endpoint takes the next one, so
+ * the host is only NAKed when this is full.
+ */
+#ifndef CDC_RX_BUFFER_SIZE
+#define CDC_RX_BUFFER_SIZE 256
+#endif
+
+/*
+ * Start of frames (1 ms each) without a new ‘write’ before a
+ * partial packet is sent anyway.
+ */
+#ifndef CDC_TX_IDLE_FLUSH_MS
+#define CDC_TX_IDLE_FLUSH_MS 2
+#endif
+
 #define CDC_COMMUNICATION_INTERFACE_CLASS 0x02
 #define CDC_CALL_MANAGEMENT               0x01
 #define CDC_ABSTRACT_CONTROL_MODEL        0x02
@@ -97,12 +122,42 @@ class CDCACM_ : public Stream
         int available();
         int peek();
         int read();
+        size_t readBytes(char* buffer, size_t length);
+        size_t readBytes(uint8_t* buffer, size_t length)
+        {
+            return this->readBytes((char*)buffer, length);
+        }
+        size_t peekSpan(const uint8_t** data);
+        size_t consume(size_t n);
         int availableForWrite();
         size_t write(uint8_t c);
         size_t write(const uint8_t* d, size_t len);
         void flush();
         using Print::write;
 
+        /*
+         * How long a partial packet may wait for more data, in
+         * milliseconds. 0 sends it on the next start of frame.
+         */
+        void setIdleFlush(uint16_t ms);
+
+        /*
+         * Hand received octets to ‘sink’ from the USB interrupt instead
+         * of the receive ring, e.g. straight into an RTOS stream
+         * buffer. A packet the sink has no room for stays on the
+         * endpoint, holding off the host, until ‘rxSinkReady’ is
+         * called. NULL goes back to the ring.
+         */
+        void setRxSink(const rx_sink_t* sink);
+        void rxSinkReady();
+
+        /*
+         * Called from the USB interrupt.
+         */
+        void transcIn(uint8_t ep);
+        void transcOut(uint8_t ep);
+        void sof();
+
     private:
         uint8_t acmInterface;
         uint8_t dataInterface;
@@ -127,9 +182,36 @@ class CDCACM_ : public Stream
         uint8_t lineState = 0;
         volatile int32_t breakValue = -1;
 
-        // We only store one octet, but up to 16 bits to have a flag that
-        // specifies whether or not a character has been read.
-        volatile int16_t peekBuffer = -1;
+        /*
+         * Receive ring, filled from the OUT endpoint in the interrupt
+         * and drained by ‘read’.
+         */
+        uint8_t rxBuffer[CDC_RX_BUFFER_SIZE];
+        volatile uint16_t rxHead = 0;
+        volatile uint16_t rxTail = 0;
+        volatile bool rxPulling = false;
+        const rx_sink_t* volatile rxSink = nullptr;
+
+        size_t rxPending();
+        size_t rxSpace();
+        void rxPull();
+        size_t rxRead(uint8_t* d, size_t len);
+
+        /*
+         * Transmit ring, filled by ‘write’ and drained into the IN
+         * endpoint from the IN complete interrupt, so small writes
+         * don’t wait for the host.
+         */
+        uint8_t txBuffer[CDC_TX_BUFFER_SIZE];
+        volatile uint16_t txHead = 0;
+        volatile uint16_t txTail = 0;
+        volatile bool txKicking = false;
+        volatile uint16_t txIdleFrames = 0;
+        uint16_t txIdleFlush = CDC_TX_IDLE_FLUSH_MS;
+
+        size_t txPending();
+        size_t txSpace();
+        void txKick(bool partial);
 };
 
 #ifdef USBD_USE_CDC
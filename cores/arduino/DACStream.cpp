@@ -0,0 +1,348 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "DACStream.h"
+#include "HardwareTimer.h"
+#include "pins_arduino.h"
+
+/*!
+    \brief      DACStream object construct
+    \param[in]  pin: DAC pin
+    \param[out] none
+    \retval     none
+*/
+DACStream::DACStream(uint32_t pin)
+{
+    this->pin = DIGITAL_TO_PINNAME(pin);
+    this->wave = DAC_STREAM_WAVE_NONE;
+    this->waveBits = 1;
+    this->buffer = NULL;
+    this->length = 0;
+    this->callback = NULL;
+    this->running = false;
+}
+
+/*!
+    \brief      stop output, the DMA must not read the buffer of a destroyed object
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+DACStream::~DACStream(void)
+{
+    end();
+}
+
+/*!
+    \brief      add pseudo random noise to every sample, takes effect with the next begin()
+    \param[in]  bits: number of unmasked LFSR bits, 1..12
+    \param[out] none
+    \retval     none
+*/
+void DACStream::setNoise(uint8_t bits)
+{
+    this->wave = DAC_STREAM_WAVE_NOISE;
+    this->waveBits = bits;
+}
+
+/*!
+    \brief      add a triangle to every sample, it steps by one on each trigger, takes effect with
+                the next begin()
+    \param[in]  bits: amplitude is 2^bits - 1, 1..12
+    \param[out] none
+    \retval     none
+*/
+void DACStream::setTriangle(uint8_t bits)
+{
+    this->wave = DAC_STREAM_WAVE_TRIANGLE;
+    this->waveBits = bits;
+}
+
+/*!
+    \brief      output the samples without noise or triangle, takes effect with the next begin()
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void DACStream::clearWave(void)
+{
+    this->wave = DAC_STREAM_WAVE_NONE;
+}
+
+/*!
+    \brief      DMA callback, hands each half of the buffer that was sent to the user callback
+    \param[in]  arg: the DACStream object
+    \param[in]  flags: DMA_CALLBACK_FLAG_x
+    \param[out] none
+    \retval     none
+*/
+void DACStream::dmaIrq(void *arg, uint32_t flags)
+{
+    DACStream *stream = (DACStream *)arg;
+    size_t half = stream->length / 2;
+
+    if (stream->callback == NULL) {
+        return;
+    }
+    if (flags & DMA_CALLBACK_FLAG_HTF) {
+        stream->callback(stream->buffer, half);
+    }
+    if (flags & DMA_CALLBACK_FLAG_FTF) {
+        stream->callback(stream->buffer + half, stream->length - half);
+    }
+}
+
+/*!
+    \brief      start the output
+    \param[in]  timer: TIMERx setting the sample rate
+    \param[in]  buffer: ring buffer of samples or NULL
+    \param[in]  length: number of samples in buffer
+    \param[in]  value: base value of the wave when there is no buffer
+    \param[in]  callback: called from the DMA interrupt as each half has been sent
+    \param[out] none
+    \retval     false if the pin has no DAC or the timer cannot trigger it
+*/
+bool DACStream::start(uint32_t timer, uint16_t *buffer, size_t length, uint16_t value,
+                      dacStreamCallback_t callback)
+{
+    end();
+    this->buffer = buffer;
+    this->length = length;
+    this->callback = callback;
+    this->running = dac_stream_start(this->pin, buffer, length, value, timer, this->wave,
+                                     this->waveBits, (callback != NULL) ? dmaIrq : NULL, this) != 0;
+    return this->running;
+}
+
+/*!
+    \brief      output the buffer over and over, one sample per update of the timer. The timer keeps
+                its own period and is started by the sketch
+    \param[in]  timer: TIMER5, or TIMER6 on GD32F30x
+    \param[in]  buffer: ring buffer of 12-bit right aligned samples, must stay valid while running
+    \param[in]  length: number of samples in buffer, even so both halves can be refilled in turn
+    \param[in]  callback: called from the DMA interrupt with each half of the buffer once it was sent
+    \param[out] none
+    \retval     false if the pin has no DAC, the part has no DAC DMA or the timer cannot trigger it
+*/
+bool DACStream::begin(HardwareTimer &timer, uint16_t *buffer, size_t length,
+                      dacStreamCallback_t callback)
+{
+    if ((buffer == NULL) || (length == 0U) || ((callback != NULL) && ((length % 2U) != 0U))) {
+        return false;
+    }
+    return start(timer.getInstance(), buffer, length, 0U, callback);
+}
+
+/*!
+    \brief      generate the noise or triangle set up before around a fixed value, one step per
+                update of the timer
+    \param[in]  timer: TIMER5, or TIMER6 on GD32F30x
+    \param[in]  value: 12-bit base value
+    \param[out] none
+    \retval     false if no wave is set, the pin has no DAC or the timer cannot trigger it
+*/
+bool DACStream::begin(HardwareTimer &timer, uint16_t value)
+{
+    if (this->wave == DAC_STREAM_WAVE_NONE) {
+        return false;
+    }
+    return start(timer.getInstance(), NULL, 0U, value, NULL);
+}
+
+/*!
+    \brief      stop output, analogWrite() can use the DAC again afterwards
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void DACStream::end(void)
+{
+    if (!this->running) {
+        return;
+    }
+    dac_stream_stop(this->pin);
+    this->callback = NULL;
+    this->running = false;
+}
+
+/*!
+    \brief      check if the output is running
+    \param[in]  none
+    \param[out] none
+    \retval     true while running
+*/
+bool DACStream::isRunning(void)
+{
+    return this->running;
+}
+
+/*!
+    \brief      get the buffer index of the next sample to be sent
+    \param[in]  none
+    \param[out] none
+    \retval     index into the sample buffer
+*/
+size_t DACStream::bufferIndex(void)
+{
+    size_t remaining;
+
+    if (!this->running || (this->buffer == NULL)) {
+        return 0;
+    }
+    remaining = dac_stream_remaining(this->pin);
+    return (remaining == 0U) ? 0U : this->length - remaining;
+}
+
+/*!
+    \brief      DACDualStream object construct
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+DACDualStream::DACDualStream(void)
+{
+    this->buffer = NULL;
+    this->length = 0;
+    this->callback = NULL;
+    this->running = false;
+}
+
+/*!
+    \brief      stop output, the DMA must not read the buffer of a destroyed object
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+DACDualStream::~DACDualStream(void)
+{
+    end();
+}
+
+/*!
+    \brief      DMA callback, hands each half of the buffer that was sent to the user callback
+    \param[in]  arg: the DACDualStream object
+    \param[in]  flags: DMA_CALLBACK_FLAG_x
+    \param[out] none
+    \retval     none
+*/
+void DACDualStream::dmaIrq(void *arg, uint32_t flags)
+{
+    DACDualStream *stream = (DACDualStream *)arg;
+    size_t half = stream->length / 2;
+
+    if (stream->callback == NULL) {
+        return;
+    }
+    if (flags & DMA_CALLBACK_FLAG_HTF) {
+        stream->callback(stream->buffer, half);
+    }
+    if (flags & DMA_CALLBACK_FLAG_FTF) {
+        stream->callback(stream->buffer + half, stream->length - half);
+    }
+}
+
+/*!
+    \brief      output the pairs over and over on both DACs, one pair per update of the timer. The
+                timer keeps its own period and is started by the sketch
+    \param[in]  timer: TIMER5 or TIMER6
+    \param[in]  buffer: ring buffer of DAC_DUAL_SAMPLE() pairs, must stay valid while running
+    \param[in]  length: number of pairs in buffer, even so both halves can be refilled in turn
+    \param[in]  callback: called from the DMA interrupt with each half of the buffer once it was sent
+    \param[out] none
+    \retval     false if the part has no dual DAC DMA, a DACStream holds one of the DACs or the
+                timer cannot trigger them
+*/
+bool DACDualStream::begin(HardwareTimer &timer, uint32_t *buffer, size_t length,
+                          dacDualStreamCallback_t callback)
+{
+    if ((buffer == NULL) || (length == 0U) || ((callback != NULL) && ((length % 2U) != 0U))) {
+        return false;
+    }
+    end();
+    this->buffer = buffer;
+    this->length = length;
+    this->callback = callback;
+    this->running = dac_dual_stream_start(buffer, length, timer.getInstance(),
+                                          (callback != NULL) ? dmaIrq : NULL, this) != 0;
+    return this->running;
+}
+
+/*!
+    \brief      stop output, analogWrite() and write() can use the DACs again afterwards
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void DACDualStream::end(void)
+{
+    if (!this->running) {
+        return;
+    }
+    dac_dual_stream_stop();
+    this->callback = NULL;
+    this->running = false;
+}
+
+/*!
+    \brief      set both outputs in the same clock, ignored while a stream runs on either DAC
+    \param[in]  value0: 12-bit value of DAC0
+    \param[in]  value1: 12-bit value of DAC1
+    \param[out] none
+    \retval     none
+*/
+void DACDualStream::write(uint16_t value0, uint16_t value1)
+{
+    set_dac_dual_value(value0, value1);
+}
+
+/*!
+    \brief      check if the output is running
+    \param[in]  none
+    \param[out] none
+    \retval     true while running
+*/
+bool DACDualStream::isRunning(void)
+{
+    return this->running;
+}
+
+/*!
+    \brief      get the buffer index of the next pair to be sent
+    \param[in]  none
+    \param[out] none
+    \retval     index into the pair buffer
+*/
+size_t DACDualStream::bufferIndex(void)
+{
+    size_t remaining;
+
+    if (!this->running) {
+        return 0;
+    }
+    remaining = dac_dual_stream_remaining();
+    return (remaining == 0U) ? 0U : this->length - remaining;
+}
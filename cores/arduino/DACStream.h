@@ -0,0 +1,97 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef DACSTREAM_H
+#define DACSTREAM_H
+
+#include "analog.h"
+
+class HardwareTimer;
+
+/* buffer points at the half of the sample buffer that was just sent and may be refilled */
+typedef void(*dacStreamCallback_t)(uint16_t *buffer, size_t count);
+
+/* Outputs 12-bit samples on a DAC pin at the update rate of TIMER5 (or TIMER6 on GD32F30x),
+   DMA feeds the samples from a ring buffer without interrupts per sample. The DAC can add
+   noise or a triangle on top of the samples. Available on GD32F30x and GD32F3x0 */
+class DACStream
+{
+    public:
+        DACStream(uint32_t pin);                                                  //DACStream object construct
+        ~DACStream(void);                                                         //stop output
+        void setNoise(uint8_t bits);                                              //add noise of bits LSBs
+        void setTriangle(uint8_t bits);                                           //add triangle of 2^bits - 1
+        void clearWave(void);                                                     //output samples only
+        bool begin(HardwareTimer &timer, uint16_t *buffer, size_t length,
+                   dacStreamCallback_t callback = NULL);                          //stream buffer over and over
+        bool begin(HardwareTimer &timer, uint16_t value);                         //generate wave around value
+        void end(void);                                                           //stop output
+        bool isRunning(void);                                                     //check if output is running
+        size_t bufferIndex(void);                                                 //get index of the next sample
+
+    private:
+        static void dmaIrq(void *arg, uint32_t flags);
+        bool start(uint32_t timer, uint16_t *buffer, size_t length, uint16_t value,
+                   dacStreamCallback_t callback);
+        PinName pin;
+        uint8_t wave;
+        uint8_t waveBits;
+        uint16_t *buffer;
+        size_t length;
+        dacStreamCallback_t callback;
+        bool running;
+};
+
+/* buffer points at the half of the pair buffer that was just sent and may be refilled */
+typedef void(*dacDualStreamCallback_t)(uint32_t *buffer, size_t count);
+
+/* Outputs pairs of 12-bit samples on both DAC pins at the update rate of TIMER5 or TIMER6,
+   for I/Q signals or XY deflection. One DMA channel writes each pair, DAC_DUAL_SAMPLE(dac0,
+   dac1), to the concurrent data register and both converters take it on the same trigger, so
+   the channels never skew. write() sets both outputs at once without a timer. Available on
+   GD32F30x parts with two DACs */
+class DACDualStream
+{
+    public:
+        DACDualStream(void);                                                      //DACDualStream object construct
+        ~DACDualStream(void);                                                     //stop output
+        bool begin(HardwareTimer &timer, uint32_t *buffer, size_t length,
+                   dacDualStreamCallback_t callback = NULL);                      //stream pairs over and over
+        void end(void);                                                           //stop output
+        void write(uint16_t value0, uint16_t value1);                             //set both outputs at once
+        bool isRunning(void);                                                     //check if output is running
+        size_t bufferIndex(void);                                                 //get index of the next pair
+
+    private:
+        static void dmaIrq(void *arg, uint32_t flags);
+        uint32_t *buffer;
+        size_t length;
+        dacDualStreamCallback_t callback;
+        bool running;
+};
+
+#endif /* DACSTREAM_H */
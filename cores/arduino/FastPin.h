@@ -0,0 +1,154 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef FASTPIN_H
+#define FASTPIN_H
+
+#include "gd32xxyy.h"
+#include "gd32/PinNames.h"
+#include "gd32/PortNames.h"
+#include "gd32/pins_arduino.h"
+#include "api/Common.h"
+
+/* GPIOx base address of a port number, folds to a constant when the port is known at compile time */
+static constexpr uint32_t fastPinPort(uint32_t port)
+{
+    return
+#ifdef GPIOA
+        (port == 0U) ? GPIOA :
+#endif
+#ifdef GPIOB
+        (port == 1U) ? GPIOB :
+#endif
+#ifdef GPIOC
+        (port == 2U) ? GPIOC :
+#endif
+#ifdef GPIOD
+        (port == 3U) ? GPIOD :
+#endif
+#ifdef GPIOE
+        (port == 4U) ? GPIOE :
+#endif
+#ifdef GPIOF
+        (port == 5U) ? GPIOF :
+#endif
+#ifdef GPIOG
+        (port == 6U) ? GPIOG :
+#endif
+        0U;
+}
+
+/* A pin whose port and bit are resolved at compile time, e.g. FastPin<PORTA_5>::high().
+   Every write is a single store to the bit operation register, so it is atomic with respect to
+   interrupts touching other pins of the port. Set the pin up with pinMode() or mode() first */
+template<PinName pinname>
+class FastPin
+{
+    public:
+        static_assert(pinname != NC, "FastPin needs a real pin");
+        static_assert(fastPinPort(GD_PORT_GET(pinname)) != 0U, "FastPin port does not exist on this part");
+
+        static constexpr uint32_t port = fastPinPort(GD_PORT_GET(pinname));
+        static constexpr uint32_t mask = 1UL << GD_PIN_GET(pinname);
+
+        static inline __attribute__((always_inline)) void high(void)
+        {
+            GPIO_BOP(port) = mask;
+        }
+        static inline __attribute__((always_inline)) void low(void)
+        {
+            /* the upper half of the bit operation register clears */
+            GPIO_BOP(port) = mask << 16;
+        }
+        static inline __attribute__((always_inline)) void write(bool value)
+        {
+            GPIO_BOP(port) = value ? mask : (mask << 16);
+        }
+        static inline __attribute__((always_inline)) bool read(void)
+        {
+            return (GPIO_ISTAT(port) & mask) != 0U;
+        }
+        static inline __attribute__((always_inline)) void toggle(void)
+        {
+            port_toggle(port, mask);
+        }
+        static void mode(PinMode pinmode)
+        {
+            pinMode(PinName_to_digital(pinname), pinmode);
+        }
+};
+
+/* PinName of an Arduino pin number known at compile time, a build error if the board has no such pin */
+template<pin_size_t pin>
+static constexpr PinName fastPinName(void)
+{
+    static_assert(pin < DIGITAL_PINS_NUM, "not a digital pin of this board");
+    return digital_pins_const[pin];
+}
+
+/* FastPin by Arduino pin number, e.g. FastDigitalPin<PA5>::high() or FastDigitalPin<LED_BUILTIN> */
+template<pin_size_t pin>
+using FastDigitalPin = FastPin<fastPinName<pin>()>;
+
+/* portWrite()/portRead() with the port resolved at compile time, e.g. FastPort<PORTB>::write(0x00FF, data) */
+template<PortName portname>
+class FastPort
+{
+    public:
+        static_assert(fastPinPort(portname) != 0U, "FastPort port does not exist on this part");
+
+        static constexpr uint32_t port = fastPinPort(portname);
+
+        static inline __attribute__((always_inline)) void write(uint16_t mask, uint16_t value)
+        {
+            GPIO_BOP(port) = ((uint32_t)(~value & mask) << 16) | (uint32_t)(value & mask);
+        }
+        static inline __attribute__((always_inline)) uint16_t read(void)
+        {
+            return (uint16_t)GPIO_ISTAT(port);
+        }
+};
+
+/* Same as digitalWrite()/digitalRead()/digitalToggle() on a PinName, a single register access
+   when pinname is a constant. There is no check that pinname is valid */
+static inline __attribute__((always_inline)) void digitalWriteFast(PinName pinname, PinStatus status)
+{
+    GPIO_BOP(fastPinPort(GD_PORT_GET(pinname))) = (status != LOW) ? (1UL << GD_PIN_GET(pinname)) :
+                                                   (1UL << (GD_PIN_GET(pinname) + 16U));
+}
+
+static inline __attribute__((always_inline)) PinStatus digitalReadFast(PinName pinname)
+{
+    return (GPIO_ISTAT(fastPinPort(GD_PORT_GET(pinname))) & (1UL << GD_PIN_GET(pinname))) ? HIGH : LOW;
+}
+
+static inline __attribute__((always_inline)) void digitalToggleFast(PinName pinname)
+{
+    port_toggle(fastPinPort(GD_PORT_GET(pinname)), 1UL << GD_PIN_GET(pinname));
+}
+
+#endif /* FASTPIN_H */
@@ -0,0 +1,112 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef FIXEDPOOL_H
+#define FIXEDPOOL_H
+
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include "gd32/pool.h"
+
+/*
+ * N objects of type T in static storage, see gd32/pool.h. create() and
+ * destroy() construct and destruct in place and may be called from
+ * interrupts, as long as the constructor and destructor of T may.
+ *
+ *   static FixedPool<Message, 16> messages;
+ *   Message *m = messages.create(id, len);   // NULL when all 16 are in use
+ *   ...
+ *   messages.destroy(m);
+ */
+template <typename T, size_t N>
+class FixedPool {
+    public:
+        /* constant-initialized, so usable from other constructors of static objects */
+        constexpr FixedPool() : storage{}, pool{NULL, storage[0].object, sizeof(Block), N, 0U, 0U, 0U} {}
+
+        /* an object constructed from args, NULL if all N are in use */
+        template <typename... Args>
+        T *create(Args &&... args)
+        {
+            void *block = pool_alloc(&pool);
+
+            return (block != NULL) ? new (block) T(static_cast<Args &&>(args)...) : NULL;
+        }
+        /* destruct and give back an object of this pool, NULL is ignored */
+        void destroy(T *object)
+        {
+            if (object != NULL) {
+                object->~T();
+                pool_free(&pool, object);
+            }
+        }
+        /* raw blocks for T, for types constructed by the caller */
+        void *allocate(void)
+        {
+            return pool_alloc(&pool);
+        }
+        void deallocate(void *block)
+        {
+            pool_free(&pool, block);
+        }
+
+        /* objects handed out now */
+        size_t used(void) const
+        {
+            return pool_used(&pool);
+        }
+        size_t available(void) const
+        {
+            return N - pool_used(&pool);
+        }
+        /* create() calls that found the pool empty, for sizing N */
+        uint32_t misses(void) const
+        {
+            return pool.misses;
+        }
+        static constexpr size_t capacity(void)
+        {
+            return N;
+        }
+
+    private:
+        union Block {
+            pool_block_t link;                    //free list link while the block is free
+            alignas(T) uint8_t object[sizeof(T)]; //the object while it is in use
+        };
+        static_assert(N > 0 && N <= 0xFFFF, "FixedPool holds 1 to 65535 objects");
+        static_assert(sizeof(Block) <= 0xFFFF, "FixedPool objects must be smaller than 64 KiB");
+
+        Block storage[N];                         //the blocks
+        pool_t pool;                              //free list over storage
+
+        FixedPool(const FixedPool &) = delete;
+        FixedPool &operator=(const FixedPool &) = delete;
+};
+
+#endif /* FIXEDPOOL_H */
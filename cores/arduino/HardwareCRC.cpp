@@ -0,0 +1,134 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "HardwareCRC.h"
+
+/*!
+    \brief      HardwareCRC object construct
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+HardwareCRC::HardwareCRC(void)
+{
+    this->calc.width = 32;
+    this->calc.reflect = true;
+    this->calc.xor_out = 0xFFFFFFFF;
+    this->calc.pending = 0;
+}
+
+/*!
+    \brief      reset the CRC unit for a new calculation
+    \param[in]  polynomial: generator polynomial without the top bit
+    \param[in]  width: polynomial size, 7, 8, 16 or 32 bits
+    \param[in]  init: initial register value
+    \param[in]  reflect: true to process bytes least significant bit first and reverse the result
+    \param[in]  xorOut: value the result is XORed with
+    \param[out] none
+    \retval     false if the CRC unit of this series can't compute the CRC
+*/
+bool HardwareCRC::begin(uint32_t polynomial, uint8_t width, uint32_t init, bool reflect,
+                        uint32_t xorOut)
+{
+    return crc_calc_begin(&this->calc, polynomial, width, init, reflect, xorOut);
+}
+
+/*!
+    \brief      feed bytes into the calculation
+    \param[in]  data: the bytes
+    \param[in]  length: number of bytes
+    \param[out] none
+    \retval     none
+*/
+void HardwareCRC::update(const void *data, size_t length)
+{
+    crc_calc_update(&this->calc, data, length);
+}
+
+/*!
+    \brief      feed one byte into the calculation
+    \param[in]  data: the byte
+    \param[out] none
+    \retval     none
+*/
+void HardwareCRC::update(uint8_t data)
+{
+    crc_calc_update(&this->calc, &data, 1);
+}
+
+/*!
+    \brief      feed bytes into the calculation by DMA, the CPU is free meanwhile
+    \param[in]  data: the bytes, must stay valid until callback
+    \param[in]  length: number of bytes
+    \param[in]  callback: called from the DMA interrupt once all bytes went in
+    \param[in]  arg: passed through to callback
+    \param[out] none
+    \retval     false if this series can't feed the CRC unit by DMA or no DMA channel is idle,
+                update() has to be used then
+*/
+bool HardwareCRC::updateDMA(const void *data, size_t length, crc_callback_t callback, void *arg)
+{
+    return crc_calc_update_dma(&this->calc, data, length, callback, arg);
+}
+
+/*!
+    \brief      check if a DMA feed is running
+    \param[in]  none
+    \param[out] none
+    \retval     true until the callback of updateDMA() is called
+*/
+bool HardwareCRC::isBusy(void)
+{
+    return crc_calc_busy();
+}
+
+/*!
+    \brief      get the CRC of the bytes fed so far, waits for a DMA feed, more bytes can follow
+    \param[in]  none
+    \param[out] none
+    \retval     the CRC, in the low width bits
+*/
+uint32_t HardwareCRC::value(void)
+{
+    return crc_calc_value(&this->calc);
+}
+
+/*!
+    \brief      compute the CRC-32 of a buffer, as zlib's crc32() does
+    \param[in]  data: the bytes
+    \param[in]  length: number of bytes
+    \param[out] none
+    \retval     the CRC-32
+*/
+uint32_t HardwareCRC::crc32(const void *data, size_t length)
+{
+    HardwareCRC crc;
+
+    crc.begin();
+    crc.update(data, length);
+    return crc.value();
+}
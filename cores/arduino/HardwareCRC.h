@@ -0,0 +1,55 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef HARDWARECRC_H
+#define HARDWARECRC_H
+
+#include "gd32/crc.h"
+
+/* Computes CRCs with the CRC unit, by default the CRC-32 of zlib, Ethernet and PNG. Other
+   polynomials and sizes work on GD32F3x0, GD32E23x and GD32E50x, see crc.h for what each
+   series can do. There is one unit, so one calculation runs at a time */
+class HardwareCRC
+{
+    public:
+        HardwareCRC(void);                                                        //HardwareCRC object construct
+        bool begin(uint32_t polynomial = CRC32_POLYNOMIAL, uint8_t width = 32,
+                   uint32_t init = 0xFFFFFFFF, bool reflect = true,
+                   uint32_t xorOut = 0xFFFFFFFF);                                 //start a calculation
+        void update(const void *data, size_t length);                            //feed bytes
+        void update(uint8_t data);                                                //feed one byte
+        bool updateDMA(const void *data, size_t length, crc_callback_t callback = NULL,
+                       void *arg = NULL);                                         //feed bytes by DMA
+        bool isBusy(void);                                                        //check if DMA is feeding
+        uint32_t value(void);                                                     //get the CRC so far
+        static uint32_t crc32(const void *data, size_t length);                   //CRC-32 of a buffer
+
+    private:
+        crc_calc_t calc;
+};
+
+#endif /* HARDWARECRC_H */
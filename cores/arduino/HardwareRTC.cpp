@@ -26,6 +26,7 @@ OF SUCH DAMAGE.
 */
 
 #include "HardwareRTC.h"
+#include "gd32/deferred.h"
 #include <cstddef>
 
 HWRTC rtc;
@@ -60,9 +61,6 @@ HWRTC::HWRTC(void)
 */
 void HWRTC::getUTCTime(UTCTimeStruct *utcTime)
 {
-    utcTime->year    = UTCTime.year;
-    utcTime->month   = UTCTime.month;
-    utcTime->day     = UTCTime.day;
     rtc_getUTCTime(utcTime);
 }
 
@@ -89,6 +87,17 @@ uint32_t HWRTC::getSecTime(void)
     return rtc_getSecTime();
 }
 
+/*!
+    \brief      get second time with milliseconds
+    \param[in]  none
+    \param[out] ms: milliseconds into the current second
+    \retval     second counts
+*/
+uint32_t HWRTC::getSecTime(uint16_t *ms)
+{
+    return rtc_getSecTimeMs(ms);
+}
+
 /*!
     \brief      set second counts
     \param[in]  utcTime: point to UTC format time
@@ -124,28 +133,48 @@ void HWRTC::setAlarmTime(uint32_t offset, ALARM_OFFSET_FORMAT mode)
     rtc_setAlarmTime(rtc_getSecTime() + seconds);
 }
 
+/*!
+    \brief      set periodic wakeup
+    \param[in]  ms: period in milliseconds, 0 to stop
+    \param[out] none
+    \retval     the period used in milliseconds, see rtc_setWakeupPeriod()
+*/
+uint32_t HWRTC::setWakeupPeriod(uint32_t ms)
+{
+    return rtc_setWakeupPeriod(ms);
+}
+
 /*!
     \brief      attach interrupt
     \param[in]  callback: callback function
     \param[in]  mode: interrupt mode
+    \param[in]  deferred: queue the callback to run at thread level, see deferred.h
     \param[out] none
     \retval     none
 */
-void HWRTC::attachInterrupt(RTCCallback_t callback, INT_MODE mode)
+void HWRTC::attachInterrupt(RTCCallback_t callback, INT_MODE mode, bool deferred)
 {
     switch (mode) {
         case INT_SECOND_MODE:
             this->callback[0] = callback;
+            this->deferred[0] = deferred;
             rtc_attachInterrupt((INT_MODE)0);
             break;
         case INT_ALARM_MODE:
             this->callback[1] = callback;
+            this->deferred[1] = deferred;
             rtc_attachInterrupt((INT_MODE)1);
             break;
         case INT_OVERFLOW_MODE:
             this->callback[2] = callback;
+            this->deferred[2] = deferred;
             rtc_attachInterrupt((INT_MODE)2);
             break;
+        case INT_WAKEUP_MODE:
+            this->callback[3] = callback;
+            this->deferred[3] = deferred;
+            rtc_attachInterrupt((INT_MODE)3);
+            break;
     }
 }
 
@@ -170,6 +199,10 @@ void HWRTC::detachInterrupt(INT_MODE mode)
             rtc_detachInterrupt((INT_MODE)2);
             this->callback[2] = NULL;
             break;
+        case INT_WAKEUP_MODE:
+            rtc_detachInterrupt((INT_MODE)3);
+            this->callback[3] = NULL;
+            break;
     }
 }
 
@@ -184,17 +217,38 @@ void HWRTC::interruptHandler(INT_MODE mode)
     switch (mode) {
         case INT_SECOND_MODE:
             if (NULL != this->callback[0]) {
-                this->callback[0]();
+                if (this->deferred[0]) {
+                    deferred_post_call(this->callback[0]);
+                } else {
+                    this->callback[0]();
+                }
             }
             break;
         case INT_ALARM_MODE:
             if (NULL != this->callback[1]) {
-                this->callback[1]();
+                if (this->deferred[1]) {
+                    deferred_post_call(this->callback[1]);
+                } else {
+                    this->callback[1]();
+                }
             }
             break;
         case INT_OVERFLOW_MODE:
             if (NULL != this->callback[2]) {
-                this->callback[2]();
+                if (this->deferred[2]) {
+                    deferred_post_call(this->callback[2]);
+                } else {
+                    this->callback[2]();
+                }
+            }
+            break;
+        case INT_WAKEUP_MODE:
+            if (NULL != this->callback[3]) {
+                if (this->deferred[3]) {
+                    deferred_post_call(this->callback[3]);
+                } else {
+                    this->callback[3]();
+                }
             }
             break;
         default:
@@ -13,13 +13,17 @@ class HWRTC
         void getUTCTime(UTCTimeStruct *utcTime);                      //get UTC time from base time
         void setSecTime(uint32_t secTime);                            //set second time from base time
         uint32_t getSecTime(void);                                    //get second time from base time
+        uint32_t getSecTime(uint16_t *ms);                            //get second time and milliseconds
         void setAlarmTime(uint32_t offset, ALARM_OFFSET_FORMAT mode); //set alarm clock time base time
-        void attachInterrupt(RTCCallback_t callback, INT_MODE mode);  //attach RTC interrupt
+        uint32_t setWakeupPeriod(uint32_t ms);                        //INT_WAKEUP_MODE every ms, uses the alarm
+        void attachInterrupt(RTCCallback_t callback, INT_MODE mode,
+                             bool deferred = false);                  //attach RTC interrupt
         void detachInterrupt(INT_MODE mode);                          //detach RTC interrupt
         void interruptHandler(INT_MODE mode);
     private:
         UTCTimeStruct UTCTime;//time base
-        RTCCallback_t callback[3] = {0};
+        RTCCallback_t callback[4] = {0};
+        bool deferred[4] = {false, false, false, false};
 };
 
 #endif
@@ -23,8 +23,11 @@
 */
 
 #include <stdio.h>
+#include <string.h>
 #include "Arduino.h"
 #include "HardwareSerial.h"
+#include "gd32/os_event.h"
+#include "gd32/critical.h"
 //#if defined(HAVE_HWSERIAL) || defined(HAVE_HWSERIAL1) || defined(HAVE_HWSERIAL2) || defined(HAVE_HWSERIAL3)
 
 // SerialEvent functions are weak, so when the user doesn't define them,
@@ -36,14 +39,38 @@
 
 extern struct serial_s *obj_s_buf[UART_NUM];
 
+// Bit n is set by the receive interrupt of the port with index n whenever
+// data arrived, so serialEventRun() only looks at ports that got something.
+static volatile uint32_t serial_event_pending = 0;
+
+static void serial_event_set(uint32_t mask)
+{
+    uint32_t state = critical_enter();
+    serial_event_pending |= mask;
+    critical_exit(state);
+}
+
+static uint32_t serial_event_take(void)
+{
+    uint32_t state = critical_enter();
+    uint32_t pending = serial_event_pending;
+    serial_event_pending = 0;
+    critical_exit(state);
+    return pending;
+}
+
+uint32_t serialEventPending(void)
+{
+    return serial_event_pending;
+}
+
 int HardwareSerial::availableSerialN(unsigned n)
 {
     // copy of the HardwareSerial::available function but more direct.
     if (n >= UART_NUM)
         return 0;
     auto _serial = obj_s_buf[n];
-    return ((unsigned int)(SERIAL_RX_BUFFER_SIZE + _serial->rx_head - _serial->rx_tail)) %
-           SERIAL_RX_BUFFER_SIZE;
+    return (_serial->rx_head - _serial->rx_tail) & _serial->rx_mask;
 }
 
 #if defined(HAVE_HWSERIAL1)
@@ -71,7 +98,6 @@ bool Serial3_available()
 #endif
 
 #if defined(HAVE_HWSERIAL4)
-HardwareSerial Serial4(RX3, TX3, 3);
 void serialEvent4() __attribute__((weak));
 bool Serial4_available()
 {
@@ -80,7 +106,6 @@ bool Serial4_available()
 #endif
 
 #if defined(HAVE_HWSERIAL5)
-HardwareSerial Serial5(RX4, TX4, 4);
 void serialEvent5() __attribute__((weak));
 bool Serial5_available()
 {
@@ -91,45 +116,103 @@ bool Serial5_available()
 
 void serialEventRun(void)
 {
+    uint32_t pending = serial_event_take();
+    uint32_t again = 0;
+
+    if (pending == 0) {
+        return;
+    }
 #if defined(HAVE_HWSERIAL1)
-    if (serialEvent1 && Serial1_available()) {
+    if ((pending & (1UL << 0)) && serialEvent1 && Serial1_available()) {
         serialEvent1();
+        // not everything was read, call it again on the next loop()
+        if (Serial1_available()) {
+            again |= 1UL << 0;
+        }
     }
 #endif
 #if defined(HAVE_HWSERIAL2)
-    if (serialEvent2 && Serial2_available()) {
+    if ((pending & (1UL << 1)) && serialEvent2 && Serial2_available()) {
         serialEvent2();
+        // not everything was read, call it again on the next loop()
+        if (Serial2_available()) {
+            again |= 1UL << 1;
+        }
     }
 #endif
 #if defined(HAVE_HWSERIAL3)
-    if (serialEvent3 && Serial3_available()) {
+    if ((pending & (1UL << 2)) && serialEvent3 && Serial3_available()) {
         serialEvent3();
+        // not everything was read, call it again on the next loop()
+        if (Serial3_available()) {
+            again |= 1UL << 2;
+        }
     }
 #endif
 #if defined(HAVE_HWSERIAL4)
-    if (serialEvent4 && Serial4_available()) {
+    if ((pending & (1UL << 3)) && serialEvent4 && Serial4_available()) {
         serialEvent4();
+        // not everything was read, call it again on the next loop()
+        if (Serial4_available()) {
+            again |= 1UL << 3;
+        }
     }
 #endif
 #if defined(HAVE_HWSERIAL5)
-    if(serialEvent5 && Serial5_available()) {
+    if ((pending & (1UL << 4)) && serialEvent5 && Serial5_available()) {
         serialEvent5();
+        // not everything was read, call it again on the next loop()
+        if (Serial5_available()) {
+            again |= 1UL << 4;
+        }
     }
 #endif
+    if (again != 0) {
+        serial_event_set(again);
+    }
 }
 
-HardwareSerial::HardwareSerial(uint8_t rx, uint8_t tx, int uart_index)
+HardwareSerial::HardwareSerial(uint8_t rx, uint8_t tx, int uart_index,
+                               unsigned char *rx_buffer, uint16_t rx_size,
+                               unsigned char *tx_buffer, uint16_t tx_size)
 {
+    // keep only the highest set bit so the indices can wrap with a mask
+    while ((rx_size & (rx_size - 1)) != 0) {
+        rx_size &= rx_size - 1;
+    }
+    while ((tx_size & (tx_size - 1)) != 0) {
+        tx_size &= tx_size - 1;
+    }
     _serial.pin_rx = DIGITAL_TO_PINNAME(rx);
     _serial.pin_tx =  DIGITAL_TO_PINNAME(tx);
-    _serial.rx_buff = _rx_buffer;
+    _serial.rx_buff = rx_buffer;
+    _serial.rx_mask = rx_size - 1;
     _serial.rx_head = 0;
     _serial.rx_tail = 0;
-    _serial.tx_buff = _tx_buffer;
+    _serial.tx_buff = tx_buffer;
+    _serial.tx_mask = tx_size - 1;
     _serial.tx_head = 0;
     _serial.tx_tail = 0;
     _serial.tx_count = 0;
+    memset((void *)&_serial.stats, 0, sizeof(_serial.stats));
+    _serial.rx_delimiter = -1;
+    _serial.rx_scan = 0;
+    _serial.delimiter_callback = NULL;
+    _serial.rx_sink = NULL;
+    _serial.irq_level = 0;
+    _serial.tx_dma = NULL;
+    _serial.rx_dma = NULL;
     _serial.index = uart_index;
+    _tx_dma = false;
+    _rx_dma = false;
+    _tx_full_policy = SERIAL_TX_FULL_BLOCK;
+    _tx_dropped = 0;
+    _rts_pin = NC;
+    _cts_pin = NC;
+    _de_pin = NC;
+    _de_active_high = true;
+    _node_address = -1;
+    _auto_baud = false;
 }
 
 void HardwareSerial::begin(unsigned long baud, uint8_t config)
@@ -168,10 +251,24 @@ void HardwareSerial::begin(unsigned long baud, uint8_t config)
 
     serial_init(&_serial, _serial.pin_tx, _serial.pin_rx);
     serial_baud(&_serial, baud);
+    if (_auto_baud) {
+        serial_auto_baud(&_serial, 1);
+    }
     serial_format(&_serial, databits, parity, stopbits);
+    _flow_control_apply();
+    if (_de_pin != NC) {
+        serial_set_rs485(&_serial, _de_pin, _de_active_high);
+    }
+    if (_node_address >= 0) {
+        serial_set_address(&_serial, _node_address);
+    }
+    serial_set_char_match(&_serial, _serial.rx_delimiter);
+    if (_tx_dma) {
+        serial_tx_dma_config(&_serial, 1);
+    }
 
     uart_attach_rx_callback(&_serial, _rx_complete_irq);
-    serial_receive(&_serial, &_serial.rx_buff[_serial.rx_head], 1);
+    _rx_start();
     // only enable it after everything has been setup properly
     serial_enable(&_serial);
 }
@@ -188,8 +285,7 @@ void HardwareSerial::end()
 
 int HardwareSerial::available(void)
 {
-    return ((unsigned int)(SERIAL_RX_BUFFER_SIZE + _serial.rx_head - _serial.rx_tail)) %
-           SERIAL_RX_BUFFER_SIZE;
+    return (_serial.rx_head - _serial.rx_tail) & _serial.rx_mask;
 }
 int HardwareSerial::peek(void)
 {
@@ -209,18 +305,61 @@ int HardwareSerial::read(void)
         return -1;
     } else {
         c = _serial.rx_buff[_serial.rx_tail];
-        _serial.rx_tail = (rx_buffer_index_t)(_serial.rx_tail + 1) % SERIAL_RX_BUFFER_SIZE;
+        _serial.rx_tail = (_serial.rx_tail + 1) & _serial.rx_mask;
         return c;
     }
 }
 
+size_t HardwareSerial::read(uint8_t *buffer, size_t size)
+{
+    size_t count = 0;
+
+    // at most two chunks: up to the end of the ring, then from its start
+    while (count < size) {
+        uint16_t head = _serial.rx_head;
+        uint16_t tail = _serial.rx_tail;
+        if (head == tail) {
+            break;
+        }
+        size_t n = (head > tail) ? (size_t)(head - tail) : (size_t)(_serial.rx_mask + 1 - tail);
+        n = min(n, size - count);
+        memcpy(buffer + count, &_serial.rx_buff[tail], n);
+        _serial.rx_tail = (tail + n) & _serial.rx_mask;
+        count += n;
+    }
+    return count;
+}
+
+size_t HardwareSerial::peekSpan(const uint8_t **data)
+{
+    uint16_t head = _serial.rx_head;
+    uint16_t tail = _serial.rx_tail;
+
+    *data = &_serial.rx_buff[tail];
+    if (head >= tail) {
+        return head - tail;
+    }
+    return _serial.rx_mask + 1 - tail;
+}
+
+size_t HardwareSerial::consume(size_t n)
+{
+    size_t count = available();
+
+    if (n > count) {
+        n = count;
+    }
+    _serial.rx_tail = (_serial.rx_tail + n) & _serial.rx_mask;
+    return n;
+}
+
 int HardwareSerial::availableForWrite(void)
 {
-    tx_buffer_index_t head = _serial.tx_head;
-    tx_buffer_index_t tail = _serial.tx_tail;
+    uint16_t head = _serial.tx_head;
+    uint16_t tail = _serial.tx_tail;
 
     if (head >= tail) {
-        return SERIAL_TX_BUFFER_SIZE - 1 - head + tail;
+        return _serial.tx_mask - head + tail;
     }
     return tail - head - 1;
 }
@@ -236,30 +375,261 @@ void HardwareSerial::flush()
     //wait for transmit data to be sent
     while ((_serial.tx_head != _serial.tx_tail)) {
         // wait for transmit data to be sent
+        os_event_wait();
     }
     // Wait for transmission to complete
-    while ((_serial.tx_state & OP_STATE_BUSY) != 0);
+    while ((_serial.tx_state & OP_STATE_BUSY) != 0) {
+        os_event_wait();
+    }
 }
 
 size_t HardwareSerial::write(uint8_t c)
 {
     _written = true;
-    tx_buffer_index_t nextWrite = (_serial.tx_head + 1) % SERIAL_TX_BUFFER_SIZE;
+    uint16_t nextWrite = (_serial.tx_head + 1) & _serial.tx_mask;
+    if (_serial.tx_tail == nextWrite) {
+        if (_tx_full_policy == SERIAL_TX_FULL_DROP) {
+            _tx_dropped++;
+            return 1;
+        } else if (_tx_full_policy == SERIAL_TX_FULL_FAIL) {
+            return 0;
+        }
+    }
     while (_serial.tx_tail == nextWrite) {
+        os_event_wait();
     }   // Spin locks if we're about to overwrite the buffer. This continues once the data is sent
     _serial.tx_buff[_serial.tx_head] = c;
     _serial.tx_head = nextWrite;
 
-    _serial.tx_count++;
-
     if (!serial_tx_active(&_serial)) {
         uart_attach_tx_callback(&_serial, _tx_complete_irq);
-        serial_transmit(&_serial, &_serial.tx_buff[_serial.tx_tail], 1);
-
+        _tx_start(&_serial);
     }
     return 1;
 }
 
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    size_t written = 0;
+
+    _written = true;
+    while (written < size) {
+        uint16_t head = _serial.tx_head;
+        uint16_t tail = _serial.tx_tail;
+        // contiguous free space after head, one slot stays empty to tell a full ring from an empty one
+        size_t space;
+        if (head >= tail) {
+            space = _serial.tx_mask + 1 - head - ((tail == 0) ? 1 : 0);
+        } else {
+            space = tail - head - 1;
+        }
+        if (space == 0) {
+            if (_tx_full_policy == SERIAL_TX_FULL_DROP) {
+                _tx_dropped += size - written;
+                return size;
+            } else if (_tx_full_policy == SERIAL_TX_FULL_FAIL) {
+                break;
+            }
+            // Spin locks until the transmitter has made room
+            os_event_wait();
+            continue;
+        }
+        size_t n = min(space, size - written);
+        memcpy(&_serial.tx_buff[head], buffer + written, n);
+        _serial.tx_head = (head + n) & _serial.tx_mask;
+        written += n;
+
+        if (!serial_tx_active(&_serial)) {
+            uart_attach_tx_callback(&_serial, _tx_complete_irq);
+            _tx_start(&_serial);
+        }
+    }
+    return written;
+}
+
+bool HardwareSerial::setFlowControl(uint32_t rtsPin, uint32_t ctsPin)
+{
+    _rts_pin = DIGITAL_TO_PINNAME(rtsPin);
+    _cts_pin = DIGITAL_TO_PINNAME(ctsPin);
+    if (_serial.rx_state == OP_STATE_RESET) {
+        // not started yet, begin() applies it
+        return true;
+    }
+    return _flow_control_apply();
+}
+
+bool HardwareSerial::_flow_control_apply(void)
+{
+    FlowControl type;
+
+    if (_rts_pin != NC && _cts_pin != NC) {
+        type = FlowControlRTSCTS;
+    } else if (_rts_pin != NC) {
+        type = FlowControlRTS;
+    } else if (_cts_pin != NC) {
+        type = FlowControlCTS;
+    } else {
+        type = FlowControlNone;
+    }
+    return serial_set_flow_control(&_serial, type, _rts_pin, _cts_pin) != 0;
+}
+
+bool HardwareSerial::setRS485(uint32_t dePin, bool activeHigh)
+{
+    _de_pin = DIGITAL_TO_PINNAME(dePin);
+    _de_active_high = activeHigh;
+    if (_serial.tx_state == OP_STATE_RESET) {
+        // not started yet, begin() applies it
+        return true;
+    }
+    return (serial_set_rs485(&_serial, _de_pin, _de_active_high) != 0) == (_de_pin != NC);
+}
+
+void HardwareSerial::onDelimiter(char delimiter, void (*callback)(void))
+{
+    // stop matching before the callback changes, the receive interrupt reads both
+    _serial.rx_delimiter = -1;
+    _serial.delimiter_callback = callback;
+    _serial.rx_scan = _serial.rx_head;
+    if (callback != NULL) {
+        _serial.rx_delimiter = (uint8_t)delimiter;
+    }
+    if (_serial.rx_state != OP_STATE_RESET) {
+        serial_set_char_match(&_serial, _serial.rx_delimiter);
+    }
+}
+
+bool HardwareSerial::setNodeAddress(int address)
+{
+    bool ok;
+
+    if (address > SERIAL_ADDRESS_MAX) {
+        return false;
+    }
+    _node_address = (address < 0) ? -1 : address;
+    if (_serial.rx_state == OP_STATE_RESET) {
+        // not started yet, begin() applies it
+        return true;
+    }
+    // the word length only changes between characters
+    flush();
+    ok = serial_set_address(&_serial, _node_address) != 0;
+    if (!ok) {
+        _node_address = _serial.mp_address;
+    }
+    // the address register is shared with hardware character matching
+    serial_set_char_match(&_serial, _serial.rx_delimiter);
+    if (_tx_dma && (_node_address < 0)) {
+        serial_tx_dma_config(&_serial, 1);
+    }
+    return ok;
+}
+
+size_t HardwareSerial::writeFrame(uint8_t address, const uint8_t *buffer, size_t size)
+{
+    if (_serial.mp_address < 0) {
+        return 0;
+    }
+    // the address character must not overtake data still in the ring
+    flush();
+    _written = true;
+    serial_putc_address(&_serial, address, size != 0);
+    return write(buffer, size);
+}
+
+bool HardwareSerial::setAutoBaud(bool enable)
+{
+    _auto_baud = enable;
+    if (_serial.rx_state == OP_STATE_RESET) {
+        // not started yet, begin() applies it
+        return true;
+    }
+    return serial_auto_baud(&_serial, enable) != 0;
+}
+
+unsigned long HardwareSerial::detectedBaud(void)
+{
+    if (!_auto_baud || _serial.rx_state == OP_STATE_RESET) {
+        return 0;
+    }
+    return serial_auto_baud_result(&_serial);
+}
+
+serial_stats_t HardwareSerial::getStats(void)
+{
+    serial_stats_t stats;
+
+    memcpy(&stats, (const void *)&_serial.stats, sizeof(stats));
+    return stats;
+}
+
+void HardwareSerial::clearStats(void)
+{
+    memset((void *)&_serial.stats, 0, sizeof(_serial.stats));
+}
+
+bool HardwareSerial::setTxDMA(bool enable)
+{
+    _tx_dma = enable;
+    if (_serial.tx_state == OP_STATE_RESET) {
+        // not started yet, begin() applies it
+        return true;
+    }
+    flush();
+    return serial_tx_dma_config(&_serial, enable) == (enable ? 1 : 0);
+}
+
+bool HardwareSerial::setRxDMA(bool enable)
+{
+    _rx_dma = enable;
+    if (_serial.rx_state == OP_STATE_RESET) {
+        // not started yet, begin() applies it
+        return true;
+    }
+    serial_rx_dma_stop(&_serial);
+    _rx_start();
+    return (_serial.rx_dma != NULL) == enable;
+}
+
+void HardwareSerial::setRxSink(const rx_sink_t *sink)
+{
+    // the interrupt must not see the ring and the sink half switched
+    uint32_t state = critical_enter();
+    _serial.rx_sink = sink;
+    _serial.rx_tail = _serial.rx_head;
+    critical_exit(state);
+}
+
+void HardwareSerial::setInterruptPriority(uint8_t priority)
+{
+    serial_set_irq_priority(&_serial, priority);
+}
+
+void HardwareSerial::_rx_start(void)
+{
+    // circular DMA always starts writing at the beginning of the ring
+    if (_rx_dma && serial_rx_dma_start(&_serial, _serial.rx_buff, _serial.rx_mask + 1)) {
+        _serial.rx_tail = 0;
+        _serial.rx_scan = 0;
+        return;
+    }
+    if (!serial_rx_active(&_serial)) {
+        serial_receive(&_serial, &_serial.rx_buff[_serial.rx_head], 1);
+    }
+}
+
+void HardwareSerial::_tx_start(serial_t *obj)
+{
+    uint16_t tail = obj->tx_tail;
+    uint16_t head = obj->tx_head;
+    // hand everything up to the head to the UART, or up to the end of the ring if it wraps
+    size_t len = (head >= tail) ? (head - tail) : (obj->tx_mask + 1 - tail);
+
+    if (len != 0) {
+        serial_transmit(obj, &obj->tx_buff[tail], len);
+    }
+}
+
 void HardwareSerial::_rx_complete_irq(serial_t *obj)
 {
     // No Parity error, read byte and store it in the buffer if there is room
@@ -267,28 +637,94 @@ void HardwareSerial::_rx_complete_irq(serial_t *obj)
     if (obj == NULL) {
         return;
     }
+    if (obj->rx_dma != NULL) {
+        // circular DMA reception, uart.c already moved rx_head to the DMA write position
+        if (obj->rx_sink != NULL) {
+            _sink_drain(obj);
+        }
+        serial_event_set(1UL << obj->index);
+        _delimiter_scan(obj);
+        return;
+    }
     if (serial_rx_active(obj)) {
         return;
     }
     c = serial_getc(obj);
-    rx_buffer_index_t i = (unsigned int)(obj->rx_head + 1) % SERIAL_RX_BUFFER_SIZE;
-    if (i != obj->rx_tail) {
+    uint16_t i = (obj->rx_head + 1) & obj->rx_mask;
+    if (obj->rx_sink != NULL) {
+        if (obj->rx_sink->space(obj->rx_sink->arg) > 0) {
+            obj->rx_sink->write(obj->rx_sink->arg, &c, 1);
+        } else {
+            obj->stats.rx_dropped++;
+        }
+    } else if (i != obj->rx_tail) {
         obj->rx_buff[obj->rx_head] = c;
         obj->rx_head = i;
+        serial_event_set(1UL << obj->index);
+        uint16_t unread = (i - obj->rx_tail) & obj->rx_mask;
+        if (unread > obj->stats.rx_peak) {
+            obj->stats.rx_peak = unread;
+        }
+        // a dropped delimiter would announce a frame that is not in the ring
+        if (obj->rx_delimiter == c) {
+            obj->rx_scan = i;
+            obj->delimiter_callback();
+        }
+    } else {
+        obj->stats.rx_dropped++;
     }
     serial_receive(obj, &obj->rx_buff[obj->rx_head], 1);
 }
 
+// Pass what DMA wrote into the ring on to the sink
+void HardwareSerial::_sink_drain(serial_t *obj)
+{
+    uint16_t head = obj->rx_head;
+    uint16_t tail = obj->rx_tail;
+
+    while (tail != head) {
+        // up to the head, or up to the end of the ring if it wraps
+        size_t len = (head > tail) ? (head - tail) : (obj->rx_mask + 1 - tail);
+        size_t room = obj->rx_sink->space(obj->rx_sink->arg);
+        if (room < len) {
+            obj->rx_sink->write(obj->rx_sink->arg, &obj->rx_buff[tail], room);
+            obj->stats.rx_dropped += (head - tail - room) & obj->rx_mask;
+            break;
+        }
+        obj->rx_sink->write(obj->rx_sink->arg, &obj->rx_buff[tail], len);
+        tail = (tail + len) & obj->rx_mask;
+    }
+    obj->rx_tail = head;
+}
+
+void HardwareSerial::_delimiter_scan(serial_t *obj)
+{
+    uint16_t head = obj->rx_head;
+    uint16_t i = obj->rx_scan;
+
+    if (obj->rx_delimiter < 0) {
+        return;
+    }
+    // bytes DMA wrote since the last look
+    while (i != head) {
+        uint8_t c = obj->rx_buff[i];
+        i = (i + 1) & obj->rx_mask;
+        if (obj->rx_delimiter == c) {
+            obj->rx_scan = i;
+            obj->delimiter_callback();
+        }
+    }
+    obj->rx_scan = head;
+}
+
 void HardwareSerial::_tx_complete_irq(serial_t *obj)
 {
     if (obj == NULL) {
         return;
     }
-    obj->tx_tail = (obj->tx_tail + 1) % SERIAL_TX_BUFFER_SIZE;
-    if (obj->tx_head == obj->tx_tail) {
-    } else {
-        serial_transmit(obj, &obj->tx_buff[obj->tx_tail], 1);
-    }
+    obj->tx_tail = (obj->tx_tail + obj->tx_size) & obj->tx_mask;
+    _tx_start(obj);
+    os_event_signal();
 }
 
 
@@ -28,25 +28,29 @@
 
 #include "api/Stream.h"
 #include "uart.h"
+#include "Async.h"
 
 
 // Define constants and variables for buffering incoming serial data.  We're
 // using a ring buffer (I think), in which head is the index of the location
 // to which to write the next incoming character and tail is the index of the
 // location from which to read.
-// NOTE: a "power of 2" buffer size is reccomended to dramatically
-//       optimize all the modulo operations for ring buffers.
-// WARNING: When buffer sizes are increased to > 256, the buffer index
-// variables are automatically increased in size, but the extra
-// atomicity guards needed for that are not implemented. This will
-// often work, but occasionally a race condition can occur that makes
-// Serial behave erratically. See https://github.com/arduino/Arduino/issues/2405
+// Buffer sizes must be a power of 2 (up to 32768) so that the ring indices
+// can be wrapped with a mask. Each SerialN instance can be sized on its own
+// with SERIALn_RX_BUFFER_SIZE/SERIALn_TX_BUFFER_SIZE, which default to
+// SERIAL_RX_BUFFER_SIZE/SERIAL_TX_BUFFER_SIZE. The minimal core profile
+// starts them at 16 bytes for the 4 KB RAM parts.
 
+#if defined(GD32_CORE_MINIMAL)
+#define SERIAL_DEFAULT_BUFFER_SIZE 16
+#else
+#define SERIAL_DEFAULT_BUFFER_SIZE 64
+#endif
 #if !defined(SERIAL_TX_BUFFER_SIZE)
-#define SERIAL_TX_BUFFER_SIZE 64
+#define SERIAL_TX_BUFFER_SIZE SERIAL_DEFAULT_BUFFER_SIZE
 #endif
 #if !defined(SERIAL_RX_BUFFER_SIZE)
-#define SERIAL_RX_BUFFER_SIZE 64
+#define SERIAL_RX_BUFFER_SIZE SERIAL_DEFAULT_BUFFER_SIZE
 #endif
 #if (SERIAL_TX_BUFFER_SIZE>256)
 typedef uint16_t tx_buffer_index_t;
@@ -59,6 +63,37 @@ typedef uint16_t rx_buffer_index_t;
 typedef uint8_t rx_buffer_index_t;
 #endif
 
+#if !defined(SERIAL1_RX_BUFFER_SIZE)
+#define SERIAL1_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL1_TX_BUFFER_SIZE)
+#define SERIAL1_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL2_RX_BUFFER_SIZE)
+#define SERIAL2_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL2_TX_BUFFER_SIZE)
+#define SERIAL2_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL3_RX_BUFFER_SIZE)
+#define SERIAL3_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL3_TX_BUFFER_SIZE)
+#define SERIAL3_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL4_RX_BUFFER_SIZE)
+#define SERIAL4_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL4_TX_BUFFER_SIZE)
+#define SERIAL4_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL5_RX_BUFFER_SIZE)
+#define SERIAL5_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL5_TX_BUFFER_SIZE)
+#define SERIAL5_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+
 
 typedef struct {
     unsigned char buffer[SERIAL_RX_BUFFER_SIZE];
@@ -83,20 +118,50 @@ typedef struct {
 #define SERIAL_7O2 0x3C
 #define SERIAL_8O2 0x3E
 
+// Pin number that disables a flow control line in setFlowControl()
+#define SERIAL_NO_FLOW_PIN 0xFFFFFFFFU
+
+// What write() does when the TX ring is full, see setTxFullPolicy()
+typedef enum {
+    SERIAL_TX_FULL_BLOCK,   // wait until the transmitter has made room (default)
+    SERIAL_TX_FULL_DROP,    // discard what does not fit, count it, report it as written
+    SERIAL_TX_FULL_FAIL     // discard what does not fit and return the number actually queued
+} SerialTxFullPolicy;
+
+#if ASYNC_COROUTINES
+class AsyncSerialRead;
+#endif
+
 class HardwareSerial : public Stream
 {
     protected:
         // Has any byte been written to the UART since begin()
         volatile bool _written;
-        // Don't put any members after these buffers, since only the first
-        // 32 bytes of this struct can be accessed quickly using the ldd
-        // instruction.
-        unsigned char _rx_buffer[SERIAL_RX_BUFFER_SIZE];
-        unsigned char _tx_buffer[SERIAL_TX_BUFFER_SIZE];
+        SerialTxFullPolicy _tx_full_policy;
+        // Bytes discarded under SERIAL_TX_FULL_DROP
+        volatile uint32_t _tx_dropped;
+        // Hardware flow control pins, NC when unused, see setFlowControl()
+        PinName _rts_pin;
+        PinName _cts_pin;
+        // Detect the baud rate from the first received character, see setAutoBaud()
+        bool _auto_baud;
+        // RS-485 driver enable pin, NC when unused, see setRS485()
+        PinName _de_pin;
+        bool _de_active_high;
+        // Multiprocessor node address, -1 when unused, see setNodeAddress()
+        int16_t _node_address;
+        // Transmit/receive through DMA, see setTxDMA()/setRxDMA()
+        bool _tx_dma;
+        bool _rx_dma;
         serial_t _serial;
 
     public:
-        HardwareSerial(uint8_t rx, uint8_t tx, int uart_index);
+        // The ring buffers are supplied by the caller, see HardwareSerialBuffered
+        // for an instance that carries its own. Sizes are rounded down to a
+        // power of 2.
+        HardwareSerial(uint8_t rx, uint8_t tx, int uart_index,
+                       unsigned char *rx_buffer, uint16_t rx_size,
+                       unsigned char *tx_buffer, uint16_t tx_size);
         void begin(unsigned long baud)
         {
             begin(baud, SERIAL_8N1);
@@ -106,9 +171,26 @@ class HardwareSerial : public Stream
         virtual int available(void);
         virtual int peek(void);
         virtual int read(void);
+        // Copy up to size already received bytes, returns the number copied (does not wait)
+        size_t read(uint8_t *buffer, size_t size);
+        // Point *data at the oldest unread byte and return how many bytes follow
+        // it contiguously in the RX ring (0 if none). The bytes stay in the ring
+        // until consume() is called; a second call after consume() returns the
+        // part that wrapped to the start of the ring.
+        virtual size_t peekSpan(const uint8_t **data);
+        // Drop up to n unread bytes, returns the number dropped
+        virtual size_t consume(size_t n);
+#if ASYNC_COROUTINES
+        // co_await readAsync(buffer, size) lets the other tasks run until
+        // size bytes have arrived, or timeout ms have passed without the
+        // buffer filling (0 waits for ever), and gives the number read. See
+        // Async.h.
+        AsyncSerialRead readAsync(uint8_t *buffer, size_t size, uint32_t timeout = 0);
+#endif
         int availableForWrite(void);
         virtual void flush(void);
         virtual size_t write(uint8_t);
+        virtual size_t write(const uint8_t *buffer, size_t size);
         inline size_t write(unsigned long n)
         {
             return write((uint8_t)n);
@@ -131,9 +213,105 @@ class HardwareSerial : public Stream
             return true;
         }
 
+        // Choose whether write() waits for room in the TX ring or returns at once
+        void setTxFullPolicy(SerialTxFullPolicy policy)
+        {
+            _tx_full_policy = policy;
+        }
+        uint32_t txDroppedCount(void)
+        {
+            return _tx_dropped;
+        }
+        void clearTxDroppedCount(void)
+        {
+            _tx_dropped = 0;
+        }
+
+        // Enable hardware flow control on the RTS and/or CTS pin of this USART
+        // (see PinMap_UART_RTS/PinMap_UART_CTS of the variant). Pass an invalid
+        // pin number, e.g. SERIAL_NO_FLOW_PIN, to leave that line unused. Can be
+        // called before or after begin(); returns false when called after begin()
+        // with a pin that does not belong to this USART.
+        bool setFlowControl(uint32_t rtsPin, uint32_t ctsPin = SERIAL_NO_FLOW_PIN);
+
+        // Drive the DE pin of an RS-485 transceiver: asserted while characters
+        // are sent, released from the transmission complete interrupt, so
+        // flush() is not needed to turn the bus around. The USART drives it
+        // in hardware on GD32F3x0/F1x0/E23x when dePin is its RTS pin. Pass
+        // SERIAL_NO_FLOW_PIN to stop. Can be called before or after begin().
+        bool setRS485(uint32_t dePin, bool activeHigh = true);
+
+        // Call callback from the receive interrupt once for every received
+        // delimiter character (e.g. '\n', or 0x00 for COBS), so a complete
+        // frame can be handled without polling available(). On GD32F3x0/F1x0/
+        // E23x the USART matches the character in hardware, which also wakes
+        // up DMA reception at once. Pass a NULL callback to stop.
+        void onDelimiter(char delimiter, void (*callback)(void));
+
+        // Share a multi-drop (RS-485) bus by address: frames become 8 data
+        // bits plus a 9th bit marking address characters, and the receiver
+        // stays muted, raising no interrupt at all, until an address character
+        // for this node arrives. It is received as the first byte of the
+        // frame, followed by the data up to the next address character for
+        // another node. Needs an 8N1 or 8N2 format. The address goes up to
+        // SERIAL_ADDRESS_MAX: 255, but only 15 on GD32F30x/E50x, which compare
+        // the low 4 bits. On GD32F3x0/F1x0/E23x onDelimiter() falls back to
+        // matching in software, and transmission stays interrupt driven. Pass
+        // -1 to stop. Can be called before or after begin().
+        bool setNodeAddress(int address);
+        // Send a frame to the node at address: its address character, then
+        // size bytes of data. Waits for what was queued before; returns the
+        // data bytes queued, 0 unless setNodeAddress() is in effect.
+        size_t writeFrame(uint8_t address, const uint8_t *buffer, size_t size);
+
+        // Measure the baud rate on the start bit of the next received
+        // character (its LSB must be 1) and switch to it. Only USART0 of
+        // GD32F3x0/E23x has the detector; returns false elsewhere once begin()
+        // has been called. Baud rates above clock / 16 are generated with 8x
+        // oversampling automatically where the USART supports it.
+        bool setAutoBaud(bool enable = true);
+        // The detected baud rate, 0 until a character has been measured
+        unsigned long detectedBaud(void);
+
+        // Counters of this port since construction or the last clearStats()
+        serial_stats_t getStats(void);
+        void clearStats(void);
+
+        // Feed the transmitter from the TX ring by DMA instead of one interrupt
+        // per character. Can be called before or after begin(); when called after
+        // begin() it returns false if this UART has no DMA request line (e.g.
+        // UART4 on GD32F30x) and the port stays interrupt driven.
+        bool setTxDMA(bool enable = true);
+        // Receive into the RX ring through a circular DMA channel; rx_head is
+        // advanced on the IDLE line and DMA half/full interrupts. Unread data
+        // is overwritten instead of dropped when the ring overflows. Switching
+        // after begin() discards unread data.
+        bool setRxDMA(bool enable = true);
+
+        // Hand received bytes to sink from the receive interrupt instead of
+        // the RX ring, e.g. straight into an RTOS stream buffer, so a task
+        // can wait on that rather than poll available(). Bytes the sink has
+        // no room for are dropped and counted in rx_dropped. The sink must
+        // stay valid until it is replaced; pass NULL to go back to the ring.
+        void setRxSink(const rx_sink_t *sink);
+        // Run this port's interrupts at no more urgent a priority than
+        // priority (8 bit, as written to BASEPRI), e.g. so a sink may call
+        // into an RTOS.
+        void setInterruptPriority(uint8_t priority);
+        // The receive pin, e.g. to wake up from deep-sleep on a start bit
+        PinName getRxPin(void)
+        {
+            return _serial.pin_rx;
+        }
+
         // Interrupt handlers
         static void _rx_complete_irq(serial_t *obj);
         static void _tx_complete_irq(serial_t *obj);
+        static void _tx_start(serial_t *obj);
+        void _rx_start(void);
+        static void _delimiter_scan(serial_t *obj);
+        static void _sink_drain(serial_t *obj);
+        bool _flow_control_apply(void);
 
         // helper func for linker
         static int availableSerialN(unsigned n);
@@ -142,6 +320,62 @@ class HardwareSerial : public Stream
 
 };
 
+#if ASYNC_COROUTINES
+// Awaitable of HardwareSerial::readAsync(), the receive ring is drained
+// into the buffer from Async.poll()
+class AsyncSerialRead : public AsyncPoll<AsyncSerialRead>
+{
+    public:
+        AsyncSerialRead(HardwareSerial *serial, uint8_t *buffer, size_t size, uint32_t timeout)
+            : serial(serial), buffer(buffer), size(size), count(0), timeout(timeout), start(millis())
+        {
+        }
+        bool ready(void)
+        {
+            count += serial->read(buffer + count, size - count);
+            return (count == size) || ((timeout != 0) && ((millis() - start) >= timeout));
+        }
+        size_t value(void)
+        {
+            return count;
+        }
+
+    private:
+        HardwareSerial *serial;
+        uint8_t *buffer;
+        size_t size;
+        size_t count;
+        uint32_t timeout;
+        uint32_t start;
+};
+
+inline AsyncSerialRead HardwareSerial::readAsync(uint8_t *buffer, size_t size, uint32_t timeout)
+{
+    return AsyncSerialRead(this, buffer, size, timeout);
+}
+#endif
+
+// A HardwareSerial with its own RX_SIZE/TX_SIZE byte ring buffers, e.g.
+// HardwareSerialBuffered<1024, 64> Pipe(PA3, PA2, 1);
+template <size_t RX_SIZE, size_t TX_SIZE>
+class HardwareSerialBuffered : public HardwareSerial
+{
+        static_assert(RX_SIZE >= 2 && RX_SIZE <= 32768 && (RX_SIZE & (RX_SIZE - 1)) == 0,
+                      "serial RX buffer size must be a power of 2 between 2 and 32768");
+        static_assert(TX_SIZE >= 2 && TX_SIZE <= 32768 && (TX_SIZE & (TX_SIZE - 1)) == 0,
+                      "serial TX buffer size must be a power of 2 between 2 and 32768");
+
+    public:
+        HardwareSerialBuffered(uint8_t rx, uint8_t tx, int uart_index)
+            : HardwareSerial(rx, tx, uart_index, _rx_storage, RX_SIZE, _tx_storage, TX_SIZE)
+        {
+        }
+
+    private:
+        unsigned char _rx_storage[RX_SIZE];
+        unsigned char _tx_storage[TX_SIZE];
+};
+
 /*
  * ‘Serial’ is for the CDC-ACM if enabled. Hardware serial peripherals begin at
  * ‘Serial1’.
@@ -169,24 +403,28 @@ class HardwareSerial : public Stream
 #endif /* USBD_USE_CDC */
 
 #if defined(HAVE_HWSERIAL1)
-extern HardwareSerial Serial1;
+extern HardwareSerialBuffered<SERIAL1_RX_BUFFER_SIZE, SERIAL1_TX_BUFFER_SIZE> Serial1;
 #endif
 
 #if defined(HAVE_HWSERIAL2)
-extern HardwareSerial Serial2;
+extern HardwareSerialBuffered<SERIAL2_RX_BUFFER_SIZE, SERIAL2_TX_BUFFER_SIZE> Serial2;
 #endif
 
 #if defined(HAVE_HWSERIAL3)
-extern HardwareSerial Serial3;
+extern HardwareSerialBuffered<SERIAL3_RX_BUFFER_SIZE, SERIAL3_TX_BUFFER_SIZE> Serial3;
 #endif
 
 #if defined(HAVE_HWSERIAL4)
-extern HardwareSerial Serial4;
+extern HardwareSerialBuffered<SERIAL4_RX_BUFFER_SIZE, SERIAL4_TX_BUFFER_SIZE> Serial4;
 #endif
 
 #if defined(HAVE_HWSERIAL5)
-extern HardwareSerial Serial5;
+extern HardwareSerialBuffered<SERIAL5_RX_BUFFER_SIZE, SERIAL5_TX_BUFFER_SIZE> Serial5;
 #endif
 
 extern void serialEventRun(void) __attribute__((weak));
+// Bitmask of the ports (bit n is UART index n) that received data which
+// serialEventRun() has not dispatched yet. loop() can sleep while it is 0:
+//   if (!serialEventPending()) __WFI();
+extern uint32_t serialEventPending(void);
 #endif
@@ -6,5 +6,5 @@
 // otherwise we pay the RAM for *all* serial objects.
 
 #if defined(HAVE_HWSERIAL1)
-HardwareSerial Serial1(RX0, TX0, 0);
+HardwareSerialBuffered<SERIAL1_RX_BUFFER_SIZE, SERIAL1_TX_BUFFER_SIZE> Serial1(RX0, TX0, 0);
 #endif
\ No newline at end of file
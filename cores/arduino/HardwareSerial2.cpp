@@ -6,5 +6,5 @@
 // otherwise we pay the RAM for *all* serial objects.
 
 #if defined(HAVE_HWSERIAL2)
-HardwareSerial Serial2(RX1, TX1, 1);
+HardwareSerialBuffered<SERIAL2_RX_BUFFER_SIZE, SERIAL2_TX_BUFFER_SIZE> Serial2(RX1, TX1, 1);
 #endif
\ No newline at end of file
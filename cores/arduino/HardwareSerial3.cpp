@@ -6,5 +6,5 @@
 // otherwise we pay the RAM for *all* serial objects.
 
 #if defined(HAVE_HWSERIAL3)
-HardwareSerial Serial3(RX2, TX2, 2);
+HardwareSerialBuffered<SERIAL3_RX_BUFFER_SIZE, SERIAL3_TX_BUFFER_SIZE> Serial3(RX2, TX2, 2);
 #endif
\ No newline at end of file
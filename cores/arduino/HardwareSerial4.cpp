@@ -6,5 +6,5 @@
 // otherwise we pay the RAM for *all* serial objects.
 
 #if defined(HAVE_HWSERIAL4)
-HardwareSerial Serial4(RX3, TX3, 3);
+HardwareSerialBuffered<SERIAL4_RX_BUFFER_SIZE, SERIAL4_TX_BUFFER_SIZE> Serial4(RX3, TX3, 3);
 #endif
\ No newline at end of file
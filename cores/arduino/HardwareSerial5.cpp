@@ -6,5 +6,5 @@
 // otherwise we pay the RAM for *all* serial objects.
 
 #if defined(HAVE_HWSERIAL5)
-HardwareSerial Serial5(RX4, TX4, 4);
+HardwareSerialBuffered<SERIAL5_RX_BUFFER_SIZE, SERIAL5_TX_BUFFER_SIZE> Serial5(RX4, TX4, 4);
 #endif
\ No newline at end of file
@@ -26,11 +26,50 @@ OF SUCH DAMAGE.
 */
 
 #include "HardwareTimer.h"
+#include "gd32/deferred.h"
+#include "gd32/critical.h"
+#include "gd32/clock.h"
 #include "pins_arduino.h"
 #define TIMERNUMS   17
 
 HardwareTimer *hardwaretimerObj[TIMERNUMS] = {NULL};
 
+/*!
+    \brief      timer interrupt callback, routes a source to the owning HardwareTimer
+    \param[in]  arg: the HardwareTimer object
+    \param[in]  source: TIMER_IRQ_SOURCE_UP or TIMER_IRQ_SOURCE_CH(x)(x=0..3)
+    \param[out] none
+    \retval     none
+*/
+static void hardwareTimerIrq(void *arg, uint8_t source)
+{
+    HardwareTimer *timer = (HardwareTimer *)arg;
+
+    if (TIMER_IRQ_SOURCE_UP == source) {
+        timer->periodCallback();
+    } else {
+        timer->captureCallback(source - TIMER_IRQ_SOURCE_CH(0));
+    }
+}
+
+/*!
+    \brief      recompute the periods set in time units after the system clock changed
+    \param[in]  arg: unused
+    \param[out] none
+    \retval     none
+*/
+static void hardwareTimerClockChanged(void *arg)
+{
+    (void)arg;
+    for (uint8_t index = 0; index < TIMERNUMS; index++) {
+        if (hardwaretimerObj[index]) {
+            hardwaretimerObj[index]->clockChanged();
+        }
+    }
+}
+
+static clock_listener_t hardwareTimerClockListener = { hardwareTimerClockChanged, NULL, NULL };
+
 /*!
     \brief      HardwareTimer object construct
     \param[in]  instance: TIMERx(x=0..13)
@@ -44,9 +83,13 @@ HardwareTimer::HardwareTimer(uint32_t instance)
     this->timerDevice = instance;
     this->updateCallback = NULL;
     this->isTimerActive = false;
+    this->isEncoderActive = false;
+    this->encoderHigh = 0;
     this->timerPeriod.time = 1;
     this->timerPeriod.format = FORMAT_MS;
+    this->periodFromTime = true;
     timerHandle.init(timerDevice, &timerPeriod);
+    clock_listener_add(&hardwareTimerClockListener);
 }
 
 /*!
@@ -75,23 +118,26 @@ void HardwareTimer::stop(void)
 
 /*!
     \brief      set prescaler
-    \param[in]  prescaler: prescaler value
+    \param[in]  prescaler: prescaler value, 1..65536
     \param[out] none
     \retval     none
 */
-void HardwareTimer::setPrescaler(uint16_t prescaler)
+void HardwareTimer::setPrescaler(uint32_t prescaler)
 {
+    this->periodFromTime = false;
+    Timer_wake(timerDevice);
     timer_prescaler_config(timerDevice, prescaler - 1, TIMER_PSC_RELOAD_NOW);
 }
 
 /*!
     \brief      set counter
-    \param[in]  count: counter value
+    \param[in]  count: counter value, up to getMaxCount() + 1
     \param[out] none
     \retval     none
 */
-void HardwareTimer::setCounter(uint16_t count)
+void HardwareTimer::setCounter(uint32_t count)
 {
+    Timer_wake(timerDevice);
     timer_counter_value_config(timerDevice, count - 1);
 }
 
@@ -103,6 +149,7 @@ void HardwareTimer::setCounter(uint16_t count)
 */
 void HardwareTimer::setrRpetitionValue(uint16_t repetition)
 {
+    Timer_wake(timerDevice);
     timer_repetition_value_config(timerDevice, repetition - 1);
 }
 
@@ -117,9 +164,27 @@ void HardwareTimer::setPeriodTime(uint32_t time, enum timeFormat format)
 {
     this->timerPeriod.time = time;
     this->timerPeriod.format = format;
+    this->periodFromTime = (format != FORMAT_TICK);
     timerHandle.setPeriodTime(timerDevice, &timerPeriod);
 }
 
+/*!
+    \brief      reprogram a period given in time units for the new timer clock
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void HardwareTimer::clockChanged(void)
+{
+    if (this->periodFromTime && !this->isEncoderActive) {
+        timerHandle.setPeriodTime(timerDevice, &timerPeriod);
+    }
+    if (this->pwmInputChannel != 0xFF) {
+        /* the captures keep counting in ticks of the new clock */
+        this->pwmInputHz = getTimerClkFrequency(timerDevice) / (TIMER_PSC(timerDevice) + 1U);
+    }
+}
+
 /*!
     \brief      set timer period with the inital format
     \param[in]  value: period time
@@ -128,6 +193,8 @@ void HardwareTimer::setPeriodTime(uint32_t time, enum timeFormat format)
 */
 void HardwareTimer::setReloadValue(uint32_t value)
 {
+    this->periodFromTime = false;
+    Timer_wake(timerDevice);
     timer_autoreload_value_config(timerDevice, value - 1);
 }
 
@@ -145,16 +212,27 @@ void HardwareTimer::refresh(void)
 /*!
     \brief      attach callback for period interrupt
     \param[in]  callback: callback function
+    \param[in]  channel: capture channel 0..3, or 0xFF for the period interrupt
+    \param[in]  deferred: queue the callback to run at thread level, see deferred.h
     \param[out] none
     \retval     none
 */
-void HardwareTimer::attachInterrupt(timerCallback_t callback, uint8_t channel)
+void HardwareTimer::attachInterrupt(timerCallback_t callback, uint8_t channel, bool deferred)
 {
+    uint8_t bit = (channel < 4) ? (1U << channel) : TIMER_DEFERRED_UPDATE;
+
+    if (deferred) {
+        this->deferredCallbacks |= bit;
+    } else {
+        this->deferredCallbacks &= ~bit;
+    }
     if (channel < 4) {
         this->captureCallbacks[channel] = callback;
+        Timer_attachIrqCallback(timerDevice, TIMER_IRQ_SOURCE_CH(channel), hardwareTimerIrq, this);
         timerHandle.enableCaptureIT(timerDevice, channel);
     } else if (0xFF == channel) {
         this->updateCallback = callback;
+        Timer_attachIrqCallback(timerDevice, TIMER_IRQ_SOURCE_UP, hardwareTimerIrq, this);
         timerHandle.enableUpdateIT(timerDevice);
     }
 }
@@ -170,31 +248,49 @@ void HardwareTimer::detachInterrupt(uint8_t channel)
     if (channel < 4) {
         this->captureCallbacks[channel] = NULL;
         timerHandle.disableCaptureIT(timerDevice, channel);
+        Timer_detachIrqCallback(timerDevice, TIMER_IRQ_SOURCE_CH(channel));
     } else if (0xFF == channel) {
         this->updateCallback = NULL;
-        timerHandle.disableUpdateIT(timerDevice);
+        /* encoder mode needs the update interrupt to extend the count */
+        if (!this->isEncoderActive) {
+            timerHandle.disableUpdateIT(timerDevice);
+            Timer_detachIrqCallback(timerDevice, TIMER_IRQ_SOURCE_UP);
+        }
     }
 }
 
-void HardwareTimer::setCaptureMode(uint32_t ulpin, uint8_t channel, captureMode mode)
+/*!
+    \brief      route a timer channel pin as capture input
+    \param[in]  ulpin: pin of the timer channel
+    \param[out] none
+    \retval     none
+*/
+void captureInputPinInit(uint32_t ulpin)
 {
-    timer_ic_parameter_struct timer_icinitpara;
-
     PinName pinname = DIGITAL_TO_PINNAME(ulpin);
+#if defined(GD32F30x) || defined(GD32F10x) || defined(GD32E50X)
     uint32_t function = pinmap_find_function(pinname, PinMap_PWM);
     uint32_t remap  = GD_PIN_REMAP_GET(function);
     uint32_t port = gpio_port[GD_PORT_GET(pinname)];
     uint32_t pin = gpio_pin[GD_PIN_GET(pinname)];
     gpio_clock_enable(GD_PORT_GET(pinname));
-#if defined(GD32F30x)
     rcu_periph_clock_enable(RCU_AF);
     gpio_init(port, GPIO_MODE_IN_FLOATING, GPIO_OSPEED_50MHZ, pin);
+    pinmode_configured[GD_PORT_GET(pinname)] &= ~pin;
     if (0 != remap) {
         gpio_pin_remap_config(GD_GPIO_REMAP[remap], ENABLE);
     }
-#elif defined(GD32F3x0) || defined(GD32F1x0)
-    /* !!TODO!! */
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+    /* the alternate function of a timer channel pin serves capture as well */
+    pinmap_pinout(pinname, PinMap_PWM);
 #endif
+}
+
+void HardwareTimer::setCaptureMode(uint32_t ulpin, uint8_t channel, captureMode mode)
+{
+    timer_ic_parameter_struct timer_icinitpara;
+
+    captureInputPinInit(ulpin);
 
     switch (mode) {
         case RISING_EDGE:
@@ -213,6 +309,7 @@ void HardwareTimer::setCaptureMode(uint32_t ulpin, uint8_t channel, captureMode
     timer_icinitpara.icselection = TIMER_IC_SELECTION_DIRECTTI;
     timer_icinitpara.icprescaler = TIMER_IC_PSC_DIV1;
     timer_icinitpara.icfilter    = 0x0;
+    Timer_wake(timerDevice);
     timer_input_capture_config(timerDevice, channel, &timer_icinitpara);
     timer_auto_reload_shadow_enable(timerDevice);
 }
@@ -233,53 +330,540 @@ uint32_t HardwareTimer::getTimerClkFre(void)
 }
 
 /*!
-    \brief      period callback handler
+    \brief      get counter value
     \param[in]  none
     \param[out] none
+    \retval     counter value
+*/
+uint32_t HardwareTimer::getCounter(void)
+{
+    return timer_counter_read(timerDevice);
+}
+
+/*!
+    \brief      get the largest counter value
+    \param[in]  none
+    \param[out] none
+    \retval     0xFFFFFFFF for TIMER1 where it counts in 32 bits, 0xFFFF otherwise
+*/
+uint32_t HardwareTimer::getMaxCount(void)
+{
+    return Timer_maxCount(timerDevice);
+}
+
+/*!
+    \brief      get the timer peripheral
+    \param[in]  none
+    \param[out] none
+    \retval     TIMERx
+*/
+uint32_t HardwareTimer::getInstance(void)
+{
+    return timerDevice;
+}
+
+/*!
+    \brief      select the event driven onto the trigger output TRGO
+    \param[in]  trgo: TRGO_ENABLE to start slaves with this timer, TRGO_UPDATE to clock them
+    \param[in]  sync: delay this timer by the trigger latency so all timers start in lockstep
+    \param[out] none
     \retval     none
 */
-void HardwareTimer::periodCallback(void)
+void HardwareTimer::setMasterMode(enum timerTriggerOutput trgo, bool sync)
 {
-    if (NULL != this->updateCallback) {
-        this->updateCallback();
+    Timer_setMasterMode(timerDevice, trgo, sync);
+}
+
+/*!
+    \brief      follow the trigger output of another timer
+    \param[in]  mode: SLAVE_TRIGGER for a synchronized start, SLAVE_EXTERNAL_CLOCK to chain counters
+    \param[in]  master: timer configured with setMasterMode()
+    \param[out] none
+    \retval     false if master is not connected to this timer, use setSlaveModeITI() then
+*/
+bool HardwareTimer::setSlaveMode(enum timerSlaveMode mode, HardwareTimer &master)
+{
+    return Timer_setSlaveMode(timerDevice, mode, master.timerDevice) != 0;
+}
+
+/*!
+    \brief      follow an internal trigger input
+    \param[in]  mode: what this timer does on its trigger
+    \param[in]  iti: internal trigger input 0..3, see the trigger connection table of the user manual
+    \param[out] none
+    \retval     none
+*/
+void HardwareTimer::setSlaveModeITI(enum timerSlaveMode mode, uint8_t iti)
+{
+    Timer_setSlaveModeITI(timerDevice, mode, iti);
+}
+
+/*!
+    \brief      count quadrature encoder edges in hardware on channel 0 and 1 of the timer
+    \param[in]  pinA: pin of channel 0
+    \param[in]  pinB: pin of channel 1
+    \param[in]  mode: edges to count
+    \param[out] none
+    \retval     false if the pins are not channel 0 and 1 of this timer
+*/
+bool HardwareTimer::setEncoderMode(uint32_t pinA, uint32_t pinB, encoderMode mode)
+{
+    pwmDevice_t deviceA = getTimerDeviceFromPinname(DIGITAL_TO_PINNAME(pinA));
+    pwmDevice_t deviceB = getTimerDeviceFromPinname(DIGITAL_TO_PINNAME(pinB));
+    uint32_t decomode;
+
+    if ((deviceA.timer != timerDevice) || (deviceA.channel != TIMER_CH_0) ||
+            (deviceB.timer != timerDevice) || (deviceB.channel != TIMER_CH_1)) {
+        return false;
+    }
+    switch (mode) {
+        case ENCODER_X2_A:
+            decomode = TIMER_ENCODER_MODE0;
+            break;
+        case ENCODER_X2_B:
+            decomode = TIMER_ENCODER_MODE1;
+            break;
+        default:
+            decomode = TIMER_ENCODER_MODE2;
+            break;
     }
+    captureInputPinInit(pinA);
+    captureInputPinInit(pinB);
+
+    Timer_wake(timerDevice);
+    timer_disable(timerDevice);
+    timer_autoreload_value_config(timerDevice, 0xFFFF);
+    timer_prescaler_config(timerDevice, 0, TIMER_PSC_RELOAD_NOW);
+    timer_quadrature_decoder_mode_config(timerDevice, decomode, TIMER_IC_POLARITY_RISING,
+                                         TIMER_IC_POLARITY_RISING);
+    timer_counter_value_config(timerDevice, 0);
+    this->encoderHigh = 0;
+    this->isEncoderActive = true;
+    /* the update event of the prescaler reload must not count as a wrap */
+    timer_flag_clear(timerDevice, TIMER_FLAG_UP);
+    Timer_attachIrqCallback(timerDevice, TIMER_IRQ_SOURCE_UP, hardwareTimerIrq, this);
+    timerHandle.enableUpdateIT(timerDevice);
+    timer_enable(timerDevice);
+    this->isTimerActive = true;
+    return true;
 }
 
-void HardwareTimer::captureCallback(uint8_t channel)
+/*!
+    \brief      account for a wrap of the 16 bit encoder counter
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void HardwareTimer::encoderWrap(void)
 {
-    if (NULL != this->captureCallbacks[channel]) {
-        this->captureCallbacks[channel]();
+    /* just after an overflow the counter is near 0, after an underflow near 0xFFFF */
+    if (timer_counter_read(timerDevice) < 0x8000U) {
+        this->encoderHigh += 0x10000;
+    } else {
+        this->encoderHigh -= 0x10000;
     }
 }
 
-extern "C"
+/*!
+    \brief      get the encoder position, extended to 32 bits
+    \param[in]  none
+    \param[out] none
+    \retval     position in counted edges
+*/
+int32_t HardwareTimer::getCount(void)
 {
-    /*!
-        \brief      timer update interrupt handler
-        \param[in]  timer: TIMERx(x=0..13)
-        \param[out] none
-        \retval     none
-    */
-    void Timer_updateHandle(uint32_t timer)
-    {
-        uint32_t index = getTimerIndex(timer);
-        if (hardwaretimerObj[index]) {
-            hardwaretimerObj[index]->periodCallback();
+    uint32_t state;
+    int32_t count;
+
+    state = critical_enter();
+    /* a wrap the interrupt has not handled yet is folded in here */
+    if (timer_flag_get(timerDevice, TIMER_FLAG_UP) != RESET) {
+        timer_flag_clear(timerDevice, TIMER_FLAG_UP);
+        encoderWrap();
+    }
+    count = this->encoderHigh + (int32_t)(timer_counter_read(timerDevice) & 0xFFFFU);
+    critical_exit(state);
+    return count;
+}
+
+/*!
+    \brief      set the encoder position
+    \param[in]  count: new position
+    \param[out] none
+    \retval     none
+*/
+void HardwareTimer::setCount(int32_t count)
+{
+    uint32_t state;
+
+    Timer_wake(timerDevice);
+    state = critical_enter();
+    timer_counter_value_config(timerDevice, (uint32_t)count & 0xFFFFU);
+    this->encoderHigh = count - (int32_t)((uint32_t)count & 0xFFFFU);
+    timer_flag_clear(timerDevice, TIMER_FLAG_UP);
+    critical_exit(state);
+}
+
+/*!
+    \brief      output one pulse per trigger on a pin, delay after the trigger and width long,
+                timed by the timer alone; the timer runs nothing else meanwhile
+    \param[in]  pin: output pin, a channel of this timer
+    \param[in]  delay: time from the trigger to the pulse, at least one tick
+    \param[in]  width: time the output is active
+    \param[in]  format: FORMAT_US or FORMAT_TICK; in ticks of the timer clock delay plus
+                width are at most 65536
+    \param[in]  activeHigh: a high pulse on a low output, or the opposite
+    \param[out] none
+    \retval     false if the pin is not a channel of this timer or the times don't fit
+*/
+bool HardwareTimer::setOnePulse(uint32_t pin, uint32_t delay, uint32_t width, enum timeFormat format,
+                                bool activeHigh)
+{
+    pwmDevice_t device = getTimerDeviceFromPinname(DIGITAL_TO_PINNAME(pin));
+    uint64_t delayTicks;
+    uint64_t widthTicks;
+    uint32_t psc;
+
+    if ((device.timer != timerDevice) || (device.channel > TIMER_CH_3)) {
+        return false;
+    }
+    if (format == FORMAT_US) {
+        delayTicks = ((uint64_t)delay * getTimerClkFrequency(timerDevice)) / 1000000U;
+        widthTicks = ((uint64_t)width * getTimerClkFrequency(timerDevice)) / 1000000U;
+    } else if (format == FORMAT_TICK) {
+        delayTicks = delay;
+        widthTicks = width;
+    } else {
+        return false;
+    }
+    /* the smallest prescaler that fits both in one 16 bit period, for the finest steps */
+    psc = (uint32_t)((delayTicks + widthTicks - 1U) / 65536U);
+    if ((format == FORMAT_TICK && psc != 0U) || (psc > 0xFFFFU)) {
+        return false;
+    }
+    delayTicks = (delayTicks + psc / 2U) / (psc + 1U);
+    widthTicks = (widthTicks + psc / 2U) / (psc + 1U);
+    if (delayTicks == 0U) {
+        delayTicks = 1U;
+    }
+    if (widthTicks == 0U) {
+        widthTicks = 1U;
+    }
+    if (delayTicks + widthTicks > 65536U) {
+        widthTicks = 65536U - delayTicks;
+    }
+
+    this->isTimerActive = false;
+    Timer_onePulseConfig(timerDevice, device.channel, (uint32_t)delayTicks, (uint32_t)widthTicks,
+                         (uint16_t)psc, activeHigh ? 1U : 0U);
+    pinmap_pinout(DIGITAL_TO_PINNAME(pin), PinMap_PWM);
+    this->pulseChannel = device.channel;
+    return true;
+}
+
+/*!
+    \brief      start the pulses of setOnePulse() on an edge of a channel 0 or 1 input
+    \param[in]  pin: trigger pin, channel 0 or 1 of this timer, not the output channel
+    \param[in]  falling: trigger on falling edges instead of rising ones
+    \param[in]  retriggerable: an edge during the delay or the pulse starts the delay over;
+                the first edge after a pulse ended is then taken from the capture interrupt,
+                its latency adds to the delay, and delay plus width must be longer than it
+    \param[out] none
+    \retval     false if the pin is no trigger input of this timer
+*/
+bool HardwareTimer::setPulseTrigger(uint32_t pin, bool falling, bool retriggerable)
+{
+    pwmDevice_t device = getTimerDeviceFromPinname(DIGITAL_TO_PINNAME(pin));
+
+    if ((device.timer != timerDevice) || (device.channel > TIMER_CH_1) || (device.channel == this->pulseChannel)) {
+        return false;
+    }
+    captureInputPinInit(pin);
+    return Timer_onePulseTrigger(timerDevice, (device.channel == TIMER_CH_0) ? PULSE_TRIGGER_CH0 : PULSE_TRIGGER_CH1,
+                                 falling ? 1U : 0U, retriggerable ? 1U : 0U) != 0U;
+}
+
+/*!
+    \brief      start the pulses of setOnePulse() on an internal trigger, the TRGO of another timer
+    \param[in]  iti: internal trigger input 0..3, see the trigger connection table of the user manual
+    \param[out] none
+    \retval     none
+*/
+void HardwareTimer::setPulseTriggerITI(uint8_t iti)
+{
+    Timer_onePulseTrigger(timerDevice, (enum timerPulseTrigger)(PULSE_TRIGGER_ITI0 + (iti & 0x3U)), 0U, 0U);
+}
+
+/*!
+    \brief      start a pulse of setOnePulse() now, ignored while one is under way
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void HardwareTimer::firePulse(void)
+{
+    Timer_firePulse(timerDevice);
+}
+
+/*!
+    \brief      measure period and high time of a PWM signal on a pin continuously in hardware:
+                channel 0 and 1 capture the rising and falling edges of the one input and the
+                rising edge restarts the counter, so nothing runs on the CPU; the timer runs
+                nothing else meanwhile
+    \param[in]  pin: input pin, channel 0 or 1 of this timer
+    \param[in]  maxPeriodUs: longest period to measure, sets the resolution; no rising edge for
+                longer reads as no signal
+    \param[out] none
+    \retval     false if the pin is not channel 0 or 1 of this timer, or the timer has no slave mode
+*/
+bool HardwareTimer::setPWMInputMode(uint32_t pin, uint32_t maxPeriodUs)
+{
+    pwmDevice_t device = getTimerDeviceFromPinname(DIGITAL_TO_PINNAME(pin));
+    uint32_t hz;
+
+    if ((device.timer != timerDevice) || (device.channel > TIMER_CH_1)) {
+        return false;
+    }
+    captureInputPinInit(pin);
+    hz = Timer_pwmInputConfig(timerDevice, device.channel, maxPeriodUs);
+    if (hz == 0) {
+        return false;
+    }
+    this->periodFromTime = false;
+    this->isEncoderActive = false;
+    this->isTimerActive = true;
+    this->pwmInputChannel = device.channel;
+    this->pwmInputLost = true;
+    this->pwmInputHz = hz;
+    this->pwmInputPeriod = 0;
+    this->pwmInputWidth = 0;
+    return true;
+}
+
+/*!
+    \brief      take the latest capture of PWM input mode, if there is a new one
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void HardwareTimer::pwmInputRead(void)
+{
+    uint8_t other = pwmInputChannel ^ 1U;
+    uint32_t period;
+    uint32_t width;
+    uint32_t state;
+
+    state = critical_enter();
+    if (timer_flag_get(timerDevice, TIMER_FLAG_UP) != RESET) {
+        /* no rising edge for a whole counter range */
+        timer_flag_clear(timerDevice, TIMER_FLAG_UP);
+        timer_flag_clear(timerDevice, (uint32_t)TIMER_FLAG_CH0 << pwmInputChannel);
+        this->pwmInputLost = true;
+        this->pwmInputPeriod = 0;
+        this->pwmInputWidth = 0;
+    } else if (timer_flag_get(timerDevice, (uint32_t)TIMER_FLAG_CH0 << pwmInputChannel) != RESET) {
+        /* reading the capture value clears its flag */
+        period = timer_channel_capture_value_register_read(timerDevice, pwmInputChannel);
+        width = timer_channel_capture_value_register_read(timerDevice, other);
+        if (this->pwmInputLost) {
+            /* the first edge after a pause ends no period */
+            this->pwmInputLost = false;
+        } else {
+            this->pwmInputPeriod = period;
+            this->pwmInputWidth = (width < period) ? width : period;
         }
     }
-    /*!
-        \brief      timer capture interrupt handler
-        \param[in]  timer: TIMERx(x=0..13)
-        \param[in]  channel: TIMERx(x=0..3)
-        \param[out] none
-        \retval     none
-    */
-    void Timer_captureHandle(uint32_t timer, uint8_t channel)
-    {
-        uint32_t index =  getTimerIndex(timer);
-        if (hardwaretimerObj[index]) {
-            hardwaretimerObj[index]->captureCallback(channel);
+    critical_exit(state);
+}
+
+/*!
+    \brief      convert ticks of PWM input mode to a time
+    \param[in]  ticks: period or high time
+    \param[in]  hz: tick frequency
+    \param[in]  format: FORMAT_TICK, FORMAT_US, FORMAT_MS, FORMAT_S or FORMAT_HZ for 1 / time
+    \param[out] none
+    \retval     the time, 0 for 0 ticks
+*/
+static uint32_t pwmInputTime(uint32_t ticks, uint32_t hz, enum timeFormat format)
+{
+    if (ticks == 0) {
+        return 0;
+    }
+    switch (format) {
+        case FORMAT_TICK:
+            return ticks;
+        case FORMAT_MS:
+            return (uint32_t)((uint64_t)ticks * 1000U / hz);
+        case FORMAT_S:
+            return ticks / hz;
+        case FORMAT_HZ:
+            return hz / ticks;
+        default:
+            return (uint32_t)((uint64_t)ticks * 1000000U / hz);
+    }
+}
+
+/*!
+    \brief      get the period measured by PWM input mode
+    \param[in]  format: FORMAT_US, FORMAT_MS, FORMAT_S, FORMAT_TICK, or FORMAT_HZ for the frequency
+    \param[out] none
+    \retval     the latest period, 0 before the first complete one or without signal
+*/
+uint32_t HardwareTimer::getPeriod(enum timeFormat format)
+{
+    if (pwmInputChannel == 0xFF) {
+        return 0;
+    }
+    pwmInputRead();
+    return pwmInputTime(pwmInputPeriod, pwmInputHz, format);
+}
+
+/*!
+    \brief      get the high time measured by PWM input mode, e.g. the 1..2 ms of an RC receiver
+    \param[in]  format: FORMAT_US, FORMAT_MS, FORMAT_S or FORMAT_TICK
+    \param[out] none
+    \retval     the latest high time, 0 before the first complete period or without signal
+*/
+uint32_t HardwareTimer::getPulseWidth(enum timeFormat format)
+{
+    if (pwmInputChannel == 0xFF) {
+        return 0;
+    }
+    pwmInputRead();
+    return pwmInputTime(pwmInputWidth, pwmInputHz, format);
+}
+
+/*!
+    \brief      get the duty cycle measured by PWM input mode
+    \param[in]  range: value of a signal that is high all the time, 100 for percent
+    \param[out] none
+    \retval     high time / period scaled to 0..range, 0 without signal
+*/
+uint32_t HardwareTimer::getDutyCycle(uint32_t range)
+{
+    if (pwmInputChannel == 0xFF) {
+        return 0;
+    }
+    pwmInputRead();
+    if (pwmInputPeriod == 0) {
+        return 0;
+    }
+    return (uint32_t)((uint64_t)pwmInputWidth * range / pwmInputPeriod);
+}
+
+/*!
+    \brief      capture buffer DMA interrupt, hands the filled half to the callback
+    \param[in]  arg: captureBuffer_t of the channel
+    \param[in]  flags: DMA channel flags
+    \param[out] none
+    \retval     none
+*/
+static void captureBufferIrq(void *arg, uint32_t flags)
+{
+    captureBuffer_t *capture = (captureBuffer_t *)arg;
+    size_t half = capture->length / 2;
+
+    if (capture->callback == NULL) {
+        return;
+    }
+    if (flags & DMA_CALLBACK_FLAG_HTF) {
+        capture->callback(capture->buffer, half);
+    }
+    if (flags & DMA_CALLBACK_FLAG_FTF) {
+        capture->callback(capture->buffer + half, capture->length - half);
+    }
+}
+
+/*!
+    \brief      capture edges on a pin into a ring buffer by DMA, without an interrupt per edge
+    \param[in]  ulpin: capture pin
+    \param[in]  channel: timer channel of the pin
+    \param[in]  mode: edge to capture
+    \param[in]  buffer: ring buffer of counter values, must stay valid while capturing
+    \param[in]  length: number of values in buffer
+    \param[in]  callback: called from the DMA interrupt with each half of the buffer once it is filled
+    \param[out] none
+    \retval     false if the channel has no DMA request
+*/
+bool HardwareTimer::captureToBuffer(uint32_t ulpin, uint8_t channel, captureMode mode,
+                                    uint16_t *buffer, size_t length, captureBufferCallback_t callback)
+{
+    if (channel > 3) {
+        return false;
+    }
+    setCaptureMode(ulpin, channel, mode);
+    this->captureBuffers[channel].buffer = buffer;
+    this->captureBuffers[channel].length = length;
+    this->captureBuffers[channel].callback = callback;
+    return Timer_captureDmaStart(timerDevice, channel, buffer, length,
+                                 (callback != NULL) ? captureBufferIrq : NULL,
+                                 &this->captureBuffers[channel]) != 0;
+}
+
+/*!
+    \brief      stop capturing into the buffer
+    \param[in]  channel: timer channel
+    \param[out] none
+    \retval     none
+*/
+void HardwareTimer::stopCaptureBuffer(uint8_t channel)
+{
+    if (channel > 3) {
+        return;
+    }
+    Timer_captureDmaStop(timerDevice, channel);
+    this->captureBuffers[channel].callback = NULL;
+}
+
+/*!
+    \brief      get the buffer index the next capture is written to
+    \param[in]  channel: timer channel
+    \param[out] none
+    \retval     index into the capture buffer
+*/
+size_t HardwareTimer::captureBufferIndex(uint8_t channel)
+{
+    size_t length;
+    size_t remaining;
+
+    if (channel > 3) {
+        return 0;
+    }
+    length = this->captureBuffers[channel].length;
+    remaining = Timer_captureDmaRemaining(timerDevice, channel);
+    if ((length == 0) || (remaining == 0) || (remaining > length)) {
+        return 0;
+    }
+    return length - remaining;
+}
+
+/*!
+    \brief      period callback handler
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void HardwareTimer::periodCallback(void)
+{
+    if (this->isEncoderActive) {
+        encoderWrap();
+    }
+    if (NULL != this->updateCallback) {
+        if (this->deferredCallbacks & TIMER_DEFERRED_UPDATE) {
+            deferred_post_call(this->updateCallback);
+        } else {
+            this->updateCallback();
         }
     }
 }
 
+void HardwareTimer::captureCallback(uint8_t channel)
+{
+    if (NULL != this->captureCallbacks[channel]) {
+        if (this->deferredCallbacks & (1U << channel)) {
+            deferred_post_call(this->captureCallbacks[channel]);
+        } else {
+            this->captureCallbacks[channel]();
+        }
+    }
+}
@@ -40,6 +40,16 @@ OF SUCH DAMAGE.
 
 
 typedef void(*timerCallback_t)(void);
+/* bit of the period callback in deferredCallbacks, channels take bits 0..3 */
+#define TIMER_DEFERRED_UPDATE   (1U << 4)
+/* data points at the half of the capture buffer that was just filled */
+typedef void(*captureBufferCallback_t)(const uint16_t *data, size_t count);
+
+typedef struct {
+    uint16_t *buffer;
+    size_t length;
+    captureBufferCallback_t callback;
+} captureBuffer_t;
 
 class HardwareTimer
 {
@@ -50,14 +60,15 @@ class HardwareTimer
         void stop(void);                                                          //stop timer
         void refresh(
             void);                                                       //update some registers to restart counters
-        void setPrescaler(uint16_t prescaler);                                    //set prescaler
-        void setCounter(uint16_t count);                                          //set counter
+        void setPrescaler(uint32_t prescaler);                                    //set prescaler, 1..65536
+        void setCounter(uint32_t count);                                          //set counter, full width on a 32 bit timer
         void setrRpetitionValue(uint16_t repetition);                             //set rpetition value
         void setPeriodTime(uint32_t time, enum timeFormat format = FORMAT_MS);    //set timer period
         void setReloadValue(uint32_t
                             value);                                      //set timer period with the inital format
         void attachInterrupt(timerCallback_t callback,
-                             uint8_t channel = 0xff);   //attach callback for period/capture interrupt
+                             uint8_t channel = 0xff,
+                             bool deferred = false);    //attach callback for period/capture interrupt
         void detachInterrupt(uint8_t channel =
                                  0xff);                             //detach callback for period/capture interrupt
         void periodCallback(void);                                                //period callback handler
@@ -67,14 +78,63 @@ class HardwareTimer
                                  channel);                                //get timer channel capture value
         uint32_t getTimerClkFre(
             void);                                            //get timer clock frequency
+        uint32_t getCounter(
+            void);                                                //get counter value
+        uint32_t getMaxCount(
+            void);                                                //0xFFFFFFFF for a 32 bit timer, else 0xFFFF
+        uint32_t getInstance(
+            void);                                                //get TIMERx of this timer
+        void setMasterMode(enum timerTriggerOutput trgo,
+                           bool sync = false);                        //select event driven onto TRGO
+        bool setSlaveMode(enum timerSlaveMode mode,
+                          HardwareTimer &master);                     //follow TRGO of another timer
+        void setSlaveModeITI(enum timerSlaveMode mode,
+                             uint8_t iti);                            //follow internal trigger ITIx
+        bool setEncoderMode(uint32_t pinA, uint32_t pinB,
+                            encoderMode mode = ENCODER_X4);              //count encoder edges in hardware
+        int32_t getCount(void);                                           //get encoder position
+        void setCount(int32_t count);                                     //set encoder position
+        bool captureToBuffer(uint32_t ulpin, uint8_t channel, captureMode mode,
+                             uint16_t *buffer, size_t length,
+                             captureBufferCallback_t callback = NULL);  //capture into ring buffer by DMA
+        void stopCaptureBuffer(uint8_t channel);                          //stop capture into buffer
+        size_t captureBufferIndex(uint8_t channel);                       //index the next capture goes to
+        void clockChanged(void);                                          //redo time based period on new clock
+        bool setOnePulse(uint32_t pin, uint32_t delay, uint32_t width,
+                         enum timeFormat format = FORMAT_US,
+                         bool activeHigh = true);                       //one delayed pulse per trigger on a pin
+        bool setPulseTrigger(uint32_t pin, bool falling = false,
+                             bool retriggerable = false);               //start pulses on an edge of CH0/CH1
+        void setPulseTriggerITI(uint8_t iti);                             //start pulses on internal trigger ITIx
+        void firePulse(void);                                             //start a pulse from software
+        bool setPWMInputMode(uint32_t pin,
+                             uint32_t maxPeriodUs = 65535);             //measure period/duty in hardware
+        uint32_t getPeriod(enum timeFormat format = FORMAT_US);           //measured period, 0 without signal
+        uint32_t getPulseWidth(enum timeFormat format = FORMAT_US);       //measured high time
+        uint32_t getDutyCycle(uint32_t range = 100);                      //high time in 0..range of the period
     private:
+        void encoderWrap(void);                                           //extend encoder count on wrap
+        void pwmInputRead(void);                                          //take the latest PWM input capture
         uint32_t timerDevice;
         bool isTimerActive;
+        bool isEncoderActive = false;
+        bool periodFromTime = false;                                      //period set in time units, not ticks
+        volatile int32_t encoderHigh = 0;
         timerPeriod_t timerPeriod;
         timerCallback_t updateCallback;
         timerCallback_t captureCallbacks[4] = {0};
+        uint8_t pulseChannel = 0xFF;                                      //output channel of setOnePulse()
+        uint8_t deferredCallbacks = 0;                                    //channels 0..3, TIMER_DEFERRED_UPDATE
+        captureBuffer_t captureBuffers[4] = {};
+        uint8_t pwmInputChannel = 0xFF;                                   //channel of setPWMInputMode()
+        bool pwmInputLost = true;                                         //no capture since a pause
+        uint32_t pwmInputHz = 0;                                          //tick frequency of the captures
+        uint32_t pwmInputPeriod = 0;                                      //last period, ticks
+        uint32_t pwmInputWidth = 0;                                       //last high time, ticks
 };
 
 extern timerhandle_t timerHandle;
 
+void captureInputPinInit(uint32_t ulpin);                                 //route a pin as timer capture input
+
 #endif /* HARDWARETIMER_H */
@@ -0,0 +1,537 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "Arduino.h"
+
+#if defined(GD32E50X)
+
+/* longest period the counter takes */
+#define SHRTIMER_PERIOD_MAX     0xFFDFU
+/* longest dead time the generator takes */
+#define SHRTIMER_DEADTIME_MAX   0xFFFFU
+/* counts per nanosecond * 2^shift are fSHRTIMER_CK * 64 / 1e9, i.e. fSHRTIMER_CK / 15625000 */
+#define SHRTIMER_NS_DIVIDER     15625000ULL
+
+/* counter clocks from 64 * fSHRTIMER_CK down, one halving per step */
+static const uint32_t shrtimerCounterPrescaler[] = {
+    SHRTIMER_PRESCALER_MUL64, SHRTIMER_PRESCALER_MUL32, SHRTIMER_PRESCALER_MUL16,
+    SHRTIMER_PRESCALER_MUL8, SHRTIMER_PRESCALER_MUL4, SHRTIMER_PRESCALER_MUL2,
+    SHRTIMER_PRESCALER_DIV1, SHRTIMER_PRESCALER_DIV2, SHRTIMER_PRESCALER_DIV4
+};
+
+/* dead time generator clocks, the same way */
+static const uint32_t shrtimerDeadTimePrescaler[] = {
+    SHRTIMER_DEADTIME_PRESCALER_MUL64, SHRTIMER_DEADTIME_PRESCALER_MUL32, SHRTIMER_DEADTIME_PRESCALER_MUL16,
+    SHRTIMER_DEADTIME_PRESCALER_MUL8, SHRTIMER_DEADTIME_PRESCALER_MUL4, SHRTIMER_DEADTIME_PRESCALER_MUL2,
+    SHRTIMER_DEADTIME_PRESCALER_DIV1, SHRTIMER_DEADTIME_PRESCALER_DIV2, SHRTIMER_DEADTIME_PRESCALER_DIV4,
+    SHRTIMER_DEADTIME_PRESCALER_DIV8, SHRTIMER_DEADTIME_PRESCALER_DIV16
+};
+
+static const uint32_t shrtimerCounter[] = {
+    SHRTIMER_ST0_COUNTER, SHRTIMER_ST1_COUNTER, SHRTIMER_ST2_COUNTER, SHRTIMER_ST3_COUNTER, SHRTIMER_ST4_COUNTER
+};
+
+static const uint32_t shrtimerSoftwareUpdate[] = {
+    SHRTIMER_UPDATE_SW_ST0, SHRTIMER_UPDATE_SW_ST1, SHRTIMER_UPDATE_SW_ST2, SHRTIMER_UPDATE_SW_ST3, SHRTIMER_UPDATE_SW_ST4
+};
+
+static const uint32_t shrtimerFault[] = {
+    SHRTIMER_FAULT_0, SHRTIMER_FAULT_1, SHRTIMER_FAULT_2, SHRTIMER_FAULT_3, SHRTIMER_FAULT_4
+};
+
+static const uint32_t shrtimerFaultEnable[] = {
+    SHRTIMER_STXFAULTENABLE_FAULT0, SHRTIMER_STXFAULTENABLE_FAULT1, SHRTIMER_STXFAULTENABLE_FAULT2,
+    SHRTIMER_STXFAULTENABLE_FAULT3, SHRTIMER_STXFAULTENABLE_FAULT4
+};
+
+static const uint32_t shrtimerFaultFlag[] = {
+    SHRTIMER_FLAG_FLT0, SHRTIMER_FLAG_FLT1, SHRTIMER_FLAG_FLT2, SHRTIMER_FLAG_FLT3, SHRTIMER_FLAG_FLT4
+};
+
+/* compare 2 of each Slave_TIMER, on SHRTIMER_ADCTRIG0/2 and on SHRTIMER_ADCTRIG1/3 */
+static const uint32_t shrtimerAdcEvent02[] = {
+    SHRTIMER_ADCTRGI02_EVENT_ST0CMP2, SHRTIMER_ADCTRGI02_EVENT_ST1CMP2, SHRTIMER_ADCTRGI02_EVENT_ST2CMP2,
+    SHRTIMER_ADCTRGI02_EVENT_ST3CMP2, SHRTIMER_ADCTRGI02_EVENT_ST4CMP2
+};
+
+static const uint32_t shrtimerAdcEvent13[] = {
+    SHRTIMER_ADCTRGI13_EVENT_ST0CMP2, SHRTIMER_ADCTRGI13_EVENT_ST1CMP2, SHRTIMER_ADCTRGI13_EVENT_ST2CMP2,
+    SHRTIMER_ADCTRGI13_EVENT_ST3CMP2, SHRTIMER_ADCTRGI13_EVENT_ST4CMP2
+};
+
+static const uint32_t shrtimerAdcUpdate[] = {
+    SHRTIMER_ADCTRGI_UPDATE_ST0, SHRTIMER_ADCTRGI_UPDATE_ST1, SHRTIMER_ADCTRGI_UPDATE_ST2,
+    SHRTIMER_ADCTRGI_UPDATE_ST3, SHRTIMER_ADCTRGI_UPDATE_ST4
+};
+
+/* pins with a SHRTIMER alternate function */
+typedef struct {
+    PinName pin;
+    uint32_t afio;
+} shrtimerPin_t;
+
+static const shrtimerPin_t shrtimerPins[] = {
+    {PORTA_8,  AFIO_PA8_SHRTIMER_CFG},  {PORTA_9,  AFIO_PA9_SHRTIMER_CFG},
+    {PORTA_10, AFIO_PA10_SHRTIMER_CFG}, {PORTA_11, AFIO_PA11_SHRTIMER_CFG},
+    {PORTA_12, AFIO_PA12_SHRTIMER_CFG}, {PORTA_15, AFIO_PA15_SHRTIMER_CFG},
+    {PORTB_1,  AFIO_PB1_SHRTIMER_CFG},  {PORTB_2,  AFIO_PB2_SHRTIMER_CFG},
+    {PORTB_3,  AFIO_PB3_SHRTIMER_CFG},  {PORTB_4,  AFIO_PB4_SHRTIMER_CFG},
+    {PORTB_5,  AFIO_PB5_SHRTIMER_CFG},  {PORTB_6,  AFIO_PB6_SHRTIMER_CFG},
+    {PORTB_7,  AFIO_PB7_SHRTIMER_CFG},  {PORTB_8,  AFIO_PB8_SHRTIMER_CFG},
+    {PORTB_9,  AFIO_PB9_SHRTIMER_CFG},  {PORTB_10, AFIO_PB10_SHRTIMER_CFG},
+    {PORTB_11, AFIO_PB11_SHRTIMER_CFG}, {PORTB_12, AFIO_PB12_SHRTIMER_CFG},
+    {PORTB_13, AFIO_PB13_SHRTIMER_CFG}, {PORTB_14, AFIO_PB14_SHRTIMER_CFG},
+    {PORTB_15, AFIO_PB15_SHRTIMER_CFG}, {PORTC_6,  AFIO_PC6_SHRTIMER_CFG},
+    {PORTC_7,  AFIO_PC7_SHRTIMER_CFG},  {PORTC_8,  AFIO_PC8_SHRTIMER_CFG},
+    {PORTC_9,  AFIO_PC9_SHRTIMER_CFG},  {PORTC_11, AFIO_PC11_SHRTIMER_CFG},
+    {PORTC_12, AFIO_PC12_SHRTIMER_CFG}, {PORTD_4,  AFIO_PD4_SHRTIMER_CFG},
+    {PORTD_5,  AFIO_PD5_SHRTIMER_CFG},  {PORTE_0,  AFIO_PE0_SHRTIMER_CFG},
+    {PORTE_1,  AFIO_PE1_SHRTIMER_CFG},  {PORTG_6,  AFIO_PG6_SHRTIMER_CFG},
+    {PORTG_7,  AFIO_PG7_SHRTIMER_CFG},  {PORTG_10, AFIO_PG10_SHRTIMER_CFG},
+    {PORTG_11, AFIO_PG11_SHRTIMER_CFG}, {PORTG_12, AFIO_PG12_SHRTIMER_CFG},
+    {PORTG_13, AFIO_PG13_SHRTIMER_CFG}
+};
+
+static bool shrtimerReady = false;
+
+/* clock the SHRTIMER from the system clock and calibrate the delay line the fine steps come from */
+static void shrtimerInit(void)
+{
+    if (shrtimerReady) {
+        return;
+    }
+    rcu_shrtimer_clock_config(RCU_SHRTIMERSRC_CKSYS);
+    rcu_periph_clock_enable(RCU_SHRTIMER);
+    shrtimer_dll_calibration_start(SHRTIMER0, SHRTIMER_CALIBRATION_ONCE);
+    while (RESET == shrtimer_common_flag_get(SHRTIMER0, SHRTIMER_FLAG_DLLCAL)) {
+    }
+    /* keep it calibrated while temperature and voltage drift */
+    shrtimer_dll_calibration_start(SHRTIMER0, SHRTIMER_CALIBRATION_131072_PERIOD);
+    shrtimerReady = true;
+}
+
+/* route pin to the SHRTIMER alternate function in the given mode */
+static bool shrtimerPinout(PinName p, GD32PinMode mode)
+{
+    for (uint8_t i = 0; i < sizeof(shrtimerPins) / sizeof(shrtimerPins[0]); i++) {
+        if (shrtimerPins[i].pin == p) {
+            pin_function(p, GD_PIN_FUNCTION1(mode, 0));
+            rcu_periph_clock_enable(RCU_AF);
+            gpio_afio_port_config(shrtimerPins[i].afio, ENABLE);
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!
+    \brief      HighResPWM object construct
+    \param[in]  slaveTimer: Slave_TIMER to use, 0 to 4
+    \param[out] none
+    \retval     none
+*/
+HighResPWM::HighResPWM(uint8_t slaveTimer)
+{
+    this->timer = slaveTimer;
+    this->period = 0;
+    this->shift = 0xFF;
+    this->duty[0] = 0;
+    this->duty[1] = 0;
+    this->adcAt = 0;
+    this->faults = SHRTIMER_STXFAULTENABLE_NONE;
+    this->deadTime = false;
+    this->running = false;
+}
+
+/*!
+    \brief      hand a pin to the SHRTIMER as an output
+    \param[in]  pin: arduino pin with a SHRTIMER alternate function
+    \param[out] none
+    \retval     false if the pin has none
+*/
+bool HighResPWM::attachPin(uint32_t pin)
+{
+    return shrtimerPinout(DIGITAL_TO_PINNAME(pin), PIN_MODE_AF_PP);
+}
+
+/*!
+    \brief      set up the Slave_TIMER, outputs stay off until start()
+    \param[in]  periodNs: PWM period in nanoseconds
+    \param[out] none
+    \retval     false if the timer doesn't exist or the period is out of range
+*/
+bool HighResPWM::begin(uint32_t periodNs)
+{
+    shrtimer_timerinit_parameter_struct init;
+
+    this->shift = 0xFF;
+    if (!this->setPeriod(periodNs)) {
+        return false;
+    }
+    /* period and compare values change at the end of a period, so they never glitch */
+    shrtimer_timerinit_struct_para_init(&init);
+    init.shadow = SHRTIMER_SHADOW_ENABLED;
+    init.repetition_update = SHRTIMER_UPDATEONREPETITION_ENABLED;
+    shrtimer_timers_waveform_init(SHRTIMER0, this->timer, &init);
+    this->applyConfig();
+    this->setDuty(0, this->duty[0]);
+    this->setDuty(1, this->duty[1]);
+    return true;
+}
+
+/*!
+    \brief      change the period, duty and ADC trigger times are kept in nanoseconds
+    \param[in]  periodNs: PWM period in nanoseconds
+    \param[out] none
+    \retval     false if the period is out of range
+*/
+bool HighResPWM::setPeriod(uint32_t periodNs)
+{
+    shrtimer_baseinit_parameter_struct base;
+    uint8_t s;
+    uint32_t counts = 0;
+
+    if (this->timer > SHRTIMER_SLAVE_TIMER4) {
+        return false;
+    }
+    shrtimerInit();
+    /* the finest counter clock the period fits in */
+    for (s = 0; s < sizeof(shrtimerCounterPrescaler) / sizeof(shrtimerCounterPrescaler[0]); s++) {
+        counts = this->toCounts(periodNs, s);
+        if (counts <= SHRTIMER_PERIOD_MAX) {
+            break;
+        }
+    }
+    if ((counts > SHRTIMER_PERIOD_MAX) || (counts < max((3U << 6) >> s, 3U))) {
+        return false;
+    }
+    if (s != this->shift) {
+        /* the counter clock only changes while the counter stands */
+        if (this->running) {
+            shrtimer_timers_counter_disable(SHRTIMER0, shrtimerCounter[this->timer]);
+        }
+        shrtimer_baseinit_struct_para_init(&base);
+        base.period = counts;
+        base.prescaler = shrtimerCounterPrescaler[s];
+        base.counter_mode = SHRTIMER_COUNTER_MODE_CONTINOUS;
+        shrtimer_timers_base_init(SHRTIMER0, this->timer, &base);
+        this->shift = s;
+        if (this->running) {
+            shrtimer_timers_counter_enable(SHRTIMER0, shrtimerCounter[this->timer]);
+        }
+    } else {
+        shrtimer_timers_autoreload_value_config(SHRTIMER0, this->timer, counts);
+    }
+    this->period = counts;
+    this->setDuty(0, this->duty[0]);
+    if (!this->deadTime) {
+        this->setDuty(1, this->duty[1]);
+    }
+    if (this->adcAt != 0) {
+        shrtimer_slavetimer_compare_value_config(SHRTIMER0, this->timer, SHRTIMER_COMPARE2,
+                                                 constrain(this->toCounts(this->adcAt, this->shift),
+                                                           this->minCounts(), this->period - 1));
+    }
+    return true;
+}
+
+/*!
+    \brief      set how long a channel is high from the start of each period
+    \param[in]  channel: 0 or 1, 1 only without dead time
+    \param[in]  highNs: high time in nanoseconds, 0 for always low, the period or more for always high
+    \param[out] none
+    \retval     false if channel is not free to set
+*/
+bool HighResPWM::setDuty(uint8_t channel, uint32_t highNs)
+{
+    uint32_t counts;
+
+    if ((channel > 1) || ((channel == 1) && this->deadTime)) {
+        return false;
+    }
+    this->duty[channel] = highNs;
+    if (this->period == 0) {
+        return true;
+    }
+    counts = this->toCounts(highNs, this->shift);
+    if (counts == 0) {
+        this->configChannel(channel, SHRTIMER_CHANNEL_SET_NONE, SHRTIMER_CHANNEL_RESET_PER);
+    } else if (counts >= this->period) {
+        this->configChannel(channel, SHRTIMER_CHANNEL_SET_PER, SHRTIMER_CHANNEL_RESET_NONE);
+    } else {
+        shrtimer_slavetimer_compare_value_config(SHRTIMER0, this->timer,
+                                                 (channel == 0) ? SHRTIMER_COMPARE0 : SHRTIMER_COMPARE1,
+                                                 max(counts, this->minCounts()));
+        this->configChannel(channel, SHRTIMER_CHANNEL_SET_PER,
+                            (channel == 0) ? SHRTIMER_CHANNEL_RESET_CMP0 : SHRTIMER_CHANNEL_RESET_CMP1);
+    }
+    return true;
+}
+
+/*!
+    \brief      make channel 1 the complement of channel 0, with dead time after each edge of channel 0
+    \param[in]  risingNs: delay of the rising edge of channel 0 in nanoseconds
+    \param[in]  fallingNs: delay of the rising edge of channel 1 in nanoseconds
+    \param[out] none
+    \retval     false if the times are out of range, or dead time is switched on while running
+*/
+bool HighResPWM::setDeadTime(uint32_t risingNs, uint32_t fallingNs)
+{
+    shrtimer_deadtimecfg_parameter_struct dt;
+    uint8_t s;
+    uint32_t rising = 0;
+    uint32_t falling = 0;
+
+    if (this->running && !this->deadTime) {
+        return false;
+    }
+    for (s = 0; s < sizeof(shrtimerDeadTimePrescaler) / sizeof(shrtimerDeadTimePrescaler[0]); s++) {
+        rising = this->toCounts(risingNs, s);
+        falling = this->toCounts(fallingNs, s);
+        if ((rising <= SHRTIMER_DEADTIME_MAX) && (falling <= SHRTIMER_DEADTIME_MAX)) {
+            break;
+        }
+    }
+    if ((rising > SHRTIMER_DEADTIME_MAX) || (falling > SHRTIMER_DEADTIME_MAX)) {
+        return false;
+    }
+    shrtimer_deadtimercfg_struct_para_init(&dt);
+    dt.prescaler = shrtimerDeadTimePrescaler[s];
+    dt.rising_value = rising;
+    dt.falling_value = falling;
+    shrtimer_slavetimer_deadtime_config(SHRTIMER0, this->timer, &dt);
+    if (!this->deadTime) {
+        this->deadTime = true;
+        this->applyConfig();
+    }
+    return true;
+}
+
+/*!
+    \brief      make channel 1 follow its own duty again
+    \param[in]  none
+    \param[out] none
+    \retval     false while running
+*/
+bool HighResPWM::clearDeadTime(void)
+{
+    if (this->running) {
+        return false;
+    }
+    this->deadTime = false;
+    this->applyConfig();
+    this->setDuty(1, this->duty[1]);
+    return true;
+}
+
+/*!
+    \brief      drive both outputs inactive while a fault input is active, until clearFault()
+    \param[in]  fault: fault input 0 to 4
+    \param[in]  activeHigh: true if the fault is signalled by a high level
+    \param[in]  pin: arduino pin with the SHRTIMER_FLTx function, NC for the internal source
+                (a comparator)
+    \param[in]  filter: digital filter, 0 (none) to 15
+    \param[out] none
+    \retval     false if fault or pin is out of range
+*/
+bool HighResPWM::enableFault(uint8_t fault, bool activeHigh, uint32_t pin, uint8_t filter)
+{
+    shrtimer_faultcfg_parameter_struct cfg;
+
+    if ((fault > 4) || (filter > 15)) {
+        return false;
+    }
+    if ((pin != (uint32_t)NC) && !shrtimerPinout(DIGITAL_TO_PINNAME(pin), PIN_MODE_IN_FLOATING)) {
+        return false;
+    }
+    shrtimerInit();
+    shrtimer_faultcfg_struct_para_init(&cfg);
+    cfg.source = (pin != (uint32_t)NC) ? SHRTIMER_FAULT_SOURCE_PIN : SHRTIMER_FAULT_SOURCE_INTERNAL;
+    cfg.polarity = activeHigh ? SHRTIMER_FAULT_POLARITY_HIGH : SHRTIMER_FAULT_POLARITY_LOW;
+    cfg.filter = filter;
+    cfg.control = SHRTIMER_FAULT_CHANNEL_ENABLE;
+    cfg.protect = SHRTIMER_FAULT_PROTECT_DISABLE;
+    shrtimer_fault_config(SHRTIMER0, shrtimerFault[fault], &cfg);
+    this->faults |= shrtimerFaultEnable[fault];
+    if (this->period != 0) {
+        this->applyConfig();
+    }
+    return true;
+}
+
+/*!
+    \brief      fire an ADC trigger output at a point of every period, one point per Slave_TIMER
+    \param[in]  trigger: SHRTIMER_ADCTRIGx, 0 to 3, 0 and 2 start regular and 1 and 3 inserted
+                conversions of ADC0/1
+    \param[in]  atNs: nanoseconds after the start of the period
+    \param[out] none
+    \retval     false if begin() has not run or trigger is out of range
+*/
+bool HighResPWM::setADCTrigger(uint8_t trigger, uint32_t atNs)
+{
+    shrtimer_adctrigcfg_parameter_struct cfg;
+
+    if ((trigger > 3) || (this->period == 0)) {
+        return false;
+    }
+    this->adcAt = max(atNs, (uint32_t)1);
+    shrtimer_slavetimer_compare_value_config(SHRTIMER0, this->timer, SHRTIMER_COMPARE2,
+                                             constrain(this->toCounts(this->adcAt, this->shift),
+                                                       this->minCounts(), this->period - 1));
+    shrtimer_adctrigcfg_struct_para_init(&cfg);
+    cfg.update_source = shrtimerAdcUpdate[this->timer];
+    cfg.trigger = (trigger & 1) ? shrtimerAdcEvent13[this->timer] : shrtimerAdcEvent02[this->timer];
+    shrtimer_adc_trigger_config(SHRTIMER0, SHRTIMER_ADCTRIG_0 + trigger, &cfg);
+    return true;
+}
+
+/*!
+    \brief      start the counter and enable both outputs
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void HighResPWM::start(void)
+{
+    if (this->period == 0) {
+        return;
+    }
+    /* load what was written to the shadow registers, the first period runs with it */
+    shrtimer_software_update(SHRTIMER0, shrtimerSoftwareUpdate[this->timer]);
+    shrtimer_output_channel_enable(SHRTIMER0, this->channelId(0) | this->channelId(1));
+    shrtimer_timers_counter_enable(SHRTIMER0, shrtimerCounter[this->timer]);
+    this->running = true;
+}
+
+/*!
+    \brief      stop the counter, the outputs go to their inactive level
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void HighResPWM::stop(void)
+{
+    if (this->period == 0) {
+        return;
+    }
+    shrtimer_output_channel_disable(SHRTIMER0, this->channelId(0) | this->channelId(1));
+    shrtimer_timers_counter_disable(SHRTIMER0, shrtimerCounter[this->timer]);
+    this->running = false;
+}
+
+/*!
+    \brief      check if a fault input stopped the outputs
+    \param[in]  none
+    \param[out] none
+    \retval     true if an output is in the fault state
+*/
+bool HighResPWM::isFaulted(void)
+{
+    if (this->period == 0) {
+        return false;
+    }
+    return (SHRTIMER_CHANNEL_STATE_FAULT == shrtimer_slavetimer_waveform_channel_state_get(SHRTIMER0, this->channelId(0)))
+           || (SHRTIMER_CHANNEL_STATE_FAULT == shrtimer_slavetimer_waveform_channel_state_get(SHRTIMER0, this->channelId(1)));
+}
+
+/*!
+    \brief      enable the outputs again after a fault, fails silently while the fault is still active
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void HighResPWM::clearFault(void)
+{
+    for (uint8_t i = 0; i < 5; i++) {
+        if (this->faults & shrtimerFaultEnable[i]) {
+            shrtimer_common_flag_clear(SHRTIMER0, shrtimerFaultFlag[i]);
+        }
+    }
+    if (this->running) {
+        shrtimer_output_channel_enable(SHRTIMER0, this->channelId(0) | this->channelId(1));
+    }
+}
+
+/*!
+    \brief      get the step the duty and period move in at the current period
+    \param[in]  none
+    \param[out] none
+    \retval     step in picoseconds, 0 before begin()
+*/
+uint32_t HighResPWM::resolution(void)
+{
+    if (this->period == 0) {
+        return 0;
+    }
+    return (uint32_t)((SHRTIMER_NS_DIVIDER * 1000ULL << this->shift) / rcu_clock_freq_get(CK_SYS));
+}
+
+/* counts of the clock 64 * fSHRTIMER_CK >> shift in ns */
+uint32_t HighResPWM::toCounts(uint32_t ns, uint8_t shift)
+{
+    uint64_t counts = ((uint64_t)ns * rcu_clock_freq_get(CK_SYS) / SHRTIMER_NS_DIVIDER) >> shift;
+
+    return (counts > 0xFFFFFFFFULL) ? 0xFFFFFFFFU : (uint32_t)counts;
+}
+
+/* shortest compare value, three SHRTIMER clocks */
+uint32_t HighResPWM::minCounts(void)
+{
+    return max((3U << 6) >> this->shift, 3U);
+}
+
+/* dead time and fault inputs of the Slave_TIMER */
+void HighResPWM::applyConfig(void)
+{
+    shrtimer_timercfg_parameter_struct cfg;
+
+    shrtimer_timercfg_struct_para_init(&cfg);
+    cfg.fault_enable = this->faults;
+    cfg.deadtime_enable = this->deadTime ? SHRTIMER_STXDEADTIME_ENABLED : SHRTIMER_STXDEADTIME_DISABLED;
+    shrtimer_slavetimer_waveform_config(SHRTIMER0, this->timer, &cfg);
+}
+
+/* set and reset events of a channel, idle and fault state inactive */
+void HighResPWM::configChannel(uint8_t channel, uint32_t set, uint32_t reset)
+{
+    shrtimer_channel_outputcfg_parameter_struct cfg;
+
+    shrtimer_channel_outputcfg_struct_para_init(&cfg);
+    cfg.set_request = set;
+    cfg.reset_request = reset;
+    cfg.fault_state = SHRTIMER_CHANNEL_FAULTSTATE_INACTIVE;
+    shrtimer_slavetimer_waveform_channel_config(SHRTIMER0, this->timer,
+                                                this->channelId(channel), &cfg);
+}
+
+/* SHRTIMER_STx_CHy of this Slave_TIMER */
+uint32_t HighResPWM::channelId(uint8_t channel)
+{
+    return ((channel == 0) ? SHRTIMER_ST0_CH0 : SHRTIMER_ST0_CH1) << (2 * this->timer);
+}
+
+#endif /* GD32E50X */
@@ -0,0 +1,82 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef HIGHRESPWM_H
+#define HIGHRESPWM_H
+
+#include "gd32xxyy.h"
+#include "gd32/PinNames.h"
+
+#if defined(GD32E50X)
+
+/* One Slave_TIMER (0 to 4) of the super high-resolution timer SHRTIMER. Times are in
+   nanoseconds and are counted at up to 64 times the system clock, so edges move in steps of
+   well under a nanosecond; longer periods fall back to coarser counter clocks (see
+   resolution()). Channel 0 is high from the start of the period for its duty time. Channel 1
+   either does the same with its own duty, or with setDeadTime() outputs the complement of
+   channel 0 with dead time around both edges. Enabled fault inputs drive both outputs
+   inactive until clearFault(). The SHRTIMER_ADCTRIGx outputs can fire at one point of the
+   period, to sample currents where the switches are quiet. Pins are given by the caller: the
+   datasheet of the part says which pin carries which SHRTIMER signal */
+class HighResPWM
+{
+    public:
+        HighResPWM(uint8_t slaveTimer);                                           //HighResPWM object construct
+        static bool attachPin(uint32_t pin);                                      //hand a pin to the SHRTIMER
+        bool begin(uint32_t periodNs);                                            //set the period, outputs stay off
+        bool setPeriod(uint32_t periodNs);                                        //change the period
+        bool setDuty(uint8_t channel, uint32_t highNs);                           //set the high time of a channel
+        bool setDeadTime(uint32_t risingNs, uint32_t fallingNs);                  //make channel 1 the complement of channel 0
+        bool clearDeadTime(void);                                                 //make channel 1 independent again
+        bool enableFault(uint8_t fault, bool activeHigh, uint32_t pin = NC,
+                         uint8_t filter = 0);                                     //stop the outputs on a fault input
+        bool setADCTrigger(uint8_t trigger, uint32_t atNs);                       //fire SHRTIMER_ADCTRIGx into the period
+        void start(void);                                                         //start counter and outputs
+        void stop(void);                                                          //stop counter and outputs
+        bool isFaulted(void);                                                     //check if a fault stopped the outputs
+        void clearFault(void);                                                    //restart the outputs after a fault
+        uint32_t resolution(void);                                                //get the duty step in picoseconds
+
+    private:
+        uint32_t toCounts(uint32_t ns, uint8_t shift);
+        uint32_t minCounts(void);
+        void applyConfig(void);
+        void configChannel(uint8_t channel, uint32_t set, uint32_t reset);
+        uint32_t channelId(uint8_t channel);
+        uint32_t timer;
+        uint32_t period;                                                          //in counts
+        uint8_t shift;                                                            //counts are 64 * fSHRTIMER_CK >> shift
+        uint32_t duty[2];                                                         //in ns, kept across period changes
+        uint32_t adcAt;                                                           //in ns, where the ADC triggers fire
+        uint32_t faults;                                                          //SHRTIMER_STXFAULTENABLE_x
+        bool deadTime;
+        bool running;
+};
+
+#endif /* GD32E50X */
+
+#endif /* HIGHRESPWM_H */
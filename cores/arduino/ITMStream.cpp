@@ -0,0 +1,121 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "ITMStream.h"
+
+ITMStream SWO;
+
+/*!
+    \brief      ITMStream object construct
+    \param[in]  port: stimulus port, 0 to 31
+    \param[out] none
+    \retval     none
+*/
+ITMStream::ITMStream(uint8_t port)
+{
+    this->port = port;
+}
+
+/*!
+    \brief      start the SWO output, shared by all ITMStream objects
+    \param[in]  baud: SWO bit rate, the probe must be set to the same
+    \param[out] none
+    \retval     false if the part has no SWO or baud can't be made
+*/
+bool ITMStream::begin(uint32_t baud)
+{
+    return itm_init(baud);
+}
+
+/*!
+    \brief      stop the SWO output, for all ITMStream objects
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void ITMStream::end(void)
+{
+    itm_deinit();
+}
+
+/*!
+    \brief      write one byte
+    \param[in]  c: byte to write
+    \param[out] none
+    \retval     1, also when the output is off
+*/
+size_t ITMStream::write(uint8_t c)
+{
+    itm_write(this->port, &c, 1U);
+    return 1;
+}
+
+/*!
+    \brief      write a buffer
+    \param[in]  buffer: bytes to write
+    \param[in]  size: number of bytes
+    \param[out] none
+    \retval     size, also when the output is off
+*/
+size_t ITMStream::write(const uint8_t *buffer, size_t size)
+{
+    itm_write(this->port, buffer, size);
+    return size;
+}
+
+/*!
+    \brief      bytes a write takes without waiting for the stimulus FIFO
+    \param[in]  none
+    \param[out] none
+    \retval     4, the size of one packet
+*/
+int ITMStream::availableForWrite(void)
+{
+    return 4;
+}
+
+/*!
+    \brief      write one value as a 32 bit packet, for event markers
+    \param[in]  value: value to send
+    \param[out] none
+    \retval     none
+*/
+void ITMStream::event(uint32_t value)
+{
+    itm_event(this->port, value);
+}
+
+/*!
+    \brief      check if output goes out
+    \param[in]  none
+    \param[out] none
+    \retval     false if the ITM or the port is off
+*/
+ITMStream::operator bool(void)
+{
+    return itm_port_enabled(this->port);
+}
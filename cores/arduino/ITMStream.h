@@ -0,0 +1,58 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef ITMSTREAM_H
+#define ITMSTREAM_H
+
+#include "api/Print.h"
+#include "gd32/itm.h"
+
+/* Print over an ITM stimulus port and the SWO pin, see itm.h. Writes cost a few cycles
+   and never wait for a UART or an interrupt, so logging hardly moves the timing of the
+   code it logs, also from interrupt handlers. Output is dropped while no SWO is set up.
+   Available on GD32F30x and GD32E50x */
+class ITMStream : public Print
+{
+    public:
+        ITMStream(uint8_t port = ITM_PORT_PRINT);                                 //ITMStream object construct
+        bool begin(uint32_t baud);                                                //start the SWO output
+        void end(void);                                                           //stop the SWO output
+        size_t write(uint8_t c);                                                  //write one byte
+        size_t write(const uint8_t *buffer, size_t size);                         //write a buffer
+        int availableForWrite(void);                                              //bytes a write takes without waiting
+        void event(uint32_t value);                                               //write one 32 bit packet
+        operator bool(void);                                                      //check if output goes out
+        using Print::write;
+
+    private:
+        uint8_t port;
+};
+
+/* text on ITM_PORT_PRINT */
+extern ITMStream SWO;
+
+#endif /* ITMSTREAM_H */
@@ -0,0 +1,344 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "KeyScanner.h"
+#include "HardwareTimer.h"
+#include "pins_arduino.h"
+
+/*!
+    \brief      KeyScanner object construct
+    \param[in]  rowPort: port of the row pins, PORTA, PORTB, ...
+    \param[in]  rowMask: the row pins, bit n is pin n; row 0 is the lowest
+    \param[in]  columnPort: port of the column pins
+    \param[in]  columnMask: the column pins; column 0 is the lowest
+    \param[out] none
+    \retval     none
+*/
+KeyScanner::KeyScanner(PortName rowPort, uint16_t rowMask, PortName columnPort, uint16_t columnMask)
+{
+    this->rowPort = rowPort;
+    this->columnPort = columnPort;
+    this->rowMask = rowMask;
+    this->columnMask = columnMask;
+    this->rows = 0;
+    this->debounceScans = 0;
+    this->channel = 0;
+    this->timer = NULL;
+    this->callback = NULL;
+    this->running = false;
+    this->scanCount = 0;
+    this->droppedCount = 0;
+    this->eventHead = 0;
+    this->eventTail = 0;
+}
+
+/*!
+    \brief      stop scanning, the DMA must not write into an object that is gone
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+KeyScanner::~KeyScanner(void)
+{
+    end();
+}
+
+/*!
+    \brief      DMA callback of the column reads, each half of the buffer is one complete scan
+    \param[in]  arg: the KeyScanner object
+    \param[in]  flags: DMA_CALLBACK_FLAG_x
+    \param[out] none
+    \retval     none
+*/
+void KeyScanner::dmaIrq(void *arg, uint32_t flags)
+{
+    KeyScanner *scanner = (KeyScanner *)arg;
+
+    if (flags & DMA_CALLBACK_FLAG_HTF) {
+        scanner->scan(scanner->samples);
+    }
+    if (flags & DMA_CALLBACK_FLAG_FTF) {
+        scanner->scan(scanner->samples + scanner->rows);
+    }
+}
+
+/*!
+    \brief      debounce one scan: a key changes once it has read the other way debounceScans
+                scans in a row, so bounces and single misreads never get through
+    \param[in]  samples: the column port, once per row
+    \param[out] none
+    \retval     none
+*/
+void KeyScanner::scan(const uint16_t *samples)
+{
+    for (uint8_t row = 0; row < this->rows; row++) {
+        /* columns read low are pressed */
+        uint16_t pressed = (uint16_t)~samples[row] & this->columnMask;
+        uint16_t changed = pressed ^ this->state[row];
+        uint16_t keys = changed | this->settling[row];
+
+        this->settling[row] = 0;
+        while (keys != 0U) {
+            uint8_t pin = (uint8_t)__builtin_ctz(keys);
+            uint16_t bit = (uint16_t)(1U << pin);
+
+            keys &= (uint16_t)(keys - 1U);
+            if (!(changed & bit)) {
+                /* back where it was, a bounce */
+                this->counts[row][pin] = 0;
+            } else if (++this->counts[row][pin] >= this->debounceScans) {
+                this->counts[row][pin] = 0;
+                this->state[row] ^= bit;
+                post(row, bit, (pressed & bit) != 0U);
+            } else {
+                this->settling[row] |= bit;
+            }
+        }
+    }
+    this->scanCount++;
+}
+
+/*!
+    \brief      report a key change to the callback, or queue it for read()
+    \param[in]  row: row index
+    \param[in]  bit: the column pin
+    \param[in]  pressed: new state of the key
+    \param[out] none
+    \retval     none
+*/
+void KeyScanner::post(uint8_t row, uint16_t bit, bool pressed)
+{
+    KeyEvent event;
+
+    event.row = row;
+    event.column = (uint8_t)__builtin_popcount(this->columnMask & (uint16_t)(bit - 1U));
+    event.pressed = pressed;
+    if (this->callback != NULL) {
+        this->callback(event);
+        return;
+    }
+    if ((uint8_t)(this->eventHead - this->eventTail) >= KEYSCANNER_EVENTS) {
+        this->droppedCount++;
+        return;
+    }
+    this->events[this->eventHead & (KEYSCANNER_EVENTS - 1U)] = event;
+    /* the event has to be in place before read() can see it */
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    this->eventHead++;
+}
+
+/*!
+    \brief      start scanning; the timer is set to rowTimeUs and started, so a scan takes the
+                number of rows times rowTimeUs. The columns are read three quarters into each
+                row's time, the rest of the matrix has that long to settle
+    \param[in]  timer: a timer with an update DMA request and a channel DMA request on another
+                DMA channel, which is picked among its channels
+    \param[in]  rowTimeUs: time each row is driven, in us
+    \param[in]  debounceScans: scans a key must read changed before it counts, 1 to 255
+    \param[in]  callback: called from the DMA interrupt for each key change, NULL to queue them
+                for read()
+    \param[out] none
+    \retval     false if the pins or the timer don't allow it, or its DMA channels are in use
+*/
+bool KeyScanner::begin(HardwareTimer &timer, uint32_t rowTimeUs, uint8_t debounceScans,
+                       keyScannerCallback_t callback)
+{
+    uint32_t instance = timer.getInstance();
+    uint32_t rowPins[KEYSCANNER_MAX_ROWS];
+    uint32_t reload;
+    uint8_t count = 0;
+    uint8_t ch;
+
+    end();
+    if ((this->rowPort >= GPIO_PORT_NUM) || (this->columnPort >= GPIO_PORT_NUM) || (this->columnMask == 0U) ||
+            (this->rowMask == 0U) || (rowTimeUs == 0U) || (debounceScans == 0U) ||
+            ((this->rowPort == this->columnPort) && (this->rowMask & this->columnMask))) {
+        return false;
+    }
+    for (uint8_t pin = 0; pin < 16U; pin++) {
+        if (this->rowMask & (1U << pin)) {
+            if (count == KEYSCANNER_MAX_ROWS) {
+                return false;
+            }
+            rowPins[count++] = 1UL << pin;
+        }
+    }
+    /* row r low and all others high; the DMA starts at row 1, row 0 is driven before the start */
+    for (uint8_t row = 0; row < count; row++) {
+        uint32_t low = rowPins[(row + 1U) % count];
+        this->rowWords[row] = (low << 16) | (this->rowMask & ~low);
+    }
+    this->rows = count;
+    this->debounceScans = debounceScans;
+    this->callback = callback;
+    this->timer = &timer;
+    for (uint8_t row = 0; row < count; row++) {
+        this->state[row] = 0;
+        this->settling[row] = 0;
+        for (uint8_t pin = 0; pin < 16U; pin++) {
+            this->counts[row][pin] = 0;
+        }
+    }
+    this->eventHead = 0;
+    this->eventTail = 0;
+
+    gpio_clock_enable(this->rowPort);
+    gpio_clock_enable(this->columnPort);
+    timer.stop();
+    timer.setPeriodTime(rowTimeUs, FORMAT_US);
+    reload = TIMER_CAR(instance);
+    timer_counter_value_config(instance, 0);
+    if (!Timer_updateDmaStart(instance, (uint32_t)&GPIO_BOP(gpio_port[this->rowPort]), this->rowWords, count, 1U,
+                              NULL, NULL)) {
+        return false;
+    }
+    /* the first channel whose DMA isn't the update one and is free */
+    for (ch = TIMER_CH_0; ch <= TIMER_CH_3; ch++) {
+        if (Timer_compareDmaSample(instance, ch, reload - reload / 4U,
+                                   (uint32_t)portInputRegister(gpio_port[this->columnPort]), this->samples,
+                                   2U * count, 2U, dmaIrq, this)) {
+            break;
+        }
+    }
+    if (ch > TIMER_CH_3) {
+        Timer_updateDmaStop(instance);
+        return false;
+    }
+    this->channel = ch;
+    GPIO_BOP(gpio_port[this->rowPort]) = (rowPins[0] << 16) | (this->rowMask & ~rowPins[0]);
+    this->running = true;
+    timer.start();
+    return true;
+}
+
+/*!
+    \brief      stop scanning and drive all rows high; the timer is left stopped, the keys keep
+                their last state
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void KeyScanner::end(void)
+{
+    if (!this->running) {
+        return;
+    }
+    this->timer->stop();
+    Timer_captureDmaStop(this->timer->getInstance(), this->channel);
+    Timer_updateDmaStop(this->timer->getInstance());
+    GPIO_BOP(gpio_port[this->rowPort]) = this->rowMask;
+    this->running = false;
+}
+
+/*!
+    \brief      check if scanning
+    \param[in]  none
+    \param[out] none
+    \retval     true while scanning
+*/
+bool KeyScanner::isRunning(void)
+{
+    return this->running;
+}
+
+/*!
+    \brief      take the oldest key change from the queue, which only fills without a callback
+    \param[in]  none
+    \param[out] event: the change
+    \retval     false if there is none
+*/
+bool KeyScanner::read(KeyEvent &event)
+{
+    if (this->eventHead == this->eventTail) {
+        return false;
+    }
+    event = this->events[this->eventTail & (KEYSCANNER_EVENTS - 1U)];
+    /* and copied out before post() may reuse its slot */
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    this->eventTail++;
+    return true;
+}
+
+/*!
+    \brief      get the debounced state of a key
+    \param[in]  row: row index
+    \param[in]  column: column index
+    \param[out] none
+    \retval     true if it is pressed
+*/
+bool KeyScanner::isPressed(uint8_t row, uint8_t column)
+{
+    return (rowState(row) >> column) & 1U;
+}
+
+/*!
+    \brief      get the debounced state of the keys of a row
+    \param[in]  row: row index
+    \param[out] none
+    \retval     bit n set if the key in column n is pressed
+*/
+uint16_t KeyScanner::rowState(uint8_t row)
+{
+    uint16_t pins, keys = 0;
+    uint8_t column = 0;
+
+    if (row >= this->rows) {
+        return 0;
+    }
+    pins = this->state[row];
+    for (uint8_t pin = 0; pin < 16U; pin++) {
+        if (this->columnMask & (1U << pin)) {
+            if (pins & (1U << pin)) {
+                keys |= (uint16_t)(1U << column);
+            }
+            column++;
+        }
+    }
+    return keys;
+}
+
+/*!
+    \brief      get the number of complete scans, to check the scan rate or wait for a fresh scan
+    \param[in]  none
+    \param[out] none
+    \retval     scans since begin()
+*/
+uint32_t KeyScanner::scans(void)
+{
+    return this->scanCount;
+}
+
+/*!
+    \brief      get the number of key changes dropped because read() fell behind
+    \param[in]  none
+    \param[out] none
+    \retval     changes lost
+*/
+uint32_t KeyScanner::dropped(void)
+{
+    return this->droppedCount;
+}
@@ -0,0 +1,110 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef KEYSCANNER_H
+#define KEYSCANNER_H
+
+#include "timer.h"
+#include "PortNames.h"
+
+class HardwareTimer;
+
+/* rows a KeyScanner drives, at most the 16 pins of a port */
+#ifndef KEYSCANNER_MAX_ROWS
+#define KEYSCANNER_MAX_ROWS     16
+#endif
+/* key changes read() can fall behind by before they are dropped, a power of 2 */
+#ifndef KEYSCANNER_EVENTS
+#define KEYSCANNER_EVENTS       32
+#endif
+
+typedef struct {
+    uint8_t row;        //index of the row pin among the rows, 0 for the lowest pin
+    uint8_t column;     //index of the column pin among the columns
+    bool pressed;
+} KeyEvent;
+
+/* a key changed, after debouncing; called from the DMA interrupt */
+typedef void(*keyScannerCallback_t)(const KeyEvent &event);
+
+/* Key matrix scanning without the CPU: at every update of a timer DMA drives the next row low
+   (GPIO_BOP, like PortPattern), and at a compare event late in the same period a second DMA
+   copies the column port's input register (like PortSampler), so every row is read a fixed time
+   after it was selected. An interrupt comes once per complete scan, when it debounces each key
+   and queues its changes for read() or hands them to the callback. Rows are pins of one port,
+   columns pins of another or the same one; the rows are set up with pinMode(OUTPUT) and the
+   columns with pinMode(INPUT_PULLUP) first, a key (and its diode, anode on the column) connects
+   its column to its row. A timer serves one KeyScanner, PortPattern or PortSampler at a time */
+class KeyScanner
+{
+    public:
+        KeyScanner(PortName rowPort, uint16_t rowMask, PortName columnPort,
+                   uint16_t columnMask);                                        //KeyScanner object construct
+        ~KeyScanner(void);                                                       //stop scanning
+        bool begin(HardwareTimer &timer, uint32_t rowTimeUs = 100, uint8_t debounceScans = 5,
+                   keyScannerCallback_t callback = NULL);                        //start scanning
+        void end(void);                                                          //stop scanning, rows high
+        bool isRunning(void);                                                    //check if scanning
+        bool read(KeyEvent &event);                                              //take the oldest key change
+        bool isPressed(uint8_t row, uint8_t column);                             //debounced state of a key
+        uint16_t rowState(uint8_t row);                                          //debounced keys of a row, bit n is column n
+        uint32_t scans(void);                                                    //complete scans so far
+        uint32_t dropped(void);                                                  //key changes read() lost
+
+    private:
+        static void dmaIrq(void *arg, uint32_t flags);
+        void scan(const uint16_t *samples);
+        void post(uint8_t row, uint16_t bit, bool pressed);
+
+        PortName rowPort;
+        PortName columnPort;
+        uint16_t rowMask;
+        uint16_t columnMask;
+        uint8_t rows;
+        uint8_t debounceScans;
+        uint8_t channel;
+        HardwareTimer *timer;
+        keyScannerCallback_t callback;
+        bool running;
+
+        uint32_t rowWords[KEYSCANNER_MAX_ROWS];                                  //GPIO_BOP words, row 1 first
+        uint16_t samples[2 * KEYSCANNER_MAX_ROWS];                               //two scans of the column port
+        volatile uint16_t state[KEYSCANNER_MAX_ROWS];                           //debounced, port bits, 1 pressed
+        uint16_t settling[KEYSCANNER_MAX_ROWS];                                 //keys whose count is running
+        uint8_t counts[KEYSCANNER_MAX_ROWS][16];                                 //scans a key has read changed
+        volatile uint32_t scanCount;
+        volatile uint32_t droppedCount;
+
+        KeyEvent events[KEYSCANNER_EVENTS];
+        volatile uint8_t eventHead;
+        volatile uint8_t eventTail;
+        static_assert((KEYSCANNER_EVENTS & (KEYSCANNER_EVENTS - 1)) == 0 && KEYSCANNER_EVENTS <= 128,
+                      "KEYSCANNER_EVENTS must be a power of 2 up to 128");
+        static_assert(KEYSCANNER_MAX_ROWS <= 16, "KEYSCANNER_MAX_ROWS is at most 16");
+};
+
+#endif /* KEYSCANNER_H */
@@ -0,0 +1,182 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "LowPower.h"
+#include "HardwareRTC.h"
+#include "gd32/gpio_interrupt.h"
+
+LowPowerClass LowPower;
+
+/*!
+    \brief      receive pin interrupt of the port set with enableWakeupFrom()
+    \param[in]  callback: the user callback, or NULL
+    \param[out] none
+    \retval     none
+*/
+static void serialWakeup(void *callback)
+{
+    if (NULL != callback) {
+        ((voidFuncPtr)callback)();
+    }
+}
+
+/*!
+    \brief      sleep mode, the core stops until the next interrupt
+    \param[in]  ms: keep sleeping until this many milliseconds passed, 0 for one interrupt
+    \param[out] none
+    \retval     none
+*/
+void LowPowerClass::sleep(uint32_t ms)
+{
+    uint32_t start = millis();
+
+    /* SysTick wakes the core every millisecond */
+    do {
+        power_sleep();
+    } while (millis() - start < ms);
+}
+
+/*!
+    \brief      deep-sleep mode, all high speed clocks stop until an EXTI line fires
+    \param[in]  ms: wake up by RTC alarm after this, 0 to wait for EXTI only
+    \param[out] none
+    \retval     none
+*/
+void LowPowerClass::deepSleep(uint32_t ms)
+{
+    bool alarm = (ms != 0) && setAlarm(ms);
+    PinName rx = NC;
+
+    if (NULL != wakeSerial) {
+        rx = wakeSerial->getRxPin();
+        /* the USART has no clock in deep-sleep, the first start bit is seen by EXTI
+         * and the character it begins is lost */
+        gpio_interrupt_enable_param(GD_PORT_GET(rx), GD_PIN_GET(rx), serialWakeup,
+                                    (void *)wakeSerialCallback, EXTI_TRIG_FALLING);
+    }
+
+    power_deepsleep();
+
+    if (NC != rx) {
+        gpio_interrupt_disable(GD_PIN_GET(rx));
+    }
+    if (alarm) {
+        rtc_detachInterrupt(INT_ALARM_MODE);
+    }
+}
+
+/*!
+    \brief      standby mode, only the backup domain stays powered
+    \param[in]  ms: wake up by RTC alarm after this, 0 for the WKUP pin only
+    \param[out] none
+    \retval     none, the part wakes up through reset
+*/
+void LowPowerClass::standby(uint32_t ms)
+{
+    if (ms != 0) {
+        setAlarm(ms);
+    }
+    power_standby();
+}
+
+/*!
+    \brief      attach a pin interrupt, which wakes up from sleep and deep-sleep too
+    \param[in]  pin: arduino pin number
+    \param[in]  callback: called from the interrupt after the clocks are restored
+    \param[in]  mode: RISING, FALLING or CHANGE
+    \param[out] none
+    \retval     none
+*/
+void LowPowerClass::attachInterruptWakeup(uint32_t pin, voidFuncPtr callback, PinStatus mode)
+{
+    attachInterrupt(pin, callback, mode);
+}
+
+/*!
+    \brief      wake up from deep-sleep when a character starts on a serial port
+    \param[in]  serial: the port, begin() must have been called
+    \param[in]  callback: called from the interrupt on wakeup, may be NULL
+    \param[out] none
+    \retval     none
+*/
+void LowPowerClass::enableWakeupFrom(HardwareSerial *serial, voidFuncPtr callback)
+{
+    this->wakeSerial = serial;
+    this->wakeSerialCallback = callback;
+}
+
+/*!
+    \brief      stop waking up from deep-sleep on serial reception
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void LowPowerClass::disableWakeupFrom(void)
+{
+    this->wakeSerial = NULL;
+    this->wakeSerialCallback = NULL;
+}
+
+/*!
+    \brief      let a rising edge on the WKUP pin (PA0) end standby
+    \param[in]  enable: true to enable
+    \param[out] none
+    \retval     none
+*/
+void LowPowerClass::enableWakeupPin(bool enable)
+{
+    power_wakeup_pin(enable);
+}
+
+/*!
+    \brief      check if the last reset was a wakeup from standby, clears the flag
+    \param[in]  none
+    \param[out] none
+    \retval     true after a wakeup from standby
+*/
+bool LowPowerClass::wokeFromStandby(void)
+{
+    return power_woke_from_standby();
+}
+
+/*!
+    \brief      arm the RTC alarm ms from now, rounded up to whole seconds
+    \param[in]  ms: milliseconds
+    \param[out] none
+    \retval     false where the RTC has no alarm
+*/
+bool LowPowerClass::setAlarm(uint32_t ms)
+{
+#if defined(GD32E23x)
+    (void)ms;
+    return false;
+#else
+    rtc.setAlarmTime((ms + 999U) / 1000U, RTC_ALARM_S);
+    rtc_attachInterrupt(INT_ALARM_MODE);
+    return true;
+#endif
+}
@@ -0,0 +1,66 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef _GD_LOWPOWER_H_
+#define _GD_LOWPOWER_H_
+
+#include "Arduino.h"
+#include "gd32/power.h"
+
+/*
+ * sleep() halts the core, peripherals and millis() keep running.
+ * deepSleep() stops every high speed clock: only EXTI wakes it up, i.e. pin
+ * interrupts, the receive pin of a port given to enableWakeupFrom(), or the
+ * RTC alarm. millis() stands still meanwhile, and serial output still in
+ * the FIFO is lost, so flush() first. standby() keeps only the backup
+ * domain powered and wakes up through reset, from the WKUP pin or the RTC.
+ *
+ * A timeout makes deepSleep() and standby() set the RTC alarm, so it needs
+ * the 32.768 kHz LXTAL and is rounded up to whole seconds. Not on GD32E23x.
+ */
+class LowPowerClass
+{
+    public:
+        void sleep(uint32_t ms = 0);                                      //WFI, until next interrupt or ms passed
+        void deepSleep(uint32_t ms = 0);                                  //deep-sleep, until EXTI or ms passed
+        void standby(uint32_t ms = 0);                                    //standby, wakes up through reset
+        void attachInterruptWakeup(uint32_t pin, voidFuncPtr callback,
+                                   PinStatus mode);                       //pin interrupt that also wakes up
+        void enableWakeupFrom(HardwareSerial *serial,
+                              voidFuncPtr callback = NULL);               //wake from deep-sleep on RX start bit
+        void disableWakeupFrom(void);                                     //stop waking on RX
+        void enableWakeupPin(bool enable = true);                         //WKUP pin (PA0) ends standby
+        bool wokeFromStandby(void);                                       //last reset came from standby
+    private:
+        bool setAlarm(uint32_t ms);
+        HardwareSerial *wakeSerial = NULL;
+        voidFuncPtr wakeSerialCallback = NULL;
+};
+
+extern LowPowerClass LowPower;
+
+#endif /* _GD_LOWPOWER_H_ */
@@ -0,0 +1,185 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "PortPattern.h"
+#include "HardwareTimer.h"
+#include "pins_arduino.h"
+
+/*!
+    \brief      PortPattern object construct
+    \param[in]  port: PORTA, PORTB, ...
+    \param[out] none
+    \retval     none
+*/
+PortPattern::PortPattern(PortName port)
+{
+    this->port = port;
+    this->timer = 0;
+    this->length = 0;
+    this->loop = false;
+    this->callback = NULL;
+    this->running = false;
+}
+
+/*!
+    \brief      stop output, the DMA must not read a buffer the object no longer tracks
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+PortPattern::~PortPattern(void)
+{
+    end();
+}
+
+/*!
+    \brief      DMA callback, hands each half of a loop to the user callback for refilling, ends
+                a single pass
+    \param[in]  arg: the PortPattern object
+    \param[in]  flags: DMA_CALLBACK_FLAG_x
+    \param[out] none
+    \retval     none
+*/
+void PortPattern::dmaIrq(void *arg, uint32_t flags)
+{
+    PortPattern *pattern = (PortPattern *)arg;
+    portPatternCallback_t callback = pattern->callback;
+    size_t half = pattern->length / 2;
+
+    if (!pattern->loop) {
+        if (flags & DMA_CALLBACK_FLAG_FTF) {
+            /* the last word is out, the timer runs on without writes */
+            Timer_updateDmaStop(pattern->timer);
+            pattern->callback = NULL;
+            pattern->running = false;
+            if (callback != NULL) {
+                callback(0, pattern->length);
+            }
+        }
+        return;
+    }
+    if (callback == NULL) {
+        return;
+    }
+    if (flags & DMA_CALLBACK_FLAG_HTF) {
+        callback(0, half);
+    }
+    if (flags & DMA_CALLBACK_FLAG_FTF) {
+        callback(half, pattern->length - half);
+    }
+}
+
+/*!
+    \brief      write the buffer to the port, one word per update of the timer
+    \param[in]  timer: a timer with an update DMA request, its period is the step interval
+    \param[in]  buffer: GPIO_BOP words, must stay valid while running
+    \param[in]  length: number of words, even for a loop with a callback so both halves can be
+                refilled in turn
+    \param[in]  loop: start over at the first word after the last one until end()
+    \param[in]  callback: called from the DMA interrupt with each half of a loop once it was
+                written, or once when a single pass is done
+    \param[out] none
+    \retval     false if the timer has no update DMA request or its DMA channel is in use
+*/
+bool PortPattern::begin(HardwareTimer &timer, const uint32_t *buffer, size_t length, bool loop,
+                        portPatternCallback_t callback)
+{
+    end();
+    if ((buffer == NULL) || (length == 0U) || (loop && (callback != NULL) && ((length % 2U) != 0U)) ||
+            (this->port >= GPIO_PORT_NUM)) {
+        return false;
+    }
+    gpio_clock_enable(this->port);
+    this->timer = timer.getInstance();
+    this->length = length;
+    this->loop = loop;
+    this->callback = callback;
+    /* a single pass needs the interrupt to give the channel back */
+    this->running = true;
+    if (!Timer_updateDmaStart(this->timer, (uint32_t)&GPIO_BOP(gpio_port[this->port]), buffer, length,
+                              loop ? 1U : 0U, (loop && (callback == NULL)) ? NULL : dmaIrq, this)) {
+        this->callback = NULL;
+        this->running = false;
+    }
+    return this->running;
+}
+
+/*!
+    \brief      stop output, the pins keep the level of the last word written; the timer keeps running
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void PortPattern::end(void)
+{
+    if (!this->running) {
+        return;
+    }
+    Timer_updateDmaStop(this->timer);
+    this->callback = NULL;
+    this->running = false;
+}
+
+/*!
+    \brief      check if output is running, a single pass stops by itself after the last word
+    \param[in]  none
+    \param[out] none
+    \retval     true while running
+*/
+bool PortPattern::isRunning(void)
+{
+    return this->running;
+}
+
+/*!
+    \brief      get the buffer index of the next word to be written
+    \param[in]  none
+    \param[out] none
+    \retval     index into the buffer, 0 when not running
+*/
+size_t PortPattern::bufferIndex(void)
+{
+    size_t remaining;
+
+    if (!this->running) {
+        return 0;
+    }
+    remaining = Timer_updateDmaRemaining(this->timer);
+    return (remaining == 0U) ? 0U : this->length - remaining;
+}
+
+/*!
+    \brief      build a GPIO_BOP word
+    \param[in]  mask: pins the word drives, bit n is pin n
+    \param[in]  value: level of each of those pins
+    \param[out] none
+    \retval     the word, pins outside mask keep their level
+*/
+uint32_t PortPattern::word(uint16_t mask, uint16_t value)
+{
+    return ((uint32_t)(mask & (uint16_t)~value) << 16) | (uint32_t)(mask & value);
+}
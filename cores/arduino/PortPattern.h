@@ -0,0 +1,67 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef PORTPATTERN_H
+#define PORTPATTERN_H
+
+#include "timer.h"
+#include "PortNames.h"
+
+class HardwareTimer;
+
+/* words from index on were written out and may be refilled, or the single pass is done */
+typedef void(*portPatternCallback_t)(size_t index, size_t count);
+
+/* Writes a buffer of GPIO_BOP words to a port at the update rate of a timer, by DMA from the timer
+   update request, so the pins change with the timer clock and the CPU does nothing per step. The
+   low half of a word sets pins, the high half clears them, pins in neither keep their level, so
+   several patterns on different pins of a port don't disturb each other; word() builds one. The
+   buffer may lie in flash. The timer keeps its own period and is started by the sketch, the pins
+   are set up with pinMode() first. A timer serves one PortPattern or PortSampler at a time */
+class PortPattern
+{
+    public:
+        PortPattern(PortName port);                                               //PortPattern object construct
+        ~PortPattern(void);                                                       //stop output
+        bool begin(HardwareTimer &timer, const uint32_t *buffer, size_t length,
+                   bool loop = false, portPatternCallback_t callback = NULL);     //write the buffer out
+        void end(void);                                                           //stop output
+        bool isRunning(void);                                                     //check if output is running
+        size_t bufferIndex(void);                                                 //get index of the next word
+        static uint32_t word(uint16_t mask, uint16_t value);                      //BOP word driving mask pins to value
+
+    private:
+        static void dmaIrq(void *arg, uint32_t flags);
+        PortName port;
+        uint32_t timer;
+        size_t length;
+        bool loop;
+        portPatternCallback_t callback;
+        volatile bool running;
+};
+
+#endif /* PORTPATTERN_H */
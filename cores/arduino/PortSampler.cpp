@@ -0,0 +1,205 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "PortSampler.h"
+#include "HardwareTimer.h"
+#include "pins_arduino.h"
+
+/*!
+    \brief      PortSampler object construct
+    \param[in]  port: PORTA, PORTB, ...
+    \param[out] none
+    \retval     none
+*/
+PortSampler::PortSampler(PortName port)
+{
+    this->port = port;
+    this->timer = 0;
+    this->buffer = NULL;
+    this->length = 0;
+    this->width = 2;
+    this->callback = NULL;
+    this->callback8 = NULL;
+    this->running = false;
+}
+
+/*!
+    \brief      stop sampling, the DMA must not write the buffer of a destroyed object
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+PortSampler::~PortSampler(void)
+{
+    end();
+}
+
+/*!
+    \brief      DMA callback, hands each half of the buffer that was filled to the user callback
+    \param[in]  arg: the PortSampler object
+    \param[in]  flags: DMA_CALLBACK_FLAG_x
+    \param[out] none
+    \retval     none
+*/
+void PortSampler::dmaIrq(void *arg, uint32_t flags)
+{
+    PortSampler *sampler = (PortSampler *)arg;
+    size_t half = sampler->length / 2;
+
+    if (sampler->width == 1U) {
+        uint8_t *samples = (uint8_t *)sampler->buffer;
+
+        if (sampler->callback8 == NULL) {
+            return;
+        }
+        if (flags & DMA_CALLBACK_FLAG_HTF) {
+            sampler->callback8(samples, half);
+        }
+        if (flags & DMA_CALLBACK_FLAG_FTF) {
+            sampler->callback8(samples + half, sampler->length - half);
+        }
+    } else {
+        uint16_t *samples = (uint16_t *)sampler->buffer;
+
+        if (sampler->callback == NULL) {
+            return;
+        }
+        if (flags & DMA_CALLBACK_FLAG_HTF) {
+            sampler->callback(samples, half);
+        }
+        if (flags & DMA_CALLBACK_FLAG_FTF) {
+            sampler->callback(samples + half, sampler->length - half);
+        }
+    }
+}
+
+/*!
+    \brief      start sampling
+    \param[in]  timer: timer setting the sample rate
+    \param[in]  buffer: ring buffer
+    \param[in]  length: number of samples in buffer
+    \param[in]  width: bytes per sample, 1 or 2
+    \param[in]  halves: a callback wants each half of the buffer
+    \param[out] none
+    \retval     false if the timer has no update DMA request or its DMA channel is in use
+*/
+bool PortSampler::start(HardwareTimer &timer, void *buffer, size_t length, uint8_t width, bool halves)
+{
+    if ((buffer == NULL) || (length == 0U) || (halves && ((length % 2U) != 0U)) ||
+            (this->port >= GPIO_PORT_NUM)) {
+        return false;
+    }
+    gpio_clock_enable(this->port);
+    this->timer = timer.getInstance();
+    this->buffer = buffer;
+    this->length = length;
+    this->width = width;
+    this->running = Timer_updateDmaSample(this->timer, (uint32_t)portInputRegister(gpio_port[this->port]),
+                                          buffer, length, width, halves ? dmaIrq : NULL, this) != 0;
+    return this->running;
+}
+
+/*!
+    \brief      copy the input register of the port into the buffer over and over, one sample per
+                update of the timer
+    \param[in]  timer: a timer with an update DMA request, its period is the sample interval
+    \param[in]  buffer: ring buffer of samples, bit n is pin n, must stay valid while running
+    \param[in]  length: number of samples in buffer, even so both halves can be read in turn
+    \param[in]  callback: called from the DMA interrupt with each half of the buffer once it is filled
+    \param[out] none
+    \retval     false if the timer has no update DMA request or its DMA channel is in use
+*/
+bool PortSampler::begin(HardwareTimer &timer, uint16_t *buffer, size_t length, portSamplerCallback_t callback)
+{
+    end();
+    this->callback = callback;
+    this->callback8 = NULL;
+    return start(timer, buffer, length, 2U, callback != NULL);
+}
+
+/*!
+    \brief      copy pins 0..7 of the port into the buffer over and over, one sample per update of
+                the timer; half the memory of 16-bit samples for the same time
+    \param[in]  timer: a timer with an update DMA request, its period is the sample interval
+    \param[in]  buffer: ring buffer of samples, bit n is pin n, must stay valid while running
+    \param[in]  length: number of samples in buffer, even so both halves can be read in turn
+    \param[in]  callback: called from the DMA interrupt with each half of the buffer once it is filled
+    \param[out] none
+    \retval     false if the timer has no update DMA request or its DMA channel is in use
+*/
+bool PortSampler::begin(HardwareTimer &timer, uint8_t *buffer, size_t length, portSampler8Callback_t callback)
+{
+    end();
+    this->callback = NULL;
+    this->callback8 = callback;
+    return start(timer, buffer, length, 1U, callback != NULL);
+}
+
+/*!
+    \brief      stop sampling, the timer keeps running
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void PortSampler::end(void)
+{
+    if (!this->running) {
+        return;
+    }
+    Timer_updateDmaStop(this->timer);
+    this->callback = NULL;
+    this->callback8 = NULL;
+    this->running = false;
+}
+
+/*!
+    \brief      check if sampling is running
+    \param[in]  none
+    \param[out] none
+    \retval     true while running
+*/
+bool PortSampler::isRunning(void)
+{
+    return this->running;
+}
+
+/*!
+    \brief      get the buffer index the next sample is written to
+    \param[in]  none
+    \param[out] none
+    \retval     index into the sample buffer
+*/
+size_t PortSampler::bufferIndex(void)
+{
+    size_t remaining;
+
+    if (!this->running) {
+        return 0;
+    }
+    remaining = Timer_updateDmaRemaining(this->timer);
+    return (remaining == 0U) ? 0U : this->length - remaining;
+}
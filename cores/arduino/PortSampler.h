@@ -0,0 +1,73 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef PORTSAMPLER_H
+#define PORTSAMPLER_H
+
+#include "timer.h"
+#include "PortNames.h"
+
+class HardwareTimer;
+
+/* samples points at the half of the buffer that was just filled and may be read */
+typedef void(*portSamplerCallback_t)(uint16_t *samples, size_t count);
+typedef void(*portSampler8Callback_t)(uint8_t *samples, size_t count);
+
+/* Logic analyzer: copies the input register of a GPIO port into a ring buffer at the update rate
+   of a timer, by DMA from the timer update request, so the CPU does nothing per sample. Samples
+   are 16 bits for the whole port or 8 bits for pins 0..7. The timer keeps its own period and is
+   started by the sketch; a few MHz are reached, how many depends on the other DMA and bus traffic,
+   and the DMA arbitration adds a few bus clocks of jitter to each sample. The pins are sampled
+   as they are, set them up with pinMode() first. A timer serves one PortSampler or PortPattern
+   at a time */
+class PortSampler
+{
+    public:
+        PortSampler(PortName port);                                               //PortSampler object construct
+        ~PortSampler(void);                                                       //stop sampling
+        bool begin(HardwareTimer &timer, uint16_t *buffer, size_t length,
+                   portSamplerCallback_t callback = NULL);                        //sample all 16 pins
+        bool begin(HardwareTimer &timer, uint8_t *buffer, size_t length,
+                   portSampler8Callback_t callback = NULL);                       //sample pins 0..7
+        void end(void);                                                           //stop sampling
+        bool isRunning(void);                                                     //check if sampling is running
+        size_t bufferIndex(void);                                                 //get index of the next sample
+
+    private:
+        static void dmaIrq(void *arg, uint32_t flags);
+        bool start(HardwareTimer &timer, void *buffer, size_t length, uint8_t width, bool halves);
+        PortName port;
+        uint32_t timer;
+        void *buffer;
+        size_t length;
+        uint8_t width;
+        portSamplerCallback_t callback;
+        portSampler8Callback_t callback8;
+        bool running;
+};
+
+#endif /* PORTSAMPLER_H */
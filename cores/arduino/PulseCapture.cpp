@@ -0,0 +1,187 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "PulseCapture.h"
+#include "HardwareTimer.h"
+#include "pins_arduino.h"
+
+/*!
+    \brief      convert a pulse width from timer ticks to nanoseconds
+    \param[in]  ticks: width in timer ticks
+    \param[in]  tick_hz: timer tick frequency
+    \param[out] none
+    \retval     width in ns, saturated at 0xFFFFFFFF
+*/
+static uint32_t pulseTicksToNs(uint32_t ticks, uint32_t tick_hz)
+{
+    uint64_t ns;
+
+    if (tick_hz == 0U) {
+        return 0;
+    }
+    ns = (uint64_t)ticks * 1000000000ULL / tick_hz;
+    return (ns > 0xFFFFFFFFULL) ? 0xFFFFFFFFUL : (uint32_t)ns;
+}
+
+/*!
+    \brief      route the pin to its timer and start a measurement
+    \param[in]  pulse: state of the measurement
+    \param[in]  pin: PWM capable pin
+    \param[in]  state: HIGH or LOW, the level of the pulse
+    \param[in]  timeout: microseconds to wait for the end of a pulse
+    \param[in]  callback: called from the timer interrupt when done, NULL to poll
+    \param[in]  arg: passed through to the callback
+    \param[out] none
+    \retval     tick frequency in Hz, 0 if the pin has no usable timer channel
+*/
+static uint32_t pulseStart(timerPulse_t *pulse, uint32_t pin, uint32_t state, uint32_t timeout,
+                           timerPulseCallback_t callback, void *arg)
+{
+    PinName pinname = DIGITAL_TO_PINNAME(pin);
+    pwmDevice_t device;
+
+    if ((PinName)NC == pinname) {
+        return 0;
+    }
+    device = getTimerDeviceFromPinname(pinname);
+    if ((uint32_t)NC == device.timer) {
+        return 0;
+    }
+    captureInputPinInit(pin);
+    return Timer_pulseStart(pulse, device.timer, device.channel, (state != 0U) ? 1U : 0U, timeout,
+                            callback, arg);
+}
+
+uint32_t pulseInCapture(uint32_t pin, uint32_t state, uint32_t timeout)
+{
+    timerPulse_t pulse = {};
+    uint32_t tick_hz = pulseStart(&pulse, pin, state, timeout, NULL, NULL);
+
+    if (tick_hz == 0U) {
+        return 0;
+    }
+    while (!Timer_pulsePoll(&pulse)) {
+    }
+    return pulseTicksToNs(pulse.width, tick_hz);
+}
+
+/*!
+    \brief      PulseCapture object construct
+    \param[in]  pin: PWM capable pin
+    \param[out] none
+    \retval     none
+*/
+PulseCapture::PulseCapture(uint32_t pin)
+{
+    this->pin = pin;
+    this->tickHz = 0;
+    this->pulse = {};
+    this->callback = NULL;
+    this->arg = NULL;
+}
+
+/*!
+    \brief      abort a running measurement, the timer must not write into a destroyed object
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+PulseCapture::~PulseCapture(void)
+{
+    end();
+}
+
+/*!
+    \brief      timer interrupt callback of a finished measurement
+    \param[in]  arg: the PulseCapture object
+    \param[in]  ticks: width in timer ticks, 0 on timeout
+    \param[out] none
+    \retval     none
+*/
+void PulseCapture::pulseDone(void *arg, uint32_t ticks)
+{
+    PulseCapture *capture = (PulseCapture *)arg;
+
+    if (NULL != capture->callback) {
+        capture->callback(capture->arg, pulseTicksToNs(ticks, capture->tickHz));
+    }
+}
+
+/*!
+    \brief      start measuring the next pulse, a pulse already running when called is skipped
+    \param[in]  state: HIGH or LOW, the level of the pulse
+    \param[in]  timeout: microseconds to wait for the end of a pulse
+    \param[in]  callback: called from the timer interrupt with the width, may be NULL
+    \param[in]  arg: passed through to the callback
+    \param[out] none
+    \retval     false if the pin has no timer channel pair
+*/
+bool PulseCapture::begin(uint32_t state, uint32_t timeout, pulseCaptureCallback_t callback,
+                         void *arg)
+{
+    end();
+    this->callback = callback;
+    this->arg = arg;
+    this->tickHz = pulseStart(&this->pulse, this->pin, state, timeout, pulseDone, this);
+    return this->tickHz != 0U;
+}
+
+/*!
+    \brief      check if the measurement is done
+    \param[in]  none
+    \param[out] none
+    \retval     true once a pulse was measured or the timeout expired
+*/
+bool PulseCapture::available(void)
+{
+    return TIMER_PULSE_DONE == this->pulse.phase;
+}
+
+/*!
+    \brief      get the result of the last measurement
+    \param[in]  none
+    \param[out] none
+    \retval     width in ns, 0 on timeout or while not done
+*/
+uint32_t PulseCapture::read(void)
+{
+    if (!available()) {
+        return 0;
+    }
+    return pulseTicksToNs(this->pulse.width, this->tickHz);
+}
+
+/*!
+    \brief      abort a running measurement
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void PulseCapture::end(void)
+{
+    Timer_pulseStop(&this->pulse);
+}
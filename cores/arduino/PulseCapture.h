@@ -0,0 +1,65 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef PULSECAPTURE_H
+#define PULSECAPTURE_H
+
+#include "timer.h"
+
+/* width in nanoseconds, 0 if no complete pulse was seen before the timeout */
+typedef void(*pulseCaptureCallback_t)(void *arg, uint32_t width_ns);
+
+/* Measures one pulse on a PWM capable pin (PinMap_PWM) with the input capture of its timer:
+   the leading and trailing edge are latched by hardware, so the width has the resolution of the
+   timer clock and the CPU is free while waiting. The timer of the pin must not be used for
+   anything else during a measurement */
+class PulseCapture
+{
+    public:
+        PulseCapture(uint32_t pin);                                               //PulseCapture object construct
+        ~PulseCapture(void);                                                      //abort a running measurement
+        bool begin(uint32_t state, uint32_t timeout = 1000000UL,
+                   pulseCaptureCallback_t callback = NULL, void *arg = NULL);     //start measuring a pulse
+        bool available(void);                                                     //check if the measurement is done
+        uint32_t read(void);                                                      //get width in ns, 0 on timeout
+        void end(void);                                                           //abort a running measurement
+
+    private:
+        static void pulseDone(void *arg, uint32_t ticks);
+        uint32_t pin;
+        uint32_t tickHz;
+        timerPulse_t pulse;
+        pulseCaptureCallback_t callback;
+        void *arg;
+};
+
+/* pulseIn() on the timer input capture of the pin, returns the width in nanoseconds. Polls the
+   timer flags, so it also works with interrupts disabled. 0 on timeout or if the pin has no
+   timer channel pair */
+uint32_t pulseInCapture(uint32_t pin, uint32_t state, uint32_t timeout = 1000000UL);
+
+#endif /* PULSECAPTURE_H */
@@ -1,73 +1,190 @@
-
 #include "Arduino.h"
-#include "HardwareTimer.h"
 
 #define   MAX_FREQ  65535
 
+// pins playing at the same time
+#ifndef TONE_MAX_PINS
+#define TONE_MAX_PINS           4
+#endif
+// a duration is counted down in steps the soft timer can take
+#define TONE_DURATION_STEP_MS   1000000UL
+
+/*
+ * A tone on a pin in PinMap_PWM is generated by its timer channel in toggle
+ * mode, so it runs without interrupts; a duration costs one soft timer
+ * interrupt at the end. Only one tone plays per timer (the timer period sets
+ * the frequency), and any analogWrite() on other channels of that timer gets
+ * its period changed. Other pins, and pins whose timer is already playing a
+ * tone, are toggled from a soft timer every half period.
+ */
 typedef struct {
     PinName pin;
-    int32_t count;
+    bool hardware;
+    pwmDevice_t pwm;
+    uint32_t port;
+    uint32_t bit;
+    int32_t count;              // toggles left, -1 forever
+    uint32_t remaining;         // ms left of a hardware tone
+    soft_timer_t timer;         // toggles the pin, or ends a hardware tone
 } timerPinInfo_t;
 
-static void timerTonePinInit(PinName p, uint32_t frequency, uint32_t duration);
-static void tonePeriodElapsedCallback();
-static timerPinInfo_t TimerTone_pinInfo = {NC, 0};
-static HardwareTimer TimerTone(TIMER_TONE);
+static timerPinInfo_t TimerTone_pinInfo[TONE_MAX_PINS];
+static bool TimerTone_ready = false;
+
+static void toneStop(timerPinInfo_t *info)
+{
+    soft_timer_stop(&info->timer);
+    if (info->hardware) {
+        PWM_stop(&info->pwm);
+        info->hardware = false;
+        pin_function(info->pin, GD_PIN_FUNCTION3(PIN_MODE_OUT_PP, 0, 0));
+    }
+    gpio_bit_write(info->port, info->bit, (bit_status)0);
+    info->pin = NC;
+}
 
 // Tone Period elapsed callback in non-blocking mode
-static void tonePeriodElapsedCallback()
+static void tonePeriodElapsedCallback(void *arg)
 {
-    uint32_t port = gpio_port[GD_PORT_GET(TimerTone_pinInfo.pin)];
-    uint32_t pin =  gpio_pin[GD_PIN_GET(TimerTone_pinInfo.pin)];
-
-    if (port != (uint32_t)NC) {
-        if (TimerTone_pinInfo.count == -1) {
-            gpio_bit_write(port, pin, (bit_status)(1 - (int)gpio_input_bit_get(port, pin)));
-        } else if (TimerTone_pinInfo.count != 0) {
-            if (TimerTone_pinInfo.count > 0) {
-                TimerTone_pinInfo.count--;
-            }
-            gpio_bit_write(port, pin, (bit_status)(1 - (int)gpio_input_bit_get(port, pin)));
-        } else {
-            gpio_bit_write(port, pin, (bit_status)0);
+    timerPinInfo_t *info = (timerPinInfo_t *)arg;
+
+    if (info->count == -1) {
+        gpio_bit_write(info->port, info->bit, (bit_status)(1 - (int)gpio_input_bit_get(info->port, info->bit)));
+    } else if (info->count != 0) {
+        info->count--;
+        gpio_bit_write(info->port, info->bit, (bit_status)(1 - (int)gpio_input_bit_get(info->port, info->bit)));
+    } else {
+        toneStop(info);
+    }
+}
+
+// end of a hardware tone, or of one step of its duration
+static void toneDurationCallback(void *arg)
+{
+    timerPinInfo_t *info = (timerPinInfo_t *)arg;
+
+    if (info->remaining > TONE_DURATION_STEP_MS) {
+        info->remaining -= TONE_DURATION_STEP_MS;
+        soft_timer_start(&info->timer, TONE_DURATION_STEP_MS * 1000UL, 0, toneDurationCallback, info);
+    } else {
+        toneStop(info);
+    }
+}
+
+// a timer playing a tone on another pin keeps it
+static bool toneTimerBusy(const timerPinInfo_t *self, uint32_t timer)
+{
+    for (uint8_t i = 0; i < TONE_MAX_PINS; i++) {
+        const timerPinInfo_t *info = &TimerTone_pinInfo[i];
+        if ((info != self) && (info->pin != NC) && info->hardware && (info->pwm.timer == timer)) {
+            return true;
         }
     }
+    return false;
 }
 
-static void timerTonePinInit(PinName p, uint32_t frequency, uint32_t duration)
+static bool timerToneHardwareStart(timerPinInfo_t *info, uint32_t frequency, uint32_t duration)
+{
+    pwmDevice_t pwm;
+
+    if (pinmap_peripheral(info->pin, PinMap_PWM) == (uint32_t)NC) {
+        return false;
+    }
+    pwm = getTimerDeviceFromPinname(info->pin);
+    if (toneTimerBusy(info, pwm.timer)) {
+        return false;
+    }
+    if (!info->hardware) {
+        info->pwm = pwm;
+        pinmap_pinout(info->pin, PinMap_PWM);
+        PWM_init(&info->pwm, NULL);
+    }
+    // the output toggles at every compare match, once per counter period
+    if (PWM_setFrequency(&info->pwm, 2 * frequency) == 0) {
+        PWM_stop(&info->pwm);
+        info->hardware = false;
+        return false;
+    }
+    timer_channel_output_mode_config(info->pwm.timer, info->pwm.channel, TIMER_OC_MODE_TOGGLE);
+    timer_channel_output_pulse_value_config(info->pwm.timer, info->pwm.channel, 0);
+    PWM_start(&info->pwm);
+    info->hardware = true;
+
+    if (duration > 0) {
+        info->remaining = duration;
+        soft_timer_start(&info->timer, ((duration > TONE_DURATION_STEP_MS) ? TONE_DURATION_STEP_MS : duration) * 1000UL,
+                         0, toneDurationCallback, info);
+    }
+    return true;
+}
+
+static void timerTonePinInit(timerPinInfo_t *info, PinName p, uint32_t frequency, uint32_t duration)
 {
     uint32_t timFreq = 2 * frequency;
 
     if (frequency <= MAX_FREQ) {
         if (frequency == 0) {
-            TimerTone.stop();
+            if (info->pin != NC) {
+                toneStop(info);
+            }
         } else {
-            TimerTone_pinInfo.pin = p;
+            soft_timer_stop(&info->timer);
+            info->pin = p;
+            info->port = gpio_port[GD_PORT_GET(p)];
+            info->bit = gpio_pin[GD_PIN_GET(p)];
+
+            if (timerToneHardwareStart(info, frequency, duration)) {
+                return;
+            }
 
             //Calculate the toggle count
             if (duration > 0) {
-                TimerTone_pinInfo.count = ((timFreq * duration) / 1000);
+                info->count = ((timFreq * duration) / 1000);
             } else {
-                TimerTone_pinInfo.count = -1;
+                info->count = -1;
             }
 
-            pin_function(TimerTone_pinInfo.pin, GD_PIN_FUNCTION3(PIN_MODE_OUT_PP, 0, 0));
+            pin_function(info->pin, GD_PIN_FUNCTION3(PIN_MODE_OUT_PP, 0, 0));
 
-            TimerTone.setPeriodTime(timFreq, FORMAT_HZ);
-            TimerTone.attachInterrupt(tonePeriodElapsedCallback);
-            TimerTone.start();
+            // toggle every half period, on the shared soft timer
+            soft_timer_start(&info->timer, 1000000 / timFreq, 1000000 / timFreq,
+                             tonePeriodElapsedCallback, info);
         }
     }
 }
 
+// the slot playing on p, or a free one
+static timerPinInfo_t *toneSlot(PinName p, bool allocate)
+{
+    timerPinInfo_t *spare = NULL;
+
+    if (!TimerTone_ready) {
+        for (uint8_t i = 0; i < TONE_MAX_PINS; i++) {
+            TimerTone_pinInfo[i].pin = NC;
+        }
+        TimerTone_ready = true;
+    }
+    for (uint8_t i = 0; i < TONE_MAX_PINS; i++) {
+        if (TimerTone_pinInfo[i].pin == p) {
+            return &TimerTone_pinInfo[i];
+        }
+        if ((spare == NULL) && (TimerTone_pinInfo[i].pin == NC)) {
+            spare = &TimerTone_pinInfo[i];
+        }
+    }
+    return allocate ? spare : NULL;
+}
+
 // frequency (in hertz) and duration (in milliseconds).
 void tone(uint8_t _pin, unsigned int frequency, unsigned long duration)
 {
     PinName p = DIGITAL_TO_PINNAME(_pin);
+    timerPinInfo_t *info;
 
     if (p != NC) {
-        if ((TimerTone_pinInfo.pin == NC) || (TimerTone_pinInfo.pin == p)) {
-            timerTonePinInit(p, frequency, duration);
+        info = toneSlot(p, frequency != 0);
+        if (info != NULL) {
+            timerTonePinInit(info, p, frequency, duration);
         }
     }
 }
@@ -75,7 +192,12 @@ void tone(uint8_t _pin, unsigned int frequency, unsigned long duration)
 void noTone(uint8_t _pin)
 {
     PinName p = DIGITAL_TO_PINNAME(_pin);
-    if ((p != NC) && (TimerTone_pinInfo.pin == p)) {
-        TimerTone.stop();
+    timerPinInfo_t *info;
+
+    if (p != NC) {
+        info = toneSlot(p, false);
+        if (info != NULL) {
+            toneStop(info);
+        }
     }
 }
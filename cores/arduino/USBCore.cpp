@@ -4,7 +4,9 @@
 extern "C" {
 #include "gd32/usb.h"
 #include "usbd_enum.h"
+#if !USB_USBFS
 #include "usbd_lld_regs.h"
+#endif
 #include "usbd_transc.h"
 }
 
@@ -21,6 +23,19 @@ extern "C" {
 #define STR_IDX_PRODUCT 2
 #define STR_IDX_SERIAL 3
 
+/*
+ * The device state and endpoint transfers, which USBFS keeps one level
+ * down in ‘usbd.dev’ under the same names.
+ */
+static inline auto& perp(usb_dev& usbd)
+{
+#if USB_USBFS
+    return usbd.dev;
+#else
+    return usbd;
+#endif
+}
+
 // bMaxPower in Configuration Descriptor
 #define USB_CONFIG_POWER_MA(mA)                ((mA)/2)
 #ifndef USB_CONFIG_POWER
@@ -96,11 +111,23 @@ static uint8_t* stringDescs[] = {
     [STR_IDX_SERIAL]  = (uint8_t *)&serialDesc
 };
 
+#if !USB_USBFS
+/*
+ * Endpoint buffer descriptor table, at the same place
+ * ‘usbd_lld_core.c’ puts it.
+ */
+static usbd_ep_ram* const btable = (usbd_ep_ram*)(USBD_RAM + 2 * (BTABLE_OFFSET & 0xFFF8));
+#endif
+
 usb_desc desc = {
     .dev_desc    = (uint8_t *)&devDesc,
     .config_desc = (uint8_t *)&configDesc,
     .bos_desc    = nullptr,
+#if USB_USBFS
+    .strings     = (void* const*)stringDescs
+#else
     .strings     = stringDescs
+#endif
 };
 
 template<size_t L>
@@ -110,37 +137,50 @@ void EPBuffer<L>::init(uint8_t ep)
     this->reset();
     this->rxWaiting = false;
     this->txWaiting = false;
+    this->doubleBuffered = false;
+    this->txQueued = 0;
 }
 
 template<size_t L>
 size_t EPBuffer<L>::push(const void *d, size_t len)
 {
-    usb_disable_interrupts();
-    size_t w = min(this->sendSpace(), len);
-    const uint8_t* d8 = (const uint8_t*)d;
-    for (size_t i = 0; i < w; i++) {
-        *this->p++ = *d8++;
+#if USB_USBFS
+    // USBFS reads an IN transfer straight out of ‘buf’ until it's done.
+    if (this->txWaiting && !this->waitForWriteComplete()) {
+        return 0;
     }
+#endif
+    uint8_t* start = this->p;
+    size_t w = min(this->sendSpace(), len);
+    memcpy(start, d, w);
+
+    // Make the data visible before the pointer that covers it.
+    __DMB();
+    this->p = start + w;
     assert(this->p >= this->buf);
-    usb_enable_interrupts();
     return w;
 }
 
 template<size_t L>
 size_t EPBuffer<L>::pop(void* d, size_t len)
 {
-    usb_disable_interrupts();
+    uint8_t* start = this->p;
     size_t r = min(this->available(), len);
-    uint8_t* d8 = (uint8_t*)d;
-    for (size_t i = 0; i < r; i++) {
-        *d8++ = *this->p++;
-    }
+    memcpy(d, start, r);
+
+    __DMB();
+    this->p = start + r;
     assert(this->p <= this->tail);
 
+    /*
+     * Re-arming the endpoint races with ‘transcOut’, which is the
+     * only part that needs the interrupt held off.
+     */
     if (this->available() == 0) {
+        usb_disable_interrupts();
         this->enableOutEndpoint();
+        usb_enable_interrupts();
     }
-    usb_enable_interrupts();
     return r;
 }
 
@@ -174,6 +214,14 @@ size_t EPBuffer<L>::sendSpace()
 template<size_t L>
 void EPBuffer<L>::flush()
 {
+#if USB_USBFS
+    // Replies on endpoint 0 go out whole once the request has been
+    // handled, see ‘handleSetup’.
+    if (this->ep == 0) {
+        return;
+    }
+#endif
+
     /*
      * Bounce out if a flush is already occurring. This is only
      * possible when ‘flush’ is called from an interrupt, so the
@@ -190,15 +238,26 @@ void EPBuffer<L>::flush()
     // Only attempt to send if there's data and the device is
     // configured enough to send it.
     if (this->len() > 0
-        && (USBCore().usbDev().cur_status >= USBD_CONFIGURED
-            || (this->ep == 0 && USBCore().usbDev().cur_status >= USBD_ADDRESSED))) {
+        && (perp(USBCore().usbDev()).cur_status >= USBD_CONFIGURED
+            || (this->ep == 0 && perp(USBCore().usbDev()).cur_status >= USBD_ADDRESSED))) {
         auto canWrite = this->waitForWriteComplete();
+#if USB_USBFS
         if (canWrite) {
+            // The whole buffer is one transfer, the peripheral splits it
+            // into packets.
+            this->txWaiting = true;
+            usbd_ep_send(&USBCore().usbDev(), this->ep | USB_TRX_IN, this->buf, this->len());
+        }
+#else
+        if (canWrite && this->doubleBuffered) {
+            this->writeDoubleBuffer();
+        } else if (canWrite) {
             // Only start the next transmission if the device hasn't been
             // reset.
             this->txWaiting = true;
-            USBCore().usbDev().drv_handler->ep_write((uint8_t*)this->buf, this->ep, this->len());
+            USBCore().usbDev().drv_handler->ep_write(this->buf, this->ep, this->len());
         }
+#endif
         this->reset();
     }
     this->currentlyFlushing = false;
@@ -215,21 +274,84 @@ void EPBuffer<L>::enableOutEndpoint()
     this->rxWaiting = true;
 
     this->reset();
+#if USB_USBFS
+    /*
+     * One packet at a time all the same: a transfer only ends early on
+     * a short packet, and hosts don't follow a write that fills whole
+     * packets with a ZLP.
+     */
+    usbd_ep_recev(&USBCore().usbDev(), this->ep, this->buf,
+                  USBCore().usbDev().dev.transc_out[this->ep].max_len);
+#else
     usb_transc_config(&USBCore().usbDev().transc_out[this->ep],
-                      (uint8_t*)this->buf, sizeof(this->buf), 0);
+                      this->buf, sizeof(this->buf), 0);
     USBCore().usbDev().drv_handler->ep_rx_enable(&USBCore().usbDev(), this->ep);
+#endif
+}
+
+#if !USB_USBFS
+template<size_t L>
+void EPBuffer<L>::enableDoubleBuffer()
+{
+    this->doubleBuffered = true;
+    this->txQueued = 0;
+
+    /*
+     * Start with DTOG (the buffer the peripheral sends next) and
+     * SW_BUF (the buffer we fill next) both on buffer 0. While they
+     * are equal the peripheral NAKs, so nothing goes out until the
+     * first ‘flush’.
+     */
+    USBD_TX_DTG_CLEAR(this->ep);
+    USBD_RX_DTG_CLEAR(this->ep);
+    btable[this->ep].tx_count = 0;
+    btable[this->ep].rx_count = 0;
+}
+
+// Copy the buffer into the hardware buffer selected by SW_BUF and
+// hand it to the peripheral.
+template<size_t L>
+void EPBuffer<L>::writeDoubleBuffer()
+{
+    // SW_BUF of an IN endpoint is the RX data toggle bit.
+    auto second = (USBD_EPxCS(this->ep) & EPxCS_RX_DTG) != 0;
+    uint16_t len = this->len();
+    auto dst = (volatile uint32_t*)((second ? btable[this->ep].rx_addr : btable[this->ep].tx_addr) * 2U + USBD_RAM);
+
+    // The packet memory is 16 bits wide, with each half-word on a
+    // 32-bit boundary. ‘buf’ is aligned and even-sized, so reading a
+    // whole half-word past an odd length stays inside it.
+    const uint16_t* src = (const uint16_t*)this->buf;
+    for (uint16_t i = 0; i < len; i += 2) {
+        *dst++ = *src++;
+    }
+    if (second) {
+        btable[this->ep].rx_count = len;
+    } else {
+        btable[this->ep].tx_count = len;
+    }
+
+    usb_disable_interrupts();
+    user_buffer_free(this->ep, (uint8_t)DBUF_EP_IN);
+    this->txQueued++;
+    this->txWaiting = this->txQueued >= 2;
+    usb_enable_interrupts();
 }
+#endif
 
 template<size_t L>
 void EPBuffer<L>::transcOut()
 {
-    this->tail = this->buf + USBCore().usbDev().transc_out[this->ep].xfer_count;;
+    this->tail = this->buf + perp(USBCore().usbDev()).transc_out[this->ep].xfer_count;
     this->rxWaiting = false;
 }
 
 template<size_t L>
 void EPBuffer<L>::transcIn()
 {
+    if (this->doubleBuffered && this->txQueued > 0) {
+        this->txQueued--;
+    }
     this->txWaiting = false;
 }
 
@@ -239,36 +361,34 @@ uint8_t* EPBuffer<L>::ptr()
     return this->buf;
 }
 
-// Busy loop until an OUT packet has been received. Returns ‘false’ if
+// Wait until an OUT packet has been received. Returns ‘false’ if
 // the device has been reset.
 template<size_t L>
 bool EPBuffer<L>::waitForReadComplete()
 {
-    // auto start = getCurrentMillis();
     auto ok = true;
-    while (ok && this->rxWaiting) {
-        ok = EPBuffers().pollEPStatus();
-        // if (getCurrentMillis() - start > 5) {
-        //     EPBuffers().buf(ep).transcIn();
-        //     return false;
-        // }
+    while (ok) {
+        auto seen = EPBuffers().events();
+        if (!this->rxWaiting) {
+            break;
+        }
+        ok = EPBuffers().waitForEvent(seen);
     }
     return ok;
 }
 
-// Busy loop until the latest IN packet has been sent. Returns ‘true’
-// if a new packet can be queued when this call completes.
+// Wait until the latest IN packet has been sent. Returns ‘true’ if a
+// new packet can be queued when this call completes.
 template<size_t L>
 bool EPBuffer<L>::waitForWriteComplete()
 {
-    // auto start = getCurrentMillis();
     auto ok = true;
-    while (ok && this->txWaiting) {
-        ok = EPBuffers().pollEPStatus();
-        // if (getCurrentMillis() - start > 5) {
-        //     EPBuffers().buf(ep).transcIn();
-        //     ok = false;
-        // }
+    while (ok) {
+        auto seen = EPBuffers().events();
+        if (!this->txWaiting) {
+            break;
+        }
+        ok = EPBuffers().waitForEvent(seen);
     }
     return ok;
 }
@@ -308,6 +428,12 @@ EPDesc* EPBuffers_<L, C>::desc(uint8_t ep)
 template<size_t L, size_t C>
 bool EPBuffers_<L, C>::pollEPStatus()
 {
+#if USB_USBFS
+    // The interrupt handler itself does it all, resets included.
+    auto resets = this->resetCount;
+    usb_poll();
+    return this->resetCount == resets;
+#else
     /*
      * I’m not sure how much of this is necessary, but this is the
      * series of checks that’s used by ‘usbd_isr’ to verify the IN
@@ -355,11 +481,57 @@ bool EPBuffers_<L, C>::pollEPStatus()
         }
     }
     return ok;
+#endif
+}
+
+template<size_t L, size_t C>
+uint32_t EPBuffers_<L, C>::events()
+{
+    return this->eventCount;
+}
+
+template<size_t L, size_t C>
+bool EPBuffers_<L, C>::waitForEvent(uint32_t seen)
+{
+    /*
+     * The USB interrupt can’t get in if we’re in an interrupt handler
+     * ourselves or have it masked, so go and look at the peripheral
+     * directly.
+     */
+#if USB_USBFS
+    auto masked = (USBCore().usbDev().regs.gr->GAHBCS & GAHBCS_GINTEN) == 0;
+#else
+    auto masked = (USBD_CTL & CTL_STIE) == 0;
+#endif
+    if (__get_IPSR() != 0 || __get_PRIMASK() != 0 || masked) {
+        return this->pollEPStatus();
+    }
+
+    auto resets = this->resetCount;
+    while (this->eventCount == seen) {
+        usb_event_wait();
+    }
+    return this->resetCount == resets;
+}
+
+template<size_t L, size_t C>
+void EPBuffers_<L, C>::signalEvent()
+{
+    this->eventCount++;
+    usb_event_signal();
 }
 
-EPBuffers_<USB_EP_SIZE, EP_COUNT>& EPBuffers()
+template<size_t L, size_t C>
+void EPBuffers_<L, C>::busReset()
 {
-    static EPBuffers_<USB_EP_SIZE, EP_COUNT> obj;
+    this->init();
+    this->resetCount++;
+    this->signalEvent();
+}
+
+EPBuffers_<USB_XFER_SIZE, EP_COUNT>& EPBuffers()
+{
+    static EPBuffers_<USB_XFER_SIZE, EP_COUNT> obj;
     return obj;
 }
 
@@ -368,6 +540,26 @@ class ClassCore
     public:
         static usb_class *structPtr()
         {
+#if USB_USBFS
+            /*
+             * Transfers don't come through here, the driver calls
+             * ‘usbd_setup_transc’ and friends below for those.
+             */
+            static usb_class rc = {
+#if USB_USBHS
+                // The USBHS driver declares these two the other way round.
+                .alter_set = 0x0,
+                .command   = 0xff,
+#else
+                .command   = 0xff,
+                .alter_set = 0x0,
+#endif
+                .init      = ClassCore::init,
+                .deinit    = ClassCore::deinit,
+                .req_proc  = ClassCore::reqProcess,
+                .SOF       = ClassCore::sof
+            };
+#else
             static usb_class rc = {
                 .req_cmd     = 0xff,
                 .req_altset  = 0x0,
@@ -379,9 +571,61 @@ class ClassCore
                 .data_in     = ClassCore::dataIn,
                 .data_out    = ClassCore::dataOut
             };
+#endif
             return &rc;
         }
 
+        // The descriptor of ‘PluggableUSB’ endpoint ‘ep’.
+        static usb_desc_ep endpointDescriptor(uint8_t ep)
+        {
+            auto desc = *(EPDesc*)epBuffer(ep);
+            usb_desc_ep ep_desc = {
+                .header = {
+                    .bLength = sizeof(ep_desc),
+                    .bDescriptorType = USB_DESCTYPE_EP,
+                },
+                .bEndpointAddress = (uint8_t)(desc.dir() | ep),
+                .bmAttributes = desc.type(),
+                .wMaxPacketSize = desc.maxlen(),
+                .bInterval = 0
+            };
+            return ep_desc;
+        }
+
+#if USB_USBFS
+        // Called after device configuration is set.
+        static uint8_t init(usb_dev* usbd, uint8_t config_index)
+        {
+            (void)config_index;
+
+            /*
+             * Every endpoint has its own FIFO, sized in usb_conf.h, so
+             * there is nothing to hand out here.
+             */
+            for (uint8_t ep = 1; ep < PluggableUSB().epCount(); ep++) {
+                auto ep_desc = endpointDescriptor(ep);
+                usbd_ep_setup(usbd, &ep_desc);
+                if ((ep_desc.bEndpointAddress & USB_TRX_IN) == 0) {
+                    EPBuffers().buf(ep).enableOutEndpoint();
+                }
+            }
+            return USBD_OK;
+        }
+
+        // Called when SetConfiguration setup packet sets the
+        // configuration to 0.
+        static uint8_t deinit(usb_dev* usbd, uint8_t config_index)
+        {
+            (void)config_index;
+
+            for (uint8_t ep = 1; ep < PluggableUSB().epCount(); ep++) {
+                usbd_ep_clear(usbd, endpointDescriptor(ep).bEndpointAddress);
+            }
+            return USBD_OK;
+        }
+
+        static uint8_t sof(usb_dev* usbd);
+#else
         // Called after device configuration is set.
         static uint8_t init(usb_dev* usbd, uint8_t config_index)
         {
@@ -392,24 +636,45 @@ class ClassCore
              * handle what’s configured by ‘PluggableUSB’.
              */
             uint32_t buf_offset = EP0_RX_ADDR + USB_EP_SIZE;
+
+            /*
+             * Packet memory left once every endpoint has one buffer,
+             * handed out as second buffers in endpoint order.
+             */
+            int32_t spare = 512 - buf_offset;
+            for (uint8_t ep = 1; ep < PluggableUSB().epCount(); ep++) {
+                spare -= ((EPDesc*)epBuffer(ep))->maxlen();
+            }
+
             for (uint8_t ep = 1; ep < PluggableUSB().epCount(); ep++) {
                 auto desc = *(EPDesc*)epBuffer(ep);
-                usb_desc_ep ep_desc = {
-                    .header = {
-                        .bLength = sizeof(ep_desc),
-                        .bDescriptorType = USB_DESCTYPE_EP,
-                    },
-                    .bEndpointAddress = (uint8_t)(desc.dir() | ep),
-                    .bmAttributes = desc.type(),
-                    .wMaxPacketSize = desc.maxlen(),
-                    .bInterval = 0
-                };
+                auto ep_desc = endpointDescriptor(ep);
+                /*
+                 * Bulk IN endpoints get both hardware buffers while they
+                 * fit, so the next packet can be filled while one is on
+                 * the wire.
+                 */
+                auto dbl = desc.dir() != 0 && desc.type() == USB_EP_ATTR_BULK
+                           && spare >= ep_desc.wMaxPacketSize;
+                if (dbl) {
+                    spare -= ep_desc.wMaxPacketSize;
+                }
+                auto hwLen = dbl ? 2 * ep_desc.wMaxPacketSize : ep_desc.wMaxPacketSize;
+
                 // Don’t overflow the hardware buffer table.
-                assert((buf_offset + ep_desc.wMaxPacketSize) <= 512);
+                assert((buf_offset + hwLen) <= 512);
 
                 usbd->ep_transc[ep][TRANSC_IN] = USBCore_::transcInHelper;
                 usbd->ep_transc[ep][TRANSC_OUT] = USBCore_::transcOutHelper;
-                usbd->drv_handler->ep_setup(usbd, EP_BUF_SNG, buf_offset, &ep_desc);
+                if (dbl) {
+                    // Buffer 0 goes in the low half-word, buffer 1 in the high one.
+                    usbd->drv_handler->ep_setup(usbd, EP_BUF_DBL,
+                                                buf_offset | ((buf_offset + ep_desc.wMaxPacketSize) << 16),
+                                                &ep_desc);
+                    EPBuffers().buf(ep).enableDoubleBuffer();
+                } else {
+                    usbd->drv_handler->ep_setup(usbd, EP_BUF_SNG, buf_offset, &ep_desc);
+                }
 
                 /*
                  * Allow data to come in to OUT buffers immediately, as it
@@ -419,7 +684,7 @@ class ClassCore
                     EPBuffers().buf(ep).enableOutEndpoint();
                 }
 
-                buf_offset += ep_desc.wMaxPacketSize;
+                buf_offset += hwLen;
             }
             return USBD_OK;
         }
@@ -432,6 +697,7 @@ class ClassCore
             (void)config_index;
             return USBD_OK;
         }
+#endif
 
         // Called when ep0 gets a SETUP packet after configuration.
         static uint8_t reqProcess(usb_dev* usbd, usb_req* req)
@@ -494,10 +760,74 @@ class ClassCore
         }
 };
 
+// The start of frame callback, see ‘attachSOF’.
+static void (*volatile sofCallback)(void) = nullptr;
+
+static uint8_t handleSOF(usb_dev* usbd)
+{
+    (void)usbd;
+    auto callback = sofCallback;
+    if (callback != nullptr) {
+        callback();
+    }
+    return USBD_OK;
+}
+
+#if USB_USBFS
+uint8_t ClassCore::sof(usb_dev* usbd)
+{
+    return handleSOF(usbd);
+}
+
+void usb_bus_reset(void)
+{
+    EPBuffers().busReset();
+}
+
+/*
+ * The USBFS interrupt handler calls these three for every endpoint,
+ * where USBD goes through ‘ep_transc’. They replace the library’s
+ * usbd_transc.c, which answers requests from static tables.
+ */
+uint8_t usbd_setup_transc(usb_core_driver* udev)
+{
+    USBCore_::transcSetupHelper(udev, 0);
+    return USBD_OK;
+}
+
+uint8_t usbd_out_transc(usb_core_driver* udev, uint8_t ep_num)
+{
+    USBCore_::transcOutHelper(udev, ep_num);
+    return USBD_OK;
+}
+
+uint8_t usbd_in_transc(usb_core_driver* udev, uint8_t ep_num)
+{
+    USBCore_::transcInHelper(udev, ep_num);
+    return USBD_OK;
+}
+
+USBCore_::USBCore_()
+{
+    /*
+     * Use global ‘usbd’ here, instead of wrapped version, to avoid
+     * initialization loop.
+     */
+    usb_init(&desc, ClassCore::structPtr());
+    usbd.dev.user_data = this;
+
+    // Nobody wants start of frame until ‘attachSOF’.
+    usbd.regs.gr->GINTEN &= ~GINTEN_SOFIE;
+}
+#else
+static usbd_int_cb_struct sofHandler = {
+    .SOF = handleSOF
+};
+
 void (*oldResetHandler)(usb_dev *usbd);
 void handleReset(usb_dev *usbd)
 {
-    EPBuffers().init();
+    EPBuffers().busReset();
     oldResetHandler(usbd);
 }
 
@@ -522,15 +852,31 @@ USBCore_::USBCore_()
     this->oldTranscIn = usbd.ep_transc[0][TRANSC_IN];
     usbd.ep_transc[0][TRANSC_IN] = USBCore_::transcInHelper;
 }
+#endif
 
 void USBCore_::connect()
 {
+    if (this->isConnected) {
+        return;
+    }
+    this->isConnected = true;
     usb_connect();
 }
 
 void USBCore_::disconnect()
 {
     usb_disconnect();
+    this->isConnected = false;
+}
+
+bool USBCore_::connected()
+{
+    return this->isConnected;
+}
+
+bool USBCore_::configured()
+{
+    return perp(this->usbDev()).cur_status == USBD_CONFIGURED;
 }
 
 // Send ‘len’ octets of ‘d’ through the control pipe (endpoint 0).
@@ -555,6 +901,11 @@ int USBCore_::sendControl(uint8_t flags, const void* data, int len)
         if (this->sendSpace(0) == 0) {
             this->flush(0);
         }
+        // A USBFS reply is sent whole from the buffer, see ‘flush’, so
+        // whatever doesn't fit is dropped.
+        if (w == 0) {
+            break;
+        }
     }
 
     if (flags & TRANSFER_RELEASE) {
@@ -580,6 +931,15 @@ int USBCore_::sendControl(uint8_t flags, const void* data, int len)
 // but ‘EPBuffer’ only allows for one direction at a time.
 int USBCore_::recvControl(void* data, int len)
 {
+#if USB_USBFS
+    // The data stage is in the buffer already, see ‘transcSetup’.
+    if (len > this->ctlLen - this->ctlRead) {
+        return -1;
+    }
+    memcpy(data, EPBuffers().buf(0).ptr() + this->ctlRead, len);
+    this->ctlRead += len;
+    return len;
+#else
     uint8_t* d = (uint8_t*)data;
     auto read = 0;
     while (read < len) {
@@ -594,6 +954,7 @@ int USBCore_::recvControl(void* data, int len)
     }
     assert(read == len);
     return len;
+#endif
 }
 
 // TODO: no idea? this isn’t in the avr 1.8.2 library, although it has
@@ -627,10 +988,12 @@ int USBCore_::send(uint8_t ep, const void* data, int len)
     ep &= 0x7;
     auto wrote = 0;
 
+#if !USB_USBFS
     // Make sure any transactions made outside of PluggableUSB are
     // cleaned up.
     auto transc = &USBCore().usbDev().transc_in[ep];
     usb_transc_config(transc, nullptr, 0, 0);
+#endif
 
     // TODO: query the endpoint for its max packet length.
     while (wrote < len) {
@@ -686,21 +1049,60 @@ int USBCore_::flush(uint8_t ep)
     return 0;
 }
 
+void USBCore_::attachTranscIn(uint8_t ep, void (*callback)(void* arg, uint8_t ep), void* arg)
+{
+    assert(ep < EP_COUNT);
+    usb_disable_interrupts();
+    this->transcInHandlers[ep].callback = callback;
+    this->transcInHandlers[ep].arg = arg;
+    usb_enable_interrupts();
+}
+
+void USBCore_::attachTranscOut(uint8_t ep, void (*callback)(void* arg, uint8_t ep), void* arg)
+{
+    assert(ep < EP_COUNT);
+    usb_disable_interrupts();
+    this->transcOutHandlers[ep].callback = callback;
+    this->transcOutHandlers[ep].arg = arg;
+    usb_enable_interrupts();
+}
+
+void USBCore_::attachSOF(void (*callback)(void))
+{
+    sofCallback = callback;
+#if USB_USBFS
+    if (callback != nullptr) {
+        usbd.regs.gr->GINTEN |= GINTEN_SOFIE;
+    } else {
+        usbd.regs.gr->GINTEN &= ~GINTEN_SOFIE;
+    }
+#else
+    // The library only takes SOF interrupts with a handler set.
+    usbd_int_fops = callback != nullptr ? &sofHandler : nullptr;
+#endif
+}
+
+void USBCore_::setBOSDescriptor(const uint8_t* bos)
+{
+    devDesc.bcdUSB = bos != nullptr ? 0x0201 : 0x0200;
+    desc.bos_desc = (uint8_t*)bos;
+}
+
 void USBCore_::transcSetupHelper(usb_dev* usbd, uint8_t ep)
 {
-    USBCore_* core = (USBCore_*)usbd->user_data;
+    USBCore_* core = (USBCore_*)perp(*usbd).user_data;
     core->transcSetup(usbd, ep);
 }
 
 void USBCore_::transcOutHelper(usb_dev* usbd, uint8_t ep)
 {
-    USBCore_* core = (USBCore_*)usbd->user_data;
+    USBCore_* core = (USBCore_*)perp(*usbd).user_data;
     core->transcOut(usbd, ep);
 }
 
 void USBCore_::transcInHelper(usb_dev* usbd, uint8_t ep)
 {
-    USBCore_* core = (USBCore_*)usbd->user_data;
+    USBCore_* core = (USBCore_*)perp(*usbd).user_data;
     core->transcIn(usbd, ep);
 }
 
@@ -709,6 +1111,173 @@ usb_dev& USBCore_::usbDev()
     return usbd;
 }
 
+#if USB_USBFS
+/*
+ * The driver has read the SETUP packet into ‘control.req’ already. A
+ * data stage from the host is gathered in endpoint 0’s buffer before
+ * the request is handled, so handlers find it with ‘recvControl’ the
+ * way they do on USBD.
+ */
+void USBCore_::transcSetup(usb_dev* usbd, uint8_t ep)
+{
+    (void)ep;
+    auto& req = usbd->dev.control.req;
+
+    EPBuffers().buf(0).reset();
+    this->ctlLen = 0;
+    this->ctlRead = 0;
+    if ((req.bmRequestType & USB_TRX_IN) != USB_TRX_IN && req.wLength > 0) {
+        if (req.wLength > USB_XFER_SIZE) {
+            this->stallControl(usbd);
+        } else {
+            usbd->dev.control.ctl_state = USB_CTL_DATA_OUT;
+            usbd_ep_recev(usbd, 0, EPBuffers().buf(0).ptr(), req.wLength);
+        }
+        return;
+    }
+    this->handleSetup(usbd);
+}
+
+void USBCore_::handleSetup(usb_dev* usbd)
+{
+    auto& req = usbd->dev.control.req;
+    usb_reqsta reqstat = REQ_NOTSUPP;
+    // Whether the library answered, from ‘transc_in[0]’ rather than our buffer.
+    auto library = false;
+
+    this->maxWrite = req.wLength;
+    switch (req.bmRequestType & USB_REQTYPE_MASK) {
+        /* standard device request */
+        case USB_REQTYPE_STRD:
+            if (req.bRequest == USB_GET_DESCRIPTOR
+                && (req.bmRequestType & USB_RECPTYPE_MASK) == USB_RECPTYPE_DEV
+                && (req.wValue >> 8) == USB_DESCTYPE_CONFIG) {
+                this->sendDeviceConfigDescriptor();
+                reqstat = REQ_SUPP;
+            } else if (req.bRequest == USB_GET_DESCRIPTOR
+                       && (req.bmRequestType & USB_RECPTYPE_MASK) == USB_RECPTYPE_DEV
+                       && (req.wValue >> 8) == USB_DESCTYPE_STR) {
+                reqstat = this->sendDeviceStringDescriptor() ? REQ_SUPP : REQ_NOTSUPP;
+            } else if ((req.bmRequestType & USB_RECPTYPE_MASK) == USB_RECPTYPE_ITF) {
+                reqstat = (usb_reqsta)ClassCore::reqProcess(usbd, &req);
+            } else {
+                usbd->dev.transc_in[0].remain_len = 0;
+                reqstat = usbd_standard_request(usbd, &req);
+                library = true;
+            }
+            break;
+
+        /* device class request */
+        case USB_REQTYPE_CLASS:
+            // Calls into class_core->req_proc once configured.
+            reqstat = usbd_class_request(usbd, &req);
+            break;
+
+        /* vendor defined request */
+        case USB_REQTYPE_VENDOR:
+            {
+                arduino::USBSetup setup;
+                memcpy(&setup, &req, sizeof(setup));
+                reqstat = PluggableUSB().setup(setup) ? REQ_SUPP : REQ_NOTSUPP;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    if (reqstat != REQ_SUPP) {
+        this->stallControl(usbd);
+    } else if ((req.bmRequestType & USB_TRX_IN) == USB_TRX_IN && req.wLength > 0) {
+        if (library) {
+            this->sendControlReply(usbd, usbd->dev.transc_in[0].xfer_buf, usbd->dev.transc_in[0].remain_len);
+        } else {
+            this->sendControlReply(usbd, EPBuffers().buf(0).ptr(), EPBuffers().buf(0).len());
+        }
+    } else {
+        this->sendControlStatus(usbd);
+    }
+}
+
+// Start the data stage of an IN request, ‘controlIn’ sends the rest
+// of it one packet at a time.
+void USBCore_::sendControlReply(usb_dev* usbd, uint8_t* data, uint32_t len)
+{
+    auto& req = usbd->dev.control.req;
+    auto transc = &usbd->dev.transc_in[0];
+
+    len = min(len, (uint32_t)req.wLength);
+    // Ending short of ‘wLength’ on a full packet takes a ZLP.
+    usbd->dev.control.ctl_zlp = len > 0 && len < req.wLength && len % transc->max_len == 0;
+    usbd->dev.control.ctl_state = len > transc->max_len ? USB_CTL_DATA_IN : USB_CTL_LAST_DATA_IN;
+    transc->remain_len = len;
+    usbd_ep_send(usbd, 0, data, len);
+}
+
+// Acknowledge a request without an IN data stage.
+void USBCore_::sendControlStatus(usb_dev* usbd)
+{
+    usbd->dev.control.ctl_state = USB_CTL_STATUS_IN;
+    usbd_ep_send(usbd, 0, nullptr, 0);
+    usb_ctlep_startout(usbd);
+}
+
+void USBCore_::stallControl(usb_dev* usbd)
+{
+    usbd->dev.control.ctl_state = USB_CTL_IDLE;
+    usbd_ep_stall(usbd, 0x80);
+    usbd_ep_stall(usbd, 0x00);
+    usb_ctlep_startout(usbd);
+}
+
+// A packet of an OUT data stage came in. Endpoint 0 takes one at a
+// time, the request is handled once all of them are.
+void USBCore_::controlOut(usb_dev* usbd)
+{
+    if (usbd->dev.control.ctl_state != USB_CTL_DATA_OUT) {
+        return;
+    }
+
+    auto& req = usbd->dev.control.req;
+    auto transc = &usbd->dev.transc_out[0];
+    this->ctlLen += transc->xfer_count;
+    if (this->ctlLen < req.wLength && transc->xfer_count == transc->max_len) {
+        usbd_ep_recev(usbd, 0, EPBuffers().buf(0).ptr() + this->ctlLen, req.wLength - this->ctlLen);
+    } else {
+        usbd->dev.control.ctl_state = USB_CTL_LAST_DATA_OUT;
+        this->handleSetup(usbd);
+    }
+}
+
+// A packet of an IN data stage went out, send the next one or finish
+// with the status stage.
+void USBCore_::controlIn(usb_dev* usbd)
+{
+    auto transc = &usbd->dev.transc_in[0];
+    switch (usbd->dev.control.ctl_state) {
+        case USB_CTL_DATA_IN:
+            // The driver has moved ‘xfer_buf’ past what it sent.
+            transc->remain_len -= transc->max_len;
+            usbd->dev.control.ctl_state = transc->remain_len > transc->max_len ? USB_CTL_DATA_IN : USB_CTL_LAST_DATA_IN;
+            usbd_ep_send(usbd, 0, transc->xfer_buf, transc->remain_len);
+            break;
+
+        case USB_CTL_LAST_DATA_IN:
+            if (usbd->dev.control.ctl_zlp) {
+                usbd->dev.control.ctl_zlp = 0;
+                usbd_ep_send(usbd, 0, nullptr, 0);
+            } else {
+                usbd->dev.control.ctl_state = USB_CTL_STATUS_OUT;
+                usbd_ep_recev(usbd, 0, nullptr, 0);
+                usb_ctlep_startout(usbd);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+#else
 /*
  * TODO: This is a heck of a monkey patch that just seems to get more
  * fragile every time functionality is needed in the rest of the
@@ -745,7 +1314,9 @@ void USBCore_::transcSetup(usb_dev* usbd, uint8_t ep)
             } else if (usbd->control.req.bRequest == USB_GET_DESCRIPTOR
                        && (usbd->control.req.bmRequestType & USB_RECPTYPE_MASK) == USB_RECPTYPE_DEV
                        && (usbd->control.req.wValue >> 8) == USB_DESCTYPE_STR) {
-                this->sendDeviceStringDescriptor();
+                if (!this->sendDeviceStringDescriptor()) {
+                    usbd_ep_stall(usbd, 0);
+                }
                 return;
             } else if ((usbd->control.req.bmRequestType & USB_RECPTYPE_MASK) == USB_RECPTYPE_ITF) {
                 reqstat = (usb_reqsta)ClassCore::reqProcess(usbd, &usbd->control.req);
@@ -774,9 +1345,19 @@ void USBCore_::transcSetup(usb_dev* usbd, uint8_t ep)
 
         /* vendor defined request */
         case USB_REQTYPE_VENDOR:
-            // Does nothing.
-            reqstat = usbd_vendor_request(usbd, &usbd->control.req);
-            break;
+            // Offered to the PluggableUSB modules, which answer any
+            // data stage themselves, like class requests. Nobody
+            // taking it stalls the request.
+            {
+                arduino::USBSetup setup;
+                memcpy(&setup, &usbd->control.req, sizeof(setup));
+                if (!PluggableUSB().setup(setup)) {
+                    usbd_ep_stall(usbd, 0);
+                } else if ((usbd->control.req.bmRequestType & USB_TRX_IN) != USB_TRX_IN) {
+                    this->sendZLP(usbd, 0);
+                }
+            }
+            return;
 
         default:
             break;
@@ -806,14 +1387,28 @@ void USBCore_::transcSetup(usb_dev* usbd, uint8_t ep)
         usbd_ep_stall(usbd, 0);
     }
 }
+#endif /* USB_USBFS */
 
 // Called in interrupt context.
 void USBCore_::transcOut(usb_dev* usbd, uint8_t ep)
 {
-    EPBuffers().buf(ep).transcOut();
     if (ep == 0) {
+#if USB_USBFS
+        this->controlOut(usbd);
+#else
+        EPBuffers().buf(ep).transcOut();
         this->oldTranscOut(usbd, ep);
+#endif
+    } else {
+        EPBuffers().buf(ep).transcOut();
+#ifdef USBD_USE_CDC
+        CDCACM().transcOut(ep);
+#endif
     }
+    if (this->transcOutHandlers[ep].callback != nullptr) {
+        this->transcOutHandlers[ep].callback(this->transcOutHandlers[ep].arg, ep);
+    }
+    EPBuffers().signalEvent();
 }
 
 // Called in interrupt context.
@@ -821,8 +1416,21 @@ void USBCore_::transcIn(usb_dev* usbd, uint8_t ep)
 {
     EPBuffers().buf(ep).transcIn();
     if (ep == 0) {
+#if USB_USBFS
+        this->controlIn(usbd);
+#else
         this->oldTranscIn(usbd, ep);
+#endif
+    }
+#ifdef USBD_USE_CDC
+    else {
+        CDCACM().transcIn(ep);
+    }
+#endif
+    if (this->transcInHandlers[ep].callback != nullptr) {
+        this->transcInHandlers[ep].callback(this->transcInHandlers[ep].arg, ep);
     }
+    EPBuffers().signalEvent();
 }
 
 void USBCore_::sendDeviceConfigDescriptor()
@@ -852,9 +1460,10 @@ void USBCore_::sendDeviceConfigDescriptor()
     this->flush(0);
 }
 
-void USBCore_::sendDeviceStringDescriptor()
+// Returns ‘false’ for an index we have no string for.
+bool USBCore_::sendDeviceStringDescriptor()
 {
-    switch (lowByte(USBCore().usbDev().control.req.wValue)) {
+    switch (lowByte(perp(USBCore().usbDev()).control.req.wValue)) {
         case STR_IDX_LANGID: {
             const usb_desc_LANGID desc = {
                 .header = {
@@ -864,7 +1473,7 @@ void USBCore_::sendDeviceStringDescriptor()
                 .wLANGID = ENG_LANGID
             };
             USBCore().sendControl(0 | TRANSFER_RELEASE, &desc, desc.header.bLength);
-            return;
+            break;
         }
         case STR_IDX_MFC:
             this->sendStringDesc(USB_MANUFACTURER);
@@ -876,9 +1485,9 @@ void USBCore_::sendDeviceStringDescriptor()
             USBCore().sendControl(0 | TRANSFER_RELEASE, &serialDesc, serialDesc.header.bLength);
             break;
         default:
-            USBCore().usbDev().drv_handler->ep_stall_set(&USBCore().usbDev(), 0);
-            return;
+            return false;
     }
+    return true;
 }
 
 void USBCore_::sendStringDesc(const char *str)
@@ -899,10 +1508,12 @@ void USBCore_::sendStringDesc(const char *str)
     USBCore().flush(0);
 }
 
+#if !USB_USBFS
 void USBCore_::sendZLP(usb_dev* usbd, uint8_t ep)
 {
     usbd->drv_handler->ep_write(nullptr, ep, 0);
 }
+#endif
 
 USBCore_& USBCore()
 {
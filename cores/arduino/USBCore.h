@@ -47,6 +47,18 @@ union EPDesc {
     }
 };
 
+/*
+ * Where ‘PluggableUSB’ starts handing out interfaces and endpoints,
+ * after the ones CDC-ACM has taken.
+ */
+#ifdef USBD_USE_CDC
+#define PLUGGABLE_USB_FIRST_INTERFACE 2
+#define PLUGGABLE_USB_FIRST_ENDPOINT  4
+#else
+#define PLUGGABLE_USB_FIRST_INTERFACE 0
+#define PLUGGABLE_USB_FIRST_ENDPOINT  1
+#endif
+
 /*
  * Mappings from Arduino USB API to USBCore singleton functions.
  */
@@ -79,15 +91,22 @@ class EPBuffer
         uint8_t* ptr();
         void enableOutEndpoint();
 
+        /*
+         * Switch an IN endpoint set up with ‘EP_BUF_DBL’ to ping-pong
+         * operation, where ‘flush’ fills one hardware buffer while the
+         * other one is being sent.
+         */
+        void enableDoubleBuffer();
+
         void transcIn();
         void transcOut();
 
         /*
-         * Busy loop until the endpoint has a packet available.
+         * Wait until the endpoint has a packet available.
          */
         bool waitForReadComplete();
         /*
-         * Busy loop until the endpoint has finished its current
+         * Wait until the endpoint has finished its current
          * transmission.
          */
         bool waitForWriteComplete();
@@ -109,15 +128,31 @@ class EPBuffer
          */
         volatile bool txWaiting = false;
     private:
-        volatile uint8_t buf[L];
-        volatile uint8_t* tail = buf;
-        volatile uint8_t* p = buf;
+        /*
+         * The data itself is only touched by one side at a time: the
+         * application while filling an IN buffer or draining an OUT
+         * one, the interrupt while the OUT endpoint is armed. Only the
+         * pointers are shared, and those are published after the data
+         * with a barrier, so the copies can run at full speed.
+         */
+        uint8_t buf[L] __attribute__((aligned(4)));
+        uint8_t* volatile tail = buf;
+        uint8_t* volatile p = buf;
 
         /*
          * Prevent more than one simultaneous call to ‘flush’.
          */
         volatile bool currentlyFlushing = false;
 
+        /*
+         * Whether the endpoint runs with both hardware buffers, and how
+         * many of them hold a packet the host hasn’t taken yet.
+         */
+        bool doubleBuffered = false;
+        volatile uint8_t txQueued = 0;
+
+        void writeDoubleBuffer();
+
         uint8_t ep;
 };
 
@@ -134,19 +169,55 @@ class EPBuffers_
 
         bool pollEPStatus();
 
+        /*
+         * Endpoint completions and bus resets, counted by the
+         * interrupt handler.
+         *
+         * To wait for an endpoint flag to change, take ‘events’ before
+         * checking the flag and hand it to ‘waitForEvent’, which
+         * returns as soon as the count moves on, so an event landing in
+         * between isn’t lost. Thread context sleeps in
+         * ‘usb_event_wait’ meanwhile, interrupt context (where the
+         * handler can’t run) falls back to ‘pollEPStatus’. Returns
+         * ‘false’ if the host reset the device.
+         */
+        uint32_t events();
+        bool waitForEvent(uint32_t seen);
+        /*
+         * Called in interrupt context.
+         */
+        void signalEvent();
+        void busReset();
+
     private:
         EPBuffer<L> epBufs[C];
+
+        volatile uint32_t eventCount = 0;
+        volatile uint32_t resetCount = 0;
 };
 
-EPBuffers_<USBD_EP0_MAX_SIZE, EP_COUNT>& EPBuffers();
+EPBuffers_<USB_XFER_SIZE, EP_COUNT>& EPBuffers();
 
 class USBCore_
 {
     public:
         USBCore_();
 
+        /*
+         * Attach to the bus and let the host enumerate the device,
+         * without waiting for it to finish. Safe to call again, only
+         * the first call does anything, so classes call it whenever
+         * they are used.
+         */
         void connect();
         void disconnect();
+        bool connected();
+
+        /*
+         * Whether the host has configured the device, so the class
+         * endpoints are up.
+         */
+        bool configured();
 
         /*
          * PluggableUSB interface.
@@ -161,6 +232,34 @@ class USBCore_
         int recv(uint8_t ep);
         int flush(uint8_t ep);
 
+        /*
+         * Run ‘callback’ from the USB interrupt every time an IN
+         * transfer on ‘ep’ completes, so a class can queue its next
+         * packet without a thread waiting on the endpoint.
+         */
+        void attachTranscIn(uint8_t ep, void (*callback)(void* arg, uint8_t ep), void* arg);
+
+        /*
+         * The same for OUT transfers, so a class can copy a packet out
+         * and re-arm the endpoint before the host retries it.
+         */
+        void attachTranscOut(uint8_t ep, void (*callback)(void* arg, uint8_t ep), void* arg);
+
+        /*
+         * Run ‘callback’ from the USB interrupt on every start of
+         * frame, once a millisecond, or stop with ‘nullptr’. The
+         * interrupt is left off while nobody needs it.
+         */
+        void attachSOF(void (*callback)(void));
+
+        /*
+         * Serve ‘bos’ for GET_DESCRIPTOR(BOS), e.g. to point Windows at
+         * an MS OS 2.0 descriptor set. The device descriptor then
+         * announces USB 2.01, which is what makes the host ask for it.
+         * Must be set before the device is enumerated.
+         */
+        void setBOSDescriptor(const uint8_t* bos);
+
         /*
          * Static member function helpers called from ISR.
          *
@@ -183,6 +282,8 @@ class USBCore_
         // I think this is only on the setup packet, so it should be fine.
         uint16_t maxWrite = 0;
 
+        bool isConnected = false;
+
         /*
          * Pointers to the transaction routines specified by ‘usbd_init’.
          */
@@ -190,12 +291,34 @@ class USBCore_
         void (*oldTranscOut)(usb_dev* usbd, uint8_t ep);
         void (*oldTranscIn)(usb_dev* usbd, uint8_t ep);
 
+        struct {
+            void (*callback)(void* arg, uint8_t ep);
+            void* arg;
+        } transcInHandlers[EP_COUNT] = {}, transcOutHandlers[EP_COUNT] = {};
+
         void transcSetup(usb_dev* usbd, uint8_t ep);
         void transcOut(usb_dev* usbd, uint8_t ep);
         void transcIn(usb_dev* usbd, uint8_t ep);
 
+#if USB_USBFS
+        /*
+         * Octets of the data stage of the current control request
+         * received from the host, and how far ‘recvControl’ has read
+         * them.
+         */
+        uint16_t ctlLen = 0;
+        uint16_t ctlRead = 0;
+
+        void handleSetup(usb_dev* usbd);
+        void sendControlReply(usb_dev* usbd, uint8_t* data, uint32_t len);
+        void sendControlStatus(usb_dev* usbd);
+        void stallControl(usb_dev* usbd);
+        void controlOut(usb_dev* usbd);
+        void controlIn(usb_dev* usbd);
+#endif
+
         void sendDeviceConfigDescriptor();
-        void sendDeviceStringDescriptor();
+        bool sendDeviceStringDescriptor();
 
         void sendStringDesc(const char *str);
 
@@ -0,0 +1,149 @@
+#ifdef USBCON
+#include "USBHID.h"
+
+extern "C" {
+#include "gd32/usb.h"
+}
+
+USBHID::USBHID(const uint8_t* reportDescriptor, uint16_t descriptorLength,
+               uint8_t protocol, uint8_t interval)
+    : PluggableUSBModule(1, 1, epType),
+      reportDescriptor(reportDescriptor),
+      descriptorLength(descriptorLength),
+      bootProtocol(protocol),
+      interval(interval)
+{
+    this->epType[0] = EPDesc(USB_TRX_IN, USB_ENDPOINT_TYPE_INTERRUPT).val;
+    if (PluggableUSB().plug(this)) {
+        USBCore().attachTranscIn(this->pluggedEndpoint, USBHID::transcIn, this);
+    }
+}
+
+int USBHID::getInterface(uint8_t* interfaceCount)
+{
+    *interfaceCount += 1;
+
+    uint8_t subClass = this->bootProtocol != HID_PROTOCOL_NONE ? HID_SUBCLASS_BOOT : HID_SUBCLASS_NONE;
+    HIDDescriptor desc = {
+        D_INTERFACE(this->pluggedInterface, 1, HID_INTERFACE_CLASS, subClass, this->bootProtocol),
+        D_HIDREPORT(this->descriptorLength),
+        D_ENDPOINT(USB_ENDPOINT_IN(this->pluggedEndpoint), USB_ENDPOINT_TYPE_INTERRUPT, USB_EP_SIZE, this->interval)
+    };
+    return USB_SendControl(0, &desc, sizeof(desc));
+}
+
+int USBHID::getDescriptor(arduino::USBSetup& setup)
+{
+    if (setup.bmRequestType != REQUEST_DEVICETOHOST_STANDARD_INTERFACE
+        || setup.wIndex != this->pluggedInterface) {
+        return 0;
+    }
+
+    if (setup.wValueH == HID_REPORT_DESCRIPTOR_TYPE) {
+        return USB_SendControl(0, this->reportDescriptor, this->descriptorLength);
+    } else if (setup.wValueH == HID_HID_DESCRIPTOR_TYPE) {
+        const HIDDescDescriptor desc = D_HIDREPORT(this->descriptorLength);
+        return USB_SendControl(0, &desc, sizeof(desc));
+    }
+    return 0;
+}
+
+bool USBHID::setup(arduino::USBSetup& setup)
+{
+    if (setup.wIndex != this->pluggedInterface) {
+        return false;
+    }
+
+    if (setup.bmRequestType == REQUEST_DEVICETOHOST_CLASS_INTERFACE) {
+        if (setup.bRequest == HID_GET_REPORT) {
+            if (this->reportLen == 0) {
+                return false;
+            }
+            USB_SendControl(TRANSFER_RELEASE, this->report, this->reportLen);
+            return true;
+        } else if (setup.bRequest == HID_GET_IDLE) {
+            USB_SendControl(TRANSFER_RELEASE, &this->idle, sizeof(this->idle));
+            return true;
+        } else if (setup.bRequest == HID_GET_PROTOCOL) {
+            USB_SendControl(TRANSFER_RELEASE, &this->protocol, sizeof(this->protocol));
+            return true;
+        }
+    } else if (setup.bmRequestType == REQUEST_HOSTTODEVICE_CLASS_INTERFACE) {
+        if (setup.bRequest == HID_SET_IDLE) {
+            // Reports are only sent on change, whatever the host asks
+            // for.
+            this->idle = setup.wValueH;
+            return true;
+        } else if (setup.bRequest == HID_SET_PROTOCOL) {
+            this->protocol = setup.wValueL;
+            return true;
+        } else if (setup.bRequest == HID_SET_REPORT) {
+            uint8_t data[USB_EP_SIZE];
+            if (setup.wLength > sizeof(data)) {
+                return false;
+            }
+            if (USB_RecvControl(data, setup.wLength) < 0) {
+                return false;
+            }
+            if (this->outputCallback != nullptr) {
+                this->outputCallback(data, setup.wLength);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+int USBHID::sendReport(const void* data, uint8_t len)
+{
+    if (len > sizeof(this->report)
+        || !USBCore().configured()) {
+        return -1;
+    }
+
+    // Keep the interrupt from sending the parked report while it is
+    // being replaced.
+    usb_disable_interrupts();
+    memcpy(this->report, data, len);
+    this->reportLen = len;
+    this->pending = true;
+    if (!EPBuffers().buf(this->pluggedEndpoint).txWaiting) {
+        this->sendPending();
+    }
+    usb_enable_interrupts();
+    return len;
+}
+
+bool USBHID::reportPending()
+{
+    return this->pending;
+}
+
+void USBHID::onOutputReport(void (*callback)(const uint8_t* data, uint8_t len))
+{
+    this->outputCallback = callback;
+}
+
+uint8_t USBHID::getProtocol()
+{
+    return this->protocol;
+}
+
+// Write the parked report into the idle endpoint. Runs with USB
+// interrupts masked or from the interrupt itself.
+void USBHID::sendPending()
+{
+    if (!this->pending) {
+        return;
+    }
+    this->pending = false;
+    USB_Send(this->pluggedEndpoint | TRANSFER_RELEASE, this->report, this->reportLen);
+}
+
+// Called in interrupt context once the host has taken a report.
+void USBHID::transcIn(void* arg, uint8_t ep)
+{
+    (void)ep;
+    ((USBHID*)arg)->sendPending();
+}
+#endif
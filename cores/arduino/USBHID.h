@@ -0,0 +1,124 @@
+#pragma once
+#ifdef USBCON
+#include "api/ArduinoAPI.h"
+#include "api/PluggableUSB.h"
+#include "USBCore.h"
+
+#define HID_INTERFACE_CLASS      0x03
+#define HID_SUBCLASS_NONE        0x00
+#define HID_SUBCLASS_BOOT        0x01
+#define HID_PROTOCOL_NONE        0x00
+#define HID_PROTOCOL_KEYBOARD    0x01
+#define HID_PROTOCOL_MOUSE       0x02
+
+#define HID_HID_DESCRIPTOR_TYPE    0x21
+#define HID_REPORT_DESCRIPTOR_TYPE 0x22
+
+#define HID_GET_REPORT   0x01
+#define HID_GET_IDLE     0x02
+#define HID_GET_PROTOCOL 0x03
+#define HID_SET_REPORT   0x09
+#define HID_SET_IDLE     0x0a
+#define HID_SET_PROTOCOL 0x0b
+
+/*
+ * Frames (1 ms each) between polls of the report endpoint.
+ */
+#ifndef USBHID_INTERVAL
+#define USBHID_INTERVAL 1
+#endif
+
+#define D_HIDREPORT(_descriptorLength) \
+	{ 9, HID_HID_DESCRIPTOR_TYPE, 0x11, 0x01, 0, 1, HID_REPORT_DESCRIPTOR_TYPE, lowByte(_descriptorLength), highByte(_descriptorLength) }
+
+#pragma pack(push, 1)
+typedef struct {
+    uint8_t len;
+    uint8_t dtype;
+    uint8_t versionL;
+    uint8_t versionH;
+    uint8_t country;
+    uint8_t numDescs;
+    uint8_t descType;
+    uint8_t descLenL;
+    uint8_t descLenH;
+} HIDDescDescriptor;
+
+typedef struct {
+    InterfaceDescriptor hid;
+    HIDDescDescriptor desc;
+    EndpointDescriptor in;
+} HIDDescriptor;
+#pragma pack(pop)
+
+/*
+ * HID interface with a single interrupt IN endpoint, for devices that
+ * want every report on the wire at the next poll.
+ *
+ * ‘sendReport’ never waits. While the endpoint is idle the report goes
+ * straight into packet memory, ready for the next IN token. While it
+ * is busy the report is parked and written from the USB interrupt as
+ * soon as the previous one is taken, and a newer report replaces one
+ * still parked, so the host always gets the latest state.
+ *
+ * Declare at global scope, so it is plugged in before USB enumerates.
+ */
+class USBHID : public arduino::PluggableUSBModule
+{
+    public:
+        USBHID(const uint8_t* reportDescriptor, uint16_t descriptorLength,
+               uint8_t protocol = HID_PROTOCOL_NONE, uint8_t interval = USBHID_INTERVAL);
+
+        /*
+         * Queue a report, including its report ID if the descriptor
+         * uses them. Returns the number of octets queued, or -1 if it
+         * doesn't fit a packet or the device isn't configured.
+         */
+        int sendReport(const void* data, uint8_t len);
+
+        /*
+         * Whether a report is still waiting behind the one on the
+         * endpoint.
+         */
+        bool reportPending();
+
+        /*
+         * Called from the USB interrupt with each output report (e.g.
+         * keyboard LEDs) the host sends with SET_REPORT.
+         */
+        void onOutputReport(void (*callback)(const uint8_t* data, uint8_t len));
+
+        /*
+         * Boot or report protocol, as last set by the host.
+         */
+        uint8_t getProtocol();
+
+    protected:
+        bool setup(arduino::USBSetup& setup);
+        int getInterface(uint8_t* interfaceCount);
+        int getDescriptor(arduino::USBSetup& setup);
+
+    private:
+        unsigned int epType[1];
+
+        const uint8_t* reportDescriptor;
+        uint16_t descriptorLength;
+        uint8_t bootProtocol;
+        uint8_t interval;
+
+        uint8_t protocol = 1;
+        uint8_t idle = 0;
+        void (*outputCallback)(const uint8_t* data, uint8_t len) = nullptr;
+
+        /*
+         * The latest report; it stays here after it is sent for
+         * GET_REPORT.
+         */
+        uint8_t report[USB_EP_SIZE];
+        uint8_t reportLen = 0;
+        volatile bool pending = false;
+
+        void sendPending();
+        static void transcIn(void* arg, uint8_t ep);
+};
+#endif
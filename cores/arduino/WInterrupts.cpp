@@ -19,11 +19,12 @@
 #include "Arduino.h"
 #include <api/Interrupts.h>
 #include "gpio_interrupt.h"
+#include "gd32/deferred.h"
+#include "gd32/vectors.h"
 
-void attachInterrupt(pin_size_t pin, voidFuncPtr callback, PinStatus mode)
+static exti_trig_type_enum interrupt_trigger(PinStatus mode)
 {
     exti_trig_type_enum it_mode;
-    PinName pinname = DIGITAL_TO_PINNAME(pin);
 
     switch (mode) {
         case CHANGE :
@@ -41,7 +42,46 @@ void attachInterrupt(pin_size_t pin, voidFuncPtr callback, PinStatus mode)
             it_mode = EXTI_TRIG_RISING;
             break;
     }
-    gpio_interrupt_enable(GD_PORT_GET(pinname), GD_PIN_GET(pinname), callback, it_mode);
+    return it_mode;
+}
+
+void attachInterrupt(pin_size_t pin, voidFuncPtr callback, PinStatus mode)
+{
+    PinName pinname = DIGITAL_TO_PINNAME(pin);
+    gpio_interrupt_enable(GD_PORT_GET(pinname), GD_PIN_GET(pinname), callback,
+                          interrupt_trigger(mode));
+}
+
+void attachInterruptParam(pin_size_t pin, voidFuncPtrParam callback, PinStatus mode, void *param)
+{
+    PinName pinname = DIGITAL_TO_PINNAME(pin);
+    gpio_interrupt_enable_param(GD_PORT_GET(pinname), GD_PIN_GET(pinname), callback, param,
+                                interrupt_trigger(mode));
+}
+
+/* the EXTI interrupt only queues the callback, passed along as param */
+static void deferredInterrupt(void *callback)
+{
+    deferred_post_call((voidFuncPtr)callback);
+}
+
+void attachInterruptDeferred(pin_size_t pin, voidFuncPtr callback, PinStatus mode)
+{
+    PinName pinname = DIGITAL_TO_PINNAME(pin);
+    gpio_interrupt_enable_param(GD_PORT_GET(pinname), GD_PIN_GET(pinname), deferredInterrupt,
+                                (void *)callback, interrupt_trigger(mode));
+}
+
+void setInterruptPriority(pin_size_t pin, uint8_t priority)
+{
+    PinName pinname = DIGITAL_TO_PINNAME(pin);
+    gpio_interrupt_priority(GD_PIN_GET(pinname), priority, 0);
+}
+
+void attachInterruptPriority(pin_size_t pin, voidFuncPtr callback, PinStatus mode, uint8_t priority)
+{
+    setInterruptPriority(pin, priority);
+    attachInterrupt(pin, callback, mode);
 }
 
 void detachInterrupt(pin_size_t pin)
@@ -49,3 +89,19 @@ void detachInterrupt(pin_size_t pin)
     PinName pinname = DIGITAL_TO_PINNAME(pin);
     gpio_interrupt_disable(GD_PIN_GET(pinname));
 }
+
+void attachVector(IRQn_Type irq, voidFuncPtr callback)
+{
+    vector_attach(irq, callback);
+}
+
+void detachVector(IRQn_Type irq)
+{
+    vector_detach(irq);
+}
+
+uint32_t interruptTimestamp(pin_size_t pin)
+{
+    PinName pinname = DIGITAL_TO_PINNAME(pin);
+    return gpio_interrupt_timestamp(GD_PIN_GET(pinname));
+}
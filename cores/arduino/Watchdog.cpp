@@ -0,0 +1,97 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "Watchdog.h"
+
+WatchdogClass Watchdog;
+
+/*!
+    \brief      start the free watchdog, or change its timeout
+    \param[in]  timeout_ms: time without a refresh until the reset
+    \param[out] none
+    \retval     the timeout it got in milliseconds
+*/
+uint32_t WatchdogClass::begin(uint32_t timeout_ms)
+{
+    return watchdog_begin(timeout_ms);
+}
+
+/*!
+    \brief      start the window watchdog
+    \param[in]  timeout_us: time without a refresh until the reset
+    \param[in]  window_us: refreshes sooner than this after the previous one reset the part too
+    \param[out] none
+    \retval     the timeout it got in microseconds, 0 if PCLK1 doesn't allow it
+*/
+uint32_t WatchdogClass::beginWindow(uint32_t timeout_us, uint32_t window_us)
+{
+    return watchdog_window_begin(timeout_us, window_us);
+}
+
+/*!
+    \brief      add a task or loop the free watchdog waits for
+    \param[in]  none
+    \param[out] none
+    \retval     the client for checkIn(), -1 if all are taken
+*/
+int WatchdogClass::addClient(void)
+{
+    return watchdog_client_add();
+}
+
+/*!
+    \brief      stop waiting for a client
+    \param[in]  client: from addClient()
+    \param[out] none
+    \retval     none
+*/
+void WatchdogClass::removeClient(int client)
+{
+    watchdog_client_remove(client);
+}
+
+/*!
+    \brief      report a client alive, the last of a round refreshes the free watchdog
+    \param[in]  client: from addClient()
+    \param[out] none
+    \retval     none
+*/
+void WatchdogClass::checkIn(int client)
+{
+    watchdog_check_in(client);
+}
+
+/*!
+    \brief      tell whether a watchdog caused the last reset
+    \param[in]  none
+    \param[out] none
+    \retval     true for the free or the window watchdog
+*/
+bool WatchdogClass::causedReset(void)
+{
+    return watchdog_caused_reset();
+}
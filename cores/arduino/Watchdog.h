@@ -0,0 +1,63 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef _GD_WATCHDOG_H_
+#define _GD_WATCHDOG_H_
+
+#include "Arduino.h"
+#include "gd32/watchdog.h"
+
+/*
+ * begin() starts the free watchdog, which resets the part unless
+ * refresh() comes within the timeout; it can't be stopped again. With
+ * several tasks or loops to watch, each takes a client from addClient()
+ * and calls checkIn() instead of refresh(): the watchdog is refreshed
+ * once all of them checked in, so any single one that hangs resets the
+ * part. See gd32/watchdog.h for the window watchdog and the limits.
+ */
+class WatchdogClass
+{
+    public:
+        uint32_t begin(uint32_t timeout_ms);                              //start, returns the timeout in ms
+        void refresh(void)                                                //one register store
+        {
+            watchdog_refresh();
+        }
+        uint32_t beginWindow(uint32_t timeout_us, uint32_t window_us = 0); //window watchdog, 0 if out of range
+        void refreshWindow(void)                                          //window watchdog, one register store
+        {
+            watchdog_window_refresh();
+        }
+        int addClient(void);                                              //supervisor client, -1 if none left
+        void removeClient(int client);                                    //no longer wait for it
+        void checkIn(int client);                                         //the last of a round refreshes
+        bool causedReset(void);                                           //the last reset came from a watchdog
+};
+
+extern WatchdogClass Watchdog;
+
+#endif /* _GD_WATCHDOG_H_ */
@@ -30,7 +30,12 @@ OF SUCH DAMAGE.
 
 #include "analog.h"
 #include "pwm.h"
+#include "pins_arduino.h"
 #include "fatal.h"
+#include "gd32/os_event.h"
+#include "gd32/irq_profile.h"
+#include "gd32/irq_priority.h"
+#include "gd32/clock.h"
 
 #if defined(DAC0) && defined(DAC1)
 #define DAC_NUMS  2
@@ -69,12 +74,99 @@ analog_t DAC_[DAC_NUMS] = {0};
 #endif
 analog_t ADC_[ADC_NUMS] = {0};
 
+/* inverse of get_adc_index() */
+static const uint32_t adc_periphs[ADC_NUMS] = {
+#if defined(GD32F30x) || defined(GD32E50X)
+    ADC0,
+#if ADC_NUMS > 1
+    ADC1,
+#endif
+#if ADC_NUMS > 2
+    ADC2,
+#endif
+#else
+    ADC,
+#endif
+};
+
+/* adc index and channel of every digital pin, filled in by the first get_adc_pin_value() */
+#define ADC_PIN_DESC_UNKNOWN        0x00U
+#define ADC_PIN_DESC_NONE           0xFFU
+#define ADC_PIN_DESC(index, ch)     ((uint8_t)((((index) << 5) | (ch)) + 1U))
+#define ADC_PIN_DESC_INDEX(desc)    ((uint8_t)(((desc) - 1U) >> 5))
+#define ADC_PIN_DESC_CHANNEL(desc)  ((uint8_t)(((desc) - 1U) & 0x1FU))
+static uint8_t adc_pin_desc[DIGITAL_PINS_NUM] = {ADC_PIN_DESC_UNKNOWN};
+
+/* no channel in rank 0 of the regular sequence yet */
+#define ADC_CHANNEL_NONE            0xFFU
+
+#define ADC_SAMPLETIME_DEFAULT      ADC_SAMPLETIME_7POINT5
+
+#if defined(GD32F30x) || defined(GD32E50X) || defined(GD32F3x0) || defined(GD32F170_190) || defined(GD32E23x)
+#define ADC_HAS_RESOLUTION
+#endif
+#if defined(GD32F30x) || defined(GD32E50X) || defined(GD32F3x0) || defined(GD32E23x)
+#define ADC_HAS_OVERSAMPLER
+#endif
+
+/* settings shared by all adcs, applied by adc_apply_config() */
+#if defined(GD32F30x) || defined(GD32E50X)
+static uint32_t adc_prescaler = RCU_CKADC_CKAPB2_DIV6;
+#else
+static uint32_t adc_prescaler = RCU_ADCCK_APB2_DIV6;
+#endif
+static uint8_t adc_resolution_bits = 12U;
+static uint8_t adc_oversample_log2 = 0U;
+static uint8_t adc_oversample_shift = 0U;
+/* ADC_SAMPLETIME_x + 1 of every digital pin, 0 for ADC_SAMPLETIME_DEFAULT */
+static uint8_t adc_pin_sample_time[DIGITAL_PINS_NUM] = {0};
+
+#if (defined(GD32F30x) || defined(GD32E50X)) && (ADC_NUMS > 1)
+#define ADC_HAS_DUAL_MODE
+/* ADC0 and ADC1 are synchronised by adc_dual_start(), both are owned by it */
+static uint8_t adc_dual_running = 0U;
+#define ADC_DUAL_OWNS(index)        (adc_dual_running && ((index) < 2U))
+#else
+#define ADC_DUAL_OWNS(index)        (0)
+#endif
+
+/* iswatching: the watchdog converts its channel itself, or watches the conversions of a scan */
+#define ADC_WATCH_NONE              0U
+#define ADC_WATCH_CONVERTING        1U
+#define ADC_WATCH_SCAN              2U
+/* single conversions are not possible while a scan, the dual mode or the watchdog runs the adc */
+#define ADC_OWNED(index)            (ADC_[index].isscanning || (ADC_[index].iswatching == ADC_WATCH_CONVERTING))
+
+/* conversion started by adc_async_start() */
+#define ADC_ASYNC_IDLE              0U
+#define ADC_ASYNC_BUSY              1U
+#define ADC_ASYNC_DONE              2U
+typedef struct {
+    volatile uint8_t state;
+    uint8_t index;
+    volatile uint16_t value;
+    adc_async_callback_t callback;
+    void *arg;
+} adc_async_infor_t;
+
+static adc_async_infor_t adc_async = {ADC_ASYNC_IDLE, 0U, 0U, NULL, NULL};
+
+#if defined(GD32F30x) || defined(GD32E50X)
+#define ADC_RDATA_ADDR(adc_periph)  ((uint32_t)&ADC_RDATA(adc_periph))
+#else
+#define ADC_RDATA_ADDR(adc_periph)  ((uint32_t)&ADC_RDATA)
+#endif
+
 // dac write value
 void set_dac_value(PinName pinname, uint16_t value)
 {
 #if DAC_NUMS != 0
     uint32_t dac_periph = pinmap_peripheral(pinname, PinMap_DAC);
     uint8_t index = get_dac_index(dac_periph);
+    /* the converter belongs to a running stream, see dac_stream_start() */
+    if (DAC_[index].isscanning) {
+        return;
+    }
     if (!DAC_[index].isactive) {
         pinmap_pinout(pinname, PinMap_DAC);
         rcu_periph_clock_enable(RCU_DAC);
@@ -86,129 +178,1833 @@ void set_dac_value(PinName pinname, uint16_t value)
                 break;
             }
         }
-        if(do_reset) {
-            dac_deinit();
+        if(do_reset) {
+            dac_deinit();
+        }
+#if (defined(GD32F1x0) && defined(GD32F170_190)) || defined(GD32F30x) || defined(GD32E50X)
+        dac_trigger_disable(dac_periph);
+#if defined(GD32F30x) || defined(GD32E50X)
+        dac_wave_mode_config(dac_periph, DAC_WAVE_DISABLE);
+#endif
+        dac_output_buffer_enable(dac_periph);
+        dac_enable(dac_periph);
+        dac_data_set(dac_periph, DAC_ALIGN_12B_R, value);
+#elif defined(GD32F1x0) && !defined(GD32F170_190)
+        dac0_trigger_disable();
+        dac0_output_buffer_enable();
+        dac0_enable();
+        dac0_data_set(DAC_ALIGN_12B_R, value);
+#elif defined(GD32F3x0)
+        /* only has 1 DAC at maximum, no need for a parameter... */
+        dac_trigger_disable();
+        dac_wave_mode_config(DAC_WAVE_DISABLE);
+        dac_output_buffer_enable();
+        dac_enable();
+        dac_data_set(DAC_ALIGN_12B_R, value);
+#endif
+        DAC_[index].isactive = true;
+    } else {
+        //set dac value
+#if defined(GD32F30x) || (defined(GD32F1x0) && defined(GD32F170_190)) || defined(GD32E50X)
+        dac_data_set(dac_periph, DAC_ALIGN_12B_R, value);
+#elif defined(GD32F10x) && !defined(GD32F170_190)
+        dac0_data_set(DAC_ALIGN_12B_R, value);
+#elif defined(GD32F3x0)
+        dac_data_set(DAC_ALIGN_12B_R, value);
+#endif
+    }
+#endif
+}
+
+#if DAC_NUMS != 0 && (defined(GD32F30x) || defined(GD32F3x0))
+#define DAC_HAS_STREAM
+#endif
+
+#if DAC_NUMS > 1 && defined(GD32F30x)
+#define DAC_HAS_DUAL
+#endif
+
+#if defined(DAC_HAS_STREAM) && defined(DAC_HAS_DUAL)
+#define DAC_HAS_DUAL_STREAM
+/* both dacs belong to dac_dual_stream_start(), not to streams of their own */
+static bool dac_dual_streaming = false;
+#endif
+
+#if defined(DAC_HAS_STREAM)
+//get the DMA channel serving the update requests of a dac, NULL if it has none
+static const dma_channel_t *get_dac_dma(uint32_t dac_periph)
+{
+#if defined(GD32F30x)
+    static const dma_channel_t dac_dma[DAC_NUMS] = {
+        {DMA1, DMA_CH2},
+#if DAC_NUMS > 1
+        {DMA1, DMA_CH3},
+#endif
+    };
+#else
+    static const dma_channel_t dac_dma[DAC_NUMS] = {
+        {0U, DMA_CH2},
+    };
+#endif
+    return &dac_dma[get_dac_index(dac_periph)];
+}
+
+//get the 12-bit right aligned data holding register of a dac
+static uint32_t get_dac_data_addr(uint32_t dac_periph)
+{
+#if defined(GD32F30x)
+#if DAC_NUMS > 1
+    if (dac_periph == DAC1) {
+        return (uint32_t)&DAC1_R12DH;
+    }
+#endif
+    (void)dac_periph;
+    return (uint32_t)&DAC0_R12DH;
+#else
+    (void)dac_periph;
+    return (uint32_t)&DAC_R12DH;
+#endif
+}
+
+//get the trigger source selecting TRGO of a timer, 0xFFFFFFFF if that timer cannot trigger the dac
+static uint32_t get_dac_trigger(uint32_t timer)
+{
+    switch (timer) {
+        case TIMER5:
+            return DAC_TRIGGER_T5_TRGO;
+#if defined(GD32F30x)
+        case TIMER6:
+            return DAC_TRIGGER_T6_TRGO;
+#endif
+        default:
+            return 0xFFFFFFFFU;
+    }
+}
+#endif
+
+//output a buffer on a dac pin, one sample per update of timer, moved by circular DMA
+//callback gets DMA_CALLBACK_FLAG_HTF/FTF as each half has been sent and may be refilled
+//wave DAC_STREAM_WAVE_NOISE or DAC_STREAM_WAVE_TRIANGLE adds noise of wave_bits LSBs or a triangle
+//of 2^wave_bits - 1 on top of the samples, buffer NULL adds it on top of value instead
+uint8_t dac_stream_start(PinName pinname, const uint16_t *buffer, size_t length, uint16_t value,
+                         uint32_t timer, uint8_t wave, uint8_t wave_bits,
+                         dma_callback_t callback, void *arg)
+{
+#if defined(DAC_HAS_STREAM)
+    dma_parameter_struct dma_init_struct;
+    const dma_channel_t *ch;
+    uint32_t dac_periph = pinmap_peripheral(pinname, PinMap_DAC);
+    uint32_t trigger = get_dac_trigger(timer);
+    uint32_t wave_mode;
+    uint32_t wave_width = DWBW(((wave_bits < 1U) ? 1U : ((wave_bits > 12U) ? 12U : wave_bits)) - 1U);
+    uint8_t index;
+
+    if (((uint32_t)NC == dac_periph) || (trigger == 0xFFFFFFFFU)
+            || ((buffer == NULL) && (wave == DAC_STREAM_WAVE_NONE))
+            || ((buffer != NULL) && (length == 0U))) {
+        return 0;
+    }
+    switch (wave) {
+        case DAC_STREAM_WAVE_NOISE:
+            wave_mode = DAC_WAVE_MODE_LFSR;
+            break;
+        case DAC_STREAM_WAVE_TRIANGLE:
+            wave_mode = DAC_WAVE_MODE_TRIANGLE;
+            break;
+        default:
+            wave_mode = DAC_WAVE_DISABLE;
+            break;
+    }
+    index = get_dac_index(dac_periph);
+    dac_stream_stop(pinname);
+    /* still held by dac_dual_stream_start() */
+    if (DAC_[index].isscanning) {
+        return 0;
+    }
+    if ((buffer != NULL) && !dma_channel_claim(get_dac_dma(dac_periph), &DAC_[index])) {
+        return 0;
+    }
+    pinmap_pinout(pinname, PinMap_DAC);
+    rcu_periph_clock_enable(RCU_DAC);
+
+#if defined(GD32F30x)
+    dac_disable(dac_periph);
+    dac_output_buffer_enable(dac_periph);
+    dac_trigger_source_config(dac_periph, trigger);
+    dac_trigger_enable(dac_periph);
+    dac_wave_mode_config(dac_periph, wave_mode);
+    if (wave_mode != DAC_WAVE_DISABLE) {
+        dac_wave_bit_width_config(dac_periph, wave_width);
+    }
+#else
+    dac_disable();
+    dac_output_buffer_enable();
+    dac_trigger_source_config(trigger);
+    dac_trigger_enable();
+    dac_wave_mode_config(wave_mode);
+    if (wave_mode != DAC_WAVE_DISABLE) {
+        dac_wave_bit_width_config(wave_width);
+    }
+#endif
+    if (buffer != NULL) {
+        ch = get_dac_dma(dac_periph);
+        dma_channel_clock_enable(ch);
+        dma_deinit(DMA_SPL_ARGS(ch));
+        dma_struct_para_init(&dma_init_struct);
+        dma_init_struct.direction    = DMA_MEMORY_TO_PERIPHERAL;
+        dma_init_struct.memory_addr  = (uint32_t)buffer;
+        dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+        dma_init_struct.memory_width = DMA_MEMORY_WIDTH_16BIT;
+        dma_init_struct.number       = length;
+        dma_init_struct.periph_addr  = get_dac_data_addr(dac_periph);
+        dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+        dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_16BIT;
+        dma_init_struct.priority     = DMA_PRIORITY_HIGH;
+        dma_init(DMA_SPL_ARGS(ch), &dma_init_struct);
+        dma_circulation_enable(DMA_SPL_ARGS(ch));
+        dma_memory_to_memory_disable(DMA_SPL_ARGS(ch));
+        if (callback != NULL) {
+            dma_channel_attach_irq(ch, callback, arg, IRQ_LEVEL(IRQ_PRIO_DAC));
+            dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_HTF);
+            dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_FTF);
+        }
+        dma_channel_enable(DMA_SPL_ARGS(ch));
+    }
+#if defined(GD32F30x)
+    if (buffer != NULL) {
+        dac_dma_enable(dac_periph);
+    } else {
+        dac_data_set(dac_periph, DAC_ALIGN_12B_R, value);
+    }
+    dac_enable(dac_periph);
+#else
+    if (buffer != NULL) {
+        dac_dma_enable();
+    } else {
+        dac_data_set(DAC_ALIGN_12B_R, value);
+    }
+    dac_enable();
+#endif
+    Timer_setMasterMode(timer, TRGO_UPDATE, 0);
+    /* set_dac_value() has to set the converter up again once the stream is stopped */
+    DAC_[index].isactive = false;
+    DAC_[index].isscanning = true;
+    return 1;
+#else
+    (void)pinname;
+    (void)buffer;
+    (void)length;
+    (void)value;
+    (void)timer;
+    (void)wave;
+    (void)wave_bits;
+    (void)callback;
+    (void)arg;
+    return 0;
+#endif
+}
+
+//stop the output started by dac_stream_start(), the pin holds the last sample
+void dac_stream_stop(PinName pinname)
+{
+#if defined(DAC_HAS_STREAM)
+    uint32_t dac_periph = pinmap_peripheral(pinname, PinMap_DAC);
+    const dma_channel_t *ch;
+    uint8_t index;
+
+    if ((uint32_t)NC == dac_periph) {
+        return;
+    }
+    index = get_dac_index(dac_periph);
+    if (!DAC_[index].isscanning) {
+        return;
+    }
+#if defined(DAC_HAS_DUAL_STREAM)
+    if (dac_dual_streaming) {
+        return;
+    }
+#endif
+    ch = get_dac_dma(dac_periph);
+#if defined(GD32F30x)
+    dac_dma_disable(dac_periph);
+    dac_trigger_disable(dac_periph);
+    dac_wave_mode_config(dac_periph, DAC_WAVE_DISABLE);
+#else
+    dac_dma_disable();
+    dac_trigger_disable();
+    dac_wave_mode_config(DAC_WAVE_DISABLE);
+#endif
+    dma_channel_disable(DMA_SPL_ARGS(ch));
+    dma_interrupt_disable(DMA_SPL_ARGS(ch), DMA_INT_HTF);
+    dma_interrupt_disable(DMA_SPL_ARGS(ch), DMA_INT_FTF);
+    dma_channel_detach_irq(ch);
+    dma_channel_release(ch, &DAC_[index]);
+    DAC_[index].isscanning = false;
+#else
+    (void)pinname;
+#endif
+}
+
+//get the number of samples left until the stream DMA wraps to the start of the buffer
+uint32_t dac_stream_remaining(PinName pinname)
+{
+#if defined(DAC_HAS_STREAM)
+    uint32_t dac_periph = pinmap_peripheral(pinname, PinMap_DAC);
+
+    if (((uint32_t)NC == dac_periph) || !DAC_[get_dac_index(dac_periph)].isscanning) {
+        return 0;
+    }
+#if defined(DAC_HAS_DUAL_STREAM)
+    if (dac_dual_streaming) {
+        return 0;
+    }
+#endif
+    return dma_transfer_number_get(DMA_SPL_ARGS(get_dac_dma(dac_periph)));
+#else
+    (void)pinname;
+    return 0;
+#endif
+}
+
+#if defined(DAC_HAS_DUAL)
+//connect the pins of both dacs
+static void dac_dual_pinout(void)
+{
+    const PinMap *map;
+
+    for (map = PinMap_DAC; map->pin != NC; map++) {
+        pinmap_pinout(map->pin, PinMap_DAC);
+    }
+}
+#endif
+
+//write both dacs through the concurrent data register, the two outputs change on the same clock
+void set_dac_dual_value(uint16_t value0, uint16_t value1)
+{
+#if defined(DAC_HAS_DUAL)
+    uint32_t dac_periph[DAC_NUMS] = {DAC0, DAC1};
+    uint8_t i;
+
+    /* a converter belongs to a running stream */
+    if (DAC_[0].isscanning || DAC_[1].isscanning) {
+        return;
+    }
+    if (!DAC_[0].isactive || !DAC_[1].isactive) {
+        dac_dual_pinout();
+        rcu_periph_clock_enable(RCU_DAC);
+        if (!DAC_[0].isactive && !DAC_[1].isactive) {
+            dac_deinit();
+        }
+        for (i = 0; i < DAC_NUMS; i++) {
+            if (DAC_[i].isactive) {
+                continue;
+            }
+            dac_trigger_disable(dac_periph[i]);
+            dac_wave_mode_config(dac_periph[i], DAC_WAVE_DISABLE);
+            dac_output_buffer_enable(dac_periph[i]);
+            DAC_[i].isactive = true;
+        }
+        dac_concurrent_enable();
+    }
+    dac_concurrent_data_set(DAC_ALIGN_12B_R, value0, value1);
+#else
+    (void)value0;
+    (void)value1;
+#endif
+}
+
+//output a buffer of DAC_DUAL_SAMPLE() pairs on both dacs, one pair per update of timer, moved
+//by one circular DMA channel into the concurrent data register so the channels never skew
+//callback gets DMA_CALLBACK_FLAG_HTF/FTF as each half has been sent and may be refilled
+uint8_t dac_dual_stream_start(const uint32_t *buffer, size_t length, uint32_t timer,
+                              dma_callback_t callback, void *arg)
+{
+#if defined(DAC_HAS_DUAL_STREAM)
+    dma_parameter_struct dma_init_struct;
+    const dma_channel_t *ch = get_dac_dma(DAC0);
+    uint32_t dac_periph[DAC_NUMS] = {DAC0, DAC1};
+    uint32_t trigger = get_dac_trigger(timer);
+    uint8_t i;
+
+    if ((trigger == 0xFFFFFFFFU) || (buffer == NULL) || (length == 0U)) {
+        return 0;
+    }
+    dac_dual_stream_stop();
+    /* a stream of its own holds one of the dacs */
+    if (DAC_[0].isscanning || DAC_[1].isscanning) {
+        return 0;
+    }
+    if (!dma_channel_claim(ch, &DAC_[0])) {
+        return 0;
+    }
+    dac_dual_pinout();
+    rcu_periph_clock_enable(RCU_DAC);
+
+    /* both convert on the same TRGO, DAC0 alone requests the next pair */
+    for (i = 0; i < DAC_NUMS; i++) {
+        dac_disable(dac_periph[i]);
+        dac_dma_disable(dac_periph[i]);
+        dac_output_buffer_enable(dac_periph[i]);
+        dac_trigger_source_config(dac_periph[i], trigger);
+        dac_trigger_enable(dac_periph[i]);
+        dac_wave_mode_config(dac_periph[i], DAC_WAVE_DISABLE);
+    }
+
+    dma_channel_clock_enable(ch);
+    dma_deinit(DMA_SPL_ARGS(ch));
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.direction    = DMA_MEMORY_TO_PERIPHERAL;
+    dma_init_struct.memory_addr  = (uint32_t)buffer;
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_32BIT;
+    dma_init_struct.number       = length;
+    dma_init_struct.periph_addr  = (uint32_t)&DACC_R12DH;
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_32BIT;
+    dma_init_struct.priority     = DMA_PRIORITY_HIGH;
+    dma_init(DMA_SPL_ARGS(ch), &dma_init_struct);
+    dma_circulation_enable(DMA_SPL_ARGS(ch));
+    dma_memory_to_memory_disable(DMA_SPL_ARGS(ch));
+    if (callback != NULL) {
+        dma_channel_attach_irq(ch, callback, arg, IRQ_LEVEL(IRQ_PRIO_DAC));
+        dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_HTF);
+        dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_FTF);
+    }
+    dma_channel_enable(DMA_SPL_ARGS(ch));
+    dac_dma_enable(DAC0);
+    dac_concurrent_enable();
+    Timer_setMasterMode(timer, TRGO_UPDATE, 0);
+    for (i = 0; i < DAC_NUMS; i++) {
+        DAC_[i].isactive = false;
+        DAC_[i].isscanning = true;
+    }
+    dac_dual_streaming = true;
+    return 1;
+#else
+    (void)buffer;
+    (void)length;
+    (void)timer;
+    (void)callback;
+    (void)arg;
+    return 0;
+#endif
+}
+
+//stop the output started by dac_dual_stream_start(), the pins hold the last pair
+void dac_dual_stream_stop(void)
+{
+#if defined(DAC_HAS_DUAL_STREAM)
+    const dma_channel_t *ch = get_dac_dma(DAC0);
+    uint32_t dac_periph[DAC_NUMS] = {DAC0, DAC1};
+    uint8_t i;
+
+    if (!dac_dual_streaming) {
+        return;
+    }
+    dac_dma_disable(DAC0);
+    for (i = 0; i < DAC_NUMS; i++) {
+        dac_trigger_disable(dac_periph[i]);
+    }
+    dma_channel_disable(DMA_SPL_ARGS(ch));
+    dma_interrupt_disable(DMA_SPL_ARGS(ch), DMA_INT_HTF);
+    dma_interrupt_disable(DMA_SPL_ARGS(ch), DMA_INT_FTF);
+    dma_channel_detach_irq(ch);
+    dma_channel_release(ch, &DAC_[0]);
+    for (i = 0; i < DAC_NUMS; i++) {
+        DAC_[i].isscanning = false;
+    }
+    dac_dual_streaming = false;
+#endif
+}
+
+//get the number of pairs left until the dual stream DMA wraps to the start of the buffer
+uint32_t dac_dual_stream_remaining(void)
+{
+#if defined(DAC_HAS_DUAL_STREAM)
+    if (!dac_dual_streaming) {
+        return 0;
+    }
+    return dma_transfer_number_get(DMA_SPL_ARGS(get_dac_dma(DAC0)));
+#else
+    return 0;
+#endif
+}
+
+/* PWM channels configured by analogWrite(), indexed by digital pin number */
+typedef struct {
+    PWM *pwm;
+    uint32_t freq_hz;       // frequency requested for the pin, 0 follows the default
+    uint32_t applied_hz;    // frequency the timer was last programmed with
+    uint16_t value;         // last duty cycle, 0..65535
+    bool running;
+} pwm_cache_t;
+
+static pwm_cache_t pwm_cache[DIGITAL_PINS_NUM];
+
+// get the cache slot of a pin, analog aliases share the slot of their digital pin
+static pwm_cache_t *get_pwm_cache(pin_size_t ulPin)
+{
+    uint32_t pin = ulPin;
+    if (pin >= DIGITAL_PINS_NUM) {
+        pin = PinName_to_digital(DIGITAL_TO_PINNAME(ulPin));
+        if (pin >= DIGITAL_PINS_NUM) {
+            return NULL;
+        }
+    }
+    return &pwm_cache[pin];
+}
+
+//pwm set value
+void set_pwm_value(pin_size_t ulPin, uint32_t value)
+{
+    set_pwm_value_with_frequency(ulPin, 1000, value);
+}
+
+//pwm set value
+void set_pwm_value_with_base_period(pin_size_t ulPin, uint32_t base_period_us, uint32_t value)
+{
+    if (base_period_us == 0) {
+        return;
+    }
+    set_pwm_value_with_frequency(ulPin, 1000000U / base_period_us, value);
+}
+
+//pwm set value (0..65535), only the first call on a pin and frequency changes configure the timer
+void set_pwm_value_with_frequency(pin_size_t ulPin, uint32_t freq_hz, uint32_t value)
+{
+    pwm_cache_t *cache = get_pwm_cache(ulPin);
+    uint32_t period;
+    if (cache == NULL) {
+        return;
+    }
+    if (cache->freq_hz != 0) {
+        freq_hz = cache->freq_hz;
+    }
+    if (cache->pwm == NULL) {
+        cache->pwm = new PWM(ulPin);
+        cache->applied_hz = 0;
+    } else if (!cache->running) {
+        // the pin may have been switched to a GPIO by stop_pwm() in the meantime
+        pinmap_pinout(DIGITAL_TO_PINNAME(ulPin), PinMap_PWM);
+    }
+    if (cache->applied_hz != freq_hz) {
+        if (cache->pwm->setFrequency(freq_hz) == 0) {
+            return;
+        }
+        cache->applied_hz = freq_hz;
+    }
+    cache->value = value;
+    // read back the period, other channels of the same timer may have changed it
+    period = cache->pwm->getPeriodTicks();
+    // compare register is shadowed, the new value takes effect at the next period
+    cache->pwm->writeCycleValue((uint32_t)(((uint64_t)value * period + 32767U) / 65535U), FORMAT_TICK);
+    if (!cache->running) {
+        cache->pwm->start();
+        cache->running = true;
+    }
+}
+
+//pwm set frequency of a pin, takes effect immediately if the pin is already running
+void set_pwm_frequency(pin_size_t ulPin, uint32_t freq_hz)
+{
+    pwm_cache_t *cache = get_pwm_cache(ulPin);
+    if (cache == NULL) {
+        return;
+    }
+    cache->freq_hz = freq_hz;
+    if (cache->running && (freq_hz != 0) && (cache->applied_hz != freq_hz)) {
+        set_pwm_value_with_frequency(ulPin, freq_hz, cache->value);
+    }
+}
+
+//per pin pwm frequency
+void analogWriteFrequency(uint32_t pin, uint32_t freq_hz)
+{
+    set_pwm_frequency(pin, freq_hz);
+}
+
+//pwm stop
+void stop_pwm(pin_size_t ulPin)
+{
+    pwm_cache_t *cache = get_pwm_cache(ulPin);
+    if ((cache != NULL) && (cache->pwm != NULL) && cache->running) {
+        cache->pwm->stop();
+        cache->running = false;
+    }
+}
+
+//program clock, resolution and oversampler of an adc, the adc has to be disabled
+static void adc_apply_config(uint32_t adc_periph)
+{
+#ifdef ADC_HAS_RESOLUTION
+    uint32_t resolution;
+
+    switch (adc_resolution_bits) {
+        case 6:
+            resolution = ADC_RESOLUTION_6B;
+            break;
+        case 8:
+            resolution = ADC_RESOLUTION_8B;
+            break;
+        case 10:
+            resolution = ADC_RESOLUTION_10B;
+            break;
+        default:
+            resolution = ADC_RESOLUTION_12B;
+            break;
+    }
+#endif
+#if defined(GD32F30x) || defined(GD32E50X)
+    rcu_adc_clock_config(adc_prescaler);
+    adc_resolution_config(adc_periph, resolution);
+    if (adc_oversample_log2 != 0U) {
+        adc_oversample_mode_config(adc_periph, ADC_OVERSAMPLING_ALL_CONVERT,
+                                   (uint16_t)OVSAMPCTL_OVSS(adc_oversample_shift),
+                                   (uint8_t)OVSAMPCTL_OVSR(adc_oversample_log2 - 1U));
+        adc_oversample_mode_enable(adc_periph);
+    } else {
+        adc_oversample_mode_disable(adc_periph);
+    }
+#else
+    (void)adc_periph;
+    rcu_adc_clock_config((rcu_adc_clock_enum)adc_prescaler);
+#ifdef ADC_HAS_RESOLUTION
+    adc_resolution_config(resolution);
+#endif
+#ifdef ADC_HAS_OVERSAMPLER
+    if (adc_oversample_log2 != 0U) {
+        adc_oversample_mode_config(ADC_OVERSAMPLING_ALL_CONVERT,
+                                   (uint16_t)OVSAMPCTL_OVSS(adc_oversample_shift),
+                                   (uint8_t)OVSAMPCTL_OVSR(adc_oversample_log2 - 1U));
+        adc_oversample_mode_enable();
+    } else {
+        adc_oversample_mode_disable();
+    }
+#endif
+#endif
+}
+
+//wait for the result of the conversion started by adc_async_start() so the adc can be used again
+static void adc_async_finish(uint32_t adc_periph, uint8_t index)
+{
+    if ((adc_async.state != ADC_ASYNC_BUSY) || (adc_async.index != index)) {
+        return;
+    }
+    if (adc_async.callback != NULL) {
+        /* the end of conversion interrupt stores the result */
+        while (adc_async.state == ADC_ASYNC_BUSY) {
+            os_event_wait();
+        }
+        return;
+    }
+#if defined(GD32F30x) || defined(GD32E50X)
+    while (!adc_flag_get(adc_periph, ADC_FLAG_EOC));
+    adc_flag_clear(adc_periph, ADC_FLAG_EOC);
+    adc_async.value = adc_regular_data_read(adc_periph);
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+    (void)adc_periph;
+    while (!adc_flag_get(ADC_FLAG_EOC));
+    adc_flag_clear(ADC_FLAG_EOC);
+    adc_async.value = adc_regular_data_read();
+#endif
+    adc_async.state = ADC_ASYNC_DONE;
+}
+
+//make every adc that is not scanning pick up changed settings with its next conversion
+static void adc_single_reset_all(void)
+{
+    uint8_t index;
+
+    for (index = 0U; index < ADC_NUMS; index++) {
+        if (ADC_[index].isactive && !ADC_OWNED(index) && !ADC_[index].isinserted) {
+            adc_async_finish(adc_periphs[index], index);
+#if defined(GD32F30x) || defined(GD32E50X)
+            adc_disable(adc_periphs[index]);
+#else
+            adc_disable();
+#endif
+            ADC_[index].isactive = false;
+        }
+    }
+}
+
+//switch off and gate the clock of an adc once no conversion, scan, inserted group or watchdog uses it
+static void adc_gate_idle(uint32_t adc_periph, uint8_t index)
+{
+    if (ADC_[index].isactive || ADC_[index].isscanning || ADC_[index].isinserted
+            || (ADC_[index].iswatching != ADC_WATCH_NONE) || ADC_DUAL_OWNS(index)) {
+        return;
+    }
+#if defined(GD32F30x) || defined(GD32E50X)
+    adc_disable(adc_periph);
+#else
+    adc_disable();
+#endif
+    adc_clock_disable(adc_periph);
+}
+
+//set the adc resolution, rounded up to what the hardware offers: 6, 8, 10 or 12 bits
+void set_adc_resolution(uint8_t bits)
+{
+    uint8_t hw_bits = 12U;
+
+#ifdef ADC_HAS_RESOLUTION
+    if (bits <= 6U) {
+        hw_bits = 6U;
+    } else if (bits <= 8U) {
+        hw_bits = 8U;
+    } else if (bits <= 10U) {
+        hw_bits = 10U;
+    }
+#else
+    (void)bits;
+#endif
+    if (hw_bits != adc_resolution_bits) {
+        adc_resolution_bits = hw_bits;
+        adc_single_reset_all();
+    }
+}
+
+//get the number of bits of the results, including the gain of the oversampler
+uint8_t get_adc_resolution(void)
+{
+    int32_t bits = (int32_t)adc_resolution_bits + adc_oversample_log2 - adc_oversample_shift;
+
+    return (bits > 16) ? 16U : (uint8_t)bits;
+}
+
+//set the adc clock prescaler, RCU_CKADC_CKAPB2_DIVx or RCU_ADCCK_APB2_DIVx depending on the series
+void set_adc_clock_prescaler(uint32_t prescaler)
+{
+    adc_prescaler = prescaler;
+    adc_single_reset_all();
+}
+
+//set the sample time of a digital pin, ADC_SAMPLETIME_x
+void set_adc_sample_time(pin_size_t ulPin, uint32_t sample_time)
+{
+    uint32_t slot = ulPin;
+
+#ifdef ANALOG_PINS_LAST
+    if ((ulPin >= ANALOG_PINS_START) && (ulPin <= ANALOG_PINS_LAST)) {
+        slot = analog_pins[ulPin - ANALOG_PINS_START];
+    }
+#endif
+    if (slot >= DIGITAL_PINS_NUM) {
+        return;
+    }
+    adc_pin_sample_time[slot] = (uint8_t)(sample_time + 1U);
+}
+
+//average 2^ratio_log2 conversions into one result shifted right by shift bits, ratio_log2 0 turns it off
+//returns 0 if the series has no oversampler
+uint8_t set_adc_oversampling(uint8_t ratio_log2, uint8_t shift)
+{
+#ifdef ADC_HAS_OVERSAMPLER
+    if ((ratio_log2 > 8U) || (shift > 8U)) {
+        return 0;
+    }
+    adc_oversample_log2 = ratio_log2;
+    adc_oversample_shift = (ratio_log2 != 0U) ? shift : 0U;
+    adc_single_reset_all();
+    return 1;
+#else
+    (void)ratio_log2;
+    (void)shift;
+    return 0;
+#endif
+}
+
+//set up an adc for single software triggered conversions
+static void adc_single_init(uint32_t adc_periph, uint8_t index)
+{
+    adc_clock_enable(adc_periph);
+
+    adc_apply_config(adc_periph);
+#if defined(GD32F30x)|| defined(GD32E50X)
+    /* the synchronisation mode lives in ADC0 and covers ADC1 as well */
+    if (!ADC_DUAL_OWNS(0U)) {
+        adc_mode_config(ADC_MODE_FREE);
+    }
+    adc_data_alignment_config(adc_periph, ADC_DATAALIGN_RIGHT);
+    adc_channel_length_config(adc_periph, ADC_REGULAR_CHANNEL, 1U);
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+    adc_special_function_config(ADC_CONTINUOUS_MODE, ENABLE);
+    adc_data_alignment_config(ADC_DATAALIGN_RIGHT);
+    adc_channel_length_config(ADC_REGULAR_CHANNEL, 1U);
+#endif
+#if defined(GD32F30x) || defined(GD32E50X)
+    adc_external_trigger_source_config(adc_periph, ADC_REGULAR_CHANNEL, ADC0_1_2_EXTTRIG_REGULAR_NONE);
+#elif defined(GD32VF103) /* what?! Code for a RISC-V MCU here? */
+    adc_external_trigger_source_config(adc_periph, ADC_REGULAR_CHANNEL, ADC0_1_EXTTRIG_REGULAR_NONE);
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+    adc_external_trigger_source_config(ADC_REGULAR_CHANNEL, ADC_EXTTRIG_REGULAR_NONE);
+#endif
+#if defined(GD32F30x) || defined(GD32E50X)
+    adc_external_trigger_config(adc_periph, ADC_REGULAR_CHANNEL, ENABLE);
+    adc_enable(adc_periph);
+    delay(1U);
+    adc_calibration_enable(adc_periph);
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+    adc_external_trigger_config(ADC_REGULAR_CHANNEL, ENABLE);
+    adc_enable();
+    delay(1U);
+    adc_calibration_enable();
+#endif
+    ADC_[index].channel = ADC_CHANNEL_NONE;
+    ADC_[index].isactive = true;
+}
+
+//put a channel into rank 0 of the regular sequence, it is only rewritten when channel or sample time change
+static void adc_single_select(uint32_t adc_periph, uint8_t index, uint8_t channel, uint32_t sample_time)
+{
+    if ((ADC_[index].channel == channel) && (ADC_[index].sample_time == sample_time)) {
+        return;
+    }
+#if defined(GD32F30x) || defined(GD32E50X)
+    adc_regular_channel_config(adc_periph, 0U, channel, sample_time);
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+    (void)adc_periph;
+    adc_regular_channel_config(0U, channel, sample_time);
+#endif
+    ADC_[index].channel = channel;
+    ADC_[index].sample_time = (uint8_t)sample_time;
+}
+
+//convert one channel
+static uint16_t adc_single_convert(uint32_t adc_periph, uint8_t index, uint8_t channel,
+                                   uint32_t sample_time)
+{
+    uint16_t value;
+
+    adc_async_finish(adc_periph, index);
+    adc_single_select(adc_periph, index, channel, sample_time);
+#if defined(GD32F30x) || defined(GD32E50X)
+    adc_software_trigger_enable(adc_periph, ADC_REGULAR_CHANNEL);
+    while (!adc_flag_get(adc_periph, ADC_FLAG_EOC));
+    adc_flag_clear(adc_periph, ADC_FLAG_EOC);
+    value = adc_regular_data_read(adc_periph);
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+    adc_software_trigger_enable(ADC_REGULAR_CHANNEL);
+    while (!adc_flag_get(ADC_FLAG_EOC));
+    adc_flag_clear(ADC_FLAG_EOC);
+    value = adc_regular_data_read();
+#endif
+    return value;
+}
+
+//get adc value
+uint16_t get_adc_value(PinName pinname)
+{
+    uint32_t adc_periph = pinmap_peripheral(pinname, PinMap_ADC);
+    uint8_t index = get_adc_index(adc_periph);
+    uint8_t channel = get_adc_channel(pinname);
+    /* the converter belongs to a running scan or watchdog, see adc_scan_start() */
+    if (ADC_OWNED(index)) {
+        return 0;
+    }
+    if (!ADC_[index].isactive) {
+        pinmap_pinout(pinname, PinMap_ADC);
+        adc_single_init(adc_periph, index);
+    }
+    return adc_single_convert(adc_periph, index, channel, ADC_SAMPLETIME_DEFAULT);
+}
+
+//get the adc descriptor of a digital pin, the adc and channel of the pin are looked up only once
+static uint8_t get_adc_pin_desc(pin_size_t ulPin, uint32_t *slot)
+{
+    uint8_t desc;
+    PinName pinname;
+
+    *slot = ulPin;
+#ifdef ANALOG_PINS_LAST
+    if ((ulPin >= ANALOG_PINS_START) && (ulPin <= ANALOG_PINS_LAST)) {
+        *slot = analog_pins[ulPin - ANALOG_PINS_START];
+    }
+#endif
+    if (*slot >= DIGITAL_PINS_NUM) {
+        return ADC_PIN_DESC_NONE;
+    }
+    desc = adc_pin_desc[*slot];
+    if (desc == ADC_PIN_DESC_UNKNOWN) {
+        pinname = digital_pins[*slot];
+        if (!pin_in_pinmap(pinname, PinMap_ADC)) {
+            desc = ADC_PIN_DESC_NONE;
+        } else {
+            desc = ADC_PIN_DESC(get_adc_index(pinmap_peripheral(pinname, PinMap_ADC)),
+                                get_adc_channel(pinname));
+        }
+        adc_pin_desc[*slot] = desc;
+    }
+    return desc;
+}
+
+//get the sample time of the digital pin in slot
+#define ADC_PIN_SAMPLE_TIME(slot)   ((adc_pin_sample_time[slot] != 0U) ? adc_pin_sample_time[slot] - 1U : \
+                                     ADC_SAMPLETIME_DEFAULT)
+
+//get adc value of a digital pin
+uint16_t get_adc_pin_value(pin_size_t ulPin)
+{
+    uint32_t slot;
+    uint8_t desc = get_adc_pin_desc(ulPin, &slot);
+    uint8_t index;
+
+    if (desc == ADC_PIN_DESC_NONE) {
+        return 0;
+    }
+    index = ADC_PIN_DESC_INDEX(desc);
+    if (ADC_OWNED(index)) {
+        return 0;
+    }
+    if (!ADC_[index].isactive) {
+        adc_single_init(adc_periphs[index], index);
+    }
+    return adc_single_convert(adc_periphs[index], index, ADC_PIN_DESC_CHANNEL(desc),
+                              ADC_PIN_SAMPLE_TIME(slot));
+}
+
+//get the DMA channel serving the regular data of an adc, NULL if it has none
+static const dma_channel_t *get_adc_dma(uint32_t adc_periph)
+{
+#if defined(GD32F30x) || defined(GD32E50X)
+    static const dma_channel_t adc0_dma = {DMA0, DMA_CH0};
+#if ADC_NUMS > 2
+    static const dma_channel_t adc2_dma = {DMA1, DMA_CH4};
+
+    if (adc_periph == ADC2) {
+        return &adc2_dma;
+    }
+#endif
+    if (adc_periph == ADC0) {
+        return &adc0_dma;
+    }
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+    static const dma_channel_t adc_dma = {0U, DMA_CH0};
+
+    if (adc_periph == ADC) {
+        return &adc_dma;
+    }
+#endif
+    return NULL;
+}
+
+#define ADC_TRIGGER_TRGO  0xFFU
+
+typedef struct {
+    uint32_t adc_periph;
+    uint32_t timer;
+    uint8_t channel;            /* TIMER_CH_x of the compare event, ADC_TRIGGER_TRGO for TRGO */
+    uint32_t trigger;           /* external trigger source of the regular group */
+} adc_timer_trigger_t;
+
+//get the regular group trigger of an adc driven by a timer, NULL if the timer cannot trigger it
+static const adc_timer_trigger_t *get_adc_timer_trigger(uint32_t adc_periph, uint32_t timer)
+{
+    static const adc_timer_trigger_t triggers[] = {
+#if defined(GD32F30x) || defined(GD32E50X)
+        /* T7_TRGO of ADC0 needs the ADC0_ETRGRT remap and is left out */
+        {ADC0, TIMER2, ADC_TRIGGER_TRGO, ADC0_1_EXTTRIG_REGULAR_T2_TRGO},
+        {ADC0, TIMER0, TIMER_CH_0, ADC0_1_EXTTRIG_REGULAR_T0_CH0},
+        {ADC0, TIMER1, TIMER_CH_1, ADC0_1_EXTTRIG_REGULAR_T1_CH1},
+        {ADC0, TIMER3, TIMER_CH_3, ADC0_1_EXTTRIG_REGULAR_T3_CH3},
+#if ADC_NUMS > 2
+        {ADC2, TIMER7, ADC_TRIGGER_TRGO, ADC2_EXTTRIG_REGULAR_T7_TRGO},
+        {ADC2, TIMER0, TIMER_CH_2, ADC2_EXTTRIG_REGULAR_T0_CH2},
+        {ADC2, TIMER1, TIMER_CH_2, ADC2_EXTTRIG_REGULAR_T1_CH2},
+        {ADC2, TIMER2, TIMER_CH_0, ADC2_EXTTRIG_REGULAR_T2_CH0},
+        {ADC2, TIMER4, TIMER_CH_0, ADC2_EXTTRIG_REGULAR_T4_CH0},
+#endif
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+        {ADC, TIMER2, ADC_TRIGGER_TRGO, ADC_EXTTRIG_REGULAR_T2_TRGO},
+        {ADC, TIMER0, TIMER_CH_0, ADC_EXTTRIG_REGULAR_T0_CH0},
+#if defined(ADC_EXTTRIG_REGULAR_T1_CH1)
+        {ADC, TIMER1, TIMER_CH_1, ADC_EXTTRIG_REGULAR_T1_CH1},
+#endif
+        {ADC, TIMER14, TIMER_CH_0, ADC_EXTTRIG_REGULAR_T14_CH0},
+#endif
+    };
+    uint32_t i;
+
+    for (i = 0U; i < sizeof(triggers) / sizeof(triggers[0]); i++) {
+        if ((triggers[i].adc_periph == adc_periph) && (triggers[i].timer == timer)) {
+            return &triggers[i];
+        }
+    }
+    return NULL;
+}
+
+//start the circular DMA transfer of the regular data register of an adc into buffer
+//word moves both halves of the register, which hold ADC0 and ADC1 results in dual mode
+static void adc_dma_ring_start(const dma_channel_t *ch, uint32_t adc_periph, void *buffer, size_t length,
+                               bool word, dma_callback_t callback, void *arg)
+{
+    dma_parameter_struct dma_init_struct;
+
+    dma_channel_clock_enable(ch);
+    dma_deinit(DMA_SPL_ARGS(ch));
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.direction    = DMA_PERIPHERAL_TO_MEMORY;
+    dma_init_struct.memory_addr  = (uint32_t)buffer;
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = word ? DMA_MEMORY_WIDTH_32BIT : DMA_MEMORY_WIDTH_16BIT;
+    dma_init_struct.number       = length;
+    dma_init_struct.periph_addr  = ADC_RDATA_ADDR(adc_periph);
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = word ? DMA_PERIPHERAL_WIDTH_32BIT : DMA_PERIPHERAL_WIDTH_16BIT;
+    dma_init_struct.priority     = DMA_PRIORITY_HIGH;
+    dma_init(DMA_SPL_ARGS(ch), &dma_init_struct);
+    dma_circulation_enable(DMA_SPL_ARGS(ch));
+    dma_memory_to_memory_disable(DMA_SPL_ARGS(ch));
+    if (callback != NULL) {
+        dma_channel_attach_irq(ch, callback, arg, IRQ_LEVEL(IRQ_PRIO_ADC));
+        dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_HTF);
+        dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_FTF);
+    }
+    dma_channel_enable(DMA_SPL_ARGS(ch));
+}
+
+//stop the DMA transfer started by adc_dma_ring_start() and give the channel back to the claim of owner
+static void adc_dma_ring_stop(const dma_channel_t *ch, const void *owner)
+{
+    dma_channel_disable(DMA_SPL_ARGS(ch));
+    dma_interrupt_disable(DMA_SPL_ARGS(ch), DMA_INT_HTF);
+    dma_interrupt_disable(DMA_SPL_ARGS(ch), DMA_INT_FTF);
+    dma_channel_detach_irq(ch);
+    dma_channel_release(ch, owner);
+}
+
+//convert a regular sequence of pins into a ring buffer by DMA, all pins must belong to the same adc
+//timer 0 converts back to back, otherwise one sequence is converted per period of that timer
+//callback gets DMA_CALLBACK_FLAG_HTF/FTF as each half fills
+uint8_t adc_scan_start(const PinName *pins, uint8_t count, uint16_t *buffer, size_t length,
+                       uint32_t sample_time, uint32_t timer, dma_callback_t callback, void *arg)
+{
+    const adc_timer_trigger_t *trigger = NULL;
+    const dma_channel_t *ch;
+    uint32_t adc_periph;
+    uint8_t index;
+    uint8_t i;
+
+    if ((pins == NULL) || (count == 0U) || (count > ADC_SCAN_MAX_CHANNELS) || (buffer == NULL)
+            || (length == 0U)) {
+        return 0;
+    }
+    adc_periph = pinmap_peripheral(pins[0], PinMap_ADC);
+    ch = get_adc_dma(adc_periph);
+    if (ch == NULL) {
+        return 0;
+    }
+    for (i = 1U; i < count; i++) {
+        if (pinmap_peripheral(pins[i], PinMap_ADC) != adc_periph) {
+            return 0;
+        }
+    }
+    if (timer != 0U) {
+        trigger = get_adc_timer_trigger(adc_periph, timer);
+        if (trigger == NULL) {
+            return 0;
+        }
+    }
+    index = get_adc_index(adc_periph);
+    if (ADC_[index].isinserted || ADC_DUAL_OWNS(index)
+            || (ADC_[index].iswatching == ADC_WATCH_CONVERTING)) {
+        return 0;
+    }
+    adc_scan_stop(adc_periph);
+    if (!dma_channel_claim(ch, &ADC_[index])) {
+        return 0;
+    }
+    for (i = 0U; i < count; i++) {
+        pinmap_pinout(pins[i], PinMap_ADC);
+    }
+    adc_clock_enable(adc_periph);
+
+    adc_dma_ring_start(ch, adc_periph, buffer, length, false, callback, arg);
+
+    if (trigger != NULL) {
+        if (trigger->channel == ADC_TRIGGER_TRGO) {
+            Timer_setMasterMode(timer, TRGO_UPDATE, 0);
+        } else {
+            Timer_setCompareTrigger(timer, trigger->channel);
+        }
+    }
+    adc_apply_config(adc_periph);
+#if defined(GD32F30x) || defined(GD32E50X)
+    if (!ADC_DUAL_OWNS(0U)) {
+        adc_mode_config(ADC_MODE_FREE);
+    }
+    adc_special_function_config(adc_periph, ADC_SCAN_MODE, ENABLE);
+    adc_special_function_config(adc_periph, ADC_CONTINUOUS_MODE, (trigger == NULL) ? ENABLE : DISABLE);
+    adc_data_alignment_config(adc_periph, ADC_DATAALIGN_RIGHT);
+    adc_channel_length_config(adc_periph, ADC_REGULAR_CHANNEL, count);
+    for (i = 0U; i < count; i++) {
+        adc_regular_channel_config(adc_periph, i, get_adc_channel(pins[i]), sample_time);
+    }
+    adc_external_trigger_source_config(adc_periph, ADC_REGULAR_CHANNEL,
+                                       (trigger == NULL) ? ADC0_1_2_EXTTRIG_REGULAR_NONE : trigger->trigger);
+    adc_external_trigger_config(adc_periph, ADC_REGULAR_CHANNEL, ENABLE);
+    adc_enable(adc_periph);
+    delay(1U);
+    adc_calibration_enable(adc_periph);
+    adc_dma_mode_enable(adc_periph);
+    if (trigger == NULL) {
+        adc_software_trigger_enable(adc_periph, ADC_REGULAR_CHANNEL);
+    }
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+    adc_special_function_config(ADC_SCAN_MODE, ENABLE);
+    adc_special_function_config(ADC_CONTINUOUS_MODE, (trigger == NULL) ? ENABLE : DISABLE);
+    adc_data_alignment_config(ADC_DATAALIGN_RIGHT);
+    adc_channel_length_config(ADC_REGULAR_CHANNEL, count);
+    for (i = 0U; i < count; i++) {
+        adc_regular_channel_config(i, get_adc_channel(pins[i]), sample_time);
+    }
+    adc_external_trigger_source_config(ADC_REGULAR_CHANNEL,
+                                       (trigger == NULL) ? ADC_EXTTRIG_REGULAR_NONE : trigger->trigger);
+    adc_external_trigger_config(ADC_REGULAR_CHANNEL, ENABLE);
+    adc_enable();
+    delay(1U);
+    adc_calibration_enable();
+    adc_dma_mode_enable();
+    if (trigger == NULL) {
+        adc_software_trigger_enable(ADC_REGULAR_CHANNEL);
+    }
+#endif
+    /* analogRead() has to set the converter up again once the scan is stopped */
+    ADC_[index].isactive = false;
+    ADC_[index].isscanning = true;
+    return 1;
+}
+
+//stop a scan started by adc_scan_start()
+void adc_scan_stop(uint32_t adc_periph)
+{
+    const dma_channel_t *ch = get_adc_dma(adc_periph);
+    uint8_t index;
+
+    if (ch == NULL) {
+        return;
+    }
+    index = get_adc_index(adc_periph);
+    if (!ADC_[index].isscanning || ADC_DUAL_OWNS(index)) {
+        return;
+    }
+#if defined(GD32F30x) || defined(GD32E50X)
+    adc_disable(adc_periph);
+    adc_dma_mode_disable(adc_periph);
+    adc_special_function_config(adc_periph, ADC_SCAN_MODE, DISABLE);
+    adc_special_function_config(adc_periph, ADC_CONTINUOUS_MODE, DISABLE);
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+    adc_disable();
+    adc_dma_mode_disable();
+    adc_special_function_config(ADC_SCAN_MODE, DISABLE);
+#endif
+    adc_dma_ring_stop(ch, &ADC_[index]);
+    ADC_[index].isscanning = false;
+    adc_gate_idle(adc_periph, index);
+}
+
+#if defined(ADC_HAS_DUAL_MODE)
+//set up the regular sequence of one adc of the dual pair
+static void adc_dual_sequence_config(uint32_t adc_periph, const PinName *pins, uint8_t count,
+                                     uint32_t sample_time, uint32_t trigger, bool continuous)
+{
+    uint8_t i;
+
+    adc_clock_enable(adc_periph);
+    adc_apply_config(adc_periph);
+    adc_special_function_config(adc_periph, ADC_SCAN_MODE, ENABLE);
+    adc_special_function_config(adc_periph, ADC_CONTINUOUS_MODE, continuous ? ENABLE : DISABLE);
+    adc_data_alignment_config(adc_periph, ADC_DATAALIGN_RIGHT);
+    adc_channel_length_config(adc_periph, ADC_REGULAR_CHANNEL, count);
+    for (i = 0U; i < count; i++) {
+        adc_regular_channel_config(adc_periph, i, get_adc_channel(pins[i]), sample_time);
+    }
+    adc_external_trigger_source_config(adc_periph, ADC_REGULAR_CHANNEL, trigger);
+    adc_external_trigger_config(adc_periph, ADC_REGULAR_CHANNEL, ENABLE);
+}
+#endif
+
+//convert two regular sequences on ADC0 and ADC1 together into a ring buffer by DMA
+//each buffer word holds the ADC0 result in bits 0..15 and the ADC1 result in bits 16..31
+//ADC_DUAL_SIMULTANEOUS samples pins0[i] and pins1[i] at the same instant, ADC_DUAL_INTERLEAVED starts
+//ADC1 half way through ADC0 so both sample pins0 alternately at twice the rate, pins1 is ignored
+//the pins have to be on channels shared by ADC0 and ADC1, timer 0 converts back to back
+uint8_t adc_dual_start(uint8_t mode, const PinName *pins0, const PinName *pins1, uint8_t count,
+                       uint32_t *buffer, size_t length, uint32_t sample_time, uint32_t timer,
+                       dma_callback_t callback, void *arg)
+{
+#if defined(ADC_HAS_DUAL_MODE)
+    const adc_timer_trigger_t *trigger = NULL;
+    const dma_channel_t *ch = get_adc_dma(ADC0);
+    uint32_t periph;
+    uint8_t i;
+
+    if (mode == ADC_DUAL_INTERLEAVED) {
+        /* both adcs convert the same single channel */
+        pins1 = pins0;
+        count = 1U;
+    }
+    if ((pins0 == NULL) || (pins1 == NULL) || (count == 0U) || (count > ADC_SCAN_MAX_CHANNELS)
+            || (buffer == NULL) || (length == 0U) || (mode > ADC_DUAL_INTERLEAVED)) {
+        return 0;
+    }
+    for (i = 0U; i < count; i++) {
+        periph = pinmap_peripheral(pins0[i], PinMap_ADC);
+        if ((periph != ADC0) && (periph != ADC1)) {
+            return 0;
+        }
+        periph = pinmap_peripheral(pins1[i], PinMap_ADC);
+        if ((periph != ADC0) && (periph != ADC1)) {
+            return 0;
+        }
+    }
+    if (timer != 0U) {
+        trigger = get_adc_timer_trigger(ADC0, timer);
+        if (trigger == NULL) {
+            return 0;
+        }
+    }
+    if (ADC_[0].isinserted || ADC_[1].isinserted || (ADC_[0].iswatching == ADC_WATCH_CONVERTING)
+            || (ADC_[1].iswatching == ADC_WATCH_CONVERTING)) {
+        return 0;
+    }
+    adc_dual_stop();
+    adc_scan_stop(ADC0);
+    /* ADC0 is the master, its channel moves the results of both */
+    if (!dma_channel_claim(ch, &ADC_[0])) {
+        return 0;
+    }
+    for (i = 0U; i < count; i++) {
+        pinmap_pinout(pins0[i], PinMap_ADC);
+        pinmap_pinout(pins1[i], PinMap_ADC);
+    }
+    ADC_[0].isactive = false;
+    ADC_[1].isactive = false;
+    adc_disable(ADC0);
+    adc_disable(ADC1);
+
+    adc_dma_ring_start(ch, ADC0, buffer, length, true, callback, arg);
+    if (trigger != NULL) {
+        if (trigger->channel == ADC_TRIGGER_TRGO) {
+            Timer_setMasterMode(timer, TRGO_UPDATE, 0);
+        } else {
+            Timer_setCompareTrigger(timer, trigger->channel);
         }
-#if (defined(GD32F1x0) && defined(GD32F170_190)) || defined(GD32F30x) || defined(GD32E50X)
-        dac_trigger_disable(dac_periph);
-#if defined(GD32F30x) || defined(GD32E50X)
-        dac_wave_mode_config(dac_periph, DAC_WAVE_DISABLE);
-#endif
-        dac_output_buffer_enable(dac_periph);
-        dac_enable(dac_periph);
-        dac_data_set(dac_periph, DAC_ALIGN_12B_R, value);
-#elif defined(GD32F1x0) && !defined(GD32F170_190)
-        dac0_trigger_disable();
-        dac0_output_buffer_enable();
-        dac0_enable();
-        dac0_data_set(DAC_ALIGN_12B_R, value);
-#elif defined(GD32F3x0)
-        /* only has 1 DAC at maximum, no need for a parameter... */
-        dac_trigger_disable();
-        dac_wave_mode_config(DAC_WAVE_DISABLE);
-        dac_output_buffer_enable();
-        dac_enable();
-        dac_data_set(DAC_ALIGN_12B_R, value);
+    }
+
+    adc_mode_config((mode == ADC_DUAL_INTERLEAVED) ? ADC_DAUL_REGULAL_FOLLOWUP_FAST : ADC_DAUL_REGULAL_PARALLEL);
+    /* ADC0 is the master, ADC1 starts with it and must not be triggered on its own */
+    adc_dual_sequence_config(ADC0, pins0, count, sample_time,
+                             (trigger == NULL) ? ADC0_1_2_EXTTRIG_REGULAR_NONE : trigger->trigger,
+                             (trigger == NULL));
+    adc_dual_sequence_config(ADC1, pins1, count, sample_time, ADC0_1_2_EXTTRIG_REGULAR_NONE,
+                             (trigger == NULL));
+    adc_enable(ADC0);
+    adc_enable(ADC1);
+    delay(1U);
+    adc_calibration_enable(ADC0);
+    adc_calibration_enable(ADC1);
+    adc_dma_mode_enable(ADC0);
+    ADC_[0].isscanning = true;
+    ADC_[1].isscanning = true;
+    adc_dual_running = 1U;
+    if (trigger == NULL) {
+        adc_software_trigger_enable(ADC0, ADC_REGULAR_CHANNEL);
+    }
+    return 1;
+#else
+    (void)mode;
+    (void)pins0;
+    (void)pins1;
+    (void)count;
+    (void)buffer;
+    (void)length;
+    (void)sample_time;
+    (void)timer;
+    (void)callback;
+    (void)arg;
+    return 0;
 #endif
-        DAC_[index].isactive = true;
-    } else {
-        //set dac value
-#if defined(GD32F30x) || (defined(GD32F1x0) && defined(GD32F170_190)) || defined(GD32E50X)
-        dac_data_set(dac_periph, DAC_ALIGN_12B_R, value);
-#elif defined(GD32F10x) && !defined(GD32F170_190)
-        dac0_data_set(DAC_ALIGN_12B_R, value);
-#elif defined(GD32F3x0)
-        dac_data_set(DAC_ALIGN_12B_R, value);
+}
+
+//stop the conversions started by adc_dual_start(), ADC0 and ADC1 work independently again
+void adc_dual_stop(void)
+{
+#if defined(ADC_HAS_DUAL_MODE)
+    if (!adc_dual_running) {
+        return;
+    }
+    adc_disable(ADC0);
+    adc_disable(ADC1);
+    adc_dma_mode_disable(ADC0);
+    adc_special_function_config(ADC0, ADC_SCAN_MODE, DISABLE);
+    adc_special_function_config(ADC0, ADC_CONTINUOUS_MODE, DISABLE);
+    adc_special_function_config(ADC1, ADC_SCAN_MODE, DISABLE);
+    adc_special_function_config(ADC1, ADC_CONTINUOUS_MODE, DISABLE);
+    adc_mode_config(ADC_MODE_FREE);
+    adc_dma_ring_stop(get_adc_dma(ADC0), &ADC_[0]);
+    adc_dual_running = 0U;
+    ADC_[0].isscanning = false;
+    ADC_[1].isscanning = false;
+    adc_gate_idle(ADC0, 0U);
+    adc_gate_idle(ADC1, 1U);
 #endif
+}
+
+//get the number of words left until the dual mode DMA wraps to the start of the buffer
+uint32_t adc_dual_remaining(void)
+{
+#if defined(ADC_HAS_DUAL_MODE)
+    if (!adc_dual_running) {
+        return 0;
     }
+    return dma_transfer_number_get(DMA_SPL_ARGS(get_adc_dma(ADC0)));
+#else
+    return 0;
 #endif
 }
 
-//pwm set value
-void set_pwm_value(pin_size_t ulPin, uint32_t value)
+//get the number of results left until the scan DMA wraps to the start of the buffer
+uint32_t adc_scan_remaining(uint32_t adc_periph)
 {
-    uint16_t ulvalue = 1000 * value / 65535;
-    PWM pwm(ulPin);
-    pwm.setPeriodCycle(1000, ulvalue, FORMAT_US);
-    pwm.start();
+    const dma_channel_t *ch = get_adc_dma(adc_periph);
+
+    if ((ch == NULL) || !ADC_[get_adc_index(adc_periph)].isscanning) {
+        return 0;
+    }
+    return dma_transfer_number_get(DMA_SPL_ARGS(ch));
 }
 
-//pwm set value
-void set_pwm_value_with_base_period(pin_size_t ulPin, uint32_t base_period_us, uint32_t value)
+typedef struct {
+    uint32_t adc_periph;
+    uint32_t timer;
+    uint8_t channel;            /* TIMER_CH_x of the compare event, ADC_TRIGGER_TRGO for TRGO */
+    uint32_t trigger;           /* external trigger source of the inserted group */
+} adc_inserted_trigger_t;
+
+typedef struct {
+    adc_inserted_callback_t callback;
+    void *arg;
+    uint8_t count;
+} adc_inserted_infor_t;
+
+static adc_inserted_infor_t adc_inserted_infor[ADC_NUMS];
+
+//get the inserted group trigger of an adc driven by a timer, NULL if the timer cannot trigger it
+static const adc_inserted_trigger_t *get_adc_inserted_trigger(uint32_t adc_periph, uint32_t timer)
+{
+    static const adc_inserted_trigger_t triggers[] = {
+#if defined(GD32F30x) || defined(GD32E50X)
+        /* ADC1 shares the trigger sources of ADC0, T7_CH3 needs the ADC0_ETRGINS remap */
+        {ADC0, TIMER0, ADC_TRIGGER_TRGO, ADC0_1_EXTTRIG_INSERTED_T0_TRGO},
+        {ADC0, TIMER1, ADC_TRIGGER_TRGO, ADC0_1_EXTTRIG_INSERTED_T1_TRGO},
+        {ADC0, TIMER2, TIMER_CH_3, ADC0_1_EXTTRIG_INSERTED_T2_CH3},
+        {ADC0, TIMER3, ADC_TRIGGER_TRGO, ADC0_1_EXTTRIG_INSERTED_T3_TRGO},
+#if ADC_NUMS > 2
+        {ADC2, TIMER0, ADC_TRIGGER_TRGO, ADC2_EXTTRIG_INSERTED_T0_TRGO},
+        {ADC2, TIMER3, TIMER_CH_2, ADC2_EXTTRIG_INSERTED_T3_CH2},
+        {ADC2, TIMER4, ADC_TRIGGER_TRGO, ADC2_EXTTRIG_INSERTED_T4_TRGO},
+        {ADC2, TIMER7, TIMER_CH_3, ADC2_EXTTRIG_INSERTED_T7_CH3},
+#endif
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+        {ADC, TIMER0, ADC_TRIGGER_TRGO, ADC_EXTTRIG_INSERTED_T0_TRGO},
+#if defined(ADC_EXTTRIG_INSERTED_T1_TRGO)
+        {ADC, TIMER1, ADC_TRIGGER_TRGO, ADC_EXTTRIG_INSERTED_T1_TRGO},
+#endif
+        {ADC, TIMER2, TIMER_CH_3, ADC_EXTTRIG_INSERTED_T2_CH3},
+        {ADC, TIMER14, ADC_TRIGGER_TRGO, ADC_EXTTRIG_INSERTED_T14_TRGO},
+#endif
+    };
+    uint32_t i;
+
+#if (defined(GD32F30x) || defined(GD32E50X)) && (ADC_NUMS > 1)
+    if (adc_periph == ADC1) {
+        adc_periph = ADC0;
+    }
+#endif
+    for (i = 0U; i < sizeof(triggers) / sizeof(triggers[0]); i++) {
+        if ((triggers[i].adc_periph == adc_periph) && (triggers[i].timer == timer)) {
+            return &triggers[i];
+        }
+    }
+    return NULL;
+}
+
+//get the NVIC line of an adc
+static IRQn_Type get_adc_irq(uint32_t adc_periph)
 {
-    uint16_t ulvalue = base_period_us * value / 65535;
-    PWM pwm(ulPin);
-    pwm.setPeriodCycle(base_period_us, ulvalue, FORMAT_US);
-    pwm.start();
+#if defined(GD32F30x) || defined(GD32E50X)
+#if ADC_NUMS > 2
+    if (adc_periph == ADC2) {
+        return ADC2_IRQn;
+    }
+#endif
+    (void)adc_periph;
+    return ADC0_1_IRQn;
+#else
+    (void)adc_periph;
+    return ADC_CMP_IRQn;
+#endif
 }
 
-//pwm stop
-void stop_pwm(pin_size_t ulPin)
+//convert up to four pins as the inserted group on every TRGO or compare event of a timer
+//all pins must belong to the same adc, callback gets the results from the adc interrupt
+uint8_t adc_inserted_start(const PinName *pins, uint8_t count, uint32_t sample_time, uint32_t timer,
+                           adc_inserted_callback_t callback, void *arg)
 {
-    PWM pwm(ulPin);
-    pwm.stop();
+    const adc_inserted_trigger_t *trigger;
+    uint32_t adc_periph;
+    uint8_t index;
+    uint8_t i;
+
+    if ((pins == NULL) || (count == 0U) || (count > ADC_INSERTED_MAX_CHANNELS)) {
+        return 0;
+    }
+    adc_periph = pinmap_peripheral(pins[0], PinMap_ADC);
+    if ((uint32_t)NC == adc_periph) {
+        return 0;
+    }
+    for (i = 1U; i < count; i++) {
+        if (pinmap_peripheral(pins[i], PinMap_ADC) != adc_periph) {
+            return 0;
+        }
+    }
+    trigger = get_adc_inserted_trigger(adc_periph, timer);
+    if (trigger == NULL) {
+        return 0;
+    }
+    index = get_adc_index(adc_periph);
+    if (ADC_OWNED(index)) {
+        return 0;
+    }
+    adc_inserted_stop(adc_periph);
+    for (i = 0U; i < count; i++) {
+        pinmap_pinout(pins[i], PinMap_ADC);
+    }
+    if (!ADC_[index].isactive) {
+        adc_single_init(adc_periph, index);
+    }
+    if (trigger->channel == ADC_TRIGGER_TRGO) {
+        Timer_setMasterMode(timer, TRGO_UPDATE, 0);
+    } else {
+        Timer_setCompareTrigger(timer, trigger->channel);
+    }
+
+    adc_inserted_infor[index].callback = callback;
+    adc_inserted_infor[index].arg = arg;
+    adc_inserted_infor[index].count = count;
+#if defined(GD32F30x) || defined(GD32E50X)
+    adc_channel_length_config(adc_periph, ADC_INSERTED_CHANNEL, count);
+    for (i = 0U; i < count; i++) {
+        adc_inserted_channel_config(adc_periph, i, get_adc_channel(pins[i]), sample_time);
+    }
+    adc_external_trigger_source_config(adc_periph, ADC_INSERTED_CHANNEL, trigger->trigger);
+    adc_external_trigger_config(adc_periph, ADC_INSERTED_CHANNEL, ENABLE);
+    adc_interrupt_flag_clear(adc_periph, ADC_INT_FLAG_EOIC);
+    if (callback != NULL) {
+        adc_interrupt_enable(adc_periph, ADC_INT_EOIC);
+    }
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+    adc_channel_length_config(ADC_INSERTED_CHANNEL, count);
+    for (i = 0U; i < count; i++) {
+        adc_inserted_channel_config(i, get_adc_channel(pins[i]), sample_time);
+    }
+    adc_external_trigger_source_config(ADC_INSERTED_CHANNEL, trigger->trigger);
+    adc_external_trigger_config(ADC_INSERTED_CHANNEL, ENABLE);
+    adc_interrupt_flag_clear(ADC_INT_FLAG_EOIC);
+    if (callback != NULL) {
+        adc_interrupt_enable(ADC_INT_EOIC);
+    }
+#endif
+    if (callback != NULL) {
+        NVIC_ClearPendingIRQ(get_adc_irq(adc_periph));
+        irq_priority_enable(get_adc_irq(adc_periph), IRQ_PRIO_ADC);
+    }
+    ADC_[index].isinserted = true;
+    return 1;
 }
 
-//get adc value
-uint16_t get_adc_value(PinName pinname)
+//stop the inserted group started by adc_inserted_start(), the NVIC line is left alone since it is shared
+void adc_inserted_stop(uint32_t adc_periph)
 {
-    uint16_t value;
-    uint32_t adc_periph = pinmap_peripheral(pinname, PinMap_ADC);
     uint8_t index = get_adc_index(adc_periph);
-    uint8_t channel = get_adc_channel(pinname);
-    if (!ADC_[index].isactive) {
-        pinmap_pinout(pinname, PinMap_ADC);
-        adc_clock_enable(adc_periph);
 
-#if defined(GD32F30x)|| defined(GD32E50X)
-        rcu_adc_clock_config(RCU_CKADC_CKAPB2_DIV6);
-        adc_mode_config(ADC_MODE_FREE);
-        adc_resolution_config(adc_periph, ADC_RESOLUTION_12B);
-        adc_data_alignment_config(adc_periph, ADC_DATAALIGN_RIGHT);
-        adc_channel_length_config(adc_periph, ADC_REGULAR_CHANNEL, 1U);
+    if ((index >= ADC_NUMS) || !ADC_[index].isinserted) {
+        return;
+    }
+#if defined(GD32F30x) || defined(GD32E50X)
+    adc_interrupt_disable(adc_periph, ADC_INT_EOIC);
+    adc_external_trigger_config(adc_periph, ADC_INSERTED_CHANNEL, DISABLE);
 #elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
-        rcu_adc_clock_config(RCU_ADCCK_APB2_DIV6);
-        adc_special_function_config(ADC_CONTINUOUS_MODE, ENABLE);
-#if defined(GD32F3x0) || defined(GD32F170_190) || defined(GD32E23x)
-        adc_resolution_config(ADC_RESOLUTION_12B);
+    adc_interrupt_disable(ADC_INT_EOIC);
+    adc_external_trigger_config(ADC_INSERTED_CHANNEL, DISABLE);
 #endif
-        adc_data_alignment_config(ADC_DATAALIGN_RIGHT);
-        adc_channel_length_config(ADC_REGULAR_CHANNEL, 1U);
+    adc_inserted_infor[index].callback = NULL;
+    adc_inserted_infor[index].arg = NULL;
+    ADC_[index].isinserted = false;
+    adc_gate_idle(adc_periph, index);
+}
+
+//read the last result of one rank of the inserted group
+uint16_t adc_inserted_read(uint32_t adc_periph, uint8_t rank)
+{
+    if (rank >= ADC_INSERTED_MAX_CHANNELS) {
+        return 0;
+    }
+#if defined(GD32F30x) || defined(GD32E50X)
+    return adc_inserted_data_read(adc_periph, rank);
+#else
+    (void)adc_periph;
+    return adc_inserted_data_read(rank);
 #endif
+}
+
+//end of inserted group conversion, hand the results to the callback
+static void adc_inserted_irq(uint32_t adc_periph, uint8_t index)
+{
+    uint16_t values[ADC_INSERTED_MAX_CHANNELS];
+    uint8_t i;
+
 #if defined(GD32F30x) || defined(GD32E50X)
-        adc_external_trigger_source_config(adc_periph, ADC_REGULAR_CHANNEL, ADC0_1_2_EXTTRIG_REGULAR_NONE);
-#elif defined(GD32VF103) /* what?! Code for a RISC-V MCU here? */
-        adc_external_trigger_source_config(adc_periph, ADC_REGULAR_CHANNEL, ADC0_1_EXTTRIG_REGULAR_NONE);
-#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
-        adc_external_trigger_source_config(ADC_REGULAR_CHANNEL, ADC_EXTTRIG_REGULAR_NONE);
+    if (!adc_interrupt_flag_get(adc_periph, ADC_INT_FLAG_EOIC)) {
+        return;
+    }
+    adc_interrupt_flag_clear(adc_periph, ADC_INT_FLAG_EOIC);
+#else
+    if (!adc_interrupt_flag_get(ADC_INT_FLAG_EOIC)) {
+        return;
+    }
+    adc_interrupt_flag_clear(ADC_INT_FLAG_EOIC);
 #endif
+    if (adc_inserted_infor[index].callback == NULL) {
+        return;
+    }
+    for (i = 0U; i < adc_inserted_infor[index].count; i++) {
+        values[i] = adc_inserted_read(adc_periph, i);
+    }
+    adc_inserted_infor[index].callback(adc_inserted_infor[index].arg, values,
+                                       adc_inserted_infor[index].count);
+}
+
+//start converting a digital pin without waiting for the result, only one conversion can be pending
+//callback is called from the end of conversion interrupt, without one poll adc_async_ready()
+uint8_t adc_async_start(pin_size_t ulPin, adc_async_callback_t callback, void *arg)
+{
+    uint32_t slot;
+    uint8_t desc = get_adc_pin_desc(ulPin, &slot);
+    uint32_t adc_periph;
+    uint8_t index;
+
+    if ((desc == ADC_PIN_DESC_NONE) || (adc_async.state == ADC_ASYNC_BUSY)) {
+        return 0;
+    }
+    index = ADC_PIN_DESC_INDEX(desc);
+    adc_periph = adc_periphs[index];
+    if (ADC_OWNED(index)) {
+        return 0;
+    }
+    if (!ADC_[index].isactive) {
+        adc_single_init(adc_periph, index);
+    }
+    adc_single_select(adc_periph, index, ADC_PIN_DESC_CHANNEL(desc), ADC_PIN_SAMPLE_TIME(slot));
+    adc_async.index = index;
+    adc_async.callback = callback;
+    adc_async.arg = arg;
+    adc_async.state = ADC_ASYNC_BUSY;
 #if defined(GD32F30x) || defined(GD32E50X)
-        adc_external_trigger_config(adc_periph, ADC_REGULAR_CHANNEL, ENABLE);
-        adc_enable(adc_periph);
-        delay(1U);
-        adc_calibration_enable(adc_periph);
+    adc_flag_clear(adc_periph, ADC_FLAG_EOC);
+    if (callback != NULL) {
+        adc_interrupt_enable(adc_periph, ADC_INT_EOC);
+    }
 #elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
-        adc_external_trigger_config(ADC_REGULAR_CHANNEL, ENABLE);
-        adc_enable();
-        delay(1U);
-        adc_calibration_enable();
+    adc_flag_clear(ADC_FLAG_EOC);
+    if (callback != NULL) {
+        adc_interrupt_enable(ADC_INT_EOC);
+    }
 #endif
-        ADC_[index].isactive = true;
+    if (callback != NULL) {
+        irq_priority_enable(get_adc_irq(adc_periph), IRQ_PRIO_ADC);
     }
 #if defined(GD32F30x) || defined(GD32E50X)
-    adc_regular_channel_config(adc_periph, 0U, channel, ADC_SAMPLETIME_7POINT5);
     adc_software_trigger_enable(adc_periph, ADC_REGULAR_CHANNEL);
-    while (!adc_flag_get(adc_periph, ADC_FLAG_EOC));
-    adc_flag_clear(adc_periph, ADC_FLAG_EOC);
-    value = adc_regular_data_read(adc_periph);
 #elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
-    adc_regular_channel_config(0U, channel, ADC_SAMPLETIME_7POINT5);
     adc_software_trigger_enable(ADC_REGULAR_CHANNEL);
-    while (!adc_flag_get(ADC_FLAG_EOC));
-    adc_flag_clear(ADC_FLAG_EOC);
-    value = adc_regular_data_read();
 #endif
-    return value;
+    return 1;
+}
+
+//check if the conversion started by adc_async_start() has finished
+uint8_t adc_async_ready(void)
+{
+    uint32_t adc_periph;
+
+    if ((adc_async.state == ADC_ASYNC_BUSY) && (adc_async.callback == NULL)) {
+        adc_periph = adc_periphs[adc_async.index];
+#if defined(GD32F30x) || defined(GD32E50X)
+        if (adc_flag_get(adc_periph, ADC_FLAG_EOC)) {
+            adc_async_finish(adc_periph, adc_async.index);
+        }
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+        if (adc_flag_get(ADC_FLAG_EOC)) {
+            adc_async_finish(adc_periph, adc_async.index);
+        }
+#endif
+    }
+    return adc_async.state == ADC_ASYNC_DONE;
+}
+
+//get the result of the conversion started by adc_async_start(), waits for it if still running
+uint16_t adc_async_result(void)
+{
+    if (adc_async.state == ADC_ASYNC_IDLE) {
+        return 0;
+    }
+    adc_async_finish(adc_periphs[adc_async.index], adc_async.index);
+    adc_async.state = ADC_ASYNC_IDLE;
+    return adc_async.value;
+}
+
+//end of regular conversion of an adc, store the result of a pending adc_async_start()
+static void adc_async_irq(uint32_t adc_periph, uint8_t index)
+{
+    if ((adc_async.state != ADC_ASYNC_BUSY) || (adc_async.index != index)) {
+        return;
+    }
+#if defined(GD32F30x) || defined(GD32E50X)
+    if (!adc_interrupt_flag_get(adc_periph, ADC_INT_FLAG_EOC)) {
+        return;
+    }
+    adc_interrupt_disable(adc_periph, ADC_INT_EOC);
+    adc_interrupt_flag_clear(adc_periph, ADC_INT_FLAG_EOC);
+    adc_async.value = adc_regular_data_read(adc_periph);
+#else
+    (void)adc_periph;
+    if (!adc_interrupt_flag_get(ADC_INT_FLAG_EOC)) {
+        return;
+    }
+    adc_interrupt_disable(ADC_INT_EOC);
+    adc_interrupt_flag_clear(ADC_INT_FLAG_EOC);
+    adc_async.value = adc_regular_data_read();
+#endif
+    adc_async.state = ADC_ASYNC_DONE;
+    if (adc_async.callback != NULL) {
+        adc_async.callback(adc_async.arg, adc_async.value);
+    }
+    os_event_signal();
+}
+
+typedef struct {
+    adc_watchdog_callback_t callback;
+    void *arg;
+} adc_watchdog_infor_t;
+
+static adc_watchdog_infor_t adc_watchdog_infor[ADC_NUMS];
+
+//watch one channel of an adc against a window of 12-bit thresholds
+static void adc_watchdog_config(uint32_t adc_periph, uint8_t channel, uint16_t low, uint16_t high)
+{
+#if defined(GD32E50X)
+    adc_watchdog0_threshold_config(adc_periph, low, high);
+    adc_watchdog0_single_channel_enable(adc_periph, channel);
+    adc_interrupt_flag_clear(adc_periph, ADC_INT_FLAG_WDE0);
+    adc_interrupt_enable(adc_periph, ADC_INT_WDE0);
+#elif defined(GD32F30x)
+    adc_watchdog_threshold_config(adc_periph, low, high);
+    adc_watchdog_single_channel_enable(adc_periph, channel);
+    adc_interrupt_flag_clear(adc_periph, ADC_INT_FLAG_WDE);
+    adc_interrupt_enable(adc_periph, ADC_INT_WDE);
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+    (void)adc_periph;
+    adc_watchdog_threshold_config(low, high);
+    adc_watchdog_single_channel_enable(channel);
+    adc_interrupt_flag_clear(ADC_INT_FLAG_WDE);
+    adc_interrupt_enable(ADC_INT_WDE);
+#endif
+}
+
+//stop watching, the event interrupt is disabled as well
+static void adc_watchdog_unconfig(uint32_t adc_periph)
+{
+#if defined(GD32E50X)
+    adc_interrupt_disable(adc_periph, ADC_INT_WDE0);
+    adc_watchdog0_disable(adc_periph);
+#elif defined(GD32F30x)
+    adc_interrupt_disable(adc_periph, ADC_INT_WDE);
+    adc_watchdog_disable(adc_periph);
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+    (void)adc_periph;
+    adc_interrupt_disable(ADC_INT_WDE);
+    adc_watchdog_disable();
+#endif
+}
+
+//raise callback once the conversion result of a digital pin leaves the window low..high (12-bit)
+//a scan running on the adc is watched as it is, otherwise the adc keeps converting the pin by itself
+//and is not available to single conversions. callback runs once, start again to re-arm
+uint8_t adc_watchdog_start(pin_size_t ulPin, uint16_t low, uint16_t high,
+                           adc_watchdog_callback_t callback, void *arg)
+{
+    uint32_t slot;
+    uint8_t desc = get_adc_pin_desc(ulPin, &slot);
+    uint32_t adc_periph;
+    uint8_t channel;
+    uint8_t index;
+
+    if ((desc == ADC_PIN_DESC_NONE) || (low > high) || (high > 0x0FFFU)) {
+        return 0;
+    }
+    index = ADC_PIN_DESC_INDEX(desc);
+    channel = ADC_PIN_DESC_CHANNEL(desc);
+    adc_periph = adc_periphs[index];
+    if (ADC_[index].isinserted) {
+        return 0;
+    }
+    adc_watchdog_infor[index].callback = callback;
+    adc_watchdog_infor[index].arg = arg;
+    if (ADC_[index].isscanning) {
+        adc_watchdog_config(adc_periph, channel, low, high);
+        ADC_[index].iswatching = ADC_WATCH_SCAN;
+    } else {
+        adc_async_finish(adc_periph, index);
+        if (!ADC_[index].isactive) {
+            adc_single_init(adc_periph, index);
+        }
+        adc_single_select(adc_periph, index, channel, ADC_PIN_SAMPLE_TIME(slot));
+        adc_watchdog_config(adc_periph, channel, low, high);
+#if defined(GD32F30x) || defined(GD32E50X)
+        adc_special_function_config(adc_periph, ADC_CONTINUOUS_MODE, ENABLE);
+        adc_software_trigger_enable(adc_periph, ADC_REGULAR_CHANNEL);
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+        adc_special_function_config(ADC_CONTINUOUS_MODE, ENABLE);
+        adc_software_trigger_enable(ADC_REGULAR_CHANNEL);
+#endif
+        ADC_[index].iswatching = ADC_WATCH_CONVERTING;
+    }
+    irq_priority_enable(get_adc_irq(adc_periph), IRQ_PRIO_ADC);
+    return 1;
+}
+
+//stop the watchdog started by adc_watchdog_start() on the adc of a digital pin
+void adc_watchdog_stop(pin_size_t ulPin)
+{
+    uint32_t slot;
+    uint8_t desc = get_adc_pin_desc(ulPin, &slot);
+    uint32_t adc_periph;
+    uint8_t index;
+
+    if (desc == ADC_PIN_DESC_NONE) {
+        return;
+    }
+    index = ADC_PIN_DESC_INDEX(desc);
+    adc_periph = adc_periphs[index];
+    if (ADC_[index].iswatching == ADC_WATCH_NONE) {
+        return;
+    }
+    adc_watchdog_unconfig(adc_periph);
+    if (ADC_[index].iswatching == ADC_WATCH_CONVERTING) {
+        /* single conversions set the converter up again */
+#if defined(GD32F30x) || defined(GD32E50X)
+        adc_disable(adc_periph);
+        adc_special_function_config(adc_periph, ADC_CONTINUOUS_MODE, DISABLE);
+#else
+        adc_disable();
+#endif
+        ADC_[index].isactive = false;
+    }
+    adc_watchdog_infor[index].callback = NULL;
+    adc_watchdog_infor[index].arg = NULL;
+    ADC_[index].iswatching = ADC_WATCH_NONE;
+    adc_gate_idle(adc_periph, index);
+}
+
+//end single conversions on the adc of a pin, its clock is gated unless something else uses the adc
+void adc_single_stop(pin_size_t ulPin)
+{
+    uint32_t slot;
+    uint8_t desc = get_adc_pin_desc(ulPin, &slot);
+    uint32_t adc_periph;
+    uint8_t index;
+
+    if (desc == ADC_PIN_DESC_NONE) {
+        return;
+    }
+    index = ADC_PIN_DESC_INDEX(desc);
+    adc_periph = adc_periphs[index];
+    if (!ADC_[index].isactive || ADC_OWNED(index) || ADC_[index].isinserted) {
+        return;
+    }
+    adc_async_finish(adc_periph, index);
+    ADC_[index].isactive = false;
+    adc_gate_idle(adc_periph, index);
+}
+
+//watchdog event of an adc, disarm it so a channel staying outside the window does not flood the cpu
+static void adc_watchdog_irq(uint32_t adc_periph, uint8_t index)
+{
+#if defined(GD32E50X)
+    if (!adc_interrupt_flag_get(adc_periph, ADC_INT_FLAG_WDE0)) {
+        return;
+    }
+    adc_interrupt_disable(adc_periph, ADC_INT_WDE0);
+    adc_interrupt_flag_clear(adc_periph, ADC_INT_FLAG_WDE0);
+#elif defined(GD32F30x)
+    if (!adc_interrupt_flag_get(adc_periph, ADC_INT_FLAG_WDE)) {
+        return;
+    }
+    adc_interrupt_disable(adc_periph, ADC_INT_WDE);
+    adc_interrupt_flag_clear(adc_periph, ADC_INT_FLAG_WDE);
+#else
+    (void)adc_periph;
+    if (!adc_interrupt_flag_get(ADC_INT_FLAG_WDE)) {
+        return;
+    }
+    adc_interrupt_disable(ADC_INT_WDE);
+    adc_interrupt_flag_clear(ADC_INT_FLAG_WDE);
+#endif
+    if (adc_watchdog_infor[index].callback != NULL) {
+        adc_watchdog_infor[index].callback(adc_watchdog_infor[index].arg);
+    }
+}
+
+extern "C" {
+#if defined(GD32F30x) || defined(GD32E50X)
+    __attribute__((used)) void ADC0_1_IRQHandler(void)
+    {
+        IRQ_PROFILE();
+        adc_inserted_irq(ADC0, 0U);
+        adc_async_irq(ADC0, 0U);
+        adc_watchdog_irq(ADC0, 0U);
+#if ADC_NUMS > 1
+        adc_inserted_irq(ADC1, 1U);
+        adc_async_irq(ADC1, 1U);
+        adc_watchdog_irq(ADC1, 1U);
+#endif
+    }
+
+#if ADC_NUMS > 2
+    __attribute__((used)) void ADC2_IRQHandler(void)
+    {
+        IRQ_PROFILE();
+        adc_inserted_irq(ADC2, 2U);
+        adc_async_irq(ADC2, 2U);
+        adc_watchdog_irq(ADC2, 2U);
+    }
+#endif
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+    __attribute__((used)) void ADC_CMP_IRQHandler(void)
+    {
+        IRQ_PROFILE();
+        adc_inserted_irq(ADC, 0U);
+        adc_async_irq(ADC, 0U);
+        adc_watchdog_irq(ADC, 0U);
+        adc_shared_cmp_irq();
+    }
+
+    __attribute__((weak)) void adc_shared_cmp_irq(void)
+    {
+    }
+#endif
 }
 
 //get adc index value
@@ -374,31 +2170,55 @@ uint8_t get_adc_channel(PinName pinname)
     return gd_channel;
 }
 
-//adc clock enable
-void adc_clock_enable(uint32_t instance)
+//get the clock of an adc, false for an unknown instance
+static bool get_adc_rcu(uint32_t instance, rcu_periph_enum *rcu)
 {
-    rcu_periph_enum temp;
     switch (instance) {
 #if defined(GD32F30x) || defined(GD32E50X) //todo: other series
         case ADC0:
-            temp = RCU_ADC0;
-            break;
+            *rcu = RCU_ADC0;
+            return true;
         case ADC1:
-            temp = RCU_ADC1;
-            break;
+            *rcu = RCU_ADC1;
+            return true;
 #if (defined(GD32F30X_HD) || defined(GD32F30X_XD))
         case ADC2:
-            temp = RCU_ADC2;
-            break;
+            *rcu = RCU_ADC2;
+            return true;
 #endif
 #elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
         case ADC:
-            temp = RCU_ADC;
-            break;
+            *rcu = RCU_ADC;
+            return true;
 #endif
         default:
-            fatal("cannot enable ADC clock for unknown instance 0x%p", instance);
-            return;
+            return false;
+    }
+}
+
+//adc clock enable, an adc holds one reference while it is set up, adc_clock_disable() drops it
+void adc_clock_enable(uint32_t instance)
+{
+    rcu_periph_enum rcu;
+    uint32_t state;
+
+    if (!get_adc_rcu(instance, &rcu)) {
+        fatal("cannot enable ADC clock for unknown instance 0x%p", instance);
+        return;
+    }
+    state = critical_enter();
+    if (clock_periph_users(rcu) == 0U) {
+        clock_periph_acquire(rcu);
+    }
+    critical_exit(state);
+}
+
+//adc clock disable, the registers keep their values but the next user sets the adc up again
+void adc_clock_disable(uint32_t instance)
+{
+    rcu_periph_enum rcu;
+
+    if (get_adc_rcu(instance, &rcu)) {
+        clock_periph_release(rcu);
     }
-    rcu_periph_clock_enable(temp);
 }
@@ -33,6 +33,7 @@ OF SUCH DAMAGE.
 #define __ANALOG_H
 
 #include "gd32xxyy.h"
+#include "dma.h"
 
 #include "PinNames.h"
 #include "PeripheralPins.h"
@@ -42,11 +43,40 @@ OF SUCH DAMAGE.
 extern "C" {
 #endif
 
+/* length of the regular sequence, see adc_scan_start() */
+#define ADC_SCAN_MAX_CHANNELS   16
+/* waves generated by dac_stream_start() on top of the samples */
+#define DAC_STREAM_WAVE_NONE        0U
+#define DAC_STREAM_WAVE_NOISE       1U
+#define DAC_STREAM_WAVE_TRIANGLE    2U
+/* pack the DAC0 and DAC1 samples of a pair for dac_dual_stream_start() */
+#define DAC_DUAL_SAMPLE(value0, value1) ((((uint32_t)(value1) & 0xFFFU) << 16) | ((uint32_t)(value0) & 0xFFFU))
+/* modes of adc_dual_start() */
+#define ADC_DUAL_SIMULTANEOUS   0U
+#define ADC_DUAL_INTERLEAVED    1U
+/* split a word written by adc_dual_start() into the ADC0 and ADC1 results */
+#define ADC_DUAL_VALUE0(word)   ((uint16_t)((word) & 0xFFFFU))
+#define ADC_DUAL_VALUE1(word)   ((uint16_t)((word) >> 16))
+/* length of the inserted group, see adc_inserted_start() */
+#define ADC_INSERTED_MAX_CHANNELS   4
+
+/* value is the raw result of a conversion started by adc_async_start() */
+typedef void (*adc_async_callback_t)(void *arg, uint16_t value);
+/* a channel watched by adc_watchdog_start() left its window */
+typedef void (*adc_watchdog_callback_t)(void *arg);
+/* values holds the result of every rank of the inserted group */
+typedef void (*adc_inserted_callback_t)(void *arg, const uint16_t *values, uint8_t count);
+
 typedef struct {
     // uint32_t periph;
     // uint8_t channel;
     // uint8_t resolution;
     uint8_t isactive;
+    uint8_t isscanning;
+    uint8_t isinserted;
+    uint8_t iswatching;
+    uint8_t channel;            /* channel in rank 0 of the regular sequence */
+    uint8_t sample_time;        /* sample time of that channel */
     // uint32_t value;
 } analog_t;
 
@@ -54,12 +84,54 @@ uint8_t get_adc_channel(PinName pinname);
 uint8_t get_adc_index(uint32_t instance);
 uint8_t get_dac_index(uint32_t instance);
 void adc_clock_enable(uint32_t instance);
+void adc_clock_disable(uint32_t instance);
 
 void set_dac_value(PinName pinname, uint16_t value);
+uint8_t dac_stream_start(PinName pinname, const uint16_t *buffer, size_t length, uint16_t value,
+                         uint32_t timer, uint8_t wave, uint8_t wave_bits,
+                         dma_callback_t callback, void *arg);
+void dac_stream_stop(PinName pinname);
+uint32_t dac_stream_remaining(PinName pinname);
+void set_dac_dual_value(uint16_t value0, uint16_t value1);
+uint8_t dac_dual_stream_start(const uint32_t *buffer, size_t length, uint32_t timer,
+                              dma_callback_t callback, void *arg);
+void dac_dual_stream_stop(void);
+uint32_t dac_dual_stream_remaining(void);
 void set_pwm_value(pin_size_t ulPin, uint32_t value);
 void set_pwm_value_with_base_period(pin_size_t ulPin, uint32_t base_period_us, uint32_t value);
+void set_pwm_value_with_frequency(pin_size_t ulPin, uint32_t freq_hz, uint32_t value);
+void set_pwm_frequency(pin_size_t ulPin, uint32_t freq_hz);
 void stop_pwm(pin_size_t ulPin);
 uint16_t get_adc_value(PinName pinname);
+uint16_t get_adc_pin_value(pin_size_t ulPin);
+void set_adc_resolution(uint8_t bits);
+uint8_t get_adc_resolution(void);
+void set_adc_clock_prescaler(uint32_t prescaler);
+void set_adc_sample_time(pin_size_t ulPin, uint32_t sample_time);
+uint8_t set_adc_oversampling(uint8_t ratio_log2, uint8_t shift);
+uint8_t adc_scan_start(const PinName *pins, uint8_t count, uint16_t *buffer, size_t length,
+                       uint32_t sample_time, uint32_t timer, dma_callback_t callback, void *arg);
+void adc_scan_stop(uint32_t adc_periph);
+uint32_t adc_scan_remaining(uint32_t adc_periph);
+uint8_t adc_dual_start(uint8_t mode, const PinName *pins0, const PinName *pins1, uint8_t count,
+                       uint32_t *buffer, size_t length, uint32_t sample_time, uint32_t timer,
+                       dma_callback_t callback, void *arg);
+void adc_dual_stop(void);
+uint32_t adc_dual_remaining(void);
+uint8_t adc_inserted_start(const PinName *pins, uint8_t count, uint32_t sample_time, uint32_t timer,
+                           adc_inserted_callback_t callback, void *arg);
+void adc_inserted_stop(uint32_t adc_periph);
+uint16_t adc_inserted_read(uint32_t adc_periph, uint8_t rank);
+uint8_t adc_async_start(pin_size_t ulPin, adc_async_callback_t callback, void *arg);
+uint8_t adc_async_ready(void);
+uint16_t adc_async_result(void);
+uint8_t adc_watchdog_start(pin_size_t ulPin, uint16_t low, uint16_t high,
+                           adc_watchdog_callback_t callback, void *arg);
+void adc_watchdog_stop(pin_size_t ulPin);
+void adc_single_stop(pin_size_t ulPin);
+/* on parts where the comparators share the ADC interrupt, the handler calls this
+   after the ADC; does nothing by default, a comparator driver defines it */
+void adc_shared_cmp_irq(void);
 
 #ifdef __cplusplus
 }
@@ -112,11 +112,7 @@ uint8_t PluggableUSB_::epCount() {
 
 PluggableUSB_& PluggableUSB()
 {
-#ifdef USBD_USE_CDC
-  static PluggableUSB_ obj(2, 4);
-#else
-  static PluggableUSB_ obj(0, 1);
-#endif
+  static PluggableUSB_ obj(PLUGGABLE_USB_FIRST_INTERFACE, PLUGGABLE_USB_FIRST_ENDPOINT);
   return obj;
 }
 
@@ -18,6 +18,8 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
 #include <string.h>
 #include <math.h>
 
@@ -91,9 +93,7 @@ size_t Print::print(long n, int base)
     return write(n);
   } else if (base == 10) {
     if (n < 0) {
-      int t = print('-');
-      n = -n;
-      return printNumber(n, 10) + t;
+      return printNumber(0UL - (unsigned long)n, 10, true);
     }
     return printNumber(n, 10);
   } else {
@@ -113,9 +113,7 @@ size_t Print::print(long long n, int base)
     return write(n);
   } else if (base == 10) {
     if (n < 0) {
-      int t = print('-');
-      n = -n;
-      return printULLNumber(n, 10) + t;
+      return printULLNumber(0ULL - (unsigned long long)n, 10, true);
     }
     return printULLNumber(n, 10);
   } else {
@@ -235,147 +233,378 @@ size_t Print::println(const Printable& x)
   return n;
 }
 
-// Private Methods /////////////////////////////////////////////////////////////
-
-size_t Print::printNumber(unsigned long n, uint8_t base)
+size_t Print::printf(const char *format, ...)
 {
-  char buf[8 * sizeof(long) + 1]; // Assumes 8-bit chars plus zero byte.
-  char *str = &buf[sizeof(buf) - 1];
+  va_list ap;
+  va_start(ap, format);
+  size_t n = vprintf(format, ap);
+  va_end(ap);
+  return n;
+}
 
-  *str = '\0';
+// Private Methods /////////////////////////////////////////////////////////////
 
-  // prevent crash if called with base == 1
-  if (base < 2) base = 10;
+namespace {
 
-  do {
-    char c = n % base;
-    n /= base;
+// Digits of n in base, most significant first, ending just before end. n is cut into
+// 16-bit limbs and divided by the largest power of base below 2^16, so every step is a
+// 32-bit division: no 64-bit division helper is pulled in, even on cores without UMULL.
+char *formatNumber(char *end, unsigned long long n, uint8_t base, bool upper = true)
+{
+  uint16_t limb[4] = {(uint16_t)(n >> 48), (uint16_t)(n >> 32), (uint16_t)(n >> 16), (uint16_t)n};
+  uint8_t first = 0;
+  uint32_t chunk = base;
+  uint8_t chunkDigits = 1;
+  char *str = end;
+  char alpha = upper ? 'A' : 'a';
+
+  while (chunk * base <= 0xFFFF) {
+    chunk *= base;
+    chunkDigits++;
+  }
+  while (first < 3 && limb[first] == 0) {
+    first++;
+  }
+  for (;;) {
+    uint32_t rem = 0;
+    bool high = false;
+    uint8_t d = 0;
+
+    for (uint8_t i = first; i < 4; i++) {
+      uint32_t cur = (rem << 16) | limb[i];
+      limb[i] = cur / chunk;
+      rem = cur - limb[i] * chunk;
+      high |= (limb[i] != 0);
+    }
+    // a chunk below the most significant one keeps its leading zeros
+    do {
+      uint32_t q = rem / base;
+      char c = rem - q * base;
+      rem = q;
+      *--str = c < 10 ? c + '0' : c + alpha - 10;
+      d++;
+    } while (high ? d < chunkDigits : rem != 0);
+    if (!high) {
+      return str;
+    }
+    while (limb[first] == 0) {
+      first++;
+    }
+  }
+}
 
-    *--str = c < 10 ? c + '0' : c + 'A' - 10;
-  } while(n);
+// Fraction digits beyond this many are beyond the precision of a double, they print as 0
+#define PRINT_FLOAT_DIGITS 20
 
-  return write(str);
-}
+const uint32_t powersOf10[10] = {
+  1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
 
-// REFERENCE IMPLEMENTATION FOR ULL
-// size_t Print::printULLNumber(unsigned long long n, uint8_t base)
-// {
-  // // if limited to base 10 and 16 the bufsize can be smaller
-  // char buf[65];
-  // char *str = &buf[64];
+// "[-]int[.frac]" for a finite number of magnitude up to 4294967040, digits <= PRINT_FLOAT_DIGITS,
+// at the start of buf (at least 13 + digits). The fraction comes in groups of up to 9 digits,
+// one multiplication each, instead of one digit per multiplication.
+size_t formatFloat(char *buf, double number, uint8_t digits)
+{
+  char *str = buf;
+  char intBuf[10];
+  char *intEnd = intBuf + sizeof(intBuf);
 
-  // *str = '\0';
+  if (number < 0.0) {
+    *str++ = '-';
+    number = -number;
+  }
 
-  // // prevent crash if called with base == 1
-  // if (base < 2) base = 10;
+  // Round correctly so that print(1.999, 2) prints as "2.00"
+  double rounding = 0.5;
+  for (uint8_t i = 0; i < digits; ++i)
+    rounding /= 10.0;
+  number += rounding;
 
-    // do {
-      // unsigned long long t = n / base;
-      // char c = n - t * base;  // faster than c = n%base;
-      // n = t;
-      // *--str = c < 10 ? c + '0' : c + 'A' - 10;
-  // } while(n);
+  unsigned long int_part = (unsigned long)number;
+  double remainder = number - (double)int_part;
+  char *intStr = formatNumber(intEnd, int_part, 10);
+  memcpy(str, intStr, intEnd - intStr);
+  str += intEnd - intStr;
 
-  // return write(str);
-// }
+  if (digits > 0) {
+    *str++ = '.';
+  }
+  while (digits > 0) {
+    uint8_t group = digits > 9 ? 9 : digits;
+    remainder *= powersOf10[group];
+    uint32_t part = (uint32_t)remainder;
+    remainder -= part;
+    for (uint8_t i = group; i > 0; i--) {
+      uint32_t q = part / 10;
+      str[i - 1] = '0' + (part - q * 10);
+      part = q;
+    }
+    str += group;
+    digits -= group;
+  }
+  return str - buf;
+}
 
-// FAST IMPLEMENTATION FOR ULL
-size_t Print::printULLNumber(unsigned long long n64, uint8_t base)
+// Output of vprintf(), handed to write(buffer, size) a small chunk at a time
+class PrintfSink {
+  public:
+    PrintfSink(Print &out) : out(out), len(0), total(0) {}
+    void put(char c) {
+      if (len == sizeof(buf)) flush();
+      buf[len++] = c;
+    }
+    void put(const char *s, size_t n) {
+      while (n--) put(*s++);
+    }
+    void pad(char c, int n) {
+      while (n-- > 0) put(c);
+    }
+    size_t finish() {
+      flush();
+      return total;
+    }
+  private:
+    void flush() {
+      if (len) total += out.write((const uint8_t *)buf, len);
+      len = 0;
+    }
+    Print &out;
+    char buf[32];
+    size_t len;
+    size_t total;
+};
+
+// One field: prefix (sign, 0x), then zeros up to precision, then body, padded to width
+void printfField(PrintfSink &sink, const char *prefix, size_t prefixLen, const char *body,
+                 size_t bodyLen, int zeros, int width, bool left, bool zeroPad)
 {
-  // if limited to base 10 and 16 the bufsize can be 20
-  char buf[64];
-  uint8_t i = 0;
-  uint8_t innerLoops = 0;
+  int fill = width - (int)(prefixLen + bodyLen) - (zeros > 0 ? zeros : 0);
+
+  if (!left && !zeroPad) sink.pad(' ', fill);
+  sink.put(prefix, prefixLen);
+  if (!left && zeroPad) sink.pad('0', fill);
+  sink.pad('0', zeros);
+  sink.put(body, bodyLen);
+  if (left) sink.pad(' ', fill);
+}
 
-  // prevent crash if called with base == 1
-  if (base < 2) base = 10;
-
-  // process chunks that fit in "16 bit math".
-  uint16_t top = 0xFFFF / base;
-  uint16_t th16 = 1;
-  while (th16 < top)
-  {
-    th16 *= base;
-    innerLoops++;
-  }
+}
 
-  while (n64 > th16)
-  {
-    // 64 bit math part
-    uint64_t q = n64 / th16;
-    uint16_t r = n64 - q*th16;
-    n64 = q;
-
-    // 16 bit math loop to do remainder. (note buffer is filled reverse)
-    for (uint8_t j=0; j < innerLoops; j++)
-    {
-      uint16_t qq = r/base;
-      buf[i++] = r - qq*base;
-      r = qq;
+/*
+ * printf() subset: flags - + space 0 #, width and precision (also *), length hh h l ll
+ * z j t, conversions d i u o x X c s p f F %. e, E, g and G print like f.
+ * The minimal core profile (GD32_CORE_MINIMAL) leaves the floating point
+ * conversions out, so printf() doesn't pull in the soft float library; they
+ * print as is then.
+ */
+size_t Print::vprintf(const char *format, va_list ap)
+{
+  PrintfSink sink(*this);
+
+  while (*format) {
+    const char *start = format;
+    while (*format && *format != '%') format++;
+    sink.put(start, format - start);
+    if (!*format) break;
+    format++;
+
+    bool left = false, plus = false, space = false, zeroPad = false, alt = false;
+    for (;; format++) {
+      if (*format == '-') left = true;
+      else if (*format == '+') plus = true;
+      else if (*format == ' ') space = true;
+      else if (*format == '0') zeroPad = true;
+      else if (*format == '#') alt = true;
+      else break;
+    }
+    int width = 0;
+    if (*format == '*') {
+      width = va_arg(ap, int);
+      if (width < 0) {
+        left = true;
+        width = -width;
+      }
+      format++;
+    } else {
+      while (*format >= '0' && *format <= '9') width = width * 10 + (*format++ - '0');
+    }
+    int precision = -1;
+    if (*format == '.') {
+      format++;
+      precision = 0;
+      if (*format == '*') {
+        precision = va_arg(ap, int);
+        format++;
+      } else {
+        while (*format >= '0' && *format <= '9') precision = precision * 10 + (*format++ - '0');
+      }
+    }
+    uint8_t size = 0; // 0 int, 1 long, 2 long long, 3 size_t/ptrdiff_t/intmax_t
+    uint8_t shorts = 0; // 1 short, 2 char, narrowing an int argument
+    for (;; format++) {
+      if (*format == 'h') shorts++;
+      else if (*format == 'l') size++;
+      else if (*format == 'z' || *format == 'j' || *format == 't') size = 3;
+      else break;
+    }
+    if (left) zeroPad = false;
+
+    char conv = *format;
+    if (!conv) break;
+    format++;
+
+    char buf[13 + PRINT_FLOAT_DIGITS];
+    char *end = buf + sizeof(buf);
+    char prefix[2];
+    size_t prefixLen = 0;
+
+    switch (conv) {
+      case 'd':
+      case 'i':
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+      case 'p': {
+        unsigned long long v;
+        bool negative = false;
+        uint8_t base = conv == 'o' ? 8 : (conv == 'x' || conv == 'X' || conv == 'p') ? 16 : 10;
+        if (conv == 'p') {
+          v = (uintptr_t)va_arg(ap, void *);
+          alt = true;
+        } else if (conv == 'd' || conv == 'i') {
+          long long sv = size == 0 ? va_arg(ap, int) : size == 1 ? va_arg(ap, long) :
+                         size == 2 ? va_arg(ap, long long) : (long long)va_arg(ap, ptrdiff_t);
+          if (size == 0 && shorts == 1) sv = (short)sv;
+          else if (size == 0 && shorts >= 2) sv = (signed char)sv;
+          negative = sv < 0;
+          v = negative ? 0ULL - (unsigned long long)sv : (unsigned long long)sv;
+        } else {
+          v = size == 0 ? va_arg(ap, unsigned int) : size == 1 ? va_arg(ap, unsigned long) :
+              size == 2 ? va_arg(ap, unsigned long long) : (unsigned long long)va_arg(ap, size_t);
+          if (size == 0 && shorts == 1) v = (unsigned short)v;
+          else if (size == 0 && shorts >= 2) v = (unsigned char)v;
+        }
+        if (negative) prefix[prefixLen++] = '-';
+        else if (plus && base == 10) prefix[prefixLen++] = '+';
+        else if (space && base == 10) prefix[prefixLen++] = ' ';
+        if (alt && base == 16 && v != 0) {
+          prefix[prefixLen++] = '0';
+          prefix[prefixLen++] = conv == 'X' ? 'X' : 'x';
+        }
+        char *str = (precision == 0 && v == 0) ? end : formatNumber(end, v, base, conv == 'X');
+        if (alt && base == 8 && (str == end || *str != '0')) *--str = '0';
+        int zeros = precision - (int)(end - str);
+        printfField(sink, prefix, prefixLen, str, end - str, zeros, width, left,
+                    zeroPad && precision < 0);
+        break;
+      }
+#if defined(GD32_CORE_MINIMAL)
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+        (void)va_arg(ap, double);
+        sink.put('%');
+        sink.put(conv);
+        break;
+#else
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G': {
+        double v = va_arg(ap, double);
+        const char *str = buf;
+        size_t len;
+        int extra = 0;
+        if (precision < 0) precision = 6;
+        if (isnan(v) || isinf(v) || v > 4294967040.0 || v < -4294967040.0) {
+          str = isnan(v) ? "nan" : isinf(v) ? (v < 0 ? "-inf" : "inf") : "ovf";
+          len = strlen(str);
+          zeroPad = false;
+        } else {
+          if (precision > PRINT_FLOAT_DIGITS) {
+            extra = precision - PRINT_FLOAT_DIGITS;
+            precision = PRINT_FLOAT_DIGITS;
+          }
+          len = formatFloat(buf, v, precision);
+        }
+        if (*str == '-') {
+          prefix[prefixLen++] = *str++;
+          len--;
+        } else if (plus) {
+          prefix[prefixLen++] = '+';
+        } else if (space) {
+          prefix[prefixLen++] = ' ';
+        }
+        printfField(sink, prefix, prefixLen, str, len, 0, width - extra, left, zeroPad);
+        sink.pad('0', extra);
+        break;
+      }
+#endif
+      case 'c':
+        buf[0] = (char)va_arg(ap, int);
+        printfField(sink, prefix, 0, buf, 1, 0, width, left, false);
+        break;
+      case 's': {
+        const char *str = va_arg(ap, const char *);
+        size_t len = 0;
+        if (str == NULL) str = "(null)";
+        while (str[len] && (precision < 0 || len < (size_t)precision)) len++;
+        printfField(sink, prefix, 0, str, len, 0, width, left, false);
+        break;
+      }
+      case '%':
+        sink.put('%');
+        break;
+      default:
+        // unknown conversion, shown as is
+        sink.put('%');
+        sink.put(conv);
+        break;
     }
   }
+  return sink.finish();
+}
 
-  uint16_t n16 = n64;
-  while (n16 > 0)
-  {
-    uint16_t qq = n16/base;
-    buf[i++] = n16 - qq*base;
-    n16 = qq;
-  }
+size_t Print::printNumber(unsigned long n, uint8_t base, bool negative)
+{
+  return printULLNumber(n, base, negative);
+}
 
-  size_t bytes = i;
-  for (; i > 0; i--)
-    write((char) (buf[i - 1] < 10 ?
-    '0' + buf[i - 1] :
-    'A' + buf[i - 1] - 10));
+size_t Print::printULLNumber(unsigned long long n64, uint8_t base, bool negative)
+{
+  char buf[8 * sizeof(long long) + 1]; // Assumes 8-bit chars plus the sign.
+  char *end = &buf[sizeof(buf)];
+
+  // prevent crash if called with base == 1
+  if (base < 2 || base > 36) base = 10;
 
-  return bytes;
+  char *str = formatNumber(end, n64, base);
+  if (negative) *--str = '-';
+  return write(str, end - str);
 }
 
 size_t Print::printFloat(double number, int digits)
 {
+  char buf[13 + PRINT_FLOAT_DIGITS];
+
   if (digits < 0)
     digits = 2;
 
-  size_t n = 0;
-
   if (isnan(number)) return print("nan");
   if (isinf(number)) return print("inf");
   if (number > 4294967040.0) return print ("ovf");  // constant determined empirically
   if (number <-4294967040.0) return print ("ovf");  // constant determined empirically
 
-  // Handle negative numbers
-  if (number < 0.0)
-  {
-     n += print('-');
-     number = -number;
+  // one write for the whole number
+  size_t n = write(buf, formatFloat(buf, number, digits > PRINT_FLOAT_DIGITS ? PRINT_FLOAT_DIGITS : digits));
+  for (int i = PRINT_FLOAT_DIGITS; i < digits; i++) {
+    n += write('0');
   }
-
-  // Round correctly so that print(1.999, 2) prints as "2.00"
-  double rounding = 0.5;
-  for (uint8_t i=0; i<digits; ++i)
-    rounding /= 10.0;
-
-  number += rounding;
-
-  // Extract the integer part of the number and print it
-  unsigned long int_part = (unsigned long)number;
-  double remainder = number - (double)int_part;
-  n += print(int_part);
-
-  // Print the decimal point, but only if there are digits beyond
-  if (digits > 0) {
-    n += print(".");
-  }
-
-  // Extract digits from the remainder one at a time
-  while (digits-- > 0)
-  {
-    remainder *= 10.0;
-    unsigned int toPrint = (unsigned int)remainder;
-    n += print(toPrint);
-    remainder -= toPrint;
-  }
-
   return n;
 }
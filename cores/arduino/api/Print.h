@@ -19,6 +19,7 @@
 #pragma once
 
 #include <inttypes.h>
+#include <stdarg.h>
 #include <stdio.h> // for size_t
 
 #include "String.h"
@@ -35,8 +36,8 @@ class Print
 {
   private:
     int write_error;
-    size_t printNumber(unsigned long, uint8_t);
-    size_t printULLNumber(unsigned long long, uint8_t);
+    size_t printNumber(unsigned long, uint8_t, bool negative = false);
+    size_t printULLNumber(unsigned long long, uint8_t, bool negative = false);
     size_t printFloat(double, int);
   protected:
     void setWriteError(int err = 1) { write_error = err; }
@@ -89,6 +90,10 @@ class Print
     size_t println(const Printable&);
     size_t println(void);
 
+    // formatted straight to write(buffer, size) in small chunks, no full-length buffer
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    size_t vprintf(const char *format, va_list ap);
+
     virtual void flush() { /* Empty implementation for backward compatibility */ }
 };
 
@@ -135,6 +135,129 @@ bool RingBufferN<N>::isFull()
   return (_numElems == N);
 }
 
+// Lock-free ring of N bytes (a power of two) for one producer and one consumer,
+// e.g. an interrupt handler and loop(). The producer only writes _head and the
+// consumer only writes _tail; both run freely and are reduced modulo N on use,
+// so every byte of the buffer is usable and neither side has to disable
+// interrupts. push*() and availableForStore() belong to the producer, the rest
+// to the consumer.
+template <unsigned int N>
+class SPSCRingBufferN
+{
+  static_assert(N > 0 && (N & (N - 1)) == 0, "SPSCRingBufferN size must be a power of two");
+
+  public:
+    SPSCRingBufferN( void ) : _head(0), _tail(0) {}
+    bool push( uint8_t c );
+    size_t push( const uint8_t *data, size_t len );
+    size_t availableForStore() const;
+    int pop();
+    size_t pop( uint8_t *data, size_t len );
+    int peek() const;
+    size_t available() const;
+    void clear();
+
+  private:
+    uint8_t _buffer[N];
+    volatile uint32_t _head;
+    volatile uint32_t _tail;
+};
+
+template <unsigned int N>
+bool SPSCRingBufferN<N>::push( uint8_t c )
+{
+  uint32_t head = _head;
+
+  if (head - _tail == N)
+    return false;
+  _buffer[head & (N - 1)] = c;
+  // the byte has to be in place before the consumer can see it
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  _head = head + 1;
+  return true;
+}
+
+template <unsigned int N>
+size_t SPSCRingBufferN<N>::push( const uint8_t *data, size_t len )
+{
+  uint32_t head = _head;
+  size_t room = N - (head - _tail);
+  size_t offset = head & (N - 1);
+
+  if (len > room)
+    len = room;
+  // up to the end of the buffer, then the part that wraps
+  size_t first = N - offset < len ? N - offset : len;
+  memcpy(&_buffer[offset], data, first);
+  memcpy(&_buffer[0], data + first, len - first);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  _head = head + len;
+  return len;
+}
+
+template <unsigned int N>
+size_t SPSCRingBufferN<N>::availableForStore() const
+{
+  return N - (_head - _tail);
+}
+
+template <unsigned int N>
+int SPSCRingBufferN<N>::pop()
+{
+  uint32_t tail = _tail;
+
+  if (_head == tail)
+    return -1;
+  // read the byte only after seeing the head that published it
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  uint8_t value = _buffer[tail & (N - 1)];
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  _tail = tail + 1;
+  return value;
+}
+
+template <unsigned int N>
+size_t SPSCRingBufferN<N>::pop( uint8_t *data, size_t len )
+{
+  uint32_t tail = _tail;
+  size_t used = _head - tail;
+  size_t offset = tail & (N - 1);
+
+  if (len > used)
+    len = used;
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  size_t first = N - offset < len ? N - offset : len;
+  memcpy(data, &_buffer[offset], first);
+  memcpy(data + first, &_buffer[0], len - first);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  _tail = tail + len;
+  return len;
+}
+
+template <unsigned int N>
+int SPSCRingBufferN<N>::peek() const
+{
+  uint32_t tail = _tail;
+
+  if (_head == tail)
+    return -1;
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return _buffer[tail & (N - 1)];
+}
+
+template <unsigned int N>
+size_t SPSCRingBufferN<N>::available() const
+{
+  return _head - _tail;
+}
+
+// drops everything stored so far, from the consumer side
+template <unsigned int N>
+void SPSCRingBufferN<N>::clear()
+{
+  _tail = _head;
+}
+
 }
 
 #endif /* _RING_BUFFER_ */
@@ -86,6 +86,16 @@ int Stream::peekNextDigit(LookaheadMode lookahead, bool detectDecimal)
 // Public Methods
 //////////////////////////////////////////////////////////////
 
+// drops bytes one read() at a time, for streams without a buffered view
+size_t Stream::consume(size_t n)
+{
+  size_t count = 0;
+  while (count < n && read() >= 0) {
+    count++;
+  }
+  return count;
+}
+
 void Stream::setTimeout(unsigned long timeout)  // sets the maximum number of milliseconds to wait
 {
   _timeout = timeout;
@@ -206,6 +216,17 @@ size_t Stream::readBytes(char *buffer, size_t length)
 {
   size_t count = 0;
   while (count < length) {
+    const uint8_t *data;
+    size_t n = peekSpan(&data);
+    if (n > 0) {
+      if (n > length - count) n = length - count;
+      memcpy(buffer, data, n);
+      consume(n);
+      buffer += n;
+      count += n;
+      continue;
+    }
+    // nothing buffered: wait for the next byte, then look again
     int c = timedRead();
     if (c < 0) break;
     *buffer++ = (char)c;
@@ -223,6 +244,22 @@ size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length)
 {
   size_t index = 0;
   while (index < length) {
+    const uint8_t *data;
+    size_t n = peekSpan(&data);
+    if (n > 0) {
+      if (n > length - index) n = length - index;
+      const uint8_t *end = (const uint8_t *)memchr(data, (uint8_t)terminator, n);
+      size_t take = end ? (size_t)(end - data) : n;
+      memcpy(buffer, data, take);
+      buffer += take;
+      index += take;
+      if (end) {
+        consume(take + 1);
+        break;
+      }
+      consume(take);
+      continue;
+    }
     int c = timedRead();
     if (c < 0 || (char)c == terminator) break;
     *buffer++ = (char)c;
@@ -246,15 +283,80 @@ String Stream::readString()
 String Stream::readStringUntil(char terminator)
 {
   String ret;
-  int c = timedRead();
-  while (c >= 0 && (char)c != terminator)
-  {
+  while (1) {
+    const uint8_t *data;
+    size_t n = peekSpan(&data);
+    if (n > 0) {
+      const uint8_t *end = (const uint8_t *)memchr(data, (uint8_t)terminator, n);
+      size_t take = end ? (size_t)(end - data) : n;
+      ret.concat(data, take);
+      if (end) {
+        consume(take + 1);
+        break;
+      }
+      consume(take);
+      continue;
+    }
+    int c = timedRead();
+    if (c < 0 || (char)c == terminator) break;
     ret += (char)c;
-    c = timedRead();
   }
   return ret;
 }
 
+// feeds one character to every target, returns the index of a target it
+// completes or -1
+int Stream::findMultiStep(struct MultiTarget *targets, int tCount, char c) {
+  for (struct MultiTarget *t = targets; t < targets+tCount; ++t) {
+    // the simple case is if we match, deal with that first.
+    if ((char)c == t->str[t->index]) {
+      if (++t->index == t->len)
+        return t - targets;
+      else
+        continue;
+    }
+
+    // if not we need to walk back and see if we could have matched further
+    // down the stream (ie '1112' doesn't match the first position in '11112'
+    // but it will match the second position so we can't just reset the current
+    // index to 0 when we find a mismatch.
+    if (t->index == 0)
+      continue;
+
+    int origIndex = t->index;
+    do {
+      --t->index;
+      // first check if current char works against the new current index
+      if ((char)c != t->str[t->index])
+        continue;
+
+      // if it's the only char then we're good, nothing more to check
+      if (t->index == 0) {
+        t->index++;
+        break;
+      }
+
+      // otherwise we need to check the rest of the found string
+      int diff = origIndex - t->index;
+      size_t i;
+      for (i = 0; i < t->index; ++i) {
+        if (t->str[i] != t->str[i + diff])
+          break;
+      }
+
+      // if we successfully got through the previous loop then our current
+      // index is good.
+      if (i == t->index) {
+        t->index++;
+        break;
+      }
+
+      // otherwise we just try the next index
+    } while (t->index);
+  }
+  return -1;
+}
+
 int Stream::findMulti( struct Stream::MultiTarget *targets, int tCount) {
   // any zero length target string automatically matches and would make
   // a mess of the rest of the algorithm.
@@ -264,57 +366,33 @@ int Stream::findMulti( struct Stream::MultiTarget *targets, int tCount) {
   }
 
   while (1) {
-    int c = timedRead();
-    if (c < 0)
-      return -1;
-
-    for (struct MultiTarget *t = targets; t < targets+tCount; ++t) {
-      // the simple case is if we match, deal with that first.
-      if ((char)c == t->str[t->index]) {
-        if (++t->index == t->len)
-          return t - targets;
-        else
-          continue;
+    const uint8_t *data;
+    size_t n = peekSpan(&data);
+    if (n > 0) {
+      size_t i = 0;
+      // nothing matched so far on a single target: skip to its first char
+      if (tCount == 1 && targets->index == 0) {
+        const uint8_t *first = (const uint8_t *)memchr(data, (uint8_t)targets->str[0], n);
+        i = first ? (size_t)(first - data) : n;
       }
-
-      // if not we need to walk back and see if we could have matched further
-      // down the stream (ie '1112' doesn't match the first position in '11112'
-      // but it will match the second position so we can't just reset the current
-      // index to 0 when we find a mismatch.
-      if (t->index == 0)
-        continue;
-
-      int origIndex = t->index;
-      do {
-        --t->index;
-        // first check if current char works against the new current index
-        if ((char)c != t->str[t->index])
-          continue;
-
-        // if it's the only char then we're good, nothing more to check
-        if (t->index == 0) {
-          t->index++;
-          break;
-        }
-
-        // otherwise we need to check the rest of the found string
-        int diff = origIndex - t->index;
-        size_t i;
-        for (i = 0; i < t->index; ++i) {
-          if (t->str[i] != t->str[i + diff])
-            break;
+      for (; i < n; i++) {
+        int found = findMultiStep(targets, tCount, (char)data[i]);
+        if (found >= 0) {
+          consume(i + 1);
+          return found;
         }
+      }
+      consume(n);
+      continue;
+    }
 
-        // if we successfully got through the previous loop then our current
-        // index is good.
-        if (i == t->index) {
-          t->index++;
-          break;
-        }
+    int c = timedRead();
+    if (c < 0)
+      return -1;
 
-        // otherwise we just try the next index
-      } while (t->index);
-    }
+    int found = findMultiStep(targets, tCount, (char)c);
+    if (found >= 0)
+      return found;
   }
   // unreachable
   return -1;
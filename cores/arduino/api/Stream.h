@@ -61,6 +61,13 @@ class Stream : public Print
     virtual int read() = 0;
     virtual int peek() = 0;
 
+    // Buffered view for the parsing methods: point *data at the oldest unread
+    // byte and return how many follow it contiguously, 0 if none are buffered
+    // or the stream has no buffer to show. The bytes stay unread until
+    // consume(), which drops up to n of them and returns how many it dropped.
+    virtual size_t peekSpan(const uint8_t **data) { (void)data; return 0; }
+    virtual size_t consume(size_t n);
+
     Stream() {_timeout=1000;}
 
 // parsing methods
@@ -124,6 +131,9 @@ class Stream : public Print
   // This allows you to search for an arbitrary number of strings.
   // Returns index of the target that is found first or -1 if timeout occurs.
   int findMulti(struct MultiTarget *targets, int tCount);
+
+  private:
+  int findMultiStep(struct MultiTarget *targets, int tCount, char c);
 };
 
 #undef NO_IGNORE_CHAR
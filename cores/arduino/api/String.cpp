@@ -34,6 +34,7 @@ namespace arduino {
 
 size_t const String::FLT_MAX_DECIMAL_PLACES;
 size_t const String::DBL_MAX_DECIMAL_PLACES;
+unsigned int const String::SSO_CAPACITY;
 
 /*********************************************/
 /*  Constructors                             */
@@ -65,13 +66,9 @@ String::String(const __FlashStringHelper *pstr)
 
 #if __cplusplus >= 201103L || defined(__GXX_EXPERIMENTAL_CXX0X__)
 String::String(String &&rval)
-	: buffer(rval.buffer)
-	, capacity(rval.capacity)
-	, len(rval.len)
 {
-	rval.buffer = NULL;
-	rval.capacity = 0;
-	rval.len = 0;
+	init();
+	move(rval);
 }
 #endif
 
@@ -144,7 +141,7 @@ String::String(double value, unsigned char decimalPlaces)
 
 String::~String()
 {
-	if (buffer) free(buffer);
+	if (!isInline()) free(buffer);
 }
 
 /*********************************************/
@@ -160,7 +157,7 @@ inline void String::init(void)
 
 void String::invalidate(void)
 {
-	if (buffer) free(buffer);
+	if (!isInline()) free(buffer);
 	buffer = NULL;
 	capacity = len = 0;
 }
@@ -177,13 +174,33 @@ bool String::reserve(unsigned int size)
 
 bool String::changeBuffer(unsigned int maxStrLen)
 {
-	char *newbuffer = (char *)realloc(buffer, maxStrLen + 1);
-	if (newbuffer) {
-		buffer = newbuffer;
-		capacity = maxStrLen;
+	// short strings stay in the object
+	if (maxStrLen <= SSO_CAPACITY && (!buffer || isInline())) {
+		buffer = sso;
+		capacity = SSO_CAPACITY;
 		return true;
 	}
-	return false;
+	// a string that grows grows by half at least, so appending a char at a time
+	// reallocates a logarithmic number of times
+	unsigned int grown = buffer ? capacity + capacity / 2 : 0;
+	unsigned int size = maxStrLen < grown ? grown : maxStrLen;
+	for (;;) {
+		char *newbuffer;
+		if (isInline()) {
+			newbuffer = (char *)malloc(size + 1);
+			if (newbuffer) memcpy(newbuffer, sso, len + 1);
+		} else {
+			newbuffer = (char *)realloc(buffer, size + 1);
+		}
+		if (newbuffer) {
+			buffer = newbuffer;
+			capacity = size;
+			return true;
+		}
+		// the heap may still have room for the exact size
+		if (size == maxStrLen) return false;
+		size = maxStrLen;
+	}
 }
 
 /*********************************************/
@@ -218,9 +235,15 @@ void String::move(String &rhs)
 {
 	if (this != &rhs)
 	{
-		free(buffer);
-
-		buffer = rhs.buffer;
+		if (!isInline()) free(buffer);
+
+		if (rhs.isInline()) {
+			// the characters live in rhs itself, they cannot be handed over
+			buffer = sso;
+			memcpy(sso, rhs.sso, rhs.len + 1);
+		} else {
+			buffer = rhs.buffer;
+		}
 		len = rhs.len;
 		capacity = rhs.capacity;
 
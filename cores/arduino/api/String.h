@@ -60,6 +60,8 @@ class String
 
 	static size_t const FLT_MAX_DECIMAL_PLACES = 10;
 	static size_t const DBL_MAX_DECIMAL_PLACES = FLT_MAX_DECIMAL_PLACES;
+	// strings up to this length are kept in the object itself, without a heap block
+	static unsigned int const SSO_CAPACITY = 11;
 
 public:
 	// constructors
@@ -223,7 +225,9 @@ protected:
 	char *buffer;	        // the actual char array
 	unsigned int capacity;  // the array length minus one (for the '\0')
 	unsigned int len;       // the String length (not counting the '\0')
+	char sso[SSO_CAPACITY + 1]; // buffer points here while the string is short
 protected:
+	bool isInline(void) const { return buffer == sso; }
 	void init(void);
 	void invalidate(void);
 	bool changeBuffer(unsigned int maxStrLen);
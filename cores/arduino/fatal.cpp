@@ -2,6 +2,9 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <variant.h>
+#if defined(GD32_SWO_BAUD)
+#include "ITMStream.h"
+#endif
 
 /* standard setting: swallow fatal erros for firmware size reasons */
 #ifndef FATAL_LOGS_TO_SERIAL
@@ -10,7 +13,13 @@
 
 void fatal(const char *format, ...)
 {
-#if FATAL_LOGS_TO_SERIAL != 0
+#if defined(GD32_SWO_BAUD)
+    /* SWO costs neither flash for a UART driver nor time on the wire */
+    va_list arglist;
+    va_start(arglist, format);
+    SWO.vprintf(format, arglist);
+    va_end(arglist);
+#elif FATAL_LOGS_TO_SERIAL != 0
     va_list arglist;
     va_start(arglist, format);
     vprintf(format, arglist);
@@ -49,6 +49,9 @@ extern const PinMap PinMap_SPI_MOSI[];
 extern const PinMap PinMap_SPI_MISO[];
 extern const PinMap PinMap_SPI_SCLK[];
 extern const PinMap PinMap_SPI_SSEL[];
+/* quad-SPI IO2/IO3, only on parts with SPI_QCTL */
+extern const PinMap PinMap_SPI_IO2[];
+extern const PinMap PinMap_SPI_IO3[];
 
 /* CAN */
 extern const PinMap PinMap_CAN_RD[];
@@ -0,0 +1,5 @@
+#if defined(GD32F30x)
+#include "gd32f30x_bkp.c"
+#elif defined(GD32EPRT) || defined(GD32E50X)
+#include "gd32e50x_bkp.c"
+#endif
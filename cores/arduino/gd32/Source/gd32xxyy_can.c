@@ -0,0 +1,7 @@
+#if defined(GD32F30x)
+#include "gd32f30x_can.c"
+#elif defined(GD32F1x0) && defined(GD32F170_190)
+#include "gd32f1x0_can.c"
+#elif defined(GD32E50X)
+#include "gd32e50x_can.c"
+#endif
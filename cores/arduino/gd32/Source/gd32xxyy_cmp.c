@@ -0,0 +1,9 @@
+#if defined(GD32F3x0) && defined(GD32F350)
+#include "gd32f3x0_cmp.c"
+#elif defined(GD32F1x0)
+#include "gd32f1x0_cmp.c"
+#elif defined(GD32E23x)
+#include "gd32e23x_cmp.c"
+#elif (defined(GD32E50X) && (defined(GD32E50X_CL) || defined(GD32E508)))
+#include "gd32e50x_cmp.c"
+#endif
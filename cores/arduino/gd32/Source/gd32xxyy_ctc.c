@@ -0,0 +1,7 @@
+#if defined(GD32F30x)
+#include "gd32f30x_ctc.c"
+#elif defined(GD32F3x0)
+#include "gd32f3x0_ctc.c"
+#elif defined(GD32EPRT) || defined(GD32E50X)
+#include "gd32e50x_ctc.c"
+#endif
@@ -0,0 +1,9 @@
+#if defined(GD32F30x)
+#include "gd32f30x_dac.c"
+#elif defined(GD32F3x0) && defined(GD32F350)
+#include "gd32f3x0_dac.c"
+#elif defined(GD32F1x0)
+#include "gd32f1x0_dac.c"
+#elif defined(GD32EPRT) || defined(GD32E50X)
+#include "gd32e50x_dac.c"
+#endif
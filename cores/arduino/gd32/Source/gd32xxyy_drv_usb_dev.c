@@ -0,0 +1,6 @@
+#ifdef USBCON
+#include "usbd_conf.h"
+#if USB_USBFS
+#include "drv_usb_dev.c"
+#endif
+#endif
@@ -0,0 +1,6 @@
+#ifdef USBCON
+#include "usbd_conf.h"
+#if USB_USBFS
+#include "drv_usbd_int.c"
+#endif
+#endif
@@ -0,0 +1,5 @@
+#if defined(GD32F30x)
+#include "gd32f30x_enet.c"
+#elif defined(GD32EPRT) || (defined(GD32E50X) && (defined(GD32E50X_CL) || defined(GD32E508)))
+#include "gd32e50x_enet.c"
+#endif
@@ -0,0 +1,5 @@
+#if defined(GD32F30x)
+#include "gd32f30x_exmc.c"
+#elif defined(GD32EPRT) || defined(GD32E50X)
+#include "gd32e50x_exmc.c"
+#endif
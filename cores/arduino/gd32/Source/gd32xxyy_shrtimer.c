@@ -0,0 +1,3 @@
+#if defined(GD32E50X)
+#include "gd32e50x_shrtimer.c"
+#endif
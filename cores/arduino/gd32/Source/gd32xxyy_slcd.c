@@ -0,0 +1,3 @@
+#if defined(GD32F1x0) && defined(GD32F170_190)
+#include "gd32f1x0_slcd.c"
+#endif
@@ -0,0 +1,11 @@
+#if defined(GD32F30x)
+#include "gd32f30x_spi.c"
+#elif defined(GD32F3x0)
+#include "gd32f3x0_spi.c"
+#elif defined(GD32F1x0)
+#include "gd32f1x0_spi.c"
+#elif defined(GD32E23x)
+#include "gd32e23x_spi.c"
+#elif defined(GD32EPRT) || defined(GD32E50X)
+#include "gd32e50x_spi.c"
+#endif
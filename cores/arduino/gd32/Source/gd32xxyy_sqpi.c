@@ -0,0 +1,3 @@
+#if defined(GD32EPRT) || defined(GD32E50X)
+#include "gd32e50x_sqpi.c"
+#endif
@@ -0,0 +1,7 @@
+#if defined(GD32F3x0)
+#include "gd32f3x0_syscfg.c"
+#elif defined(GD32F1x0)
+#include "gd32f1x0_syscfg.c"
+#elif defined(GD32E23x)
+#include "gd32e23x_syscfg.c"
+#endif
@@ -0,0 +1,3 @@
+#if (defined(GD32E50X) && (defined(GD32E50X_CL) || defined(GD32E508)))
+#include "gd32e50x_tmu.c"
+#endif
@@ -0,0 +1,5 @@
+#if defined(GD32F3x0)
+#include "gd32f3x0_tsi.c"
+#elif defined(GD32F1x0)
+#include "gd32f1x0_tsi.c"
+#endif
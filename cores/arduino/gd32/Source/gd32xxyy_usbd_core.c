@@ -0,0 +1,3 @@
+#ifdef USBCON
+#include "usbd_core.c"
+#endif
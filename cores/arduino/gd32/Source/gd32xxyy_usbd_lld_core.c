@@ -0,0 +1,6 @@
+#ifdef USBCON
+#include "usbd_conf.h"
+#if !USB_USBFS
+#include "usbd_lld_core.c"
+#endif
+#endif
@@ -0,0 +1,9 @@
+#if defined(GD32F30x)
+#include "gd32f30x_wwdgt.c"
+#elif defined(GD32F1x0)
+#include "gd32f1x0_wwdgt.c"
+#elif defined(GD32E23x)
+#include "gd32e23x_wwdgt.c"
+#elif defined(GD32EPRT) || defined(GD32E50X)
+#include "gd32e50x_wwdgt.c"
+#endif
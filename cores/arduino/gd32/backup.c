@@ -0,0 +1,132 @@
+#include "backup.h"
+#include "critical.h"
+
+#if defined(GD32F30x) || defined(GD32E50X) || defined(GD32F10x)
+/* 16-bit register n in its 32-bit slot, 0..9 then 10..41 after a gap */
+#define BACKUP_REG16(n)         REG16(BKP + (((n) < 10U) ? (0x04U + 4U * (n)) : (0x40U + 4U * ((n) - 10U))))
+#else
+#define BACKUP_REG32(n)         REG32(RTC + 0x50U + 4U * (n))
+#endif
+
+/*!
+    \brief      enable write access to the backup registers
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void backup_begin(void)
+{
+    rcu_periph_clock_enable(RCU_PMU);
+#if defined(GD32F30x) || defined(GD32E50X) || defined(GD32F10x)
+    rcu_periph_clock_enable(RCU_BKPI);
+#endif
+    pmu_backup_write_enable();
+}
+
+/*!
+    \brief      read a backup word
+    \param[in]  index: 0..BACKUP_WORDS-1
+    \param[out] none
+    \retval     the word, 0 for an index out of range
+*/
+uint32_t backup_read(uint32_t index)
+{
+    if (index >= BACKUP_WORDS) {
+        return 0U;
+    }
+#if defined(BACKUP_REG16)
+    return (uint32_t)BACKUP_REG16(2U * index) | ((uint32_t)BACKUP_REG16(2U * index + 1U) << 16);
+#else
+    return BACKUP_REG32(index);
+#endif
+}
+
+/*!
+    \brief      write a backup word
+    \param[in]  index: 0..BACKUP_WORDS-1, ignored out of range
+    \param[in]  value: the word
+    \param[out] none
+    \retval     none
+*/
+void backup_write(uint32_t index, uint32_t value)
+{
+    if (index >= BACKUP_WORDS) {
+        return;
+    }
+#if defined(BACKUP_REG16)
+    BACKUP_REG16(2U * index) = (uint16_t)value;
+    /* most counter steps leave the high half as it is */
+    if (BACKUP_REG16(2U * index + 1U) != (uint16_t)(value >> 16)) {
+        BACKUP_REG16(2U * index + 1U) = (uint16_t)(value >> 16);
+    }
+#else
+    BACKUP_REG32(index) = value;
+#endif
+}
+
+/*!
+    \brief      add to a backup word, safe against interrupts that add to it too
+    \param[in]  index: 0..BACKUP_WORDS-1
+    \param[in]  delta: added, wrapping at 2^32
+    \param[out] none
+    \retval     the new value, 0 for an index out of range
+*/
+uint32_t backup_add(uint32_t index, uint32_t delta)
+{
+    uint32_t state;
+    uint32_t value;
+
+    if (index >= BACKUP_WORDS) {
+        return 0U;
+    }
+    state = critical_enter();
+    value = backup_read(index) + delta;
+    backup_write(index, value);
+    critical_exit(state);
+    return value;
+}
+
+/*!
+    \brief      read a byte of the backup registers
+    \param[in]  offset: 0..BACKUP_SIZE-1
+    \param[out] none
+    \retval     the byte, 0 for an offset out of range
+*/
+uint8_t backup_read_byte(uint32_t offset)
+{
+    if (offset >= BACKUP_SIZE) {
+        return 0U;
+    }
+#if defined(BACKUP_REG16)
+    return (uint8_t)(BACKUP_REG16(offset / 2U) >> (8U * (offset % 2U)));
+#else
+    return (uint8_t)(BACKUP_REG32(offset / 4U) >> (8U * (offset % 4U)));
+#endif
+}
+
+/*!
+    \brief      write a byte of the backup registers, one register store
+    \param[in]  offset: 0..BACKUP_SIZE-1, ignored out of range
+    \param[in]  value: the byte
+    \param[out] none
+    \retval     none
+*/
+void backup_write_byte(uint32_t offset, uint8_t value)
+{
+    uint32_t state;
+    uint32_t shift;
+
+    if (offset >= BACKUP_SIZE) {
+        return;
+    }
+    state = critical_enter();
+#if defined(BACKUP_REG16)
+    shift = 8U * (offset % 2U);
+    BACKUP_REG16(offset / 2U) = (uint16_t)((BACKUP_REG16(offset / 2U) & ~(0xFFU << shift)) |
+                                           ((uint32_t)value << shift));
+#else
+    shift = 8U * (offset % 4U);
+    BACKUP_REG32(offset / 4U) = (BACKUP_REG32(offset / 4U) & ~(0xFFUL << shift)) | ((uint32_t)value << shift);
+#endif
+    critical_exit(state);
+}
@@ -0,0 +1,51 @@
+#ifndef _GD32_BACKUP_H_
+#define _GD32_BACKUP_H_
+
+#include <stdint.h>
+#include "gd32xxyy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Backup data registers. They sit in the backup domain, so they keep
+ * their contents through resets, standby and, with a battery on VBAT,
+ * power loss; only a backup domain reset clears them (rtc_Init() with
+ * KILL_RTC_BACKUP_DOMAIN_ON_RESTART does one). A write is a register
+ * store, no erase and no wear, so counters can be kept there as often
+ * as they change.
+ *
+ * GD32F30x, GD32F10x and GD32E50x have 42 16-bit registers in the BKP
+ * (10 on the low and medium density GD32F10x), here paired into 32-bit
+ * words: a word write is two stores, low half first. GD32F3x0, GD32F1x0
+ * and GD32E23x have five 32-bit registers in the RTC.
+ */
+#if defined(GD32F30x) || defined(GD32E50X) || defined(GD32F10x)
+#if defined(GD32F10X_MD) || defined(GD32F10X_LD)
+#define BACKUP_SIZE             20U
+#else
+#define BACKUP_SIZE             84U
+#endif
+#else
+#define BACKUP_SIZE             20U
+#endif
+/* 32-bit words */
+#define BACKUP_WORDS            (BACKUP_SIZE / 4U)
+
+/* enable write access to the backup domain, once before writes */
+void backup_begin(void);
+/* word index, 0 for one out of range */
+uint32_t backup_read(uint32_t index);
+void backup_write(uint32_t index, uint32_t value);
+/* add to a word and return the sum, with interrupts masked in between */
+uint32_t backup_add(uint32_t index, uint32_t delta);
+/* byte offset, 0 for one out of range */
+uint8_t backup_read_byte(uint32_t offset);
+void backup_write_byte(uint32_t offset, uint8_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_BACKUP_H_ */
@@ -0,0 +1,98 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "calendar.h"
+
+/*!
+    \brief      convert days since 1970-01-01 to a date, in closed form
+    \param[in]  days: days since 1970-01-01
+    \param[out] utcTime: year, month and day are set
+    \retval     none
+*/
+void calendar_dateFromDays(uint32_t days, UTCTimeStruct *utcTime)
+{
+    /* count from 0000-03-01 in 400 year eras, so the leap day ends a year */
+    uint32_t z = days + 719468U;
+    uint32_t era = z / 146097U;
+    uint32_t doe = z - era * 146097U;
+    uint32_t yoe = (doe - doe / 1460U + doe / 36524U - doe / 146096U) / 365U;
+    uint32_t doy = doe - (365U * yoe + yoe / 4U - yoe / 100U);
+    uint32_t mp = (5U * doy + 2U) / 153U;
+
+    utcTime->day = doy - (153U * mp + 2U) / 5U + 1U;
+    utcTime->month = (mp < 10U) ? (mp + 3U) : (mp - 9U);
+    utcTime->year = era * 400U + yoe + ((utcTime->month <= 2U) ? 1U : 0U);
+}
+
+/*!
+    \brief      get month length
+    \param[in]  lpyr: is leap year
+    \param[in]  mon: month
+    \param[out] none
+    \retval     month lenth
+*/
+uint8_t monthLength(uint8_t lpyr, uint8_t mon)
+{
+    uint8_t days = 30;
+
+    if (mon == 2) { // feb
+        days = (28 + lpyr);
+    } else {
+        if (mon > 7) { // aug-dec
+            mon--;
+        }
+
+        if (mon & 1) {
+            days = 31;
+        }
+    }
+
+    return (days);
+}
+
+/*!
+    \brief      make utcTime to second counts
+    \param[in]  alarmTime: alarm time
+    \param[out] none
+    \retval     second counts
+*/
+uint32_t mkTimtoStamp(UTCTimeStruct *utcTime)
+{
+    /* closed form, the inverse of calendar_dateFromDays() */
+    uint32_t year = utcTime->year - ((utcTime->month <= 2U) ? 1U : 0U);
+    uint32_t era = year / 400U;
+    uint32_t yoe = year - era * 400U;
+    uint32_t mp = (utcTime->month > 2U) ? (utcTime->month - 3U) : (utcTime->month + 9U);
+    uint32_t doy = (153U * mp + 2U) / 5U + utcTime->day - 1U;
+    uint32_t doe = yoe * 365U + yoe / 4U - yoe / 100U + doy;
+    uint32_t numDays = era * 146097U + doe - 719468U;
+    uint32_t timestamp = 0;
+
+    timestamp = numDays * SECONDS_PER_DAY + (utcTime->hour * 3600 + utcTime->minutes * 60 +
+                                             utcTime->seconds);
+    return timestamp;
+}
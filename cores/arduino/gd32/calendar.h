@@ -0,0 +1,65 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef _GD32_CALENDAR_H_
+#define _GD32_CALENDAR_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * Calendar arithmetic of the RTC driver. It touches no hardware, so it
+ * also builds on the host for the tools/host benchmarks (make host-bench).
+ */
+#define IsLeapYear(yr) (!((yr) % 400) || (((yr) % 100) && !((yr) % 4)))
+#define YearLength(yr)  ((uint16_t)(IsLeapYear(yr) ? 366 : 365))
+#define SECONDS_PER_MINUTE    60UL
+#define SECONDS_PER_HOUR      3600UL
+#define SECONDS_PER_DAY       86400UL
+
+typedef struct {
+    uint16_t year;    // 1970+
+    uint8_t month;    // 1-12
+    uint8_t day;      // 1-31
+    uint8_t hour;     // 0-23
+    uint8_t minutes;  // 0-59
+    uint8_t seconds;  // 0-59
+} UTCTimeStruct;
+
+uint8_t monthLength(uint8_t lpyr, uint8_t mon);                 //get month length
+uint32_t mkTimtoStamp(UTCTimeStruct *utcTime);                  //make utcTime to second counts
+void calendar_dateFromDays(uint32_t days, UTCTimeStruct *utcTime);  //year, month and day of days since 1970
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_CALENDAR_H_ */
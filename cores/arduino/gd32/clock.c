@@ -0,0 +1,382 @@
+#include <stddef.h>
+#include "clock.h"
+#include "systick.h"
+#include "critical.h"
+#include "gd32xxyy.h"
+
+#define CLOCK_STARTUP_TIMEOUT   0xFFFFU
+
+/* enable registers with counted clocks: AHB, APB1, APB2 and the additional APB1 */
+#ifndef CLOCK_GATE_REGS
+#define CLOCK_GATE_REGS         4U
+#endif
+
+typedef struct {
+    uint16_t regidx;            /* offset of the enable register in RCU, 0 while unused */
+    uint8_t users[32];          /* acquires of each bit */
+} clock_gate_t;
+
+static clock_listener_t *clock_listeners;
+static volatile uint32_t clock_changes;
+static clock_gate_t clock_gates[CLOCK_GATE_REGS];
+
+/* the count of periph, a new slot for its register if add; NULL if there is none */
+static uint8_t *clock_gate_users(rcu_periph_enum periph, bool add)
+{
+    uint16_t regidx = (uint16_t)((uint32_t)periph >> 6);
+    clock_gate_t *free_gate = NULL;
+    uint8_t i;
+
+    for (i = 0U; i < CLOCK_GATE_REGS; i++) {
+        if (clock_gates[i].regidx == regidx) {
+            return &clock_gates[i].users[RCU_BIT_POS(periph)];
+        }
+        if ((clock_gates[i].regidx == 0U) && (free_gate == NULL)) {
+            free_gate = &clock_gates[i];
+        }
+    }
+    if (!add || (free_gate == NULL)) {
+        return NULL;
+    }
+    free_gate->regidx = regidx;
+    return &free_gate->users[RCU_BIT_POS(periph)];
+}
+
+void clock_periph_acquire(rcu_periph_enum periph)
+{
+    uint32_t state = critical_enter();
+    uint8_t *users = clock_gate_users(periph, true);
+
+    /* out of slots the clock just stays on, as if never released */
+    if ((users != NULL) && (*users < 0xFFU)) {
+        (*users)++;
+    }
+    rcu_periph_clock_enable(periph);
+    critical_exit(state);
+}
+
+void clock_periph_release(rcu_periph_enum periph)
+{
+    uint32_t state = critical_enter();
+    uint8_t *users = clock_gate_users(periph, false);
+
+    if ((users != NULL) && (*users != 0U)) {
+        if (--(*users) == 0U) {
+            rcu_periph_clock_disable(periph);
+        }
+    }
+    critical_exit(state);
+}
+
+uint8_t clock_periph_users(rcu_periph_enum periph)
+{
+    uint32_t state = critical_enter();
+    uint8_t *users = clock_gate_users(periph, false);
+    uint8_t count = (users != NULL) ? *users : 0U;
+
+    critical_exit(state);
+    return count;
+}
+
+void clock_listener_add(clock_listener_t *listener)
+{
+    clock_listener_t *l;
+
+    for (l = clock_listeners; l != NULL; l = l->next) {
+        if (l == listener) {
+            return;
+        }
+    }
+    listener->next = clock_listeners;
+    clock_listeners = listener;
+}
+
+uint32_t clock_generation(void)
+{
+    return clock_changes;
+}
+
+#if defined(GD32E23x)
+#define CLOCK_FLASH_HZ_PER_WS   24000000U
+#define CLOCK_FLASH_MAX_WS      2U
+#elif defined(GD32E50X)
+#define CLOCK_FLASH_HZ_PER_WS   36000000U
+#define CLOCK_FLASH_MAX_WS      4U
+#endif
+
+#if defined(CLOCK_FLASH_HZ_PER_WS)
+
+uint8_t clock_flash_wait_states(void)
+{
+    return (uint8_t)(FMC_WS & FMC_WS_WSCNT);
+}
+
+uint8_t clock_flash_wait_states_for(uint32_t hz)
+{
+    uint32_t ws = (hz == 0U) ? 0U : (hz - 1U) / CLOCK_FLASH_HZ_PER_WS;
+
+    return (uint8_t)((ws > CLOCK_FLASH_MAX_WS) ? CLOCK_FLASH_MAX_WS : ws);
+}
+
+bool clock_flash_set_wait_states(uint8_t ws)
+{
+    if ((ws > CLOCK_FLASH_MAX_WS) || (ws < clock_flash_wait_states_for(SystemCoreClock))) {
+        return false;
+    }
+    FMC_WS = (FMC_WS & ~FMC_WS_WSCNT) | ws;
+    /* the new count is in force once it reads back */
+    while ((FMC_WS & FMC_WS_WSCNT) != ws) {
+    }
+    return true;
+}
+
+void clock_flash_set_prefetch(bool enable)
+{
+    if (enable) {
+        FMC_WS |= FMC_WS_PFEN;
+    } else {
+        FMC_WS &= ~FMC_WS_PFEN;
+    }
+}
+
+void clock_flash_set_cache(bool enable)
+{
+#if defined(FMC_WS_ICEN)
+    uint32_t state = critical_enter();
+
+    /* a cache is only reset while it is off */
+    FMC_WS &= ~(FMC_WS_ICEN | FMC_WS_DCEN);
+    if (enable) {
+        FMC_WS |= FMC_WS_ICRST | FMC_WS_DCRST;
+        FMC_WS &= ~(FMC_WS_ICRST | FMC_WS_DCRST);
+        FMC_WS |= FMC_WS_ICEN | FMC_WS_DCEN;
+    }
+    critical_exit(state);
+#else
+    (void)enable;
+#endif
+}
+
+void clock_flash_tune(void)
+{
+    clock_flash_set_wait_states(clock_flash_wait_states_for(SystemCoreClock));
+    clock_flash_set_prefetch(true);
+    clock_flash_set_cache(true);
+}
+
+#else
+
+/* the code runs from zero-wait flash, there is nothing to set */
+uint8_t clock_flash_wait_states(void)
+{
+    return 0U;
+}
+
+uint8_t clock_flash_wait_states_for(uint32_t hz)
+{
+    (void)hz;
+    return 0U;
+}
+
+bool clock_flash_set_wait_states(uint8_t ws)
+{
+    return ws == 0U;
+}
+
+void clock_flash_set_prefetch(bool enable)
+{
+    (void)enable;
+}
+
+void clock_flash_set_cache(bool enable)
+{
+    (void)enable;
+}
+
+void clock_flash_tune(void)
+{
+}
+
+#endif
+
+#if CLOCK_SET_SYSTEM
+
+#define CLOCK_MAX_HZ            120000000U
+/* above this the core needs the high-driver mode */
+#define CLOCK_HIGH_DRIVE_HZ     72000000U
+/* APB1 runs at most at half the top speed */
+#define CLOCK_APB1_MAX_HZ       60000000U
+#if defined(GD32F30X_CL)
+#define CLOCK_PREDV0_MAX        16U
+#else
+#define CLOCK_PREDV0_MAX        2U
+#endif
+
+static bool clock_wait(volatile uint32_t *reg, uint32_t mask, uint32_t value)
+{
+    uint32_t timeout = 0U;
+
+    while ((*reg & mask) != value) {
+        if (++timeout == CLOCK_STARTUP_TIMEOUT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool clock_select(uint32_t cksyssrc, uint32_t scss)
+{
+    RCU_CFG0 = (RCU_CFG0 & ~RCU_CFG0_SCS) | cksyssrc;
+    return clock_wait(&RCU_CFG0, RCU_CFG0_SCSS, scss);
+}
+
+/* PLLMF holds 2..16 as 0..14, and 17..64 as 16..63 split over three fields */
+static uint32_t clock_pllmf(uint32_t mul)
+{
+    uint32_t v = (mul <= 16U) ? (mul - 2U) : (mul - 1U);
+
+    return CFG0_PLLMF(v & 0x0FU) | ((v & 0x10U) ? RCU_CFG0_PLLMF_4 : 0U)
+           | ((v & 0x20U) ? RCU_CFG0_PLLMF_5 : 0U);
+}
+
+/* find an input divider and a multiplier that make hz out of src_hz */
+static bool clock_pll_factors(uint32_t hz, uint32_t src_hz, uint32_t max_div,
+                              uint32_t *div, uint32_t *mul)
+{
+    uint32_t d;
+
+    for (d = 1U; d <= max_div; d++) {
+        uint32_t in = src_hz / d;
+        if ((src_hz % d) || (hz % in)) {
+            continue;
+        }
+        if ((hz / in >= 2U) && (hz / in <= 63U)) {
+            *div = d;
+            *mul = hz / in;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool clock_usb_running(void)
+{
+#if defined(GD32F30X_CL)
+    return (RCU_AHBEN & RCU_AHBEN_USBFSEN) != 0U;
+#else
+    return (RCU_APB1EN & RCU_APB1EN_USBDEN) != 0U;
+#endif
+}
+
+static bool clock_switch(uint32_t hz, clock_source_t source)
+{
+    uint32_t div = 1U, mul = 0U;
+    bool direct;
+
+    if (source == CLOCK_SOURCE_HXTAL) {
+        direct = (hz == HXTAL_VALUE);
+        if (!direct && !clock_pll_factors(hz, HXTAL_VALUE, CLOCK_PREDV0_MAX, &div, &mul)) {
+            return false;
+        }
+        RCU_CTL |= RCU_CTL_HXTALEN;
+        if (!clock_wait(&RCU_CTL, RCU_CTL_HXTALSTB, RCU_CTL_HXTALSTB)) {
+            return false;
+        }
+    } else {
+        direct = (hz == IRC8M_VALUE);
+        /* the PLL only gets IRC8M halved */
+        if (!direct && !clock_pll_factors(hz, IRC8M_VALUE / 2U, 1U, &div, &mul)) {
+            return false;
+        }
+    }
+
+    /* run from IRC8M while the PLL and the regulator are changed */
+    RCU_CTL |= RCU_CTL_IRC8MEN;
+    if (!clock_wait(&RCU_CTL, RCU_CTL_IRC8MSTB, RCU_CTL_IRC8MSTB)
+            || !clock_select(RCU_CKSYSSRC_IRC8M, RCU_SCSS_IRC8M)) {
+        return false;
+    }
+    RCU_CTL &= ~RCU_CTL_PLLEN;
+
+    RCU_APB1EN |= RCU_APB1EN_PMUEN;
+    if (hz <= CLOCK_HIGH_DRIVE_HZ) {
+        PMU_CTL &= ~(PMU_CTL_HDS | PMU_CTL_HDEN);
+    }
+    PMU_CTL |= PMU_CTL_LDOVS;
+
+    RCU_CFG0 &= ~(RCU_CFG0_AHBPSC | RCU_CFG0_APB1PSC | RCU_CFG0_APB2PSC);
+    RCU_CFG0 |= RCU_AHB_CKSYS_DIV1 | RCU_APB2_CKAHB_DIV1
+                | ((hz > CLOCK_APB1_MAX_HZ) ? RCU_APB1_CKAHB_DIV2 : RCU_APB1_CKAHB_DIV1);
+
+    if (direct) {
+        if (source == CLOCK_SOURCE_HXTAL) {
+            return clock_select(RCU_CKSYSSRC_HXTAL, RCU_SCSS_HXTAL);
+        }
+        return true;
+    }
+
+    RCU_CFG0 &= ~(RCU_CFG0_PLLMF | RCU_CFG0_PLLMF_4 | RCU_CFG0_PLLMF_5 | RCU_CFG0_PLLSEL);
+    RCU_CFG1 &= ~RCU_CFG1_PLLPRESEL;
+#if defined(GD32F30X_CL)
+    RCU_CFG1 &= ~(RCU_CFG1_PREDV0SEL | RCU_CFG1_PREDV0);
+    RCU_CFG1 |= CFG1_PREDV0(div - 1U);
+#else
+    RCU_CFG0 &= ~RCU_CFG0_PREDV0;
+    if (div == 2U) {
+        RCU_CFG0 |= RCU_CFG0_PREDV0;
+    }
+#endif
+    RCU_CFG0 |= clock_pllmf(mul)
+                | ((source == CLOCK_SOURCE_HXTAL) ? RCU_PLLSRC_HXTAL_IRC48M : RCU_PLLSRC_IRC8M_DIV2);
+
+    RCU_CTL |= RCU_CTL_PLLEN;
+    if (!clock_wait(&RCU_CTL, RCU_CTL_PLLSTB, RCU_CTL_PLLSTB)) {
+        return false;
+    }
+
+    if (hz > CLOCK_HIGH_DRIVE_HZ) {
+        PMU_CTL |= PMU_CTL_HDEN;
+        if (!clock_wait(&PMU_CS, PMU_CS_HDRF, PMU_CS_HDRF)) {
+            return false;
+        }
+        PMU_CTL |= PMU_CTL_HDS;
+        if (!clock_wait(&PMU_CS, PMU_CS_HDSRF, PMU_CS_HDSRF)) {
+            return false;
+        }
+    }
+
+    return clock_select(RCU_CKSYSSRC_PLL, RCU_SCSS_PLL);
+}
+
+bool clock_set_system(uint32_t hz, clock_source_t source)
+{
+    uint32_t primask;
+    clock_listener_t *l;
+    bool ok;
+
+    if ((hz == 0U) || (hz > CLOCK_MAX_HZ) || clock_usb_running()) {
+        return false;
+    }
+
+    /* nothing may run on a bus clock that is half set up */
+    primask = __get_PRIMASK();
+    __disable_irq();
+    /* wait states go up before the clock does, and down only after it */
+    if (clock_flash_wait_states_for(hz) > clock_flash_wait_states()) {
+        clock_flash_set_wait_states(clock_flash_wait_states_for(hz));
+    }
+    ok = clock_switch(hz, source);
+    /* even a failed switch may have left us on IRC8M, so always refresh */
+    SystemCoreClockUpdate();
+    systick_clock_update();
+    clock_flash_tune();
+    clock_changes++;
+    __set_PRIMASK(primask);
+
+    for (l = clock_listeners; l != NULL; l = l->next) {
+        l->changed(l->arg);
+    }
+    return ok;
+}
+
+#endif /* CLOCK_SET_SYSTEM */
@@ -0,0 +1,98 @@
+#ifndef _GD32_CLOCK_H_
+#define _GD32_CLOCK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gd32xxyy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Changing the system clock at run time. ‘clock_set_system’ switches
+ * CK_SYS to the given frequency, updates SystemCoreClock and SysTick, and
+ * then calls every registered listener, so drivers can reprogram what
+ * they derived from the old bus clocks (baud rates, timer periods).
+ * Drivers that only set their clock up at the start of a transfer can
+ * compare ‘clock_generation’ instead, which changes with every switch.
+ *
+ * Only GD32F30x has it so far: CLOCK_SET_SYSTEM is 1 there and 0
+ * elsewhere, where ‘clock_set_system’ is not declared and a call does not
+ * compile. The listeners and ‘clock_generation’ exist on every part.
+ */
+#if defined(GD32F30x)
+#define CLOCK_SET_SYSTEM 1
+#else
+#define CLOCK_SET_SYSTEM 0
+#endif
+
+typedef enum {
+    CLOCK_SOURCE_IRC8M,     /* internal 8 MHz RC oscillator */
+    CLOCK_SOURCE_HXTAL      /* external crystal, HXTAL_VALUE */
+} clock_source_t;
+
+typedef struct clock_listener {
+    void (*changed)(void *arg);
+    void *arg;
+    struct clock_listener *next;
+} clock_listener_t;
+
+#if CLOCK_SET_SYSTEM
+/* false if hz can't be made from the source, or USB is running and
+ * needs its 48 MHz kept; if an oscillator fails to start, the system is
+ * left running from IRC8M */
+bool clock_set_system(uint32_t hz, clock_source_t source);
+#endif
+/* listeners are kept, not copied, and called at thread level */
+void clock_listener_add(clock_listener_t *listener);
+uint32_t clock_generation(void);
+
+/*
+ * Flash wait states and fetch accelerators. GD32F1x0, F3x0 and F30x run
+ * code from the zero-wait flash area at any clock, so they have nothing
+ * to tune: they report 0 wait states and the other calls do nothing.
+ * GD32E23x needs one wait state per 24 MHz and has a prefetch buffer;
+ * GD32E50x needs one per 36 MHz and adds instruction and data caches,
+ * which the vendor startup code leaves off. clock_flash_tune() runs from
+ * init() and after every clock_set_system(), and sets the fewest wait
+ * states SystemCoreClock allows with prefetch and caches on.
+ *
+ * The caches are not kept coherent with flash writes. The FlashStorage
+ * erase and program functions reset them when done; other code writing
+ * flash calls clock_flash_set_cache(true) afterwards, which drops every
+ * cached line.
+ */
+uint8_t clock_flash_wait_states(void);
+/* the fewest wait states the flash takes at hz */
+uint8_t clock_flash_wait_states_for(uint32_t hz);
+/* false if ws is fewer than SystemCoreClock needs or more than the part has */
+bool clock_flash_set_wait_states(uint8_t ws);
+void clock_flash_set_prefetch(bool enable);
+/* enabling also resets the caches */
+void clock_flash_set_cache(bool enable);
+void clock_flash_tune(void);
+
+/*
+ * Peripheral clock gates shared by reference count. A driver calls
+ * ‘clock_periph_acquire’ when it starts using a peripheral and
+ * ‘clock_periph_release’ once it is done with it; the clock is turned
+ * on by the first acquire and off again by the last release, which cuts
+ * the active current and the sleep-mode current of peripherals left
+ * idle. Each acquire needs exactly one release.
+ *
+ * Clocks turned on with rcu_periph_clock_enable() directly are not
+ * counted and stay on, a release with no acquire left does nothing.
+ * Only the clocks of one peripheral are counted, those of a GPIO port
+ * are by the pins using it, see pin_function().
+ */
+void clock_periph_acquire(rcu_periph_enum periph);
+void clock_periph_release(rcu_periph_enum periph);
+/* the acquires not released yet */
+uint8_t clock_periph_users(rcu_periph_enum periph);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_CLOCK_H_ */
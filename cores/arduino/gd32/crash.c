@@ -0,0 +1,173 @@
+#include <stddef.h>
+#include "crash.h"
+#include "gd32_def.h"
+#include "systick.h"
+#include "fatal.h"
+
+#define CRASH_MAGIC             0x43524153U     /* "CRAS" */
+
+/* from the linker script */
+extern uint8_t _sdata[];
+extern uint8_t _heap_end[];         /* bottom of the main stack */
+extern uint8_t _sp[];               /* top of RAM and of the main stack */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t reported;
+    crash_report_t report;
+    uint32_t check;
+} crash_record_t;
+
+static crash_record_t crash_record GD_NOINIT;
+/* r4 to r11 as they were at the fault, saved by HardFault_Handler; not
+   static, so the names in its assembly survive LTO */
+uint32_t crash_callee[8];
+void crash_capture(uint32_t *frame, uint32_t exc_return) __attribute__((used, noreturn));
+
+static uint32_t crash_checksum(const crash_record_t *record)
+{
+    const uint32_t *word = (const uint32_t *)record;
+    uint32_t sum = 0x5A5A5A5AU;
+    uint32_t i;
+
+    for (i = 0U; i < offsetof(crash_record_t, check) / 4U; i++) {
+        sum = ((sum << 5) | (sum >> 27)) ^ word[i];
+    }
+    return sum;
+}
+
+static bool crash_valid(void)
+{
+    return (crash_record.magic == CRASH_MAGIC) && (crash_record.check == crash_checksum(&crash_record));
+}
+
+/* frame: the exception frame the core pushed, exc_return: LR on entry */
+void crash_capture(uint32_t *frame, uint32_t exc_return)
+{
+    crash_report_t *report = &crash_record.report;
+    /* a frame with floating point state has 18 more words */
+    uint32_t frame_words = ((exc_return & 0x10U) == 0U) ? 26U : 8U;
+    uint32_t *stack = frame + frame_words;
+    uint32_t i;
+
+    report->r[0] = frame[0];
+    report->r[1] = frame[1];
+    report->r[2] = frame[2];
+    report->r[3] = frame[3];
+    for (i = 0U; i < 8U; i++) {
+        report->r[4U + i] = crash_callee[i];
+    }
+    report->r[12] = frame[4];
+    report->lr = frame[5];
+    report->pc = frame[6];
+    report->xpsr = frame[7];
+    /* the core aligned the frame to 8 bytes if bit 9 of the stacked xPSR says so */
+    report->sp = (uint32_t)stack + (((frame[7] & 0x200U) != 0U) ? 4U : 0U);
+    report->exc_return = exc_return;
+#if defined(SCB_HFSR_FORCED_Msk)
+    report->cfsr = SCB->CFSR;
+    report->hfsr = SCB->HFSR;
+    report->mmfar = SCB->MMFAR;
+    report->bfar = SCB->BFAR;
+#else
+    report->cfsr = 0U;
+    report->hfsr = 0U;
+    report->mmfar = 0U;
+    report->bfar = 0U;
+#endif
+    report->uptime = getCurrentMillis();
+    report->stack_overflow = ((exc_return & 0x4U) == 0U) && ((uint8_t *)frame < _heap_end);
+    /* only what lies in RAM, a broken sp may point anywhere */
+    report->stack_words = 0U;
+    while ((report->stack_words < CRASH_STACK_WORDS) && ((uint8_t *)stack >= _sdata) && ((uint8_t *)(stack + 1) <= _sp)) {
+        report->stack[report->stack_words++] = *stack++;
+    }
+
+    crash_record.magic = CRASH_MAGIC;
+    crash_record.reported = 0U;
+    crash_record.check = crash_checksum(&crash_record);
+
+    if ((CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk) != 0U) {
+        __ASM volatile("bkpt 0");
+    }
+    NVIC_SystemReset();
+}
+
+/*!
+    \brief      hard fault: save r4 to r11, find the stack the frame went to, dump
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+__attribute__((naked)) void HardFault_Handler(void)
+{
+    /* Thumb-1 only, for GD32E23x as well */
+    __asm volatile(
+        "ldr   r2, =crash_callee    \n"
+        "stmia r2!, {r4-r7}         \n"
+        "mov   r3, r8               \n"
+        "str   r3, [r2, #0]         \n"
+        "mov   r3, r9               \n"
+        "str   r3, [r2, #4]         \n"
+        "mov   r3, r10              \n"
+        "str   r3, [r2, #8]         \n"
+        "mov   r3, r11              \n"
+        "str   r3, [r2, #12]        \n"
+        "mov   r1, lr               \n"
+        "movs  r0, #4               \n"
+        "tst   r0, r1               \n"
+        "bne   1f                   \n"
+        "mrs   r0, msp              \n"
+        "b     2f                   \n"
+        "1:                         \n"
+        "mrs   r0, psp              \n"
+        "2:                         \n"
+        "ldr   r2, =crash_capture   \n"
+        "bx    r2                   \n"
+        ".ltorg                     \n"
+    );
+}
+
+/*!
+    \brief      the dump of the last crash
+    \param[in]  none
+    \param[out] none
+    \retval     NULL if there was none since power-up or crash_clear()
+*/
+const crash_report_t *crash_last(void)
+{
+    return crash_valid() ? &crash_record.report : NULL;
+}
+
+/*!
+    \brief      forget the dump of the last crash
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void crash_clear(void)
+{
+    crash_record.magic = 0U;
+}
+
+/*!
+    \brief      report a dump the last reset left behind, once
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void crash_check(void)
+{
+    const crash_report_t *report;
+
+    if (!crash_valid() || (crash_record.reported != 0U)) {
+        return;
+    }
+    crash_record.reported = 1U;
+    crash_record.check = crash_checksum(&crash_record);
+
+    report = &crash_record.report;
+    fatal("crash after %lu ms: pc %08lx lr %08lx sp %08lx cfsr %08lx hfsr %08lx bfar %08lx%s\n",
+          report->uptime, report->pc, report->lr, report->sp, report->cfsr, report->hfsr,
+          report->bfar, report->stack_overflow ? " (stack overflow)" : "");
+}
@@ -0,0 +1,61 @@
+#ifndef _GD32_CRASH_H_
+#define _GD32_CRASH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Crash dumps. The core's HardFault_Handler saves the registers, the
+ * fault status registers and the top of the faulting stack to .noinit
+ * RAM, which the next start-up neither loads nor clears, and resets the
+ * part; with a debugger attached it stops at a breakpoint instead. The
+ * MemManage, BusFault and UsageFault handlers stay disabled, so those
+ * faults escalate to HardFault and show in cfsr.
+ *
+ * init() picks the dump up on the next start, hands it to fatal() as a
+ * one-line summary (on SWO with the "SWO trace" menu, see itm.h) and
+ * keeps it for crash_last() until the next crash. Power loss clears it.
+ *
+ * A stack overflow of the main stack shows as an sp below the bottom of
+ * the stack (stack_overflow set). If the overflow runs so far that the
+ * fault can't stack its frame, the core locks up instead, and a watchdog
+ * is the only way out.
+ */
+/* words of the faulting stack kept above the exception frame */
+#ifndef CRASH_STACK_WORDS
+#define CRASH_STACK_WORDS       16U
+#endif
+
+typedef struct {
+    uint32_t r[13];                 /* r0 to r12 */
+    uint32_t sp;                    /* before the exception frame was pushed */
+    uint32_t lr;
+    uint32_t pc;                    /* the instruction that faulted, or the next one */
+    uint32_t xpsr;
+    uint32_t exc_return;            /* bit 2 set: the fault came from a task's PSP */
+    uint32_t cfsr;                  /* configurable fault status, 0 on GD32E23x */
+    uint32_t hfsr;                  /* hard fault status, 0 on GD32E23x */
+    uint32_t mmfar;                 /* address of a memory management fault */
+    uint32_t bfar;                  /* address of a precise bus fault */
+    uint32_t uptime;                /* milliseconds since start-up */
+    uint32_t stack[CRASH_STACK_WORDS];
+    uint8_t stack_words;            /* valid words in stack */
+    bool stack_overflow;            /* sp was below the main stack */
+} crash_report_t;
+
+/* the dump of the last crash, NULL if there was none since power-up */
+const crash_report_t *crash_last(void);
+/* forget it */
+void crash_clear(void);
+/* take over a dump from before the reset and report it, run by init() */
+void crash_check(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_CRASH_H_ */
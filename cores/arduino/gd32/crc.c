@@ -0,0 +1,364 @@
+#include <string.h>
+#include "crc.h"
+#include "dma.h"
+#include "irq_priority.h"
+
+/* most units one DMA transfer moves */
+#define CRC_DMA_MAX_UNITS       0xFFFFU
+
+#if defined(CRC_HAS_REVERSE)
+/* an 8-bit write feeds the unit one byte */
+#define CRC_DATA_BYTE           REG8(CRC)
+
+typedef struct {
+    dma_channel_t ch;
+    const uint8_t *next;        /* start of the next DMA transfer */
+    size_t units;               /* words, or bytes if byte_wide, left for DMA */
+    size_t tail;                /* bytes the CPU writes at the end */
+    bool byte_wide;
+    crc_callback_t callback;
+    void *arg;
+    volatile bool busy;
+} crc_dma_t;
+
+static crc_dma_t crc_dma;
+#endif
+
+static void crc_wait(void)
+{
+#if defined(CRC_HAS_REVERSE)
+    while (crc_dma.busy) {
+    }
+#endif
+}
+
+#if defined(CRC_HAS_REVERSE)
+/* choose how the unit reverses the writes that follow */
+static void crc_input_reverse(const crc_calc_t *calc, uint32_t reverse)
+{
+    crc_input_data_reverse_config(calc->reflect ? reverse : CRC_INPUT_DATA_NOT);
+}
+
+static void crc_write_bytes(const crc_calc_t *calc, const uint8_t *p, size_t length)
+{
+    crc_input_reverse(calc, CRC_INPUT_DATA_BYTE);
+    while (length-- > 0U) {
+        CRC_DATA_BYTE = *p++;
+    }
+}
+#else
+/* the unit takes a byte stream as words, bytes in memory order, bit order as configured */
+static uint32_t crc_word_order(const crc_calc_t *calc, uint32_t word)
+{
+    return calc->reflect ? __RBIT(word) : __REV(word);
+}
+
+/* continue the CRC-32 in r, as the unit holds it, over a few bytes */
+static uint32_t crc_fold_bytes(const crc_calc_t *calc, uint32_t r, const uint8_t *p, size_t length)
+{
+    uint8_t bit;
+
+    while (length-- > 0U) {
+        r ^= calc->reflect ? __RBIT(*p) : ((uint32_t)*p << 24);
+        p++;
+        for (bit = 0U; bit < 8U; bit++) {
+            r = (r & 0x80000000U) ? ((r << 1) ^ CRC32_POLYNOMIAL) : (r << 1);
+        }
+    }
+    return r;
+}
+#endif
+
+/*!
+    \brief      reset the CRC unit for a new calculation
+    \param[in]  calc: state of the calculation
+    \param[in]  polynomial: generator polynomial without the top bit, e.g. CRC32_POLYNOMIAL
+    \param[in]  width: polynomial size, 7, 8, 16 or 32 bits
+    \param[in]  init: initial register value
+    \param[in]  reflect: true to process bytes least significant bit first and reverse the result
+    \param[in]  xor_out: value the result is XORed with
+    \param[out] none
+    \retval     false if the unit of this series can't compute the CRC
+*/
+bool crc_calc_begin(crc_calc_t *calc, uint32_t polynomial, uint8_t width, uint32_t init,
+                    bool reflect, uint32_t xor_out)
+{
+#if defined(CRC_HAS_POLYNOMIAL)
+    uint32_t size;
+
+    switch (width) {
+        case 7:
+            size = CRC_CTL_PS_7;
+            break;
+        case 8:
+            size = CRC_CTL_PS_8;
+            break;
+        case 16:
+            size = CRC_CTL_PS_16;
+            break;
+        case 32:
+            size = CRC_CTL_PS_32;
+            break;
+        default:
+            return false;
+    }
+#else
+    if ((width != 32U) || (polynomial != CRC32_POLYNOMIAL)) {
+        return false;
+    }
+#if !defined(CRC_HAS_REVERSE)
+    if (init != 0xFFFFFFFFU) {
+        return false;
+    }
+#endif
+#endif
+    crc_wait();
+    calc->polynomial = polynomial;
+    calc->init = init;
+    calc->xor_out = xor_out;
+    calc->width = width;
+    calc->reflect = reflect;
+    calc->pending = 0U;
+
+    rcu_periph_clock_enable(RCU_CRC);
+#if defined(CRC_HAS_POLYNOMIAL)
+    crc_polynomial_size_set(size);
+    crc_polynomial_set(polynomial);
+#endif
+#if defined(CRC_HAS_REVERSE)
+    crc_init_data_register_write(init);
+    if (reflect) {
+        crc_reverse_output_data_enable();
+    } else {
+        crc_reverse_output_data_disable();
+    }
+#endif
+    crc_data_register_reset();
+    return true;
+}
+
+/*!
+    \brief      feed bytes into the calculation
+    \param[in]  calc: state of the calculation
+    \param[in]  data: the bytes, any alignment
+    \param[in]  length: number of bytes
+    \param[out] none
+    \retval     none
+*/
+void crc_calc_update(crc_calc_t *calc, const void *data, size_t length)
+{
+    const uint8_t *p = (const uint8_t *)data;
+
+    crc_wait();
+#if defined(CRC_HAS_REVERSE)
+    /* single bytes up to a word boundary, the core may not read words across one */
+    if (((uint32_t)p & 3U) != 0U) {
+        size_t head = 4U - ((uint32_t)p & 3U);
+
+        if (head > length) {
+            head = length;
+        }
+        crc_write_bytes(calc, p, head);
+        p += head;
+        length -= head;
+    }
+    if (length >= 4U) {
+        crc_input_reverse(calc, CRC_INPUT_DATA_WORD);
+        if (calc->reflect) {
+            /* the word reversal also puts the bytes in memory order */
+            for (; length >= 4U; length -= 4U, p += 4) {
+                CRC_DATA = *(const uint32_t *)p;
+            }
+        } else {
+            for (; length >= 4U; length -= 4U, p += 4) {
+                CRC_DATA = __REV(*(const uint32_t *)p);
+            }
+        }
+    }
+    crc_write_bytes(calc, p, length);
+#else
+    uint32_t word;
+
+    if (calc->pending != 0U) {
+        while ((calc->pending < 4U) && (length > 0U)) {
+            calc->pending_data[calc->pending++] = *p++;
+            length--;
+        }
+        if (calc->pending < 4U) {
+            return;
+        }
+        memcpy(&word, calc->pending_data, 4U);
+        CRC_DATA = crc_word_order(calc, word);
+        calc->pending = 0U;
+    }
+    for (; length >= 4U; length -= 4U, p += 4) {
+        memcpy(&word, p, 4U);
+        CRC_DATA = crc_word_order(calc, word);
+    }
+    memcpy(calc->pending_data, p, length);
+    calc->pending = (uint8_t)length;
+#endif
+}
+
+/*!
+    \brief      get the CRC of the bytes fed so far, the calculation can go on
+    \param[in]  calc: state of the calculation
+    \param[out] none
+    \retval     the CRC, in the low width bits
+*/
+uint32_t crc_calc_value(const crc_calc_t *calc)
+{
+    uint32_t r;
+
+    crc_wait();
+#if defined(CRC_HAS_REVERSE)
+    /* the unit reverses the output itself */
+    r = CRC_DATA;
+#else
+    r = crc_fold_bytes(calc, CRC_DATA, calc->pending_data, calc->pending);
+    if (calc->reflect) {
+        r = __RBIT(r);
+    }
+#endif
+    r ^= calc->xor_out;
+    if (calc->width < 32U) {
+        r &= (1UL << calc->width) - 1U;
+    }
+    return r;
+}
+
+#if defined(CRC_HAS_REVERSE)
+/* start the next DMA transfer, at most CRC_DMA_MAX_UNITS of what is left */
+static void crc_dma_next(void)
+{
+    dma_parameter_struct dma_init_struct;
+    size_t units = (crc_dma.units > CRC_DMA_MAX_UNITS) ? CRC_DMA_MAX_UNITS : crc_dma.units;
+    dma_channel_t *ch = &crc_dma.ch;
+
+    dma_deinit(DMA_SPL_ARGS(ch));
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.direction    = DMA_MEMORY_TO_PERIPHERAL;
+    dma_init_struct.memory_addr  = (uint32_t)crc_dma.next;
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = crc_dma.byte_wide ? DMA_MEMORY_WIDTH_8BIT : DMA_MEMORY_WIDTH_32BIT;
+    dma_init_struct.number       = units;
+    dma_init_struct.periph_addr  = (uint32_t)&CRC_DATA;
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = crc_dma.byte_wide ? DMA_PERIPHERAL_WIDTH_8BIT : DMA_PERIPHERAL_WIDTH_32BIT;
+    dma_init_struct.priority     = DMA_PRIORITY_LOW;
+    dma_init(DMA_SPL_ARGS(ch), &dma_init_struct);
+    dma_circulation_disable(DMA_SPL_ARGS(ch));
+    dma_memory_to_memory_enable(DMA_SPL_ARGS(ch));
+    dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_FTF);
+    dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_ERR);
+
+    crc_dma.next += crc_dma.byte_wide ? units : 4U * units;
+    crc_dma.units -= units;
+    dma_channel_enable(DMA_SPL_ARGS(ch));
+}
+
+static void crc_dma_irq(void *arg, uint32_t flags)
+{
+    crc_calc_t *calc = (crc_calc_t *)arg;
+    crc_callback_t callback;
+
+    if ((flags & (DMA_CALLBACK_FLAG_FTF | DMA_CALLBACK_FLAG_ERR)) == 0U) {
+        return;
+    }
+    dma_channel_disable(DMA_SPL_ARGS(&crc_dma.ch));
+    if (((flags & DMA_CALLBACK_FLAG_ERR) == 0U) && (crc_dma.units > 0U)) {
+        crc_dma_next();
+        return;
+    }
+    crc_write_bytes(calc, crc_dma.next, crc_dma.tail);
+    dma_channel_detach_irq(&crc_dma.ch);
+    dma_channel_release(&crc_dma.ch, &crc_dma);
+    callback = crc_dma.callback;
+    crc_dma.busy = false;
+    if (callback != NULL) {
+        callback(crc_dma.arg);
+    }
+}
+#endif
+
+/*!
+    \brief      feed bytes into the calculation by memory-to-memory DMA
+    \param[in]  calc: state of the calculation, must stay valid until callback
+    \param[in]  data: the bytes, any alignment, must stay valid until callback
+    \param[in]  length: number of bytes
+    \param[in]  callback: called from the DMA interrupt once all bytes went in, may be NULL
+    \param[in]  arg: passed through to callback
+    \param[out] none
+    \retval     false if the unit has no input reversal or no DMA channel is idle, nothing was fed then
+*/
+bool crc_calc_update_dma(crc_calc_t *calc, const void *data, size_t length,
+                         crc_callback_t callback, void *arg)
+{
+#if defined(CRC_HAS_REVERSE)
+    const uint8_t *p = (const uint8_t *)data;
+    size_t head;
+
+    crc_wait();
+    if (!dma_channel_claim_free(&crc_dma.ch, &crc_dma)) {
+        return false;
+    }
+    crc_dma.callback = callback;
+    crc_dma.arg = arg;
+    crc_dma.busy = true;
+    if (calc->reflect) {
+        /* words in memory order, see crc_calc_update(), the unaligned ends by the CPU */
+        head = (4U - ((uint32_t)p & 3U)) & 3U;
+        if (head > length) {
+            head = length;
+        }
+        crc_write_bytes(calc, p, head);
+        crc_input_reverse(calc, CRC_INPUT_DATA_WORD);
+        crc_dma.byte_wide = false;
+        crc_dma.next = p + head;
+        crc_dma.units = (length - head) / 4U;
+        crc_dma.tail = (length - head) % 4U;
+    } else {
+        /* words would need their bytes swapped, bytes go in as they are */
+        crc_input_reverse(calc, CRC_INPUT_DATA_NOT);
+        crc_dma.byte_wide = true;
+        crc_dma.next = p;
+        crc_dma.units = length;
+        crc_dma.tail = 0U;
+    }
+    if (crc_dma.units == 0U) {
+        crc_write_bytes(calc, crc_dma.next, crc_dma.tail);
+        dma_channel_release(&crc_dma.ch, &crc_dma);
+        crc_dma.busy = false;
+        if (callback != NULL) {
+            callback(arg);
+        }
+        return true;
+    }
+    dma_channel_clock_enable(&crc_dma.ch);
+    dma_channel_attach_irq(&crc_dma.ch, crc_dma_irq, calc, IRQ_LEVEL(IRQ_PRIO_CRC));
+    crc_dma_next();
+    return true;
+#else
+    (void)calc;
+    (void)data;
+    (void)length;
+    (void)callback;
+    (void)arg;
+    return false;
+#endif
+}
+
+/*!
+    \brief      check whether a DMA feed is running
+    \param[in]  none
+    \param[out] none
+    \retval     true until the callback of crc_calc_update_dma() is called
+*/
+bool crc_calc_busy(void)
+{
+#if defined(CRC_HAS_REVERSE)
+    return crc_dma.busy;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,73 @@
+#ifndef _GD32_CRC_H_
+#define _GD32_CRC_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "gd32xxyy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The CRC calculation unit. Every series computes CRC-32 (polynomial
+ * 0x04C11DB7) over 32-bit words written to CRC_DATA, most significant bit
+ * first. Beyond that the units differ:
+ *
+ * - GD32F3x0, GD32E23x and GD32E50x take any 7, 8, 16 or 32 bit polynomial
+ *   and initial value, and can bit-reverse input and output.
+ * - GD32F1x0 has the fixed polynomial, but the initial value and the
+ *   reversal as well.
+ * - GD32F30x only has the fixed polynomial and initial value 0xFFFFFFFF.
+ *
+ * Units with input reversal also take byte writes, so any buffer goes
+ * through the hardware. GD32F30x gets each word bit- or byte-swapped by the
+ * CPU first (one instruction), and the up to three bytes that don't fill a
+ * word are folded in by software when the value is read.
+ *
+ * A reflected CRC (reflect true) processes every byte least significant bit
+ * first and reverses the result, like the common CRC-32 of zlib, Ethernet and
+ * PNG; otherwise bytes go most significant bit first, like CRC-32/MPEG-2.
+ *
+ * There is only one unit: a calculation lasts from crc_calc_begin() to the
+ * last crc_calc_value(), and another one started in between takes it over.
+ */
+#if defined(CRC_POLY)
+#define CRC_HAS_POLYNOMIAL      1
+#endif
+#if defined(CRC_CTL_REV_I)
+#define CRC_HAS_REVERSE         1
+#endif
+
+#define CRC32_POLYNOMIAL        0x04C11DB7U
+
+typedef struct {
+    uint32_t polynomial;
+    uint32_t init;
+    uint32_t xor_out;
+    uint8_t width;              /* 7, 8, 16 or 32 bits */
+    bool reflect;
+    uint8_t pending;            /* bytes waiting for a whole word, GD32F30x only */
+    uint8_t pending_data[4];
+} crc_calc_t;
+
+typedef void (*crc_callback_t)(void *arg);
+
+/* false if the unit can't compute this CRC */
+bool crc_calc_begin(crc_calc_t *calc, uint32_t polynomial, uint8_t width, uint32_t init,
+                    bool reflect, uint32_t xor_out);
+void crc_calc_update(crc_calc_t *calc, const void *data, size_t length);
+uint32_t crc_calc_value(const crc_calc_t *calc);
+/* feed by memory-to-memory DMA, callback(arg) from the DMA interrupt when done;
+   false if the unit has no input reversal or no DMA channel is idle */
+bool crc_calc_update_dma(crc_calc_t *calc, const void *data, size_t length,
+                         crc_callback_t callback, void *arg);
+/* true while a DMA feed runs, crc_calc_update() and crc_calc_value() wait for it */
+bool crc_calc_busy(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_CRC_H_ */
@@ -0,0 +1,97 @@
+#ifndef _GD32_CRITICAL_H_
+#define _GD32_CRITICAL_H_
+
+#include <stdint.h>
+#include "gd32xxyy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Critical sections of the core drivers. critical_enter() masks the
+ * interrupts of priority CRITICAL_BASEPRI and below through BASEPRI, so
+ * an interrupt set to a more urgent priority still preempts the drivers
+ * with its full latency; critical_exit() puts back what was masked
+ * before, so sections nest.
+ *
+ *   uint32_t state = critical_enter();
+ *   ...
+ *   critical_exit(state);
+ *
+ * CRITICAL_BASEPRI is an 8 bit priority as written to BASEPRI, the same
+ * kind serial_set_irq_priority() takes. The default leaves the most
+ * urgent level, NVIC_SetPriority(irq, 0), to the sketch. Every interrupt
+ * the core sets up is kept at CRITICAL_BASEPRI or below (less urgent),
+ * critical_irq_clamp(), so the sections still keep out all of them; an
+ * interrupt above it must not call into the core, except for
+ * deferred_post(), which masks everything and hands work to thread level.
+ * 0 makes the sections mask all interrupts, like noInterrupts().
+ *
+ * Cortex-M23 (GD32E23x) has no BASEPRI, its sections always mask all
+ * interrupts. BASEPRI compares preemption priorities only, which with
+ * the grouping irq_priority_init() sets are all the priority bits.
+ */
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+#define CRITICAL_HAS_BASEPRI    1
+#else
+#define CRITICAL_HAS_BASEPRI    0
+#endif
+
+#ifndef CRITICAL_BASEPRI
+#define CRITICAL_BASEPRI        (1U << (8U - __NVIC_PRIO_BITS))
+#endif
+
+#if CRITICAL_HAS_BASEPRI && (CRITICAL_BASEPRI != 0)
+
+static inline uint32_t critical_enter(void)
+{
+    uint32_t state;
+
+    __ASM volatile("mrs %0, basepri" : "=r"(state));
+    /* only ever raises the mask, a section inside a stricter one keeps that */
+    __ASM volatile("msr basepri_max, %0" : : "r"((uint32_t)CRITICAL_BASEPRI) : "memory");
+    __ISB();
+    return state;
+}
+
+static inline void critical_exit(uint32_t state)
+{
+    __ASM volatile("msr basepri, %0" : : "r"(state) : "memory");
+}
+
+/* move an interrupt the core set up below CRITICAL_BASEPRI if it is more urgent */
+static inline void critical_irq_clamp(IRQn_Type irq)
+{
+    if (NVIC_GetPriority(irq) < (CRITICAL_BASEPRI >> (8U - __NVIC_PRIO_BITS))) {
+        NVIC_SetPriority(irq, CRITICAL_BASEPRI >> (8U - __NVIC_PRIO_BITS));
+    }
+}
+
+#else
+
+static inline uint32_t critical_enter(void)
+{
+    uint32_t state = __get_PRIMASK();
+
+    __disable_irq();
+    return state;
+}
+
+static inline void critical_exit(uint32_t state)
+{
+    __set_PRIMASK(state);
+}
+
+static inline void critical_irq_clamp(IRQn_Type irq)
+{
+    (void)irq;
+}
+
+#endif /* CRITICAL_HAS_BASEPRI */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_CRITICAL_H_ */
@@ -0,0 +1,81 @@
+#include "deferred.h"
+#include "gd32xxyy.h"
+
+typedef struct {
+    deferred_func_t func;
+    void *arg;
+} deferred_call_t;
+
+static deferred_call_t deferred_queue[DEFERRED_QUEUE_SIZE];
+/* free running, the queue holds head - tail calls */
+static volatile uint32_t deferred_head;
+static volatile uint32_t deferred_tail;
+static volatile uint32_t deferred_drops;
+
+void noDeferredSignal() {}
+void deferred_signal(void) __attribute__((weak, alias("noDeferredSignal")));
+
+/* posts come from interrupts of any priority, and so does the queue
+ * get run from more than one task under an RTOS; both sides take their
+ * slot with interrupts masked */
+bool deferred_post(deferred_func_t func, void *arg)
+{
+    uint32_t primask = __get_PRIMASK();
+    bool posted = false;
+
+    __disable_irq();
+    if (deferred_head - deferred_tail < DEFERRED_QUEUE_SIZE) {
+        deferred_call_t *call = &deferred_queue[deferred_head % DEFERRED_QUEUE_SIZE];
+        call->func = func;
+        call->arg = arg;
+        deferred_head++;
+        posted = true;
+    } else {
+        deferred_drops++;
+    }
+    __set_PRIMASK(primask);
+
+    if (posted) {
+        deferred_signal();
+    }
+    return posted;
+}
+
+static void deferred_call_void(void *arg)
+{
+    ((void (*)(void))arg)();
+}
+
+bool deferred_post_call(void (*func)(void))
+{
+    return deferred_post(deferred_call_void, (void *)func);
+}
+
+void deferred_run(void)
+{
+    for (;;) {
+        uint32_t primask = __get_PRIMASK();
+        deferred_call_t call;
+
+        __disable_irq();
+        if (deferred_head == deferred_tail) {
+            __set_PRIMASK(primask);
+            return;
+        }
+        call = deferred_queue[deferred_tail % DEFERRED_QUEUE_SIZE];
+        deferred_tail++;
+        __set_PRIMASK(primask);
+
+        call.func(call.arg);
+    }
+}
+
+bool deferred_pending(void)
+{
+    return deferred_head != deferred_tail;
+}
+
+uint32_t deferred_dropped(void)
+{
+    return deferred_drops;
+}
@@ -0,0 +1,42 @@
+#ifndef _GD32_DEFERRED_H_
+#define _GD32_DEFERRED_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Work an interrupt hands over to thread level. ‘deferred_post’ queues
+ * a call from any interrupt (or from thread level), ‘deferred_run’ makes
+ * the queued calls in the order they were posted. main() runs the queue
+ * after every loop(); a sketch that blocks for long can call it itself.
+ *
+ * After each post ‘deferred_signal’ is called, from the posting context.
+ * It does nothing by default; an RTOS can replace it to have the queue
+ * run by one of its tasks instead.
+ *
+ * The queue holds DEFERRED_QUEUE_SIZE calls. A post that finds it full
+ * is dropped, and counted in ‘deferred_dropped’.
+ */
+#ifndef DEFERRED_QUEUE_SIZE
+#define DEFERRED_QUEUE_SIZE 16
+#endif
+
+typedef void (*deferred_func_t)(void *arg);
+
+bool deferred_post(deferred_func_t func, void *arg);
+/* post a call to a function without argument */
+bool deferred_post_call(void (*func)(void));
+void deferred_run(void);
+bool deferred_pending(void);
+uint32_t deferred_dropped(void);
+void deferred_signal(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_DEFERRED_H_ */
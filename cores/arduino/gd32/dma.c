@@ -0,0 +1,356 @@
+#include "dma.h"
+#include "critical.h"
+#include "irq_profile.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(DMA0)
+#define DMA_INTF_REG(periph)    DMA_INTF(periph)
+#define DMA_INTC_REG(periph)    DMA_INTC(periph)
+#else
+#define DMA_INTF_REG(periph)    DMA_INTF
+#define DMA_INTC_REG(periph)    DMA_INTC
+#endif
+
+/* channel flags GIF/FTFIF/HTFIF/ERRIF occupy 4 bits per channel */
+#define DMA_CHANNEL_FLAGS_MASK  (0x0FU)
+
+typedef struct {
+    dma_callback_t callback;
+    void *arg;
+} dma_irq_infor_t;
+
+static dma_irq_infor_t dma_irq_infor[DMA_CHANNEL_NUM] = {{NULL, NULL}};
+/* who claimed each channel, same index as dma_irq_infor */
+static const void *dma_owner[DMA_CHANNEL_NUM] = {NULL};
+
+/* NVIC line of every channel, index is (DMA1 ? DMA_CHANNELS_PER_PERIPH : 0) + channel */
+static const IRQn_Type dma_irq_n[DMA_CHANNEL_NUM] = {
+#if defined(DMA0)
+    DMA0_Channel0_IRQn,
+    DMA0_Channel1_IRQn,
+    DMA0_Channel2_IRQn,
+    DMA0_Channel3_IRQn,
+    DMA0_Channel4_IRQn,
+    DMA0_Channel5_IRQn,
+    DMA0_Channel6_IRQn,
+#if DMA_CHANNEL_NUM > DMA_CHANNELS_PER_PERIPH
+    DMA1_Channel0_IRQn,
+    DMA1_Channel1_IRQn,
+    DMA1_Channel2_IRQn,
+#if defined(GD32F30X_CL) || defined(GD32F10X_CL) || defined(GD32E50X_CL) || defined(GD32E508)
+    DMA1_Channel3_IRQn,
+    DMA1_Channel4_IRQn
+#else
+    DMA1_Channel3_Channel4_IRQn,
+    DMA1_Channel3_Channel4_IRQn
+#endif
+#endif
+#else
+    DMA_Channel0_IRQn,
+    DMA_Channel1_2_IRQn,
+    DMA_Channel1_2_IRQn,
+    DMA_Channel3_4_IRQn,
+    DMA_Channel3_4_IRQn,
+#if DMA_CHANNELS_PER_PERIPH > 5
+    DMA_Channel5_6_IRQn,
+    DMA_Channel5_6_IRQn
+#endif
+#endif
+};
+
+static uint32_t dma_channel_index(const dma_channel_t *ch)
+{
+#if DMA_CHANNEL_NUM > DMA_CHANNELS_PER_PERIPH
+    if (ch->periph == DMA1) {
+        return DMA_CHANNELS_PER_PERIPH + (uint32_t)ch->channel;
+    }
+#endif
+    return (uint32_t)ch->channel;
+}
+
+/** Claim a channel for a driver
+ *
+ * @param ch    The DMA channel
+ * @param owner Identifies the driver instance, must not be NULL
+ * @return      Non-zero if the channel was free and is now held by owner
+ */
+int dma_channel_claim(const dma_channel_t *ch, const void *owner)
+{
+    uint32_t index = dma_channel_index(ch);
+    uint32_t state;
+    int claimed = 0;
+
+    state = critical_enter();
+    if (dma_owner[index] == NULL) {
+        dma_owner[index] = owner;
+        claimed = 1;
+    }
+    critical_exit(state);
+    return claimed;
+}
+
+/** Give a claimed channel back
+ *
+ * @param ch    The DMA channel
+ * @param owner The owner passed to dma_channel_claim()
+ */
+void dma_channel_release(const dma_channel_t *ch, const void *owner)
+{
+    uint32_t index = dma_channel_index(ch);
+    uint32_t state = critical_enter();
+    if (dma_owner[index] == owner) {
+        dma_owner[index] = NULL;
+    }
+    critical_exit(state);
+}
+
+/** Claim any channel that is idle, starting from the last one
+ *
+ * Memory-to-memory transfers run on any channel; the last channels of a
+ * controller carry the fewest peripheral requests the core uses.
+ *
+ * @param ch    Filled in with the channel claimed
+ * @param owner Identifies the driver instance, must not be NULL
+ * @return      Non-zero if a channel was claimed
+ */
+int dma_channel_claim_free(dma_channel_t *ch, const void *owner)
+{
+    dma_channel_t candidate;
+    uint32_t index = DMA_CHANNEL_NUM;
+
+    while (index-- > 0U) {
+#if DMA_CHANNEL_NUM > DMA_CHANNELS_PER_PERIPH
+        candidate.periph = (index >= DMA_CHANNELS_PER_PERIPH) ? DMA1 : DMA0;
+        candidate.channel = (dma_channel_enum)(index % DMA_CHANNELS_PER_PERIPH);
+#elif defined(DMA0)
+        candidate.periph = DMA0;
+        candidate.channel = (dma_channel_enum)index;
+#else
+        candidate.periph = DMA;
+        candidate.channel = (dma_channel_enum)index;
+#endif
+        /* a channel enabled without a claim was set up by the sketch itself */
+        if (!dma_channel_is_enabled(&candidate) && dma_channel_claim(&candidate, owner)) {
+            *ch = candidate;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/** Get the owner of a channel
+ *
+ * @param ch The DMA channel
+ * @return   The owner holding the channel, NULL if it is free
+ */
+const void *dma_channel_owner(const dma_channel_t *ch)
+{
+    return dma_owner[dma_channel_index(ch)];
+}
+
+/** Enable the clock of the DMA controller serving this channel
+ *
+ * @param ch The DMA channel
+ */
+void dma_channel_clock_enable(const dma_channel_t *ch)
+{
+#if DMA_CHANNEL_NUM > DMA_CHANNELS_PER_PERIPH
+    rcu_periph_clock_enable((ch->periph == DMA1) ? RCU_DMA1 : RCU_DMA0);
+#elif defined(DMA0)
+    (void)ch;
+    rcu_periph_clock_enable(RCU_DMA0);
+#else
+    (void)ch;
+    rcu_periph_clock_enable(RCU_DMA);
+#endif
+}
+
+/** Route the channel interrupt to a callback and enable it in the NVIC
+ *
+ * @param ch       The DMA channel
+ * @param callback Called from the DMA interrupt with the channel flags that were set
+ * @param arg      Passed through to the callback
+ * @param priority NVIC priority of the channel interrupt
+ */
+void dma_channel_attach_irq(const dma_channel_t *ch, dma_callback_t callback, void *arg,
+                            uint8_t priority)
+{
+    uint32_t index = dma_channel_index(ch);
+    IRQn_Type irq = dma_irq_n[index];
+
+    dma_irq_infor[index].arg = arg;
+    dma_irq_infor[index].callback = callback;
+
+    NVIC_ClearPendingIRQ(irq);
+    NVIC_SetPriority(irq, priority);
+    critical_irq_clamp(irq);
+    NVIC_EnableIRQ(irq);
+}
+
+/** Remove the channel callback
+ *
+ * @param ch The DMA channel
+ */
+void dma_channel_detach_irq(const dma_channel_t *ch)
+{
+    uint32_t index = dma_channel_index(ch);
+
+    dma_irq_infor[index].callback = NULL;
+    dma_irq_infor[index].arg = NULL;
+}
+
+/** Check whether a channel is currently enabled
+ *
+ * @param ch The DMA channel
+ * @return   Non-zero if the channel enable bit is set
+ */
+int dma_channel_is_enabled(const dma_channel_t *ch)
+{
+#if defined(DMA0)
+    return (DMA_CHCTL(ch->periph, ch->channel) & DMA_CHXCTL_CHEN) != 0U;
+#else
+    return (DMA_CHCTL(ch->channel) & DMA_CHXCTL_CHEN) != 0U;
+#endif
+}
+
+/** Clear the flags of one channel and hand them to its callback
+ *
+ * @param periph  The DMA controller
+ * @param channel The channel number on that controller
+ * @param index   The slot in dma_irq_infor
+ */
+static void dma_channel_irq(uint32_t periph, uint32_t channel, uint32_t index)
+{
+    uint32_t shift = channel * 4U;
+    uint32_t flags = (DMA_INTF_REG(periph) >> shift) & DMA_CHANNEL_FLAGS_MASK;
+
+    (void)periph;
+    if (flags == 0U) {
+        return;
+    }
+    DMA_INTC_REG(periph) = (flags << shift);
+    if (dma_irq_infor[index].callback != NULL) {
+        dma_irq_infor[index].callback(dma_irq_infor[index].arg, flags);
+    }
+}
+
+#if defined(DMA0)
+__attribute__((used)) void DMA0_Channel0_IRQHandler(void)
+{
+    IRQ_PROFILE();
+    dma_channel_irq(DMA0, 0U, 0U);
+}
+
+__attribute__((used)) void DMA0_Channel1_IRQHandler(void)
+{
+    IRQ_PROFILE();
+    dma_channel_irq(DMA0, 1U, 1U);
+}
+
+__attribute__((used)) void DMA0_Channel2_IRQHandler(void)
+{
+    IRQ_PROFILE();
+    dma_channel_irq(DMA0, 2U, 2U);
+}
+
+__attribute__((used)) void DMA0_Channel3_IRQHandler(void)
+{
+    IRQ_PROFILE();
+    dma_channel_irq(DMA0, 3U, 3U);
+}
+
+__attribute__((used)) void DMA0_Channel4_IRQHandler(void)
+{
+    IRQ_PROFILE();
+    dma_channel_irq(DMA0, 4U, 4U);
+}
+
+__attribute__((used)) void DMA0_Channel5_IRQHandler(void)
+{
+    IRQ_PROFILE();
+    dma_channel_irq(DMA0, 5U, 5U);
+}
+
+__attribute__((used)) void DMA0_Channel6_IRQHandler(void)
+{
+    IRQ_PROFILE();
+    dma_channel_irq(DMA0, 6U, 6U);
+}
+
+#if DMA_CHANNEL_NUM > DMA_CHANNELS_PER_PERIPH
+__attribute__((used)) void DMA1_Channel0_IRQHandler(void)
+{
+    IRQ_PROFILE();
+    dma_channel_irq(DMA1, 0U, DMA_CHANNELS_PER_PERIPH + 0U);
+}
+
+__attribute__((used)) void DMA1_Channel1_IRQHandler(void)
+{
+    IRQ_PROFILE();
+    dma_channel_irq(DMA1, 1U, DMA_CHANNELS_PER_PERIPH + 1U);
+}
+
+__attribute__((used)) void DMA1_Channel2_IRQHandler(void)
+{
+    IRQ_PROFILE();
+    dma_channel_irq(DMA1, 2U, DMA_CHANNELS_PER_PERIPH + 2U);
+}
+
+#if defined(GD32F30X_CL) || defined(GD32F10X_CL) || defined(GD32E50X_CL) || defined(GD32E508)
+__attribute__((used)) void DMA1_Channel3_IRQHandler(void)
+{
+    IRQ_PROFILE();
+    dma_channel_irq(DMA1, 3U, DMA_CHANNELS_PER_PERIPH + 3U);
+}
+
+__attribute__((used)) void DMA1_Channel4_IRQHandler(void)
+{
+    IRQ_PROFILE();
+    dma_channel_irq(DMA1, 4U, DMA_CHANNELS_PER_PERIPH + 4U);
+}
+#else
+__attribute__((used)) void DMA1_Channel3_4_IRQHandler(void)
+{
+    IRQ_PROFILE();
+    dma_channel_irq(DMA1, 3U, DMA_CHANNELS_PER_PERIPH + 3U);
+    dma_channel_irq(DMA1, 4U, DMA_CHANNELS_PER_PERIPH + 4U);
+}
+#endif
+#endif
+#else
+__attribute__((used)) void DMA_Channel0_IRQHandler(void)
+{
+    IRQ_PROFILE();
+    dma_channel_irq(DMA, 0U, 0U);
+}
+
+__attribute__((used)) void DMA_Channel1_2_IRQHandler(void)
+{
+    IRQ_PROFILE();
+    dma_channel_irq(DMA, 1U, 1U);
+    dma_channel_irq(DMA, 2U, 2U);
+}
+
+__attribute__((used)) void DMA_Channel3_4_IRQHandler(void)
+{
+    IRQ_PROFILE();
+    dma_channel_irq(DMA, 3U, 3U);
+    dma_channel_irq(DMA, 4U, 4U);
+}
+
+#if DMA_CHANNELS_PER_PERIPH > 5
+__attribute__((used)) void DMA_Channel5_6_IRQHandler(void)
+{
+    IRQ_PROFILE();
+    dma_channel_irq(DMA, 5U, 5U);
+    dma_channel_irq(DMA, 6U, 6U);
+}
+#endif
+#endif
+
+#ifdef __cplusplus
+}
+#endif
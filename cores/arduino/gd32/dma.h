@@ -0,0 +1,79 @@
+#ifndef _GD32_DMA_H_
+#define _GD32_DMA_H_
+
+#include <stddef.h>
+#include "gd32xxyy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The dual-controller parts (GD32F30x, GD32F10x, GD32E50x) take the DMA
+ * peripheral as the first argument of every SPL call, the single-controller
+ * parts (GD32F3x0, GD32F1x0, GD32E23x) do not. DMA_SPL_ARGS expands a
+ * dma_channel_t into whatever argument list the SPL of the current series
+ * expects, so drivers can write e.g. dma_channel_enable(DMA_SPL_ARGS(&ch)).
+ */
+#if defined(DMA0)
+#define DMA_SPL_ARGS(ch)        (ch)->periph, (ch)->channel
+#define DMA_CHANNELS_PER_PERIPH 7
+#if defined(GD32F10X_MD)
+#define DMA_CHANNEL_NUM         7
+#else
+#define DMA_CHANNEL_NUM         12
+#endif
+#else
+#define DMA_SPL_ARGS(ch)        (ch)->channel
+#if defined(GD32E23x)
+#define DMA_CHANNELS_PER_PERIPH 5
+#else
+#define DMA_CHANNELS_PER_PERIPH 7
+#endif
+#define DMA_CHANNEL_NUM         DMA_CHANNELS_PER_PERIPH
+#endif
+
+/* Channel interrupt flags handed to the callback (same bit layout as DMA_INTF >> channel * 4) */
+#define DMA_CALLBACK_FLAG_FTF   DMA_INTF_FTFIF
+#define DMA_CALLBACK_FLAG_HTF   DMA_INTF_HTFIF
+#define DMA_CALLBACK_FLAG_ERR   DMA_INTF_ERRIF
+
+typedef struct {
+    uint32_t periph;            /* DMA0/DMA1, or DMA on single-controller parts */
+    dma_channel_enum channel;
+} dma_channel_t;
+
+typedef void (*dma_callback_t)(void *arg, uint32_t flags);
+
+/*
+ * A channel serves several peripheral requests (the request map of every
+ * series is fixed in silicon, each driver keeps the part it uses), so two
+ * drivers can want the same channel. A driver claims the channel before it
+ * programs it and releases it once it is done; a claim fails while someone
+ * else holds the channel, and the driver then falls back or reports failure
+ * instead of reprogramming a transfer that is still running. The owner is
+ * any pointer that identifies the driver instance, e.g. its state object.
+ */
+/* Non-zero if the channel was free and now belongs to owner. */
+int dma_channel_claim(const dma_channel_t *ch, const void *owner);
+/* Give the channel back, nothing happens unless owner holds it. */
+void dma_channel_release(const dma_channel_t *ch, const void *owner);
+/* Claim any idle channel into *ch, for memory-to-memory transfers that need no request line. */
+int dma_channel_claim_free(dma_channel_t *ch, const void *owner);
+/* The owner holding the channel, NULL if it is free. */
+const void *dma_channel_owner(const dma_channel_t *ch);
+/* Enable the clock of the DMA controller serving this channel. */
+void dma_channel_clock_enable(const dma_channel_t *ch);
+/* Route the channel interrupt to callback(arg, flags) and enable it in the NVIC. */
+void dma_channel_attach_irq(const dma_channel_t *ch, dma_callback_t callback, void *arg,
+                            uint8_t priority);
+/* Non-zero while the channel is enabled, i.e. some driver owns it. */
+int dma_channel_is_enabled(const dma_channel_t *ch);
+/* Remove the channel callback. The NVIC line is left alone since it may be shared. */
+void dma_channel_detach_irq(const dma_channel_t *ch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_DMA_H_ */
@@ -0,0 +1,244 @@
+#include <stdbool.h>
+#include <string.h>
+#include "dma_copy.h"
+#include "dma.h"
+#include "irq_priority.h"
+
+/* async transfers running at the same time */
+#ifndef DMA_COPY_SLOTS
+#define DMA_COPY_SLOTS          2
+#endif
+/* most units one DMA transfer moves */
+#define DMA_COPY_MAX_UNITS      0xFFFFU
+
+typedef struct {
+    dma_channel_t ch;
+    uint32_t dst;
+    uint32_t src;               /* &fill for a memset */
+    bool src_inc;
+    size_t units;               /* left to start */
+    uint8_t shift;              /* log2 of the unit size */
+    uint32_t fill;
+    dma_copy_callback_t callback;
+    void *arg;
+    volatile bool busy;
+} dma_copy_t;
+
+static dma_copy_t dma_copy_slot[DMA_COPY_SLOTS];
+
+/* the widest unit the addresses and the length are all aligned to */
+static uint8_t dma_copy_shift(uint32_t dst, uint32_t src, size_t length)
+{
+    uint32_t bits = dst | src | (uint32_t)length;
+
+    if ((bits & 3U) == 0U) {
+        return 2U;
+    }
+    if ((bits & 1U) == 0U) {
+        return 1U;
+    }
+    return 0U;
+}
+
+/* set the copy up and claim a channel for it, owner is the copy itself */
+static bool dma_copy_prepare(dma_copy_t *copy, void *dst, const void *src, uint8_t value, size_t length)
+{
+    if (!dma_channel_claim_free(&copy->ch, copy)) {
+        return false;
+    }
+    copy->fill = value * 0x01010101U;
+    copy->src_inc = (src != NULL);
+    copy->dst = (uint32_t)dst;
+    copy->src = copy->src_inc ? (uint32_t)src : (uint32_t)&copy->fill;
+    copy->shift = dma_copy_shift(copy->dst, copy->src, length);
+    copy->units = length >> copy->shift;
+    dma_channel_clock_enable(&copy->ch);
+    return true;
+}
+
+/* start the next transfer, at most DMA_COPY_MAX_UNITS of what is left */
+static void dma_copy_next(dma_copy_t *copy)
+{
+    static const uint32_t memory_width[] = {
+        DMA_MEMORY_WIDTH_8BIT, DMA_MEMORY_WIDTH_16BIT, DMA_MEMORY_WIDTH_32BIT
+    };
+    static const uint32_t periph_width[] = {
+        DMA_PERIPHERAL_WIDTH_8BIT, DMA_PERIPHERAL_WIDTH_16BIT, DMA_PERIPHERAL_WIDTH_32BIT
+    };
+    dma_parameter_struct dma_init_struct;
+    size_t units = (copy->units > DMA_COPY_MAX_UNITS) ? DMA_COPY_MAX_UNITS : copy->units;
+    dma_channel_t *ch = &copy->ch;
+
+    /* in memory-to-memory mode the "memory" side is read and the "peripheral" side written */
+    dma_deinit(DMA_SPL_ARGS(ch));
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.direction    = DMA_MEMORY_TO_PERIPHERAL;
+    dma_init_struct.memory_addr  = copy->src;
+    dma_init_struct.memory_inc   = copy->src_inc ? DMA_MEMORY_INCREASE_ENABLE : DMA_MEMORY_INCREASE_DISABLE;
+    dma_init_struct.memory_width = memory_width[copy->shift];
+    dma_init_struct.number       = units;
+    dma_init_struct.periph_addr  = copy->dst;
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_ENABLE;
+    dma_init_struct.periph_width = periph_width[copy->shift];
+    dma_init_struct.priority     = DMA_PRIORITY_LOW;
+    dma_init(DMA_SPL_ARGS(ch), &dma_init_struct);
+    dma_circulation_disable(DMA_SPL_ARGS(ch));
+    dma_memory_to_memory_enable(DMA_SPL_ARGS(ch));
+
+    copy->dst += units << copy->shift;
+    if (copy->src_inc) {
+        copy->src += units << copy->shift;
+    }
+    copy->units -= units;
+    dma_channel_enable(DMA_SPL_ARGS(ch));
+}
+
+static void dma_copy_irq(void *arg, uint32_t flags)
+{
+    dma_copy_t *copy = (dma_copy_t *)arg;
+
+    if ((flags & (DMA_CALLBACK_FLAG_FTF | DMA_CALLBACK_FLAG_ERR)) == 0U) {
+        return;
+    }
+    dma_channel_disable(DMA_SPL_ARGS(&copy->ch));
+    if (((flags & DMA_CALLBACK_FLAG_ERR) == 0U) && (copy->units > 0U)) {
+        dma_copy_next(copy);
+        dma_interrupt_enable(DMA_SPL_ARGS(&copy->ch), DMA_INT_FTF);
+        dma_interrupt_enable(DMA_SPL_ARGS(&copy->ch), DMA_INT_ERR);
+        return;
+    }
+    dma_channel_detach_irq(&copy->ch);
+    dma_channel_release(&copy->ch, copy);
+    copy->busy = false;
+    if (copy->callback != NULL) {
+        copy->callback(copy->arg);
+    }
+}
+
+/* take an idle slot, NULL if all are running */
+static dma_copy_t *dma_copy_slot_get(void)
+{
+    uint32_t state;
+    dma_copy_t *copy = NULL;
+    uint8_t i;
+
+    state = critical_enter();
+    for (i = 0U; i < DMA_COPY_SLOTS; i++) {
+        if (!dma_copy_slot[i].busy) {
+            copy = &dma_copy_slot[i];
+            copy->busy = true;
+            break;
+        }
+    }
+    critical_exit(state);
+    return copy;
+}
+
+static uint8_t dma_copy_start(void *dst, const void *src, uint8_t value, size_t length,
+                              dma_copy_callback_t callback, void *arg)
+{
+    dma_copy_t *copy;
+
+    if (length == 0U) {
+        if (callback != NULL) {
+            callback(arg);
+        }
+        return 1;
+    }
+    copy = dma_copy_slot_get();
+    if (copy == NULL) {
+        return 0;
+    }
+    if (!dma_copy_prepare(copy, dst, src, value, length)) {
+        copy->busy = false;
+        return 0;
+    }
+    copy->callback = callback;
+    copy->arg = arg;
+    dma_channel_attach_irq(&copy->ch, dma_copy_irq, copy, IRQ_LEVEL(IRQ_PRIO_DMA_COPY));
+    dma_copy_next(copy);
+    dma_interrupt_enable(DMA_SPL_ARGS(&copy->ch), DMA_INT_FTF);
+    dma_interrupt_enable(DMA_SPL_ARGS(&copy->ch), DMA_INT_ERR);
+    return 1;
+}
+
+/* run the whole copy on the calling thread, polling the channel */
+static bool dma_copy_run(void *dst, const void *src, uint8_t value, size_t length)
+{
+    dma_copy_t copy;
+
+    if ((length < DMA_COPY_MIN_LENGTH) || !dma_copy_prepare(&copy, dst, src, value, length)) {
+        return false;
+    }
+    while (copy.units > 0U) {
+        dma_copy_next(&copy);
+        while ((RESET == dma_flag_get(DMA_SPL_ARGS(&copy.ch), DMA_FLAG_FTF))
+                && (RESET == dma_flag_get(DMA_SPL_ARGS(&copy.ch), DMA_FLAG_ERR))) {
+        }
+        dma_channel_disable(DMA_SPL_ARGS(&copy.ch));
+    }
+    dma_channel_release(&copy.ch, &copy);
+    return true;
+}
+
+/*!
+    \brief      start copying memory by DMA
+    \param[in]  dst: destination, must not overlap src
+    \param[in]  src: source
+    \param[in]  length: number of bytes
+    \param[in]  callback: called from the DMA interrupt once the copy is done, may be NULL
+    \param[in]  arg: passed through to callback
+    \param[out] none
+    \retval     1 if the copy runs, 0 if no DMA channel or slot is idle
+*/
+uint8_t dma_memcpy_async(void *dst, const void *src, size_t length,
+                         dma_copy_callback_t callback, void *arg)
+{
+    return dma_copy_start(dst, src, 0U, length, callback, arg);
+}
+
+/*!
+    \brief      start filling memory by DMA
+    \param[in]  dst: destination
+    \param[in]  value: byte written
+    \param[in]  length: number of bytes
+    \param[in]  callback: called from the DMA interrupt once the fill is done, may be NULL
+    \param[in]  arg: passed through to callback
+    \param[out] none
+    \retval     1 if the fill runs, 0 if no DMA channel or slot is idle
+*/
+uint8_t dma_memset_async(void *dst, uint8_t value, size_t length,
+                         dma_copy_callback_t callback, void *arg)
+{
+    return dma_copy_start(dst, NULL, value, length, callback, arg);
+}
+
+/*!
+    \brief      copy memory by DMA and wait for it, by the CPU if DMA doesn't pay off
+    \param[in]  dst: destination, must not overlap src
+    \param[in]  src: source
+    \param[in]  length: number of bytes
+    \param[out] none
+    \retval     none
+*/
+void dma_memcpy(void *dst, const void *src, size_t length)
+{
+    if (!dma_copy_run(dst, src, 0U, length)) {
+        memcpy(dst, src, length);
+    }
+}
+
+/*!
+    \brief      fill memory by DMA and wait for it, by the CPU if DMA doesn't pay off
+    \param[in]  dst: destination
+    \param[in]  value: byte written
+    \param[in]  length: number of bytes
+    \param[out] none
+    \retval     none
+*/
+void dma_memset(void *dst, uint8_t value, size_t length)
+{
+    if (!dma_copy_run(dst, NULL, value, length)) {
+        memset(dst, value, length);
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef _GD32_DMA_COPY_H_
+#define _GD32_DMA_COPY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * memcpy and memset by a DMA channel in memory-to-memory mode, on whatever
+ * channel is idle (see dma_channel_claim_free()). The transfer moves words
+ * when the addresses and the length allow it, otherwise half-words or bytes,
+ * at the lowest DMA priority so peripheral requests go first.
+ *
+ * The async calls return at once and call callback(arg) from the DMA
+ * interrupt when done; the buffers must stay valid and untouched until then.
+ * They return 0 when no channel is idle, the caller copies by itself then.
+ * The blocking calls poll the channel instead of taking its interrupt, so
+ * they also work with interrupts disabled, and fall back to the C library
+ * for short buffers or when no channel is idle.
+ */
+typedef void (*dma_copy_callback_t)(void *arg);
+
+/* below this many bytes the blocking calls leave it to the CPU */
+#define DMA_COPY_MIN_LENGTH     64U
+
+uint8_t dma_memcpy_async(void *dst, const void *src, size_t length,
+                         dma_copy_callback_t callback, void *arg);
+uint8_t dma_memset_async(void *dst, uint8_t value, size_t length,
+                         dma_copy_callback_t callback, void *arg);
+void dma_memcpy(void *dst, const void *src, size_t length);
+void dma_memset(void *dst, uint8_t value, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_DMA_COPY_H_ */
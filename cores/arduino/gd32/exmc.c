@@ -0,0 +1,176 @@
+#include "exmc.h"
+#include "PinNames.h"
+#include "pinmap.h"
+#include "variant.h"
+
+#if defined(EXMC_AVAILABLE)
+
+#define EXMC_ADDRESS_LINES      26U
+
+/* the EXMC pins are fixed, none can be remapped */
+static const PinName exmc_data_pins[16] = {
+    PORTD_14, PORTD_15, PORTD_0, PORTD_1, PORTE_7, PORTE_8, PORTE_9, PORTE_10,
+    PORTE_11, PORTE_12, PORTE_13, PORTE_14, PORTE_15, PORTD_8, PORTD_9, PORTD_10
+};
+static const PinName exmc_address_pins[EXMC_ADDRESS_LINES] = {
+    PORTF_0, PORTF_1, PORTF_2, PORTF_3, PORTF_4, PORTF_5, PORTF_12, PORTF_13,
+    PORTF_14, PORTF_15, PORTG_0, PORTG_1, PORTG_2, PORTG_3, PORTG_4, PORTG_5,
+    PORTD_11, PORTD_12, PORTD_13, PORTE_3, PORTE_4, PORTE_5, PORTE_6, PORTE_2,
+    PORTG_13, PORTG_14
+};
+static const PinName exmc_ne_pins[4] = {PORTD_7, PORTG_9, PORTG_10, PORTG_12};
+static const PinName exmc_control_pins[] = {PORTD_4, PORTD_5};          /* NOE, NWE */
+static const PinName exmc_byte_lane_pins[] = {PORTE_0, PORTE_1};        /* NBL0, NBL1 */
+
+static void exmc_pins(const PinName *pins, uint8_t count)
+{
+    uint8_t i;
+
+    for (i = 0U; i < count; i++) {
+        pin_function(pins[i], GD_PIN_FUNCTION1(PIN_MODE_AF_PP, 0));
+    }
+}
+
+/* HCLK cycles of at least ns, within min and max */
+static uint32_t exmc_cycles(uint16_t ns, uint32_t min, uint32_t max)
+{
+    uint32_t mhz = rcu_clock_freq_get(CK_AHB) / 1000000U;
+    uint32_t cycles = ((uint32_t)ns * mhz + 999U) / 1000U;
+
+    if (cycles < min) {
+        return min;
+    }
+    return (cycles > max) ? max : cycles;
+}
+
+static void exmc_timing(exmc_norsram_timing_parameter_struct *timing, const exmc_config_t *config,
+                        uint16_t data_setup_ns)
+{
+    timing->asyn_access_mode = (config->device == EXMC_DEVICE_NOR) ? EXMC_ACCESS_MODE_B : EXMC_ACCESS_MODE_A;
+    timing->syn_data_latency = EXMC_DATALAT_2_CLK;
+    timing->syn_clk_division = EXMC_SYN_CLOCK_RATIO_DISABLE;
+    timing->bus_latency = exmc_cycles(config->bus_turnaround_ns, 1U, 16U);
+    timing->asyn_data_setuptime = exmc_cycles(data_setup_ns, 1U, 256U);
+    timing->asyn_address_holdtime = 2U;
+    timing->asyn_address_setuptime = exmc_cycles(config->address_setup_ns, 1U, 16U);
+}
+
+/*!
+    \brief      configure a chip select of the NOR/SRAM bank and its pins
+    \param[in]  config: memory, bus and timings
+    \param[out] none
+    \retval     base address of the region, NULL if the configuration is invalid
+*/
+void *exmc_begin(const exmc_config_t *config)
+{
+    exmc_norsram_parameter_struct param;
+    exmc_norsram_timing_parameter_struct read_timing, write_timing;
+    uint8_t width = (config->width == 16U) ? 16U : 8U;
+
+    if ((config->region > 3U) || (config->address_lines > EXMC_ADDRESS_LINES)
+            || ((config->width != 8U) && (config->width != 16U))) {
+        return NULL;
+    }
+    if ((config->device == EXMC_DEVICE_LCD) && (config->address_lines == 0U)) {
+        return NULL;
+    }
+
+    exmc_pins(exmc_data_pins, width);
+    exmc_pins(exmc_control_pins, 2U);
+    exmc_pins(&exmc_ne_pins[config->region], 1U);
+    if (config->device == EXMC_DEVICE_LCD) {
+        exmc_pins(&exmc_address_pins[config->address_lines - 1U], 1U);
+    } else {
+        exmc_pins(exmc_address_pins, config->address_lines);
+    }
+    if ((config->device == EXMC_DEVICE_SRAM) && (width == 16U)) {
+        exmc_pins(exmc_byte_lane_pins, 2U);
+    }
+    rcu_periph_clock_enable(RCU_EXMC);
+
+    exmc_timing(&read_timing, config, config->data_setup_ns);
+    exmc_timing(&write_timing, config, config->write_data_setup_ns);
+    exmc_norsram_struct_para_init(&param);
+    param.norsram_region = config->region;
+    param.write_mode = EXMC_ASYN_WRITE;
+    param.extended_mode = (config->write_data_setup_ns != 0U) ? ENABLE : DISABLE;
+    param.asyn_wait = DISABLE;
+    param.nwait_signal = DISABLE;
+    param.memory_write = ENABLE;
+    param.wrap_burst_mode = DISABLE;
+    param.burst_mode = DISABLE;
+    param.databus_width = (width == 16U) ? EXMC_NOR_DATABUS_WIDTH_16B : EXMC_NOR_DATABUS_WIDTH_8B;
+    param.memory_type = (config->device == EXMC_DEVICE_NOR) ? EXMC_MEMORY_TYPE_NOR : EXMC_MEMORY_TYPE_SRAM;
+    param.address_data_mux = DISABLE;
+    param.read_write_timing = &read_timing;
+    param.write_timing = &write_timing;
+    exmc_norsram_init(&param);
+    exmc_norsram_enable(config->region);
+    return (void *)EXMC_REGION_BASE(config->region);
+}
+
+/*!
+    \brief      disable a chip select, its pins stay with the EXMC as other regions may share them
+    \param[in]  region: chip select NE0-NE3
+    \param[out] none
+    \retval     none
+*/
+void exmc_end(uint8_t region)
+{
+    if (region <= 3U) {
+        exmc_norsram_disable(region);
+        pin_function(exmc_ne_pins[region], GD_PIN_FUNCTION1(PIN_MODE_IN_FLOATING, 0));
+    }
+}
+
+/*!
+    \brief      configure an 8080 LCD controller
+    \param[in]  config: EXMC_DEVICE_LCD, address_lines one above the register select line
+    \param[out] lcd: command and data addresses
+    \retval     false if the configuration is invalid
+*/
+bool exmc_lcd_begin(const exmc_config_t *config, exmc_lcd_t *lcd)
+{
+    uint8_t *base;
+    uint32_t rs;
+
+    if (config->device != EXMC_DEVICE_LCD) {
+        return false;
+    }
+    base = (uint8_t *)exmc_begin(config);
+    if (base == NULL) {
+        return false;
+    }
+    /* on a 16-bit bus A0 is the half-word address, bit 1 of the bus address */
+    rs = 1UL << ((config->address_lines - 1U) + ((config->width == 16U) ? 1U : 0U));
+    lcd->command = (volatile uint16_t *)base;
+    lcd->data = (volatile uint16_t *)(base + rs);
+    return true;
+}
+
+#endif /* EXMC_AVAILABLE */
+
+#if defined(EXMC_AVAILABLE) && defined(EXTRAM_CONFIG)
+/* from the linker script, apart only when the heap is in the EXTRAM region */
+extern uint8_t _eheap[];
+extern uint8_t _heap_end[];
+#endif
+
+/*!
+    \brief      bring external memory up before static constructors and the first heap
+                allocation: the variant's EXTRAM_CONFIG when the heap was linked there,
+                nothing otherwise; a sketch may override it
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+__attribute__((weak)) void exmc_early_init(void)
+{
+#if defined(EXMC_AVAILABLE) && defined(EXTRAM_CONFIG)
+    static const exmc_config_t extram = EXTRAM_CONFIG;
+
+    if ((uint32_t)_eheap != (uint32_t)_heap_end) {
+        exmc_begin(&extram);
+    }
+#endif
+}
@@ -0,0 +1,73 @@
+#ifndef _GD32_EXMC_H_
+#define _GD32_EXMC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gd32xxyy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(GD32F30x) || defined(GD32E50X)
+#define EXMC_AVAILABLE          1
+#endif
+
+/*
+ * Asynchronous memories on the NOR/SRAM bank of the EXMC: SRAM, NOR flash,
+ * and 8080 LCD controllers, which the EXMC drives like a SRAM with the
+ * register select line on an address pin. Each of the four chip selects
+ * NE0-NE3 has its own 64 MB region, EXMC_REGION_BASE(); once configured the
+ * memory is read and written with plain loads and stores, and an LCD
+ * command or pixel is a single store to exmc_lcd_t.command or .data.
+ *
+ * Timings are in ns and rounded up to HCLK cycles. The data setup time is
+ * how long NOE or NWE stays low; write_data_setup_ns, when not 0, gives
+ * writes their own, as LCD controllers read much slower than they write.
+ *
+ * Variables marked EXTRAM_ATTR go to the EXTRAM region of variants whose
+ * ldscript.ld has one. They are neither initialized nor zeroed at reset,
+ * since the memory isn't reachable before exmc_begin(). With the heap
+ * moved there by the board menu, exmc_early_init() configures the
+ * variant's EXTRAM_CONFIG before static constructors run; a sketch that
+ * needs other memory that early overrides it.
+ */
+#define EXMC_REGION_BASE(region)    (0x60000000U + ((uint32_t)(region) << 26))
+#define EXTRAM_ATTR                 __attribute__((section(".extram")))
+
+typedef enum {
+    EXMC_DEVICE_SRAM = 0,
+    EXMC_DEVICE_NOR,
+    EXMC_DEVICE_LCD                             /* 8080 interface */
+} exmc_device_t;
+
+typedef struct {
+    uint8_t region;                             /* chip select NE0-NE3 */
+    exmc_device_t device;
+    uint8_t width;                              /* data bus, 8 or 16 bits */
+    uint8_t address_lines;                      /* A0 to A(n-1), SRAM and NOR; for an LCD the register select is A(n-1) */
+    uint16_t address_setup_ns;
+    uint16_t data_setup_ns;
+    uint16_t write_data_setup_ns;               /* 0 for the same as reads */
+    uint16_t bus_turnaround_ns;
+} exmc_config_t;
+
+/* 16-bit stores; on an 8-bit bus cast to volatile uint8_t * for single byte cycles */
+typedef struct {
+    volatile uint16_t *command;                 /* register select low */
+    volatile uint16_t *data;                    /* register select high */
+} exmc_lcd_t;
+
+/* base address of the region, NULL if the configuration is invalid */
+void *exmc_begin(const exmc_config_t *config);
+void exmc_end(uint8_t region);
+/* exmc_begin() for an EXMC_DEVICE_LCD, with the command and data addresses */
+bool exmc_lcd_begin(const exmc_config_t *config, exmc_lcd_t *lcd);
+/* weak, called before static constructors */
+void exmc_early_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_EXMC_H_ */
@@ -0,0 +1,204 @@
+#include <stdint.h>
+#include <string.h>
+#include "fast_math.h"
+#include "gd32xxyy.h"
+
+#define FAST_MATH_PI            3.14159265f
+#define FAST_MATH_HALF_PI       1.57079633f
+/* table steps per turn, a quarter wave is FAST_MATH_STEPS / 4 */
+#define FAST_MATH_STEPS         1024
+#define FAST_MATH_QUARTER       (FAST_MATH_STEPS / 4)
+
+/* sin() over a quarter wave, both ends included */
+static const float fast_math_sine[FAST_MATH_QUARTER + 1] = {
+    0.00000000f, 0.00613588f, 0.01227154f, 0.01840673f, 0.02454123f, 0.03067480f,
+    0.03680722f, 0.04293826f, 0.04906767f, 0.05519524f, 0.06132074f, 0.06744392f,
+    0.07356456f, 0.07968244f, 0.08579731f, 0.09190896f, 0.09801714f, 0.10412163f,
+    0.11022221f, 0.11631863f, 0.12241068f, 0.12849811f, 0.13458071f, 0.14065824f,
+    0.14673047f, 0.15279719f, 0.15885814f, 0.16491312f, 0.17096189f, 0.17700422f,
+    0.18303989f, 0.18906866f, 0.19509032f, 0.20110463f, 0.20711138f, 0.21311032f,
+    0.21910124f, 0.22508391f, 0.23105811f, 0.23702361f, 0.24298018f, 0.24892761f,
+    0.25486566f, 0.26079412f, 0.26671276f, 0.27262136f, 0.27851969f, 0.28440754f,
+    0.29028468f, 0.29615089f, 0.30200595f, 0.30784964f, 0.31368174f, 0.31950203f,
+    0.32531029f, 0.33110631f, 0.33688985f, 0.34266072f, 0.34841868f, 0.35416353f,
+    0.35989504f, 0.36561300f, 0.37131719f, 0.37700741f, 0.38268343f, 0.38834505f,
+    0.39399204f, 0.39962420f, 0.40524131f, 0.41084317f, 0.41642956f, 0.42200027f,
+    0.42755509f, 0.43309382f, 0.43861624f, 0.44412214f, 0.44961133f, 0.45508359f,
+    0.46053871f, 0.46597650f, 0.47139674f, 0.47679923f, 0.48218377f, 0.48755016f,
+    0.49289819f, 0.49822767f, 0.50353838f, 0.50883014f, 0.51410274f, 0.51935599f,
+    0.52458968f, 0.52980362f, 0.53499762f, 0.54017147f, 0.54532499f, 0.55045797f,
+    0.55557023f, 0.56066158f, 0.56573181f, 0.57078075f, 0.57580819f, 0.58081396f,
+    0.58579786f, 0.59075970f, 0.59569930f, 0.60061648f, 0.60551104f, 0.61038281f,
+    0.61523159f, 0.62005721f, 0.62485949f, 0.62963824f, 0.63439328f, 0.63912444f,
+    0.64383154f, 0.64851440f, 0.65317284f, 0.65780669f, 0.66241578f, 0.66699992f,
+    0.67155895f, 0.67609270f, 0.68060100f, 0.68508367f, 0.68954054f, 0.69397146f,
+    0.69837625f, 0.70275474f, 0.70710678f, 0.71143220f, 0.71573083f, 0.72000251f,
+    0.72424708f, 0.72846439f, 0.73265427f, 0.73681657f, 0.74095113f, 0.74505779f,
+    0.74913639f, 0.75318680f, 0.75720885f, 0.76120239f, 0.76516727f, 0.76910334f,
+    0.77301045f, 0.77688847f, 0.78073723f, 0.78455660f, 0.78834643f, 0.79210658f,
+    0.79583690f, 0.79953727f, 0.80320753f, 0.80684755f, 0.81045720f, 0.81403633f,
+    0.81758481f, 0.82110251f, 0.82458930f, 0.82804505f, 0.83146961f, 0.83486287f,
+    0.83822471f, 0.84155498f, 0.84485357f, 0.84812034f, 0.85135519f, 0.85455799f,
+    0.85772861f, 0.86086694f, 0.86397286f, 0.86704625f, 0.87008699f, 0.87309498f,
+    0.87607009f, 0.87901223f, 0.88192126f, 0.88479710f, 0.88763962f, 0.89044872f,
+    0.89322430f, 0.89596625f, 0.89867447f, 0.90134885f, 0.90398929f, 0.90659570f,
+    0.90916798f, 0.91170603f, 0.91420976f, 0.91667906f, 0.91911385f, 0.92151404f,
+    0.92387953f, 0.92621024f, 0.92850608f, 0.93076696f, 0.93299280f, 0.93518351f,
+    0.93733901f, 0.93945922f, 0.94154407f, 0.94359346f, 0.94560733f, 0.94758559f,
+    0.94952818f, 0.95143502f, 0.95330604f, 0.95514117f, 0.95694034f, 0.95870347f,
+    0.96043052f, 0.96212140f, 0.96377607f, 0.96539444f, 0.96697647f, 0.96852209f,
+    0.97003125f, 0.97150389f, 0.97293995f, 0.97433938f, 0.97570213f, 0.97702814f,
+    0.97831737f, 0.97956977f, 0.98078528f, 0.98196387f, 0.98310549f, 0.98421009f,
+    0.98527764f, 0.98630810f, 0.98730142f, 0.98825757f, 0.98917651f, 0.99005821f,
+    0.99090264f, 0.99170975f, 0.99247953f, 0.99321195f, 0.99390697f, 0.99456457f,
+    0.99518473f, 0.99576741f, 0.99631261f, 0.99682030f, 0.99729046f, 0.99772307f,
+    0.99811811f, 0.99847558f, 0.99879546f, 0.99907773f, 0.99932238f, 0.99952942f,
+    0.99969882f, 0.99983058f, 0.99992470f, 0.99998118f, 1.00000000f
+};
+
+/* sin() at table step k, any k */
+static float fast_math_step(uint32_t k)
+{
+    uint32_t r = k & (FAST_MATH_QUARTER - 1);
+
+    switch ((k / FAST_MATH_QUARTER) & 3U) {
+        case 0:
+            return fast_math_sine[r];
+        case 1:
+            return fast_math_sine[FAST_MATH_QUARTER - r];
+        case 2:
+            return -fast_math_sine[r];
+        default:
+            return -fast_math_sine[FAST_MATH_QUARTER - r];
+    }
+}
+
+/* split angle into a table step and the fraction of the next one */
+static uint32_t fast_math_split(float angle, float *frac)
+{
+    float t = angle * (FAST_MATH_STEPS / (2.0f * FAST_MATH_PI));
+    int32_t k = (int32_t)t;
+
+    if ((float)k > t) {
+        k--;
+    }
+    *frac = t - (float)k;
+    return (uint32_t)k;
+}
+
+/*!
+    \brief      sine by table interpolation
+    \param[in]  angle: in radians
+    \param[out] none
+    \retval     sin(angle)
+*/
+float fast_sin(float angle)
+{
+    float frac;
+    uint32_t k = fast_math_split(angle, &frac);
+    float s0 = fast_math_step(k);
+
+    return s0 + (fast_math_step(k + 1U) - s0) * frac;
+}
+
+/*!
+    \brief      cosine by table interpolation
+    \param[in]  angle: in radians
+    \param[out] none
+    \retval     cos(angle)
+*/
+float fast_cos(float angle)
+{
+    float frac;
+    uint32_t k = fast_math_split(angle, &frac) + FAST_MATH_QUARTER;
+    float c0 = fast_math_step(k);
+
+    return c0 + (fast_math_step(k + 1U) - c0) * frac;
+}
+
+/*!
+    \brief      sine and cosine of one angle, sharing the range reduction
+    \param[in]  angle: in radians
+    \param[out] sin_out: sin(angle), may be NULL
+    \param[out] cos_out: cos(angle), may be NULL
+    \retval     none
+*/
+void fast_sincos(float angle, float *sin_out, float *cos_out)
+{
+    float frac;
+    uint32_t k = fast_math_split(angle, &frac);
+    float v0;
+
+    if (sin_out != NULL) {
+        v0 = fast_math_step(k);
+        *sin_out = v0 + (fast_math_step(k + 1U) - v0) * frac;
+    }
+    if (cos_out != NULL) {
+        k += FAST_MATH_QUARTER;
+        v0 = fast_math_step(k);
+        *cos_out = v0 + (fast_math_step(k + 1U) - v0) * frac;
+    }
+}
+
+/*!
+    \brief      four-quadrant arc tangent
+    \param[in]  y: ordinate
+    \param[in]  x: abscissa
+    \param[out] none
+    \retval     angle of (x, y) in radians, -pi to pi
+*/
+float fast_atan2(float y, float x)
+{
+    float ax = (x < 0.0f) ? -x : x;
+    float ay = (y < 0.0f) ? -y : y;
+    float z, z2, a;
+
+    if ((ax == 0.0f) && (ay == 0.0f)) {
+        return 0.0f;
+    }
+    /* atan() of the ratio in [0, 1], Abramowitz and Stegun 4.4.49 */
+    z = (ay > ax) ? (ax / ay) : (ay / ax);
+    z2 = z * z;
+    a = z * (0.9998660f + z2 * (-0.3302995f + z2 * (0.1801410f + z2 * (-0.0851330f + z2 * 0.0208351f))));
+    if (ay > ax) {
+        a = FAST_MATH_HALF_PI - a;
+    }
+    if (x < 0.0f) {
+        a = FAST_MATH_PI - a;
+    }
+    return (y < 0.0f) ? -a : a;
+}
+
+/*!
+    \brief      square root
+    \param[in]  x: radicand
+    \param[out] none
+    \retval     sqrt(x), 0 for x <= 0
+*/
+float fast_sqrt(float x)
+{
+    if (!(x > 0.0f)) {
+        return 0.0f;
+    }
+#if defined(__FPU_USED) && (__FPU_USED == 1U)
+    {
+        float r;
+
+        __ASM volatile("vsqrt.f32 %0, %1" : "=t"(r) : "t"(x));
+        return r;
+    }
+#else
+    {
+        /* inverse square root from the exponent trick, refined twice */
+        float y;
+        uint32_t i;
+
+        memcpy(&i, &x, sizeof(i));
+        i = 0x5F375A86U - (i >> 1);
+        memcpy(&y, &i, sizeof(y));
+        y = y * (1.5f - 0.5f * x * y * y);
+        y = y * (1.5f - 0.5f * x * y * y);
+        return x * y;
+    }
+#endif
+}
@@ -0,0 +1,32 @@
+#ifndef _GD32_FAST_MATH_H_
+#define _GD32_FAST_MATH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Single precision sin, cos, atan2 and sqrt for control loops (FOC, filters),
+ * trading the last few bits of sinf()/cosf()/atan2f() for a fixed, short run
+ * time and no newlib code pulled in.
+ *
+ * - fast_sin(), fast_cos() and fast_sincos() interpolate a quarter-wave table
+ *   of 1024 steps per turn, absolute error below 5e-6 within a few turns of
+ *   zero; further out the float angle (radians) itself gets coarser.
+ * - fast_atan2() evaluates a polynomial on one octant, absolute error below
+ *   1.2e-5 rad, result in [-pi, pi]; fast_atan2(0, 0) is 0.
+ * - fast_sqrt() is the FPU square root instruction where there is one, and
+ *   an inverse square root with two Newton steps (relative error below 5e-6)
+ *   on GD32E23x; 0 for x <= 0.
+ */
+float fast_sin(float angle);
+float fast_cos(float angle);
+void fast_sincos(float angle, float *sin_out, float *cos_out);
+float fast_atan2(float y, float x);
+float fast_sqrt(float x);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_FAST_MATH_H_ */
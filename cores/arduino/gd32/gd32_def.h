@@ -45,4 +45,25 @@ OF SUCH DAMAGE.
 #define WEAK __attribute__ ((weak))
 #endif
 
+/**
+ * Code run from RAM, copied there at boot together with .data. GD32F30x
+ * and GD32E50x fetch from flash with wait states past the zero-wait area,
+ * so handlers marked GD_FASTCODE take the same time wherever the image
+ * puts them. The other series run from flash at full speed and keep it
+ * there. Code called from a GD_FASTCODE function still runs from flash
+ * unless it is inlined or marked as well.
+ */
+#if defined(GD32F30x) || defined(GD32E50X)
+#define GD_FASTCODE __attribute__ ((section(".data.fastcode"), noinline, long_call))
+#else
+#define GD_FASTCODE
+#endif
+
+/**
+ * Variables the startup code neither loads nor zeroes. Their value is
+ * undefined after power-up and survives any other reset, so a large
+ * buffer that is written before it is read costs no time at boot.
+ */
+#define GD_NOINIT __attribute__ ((section(".noinit")))
+
 #endif /*_GD32_DEF_ */
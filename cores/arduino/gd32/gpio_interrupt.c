@@ -1,10 +1,18 @@
 #include "gpio_interrupt.h"
+#include "irq_profile.h"
+#include "irq_priority.h"
 
 #define EXTI_NUMS   (16)
 
 typedef struct {
     IRQn_Type irqNum;
     void (*callback)(void);
+    void (*callback_param)(void *);
+    void *param;
+    uint32_t timestamp;
+    bool prio_set;              /* prio/subprio replace IRQ_PRIO_EXTI */
+    uint8_t prio;
+    uint8_t subprio;
 } extiConf_t;
 
 extiConf_t gpio_exti_infor[EXTI_NUMS] = {
@@ -63,12 +71,40 @@ extiConf_t gpio_exti_infor[EXTI_NUMS] = {
 #endif
 };
 
-void gpio_interrupt_enable(uint32_t portNum, uint32_t pinNum, void (*callback)(void), uint32_t mode)
+/* enable the vector of a line in the NVIC with the priority chosen for it */
+static void gpio_interrupt_nvic_enable(uint32_t pinNum)
+{
+    if (!gpio_exti_infor[pinNum].prio_set) {
+        irq_priority_enable(gpio_exti_infor[pinNum].irqNum, IRQ_PRIO_EXTI);
+        return;
+    }
+    /* a priority the sketch chose is kept, the dispatch takes no critical section;
+       some NVIC controllers do not have subprio?! */
+#if defined(GD32E23x)
+    nvic_irq_enable(gpio_exti_infor[pinNum].irqNum, gpio_exti_infor[pinNum].prio);
+#else
+    nvic_irq_enable(gpio_exti_infor[pinNum].irqNum, gpio_exti_infor[pinNum].prio,
+                    gpio_exti_infor[pinNum].subprio);
+#endif
+}
+
+static bool gpio_interrupt_vector_used(uint32_t pinNum)
+{
+    int i = 0;
+    for (i = 0; i < EXTI_NUMS; i++) {
+        if (gpio_exti_infor[pinNum].irqNum == gpio_exti_infor[i].irqNum  && \
+            (NULL != gpio_exti_infor[i].callback || NULL != gpio_exti_infor[i].callback_param)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void gpio_interrupt_config(uint32_t portNum, uint32_t pinNum, uint32_t mode)
 {
     exti_line_enum exti_line = BIT(pinNum);
     exti_mode_enum exti_mode = EXTI_INTERRUPT;
     exti_trig_type_enum  trig_type = mode;
-    gpio_exti_infor[pinNum].callback = callback;
 
     gpio_clock_enable(portNum);
 #if defined(GD32F30x) || defined(GD32E50X)
@@ -82,12 +118,7 @@ void gpio_interrupt_enable(uint32_t portNum, uint32_t pinNum, void (*callback)(v
     //gpio_mode_set(gpio_port[portNum], GPIO_MODE_INPUT, GPIO_PUPD_NONE, gpio_pin[pinNum]);
 #endif
 
-    /* some NVIC controllers do not have subprio?!*/
-#if defined(GD32E23x)
-    nvic_irq_enable(gpio_exti_infor[pinNum].irqNum, EXTI_IRQ_PRIO);
-#else
-    nvic_irq_enable(gpio_exti_infor[pinNum].irqNum, EXTI_IRQ_PRIO, EXTI_IRQ_SUBPRIO);
-#endif
+    gpio_interrupt_nvic_enable(pinNum);
 #if defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
     syscfg_exti_line_config(
         (uint8_t) portNum,
@@ -101,117 +132,143 @@ void gpio_interrupt_enable(uint32_t portNum, uint32_t pinNum, void (*callback)(v
 
 }
 
-void gpio_interrupt_disable(uint32_t pinNum)
+void gpio_interrupt_enable(uint32_t portNum, uint32_t pinNum, void (*callback)(void), uint32_t mode)
+{
+    gpio_exti_infor[pinNum].callback_param = NULL;
+    gpio_exti_infor[pinNum].callback = callback;
+    gpio_interrupt_config(portNum, pinNum, mode);
+}
+
+void gpio_interrupt_enable_param(uint32_t portNum, uint32_t pinNum, void (*callback)(void *),
+                                 void *param, uint32_t mode)
 {
-    int i = 0;
     gpio_exti_infor[pinNum].callback = NULL;
+    gpio_exti_infor[pinNum].param = param;
+    gpio_exti_infor[pinNum].callback_param = callback;
+    gpio_interrupt_config(portNum, pinNum, mode);
+}
+
+/* cycle count taken when the vector of the line was entered for its last edge */
+uint32_t gpio_interrupt_timestamp(uint32_t pinNum)
+{
+    return gpio_exti_infor[pinNum].timestamp;
+}
+
+/* Set the NVIC priority of the vector serving a line. Lines sharing a vector share its priority,
+   so all of them take the new value; a vector in use is reprogrammed right away */
+void gpio_interrupt_priority(uint32_t pinNum, uint8_t prio, uint8_t subprio)
+{
+    int i = 0;
     for (i = 0; i < EXTI_NUMS; i++) {
-        if (gpio_exti_infor[pinNum].irqNum == gpio_exti_infor[i].irqNum  && \
-            NULL != gpio_exti_infor[i].callback) {
-            return ;
+        if (gpio_exti_infor[pinNum].irqNum == gpio_exti_infor[i].irqNum) {
+            gpio_exti_infor[i].prio = prio;
+            gpio_exti_infor[i].subprio = subprio;
+            gpio_exti_infor[i].prio_set = true;
         }
     }
+    if (gpio_interrupt_vector_used(pinNum)) {
+        gpio_interrupt_nvic_enable(pinNum);
+    }
+}
+
+void gpio_interrupt_disable(uint32_t pinNum)
+{
+    gpio_exti_infor[pinNum].callback = NULL;
+    gpio_exti_infor[pinNum].callback_param = NULL;
+    if (gpio_interrupt_vector_used(pinNum)) {
+        return ;
+    }
     nvic_irq_disable(gpio_exti_infor[pinNum].irqNum);
 }
 
 
-void exti_callbackHandler(uint32_t pinNum)
+/* lines served by each vector */
+#define EXTI_LINES(first, last)     ((0xFFFFU >> (15U - (last))) & (0xFFFFU << (first)))
+
+/* Service every pending and enabled line of one vector: the pending register is read once and
+   written once to clear all of them, then the callbacks run in line order. Every serviced line
+   gets the cycle count of the vector entry as its timestamp */
+static void exti_callbackHandler(uint32_t lines)
 {
-    exti_line_enum linex = (exti_line_enum)BIT(pinNum);
-    if (RESET != exti_interrupt_flag_get(linex)) {
-        exti_interrupt_flag_clear(linex);
-        if (NULL != gpio_exti_infor[pinNum].callback) {
-            gpio_exti_infor[pinNum].callback();
+    uint32_t now = getCurrentCycles();
+    uint32_t pending = EXTI_PD & EXTI_INTEN & lines;
+
+    if (0U == pending) {
+        return;
+    }
+    EXTI_PD = pending;
+    while (0U != pending) {
+        uint32_t pinNum = (uint32_t)__builtin_ctz(pending);
+        extiConf_t *exti = &gpio_exti_infor[pinNum];
+
+        pending &= pending - 1U;
+        exti->timestamp = now;
+        if (NULL != exti->callback_param) {
+            exti->callback_param(exti->param);
+        } else if (NULL != exti->callback) {
+            exti->callback();
         }
     }
 }
 
 #if defined(GD32F30x) || defined(GD32E50X)
-void EXTI0_IRQHandler(void)
+__attribute__((used)) void EXTI0_IRQHandler(void)
 {
-    exti_callbackHandler(0);
+    IRQ_PROFILE();
+    exti_callbackHandler(EXTI_LINES(0U, 0U));
 }
 
-void EXTI1_IRQHandler(void)
+__attribute__((used)) void EXTI1_IRQHandler(void)
 {
-    exti_callbackHandler(1);
+    IRQ_PROFILE();
+    exti_callbackHandler(EXTI_LINES(1U, 1U));
 }
 
-void EXTI2_IRQHandler(void)
+__attribute__((used)) void EXTI2_IRQHandler(void)
 {
-    exti_callbackHandler(2);
+    IRQ_PROFILE();
+    exti_callbackHandler(EXTI_LINES(2U, 2U));
 }
 
-void EXTI3_IRQHandler(void)
+__attribute__((used)) void EXTI3_IRQHandler(void)
 {
-    exti_callbackHandler(3);
+    IRQ_PROFILE();
+    exti_callbackHandler(EXTI_LINES(3U, 3U));
 }
 
-void EXTI4_IRQHandler(void)
+__attribute__((used)) void EXTI4_IRQHandler(void)
 {
-    exti_callbackHandler(4);
+    IRQ_PROFILE();
+    exti_callbackHandler(EXTI_LINES(4U, 4U));
 }
 
-void EXTI5_9_IRQHandler(void)
+__attribute__((used)) void EXTI5_9_IRQHandler(void)
 {
-    uint32_t i;
-    for (i = 5; i < 10; i++) {
-        exti_callbackHandler(i);
-    }
-
+    IRQ_PROFILE();
+    exti_callbackHandler(EXTI_LINES(5U, 9U));
 }
 
-void EXTI10_15_IRQHandler(void)
+__attribute__((used)) void EXTI10_15_IRQHandler(void)
 {
-    uint32_t i;
-    for (i = 10; i < 16; i++) {
-        exti_callbackHandler(i);
-    }
+    IRQ_PROFILE();
+    exti_callbackHandler(EXTI_LINES(10U, 15U));
 }
-#elif defined(GD32F3x0) || defined(GD32F1x0)
-void EXTI0_1_IRQHandler(void)
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+__attribute__((used)) void EXTI0_1_IRQHandler(void)
 {
-    uint32_t i;
-    for (i = 0; i <= 1; i++) {
-        exti_callbackHandler(i);
-    }
+    IRQ_PROFILE();
+    exti_callbackHandler(EXTI_LINES(0U, 1U));
 }
 
-void EXTI2_3_IRQHandler(void)
+__attribute__((used)) void EXTI2_3_IRQHandler(void)
 {
-    uint32_t i;
-    for (i = 2; i <= 3; i++) {
-        exti_callbackHandler(i);
-    }
+    IRQ_PROFILE();
+    exti_callbackHandler(EXTI_LINES(2U, 3U));
 }
 
-void EXTI4_15_IRQHandler(void)
-{
-    uint32_t i;
-    for (i = 4; i <= 15; i++) {
-        exti_callbackHandler(i);
-    }
-}
-#elif defined(GD32E23x)
-void EXTI0_1_IRQHandler(void)
-{
-    uint32_t i;
-    for ( i = 0; i < 2; i++) {
-        exti_callbackHandler(i);
-    }
-}
-void EXTI2_3_IRQHandler(void)
+__attribute__((used)) void EXTI4_15_IRQHandler(void)
 {
-    uint32_t i;
-    for (i = 2; i < 4; i++) {
-        exti_callbackHandler(i);
-    }
-}
-void EXTI4_15_IRQHandler(void)
-{
-    uint32_t i;
-    for (i = 4; i < 16; i++) {
-        exti_callbackHandler(i);
-    }
+    IRQ_PROFILE();
+    exti_callbackHandler(EXTI_LINES(4U, 15U));
 }
 #endif
@@ -3,16 +3,17 @@
 
 #include "Arduino.h"
 
-#define EXTI_IRQ_PRIO       3
-#define EXTI_IRQ_SUBPRIO    0
-
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 void gpio_interrupt_enable(uint32_t portNum, uint32_t pinNum, void (*callback)(void),
                            uint32_t mode);
+void gpio_interrupt_enable_param(uint32_t portNum, uint32_t pinNum, void (*callback)(void *),
+                                 void *param, uint32_t mode);
+void gpio_interrupt_priority(uint32_t pinNum, uint8_t prio, uint8_t subprio);
 void gpio_interrupt_disable(uint32_t pinNum);
+uint32_t gpio_interrupt_timestamp(uint32_t pinNum);
 
 #ifdef __cplusplus
 }
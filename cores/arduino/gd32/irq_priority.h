@@ -0,0 +1,121 @@
+#ifndef _GD32_IRQ_PRIORITY_H_
+#define _GD32_IRQ_PRIORITY_H_
+
+#include <stdint.h>
+#include "gd32xxyy.h"
+#include "critical.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The interrupt priorities of the core and its libraries, in one place.
+ * Each is an 8 bit priority as written to BASEPRI, lower is more urgent,
+ * the same form as CRITICAL_BASEPRI, serial_set_irq_priority() and
+ * FreeRTOS's configMAX_SYSCALL_INTERRUPT_PRIORITY; the NVIC keeps the
+ * top __NVIC_PRIO_BITS of it, 4 (2 on GD32E23x). Any of them can be
+ * overridden from the build flags, -DIRQ_PRIO_SYSTICK=0xF0 say.
+ *
+ * irq_priority_init() puts all priority bits into preemption
+ * (NVIC_PRIGROUP_PRE4_SUB0, what FreeRTOS expects too), so every level
+ * preempts the ones below it. Level 0 is left to the sketch: all core
+ * interrupts are clamped to CRITICAL_BASEPRI or below (critical.h).
+ * Under FreeRTOS, interrupts that signal tasks must not be more urgent
+ * than configMAX_SYSCALL_INTERRUPT_PRIORITY; building with
+ * -DCRITICAL_BASEPRI=<that value> moves all of the core below it.
+ *
+ * SysTick stays the most urgent of the core so that delay() works from
+ * interrupt handlers; a control loop that must not be preempted by it
+ * goes to level 0, or SysTick is moved down.
+ */
+#ifndef IRQ_PRIO_SYSTICK
+#define IRQ_PRIO_SYSTICK        0x10U
+#endif
+/* receive side of the USARTs, interrupt and DMA; a byte missed is lost */
+#ifndef IRQ_PRIO_USART_RX
+#define IRQ_PRIO_USART_RX       0x10U
+#endif
+#ifndef IRQ_PRIO_USART_TX
+#define IRQ_PRIO_USART_TX       0x20U
+#endif
+#ifndef IRQ_PRIO_ADC
+#define IRQ_PRIO_ADC            0x20U
+#endif
+#ifndef IRQ_PRIO_DAC
+#define IRQ_PRIO_DAC            0x20U
+#endif
+#ifndef IRQ_PRIO_TIMER_DMA
+#define IRQ_PRIO_TIMER_DMA      0x20U
+#endif
+#ifndef IRQ_PRIO_SPI
+#define IRQ_PRIO_SPI            0x20U
+#endif
+#ifndef IRQ_PRIO_I2S
+#define IRQ_PRIO_I2S            0x20U
+#endif
+#ifndef IRQ_PRIO_DMA_COPY
+#define IRQ_PRIO_DMA_COPY       0x30U
+#endif
+#ifndef IRQ_PRIO_CRC
+#define IRQ_PRIO_CRC            0x30U
+#endif
+/* USB high priority (isochronous and double buffered endpoints) and wakeup */
+#ifndef IRQ_PRIO_USB_HP
+#define IRQ_PRIO_USB_HP         0x40U
+#endif
+#ifndef IRQ_PRIO_I2C
+#define IRQ_PRIO_I2C            0x60U
+#endif
+#ifndef IRQ_PRIO_USB_LP
+#define IRQ_PRIO_USB_LP         0x80U
+#endif
+#ifndef IRQ_PRIO_RTC
+#define IRQ_PRIO_RTC            0x80U
+#endif
+#ifndef IRQ_PRIO_CAN
+#define IRQ_PRIO_CAN            0x80U
+#endif
+/* update and capture/compare of the hardware timers, soft timers included */
+#ifndef IRQ_PRIO_TIMER
+#define IRQ_PRIO_TIMER          0xA0U
+#endif
+/* attachInterrupt() pins without a priority of their own */
+#ifndef IRQ_PRIO_EXTI
+#define IRQ_PRIO_EXTI           0xC0U
+#endif
+#ifndef IRQ_PRIO_ENET
+#define IRQ_PRIO_ENET           0xC0U
+#endif
+#ifndef IRQ_PRIO_TSI
+#define IRQ_PRIO_TSI            0xC0U
+#endif
+
+/* the NVIC level of a priority, as NVIC_SetPriority() and dma_channel_attach_irq() take it */
+#define IRQ_LEVEL(priority)     ((uint32_t)(priority) >> (8U - __NVIC_PRIO_BITS))
+
+/* all priority bits preempt; before the first interrupt is set up */
+static inline void irq_priority_init(void)
+{
+#if !defined(GD32E23x)
+    nvic_priority_group_set(NVIC_PRIGROUP_PRE4_SUB0);
+#endif
+}
+
+static inline void irq_priority_set(IRQn_Type irq, uint32_t priority)
+{
+    NVIC_SetPriority(irq, IRQ_LEVEL(priority));
+    critical_irq_clamp(irq);
+}
+
+static inline void irq_priority_enable(IRQn_Type irq, uint32_t priority)
+{
+    irq_priority_set(irq, priority);
+    NVIC_EnableIRQ(irq);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_IRQ_PRIORITY_H_ */
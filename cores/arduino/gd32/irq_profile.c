@@ -0,0 +1,160 @@
+#include <string.h>
+#include "irq_profile.h"
+#include "systick.h"
+#if defined(GD32_SWO_EVENTS)
+#include "itm.h"
+#endif
+
+#if defined(GD32_IRQ_PROFILE)
+
+/* exception numbers as IPSR reports them, the external interrupts start at 16 */
+#define IRQ_PROFILE_SLOTS       (16U + IRQ_PROFILE_IRQS)
+
+#if defined(DWT_CTRL_CYCCNTENA_Msk)
+#define irq_profile_now()       (DWT->CYCCNT)
+#else
+#define irq_profile_now()       getCurrentCycles()
+#endif
+
+static irq_profile_t irq_profile_slot[IRQ_PROFILE_SLOTS];
+/* irq_profile_inner when each handler came in */
+static uint32_t irq_profile_inner_at[IRQ_PROFILE_SLOTS];
+/* when an interrupt was first seen pending, 0 if it wasn't */
+static uint32_t irq_profile_pended[IRQ_PROFILE_IRQS];
+/* cycles spent in handlers so far, each counted once */
+static uint32_t irq_profile_inner;
+
+/* stamp every interrupt that waits in the NVIC and wasn't seen yet */
+static void irq_profile_scan(uint32_t now)
+{
+    uint32_t word;
+
+    for (word = 0U; word < (IRQ_PROFILE_IRQS + 31U) / 32U; word++) {
+        uint32_t pending = NVIC->ISPR[word];
+
+        while (0U != pending) {
+            uint32_t irq = word * 32U + (uint32_t)__builtin_ctz(pending);
+
+            pending &= pending - 1U;
+            if ((irq < IRQ_PROFILE_IRQS) && (0U == irq_profile_pended[irq])) {
+                irq_profile_pended[irq] = now | 1U;
+            }
+        }
+    }
+}
+
+/*!
+    \brief      start timing the running handler, see IRQ_PROFILE()
+    \param[in]  none
+    \param[out] none
+    \retval     cycle count on entry
+*/
+uint32_t irq_profile_enter(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t now = irq_profile_now();
+    uint32_t slot = __get_IPSR();
+
+    __disable_irq();
+#if defined(GD32_SWO_EVENTS)
+    itm_event(ITM_PORT_IRQ, slot);
+#endif
+    if (slot < IRQ_PROFILE_SLOTS) {
+        if ((slot >= 16U) && (0U != irq_profile_pended[slot - 16U])) {
+            uint32_t latency = now - irq_profile_pended[slot - 16U];
+
+            if (latency > irq_profile_slot[slot].max_latency) {
+                irq_profile_slot[slot].max_latency = latency;
+            }
+            irq_profile_pended[slot - 16U] = 0U;
+        }
+        irq_profile_scan(now);
+        irq_profile_inner_at[slot] = irq_profile_inner;
+    }
+    __set_PRIMASK(primask);
+    return now;
+}
+
+/*!
+    \brief      account the running handler, called as its scope ends
+    \param[in]  start: cycle count irq_profile_enter() returned
+    \param[out] none
+    \retval     none
+*/
+void irq_profile_exit(uint32_t *start)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t now = irq_profile_now();
+    uint32_t slot = __get_IPSR();
+
+    __disable_irq();
+    if (slot < IRQ_PROFILE_SLOTS) {
+        irq_profile_t *stats = &irq_profile_slot[slot];
+        /* leave out the handlers that preempted this one */
+        uint32_t cycles = (now - *start) - (irq_profile_inner - irq_profile_inner_at[slot]);
+
+        irq_profile_inner += cycles;
+        stats->count++;
+        stats->total_cycles += cycles;
+        if (cycles > stats->max_cycles) {
+            stats->max_cycles = cycles;
+        }
+        irq_profile_scan(now);
+    }
+#if defined(GD32_SWO_EVENTS)
+    itm_event(ITM_PORT_IRQ, IRQ_PROFILE_EXIT | slot);
+#endif
+    __set_PRIMASK(primask);
+}
+
+/*!
+    \brief      read the figures of an interrupt
+    \param[in]  irq: interrupt number, negative for the core exceptions (SysTick_IRQn)
+    \param[out] stats: copy of the figures
+    \retval     false if irq isn't tracked
+*/
+bool irq_profile_get(IRQn_Type irq, irq_profile_t *stats)
+{
+    uint32_t slot = (uint32_t)((int32_t)irq + 16);
+    uint32_t primask;
+
+    if (slot >= IRQ_PROFILE_SLOTS) {
+        return false;
+    }
+    primask = __get_PRIMASK();
+    __disable_irq();
+    *stats = irq_profile_slot[slot];
+    __set_PRIMASK(primask);
+    return true;
+}
+
+/*!
+    \brief      clear the figures of all interrupts
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void irq_profile_reset(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    memset(irq_profile_slot, 0, sizeof(irq_profile_slot));
+    memset(irq_profile_pended, 0, sizeof(irq_profile_pended));
+    __set_PRIMASK(primask);
+}
+
+#else
+
+bool irq_profile_get(IRQn_Type irq, irq_profile_t *stats)
+{
+    (void)irq;
+    (void)stats;
+    return false;
+}
+
+void irq_profile_reset(void)
+{
+}
+
+#endif /* GD32_IRQ_PROFILE */
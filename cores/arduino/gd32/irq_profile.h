@@ -0,0 +1,66 @@
+#ifndef _GD32_IRQ_PROFILE_H_
+#define _GD32_IRQ_PROFILE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gd32xxyy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Interrupt profiling, built in with -DGD32_IRQ_PROFILE and compiled out
+ * otherwise. The core's handlers (USART, timers, EXTI, DMA, ADC, RTC, USB,
+ * SysTick) start with IRQ_PROFILE(), which counts every entry and the
+ * cycles it took, less the handlers that preempted it. The interrupt is
+ * told from IPSR, so a shared dispatcher is counted once per vector.
+ *
+ * Latency is the time from the first moment a profiled handler saw the
+ * interrupt pending in the NVIC, on its entry or exit, to the interrupt's
+ * own entry: how long other handlers held it up. An interrupt that comes
+ * in while no profiled handler runs shows no latency.
+ *
+ * Both hooks run with interrupts masked for a few dozen cycles. Handlers
+ * of libraries or sketches can use IRQ_PROFILE() as well.
+ *
+ * With GD32_SWO_EVENTS as well, each entry and exit also goes out on
+ * ITM_PORT_IRQ (see itm.h) as the exception number, with IRQ_PROFILE_EXIT
+ * set on exit, for a trace viewer to draw the handlers on a time line.
+ */
+#define IRQ_PROFILE_EXIT        0x80000000U
+typedef struct {
+    uint32_t count;
+    uint32_t max_cycles;
+    uint64_t total_cycles;      /* total_cycles / count is the average */
+    uint32_t max_latency;       /* cycles, external interrupts only */
+} irq_profile_t;
+
+/* external interrupts tracked, beyond the 16 core exceptions */
+#ifndef IRQ_PROFILE_IRQS
+#if defined(GD32E23x)
+#define IRQ_PROFILE_IRQS        32U
+#else
+#define IRQ_PROFILE_IRQS        96U
+#endif
+#endif
+
+#if defined(GD32_IRQ_PROFILE)
+uint32_t irq_profile_enter(void);
+void irq_profile_exit(uint32_t *start);
+/* at the very top of a handler, ends with the handler's scope */
+#define IRQ_PROFILE()   uint32_t irq_profile_start_ __attribute__((cleanup(irq_profile_exit), unused)) = \
+                            irq_profile_enter()
+#else
+#define IRQ_PROFILE()
+#endif
+
+/* false if irq isn't tracked or profiling is not built in */
+bool irq_profile_get(IRQn_Type irq, irq_profile_t *stats);
+void irq_profile_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_IRQ_PROFILE_H_ */
@@ -0,0 +1,206 @@
+#include "itm.h"
+#include "clock.h"
+#include "gd32xxyy.h"
+
+#if defined(GD32F30x) || defined(GD32E50X)
+
+#if defined(GD32E50X)
+#define ITM_DBG_CTL             DBG_CTL
+#define ITM_DBG_TRACE_IOEN      DBG_CTL_TRACE_IOEN
+#define ITM_DBG_TRACE_MODE      DBG_CTL_TRACE_MODE
+#else
+#define ITM_DBG_CTL             DBG_CTL0
+#define ITM_DBG_TRACE_IOEN      DBG_CTL0_TRACE_IOEN
+/* TRACE_MODE, not named by the GD32F30x library */
+#define ITM_DBG_TRACE_MODE      BITS(6, 7)
+#endif
+
+/* TPI_SPPR: asynchronous NRZ, the UART-like SWO format */
+#define ITM_SPPR_NRZ            2U
+/* TPI_FFCR: formatter off, the ITM packets go out as they are */
+#define ITM_FFCR_BYPASS         0x100U
+/* ITM_TCR: trace bus ID the packets carry */
+#define ITM_TCR_BUS_ID          (1UL << 16)
+#define ITM_LAR_UNLOCK          0xC5ACCE55U
+
+static uint32_t itm_baud;
+static clock_listener_t itm_listener;
+
+/* TPI_ACPR for baud at SystemCoreClock, 0 if it can't be made */
+static uint32_t itm_prescaler(uint32_t baud)
+{
+    uint32_t div;
+
+    if ((baud == 0U) || (baud > SystemCoreClock)) {
+        return 0U;
+    }
+    /* round to the nearest rate */
+    div = (SystemCoreClock + baud / 2U) / baud;
+    return (div > 0x2000U) ? 0U : div;
+}
+
+static void itm_clock_changed(void *arg)
+{
+    uint32_t div;
+
+    (void)arg;
+    div = itm_prescaler(itm_baud);
+    if ((itm_baud != 0U) && (div != 0U)) {
+        TPI->ACPR = div - 1U;
+    }
+}
+
+static inline bool itm_ready(uint8_t port)
+{
+    return ((ITM->TCR & ITM_TCR_ITMENA_Msk) != 0U) && ((ITM->TER & (1UL << port)) != 0U);
+}
+
+/*!
+    \brief      start the SWO output and enable all stimulus ports
+    \param[in]  baud: SWO bit rate, the probe must be set to the same
+    \param[out] none
+    \retval     false if baud can't be made from SystemCoreClock
+*/
+bool itm_init(uint32_t baud)
+{
+    uint32_t div = itm_prescaler(baud);
+
+    if (div == 0U) {
+        return false;
+    }
+    /* the port stays clocked, pin_function() does not count the trace pin */
+    clock_periph_acquire(RCU_GPIOB);
+    rcu_periph_clock_enable(RCU_AF);
+    gpio_init(GPIOB, GPIO_MODE_AF_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_3);
+    /* trace pin in asynchronous mode */
+    ITM_DBG_CTL = (ITM_DBG_CTL & ~ITM_DBG_TRACE_MODE) | ITM_DBG_TRACE_IOEN;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    TPI->SPPR = ITM_SPPR_NRZ;
+    TPI->ACPR = div - 1U;
+    TPI->FFCR = ITM_FFCR_BYPASS;
+    ITM->LAR = ITM_LAR_UNLOCK;
+    ITM->TCR = ITM_TCR_BUS_ID | ITM_TCR_SWOENA_Msk | ITM_TCR_SYNCENA_Msk | ITM_TCR_ITMENA_Msk;
+    ITM->TPR = 0U;
+    ITM->TER = 0xFFFFFFFFU;
+
+    if (itm_baud == 0U) {
+        itm_listener.changed = itm_clock_changed;
+        itm_listener.arg = NULL;
+        clock_listener_add(&itm_listener);
+    }
+    itm_baud = baud;
+    return true;
+}
+
+/*!
+    \brief      stop the ITM and release the trace pin
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void itm_deinit(void)
+{
+    /* let the last packets out */
+    while ((ITM->TCR & ITM_TCR_BUSY_Msk) != 0U) {
+    }
+    ITM->TER = 0U;
+    ITM->TCR = 0U;
+    ITM_DBG_CTL &= ~ITM_DBG_TRACE_IOEN;
+    /* the clock listener stays, it does nothing while itm_baud is 0 */
+    itm_baud = 0U;
+}
+
+/*!
+    \brief      check if writes to a stimulus port go out
+    \param[in]  port: stimulus port, 0 to 31
+    \param[out] none
+    \retval     false if the ITM or the port is off
+*/
+bool itm_port_enabled(uint8_t port)
+{
+    return (port < 32U) && itm_ready(port);
+}
+
+/*!
+    \brief      write bytes to a stimulus port
+    \param[in]  port: stimulus port, 0 to 31
+    \param[in]  data: bytes to send
+    \param[in]  length: number of bytes
+    \param[out] none
+    \retval     none
+*/
+void itm_write(uint8_t port, const uint8_t *data, size_t length)
+{
+    if (!itm_port_enabled(port)) {
+        return;
+    }
+    /* a 32 bit packet carries four characters for five bytes on the wire,
+       four 8 bit packets take eight */
+    while (length >= 4U) {
+        uint32_t word = (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+                        ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+
+        while (ITM->PORT[port].u32 == 0U) {
+        }
+        ITM->PORT[port].u32 = word;
+        data += 4;
+        length -= 4U;
+    }
+    while (length > 0U) {
+        while (ITM->PORT[port].u32 == 0U) {
+        }
+        ITM->PORT[port].u8 = *data++;
+        length--;
+    }
+}
+
+/*!
+    \brief      write one value to a stimulus port
+    \param[in]  port: stimulus port, 0 to 31
+    \param[in]  value: sent as a 32 bit packet
+    \param[out] none
+    \retval     none
+*/
+void itm_event(uint8_t port, uint32_t value)
+{
+    if (!itm_port_enabled(port)) {
+        return;
+    }
+    while (ITM->PORT[port].u32 == 0U) {
+    }
+    ITM->PORT[port].u32 = value;
+}
+
+#else
+
+bool itm_init(uint32_t baud)
+{
+    (void)baud;
+    return false;
+}
+
+void itm_deinit(void)
+{
+}
+
+bool itm_port_enabled(uint8_t port)
+{
+    (void)port;
+    return false;
+}
+
+void itm_write(uint8_t port, const uint8_t *data, size_t length)
+{
+    (void)port;
+    (void)data;
+    (void)length;
+}
+
+void itm_event(uint8_t port, uint32_t value)
+{
+    (void)port;
+    (void)value;
+}
+
+#endif /* GD32F30x || GD32E50X */
@@ -0,0 +1,48 @@
+#ifndef _GD32_ITM_H_
+#define _GD32_ITM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Trace output through the ITM stimulus ports and the SWO pin (PB3), on
+ * GD32F30x and GD32E50x; the other series have no trace pin and every
+ * call fails or does nothing there. The TPIU sends the ITM packets out
+ * as NRZ at itm_init()'s baud rate, derived from SystemCoreClock and
+ * kept across clock_set_system(). A write costs a few cycles: it only
+ * waits when the stimulus FIFO is full, which at 2 Mbit/s takes a
+ * sustained stream of more than 200 KB/s.
+ *
+ * Built with GD32_SWO_BAUD (the "SWO trace" board menu) init() starts
+ * the output itself. A debugger may switch ports off or take the ITM
+ * over, writes to a disabled port are dropped.
+ */
+/* text, see ITMStream */
+#define ITM_PORT_PRINT          0U
+/* interrupt entry and exit with GD32_SWO_EVENTS, see irq_profile.h */
+#define ITM_PORT_IRQ            1U
+/* task switches with GD32_SWO_EVENTS, FreeRTOS task numbers */
+#define ITM_PORT_TASK           2U
+/* free for the sketch */
+#define ITM_PORT_USER           3U
+
+/* false if the part has no SWO or baud can't be made from SystemCoreClock */
+bool itm_init(uint32_t baud);
+void itm_deinit(void);
+/* false if the ITM or the port is off */
+bool itm_port_enabled(uint8_t port);
+/* bytes as a character stream, four at a time where it can */
+void itm_write(uint8_t port, const uint8_t *data, size_t length);
+/* one 32 bit packet */
+void itm_event(uint8_t port, uint32_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_ITM_H_ */
@@ -0,0 +1,132 @@
+#include <errno.h>
+#include <malloc.h>
+#include <reent.h>
+#include <stddef.h>
+#include "memory.h"
+#include "gd32xxyy.h"
+
+/* what an untouched stack word holds */
+#define MEMORY_STACK_PATTERN    0xA5A5A5A5U
+/* left alone below the caller's stack pointer while painting */
+#define MEMORY_PAINT_MARGIN     64U
+
+/* from the linker script */
+extern uint8_t _sdata[];
+extern uint8_t _enoinit[];          /* end of .bss and .noinit */
+extern uint8_t end[];               /* start of the heap */
+extern uint8_t _eheap[];            /* end of the heap, _heap_end unless it is in external RAM */
+extern uint8_t _heap_end[];         /* bottom of the main stack */
+extern uint8_t _sp[];               /* top of the main stack */
+
+/* the break of _sbrk() and the highest it went */
+static uint8_t *memory_brk = end;
+static uint8_t *memory_brk_peak = end;
+
+/* newlib-nano's list of free chunks, if this is newlib-nano */
+typedef struct memory_chunk {
+    long size;                      /* with the header */
+    struct memory_chunk *next;
+} memory_chunk_t;
+extern memory_chunk_t *__malloc_free_list __attribute__((weak));
+void __malloc_lock(struct _reent *reent);
+void __malloc_unlock(struct _reent *reent);
+
+/*!
+    \brief      move the heap break, for malloc; stops at the end of the heap
+    \param[in]  increment: bytes to add to the heap, negative to give back
+    \param[out] none
+    \retval     the old break, (void *)-1 with errno ENOMEM if the heap is full
+*/
+void *_sbrk(ptrdiff_t increment)
+{
+    uint8_t *old = memory_brk;
+
+    if ((increment > (_eheap - memory_brk)) || (increment < (end - memory_brk))) {
+        errno = ENOMEM;
+        return (void *) -1;
+    }
+    memory_brk += increment;
+    if (memory_brk > memory_brk_peak) {
+        memory_brk_peak = memory_brk;
+    }
+    return old;
+}
+
+/*!
+    \brief      fill the main stack below the caller's frame with the pattern
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void memory_stack_paint(void)
+{
+    uint32_t *word = (uint32_t *)(((uint32_t)_heap_end + 3U) & ~3U);
+    uint32_t *top = (uint32_t *)((__get_MSP() - MEMORY_PAINT_MARGIN) & ~3U);
+
+    while (word < top) {
+        *word++ = MEMORY_STACK_PATTERN;
+    }
+}
+
+/* the heap of malloc, sizes from mallinfo() and newlib-nano's free list */
+static void memory_newlib_heap_stats(memory_stats_t *stats)
+{
+    struct mallinfo info = mallinfo();
+    uint32_t top = (uint32_t)(_eheap - memory_brk);
+    uint32_t largest = top;
+    uint32_t free_total = info.fordblks + top;
+    memory_chunk_t *chunk;
+
+    if (&__malloc_free_list != NULL) {
+        __malloc_lock(_REENT);
+        for (chunk = __malloc_free_list; chunk != NULL; chunk = chunk->next) {
+            uint32_t size = (uint32_t)chunk->size - sizeof(long);
+
+            if (size > largest) {
+                largest = size;
+            }
+        }
+        __malloc_unlock(_REENT);
+    }
+
+    stats->heap_size = (uint32_t)(_eheap - end);
+    stats->heap_used = info.uordblks;
+    stats->heap_peak = (uint32_t)(memory_brk_peak - end);
+    stats->heap_largest_free = largest;
+    stats->heap_fragmentation = (largest >= free_total) ? 0U : (uint8_t)(100U - (largest * 100U) / free_total);
+}
+
+void memory_heap_stats(memory_stats_t *stats) __attribute__((weak, alias("memory_newlib_heap_stats")));
+
+/*!
+    \brief      read the RAM use
+    \param[in]  none
+    \param[out] stats: the figures
+    \retval     none
+*/
+void memory_stats(memory_stats_t *stats)
+{
+    const uint32_t *word = (const uint32_t *)(((uint32_t)_heap_end + 3U) & ~3U);
+
+    while ((word < (const uint32_t *)_sp) && (*word == MEMORY_STACK_PATTERN)) {
+        word++;
+    }
+    stats->static_size = (uint32_t)(_enoinit - _sdata);
+    stats->stack_size = (uint32_t)(_sp - _heap_end);
+    stats->stack_peak = (uint32_t)(_sp - (const uint8_t *)word);
+    memory_heap_stats(stats);
+}
+
+/*!
+    \brief      read the RAM use
+    \param[in]  none
+    \param[out] none
+    \retval     the figures, see memory_stats_t
+*/
+memory_stats_t memoryStats(void)
+{
+    memory_stats_t stats;
+
+    memory_stats(&stats);
+    return stats;
+}
@@ -0,0 +1,50 @@
+#ifndef _GD32_MEMORY_H_
+#define _GD32_MEMORY_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * RAM use. The linker script puts .data, .bss and .noinit at the bottom
+ * of RAM and the main stack, __stack_size bytes, at the top; the heap
+ * grows up from the end of .bss and may take all RAM up to the stack,
+ * no more (malloc fails instead of running into the stack). Variants
+ * with external RAM can link the heap there instead; it then ends at
+ * _eheap, the end of the external RAM.
+ *
+ * init() fills the unused main stack with a pattern, so the deepest the
+ * stack went since reset shows as the first overwritten word. The main
+ * stack is the one of setup() and loop(), and of every interrupt; under
+ * FreeRTOS tasks run on their own stacks (uxTaskGetStackHighWaterMark()).
+ *
+ * The heap figures come from malloc, or from the FreeRTOS heap when the
+ * FreeRTOS library has malloc allocate from it (GD32_FREERTOS_MALLOC).
+ */
+typedef struct {
+    uint32_t static_size;           /* .data, .bss and .noinit */
+    uint32_t heap_size;             /* most the heap can take */
+    uint32_t heap_used;             /* allocated now, with allocator headers */
+    uint32_t heap_peak;             /* most ever allocated, or taken from RAM by malloc */
+    uint32_t heap_largest_free;     /* biggest block an allocation can get now */
+    uint8_t heap_fragmentation;     /* percent of the free heap outside the largest block */
+    uint32_t stack_size;            /* __stack_size of the linker script */
+    uint32_t stack_peak;            /* deepest the main stack went since reset */
+} memory_stats_t;
+
+void memory_stats(memory_stats_t *stats);
+/* fills the heap fields; weak, the FreeRTOS library replaces it */
+void memory_heap_stats(memory_stats_t *stats);
+/* fill the main stack below the caller's frame with the pattern, run by init() */
+void memory_stack_paint(void);
+
+/* memory_stats() for sketches */
+memory_stats_t memoryStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_MEMORY_H_ */
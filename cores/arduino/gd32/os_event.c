@@ -0,0 +1,15 @@
+#include "os_event.h"
+#include "gd32xxyy.h"
+
+void yield(void);
+
+/* give cooperative tasks a turn while waiting, not from interrupts or with them masked */
+void noOsEventWait()
+{
+    if ((0U == __get_IPSR()) && (0U == __get_PRIMASK())) {
+        yield();
+    }
+}
+void noOsEvent() {}
+void os_event_wait(void) __attribute__((weak, alias("noOsEventWait")));
+void os_event_signal(void) __attribute__((weak, alias("noOsEvent")));
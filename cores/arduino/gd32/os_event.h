@@ -0,0 +1,28 @@
+#ifndef _GD32_OS_EVENT_H_
+#define _GD32_OS_EVENT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Hooks for drivers that wait on their own interrupt. ‘os_event_wait’
+ * is called from the wait loop, until the condition it polls comes
+ * true, and ‘os_event_signal’ from the interrupt that may have made it
+ * so. By default the wait calls yield(), so the loops spin unless the
+ * Scheduler library or the sketch gives other work a turn there, and
+ * the signal does nothing; an RTOS can replace them to block the
+ * waiting task in the meantime.
+ *
+ * A wait may return without a signal, and a signal may come before the
+ * wait, so drivers always re-check their condition. An implementation
+ * that blocks should therefore also time out, a tick or so.
+ */
+void os_event_wait(void);
+void os_event_signal(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_OS_EVENT_H_ */
@@ -19,6 +19,8 @@
  */
 #include "pinmap.h"
 #include "PortNames.h"
+#include "critical.h"
+#include "clock.h"
 #include <fatal.h>
 
 extern const int GD_GPIO_MODE[];
@@ -34,15 +36,73 @@ extern const int GD_GPIO_AF[];
 
 uint32_t gpio_clock_enable(uint32_t port_idx);
 
+/* pins whose registers still hold the setting of their last pinMode() call, see wiring_digital.c */
+uint32_t pinmode_configured[GPIO_PORT_NUM] = {0U};
+
+/*
+ * Pins of each port set to a mode other than analog by pin_function().
+ * A port holds one clock reference while any is, so the port is gated
+ * once its last pin goes back to analog, the lowest power mode. Ports
+ * given to gpio_clock_enable() stay clocked for good.
+ */
+static uint32_t gpio_pins_used[GPIO_PORT_NUM];
+static uint32_t gpio_ports_pinned;
+
+static uint32_t gpio_port_get(uint32_t port_idx, rcu_periph_enum *rcu);
+
+/* lookups pinmap_entry() remembers, a power of two */
+#ifndef PINMAP_CACHE_SIZE
+#define PINMAP_CACHE_SIZE       8U
+#endif
+
+typedef struct {
+    const PinMap *map;
+    const PinMap *entry;
+    PinName pin;
+} pinmap_cache_t;
+
+/*
+ * The PinMap_* tables are scanned on every analogRead(), analogWrite() and
+ * driver init; a sketch uses few pins on few maps, so a small direct-mapped
+ * cache of (map, pin) turns the repeated scans into one compare.
+ */
+static pinmap_cache_t pinmap_cache[PINMAP_CACHE_SIZE];
+
+/* the entry of pin in map, or the NC entry that ends map */
+static const PinMap *pinmap_entry(PinName pin, const PinMap *map)
+{
+    uint32_t hash = ((uint32_t)map >> 2) ^ (uint32_t)pin;
+    pinmap_cache_t *cache = &pinmap_cache[(hash ^ (hash >> 3)) & (PINMAP_CACHE_SIZE - 1U)];
+    uint32_t state;
+    const PinMap *entry = NULL;
+
+    /* interrupts may look pins up too, the three fields go together */
+    state = critical_enter();
+    if ((cache->map == map) && (cache->pin == pin)) {
+        entry = cache->entry;
+    }
+    critical_exit(state);
+    if (entry != NULL) {
+        return entry;
+    }
+
+    for (entry = map; entry->pin != NC; entry++) {
+        if (entry->pin == pin) {
+            break;
+        }
+    }
+    state = critical_enter();
+    cache->map = map;
+    cache->pin = pin;
+    cache->entry = entry;
+    critical_exit(state);
+    return entry;
+}
+
 bool pin_in_pinmap(PinName pin, const PinMap *map)
 {
     if (pin != (PinName)NC) {
-        while (map->pin != NC) {
-            if (map->pin == pin) {
-                return true;
-            }
-            map++;
-        }
+        return (pinmap_entry(pin, map)->pin != NC);
     }
     return false;
 }
@@ -65,7 +125,16 @@ void pin_function(PinName pin, int function)
     uint32_t port   = GD_PORT_GET(pin);
     uint32_t gd_pin = 1 << GD_PIN_GET(pin);
 
-    uint32_t gpio = gpio_clock_enable(port);
+    rcu_periph_enum rcu;
+    uint32_t gpio = gpio_port_get(port, &rcu);
+    uint32_t used;
+    uint32_t state;
+
+    /* on for the writes below, whatever the pin ends up as */
+    clock_periph_acquire(rcu);
+
+    /* whoever calls pin_function() now owns the pin, pinMode() has to redo its configuration */
+    pinmode_configured[port] &= ~gd_pin;
 
 #if defined(GD32F30x) || defined(GD32F10x)|| defined(GD32E50X)
     gpio_init(gpio, GD_GPIO_MODE[mode], GD_GPIO_SPEED[speed], gd_pin);
@@ -83,6 +152,25 @@ void pin_function(PinName pin, int function)
     if (GD_GPIO_MODE[mode] == GPIO_MODE_OUTPUT || GD_GPIO_MODE[mode] == GPIO_MODE_AF)
         gpio_output_options_set(gpio, GD_GPIO_OUTPUT_MODE[output], GD_GPIO_SPEED[speed], gd_pin);
 #endif
+
+    state = critical_enter();
+    used = gpio_pins_used[port];
+#if defined(GD32F30x) || defined(GD32F10x)|| defined(GD32E50X)
+    if (GD_GPIO_MODE[mode] == GPIO_MODE_AIN) {
+#else
+    if (GD_GPIO_MODE[mode] == GPIO_MODE_ANALOG) {
+#endif
+        gpio_pins_used[port] &= ~gd_pin;
+    } else {
+        gpio_pins_used[port] |= gd_pin;
+    }
+    if ((used == 0U) && (gpio_pins_used[port] != 0U)) {
+        clock_periph_acquire(rcu);
+    } else if ((used != 0U) && (gpio_pins_used[port] == 0U)) {
+        clock_periph_release(rcu);
+    }
+    critical_exit(state);
+    clock_periph_release(rcu);
 }
 
 void pinmap_pinout(PinName pin, const PinMap *map)
@@ -91,14 +179,9 @@ void pinmap_pinout(PinName pin, const PinMap *map)
         return;
     }
 
-    while (map->pin != NC) {
-        if (map->pin == pin) {
-            pin_function(pin, map->function);
-
-            //pin_mode(pin, PullNone);
-            return;
-        }
-        map++;
+    map = pinmap_entry(pin, map);
+    if (map->pin != NC) {
+        pin_function(pin, map->function);
     }
 }
 
@@ -123,13 +206,8 @@ uint32_t pinmap_merge(uint32_t a, uint32_t b)
 
 uint32_t pinmap_find_peripheral(PinName pin, const PinMap *map)
 {
-    while (map->pin != NC) {
-        if (map->pin == pin) {
-            return map->peripheral;
-        }
-        map++;
-    }
-    return (uint32_t)NC;
+    map = pinmap_entry(pin, map);
+    return (map->pin != NC) ? (uint32_t)map->peripheral : (uint32_t)NC;
 }
 
 uint32_t pinmap_peripheral(PinName pin, const PinMap *map)
@@ -147,13 +225,8 @@ uint32_t pinmap_peripheral(PinName pin, const PinMap *map)
 
 uint32_t pinmap_find_function(PinName pin, const PinMap *map)
 {
-    while (map->pin != NC) {
-        if (map->pin == pin) {
-            return map->function;
-        }
-        map++;
-    }
-    return (uint32_t)NC;
+    map = pinmap_entry(pin, map);
+    return (map->pin != NC) ? (uint32_t)map->function : (uint32_t)NC;
 }
 
 uint32_t pinmap_function(PinName pin, const PinMap *map)
@@ -169,52 +242,65 @@ uint32_t pinmap_function(PinName pin, const PinMap *map)
     return function;
 }
 
-/** Enable GPIO clock
+/** Look up a GPIO port
  *
- * @param gpio_periph gpio port name
+ * @param port_idx port number
+ * @param rcu its clock
+ * @return the GPIO port
  */
-uint32_t gpio_clock_enable(uint32_t port_idx) {
-    uint32_t gpio_add = 0;
+static uint32_t gpio_port_get(uint32_t port_idx, rcu_periph_enum *rcu)
+{
     switch (port_idx) {
         case PORTA:
-            gpio_add = GPIOA;
-            rcu_periph_clock_enable(RCU_GPIOA);
-            break;
+            *rcu = RCU_GPIOA;
+            return GPIOA;
         case PORTB:
-            gpio_add = GPIOB;
-            rcu_periph_clock_enable(RCU_GPIOB);
-            break;
+            *rcu = RCU_GPIOB;
+            return GPIOB;
         case PORTC:
-            gpio_add = GPIOC;
-            rcu_periph_clock_enable(RCU_GPIOC);
-            break;
+            *rcu = RCU_GPIOC;
+            return GPIOC;
 #ifdef GPIOD
         case PORTD:
-            gpio_add = GPIOD;
-            rcu_periph_clock_enable(RCU_GPIOD);
-            break;
+            *rcu = RCU_GPIOD;
+            return GPIOD;
 #endif
 #ifdef GPIOE
         case PORTE:
-            gpio_add = GPIOE;
-            rcu_periph_clock_enable(RCU_GPIOE);
-            break;
+            *rcu = RCU_GPIOE;
+            return GPIOE;
 #endif
 #ifdef GPIOF
         case PORTF:
-            gpio_add = GPIOF;
-            rcu_periph_clock_enable(RCU_GPIOF);
-            break;
+            *rcu = RCU_GPIOF;
+            return GPIOF;
 #endif
 #ifdef GPIOG
         case PORTG:
-            gpio_add = GPIOG;
-            rcu_periph_clock_enable(RCU_GPIOG);
-            break;
+            *rcu = RCU_GPIOG;
+            return GPIOG;
 #endif
         default:
             fatal("port number does not exist");
-            break;
+            *rcu = RCU_GPIOA;
+            return 0;
+    }
+}
+
+/** Enable GPIO clock, for good: for code that drives the port without pin_function()
+ *
+ * @param gpio_periph gpio port name
+ */
+uint32_t gpio_clock_enable(uint32_t port_idx) {
+    rcu_periph_enum rcu;
+    uint32_t gpio_add = gpio_port_get(port_idx, &rcu);
+    uint32_t state;
+
+    state = critical_enter();
+    if ((port_idx < 32U) && !(gpio_ports_pinned & (1UL << port_idx))) {
+        gpio_ports_pinned |= 1UL << port_idx;
+        clock_periph_acquire(rcu);
     }
+    critical_exit(state);
     return gpio_add;
 }
@@ -31,6 +31,8 @@ typedef struct {
     int function;
 } PinMap;
 
+extern uint32_t pinmode_configured[];
+
 uint32_t gpio_clock_enable(uint32_t port_idx);
 void pin_function(PinName pin, int function);
 
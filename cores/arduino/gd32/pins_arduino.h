@@ -187,11 +187,21 @@ extern const uint32_t gpio_port[];
 extern const uint32_t gpio_pin[];
 #define NOT_INTERRUPT            NC
 
+/* digital_pins[] again, visible to the compiler: a constant pin number folds to its PinName
+   without a load, and as nothing indexes this copy at run time it takes no flash */
+#ifdef __cplusplus
+static constexpr PinName digital_pins_const[] = { DIGITAL_PINS_LIST };
+#else
+static const PinName digital_pins_const[] __attribute__((unused)) = { DIGITAL_PINS_LIST };
+#endif
+
 /* Convert a digital pin to a PinName */
 #ifndef ANALOG_PINS_LAST
-#define DIGITAL_TO_PINNAME(p)      (((uint32_t)p < DIGITAL_PINS_NUM) ? digital_pins[p] : NC)
+#define DIGITAL_TO_PINNAME(p)      ((__builtin_constant_p(p) && ((uint32_t)p < DIGITAL_PINS_NUM)) ? digital_pins_const[p] : \
+                                    ((uint32_t)p < DIGITAL_PINS_NUM) ? digital_pins[p] : NC)
 #else
-#define DIGITAL_TO_PINNAME(p)      (((uint32_t)p < DIGITAL_PINS_NUM) ? digital_pins[p] : \
+#define DIGITAL_TO_PINNAME(p)      ((__builtin_constant_p(p) && ((uint32_t)p < DIGITAL_PINS_NUM)) ? digital_pins_const[p] : \
+                                    ((uint32_t)p < DIGITAL_PINS_NUM) ? digital_pins[p] : \
                                     ((uint32_t)p >= ANALOG_PINS_START) && ((uint32_t)p <= ANALOG_PINS_LAST) ? \
                                     digital_pins[analog_pins[p-ANALOG_PINS_START]] : NC)
 #endif
@@ -249,6 +259,19 @@ PinName analog_pin_to_PinName(uint32_t pin);
 #define PORT_CLEAR_REG(p)            (GPIO_BC(p))
 #endif
 
+/* Toggle the pins of mask with a single store: parts with a bit toggle register use it,
+   the others read OCTL once and set the low pins / reset the high pins through BOP */
+static inline void port_toggle(uint32_t p, uint32_t mask)
+{
+#if defined(GD32F3x0) || defined(GD32E23x)
+    GPIO_TG(p) = mask;
+#else
+    uint32_t high = GPIO_OCTL(p) & mask;
+
+    GPIO_BOP(p) = (high << 16) | (high ^ mask);
+#endif
+}
+
 #if defined(GD32F30x)
 #define PORT_CTL_REG(p)             (GPIO_CTL0(P))
 #else
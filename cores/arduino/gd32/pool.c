@@ -0,0 +1,159 @@
+#include "pool.h"
+#include "gd32xxyy.h"
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_BASE__) || defined(__ARM_ARCH_8M_MAIN__)
+#define POOL_EXCLUSIVE          1
+#else
+#define POOL_EXCLUSIVE          0
+#endif
+
+#if POOL_EXCLUSIVE
+
+/* *value += delta, atomically */
+static inline void pool_add(volatile uint32_t *value, int32_t delta)
+{
+    uint32_t old;
+
+    do {
+        old = __LDREXW(value);
+    } while (__STREXW(old + (uint32_t)delta, value) != 0U);
+}
+
+/* a block from the free list, NULL if it is empty */
+static inline pool_block_t *pool_pop(pool_t *pool)
+{
+    pool_block_t *block;
+
+    do {
+        block = (pool_block_t *)__LDREXW((volatile uint32_t *)&pool->free);
+        if (block == NULL) {
+            __CLREX();
+            return NULL;
+        }
+        /* if block was taken meanwhile, an interrupt ran and the store fails */
+    } while (__STREXW((uint32_t)block->next, (volatile uint32_t *)&pool->free) != 0U);
+    return block;
+}
+
+static inline void pool_push(pool_t *pool, pool_block_t *block)
+{
+    do {
+        block->next = (pool_block_t *)__LDREXW((volatile uint32_t *)&pool->free);
+    } while (__STREXW((uint32_t)block, (volatile uint32_t *)&pool->free) != 0U);
+}
+
+/* the index of a never used block, count if there is none left */
+static inline uint32_t pool_take_fresh(pool_t *pool)
+{
+    uint32_t index;
+
+    do {
+        index = __LDREXW(&pool->fresh);
+        if (index >= pool->count) {
+            __CLREX();
+            return index;
+        }
+    } while (__STREXW(index + 1U, &pool->fresh) != 0U);
+    return index;
+}
+
+#else
+
+static inline void pool_add(volatile uint32_t *value, int32_t delta)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    *value += (uint32_t)delta;
+    __set_PRIMASK(primask);
+}
+
+static inline pool_block_t *pool_pop(pool_t *pool)
+{
+    uint32_t primask = __get_PRIMASK();
+    pool_block_t *block;
+
+    __disable_irq();
+    block = pool->free;
+    if (block != NULL) {
+        pool->free = block->next;
+    }
+    __set_PRIMASK(primask);
+    return block;
+}
+
+static inline void pool_push(pool_t *pool, pool_block_t *block)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    block->next = pool->free;
+    pool->free = block;
+    __set_PRIMASK(primask);
+}
+
+static inline uint32_t pool_take_fresh(pool_t *pool)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t index;
+
+    __disable_irq();
+    index = pool->fresh;
+    if (index < pool->count) {
+        pool->fresh = index + 1U;
+    }
+    __set_PRIMASK(primask);
+    return index;
+}
+
+#endif /* POOL_EXCLUSIVE */
+
+/*!
+    \brief      take a block from a pool, from any context
+    \param[in]  pool: the pool
+    \param[out] none
+    \retval     the block, NULL if all are in use
+*/
+void *pool_alloc(pool_t *pool)
+{
+    pool_block_t *block = pool_pop(pool);
+    uint32_t index;
+
+    if (block == NULL) {
+        index = pool_take_fresh(pool);
+        if (index >= pool->count) {
+            pool_add(&pool->misses, 1);
+            return NULL;
+        }
+        block = (pool_block_t *)(pool->storage + index * pool->block_size);
+    }
+    pool_add(&pool->used, 1);
+    return block;
+}
+
+/*!
+    \brief      give a block back to its pool, from any context
+    \param[in]  pool: the pool the block came from
+    \param[in]  block: the block, NULL is ignored
+    \param[out] none
+    \retval     none
+*/
+void pool_free(pool_t *pool, void *block)
+{
+    if (block == NULL) {
+        return;
+    }
+    pool_add(&pool->used, -1);
+    pool_push(pool, (pool_block_t *)block);
+}
+
+/*!
+    \brief      blocks of a pool handed out now
+    \param[in]  pool: the pool
+    \param[out] none
+    \retval     the count, a snapshot for diagnostics
+*/
+uint32_t pool_used(const pool_t *pool)
+{
+    return pool->used;
+}
@@ -0,0 +1,63 @@
+#ifndef _GD32_POOL_H_
+#define _GD32_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Fixed-block memory pools. A pool hands out blocks of one size from a
+ * static array in constant time, without malloc, fragmentation or a
+ * lock: pool_alloc() and pool_free() may be called from any interrupt
+ * and from threads at the same time. Freed blocks go on a list linked
+ * through their first word; blocks never used yet are taken from the end
+ * of the array, so a zero-initialized pool needs no set-up call.
+ *
+ * The list is updated with LDREX/STREX, which all GD32 cores have; an
+ * interrupt between the two clears the exclusive monitor and the update
+ * is retried, so a block taken and given back meanwhile can't corrupt
+ * the list. Built for a core without them (a host build) it falls back
+ * to masking interrupts.
+ *
+ *   static my_item_t items[8];
+ *   static pool_t item_pool = POOL_INIT(items, sizeof(my_item_t), 8);
+ *
+ * or POOL_DEFINE(item_pool, my_item_t, 8), and FixedPool<T, N> in C++.
+ */
+typedef struct pool_block {
+    struct pool_block *next;
+} pool_block_t;
+
+typedef struct {
+    pool_block_t *volatile free;    /* blocks given back */
+    uint8_t *storage;
+    uint16_t block_size;            /* at least a pointer, multiple of 4 */
+    uint16_t count;
+    volatile uint32_t fresh;        /* blocks taken from storage so far */
+    volatile uint32_t used;         /* blocks handed out now */
+    volatile uint32_t misses;       /* pool_alloc() calls that found the pool empty */
+} pool_t;
+
+#define POOL_INIT(storage, block_size, count) \
+    { NULL, (uint8_t *)(storage), (uint16_t)(block_size), (uint16_t)(count), 0U, 0U, 0U }
+
+/* a static pool of count blocks of type, storage included */
+#define POOL_DEFINE(name, type, count) \
+    static union { type item; pool_block_t link; } name##_storage[count]; \
+    static pool_t name = POOL_INIT(name##_storage, sizeof(name##_storage[0]), count)
+
+/* a block, NULL if all are in use */
+void *pool_alloc(pool_t *pool);
+/* give a block of this pool back, NULL is ignored */
+void pool_free(pool_t *pool, void *block);
+/* blocks handed out now; a snapshot, for diagnostics */
+uint32_t pool_used(const pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_POOL_H_ */
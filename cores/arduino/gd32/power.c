@@ -0,0 +1,172 @@
+#include "power.h"
+#include "gd32xxyy.h"
+
+#if defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+#define POWER_RCU_CTL       RCU_CTL0
+#define POWER_HXTALEN       RCU_CTL0_HXTALEN
+#define POWER_HXTALSTB      RCU_CTL0_HXTALSTB
+#define POWER_PLLEN         RCU_CTL0_PLLEN
+#define POWER_PLLSTB        RCU_CTL0_PLLSTB
+#else
+#define POWER_RCU_CTL       RCU_CTL
+#define POWER_HXTALEN       RCU_CTL_HXTALEN
+#define POWER_HXTALSTB      RCU_CTL_HXTALSTB
+#define POWER_PLLEN         RCU_CTL_PLLEN
+#define POWER_PLLSTB        RCU_CTL_PLLSTB
+#endif
+
+#if defined(PMU_CTL_HDEN)
+#define POWER_PMU_CTL       PMU_CTL
+#define POWER_PMU_CS        PMU_CS
+#define POWER_HDEN          PMU_CTL_HDEN
+#define POWER_HDS           PMU_CTL_HDS
+#define POWER_HDRF          PMU_CS_HDRF
+#define POWER_HDSRF         PMU_CS_HDSRF
+#elif defined(PMU_CTL0_HDEN)
+#define POWER_PMU_CTL       PMU_CTL0
+#define POWER_PMU_CS        PMU_CS0
+#define POWER_HDEN          PMU_CTL0_HDEN
+#define POWER_HDS           PMU_CTL0_HDS
+#define POWER_HDRF          PMU_CS0_HDRF
+#define POWER_HDSRF         PMU_CS0_HDSRF
+#endif
+
+/* the clock tree as SystemInit() or clock_set_system() left it */
+typedef struct {
+    uint32_t ctl;
+    uint32_t cfg0;
+#if defined(RCU_ADDCTL_IRC48MEN)
+    uint32_t addctl;
+#endif
+#if defined(POWER_HDEN)
+    uint32_t pmu_ctl;
+#endif
+} power_clocks_t;
+
+static void power_clocks_save(power_clocks_t *clocks)
+{
+    clocks->ctl = POWER_RCU_CTL;
+    clocks->cfg0 = RCU_CFG0;
+#if defined(RCU_ADDCTL_IRC48MEN)
+    clocks->addctl = RCU_ADDCTL;
+#endif
+#if defined(POWER_HDEN)
+    clocks->pmu_ctl = POWER_PMU_CTL;
+#endif
+}
+
+/* deep-sleep wakes up on IRC8M with HXTAL, IRC48M and the PLLs off */
+static void power_clocks_restore(const power_clocks_t *clocks)
+{
+    if (clocks->ctl & POWER_HXTALEN) {
+        POWER_RCU_CTL |= POWER_HXTALEN;
+        while (0U == (POWER_RCU_CTL & POWER_HXTALSTB)) {
+        }
+    }
+#if defined(RCU_ADDCTL_IRC48MEN)
+    if (clocks->addctl & RCU_ADDCTL_IRC48MEN) {
+        RCU_ADDCTL |= RCU_ADDCTL_IRC48MEN;
+        while (0U == (RCU_ADDCTL & RCU_ADDCTL_IRC48MSTB)) {
+        }
+    }
+#endif
+#if defined(RCU_CTL_PLL1EN)
+    /* PLL1 and PLL2 may feed PREDV0, so they come before the PLL */
+    if (clocks->ctl & RCU_CTL_PLL1EN) {
+        RCU_CTL |= RCU_CTL_PLL1EN;
+        while (0U == (RCU_CTL & RCU_CTL_PLL1STB)) {
+        }
+    }
+    if (clocks->ctl & RCU_CTL_PLL2EN) {
+        RCU_CTL |= RCU_CTL_PLL2EN;
+        while (0U == (RCU_CTL & RCU_CTL_PLL2STB)) {
+        }
+    }
+#endif
+    if (clocks->ctl & POWER_PLLEN) {
+        POWER_RCU_CTL |= POWER_PLLEN;
+        while (0U == (POWER_RCU_CTL & POWER_PLLSTB)) {
+        }
+    }
+#if defined(POWER_HDEN)
+    /* deep-sleep drops the high-driver mode, which the PLL may need */
+    if (clocks->pmu_ctl & POWER_HDEN) {
+        POWER_PMU_CTL |= POWER_HDEN;
+        while (0U == (POWER_PMU_CS & POWER_HDRF)) {
+        }
+        POWER_PMU_CTL |= POWER_HDS;
+        while (0U == (POWER_PMU_CS & POWER_HDSRF)) {
+        }
+    }
+#endif
+    RCU_CFG0 = (RCU_CFG0 & ~RCU_CFG0_SCS) | (clocks->cfg0 & RCU_CFG0_SCS);
+    /* SCSS mirrors SCS two bits up */
+    while ((RCU_CFG0 & RCU_CFG0_SCSS) != ((clocks->cfg0 & RCU_CFG0_SCS) << 2)) {
+    }
+}
+
+void power_sleep(void)
+{
+    pmu_to_sleepmode(WFI_CMD);
+}
+
+void power_deepsleep(void)
+{
+    power_clocks_t clocks;
+    uint32_t primask = __get_PRIMASK();
+
+    rcu_periph_clock_enable(RCU_PMU);
+    /* a pending interrupt still ends WFI, it just runs once the clocks are back */
+    __disable_irq();
+    power_clocks_save(&clocks);
+#if defined(GD32F30x)
+    pmu_to_deepsleepmode(PMU_LDO_LOWPOWER, PMU_LOWDRIVER_ENABLE, WFI_CMD);
+#else
+    pmu_to_deepsleepmode(PMU_LDO_LOWPOWER, WFI_CMD);
+#endif
+    power_clocks_restore(&clocks);
+    __set_PRIMASK(primask);
+}
+
+void power_standby(void)
+{
+    rcu_periph_clock_enable(RCU_PMU);
+#if defined(GD32F30x) || defined(GD32F10x) || defined(GD32F1x0)
+    pmu_to_standbymode();
+#else
+    pmu_to_standbymode(WFI_CMD);
+#endif
+    /* not reached, standby ends in a reset */
+    while (1) {
+    }
+}
+
+void power_wakeup_pin(bool enable)
+{
+    rcu_periph_clock_enable(RCU_PMU);
+#if defined(GD32F30x) || defined(GD32F10x)
+    if (enable) {
+        pmu_wakeup_pin_enable();
+    } else {
+        pmu_wakeup_pin_disable();
+    }
+#else
+    if (enable) {
+        pmu_wakeup_pin_enable(PMU_WAKEUP_PIN0);
+    } else {
+        pmu_wakeup_pin_disable(PMU_WAKEUP_PIN0);
+    }
+#endif
+}
+
+bool power_woke_from_standby(void)
+{
+    bool woke;
+
+    rcu_periph_clock_enable(RCU_PMU);
+    woke = (RESET != pmu_flag_get(PMU_FLAG_STANDBY));
+    if (woke) {
+        pmu_flag_clear(PMU_FLAG_RESET_STANDBY);
+    }
+    return woke;
+}
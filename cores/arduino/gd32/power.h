@@ -0,0 +1,32 @@
+#ifndef _GD32_POWER_H_
+#define _GD32_POWER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * PMU low power modes. ‘power_sleep’ stops the core until the next
+ * interrupt. ‘power_deepsleep’ also stops the high speed clocks and SysTick
+ * until an EXTI line fires (pin interrupts, the RTC alarm on EXTI 17), then
+ * brings HXTAL, the PLLs and the system clock selection back as they were
+ * before returning. Interrupts that woke the core are serviced after that,
+ * at full speed. ‘power_standby’ turns off everything but the backup
+ * domain; the next wakeup is a reset.
+ */
+void power_sleep(void);
+void power_deepsleep(void);
+void power_standby(void);
+/* the WKUP pin (PA0) wakes the part up from standby on a rising edge */
+void power_wakeup_pin(bool enable);
+/* the last reset was a wakeup from standby; reading clears the flag */
+bool power_woke_from_standby(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_POWER_H_ */
@@ -26,6 +26,8 @@ OF SUCH DAMAGE.
 */
 
 #include "rtc.h"
+#include "irq_profile.h"
+#include "irq_priority.h"
 #include <time.h>
 
 /* 
@@ -35,6 +37,28 @@ OF SUCH DAMAGE.
 */
 //#define KILL_RTC_BACKUP_DOMAIN_ON_RESTART
 
+#if defined(GD32F30x) || defined(GD32E50X)
+/* the prescaler set by rtc_Init(), the divider counts down from it once per second */
+#define RTC_DIVIDER_RELOAD      32767U
+/* periodic wakeup period in seconds, 0 while the alarm is free for rtc_setAlarmTime() */
+static volatile uint32_t rtc_wakeupPeriod;
+/* counter value of the next wakeup */
+static uint32_t rtc_wakeupNext;
+/* the GD32E50x connectivity line and GD32E508 headers spell it in capitals */
+#if !defined(RTC_Alarm_IRQn) && (defined(GD32E50X_CL) || defined(GD32E508))
+#define RTC_Alarm_IRQn          RTC_ALARM_IRQn
+#endif
+#elif defined(GD32F3x0) || defined(GD32F1x0)
+/* the synchronous prescaler set by rtc_prescaler_set(), RTC_SS counts down from it */
+#define RTC_SUBSECOND_RELOAD    0xFFU
+#define RTC_TICKS_PER_SECOND    (RTC_SUBSECOND_RELOAD + 1U)
+#define RTC_TICKS_PER_DAY       (SECONDS_PER_DAY * RTC_TICKS_PER_SECOND)
+/* periodic wakeup period in sub-second ticks, 0 while the alarm is free for rtc_setAlarmTime() */
+static volatile uint32_t rtc_wakeupPeriod;
+/* sub-second ticks since midnight of the next wakeup */
+static uint32_t rtc_wakeupNext;
+#endif
+
 #if defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
 /*
  * wrapper functions for microcontrollers that have an RTC
@@ -77,6 +101,33 @@ uint32_t rtc_counter_get()
 }
 #endif
 
+#if defined(GD32F30x) || defined(GD32E50X)
+/*!
+    \brief      convert days since 1970-01-01 to a date; the last date is cached since
+                timestamps mostly fall on the same day
+    \param[in]  days: days since 1970-01-01
+    \param[out] utcTime: year, month and day are set
+    \retval     none
+*/
+static void rtc_dateFromDays(uint32_t days, UTCTimeStruct *utcTime)
+{
+    static uint32_t cachedDays = UINT32_MAX;
+    static UTCTimeStruct cachedDate;
+    uint32_t state;
+
+    /* the RTC interrupt may convert too, so the cache is only touched with interrupts off */
+    state = critical_enter();
+    if (days != cachedDays) {
+        calendar_dateFromDays(days, &cachedDate);
+        cachedDays = days;
+    }
+    utcTime->year = cachedDate.year;
+    utcTime->month = cachedDate.month;
+    utcTime->day = cachedDate.day;
+    critical_exit(state);
+}
+#endif
+
 /*!
     \brief      rtc init
     \param[in]  none
@@ -85,15 +136,9 @@ uint32_t rtc_counter_get()
 */
 void rtc_Init(void)
 {
-#if defined(GD32E23x)
-    /* no prio group */
-    nvic_irq_enable(RTC_IRQn, 2);
-#else
-    nvic_priority_group_set(NVIC_PRIGROUP_PRE2_SUB2);
-    nvic_irq_enable(RTC_IRQn, 2, 0);
-#endif 
+    irq_priority_enable(RTC_IRQn, IRQ_PRIO_RTC);
 #if defined(GD32F30x) || defined(GD32E50X)
-    nvic_irq_enable(RTC_Alarm_IRQn, 2, 0);
+    irq_priority_enable(RTC_Alarm_IRQn, IRQ_PRIO_RTC);
     /* enable PMU and BKPI clocks */
     rcu_periph_clock_enable(RCU_BKPI);
 #endif
@@ -177,20 +222,7 @@ void rtc_getUTCTime(UTCTimeStruct *utcTime)
     utcTime->minutes = (day % 3600) / 60;
     utcTime->seconds = day % 60;
 
-    {
-        uint32_t numDays = timestamp / SECONDS_PER_DAY;
-
-        while (numDays >= YearLength(utcTime->year)) {
-            numDays -= YearLength(utcTime->year);
-            utcTime->year++;
-        }
-
-        while (numDays >= monthLength(IsLeapYear(utcTime->year), utcTime->month)) {
-            numDays -= monthLength(IsLeapYear(utcTime->year), utcTime->month);
-            utcTime->month++;
-        }
-        utcTime->day += numDays;
-    }
+    rtc_dateFromDays(timestamp / SECONDS_PER_DAY, utcTime);
 #elif defined(GD32F3x0) || defined(GD32F1x0)
     rtc_parameter_struct curr_date;
     rtc_current_time_get(&curr_date);
@@ -244,6 +276,36 @@ uint32_t rtc_getSecTime(void)
     return rtc_counter_get();
 }
 
+/*!
+    \brief      rtc get second time with the milliseconds into the current second
+    \param[in]  none
+    \param[out] ms: milliseconds, 0..999
+    \retval     second counts
+*/
+uint32_t rtc_getSecTimeMs(uint16_t *ms)
+{
+#if defined(GD32F30x) || defined(GD32E50X)
+    uint32_t secTime, divider;
+
+    /* the divider reloads as the counter steps, so read until both belong together */
+    do {
+        secTime = rtc_counter_get();
+        divider = rtc_divider_get();
+    } while (secTime != rtc_counter_get());
+    *ms = (uint16_t)(((RTC_DIVIDER_RELOAD - divider) * 1000U) / (RTC_DIVIDER_RELOAD + 1U));
+    return secTime;
+#elif defined(GD32F3x0) || defined(GD32F1x0)
+    /* reading RTC_SS freezes the time and date shadows until the date is read */
+    uint32_t subSecond = RTC_SS & RTC_SS_SSC;
+
+    *ms = (uint16_t)(((RTC_SUBSECOND_RELOAD - subSecond) * 1000U) / RTC_TICKS_PER_SECOND);
+    return rtc_getSecTime();
+#else
+    *ms = 0U;
+    return rtc_getSecTime();
+#endif
+}
+
 /*!
     \brief      rtc set alarm time
     \param[in]  alarmTime: alarm time
@@ -282,6 +344,119 @@ void rtc_setAlarmTime(uint32_t alarmTime)
 #endif
 }
 
+#if defined(GD32F3x0) || defined(GD32F1x0)
+static uint8_t rtc_toBcd(uint32_t value)
+{
+    return (uint8_t)(((value / 10U) << 4) | (value % 10U));
+}
+
+static uint32_t rtc_fromBcd(uint32_t bcd)
+{
+    return (bcd >> 4) * 10U + (bcd & 0x0FU);
+}
+
+/* sub-second ticks since midnight */
+static uint32_t rtc_ticksOfDay(void)
+{
+    uint32_t subSecond = RTC_SS & RTC_SS_SSC;
+    uint32_t time = RTC_TIME;
+    uint32_t secOfDay;
+
+    /* releases the shadows frozen by reading RTC_SS */
+    (void)RTC_DATE;
+    secOfDay = rtc_fromBcd(GET_TIME_HR(time)) * SECONDS_PER_HOUR
+               + rtc_fromBcd(GET_TIME_MN(time)) * SECONDS_PER_MINUTE + rtc_fromBcd(GET_TIME_SC(time));
+    return secOfDay * RTC_TICKS_PER_SECOND + (RTC_SUBSECOND_RELOAD - subSecond);
+}
+
+/* alarm at a time of day, down to the sub-second tick */
+static void rtc_wakeupArm(uint32_t ticks)
+{
+    rtc_alarm_struct alarm;
+    uint32_t secOfDay = ticks / RTC_TICKS_PER_SECOND;
+
+    alarm.rtc_alarm_mask = RTC_ALARM_DATE_MASK;
+    alarm.rtc_weekday_or_date = RTC_ALARM_DATE_SELECTED;
+    alarm.rtc_alarm_day = 1;
+    alarm.rtc_am_pm = RTC_AM;
+    alarm.rtc_alarm_hour = rtc_toBcd(secOfDay / SECONDS_PER_HOUR);
+    alarm.rtc_alarm_minute = rtc_toBcd((secOfDay / SECONDS_PER_MINUTE) % 60U);
+    alarm.rtc_alarm_second = rtc_toBcd(secOfDay % 60U);
+    rtc_alarm_disable();
+    rtc_alarm_config(&alarm);
+    rtc_alarm_subsecond_config(RTC_MASKSSC_8_14,
+                               RTC_SUBSECOND_RELOAD - (ticks % RTC_TICKS_PER_SECOND));
+    rtc_alarm_enable();
+}
+#endif
+
+/* schedule the wakeup after the one that just fired, called from the alarm interrupt */
+#if defined(GD32F30x) || defined(GD32E50X)
+static void rtc_wakeupAdvance(void)
+{
+    uint32_t now = rtc_getSecTime();
+
+    rtc_wakeupNext += rtc_wakeupPeriod;
+    /* a wakeup served too late starts over rather than wait for the counter to come round */
+    if ((int32_t)(rtc_wakeupNext - now) <= 0) {
+        rtc_wakeupNext = now + rtc_wakeupPeriod;
+    }
+    rtc_alarm_config(rtc_wakeupNext);
+}
+#elif defined(GD32F3x0) || defined(GD32F1x0)
+static void rtc_wakeupAdvance(void)
+{
+    uint32_t now = rtc_ticksOfDay();
+
+    rtc_wakeupNext = (rtc_wakeupNext + rtc_wakeupPeriod) % RTC_TICKS_PER_DAY;
+    if ((rtc_wakeupNext + RTC_TICKS_PER_DAY - now) % RTC_TICKS_PER_DAY > rtc_wakeupPeriod) {
+        rtc_wakeupNext = (now + rtc_wakeupPeriod) % RTC_TICKS_PER_DAY;
+    }
+    rtc_wakeupArm(rtc_wakeupNext);
+}
+#endif
+
+/*!
+    \brief      rtc periodic wakeup, raises INT_WAKEUP_MODE every period; it runs on the
+                alarm, which is not available to rtc_setAlarmTime() meanwhile
+    \param[in]  ms: period in milliseconds, 0 stops the wakeup; rounded up to whole seconds
+                on GD32F30x/E50x, to 1/256 s and at most a day on GD32F3x0/F1x0
+    \param[out] none
+    \retval     the period used in milliseconds, 0 if the RTC has no wakeup
+*/
+uint32_t rtc_setWakeupPeriod(uint32_t ms)
+{
+#if defined(GD32F30x) || defined(GD32E50X)
+    uint32_t period = (ms + 999U) / 1000U;
+
+    rtc_wakeupPeriod = 0U;
+    if (0U != period) {
+        rtc_wakeupNext = rtc_getSecTime() + period;
+        rtc_setAlarmTime(rtc_wakeupNext);
+        rtc_wakeupPeriod = period;
+    }
+    return period * 1000U;
+#elif defined(GD32F3x0) || defined(GD32F1x0)
+    uint32_t period = (uint32_t)(((uint64_t)ms * RTC_TICKS_PER_SECOND + 999U) / 1000U);
+
+    if (period >= RTC_TICKS_PER_DAY) {
+        period = RTC_TICKS_PER_DAY - 1U;
+    }
+    rtc_wakeupPeriod = 0U;
+    if (0U != period) {
+        rtc_wakeupNext = (rtc_ticksOfDay() + period) % RTC_TICKS_PER_DAY;
+        rtc_wakeupArm(rtc_wakeupNext);
+        rtc_wakeupPeriod = period;
+    } else {
+        rtc_alarm_disable();
+    }
+    return (uint32_t)(((uint64_t)period * 1000U) / RTC_TICKS_PER_SECOND);
+#else
+    (void)ms;
+    return 0U;
+#endif
+}
+
 /*!
     \brief      rtc attach interrupt
     \param[in]  mode: interrupt mode
@@ -298,6 +473,7 @@ void rtc_attachInterrupt(INT_MODE mode)
             break;
 #endif
         case INT_ALARM_MODE:
+        case INT_WAKEUP_MODE:
             interrupt = RTC_INT_ALARM;
             exti_init(EXTI_17, EXTI_INTERRUPT, EXTI_TRIG_RISING);
             break;
@@ -328,6 +504,10 @@ void rtc_detachInterrupt(INT_MODE mode)
         case INT_ALARM_MODE:
             interrupt = RTC_INT_ALARM;
             break;
+        case INT_WAKEUP_MODE:
+            interrupt = RTC_INT_ALARM;
+            rtc_setWakeupPeriod(0U);
+            break;
 #if defined(GD32F30x) || defined(GD32E50X)
         case INT_OVERFLOW_MODE:
             interrupt = RTC_INT_OVERFLOW;
@@ -343,8 +523,9 @@ void rtc_detachInterrupt(INT_MODE mode)
     \param[out] none
     \retval     none
 */
-void RTC_IRQHandler(void)
+__attribute__((used)) void RTC_IRQHandler(void)
 {
+    IRQ_PROFILE();
 #if defined(GD32F30x) || defined(GD32E50X)
     if (rtc_flag_get(RTC_FLAG_SECOND) != RESET) {
         rtc_flag_clear(RTC_FLAG_SECOND);
@@ -358,7 +539,12 @@ void RTC_IRQHandler(void)
     if (rtc_flag_get(RTC_FLAG_ALARM0) != RESET) {
         rtc_flag_clear(RTC_FLAG_ALARM0);
         exti_flag_clear(EXTI_17);
-        RTC_Handler(INT_ALARM_MODE);
+        if (0U != rtc_wakeupPeriod) {
+            rtc_wakeupAdvance();
+            RTC_Handler(INT_WAKEUP_MODE);
+        } else {
+            RTC_Handler(INT_ALARM_MODE);
+        }
     }
 #endif
 }
@@ -370,67 +556,18 @@ void RTC_IRQHandler(void)
     \retval     none
 */
 #if defined(GD32F30x) || defined(GD32E50X)
-void RTC_Alarm_IRQHandler(void)
+__attribute__((used)) void RTC_Alarm_IRQHandler(void)
 {
+    IRQ_PROFILE();
     if (rtc_flag_get(RTC_FLAG_ALARM) != RESET) {
         rtc_flag_clear(RTC_FLAG_ALARM);
         exti_flag_clear(EXTI_17);
-        RTC_Handler(INT_ALARM_MODE);
-    }
-}
-#endif
-
-/*!
-    \brief      get month length
-    \param[in]  lpyr: is leap year
-    \param[in]  mon: month
-    \param[out] none
-    \retval     month lenth
-*/
-uint8_t monthLength(uint8_t lpyr, uint8_t mon)
-{
-    uint8_t days = 30;
-
-    if (mon == 2) { // feb
-        days = (28 + lpyr);
-    } else {
-        if (mon > 7) { // aug-dec
-            mon--;
-        }
-
-        if (mon & 1) {
-            days = 31;
-        }
-    }
-
-    return (days);
-}
-
-/*!
-    \brief      make utcTime to second counts
-    \param[in]  alarmTime: alarm time
-    \param[out] none
-    \retval     second counts
-*/
-uint32_t mkTimtoStamp(UTCTimeStruct *utcTime)
-{
-    uint16_t year = utcTime->year;
-    uint8_t mon = utcTime->month;
-    uint8_t day = utcTime->day;
-    uint32_t numDays = 0;
-    uint32_t timestamp = 0;
-    while (1969 != --year) {
-        if (IsLeapYear(year)) {
-            numDays += 366;
+        if (0U != rtc_wakeupPeriod) {
+            rtc_wakeupAdvance();
+            RTC_Handler(INT_WAKEUP_MODE);
         } else {
-            numDays += 365;
+            RTC_Handler(INT_ALARM_MODE);
         }
     }
-    while (0 != --mon) {
-        numDays += monthLength(IsLeapYear(utcTime->year), mon);
-    }
-    numDays = numDays + day - 1;
-    timestamp = numDays * SECONDS_PER_DAY + (utcTime->hour * 3600 + utcTime->minutes * 60 +
-                                             utcTime->seconds);
-    return timestamp;
 }
+#endif
@@ -29,27 +29,13 @@ OF SUCH DAMAGE.
 #define _GD_RTC_H_
 
 #include "gd32xxyy.h"
+#include "calendar.h"
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
-#define IsLeapYear(yr) (!((yr) % 400) || (((yr) % 100) && !((yr) % 4)))
-#define YearLength(yr)  ((uint16_t)(IsLeapYear(yr) ? 366 : 365))
-#define SECONDS_PER_MINUTE    60UL
-#define SECONDS_PER_HOUR      3600UL
-#define SECONDS_PER_DAY       86400UL
-
-typedef struct {
-    uint16_t year;    // 1970+
-    uint8_t month;    // 1-12
-    uint8_t day;      // 1-31
-    uint8_t hour;     // 0-23
-    uint8_t minutes;  // 0-59
-    uint8_t seconds;  // 0-59
-} UTCTimeStruct;
-
 typedef enum {
     RTC_ALARM_S,
     RTC_ALARM_M,
@@ -59,22 +45,22 @@ typedef enum {
 typedef enum {
     INT_SECOND_MODE,
     INT_ALARM_MODE,
-    INT_OVERFLOW_MODE
+    INT_OVERFLOW_MODE,
+    INT_WAKEUP_MODE         /* periodic wakeup, see rtc_setWakeupPeriod() */
 } INT_MODE;
 
 void rtc_Init(void);                                            //rtc init
 void rtc_setUTCTime(UTCTimeStruct *utcTime);                    //rtc set UTC time
 void rtc_setSecTime(uint32_t secTime);                          //rtc set second time
 uint32_t rtc_getSecTime(void);                                  //rtc get second time
+uint32_t rtc_getSecTimeMs(uint16_t *ms);                        //rtc get second time and milliseconds
 void rtc_getUTCTime(UTCTimeStruct *utcTime);                    //rtc get UTC time
 void rtc_setAlarmTime(uint32_t alarmTime);                      //rtc set alarm time
+uint32_t rtc_setWakeupPeriod(uint32_t ms);                      //rtc periodic wakeup, takes over the alarm
 void rtc_attachInterrupt(INT_MODE mode);                        //rtc attach interrupt
 void rtc_detachInterrupt(INT_MODE mode);                        //rtc detach interrupt
 extern void RTC_Handler(INT_MODE mode);                         //rtc irq handler
 
-uint8_t monthLength(uint8_t lpyr, uint8_t mon);                 //get month length
-uint32_t mkTimtoStamp(UTCTimeStruct *utcTime);                  //make utcTime to second counts
-
 #ifdef __cplusplus
 }
 #endif
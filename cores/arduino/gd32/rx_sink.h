@@ -0,0 +1,21 @@
+/*
+    Where a driver hands what it receives from its interrupt, in place of
+    its own RX ring, see HardwareSerial::setRxSink() and
+    CDCACM_::setRxSink().
+*/
+
+#ifndef RX_SINK_H
+#define RX_SINK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    /* number of bytes it can take now */
+    size_t (*space)(void *arg);
+    /* take len bytes, never more than space() returned */
+    void (*write)(void *arg, const uint8_t *data, size_t len);
+    void *arg;
+} rx_sink_t;
+
+#endif /* RX_SINK_H */
@@ -0,0 +1,206 @@
+#include <stddef.h>
+#include "soft_timer.h"
+#include "clock.h"
+#include "systick.h"
+#include "timer.h"
+#include "irq_priority.h"
+#include "pins_arduino.h"
+
+#ifndef TIMER_SOFT
+#define TIMER_SOFT                  TIMER_TONE
+#endif
+
+/* the hardware timer counts microseconds, 16 bits of them */
+#define SOFT_TIMER_MAX_ARM_US       0xFFFFU
+/* the counter has to count at least once to reach an update */
+#define SOFT_TIMER_MIN_ARM_US       2U
+
+static soft_timer_t *soft_timers;
+static bool soft_timer_ready;
+static clock_listener_t soft_timer_clock;
+
+static void soft_timer_prescaler(void)
+{
+    TIMER_PSC(TIMER_SOFT) = getTimerClkFrequency(TIMER_SOFT) / 1000000U - 1U;
+}
+
+/* called with interrupts disabled */
+static void soft_timer_arm(void)
+{
+    int32_t delta;
+
+    TIMER_CTL0(TIMER_SOFT) &= ~TIMER_CTL0_CEN;
+    if (NULL == soft_timers) {
+        return;
+    }
+    delta = (int32_t)(soft_timers->due - getCurrentMicros());
+    if (delta < (int32_t)SOFT_TIMER_MIN_ARM_US) {
+        delta = SOFT_TIMER_MIN_ARM_US;
+    } else if (delta > (int32_t)SOFT_TIMER_MAX_ARM_US) {
+        /* wakes up early, finds nothing due and arms again */
+        delta = SOFT_TIMER_MAX_ARM_US;
+    }
+    TIMER_CNT(TIMER_SOFT) = 0U;
+    TIMER_CAR(TIMER_SOFT) = (uint32_t)delta - 1U;
+    TIMER_INTF(TIMER_SOFT) = ~(uint32_t)TIMER_INT_FLAG_UP;
+    /* one-pulse mode clears CEN again at the update */
+    TIMER_CTL0(TIMER_SOFT) |= TIMER_CTL0_CEN;
+}
+
+/* called with interrupts disabled */
+static void soft_timer_unlink(soft_timer_t *timer)
+{
+    soft_timer_t **p;
+
+    for (p = &soft_timers; *p != NULL; p = &(*p)->next) {
+        if (*p == timer) {
+            *p = timer->next;
+            break;
+        }
+    }
+    timer->active = false;
+}
+
+/* called with interrupts disabled, timers due at the same time stay in start order */
+static void soft_timer_insert(soft_timer_t *timer)
+{
+    soft_timer_t **p = &soft_timers;
+
+    while ((*p != NULL) && ((int32_t)((*p)->due - timer->due) <= 0)) {
+        p = &(*p)->next;
+    }
+    timer->next = *p;
+    *p = timer;
+    timer->active = true;
+}
+
+static void soft_timer_irq(void *arg, uint8_t source)
+{
+    soft_timer_t *timer;
+    uint32_t now = getCurrentMicros();
+    uint32_t state;
+
+    (void)arg;
+    (void)source;
+    state = critical_enter();
+    while ((NULL != soft_timers) && ((int32_t)(soft_timers->due - now) <= 0)) {
+        timer = soft_timers;
+        soft_timers = timer->next;
+        timer->active = false;
+        if (0U != timer->period) {
+            timer->due += timer->period;
+            if ((int32_t)(timer->due - now) <= 0) {
+                timer->due = now + timer->period;
+            }
+            soft_timer_insert(timer);
+        }
+        /* the callback may start and stop timers, so the list is left consistent */
+        critical_exit(state);
+        timer->func(timer->arg);
+        now = getCurrentMicros();
+        state = critical_enter();
+    }
+    soft_timer_arm();
+    critical_exit(state);
+}
+
+/* the prescaler was worked out for the old bus clock */
+static void soft_timer_clock_changed(void *arg)
+{
+    uint32_t state;
+
+    (void)arg;
+    soft_timer_prescaler();
+    TIMER_SWEVG(TIMER_SOFT) |= TIMER_SWEVG_UPG;
+    state = critical_enter();
+    soft_timer_arm();
+    critical_exit(state);
+}
+
+static void soft_timer_init(void)
+{
+    timer_parameter_struct timer_initpara;
+
+    timer_clock_enable(TIMER_SOFT);
+    timer_deinit(TIMER_SOFT);
+    timer_initpara.prescaler = getTimerClkFrequency(TIMER_SOFT) / 1000000U - 1U;
+    timer_initpara.period = SOFT_TIMER_MAX_ARM_US;
+    timer_initpara.repetitioncounter = 0;
+    timer_initpara.alignedmode = TIMER_COUNTER_EDGE;
+    timer_initpara.counterdirection = TIMER_COUNTER_UP;
+    timer_initpara.clockdivision = TIMER_CKDIV_DIV1;
+    timer_init(TIMER_SOFT, &timer_initpara);
+    /* only counter overflows raise the update flag, not the UPG that loads the prescaler */
+    TIMER_CTL0(TIMER_SOFT) |= TIMER_CTL0_SPM | TIMER_CTL0_UPS;
+    TIMER_INTF(TIMER_SOFT) = ~(uint32_t)TIMER_INT_FLAG_UP;
+
+    Timer_attachIrqCallback(TIMER_SOFT, TIMER_IRQ_SOURCE_UP, soft_timer_irq, NULL);
+    timer_interrupt_enable(TIMER_SOFT, TIMER_INT_UP);
+    irq_priority_enable(getTimerUpIrq(TIMER_SOFT), IRQ_PRIO_TIMER);
+
+    soft_timer_clock.changed = soft_timer_clock_changed;
+    clock_listener_add(&soft_timer_clock);
+    soft_timer_ready = true;
+}
+
+/*!
+    \brief      start or restart a soft timer
+    \param[in]  timer: the timer, kept in a list until it expires or is stopped
+    \param[in]  delay_us: microseconds until the first call
+    \param[in]  period_us: microseconds between further calls, 0 for a one-shot timer
+    \param[in]  func: called from the timer interrupt as func(arg)
+    \param[in]  arg: passed through to func
+    \param[out] none
+    \retval     none
+*/
+void soft_timer_start(soft_timer_t *timer, uint32_t delay_us, uint32_t period_us,
+                      soft_timer_func_t func, void *arg)
+{
+    uint32_t state;
+
+    if (!soft_timer_ready) {
+        soft_timer_init();
+    }
+    state = critical_enter();
+    soft_timer_unlink(timer);
+    timer->func = func;
+    timer->arg = arg;
+    timer->period = period_us;
+    timer->due = getCurrentMicros() + delay_us;
+    soft_timer_insert(timer);
+    if (soft_timers == timer) {
+        soft_timer_arm();
+    }
+    critical_exit(state);
+}
+
+/*!
+    \brief      stop a soft timer, its callback is not called again
+    \param[in]  timer: the timer, may already be stopped
+    \param[out] none
+    \retval     none
+*/
+void soft_timer_stop(soft_timer_t *timer)
+{
+    uint32_t state;
+    bool first;
+
+    state = critical_enter();
+    first = (soft_timers == timer);
+    soft_timer_unlink(timer);
+    if (first && soft_timer_ready) {
+        soft_timer_arm();
+    }
+    critical_exit(state);
+}
+
+/*!
+    \brief      check whether a soft timer is going to run
+    \param[in]  timer: the timer
+    \param[out] none
+    \retval     true until a one-shot timer has expired or the timer was stopped
+*/
+bool soft_timer_active(const soft_timer_t *timer)
+{
+    return timer->active;
+}
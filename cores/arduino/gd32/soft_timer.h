@@ -0,0 +1,49 @@
+#ifndef _GD32_SOFT_TIMER_H_
+#define _GD32_SOFT_TIMER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Any number of one-shot and periodic callbacks sharing one hardware timer.
+ * Running timers are kept sorted by due time; the hardware timer, a basic
+ * timer in one-pulse mode, is only armed for the first one, so there is one
+ * interrupt per expiry and none while nothing is due. Times are in
+ * microseconds on the micros() time base, so a delay or period must stay
+ * below 2^31 us (about 35 minutes).
+ *
+ * Callbacks run in the timer interrupt, in due order, and may start or stop
+ * any timer, themselves included. A periodic timer keeps its phase: its next
+ * expiry is one period after the last due time, not after the callback ran,
+ * unless the interrupt fell a whole period behind.
+ *
+ * The hardware timer is TIMER_SOFT, by default the variant's TIMER_TONE
+ * (tone() is built on soft timers).
+ */
+typedef void (*soft_timer_func_t)(void *arg);
+
+typedef struct soft_timer {
+    soft_timer_func_t func;
+    void *arg;
+    uint32_t due;               /* micros() of the next expiry */
+    uint32_t period;            /* 0 for a one-shot timer */
+    volatile bool active;
+    struct soft_timer *next;
+} soft_timer_t;
+
+/* (re)start: first call after delay_us, then every period_us unless it is 0 */
+void soft_timer_start(soft_timer_t *timer, uint32_t delay_us, uint32_t period_us,
+                      soft_timer_func_t func, void *arg);
+void soft_timer_stop(soft_timer_t *timer);
+/* a one-shot timer is no longer active once its callback runs */
+bool soft_timer_active(const soft_timer_t *timer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_SOFT_TIMER_H_ */
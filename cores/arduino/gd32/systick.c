@@ -37,8 +37,23 @@ OF SUCH DAMAGE.
 */
 
 #include "systick.h"
+#include "gd32_def.h"
+#include "irq_profile.h"
+#include "irq_priority.h"
 
 volatile uint32_t gd_ticks;
+/* upper half of the 64 bit millisecond count, steps when gd_ticks wraps */
+static volatile uint32_t gd_ticks_high;
+/* 2^32 / (SysTick counts per microsecond), rounded up, so micros() needs
+ * no division. Multiplying a 24 bit count by it and dropping the low word
+ * divides exactly for clocks in whole MHz up to 256 MHz; other clocks may
+ * be off by a microsecond. */
+static uint32_t systick_us_recip;
+
+static void systick_us_recip_update(void)
+{
+    systick_us_recip = (uint32_t)((1000ULL << 32) / (SysTick->LOAD + 1U)) + 1U;
+}
 
 /*!
     \brief      configure systick
@@ -55,7 +70,28 @@ void systick_config(void)
         }
     }
     /* configure the systick handler priority */
-    NVIC_SetPriority(SysTick_IRQn, 0x00U);
+    irq_priority_set(SysTick_IRQn, IRQ_PRIO_SYSTICK);
+    systick_us_recip_update();
+#if defined(DWT_CTRL_CYCCNTENA_Msk)
+    /* free running cycle counter for getCurrentCycles() */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0U;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/*!
+    \brief      reload systick for 1000Hz after SystemCoreClock changed
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void systick_clock_update(void)
+{
+    /* only the reload, the priority may belong to an RTOS by now */
+    SysTick->LOAD = SystemCoreClock / 1000U - 1U;
+    SysTick->VAL = 0U;
+    systick_us_recip_update();
 }
 
 void noOsSystickHandler() {}
@@ -67,12 +103,76 @@ void osSystickHandler() __attribute__((weak, alias("noOsSystickHandler")));
     \param[out] none
     \retval     none
 */
-void SysTick_Handler(void)
+__attribute__((used)) GD_FASTCODE void SysTick_Handler(void)
 {
-    gd_ticks++;
+    IRQ_PROFILE();
+    if (++gd_ticks == 0U) {
+        gd_ticks_high++;
+    }
     osSystickHandler();
 }
 
+/*!
+    \brief      read the millisecond count and the SysTick count within it consistently
+    \param[out] ms: milliseconds
+    \retval     SysTick counts elapsed since ms began
+*/
+static uint32_t systick_read(uint32_t *ms)
+{
+    uint32_t ticks, systick_value;
+    do {
+        ticks = gd_ticks;
+        systick_value = SysTick->VAL;
+        /* wrapped with interrupts masked, so the tick is not counted yet; this
+         * leaves COUNTFLAG alone for whoever else polls it */
+        if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+            systick_value = SysTick->VAL;
+            ticks++;
+        }
+        /* a tick in between changed gd_ticks, read again */
+    } while (ticks != gd_ticks && ticks != gd_ticks + 1);
+    *ms = ticks;
+    return (SysTick->LOAD + 1U - systick_value);
+}
+
+/*!
+    \brief      step the millisecond count over ticks that passed without an interrupt,
+                call with interrupts disabled
+    \param[in]  ticks: milliseconds to add
+    \param[out] none
+    \retval     none
+*/
+void systick_ticks_add(uint32_t ticks)
+{
+    uint32_t before = gd_ticks;
+
+    gd_ticks = before + ticks;
+    if (gd_ticks < before) {
+        gd_ticks_high++;
+    }
+}
+
+/*!
+    \brief      64 bit version of systick_read()
+    \param[out] ms: milliseconds
+    \retval     SysTick counts elapsed since ms began
+*/
+static uint32_t systick_read64(uint64_t *ms)
+{
+    uint32_t high, ticks, systick_value, pending;
+    do {
+        high = gd_ticks_high;
+        ticks = gd_ticks;
+        systick_value = SysTick->VAL;
+        pending = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+        if (pending) {
+            systick_value = SysTick->VAL;
+        }
+    } while (ticks != gd_ticks || high != gd_ticks_high);
+    *ms = (((uint64_t)high << 32) | ticks) + (pending ? 1U : 0U);
+    return (SysTick->LOAD + 1U - systick_value);
+}
+
 /*!
     \brief      get current milliseconds
     \param[in]  none
@@ -92,9 +192,50 @@ uint32_t getCurrentMillis(void)
 */
 uint32_t getCurrentMicros(void)
 {
-    uint32_t ms = gd_ticks;
-    uint32_t systick_value = SysTick->VAL;
-    uint32_t systick_load = SysTick->LOAD + 1;
-    uint32_t us = ((systick_load - systick_value) * 1000) / systick_load;
-    return (ms * 1000 + us);
-}
\ No newline at end of file
+    uint32_t ms;
+    uint32_t systick_count = systick_read(&ms);
+    return (ms * 1000U + (uint32_t)(((uint64_t)systick_count * systick_us_recip) >> 32));
+}
+
+/*!
+    \brief      get current milliseconds, 64 bit so that it never wraps
+    \param[in]  none
+    \param[out] none
+    \retval     current milliseconds
+*/
+uint64_t getCurrentMillis64(void)
+{
+    uint64_t ms;
+    (void)systick_read64(&ms);
+    return ms;
+}
+
+/*!
+    \brief      get current microseconds, 64 bit so that it never wraps
+    \param[in]  none
+    \param[out] none
+    \retval     current microseconds
+*/
+uint64_t getCurrentMicros64(void)
+{
+    uint64_t ms;
+    uint32_t systick_count = systick_read64(&ms);
+    return (ms * 1000U + (uint32_t)(((uint64_t)systick_count * systick_us_recip) >> 32));
+}
+
+/*!
+    \brief      get current CPU cycle count, wraps around at 2^32
+    \param[in]  none
+    \param[out] none
+    \retval     current cycle count (DWT CYCCNT, or rebuilt from SysTick on cores without it)
+*/
+uint32_t getCurrentCycles(void)
+{
+#if defined(DWT_CTRL_CYCCNTENA_Msk)
+    return DWT->CYCCNT;
+#else
+    uint32_t ms;
+    uint32_t systick_count = systick_read(&ms);
+    return (ms * (SysTick->LOAD + 1U) + systick_count);
+#endif
+}
@@ -44,7 +44,12 @@ OF SUCH DAMAGE.
 
 /* configure systick */
 void systick_config(void);
+void systick_clock_update(void);
+void systick_ticks_add(uint32_t ticks);
 uint32_t getCurrentMillis(void);
 uint32_t getCurrentMicros(void);
+uint64_t getCurrentMillis64(void);
+uint64_t getCurrentMicros64(void);
+uint32_t getCurrentCycles(void);
 
 #endif /* SYSTICK_H */
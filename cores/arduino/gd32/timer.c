@@ -26,6 +26,10 @@ OF SUCH DAMAGE.
 */
 
 #include "timer.h"
+#include "gd32_def.h"
+#include "irq_profile.h"
+#include "irq_priority.h"
+#include "clock.h"
 
 #if defined(GD32F1x0) || defined(GD32F3x0) || defined(GD32E50X) || defined(GD32EPRT)
 #define TIMER5_IRQ_Name TIMER5_DAC_IRQn
@@ -108,13 +112,16 @@ OF SUCH DAMAGE.
 #endif
 #endif
 
-#if defined(GD32F3x0) && !defined(GD32F350)
-#define NO_TIMER_5
-#endif
-
 extern timerhandle_t timerHandle;
 extern pwmhandle_t pwmHandle;
 
+/* timers started by Timer_start(), one bit per timer index */
+static volatile uint32_t timerCounting;
+/* timers PWM_stop() found idle and gated, one bit per timer index */
+static volatile uint32_t pwmGated;
+/* of those, the ones whose counter was running, Timer_wake() restarts them */
+static volatile uint32_t pwmGatedRunning;
+
 timerhandle_t timerHandle = {
     .init                      = Timer_init,
     .start                     = Timer_start,
@@ -124,12 +131,7 @@ timerhandle_t timerHandle = {
     .enableUpdateIT            = Timer_enableUpdateIT,
     .enableCaptureIT           = Timer_enableCaptureIT,
     .disableUpdateIT           = Timer_disableUpdateIT,
-    .disableCaptureIT          = Timer_disableCaptureIT,
-    .interruptHandle           = Timer_updateHandle,
-    .captureInterruptHandle[0] = Timer_captureHandle,
-    .captureInterruptHandle[1] = Timer_captureHandle,
-    .captureInterruptHandle[2] = Timer_captureHandle,
-    .captureInterruptHandle[3] = Timer_captureHandle
+    .disableCaptureIT          = Timer_disableCaptureIT
 };
 
 pwmhandle_t pwmHandle = {
@@ -139,7 +141,6 @@ pwmhandle_t pwmHandle = {
     .setPeriodCycle  = PWM_setPeriodCycle,
     .enablePWMIT     = PWM_enablePWMIT,
     .disablePWMIT    = PWM_disablePWMIT,
-    .interruptHandle = PWM_irqHandle,
     .writeCycleValue = PWM_writeCyclevalue
 };
 
@@ -178,7 +179,7 @@ uint32_t getTimerIndex(uint32_t instance)
             index = 4;
             break;
 #endif
-#if defined(TIMER5) && !defined(NO_TIMER_5)
+#if defined(TIMER5)
         case TIMER5:
             index = 5;
             break;
@@ -289,7 +290,7 @@ uint32_t getPWMIndex(pwmDevice_t instance)
 }
 
 /*!
-    \brief      enable timer clock
+    \brief      enable timer clock, calling it again for a timer that is on does nothing
     \param[in]  instance: TIMERx(x=0..13)
     \param[out] none
     \retval     none
@@ -323,7 +324,7 @@ void timer_clock_enable(uint32_t instance)
             temp = RCU_TIMER4;
             break;
 #endif
-#if defined(TIMER5) && !defined(NO_TIMER_5)
+#if defined(TIMER5)
         case TIMER5:
             temp = RCU_TIMER5;
             break;
@@ -386,11 +387,18 @@ void timer_clock_enable(uint32_t instance)
         default:
             break;
     }
-    rcu_periph_clock_enable(temp);
+    /* a timer holds one reference while it is set up, timer_clock_disable() drops it */
+    if (temp != 0U) {
+        uint32_t state = critical_enter();
+        if (clock_periph_users((rcu_periph_enum)temp) == 0U) {
+            clock_periph_acquire((rcu_periph_enum)temp);
+        }
+        critical_exit(state);
+    }
 }
 
 /*!
-    \brief      disable timer clock
+    \brief      gate the timer clock off, the registers keep their values
     \param[in]  instance: TIMERx(x=0..13)
     \param[out] none
     \retval     none
@@ -424,7 +432,7 @@ void timer_clock_disable(uint32_t instance)
             temp = RCU_TIMER4;
             break;
 #endif
-#if defined(TIMER5) && !defined(NO_TIMER_5)
+#if defined(TIMER5)
         case TIMER5:
             temp = RCU_TIMER5;
             break;
@@ -487,48 +495,117 @@ void timer_clock_disable(uint32_t instance)
         default:
             break;
     }
-    rcu_periph_clock_disable(temp);
+    if (temp != 0U) {
+        clock_periph_release((rcu_periph_enum)temp);
+    }
 }
 
 /*!
-    \brief      initialize timer
+    \brief      largest counter and auto reload value of a timer
     \param[in]  instance: TIMERx(x=0..13)
-    \param[in]  timerPeriod: period and format
     \param[out] none
-    \retval     none
+    \retval     0xFFFFFFFF for a 32 bit timer, 0xFFFF otherwise
 */
-void Timer_init(uint32_t instance, timerPeriod_t *timerPeriod)
+uint32_t Timer_maxCount(uint32_t instance)
 {
-    timer_parameter_struct timer_initpara;
-
-#if defined(GD32E23x)
-    /* no subprio */
-    nvic_irq_enable(getTimerUpIrq(instance), 2);
-    nvic_irq_enable(getTimerCCIrq(instance), 2);
-#else
-    nvic_irq_enable(getTimerUpIrq(instance), 2, 2);
-    nvic_irq_enable(getTimerCCIrq(instance), 2, 2);
+#if defined(TIMER_HAS_32BIT_TIMER1)
+    if (instance == TIMER1) {
+        return 0xFFFFFFFFU;
+    }
 #endif
-    timer_clock_enable(instance);
-    timer_deinit(instance);
+    (void)instance;
+    return 0xFFFFU;
+}
+
+/*!
+    \brief      work out a period given in time units for a 32 bit timer
+    \param[in]  instance: TIMERx(x=0..13)
+    \param[in]  timerPeriod: time and format
+    \param[out] timer_initpara: prescaler, period and repetition counter
+    \retval     1 if set, 0 for a 16 bit timer or a period in ticks
+*/
+static uint8_t Timer_widePeriod(uint32_t instance, timerPeriod_t *timerPeriod, timer_parameter_struct *timer_initpara)
+{
+    uint32_t clk = getTimerClkFrequency(instance);
+    uint64_t ticks;
+    uint64_t period;
+    uint32_t psc;
+
+    if (Timer_maxCount(instance) != 0xFFFFFFFFU) {
+        return 0U;
+    }
     switch (timerPeriod->format) {
         case FORMAT_US:
-            timer_initpara.prescaler = getTimerClkFrequency(instance) / 1000000 - 1;
-            timer_initpara.period = timerPeriod->time - 1;
-            timer_initpara.repetitioncounter = 0;
+            ticks = (uint64_t)clk * timerPeriod->time / 1000000U;
             break;
         case FORMAT_MS:
-            timer_initpara.prescaler = getTimerClkFrequency(instance) / 10000 - 1;
-            timer_initpara.period = timerPeriod->time * 10 - 1;
-            timer_initpara.repetitioncounter = 0;
+            ticks = (uint64_t)clk * timerPeriod->time / 1000U;
             break;
         case FORMAT_S:
-            timer_initpara.prescaler = getTimerClkFrequency(instance) / 10000 - 1;
-            timer_initpara.period = timerPeriod->time * 40 - 1 ;
-            timer_initpara.repetitioncounter = 250;
+            ticks = (uint64_t)clk * timerPeriod->time;
             break;
-        default:
+        case FORMAT_HZ:
+            ticks = (timerPeriod->time != 0U) ? (clk / timerPeriod->time) : 0U;
             break;
+        default:
+            return 0U;
+    }
+    if (ticks == 0U) {
+        ticks = 1U;
+    }
+    /* the smallest prescaler that fits the period into 32 bits: the timer clock itself
+       up to about a minute, a microsecond or finer up to 71 minutes */
+    psc = (uint32_t)((ticks - 1U) >> 32);
+    if (psc > 0xFFFFU) {
+        psc = 0xFFFFU;
+    }
+    period = ticks / (psc + 1U);
+    if (period > 0x100000000ULL) {
+        period = 0x100000000ULL;
+    }
+    timer_initpara->prescaler = (uint16_t)psc;
+    timer_initpara->period = (uint32_t)(period - 1U);
+    timer_initpara->repetitioncounter = 0;
+    return 1U;
+}
+
+/*!
+    \brief      initialize timer
+    \param[in]  instance: TIMERx(x=0..13)
+    \param[in]  timerPeriod: period and format
+    \param[out] none
+    \retval     none
+*/
+void Timer_init(uint32_t instance, timerPeriod_t *timerPeriod)
+{
+    timer_parameter_struct timer_initpara;
+
+    irq_priority_enable(getTimerUpIrq(instance), IRQ_PRIO_TIMER);
+    irq_priority_enable(getTimerCCIrq(instance), IRQ_PRIO_TIMER);
+    Timer_wake(instance);
+    timer_clock_enable(instance);
+    timer_deinit(instance);
+    /* a 32 bit timer takes the period at full width */
+    if (!Timer_widePeriod(instance, timerPeriod, &timer_initpara)) {
+        switch (timerPeriod->format) {
+            case FORMAT_US:
+                timer_initpara.prescaler = getTimerClkFrequency(instance) / 1000000 - 1;
+                timer_initpara.period = timerPeriod->time - 1;
+                timer_initpara.repetitioncounter = 0;
+                break;
+            case FORMAT_MS:
+                timer_initpara.prescaler = getTimerClkFrequency(instance) / 10000 - 1;
+                timer_initpara.period = timerPeriod->time * 10 - 1;
+                timer_initpara.repetitioncounter = 0;
+                break;
+            case FORMAT_S:
+                timer_initpara.prescaler = getTimerClkFrequency(instance) / 10000 - 1;
+                timer_initpara.period = timerPeriod->time * 40 - 1 ;
+                timer_initpara.repetitioncounter = 250;
+                break;
+            default:
+                break;
+        }
     }
     timer_initpara.alignedmode = TIMER_COUNTER_EDGE;
     timer_initpara.counterdirection = TIMER_COUNTER_UP;
@@ -544,6 +621,12 @@ void Timer_init(uint32_t instance, timerPeriod_t *timerPeriod)
 */
 void Timer_start(uint32_t instance)
 {
+    uint32_t index = getTimerIndex(instance);
+
+    if (index < 32U) {
+        timerCounting |= 1UL << index;
+    }
+    Timer_wake(instance);
     timer_enable(instance);
 }
 
@@ -555,6 +638,12 @@ void Timer_start(uint32_t instance)
 */
 void Timer_stop(uint32_t instance)
 {
+    uint32_t index = getTimerIndex(instance);
+
+    if (index < 32U) {
+        timerCounting &= ~(1UL << index);
+    }
+    Timer_wake(instance);
     timer_disable(instance);
 }
 
@@ -570,37 +659,42 @@ void Timer_setPeriodTime(uint32_t instance, timerPeriod_t *timerPeriod)
     uint32_t prescalerfactor = 0;
     uint32_t period_cycle = 0;
     timer_parameter_struct timer_initpara;
+
+    Timer_wake(instance);
     //timer_deinit(instance);
-    switch (timerPeriod->format) {
-        case FORMAT_TICK:
-            timer_initpara.prescaler = TIMER_PSC(instance);
-            timer_initpara.period = timerPeriod->time - 1;
-            timer_initpara.repetitioncounter  = 0;
-            break;
-        case FORMAT_US:
-            timer_initpara.prescaler = getTimerClkFrequency(instance) / 1000000 - 1;
-            timer_initpara.period = timerPeriod->time - 1;
-            timer_initpara.repetitioncounter = 0;
-            break;
-        case FORMAT_MS:
-            timer_initpara.prescaler = getTimerClkFrequency(instance) / 10000 - 1;
-            timer_initpara.period = timerPeriod->time * 10 - 1;
-            timer_initpara.repetitioncounter = 0;
-            break;
-        case FORMAT_S:
-            timer_initpara.prescaler = getTimerClkFrequency(instance) / 10000 - 1;
-            timer_initpara.period = timerPeriod->time * 40 - 1;
-            timer_initpara.repetitioncounter = 250;
-            break;
-        case FORMAT_HZ:
-            period_cycle = getTimerClkFrequency(instance) / timerPeriod->time;
-            prescalerfactor = (period_cycle / 65536) + 1;
-            timer_initpara.prescaler = prescalerfactor - 1;
-            timer_initpara.period = period_cycle / prescalerfactor;
-            timer_initpara.repetitioncounter  = 0;
-            break;
-        default:
-            break;
+    /* a 32 bit timer takes the period at full width */
+    if (!Timer_widePeriod(instance, timerPeriod, &timer_initpara)) {
+        switch (timerPeriod->format) {
+            case FORMAT_TICK:
+                timer_initpara.prescaler = TIMER_PSC(instance);
+                timer_initpara.period = timerPeriod->time - 1;
+                timer_initpara.repetitioncounter  = 0;
+                break;
+            case FORMAT_US:
+                timer_initpara.prescaler = getTimerClkFrequency(instance) / 1000000 - 1;
+                timer_initpara.period = timerPeriod->time - 1;
+                timer_initpara.repetitioncounter = 0;
+                break;
+            case FORMAT_MS:
+                timer_initpara.prescaler = getTimerClkFrequency(instance) / 10000 - 1;
+                timer_initpara.period = timerPeriod->time * 10 - 1;
+                timer_initpara.repetitioncounter = 0;
+                break;
+            case FORMAT_S:
+                timer_initpara.prescaler = getTimerClkFrequency(instance) / 10000 - 1;
+                timer_initpara.period = timerPeriod->time * 40 - 1;
+                timer_initpara.repetitioncounter = 250;
+                break;
+            case FORMAT_HZ:
+                period_cycle = getTimerClkFrequency(instance) / timerPeriod->time;
+                prescalerfactor = (period_cycle / 65536) + 1;
+                timer_initpara.prescaler = prescalerfactor - 1;
+                timer_initpara.period = period_cycle / prescalerfactor;
+                timer_initpara.repetitioncounter  = 0;
+                break;
+            default:
+                break;
+        }
     }
     timer_initpara.alignedmode = TIMER_COUNTER_EDGE;
     timer_initpara.counterdirection = TIMER_COUNTER_UP;
@@ -617,6 +711,7 @@ void Timer_setPeriodTime(uint32_t instance, timerPeriod_t *timerPeriod)
 */
 void Timer_rfresh(uint32_t instance)
 {
+    Timer_wake(instance);
     timer_event_software_generate(instance, TIMER_EVENT_SRC_UPG);
 }
 
@@ -628,6 +723,7 @@ void Timer_rfresh(uint32_t instance)
 */
 void Timer_enableUpdateIT(uint32_t instance)
 {
+    Timer_wake(instance);
     timer_flag_clear(instance, TIMER_INT_FLAG_UP);
     timer_interrupt_enable(instance, TIMER_INT_UP);
 }
@@ -640,6 +736,7 @@ void Timer_enableUpdateIT(uint32_t instance)
 */
 void Timer_disableUpdateIT(uint32_t instance)
 {
+    Timer_wake(instance);
     timer_flag_clear(instance, TIMER_INT_FLAG_UP);
     timer_interrupt_disable(instance, TIMER_INT_UP);
 }
@@ -676,6 +773,7 @@ void Timer_enableCaptureIT(uint32_t instance, uint8_t channel)
             //ToDo: better error handling in case of invalid params
             return;
     }
+    Timer_wake(instance);
     timer_interrupt_flag_clear(instance, interrupt_flag);
     timer_interrupt_enable(instance, interrupt);
 }
@@ -712,9 +810,327 @@ void Timer_disableCaptureIT(uint32_t instance, uint8_t channel)
             //ToDo: better error handling in case of invalid params
             return;
     }
+    Timer_wake(instance);
     timer_interrupt_flag_clear(instance, interrupt_flag);
     timer_interrupt_disable(instance, interrupt);
 }
+
+/*!
+    \brief      select the event the timer drives onto its trigger output TRGO
+    \param[in]  instance: TIMERx
+    \param[in]  trgo: trigger output source
+    \param[in]  sync: delay the trigger effect on the master so master and slaves start in lockstep
+    \param[out] none
+    \retval     none
+*/
+void Timer_setMasterMode(uint32_t instance, enum timerTriggerOutput trgo, uint8_t sync)
+{
+    static const uint32_t trgo_source[] = {
+        TIMER_TRI_OUT_SRC_RESET,
+        TIMER_TRI_OUT_SRC_ENABLE,
+        TIMER_TRI_OUT_SRC_UPDATE,
+        TIMER_TRI_OUT_SRC_CH0,
+        TIMER_TRI_OUT_SRC_O0CPRE,
+        TIMER_TRI_OUT_SRC_O1CPRE,
+        TIMER_TRI_OUT_SRC_O2CPRE,
+        TIMER_TRI_OUT_SRC_O3CPRE
+    };
+
+    if ((uint32_t)trgo >= sizeof(trgo_source) / sizeof(trgo_source[0])) {
+        return;
+    }
+    Timer_wake(instance);
+    timer_master_output_trigger_source_select(instance, trgo_source[trgo]);
+    timer_master_slave_mode_config(instance, sync ? TIMER_MASTER_SLAVE_MODE_ENABLE :
+                                   TIMER_MASTER_SLAVE_MODE_DISABLE);
+}
+
+/*!
+    \brief      raise a channel compare event once per counter period, e.g. as ADC trigger
+    \param[in]  instance: TIMERx
+    \param[in]  channel: TIMER_CH_x(x=0..3)
+    \param[out] none
+    \retval     none
+*/
+void Timer_setCompareTrigger(uint32_t instance, uint8_t channel)
+{
+    timer_oc_parameter_struct timer_ocintpara;
+
+    Timer_wake(instance);
+    /* the channel is not routed to a pin, enabling it only lets OxCPRE reach the trigger */
+    timer_ocintpara.ocpolarity = TIMER_OC_POLARITY_HIGH;
+    timer_ocintpara.outputstate = TIMER_CCX_ENABLE;
+    timer_ocintpara.ocidlestate = TIMER_OC_IDLE_STATE_LOW;
+    timer_ocintpara.outputnstate = TIMER_CCXN_DISABLE;
+    timer_ocintpara.ocnpolarity = TIMER_OCN_POLARITY_HIGH;
+    timer_ocintpara.ocnidlestate = TIMER_OCN_IDLE_STATE_LOW;
+    timer_channel_output_config(instance, channel, &timer_ocintpara);
+    timer_channel_output_mode_config(instance, channel, TIMER_OC_MODE_PWM0);
+    timer_channel_output_shadow_config(instance, channel, TIMER_OC_SHADOW_DISABLE);
+    timer_channel_output_pulse_value_config(instance, channel, (TIMER_CAR(instance) + 1U) / 2U);
+}
+
+/*!
+    \brief      get the internal trigger input of a timer that is connected to another timer's TRGO
+    \param[in]  instance: slave TIMERx
+    \param[in]  master: master TIMERx
+    \param[out] none
+    \retval     ITI number 0..3, 0xFF if the timers are not connected or the table is not known
+*/
+uint32_t Timer_getInternalTrigger(uint32_t instance, uint32_t master)
+{
+#if defined(GD32F30x) || defined(GD32F10x) || defined(GD32E50X)
+    /* ITI0..ITI3 sources of every slave timer */
+    uint32_t iti[4] = {0, 0, 0, 0};
+    uint32_t i;
+
+    switch (instance) {
+        case TIMER0:
+            iti[0] = TIMER4;
+            iti[1] = TIMER1;
+            iti[2] = TIMER2;
+            iti[3] = TIMER3;
+            break;
+        case TIMER1:
+            iti[0] = TIMER0;
+            iti[1] = TIMER7;
+            iti[2] = TIMER2;
+            iti[3] = TIMER3;
+            break;
+        case TIMER2:
+            iti[0] = TIMER0;
+            iti[1] = TIMER1;
+            iti[2] = TIMER4;
+            iti[3] = TIMER3;
+            break;
+        case TIMER3:
+            iti[0] = TIMER0;
+            iti[1] = TIMER1;
+            iti[2] = TIMER2;
+            iti[3] = TIMER7;
+            break;
+        case TIMER4:
+            iti[0] = TIMER1;
+            iti[1] = TIMER2;
+            iti[2] = TIMER3;
+            iti[3] = TIMER7;
+            break;
+        case TIMER7:
+            iti[0] = TIMER0;
+            iti[1] = TIMER1;
+            iti[2] = TIMER3;
+            iti[3] = TIMER4;
+            break;
+        default:
+            break;
+    }
+    for (i = 0; i < 4U; i++) {
+        if ((iti[i] != 0U) && (iti[i] == master)) {
+            return i;
+        }
+    }
+#else
+    /* connections differ between the GD32F3x0/F1x0/E23x parts, use Timer_setSlaveModeITI() */
+    (void)instance;
+    (void)master;
+#endif
+    return 0xFF;
+}
+
+/*!
+    \brief      make a timer follow an internal trigger input
+    \param[in]  instance: slave TIMERx
+    \param[in]  mode: what the slave does on its trigger
+    \param[in]  iti: internal trigger input 0..3, see the trigger connection table of the user manual
+    \param[out] none
+    \retval     none
+*/
+void Timer_setSlaveModeITI(uint32_t instance, enum timerSlaveMode mode, uint8_t iti)
+{
+    static const uint32_t trgsel[] = {
+        TIMER_SMCFG_TRGSEL_ITI0,
+        TIMER_SMCFG_TRGSEL_ITI1,
+        TIMER_SMCFG_TRGSEL_ITI2,
+        TIMER_SMCFG_TRGSEL_ITI3
+    };
+    uint32_t smc;
+
+    switch (mode) {
+        case SLAVE_RESET:
+            smc = TIMER_SLAVE_MODE_RESTART;
+            break;
+        case SLAVE_GATED:
+            smc = TIMER_SLAVE_MODE_PAUSE;
+            break;
+        case SLAVE_TRIGGER:
+            smc = TIMER_SLAVE_MODE_EVENT;
+            break;
+        case SLAVE_EXTERNAL_CLOCK:
+            smc = TIMER_SLAVE_MODE_EXTERNAL0;
+            break;
+        default:
+            smc = TIMER_SLAVE_MODE_DISABLE;
+            break;
+    }
+    Timer_wake(instance);
+    /* the trigger source must not change while a slave mode is active */
+    timer_slave_mode_select(instance, TIMER_SLAVE_MODE_DISABLE);
+    if (smc != TIMER_SLAVE_MODE_DISABLE) {
+        timer_input_trigger_source_select(instance, trgsel[iti & 0x03U]);
+        timer_slave_mode_select(instance, smc);
+    }
+}
+
+/*!
+    \brief      make a timer follow the trigger output of another timer
+    \param[in]  instance: slave TIMERx
+    \param[in]  mode: what the slave does on its trigger
+    \param[in]  master: master TIMERx, configured with Timer_setMasterMode()
+    \param[out] none
+    \retval     1 on success, 0 if the master is not connected to the slave
+*/
+uint8_t Timer_setSlaveMode(uint32_t instance, enum timerSlaveMode mode, uint32_t master)
+{
+    uint32_t iti = 0;
+
+    if (mode != SLAVE_DISABLE) {
+        iti = Timer_getInternalTrigger(instance, master);
+        if (iti > 3U) {
+            return 0;
+        }
+    }
+    Timer_setSlaveModeITI(instance, mode, iti);
+    return 1;
+}
+
+/*!
+    \brief      set a channel up for one pulse per trigger: delay ticks after the trigger the
+                output turns active for width ticks, then the counter stops until the next one
+    \param[in]  instance: TIMERx
+    \param[in]  channel: TIMER_CH_x(x=0..3), its pin routed to the timer
+    \param[in]  delay: ticks from the trigger to the pulse, at least 1
+    \param[in]  width: ticks of the pulse, at least 1, delay + width at most 65536
+    \param[in]  prescaler: timer clocks per tick minus 1
+    \param[in]  active_high: 1 for a high pulse on a low output, 0 for the opposite
+    \param[out] none
+    \retval     none
+*/
+void Timer_onePulseConfig(uint32_t instance, uint8_t channel, uint32_t delay, uint32_t width,
+                          uint16_t prescaler, uint8_t active_high)
+{
+    timer_oc_parameter_struct timer_ocintpara;
+
+    Timer_wake(instance);
+    timer_disable(instance);
+    timer_single_pulse_mode_config(instance, TIMER_SP_MODE_SINGLE);
+    timer_autoreload_value_config(instance, (uint16_t)(delay + width - 1U));
+    /* the update event this generates loads the reload value as well */
+    timer_prescaler_config(instance, prescaler, TIMER_PSC_RELOAD_NOW);
+    timer_counter_value_config(instance, 0U);
+
+    timer_ocintpara.ocpolarity = active_high ? TIMER_OC_POLARITY_HIGH : TIMER_OC_POLARITY_LOW;
+    timer_ocintpara.outputstate = TIMER_CCX_ENABLE;
+    timer_ocintpara.ocidlestate = TIMER_OC_IDLE_STATE_LOW;
+    timer_ocintpara.outputnstate = TIMER_CCXN_DISABLE;
+    timer_ocintpara.ocnpolarity = TIMER_OCN_POLARITY_HIGH;
+    timer_ocintpara.ocnidlestate = TIMER_OCN_IDLE_STATE_LOW;
+    timer_channel_output_config(instance, channel, &timer_ocintpara);
+    /* inactive while the counter is below delay, stopped at 0 in between pulses */
+    timer_channel_output_mode_config(instance, channel, TIMER_OC_MODE_PWM1);
+    timer_channel_output_shadow_config(instance, channel, TIMER_OC_SHADOW_DISABLE);
+    timer_channel_output_pulse_value_config(instance, channel, (uint16_t)delay);
+    timer_primary_output_config(instance, ENABLE);
+    timer_flag_clear(instance, TIMER_FLAG_UP);
+}
+
+/*!
+    \brief      restart mode only resets the counter, the first trigger after a pulse ended
+                starts it from here
+    \param[in]  arg: TIMERx
+    \param[in]  source: capture interrupt of the trigger channel
+    \param[out] none
+    \retval     none
+*/
+static void Timer_onePulseRetrigger(void *arg, uint8_t source)
+{
+    (void)source;
+    TIMER_CTL0((uint32_t)arg) |= TIMER_CTL0_CEN;
+}
+
+/*!
+    \brief      select what starts the pulses of Timer_onePulseConfig()
+    \param[in]  instance: TIMERx
+    \param[in]  trigger: a channel 0 or 1 input, whose pin is routed to the timer, or an
+                internal trigger; PULSE_TRIGGER_SOFTWARE leaves only Timer_firePulse()
+    \param[in]  falling: 1 to trigger on falling edges of a channel input
+    \param[in]  retriggerable: 1 to restart the delay on a trigger during a pulse; the first
+                trigger after a pulse ended then starts the counter from the capture interrupt,
+                its latency adds to that delay. Channel inputs only
+    \param[out] none
+    \retval     1 if set, 0 for a retriggerable internal trigger
+*/
+uint8_t Timer_onePulseTrigger(uint32_t instance, enum timerPulseTrigger trigger, uint8_t falling,
+                              uint8_t retriggerable)
+{
+    static const uint32_t trgsel[] = {
+        TIMER_SMCFG_TRGSEL_ITI0,
+        TIMER_SMCFG_TRGSEL_ITI1,
+        TIMER_SMCFG_TRGSEL_ITI2,
+        TIMER_SMCFG_TRGSEL_ITI3
+    };
+    timer_ic_parameter_struct timer_icinitpara;
+    uint8_t channel;
+
+    if (retriggerable && (trigger != PULSE_TRIGGER_CH0) && (trigger != PULSE_TRIGGER_CH1)) {
+        return 0;
+    }
+    Timer_wake(instance);
+    /* the trigger source must not change while a slave mode is active */
+    timer_slave_mode_select(instance, TIMER_SLAVE_MODE_DISABLE);
+    for (channel = 0U; channel < 2U; channel++) {
+        Timer_detachIrqCallback(instance, TIMER_IRQ_SOURCE_CH(channel));
+    }
+    if (trigger == PULSE_TRIGGER_SOFTWARE) {
+        return 1;
+    }
+    if (trigger <= PULSE_TRIGGER_CH1) {
+        channel = (trigger == PULSE_TRIGGER_CH0) ? TIMER_CH_0 : TIMER_CH_1;
+        timer_icinitpara.icpolarity = falling ? TIMER_IC_POLARITY_FALLING : TIMER_IC_POLARITY_RISING;
+        timer_icinitpara.icselection = TIMER_IC_SELECTION_DIRECTTI;
+        timer_icinitpara.icprescaler = TIMER_IC_PSC_DIV1;
+        timer_icinitpara.icfilter = 0x0;
+        timer_input_capture_config(instance, channel, &timer_icinitpara);
+        timer_input_trigger_source_select(instance, (channel == TIMER_CH_0) ? TIMER_SMCFG_TRGSEL_CI0FE0 :
+                                          TIMER_SMCFG_TRGSEL_CI1FE1);
+    } else {
+        timer_input_trigger_source_select(instance, trgsel[trigger - PULSE_TRIGGER_ITI0]);
+    }
+    if (retriggerable) {
+        Timer_attachIrqCallback(instance, TIMER_IRQ_SOURCE_CH(channel), Timer_onePulseRetrigger, (void *)instance);
+        Timer_enableCaptureIT(instance, channel);
+        timer_slave_mode_select(instance, TIMER_SLAVE_MODE_RESTART);
+    } else {
+        /* the trigger sets the counter enable bit, the pulse timing is all hardware */
+        timer_slave_mode_select(instance, TIMER_SLAVE_MODE_EVENT);
+    }
+    return 1;
+}
+
+/*!
+    \brief      start a pulse of Timer_onePulseConfig() now
+    \param[in]  instance: TIMERx
+    \param[out] none
+    \retval     none
+*/
+void Timer_firePulse(uint32_t instance)
+{
+    Timer_wake(instance);
+    TIMER_CTL0(instance) |= TIMER_CTL0_CEN;
+}
+
+/* channels with the complementary output enabled, one bit per channel for each timer index */
+static uint8_t pwmComplementary[17];
+
 /*!
     \brief      initialize pwm
     \param[in]  pwmDevice: pwm device
@@ -728,12 +1144,8 @@ void PWM_init(pwmDevice_t *pwmDevice, pwmPeriodCycle_t *pwmPeriodCycle)
     timer_oc_parameter_struct timer_ocintpara;
     timer_parameter_struct timer_initpara;
     uint32_t periph = pwmDevice->timer;
-#if defined(GD32E23x)
-    /* no subprio */
-    nvic_irq_enable(getTimerCCIrq(periph), 2);
-#else 
-    nvic_irq_enable(getTimerCCIrq(periph), 2, 2);
-#endif
+    irq_priority_enable(getTimerCCIrq(periph), IRQ_PRIO_TIMER);
+    Timer_wake(periph);
     timer_clock_enable(periph);
 #if defined(GD32F30x)
     rcu_periph_clock_enable(RCU_AF);
@@ -752,10 +1164,15 @@ void PWM_init(pwmDevice_t *pwmDevice, pwmPeriodCycle_t *pwmPeriodCycle)
     timer_ocintpara.ocpolarity = TIMER_OC_POLARITY_HIGH;
     timer_ocintpara.outputstate = TIMER_CCX_DISABLE;
     timer_ocintpara.ocidlestate = TIMER_OC_IDLE_STATE_LOW;
+    timer_ocintpara.outputnstate = TIMER_CCXN_DISABLE;
+    timer_ocintpara.ocnpolarity = TIMER_OCN_POLARITY_HIGH;
+    timer_ocintpara.ocnidlestate = TIMER_OCN_IDLE_STATE_LOW;
 
     timer_channel_output_config(pwmDevice->timer, pwmDevice->channel, &timer_ocintpara);
     timer_channel_output_pulse_value_config(pwmDevice->timer, pwmDevice->channel, 4999);
     timer_channel_output_mode_config(pwmDevice->timer, pwmDevice->channel, TIMER_OC_MODE_PWM0);
+    /* duty cycle updates take effect at the next update event, no glitches mid-period */
+    timer_channel_output_shadow_config(pwmDevice->timer, pwmDevice->channel, TIMER_OC_SHADOW_ENABLE);
     timer_auto_reload_shadow_enable(pwmDevice->timer);
     timer_channel_output_fast_config(pwmDevice->timer, pwmDevice->channel, TIMER_OC_FAST_DISABLE);
     timer_primary_output_config(pwmDevice->timer, ENABLE);
@@ -772,18 +1189,84 @@ void PWM_init(pwmDevice_t *pwmDevice, pwmPeriodCycle_t *pwmPeriodCycle)
 */
 void PWM_start(pwmDevice_t *pwmDevice)
 {
+    Timer_wake(pwmDevice->timer);
     timer_channel_output_state_config(pwmDevice->timer, pwmDevice->channel, TIMER_CCX_ENABLE);
+    if (pwmComplementary[getTimerIndex(pwmDevice->timer)] & (1U << pwmDevice->channel)) {
+        timer_channel_complementary_output_state_config(pwmDevice->timer, pwmDevice->channel, TIMER_CCXN_ENABLE);
+    }
+}
+
+/*!
+    \brief      turn the clock of a timer PWM_stop() gated back on, and its counter if that was
+                running; every function writing timer registers calls it first
+    \param[in]  timer: TIMERx
+    \param[out] none
+    \retval     none
+*/
+void Timer_wake(uint32_t timer)
+{
+    uint32_t index = getTimerIndex(timer);
+    uint32_t state;
+
+    if ((index >= 32U) || !(pwmGated & (1UL << index))) {
+        return;
+    }
+    state = critical_enter();
+    if (pwmGated & (1UL << index)) {
+        pwmGated &= ~(1UL << index);
+        timer_clock_enable(timer);
+        if (pwmGatedRunning & (1UL << index)) {
+            pwmGatedRunning &= ~(1UL << index);
+            timer_enable(timer);
+        }
+    }
+    critical_exit(state);
+}
+
+/*!
+    \brief      stop the counter of a timer and gate its clock once no channel drives an output, no
+                interrupt or DMA request is enabled, it triggers nothing and Timer_start() did not
+                start it. The next call writing the timer turns it back on, see Timer_wake()
+    \param[in]  timer: TIMERx
+    \param[out] none
+    \retval     none
+*/
+static void PWM_gateIdle(uint32_t timer)
+{
+    uint32_t index = getTimerIndex(timer);
+    uint32_t state;
+
+    if (index >= 32U) {
+        return;
+    }
+    state = critical_enter();
+    if (!(timerCounting & (1UL << index)) && (TIMER_CHCTL2(timer) == 0U)
+            && (TIMER_DMAINTEN(timer) == 0U) && !(TIMER_CTL1(timer) & TIMER_CTL1_MMC)
+            && !(TIMER_SMCFG(timer) & TIMER_SMCFG_SMC)) {
+        if (TIMER_CTL0(timer) & TIMER_CTL0_CEN) {
+            pwmGatedRunning |= 1UL << index;
+        }
+        timer_disable(timer);
+        timer_clock_disable(timer);
+        pwmGated |= 1UL << index;
+    }
+    critical_exit(state);
 }
 
 /*!
-    \brief      stop pwm output
+    \brief      stop pwm output, the timer clock is gated once the last output of it stopped
     \param[in]  pwmDevice: pwm device
     \param[out] none
     \retval     none
 */
 void PWM_stop(pwmDevice_t *pwmDevice)
 {
+    Timer_wake(pwmDevice->timer);
     timer_channel_output_state_config(pwmDevice->timer, pwmDevice->channel, TIMER_CCX_DISABLE);
+    if (pwmComplementary[getTimerIndex(pwmDevice->timer)] & (1U << pwmDevice->channel)) {
+        timer_channel_complementary_output_state_config(pwmDevice->timer, pwmDevice->channel, TIMER_CCXN_DISABLE);
+    }
+    PWM_gateIdle(pwmDevice->timer);
 }
 
 /*!
@@ -799,6 +1282,8 @@ void PWM_setPeriodCycle(pwmDevice_t *pwmDevice, pwmPeriodCycle_t *pwmPeriodCycle
     uint32_t prescalerfactor = 0;
     uint32_t period_cycle = 0;
     timer_parameter_struct timer_initpara;
+
+    Timer_wake(pwmDevice->timer);
     switch (pwmPeriodCycle->format) {
         case FORMAT_US:
             timer_initpara.prescaler = getTimerClkFrequency(pwmDevice->timer) / 1000000 - 1;
@@ -847,7 +1332,12 @@ void PWM_writeCyclevalue(pwmDevice_t *pwmDevice, pwmPeriodCycle_t *pwmPeriodCycl
 {
     uint32_t value ;
 
+    Timer_wake(pwmDevice->timer);
     switch (pwmPeriodCycle->format) {
+        case FORMAT_TICK:
+            /* raw compare value, the duty cycle is cycle / (period in ticks) */
+            value = pwmPeriodCycle->cycle + 1;
+            break;
         case FORMAT_US:
             value = pwmPeriodCycle->cycle;
             break;
@@ -868,28 +1358,397 @@ void PWM_writeCyclevalue(pwmDevice_t *pwmDevice, pwmPeriodCycle_t *pwmPeriodCycl
 }
 
 /*!
-    \brief      enable pwm interrupt
+    \brief      split a period in timer clock cycles into prescaler and counter period
+    \param[in]  period_cycle: period in timer clock cycles, at least 2
+    \param[out] prescaler: prescaler register value
+    \retval     counter period in ticks, 2..65536
+*/
+static uint32_t PWM_splitPeriod(uint32_t period_cycle, uint32_t *prescaler)
+{
+    uint32_t period;
+
+    /* smallest prescaler that fits the period into the 16 bit counter */
+    *prescaler = (period_cycle - 1U) / 65536U;
+    if (*prescaler > 0xFFFFU) {
+        *prescaler = 0xFFFFU;
+    }
+    period = period_cycle / (*prescaler + 1U);
+    if (period > 65536U) {
+        period = 65536U;
+    }
+    return period;
+}
+
+/*!
+    \brief      set pwm frequency with the finest duty cycle resolution the timer clock allows
     \param[in]  pwmDevice: pwm device
+    \param[in]  freq_hz: pwm frequency in Hz
     \param[out] none
-    \retval     none
+    \retval     period in timer ticks, 0 if freq_hz is out of range
 */
-void PWM_enablePWMIT(pwmDevice_t *pwmDevice)
+uint32_t PWM_setFrequency(pwmDevice_t *pwmDevice, uint32_t freq_hz)
 {
-    uint32_t interrupt;
-    uint32_t interrupt_flag;
-    uint16_t ch = pwmDevice->channel;
-    switch (ch) {
-        case 0:
-            interrupt = TIMER_INT_CH0;
-            interrupt_flag = TIMER_INT_FLAG_CH0;
-            break;
-        case 1:
-            interrupt = TIMER_INT_CH1;
-            interrupt_flag = TIMER_INT_FLAG_CH1;
-            break;
-        case 2:
-            interrupt = TIMER_INT_CH2;
-            interrupt_flag = TIMER_INT_FLAG_CH2;
+    uint32_t period_cycle;
+    uint32_t prescaler;
+    uint32_t period;
+
+    if (freq_hz == 0U) {
+        return 0;
+    }
+    Timer_wake(pwmDevice->timer);
+    period_cycle = getTimerClkFrequency(pwmDevice->timer) / freq_hz;
+    if (period_cycle < 2U) {
+        return 0;
+    }
+    period = PWM_splitPeriod(period_cycle, &prescaler);
+    timer_autoreload_value_config(pwmDevice->timer, period - 1U);
+    /* the update event loads prescaler, period and compare shadows together */
+    timer_prescaler_config(pwmDevice->timer, prescaler, TIMER_PSC_RELOAD_NOW);
+    return period;
+}
+
+/*!
+    \brief      get pwm period
+    \param[in]  pwmDevice: pwm device
+    \param[out] none
+    \retval     period in timer ticks
+*/
+uint32_t PWM_getPeriodTicks(pwmDevice_t *pwmDevice)
+{
+    Timer_wake(pwmDevice->timer);
+    return TIMER_CAR(pwmDevice->timer) + 1U;
+}
+
+/*!
+    \brief      initialize several channels of one timer as a synchronized pwm group
+    \param[in]  timer: TIMERx
+    \param[in]  channels: bit mask of the channels, bit x for TIMER_CH_x
+    \param[in]  freq_hz: pwm frequency in Hz
+    \param[in]  center_aligned: count up and down, the pulses of all channels are centered on each other
+    \param[out] none
+    \retval     full scale compare value (100% duty cycle), 0 if freq_hz is out of range
+*/
+uint32_t PWM_groupInit(uint32_t timer, uint8_t channels, uint32_t freq_hz, uint8_t center_aligned)
+{
+    timer_oc_parameter_struct timer_ocintpara;
+    timer_parameter_struct timer_initpara;
+    uint32_t period_cycle;
+    uint32_t prescaler;
+    uint32_t period;
+    uint16_t ch;
+
+    if (freq_hz == 0U) {
+        return 0;
+    }
+    Timer_wake(timer);
+    period_cycle = getTimerClkFrequency(timer) / freq_hz;
+    if (center_aligned) {
+        /* one pwm period counts up and down again */
+        period_cycle /= 2U;
+    }
+    if (period_cycle < 2U) {
+        return 0;
+    }
+    period = PWM_splitPeriod(period_cycle, &prescaler);
+
+    timer_clock_enable(timer);
+#if defined(GD32F30x)
+    rcu_periph_clock_enable(RCU_AF);
+#elif defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32F4xx)
+    rcu_periph_clock_enable(RCU_CFGCMP);
+#endif
+    timer_struct_para_init(&timer_initpara);
+    timer_initpara.prescaler = prescaler;
+    timer_initpara.counterdirection = TIMER_COUNTER_UP;
+    timer_initpara.clockdivision = TIMER_CKDIV_DIV1;
+    timer_initpara.repetitioncounter = 0;
+    if (center_aligned && (period > 0xFFFFU)) {
+        period = 0xFFFFU;
+    }
+    if (center_aligned) {
+        /* in center aligned mode the counter runs 0..CAR..0, so CAR is the full scale value */
+        timer_initpara.alignedmode = TIMER_COUNTER_CENTER_BOTH;
+        timer_initpara.period = period;
+    } else {
+        timer_initpara.alignedmode = TIMER_COUNTER_EDGE;
+        timer_initpara.period = period - 1U;
+    }
+    timer_init(timer, &timer_initpara);
+
+    timer_ocintpara.ocpolarity = TIMER_OC_POLARITY_HIGH;
+    timer_ocintpara.outputstate = TIMER_CCX_DISABLE;
+    timer_ocintpara.ocidlestate = TIMER_OC_IDLE_STATE_LOW;
+    timer_ocintpara.outputnstate = TIMER_CCXN_DISABLE;
+    timer_ocintpara.ocnpolarity = TIMER_OCN_POLARITY_HIGH;
+    timer_ocintpara.ocnidlestate = TIMER_OCN_IDLE_STATE_LOW;
+    for (ch = TIMER_CH_0; ch <= TIMER_CH_3; ch++) {
+        if (!(channels & (1U << ch))) {
+            continue;
+        }
+        timer_channel_output_config(timer, ch, &timer_ocintpara);
+        timer_channel_output_pulse_value_config(timer, ch, 0);
+        timer_channel_output_mode_config(timer, ch, TIMER_OC_MODE_PWM0);
+        timer_channel_output_shadow_config(timer, ch, TIMER_OC_SHADOW_ENABLE);
+        timer_channel_output_fast_config(timer, ch, TIMER_OC_FAST_DISABLE);
+    }
+    timer_auto_reload_shadow_enable(timer);
+    timer_primary_output_config(timer, ENABLE);
+    timer_enable(timer);
+
+    return period;
+}
+
+/*!
+    \brief      write the compare values of a pwm group, all of them take effect at the same update event
+    \param[in]  timer: TIMERx
+    \param[in]  channels: bit mask of the channels, bit x for TIMER_CH_x
+    \param[in]  values: compare values indexed by channel number
+    \param[out] none
+    \retval     none
+*/
+void PWM_groupWrite(uint32_t timer, uint8_t channels, const uint16_t *values)
+{
+    uint16_t ch;
+
+    Timer_wake(timer);
+    /* hold the shadow transfer so an update event cannot split the writes */
+    timer_update_event_disable(timer);
+    for (ch = TIMER_CH_0; ch <= TIMER_CH_3; ch++) {
+        if (channels & (1U << ch)) {
+            timer_channel_output_pulse_value_config(timer, ch, values[ch]);
+        }
+    }
+    timer_update_event_enable(timer);
+}
+
+/*!
+    \brief      check if a pwm channel has a complementary output, dead time and break input
+    \param[in]  pwmDevice: pwm device
+    \param[out] none
+    \retval     1 if supported, 0 otherwise
+*/
+static uint8_t PWM_hasComplementary(pwmDevice_t *pwmDevice)
+{
+    switch (pwmDevice->timer) {
+        case TIMER0:
+#if defined(TIMER7) && (defined(GD32F30x) || defined(GD32F10x) || defined(GD32E50X))
+        case TIMER7:
+#endif
+            return (pwmDevice->channel <= TIMER_CH_2) ? 1 : 0;
+#if defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+        case TIMER14:
+        case TIMER15:
+        case TIMER16:
+            return (pwmDevice->channel == TIMER_CH_0) ? 1 : 0;
+#endif
+        default:
+            return 0;
+    }
+}
+
+/*!
+    \brief      get the pin function of a timer signal, the PWM pinmap entry is used when there is one
+    \param[in]  pin: pin name
+    \param[in]  timer: TIMERx
+    \param[in]  fallback: pin function to use when the pin is not in PinMap_PWM
+    \param[out] none
+    \retval     pin function
+*/
+static int getTimerPinFunction(PinName pin, uint32_t timer, int fallback)
+{
+    const PinMap *map = PinMap_PWM;
+
+    while (map->pin != NC) {
+        if ((map->pin == pin) && (map->peripheral == (int)timer)) {
+            return map->function;
+        }
+        map++;
+    }
+    return fallback;
+}
+
+/*!
+    \brief      enable the complementary output (CHx_ON) of a pwm channel
+    \param[in]  pwmDevice: pwm device
+    \param[in]  pin: pin of the complementary output, NC if it is already routed
+    \param[out] none
+    \retval     1 if enabled, 0 if the channel has no complementary output
+*/
+uint8_t PWM_enableComplementary(pwmDevice_t *pwmDevice, PinName pin)
+{
+    uint32_t index = getTimerIndex(pwmDevice->timer);
+
+    if (!PWM_hasComplementary(pwmDevice)) {
+        return 0;
+    }
+    Timer_wake(pwmDevice->timer);
+    if (pin != NC) {
+#if defined(GD32F30x) || defined(GD32F10x) || defined(GD32E50X)
+        /* the remap of the primary channel pin also moves the complementary pin */
+        pin_function(pin, getTimerPinFunction(pin, pwmDevice->timer, GD_PIN_FUNCTION1(PIN_MODE_AF_PP, 0)));
+#else
+        /* every CHx_ON pin but TIMER14_CH0_ON on PA1 is on AF2 */
+        pin_function(pin, getTimerPinFunction(pin, pwmDevice->timer, GD_PIN_FUNC_PWM(pwmDevice->channel, 2)));
+#endif
+    }
+    timer_channel_complementary_output_polarity_config(pwmDevice->timer, pwmDevice->channel, TIMER_OCN_POLARITY_HIGH);
+    /* drive both outputs to their inactive level while the channel is stopped or in break */
+    TIMER_CCHP(pwmDevice->timer) |= TIMER_CCHP_ROS | TIMER_CCHP_IOS;
+    pwmComplementary[index] |= (1U << pwmDevice->channel);
+    if (TIMER_CHCTL2(pwmDevice->timer) & (TIMER_CCX_ENABLE << (pwmDevice->channel * 4U))) {
+        timer_channel_complementary_output_state_config(pwmDevice->timer, pwmDevice->channel, TIMER_CCXN_ENABLE);
+    }
+    return 1;
+}
+
+/*!
+    \brief      disable the complementary output of a pwm channel
+    \param[in]  pwmDevice: pwm device
+    \param[out] none
+    \retval     none
+*/
+void PWM_disableComplementary(pwmDevice_t *pwmDevice)
+{
+    if (!PWM_hasComplementary(pwmDevice)) {
+        return;
+    }
+    Timer_wake(pwmDevice->timer);
+    timer_channel_complementary_output_state_config(pwmDevice->timer, pwmDevice->channel, TIMER_CCXN_DISABLE);
+    pwmComplementary[getTimerIndex(pwmDevice->timer)] &= ~(1U << pwmDevice->channel);
+}
+
+/*!
+    \brief      set the dead time inserted between a channel and its complementary output
+    \param[in]  pwmDevice: pwm device
+    \param[in]  dead_time_ns: minimum dead time in nanoseconds, shared by all channels of the timer
+    \param[out] none
+    \retval     dead time actually programmed in nanoseconds, 0 if not supported
+*/
+uint32_t PWM_setDeadTime(pwmDevice_t *pwmDevice, uint32_t dead_time_ns)
+{
+    uint32_t clk = getTimerClkFrequency(pwmDevice->timer);
+    uint32_t ticks;
+    uint32_t step;
+    uint32_t dtcfg;
+
+    if (!PWM_hasComplementary(pwmDevice)) {
+        return 0;
+    }
+    /* round up, the dead time protects the bridge and must never be shorter than asked for */
+    ticks = (uint32_t)(((uint64_t)dead_time_ns * clk + 999999999U) / 1000000000U);
+    /* tDTS is the timer clock, PWM_init() leaves CKDIV at DIV1 */
+    if (ticks <= 127U) {
+        dtcfg = ticks;
+    } else if (ticks <= 254U) {
+        step = (ticks + 1U) / 2U;
+        dtcfg = 0x80U | (step - 64U);
+        ticks = step * 2U;
+    } else if (ticks <= 504U) {
+        step = (ticks + 7U) / 8U;
+        dtcfg = 0xC0U | (step - 32U);
+        ticks = step * 8U;
+    } else {
+        step = (ticks + 15U) / 16U;
+        if (step > 63U) {
+            step = 63U;
+        }
+        dtcfg = 0xE0U | (step - 32U);
+        ticks = step * 16U;
+    }
+    Timer_wake(pwmDevice->timer);
+    TIMER_CCHP(pwmDevice->timer) = (TIMER_CCHP(pwmDevice->timer) & ~TIMER_CCHP_DTCFG) | dtcfg;
+    return (uint32_t)(((uint64_t)ticks * 1000000000U) / clk);
+}
+
+/*!
+    \brief      enable the break input, the outputs go to their idle level while it is active
+    \param[in]  pwmDevice: pwm device
+    \param[in]  pin: break input pin, NC if it is already routed
+    \param[in]  active_high: 1 if a high level on the break input stops the outputs
+    \param[out] none
+    \retval     1 if enabled, 0 if the timer has no break input
+*/
+uint8_t PWM_enableBreak(pwmDevice_t *pwmDevice, PinName pin, uint8_t active_high)
+{
+    uint32_t cchp;
+
+    if (!PWM_hasComplementary(pwmDevice)) {
+        return 0;
+    }
+    if (pin != NC) {
+#if defined(GD32F30x) || defined(GD32F10x) || defined(GD32E50X)
+        pin_function(pin, GD_PIN_FUNCTION1(PIN_MODE_IN_FLOATING, 0));
+#else
+        pin_function(pin, GD_PIN_FUNCTION4(PIN_MODE_AF, PIN_OTYPE_PP, PIN_PUPD_NONE, 2));
+#endif
+    }
+    Timer_wake(pwmDevice->timer);
+    /* no automatic restart, the application re-arms the outputs with PWM_clearBreak() */
+    cchp = TIMER_CCHP(pwmDevice->timer) & ~(TIMER_CCHP_BRKP | TIMER_CCHP_OAEN);
+    cchp |= TIMER_CCHP_BRKEN | TIMER_CCHP_ROS | TIMER_CCHP_IOS;
+    if (active_high) {
+        cchp |= TIMER_CCHP_BRKP;
+    }
+    TIMER_CCHP(pwmDevice->timer) = cchp;
+    timer_flag_clear(pwmDevice->timer, TIMER_FLAG_BRK);
+    return 1;
+}
+
+/*!
+    \brief      disable the break input
+    \param[in]  pwmDevice: pwm device
+    \param[out] none
+    \retval     none
+*/
+void PWM_disableBreak(pwmDevice_t *pwmDevice)
+{
+    if (!PWM_hasComplementary(pwmDevice)) {
+        return;
+    }
+    Timer_wake(pwmDevice->timer);
+    TIMER_CCHP(pwmDevice->timer) &= ~TIMER_CCHP_BRKEN;
+}
+
+/*!
+    \brief      re-enable the outputs after a break event
+    \param[in]  pwmDevice: pwm device
+    \param[out] none
+    \retval     1 if the outputs run again, 0 while the break input is still active
+*/
+uint8_t PWM_clearBreak(pwmDevice_t *pwmDevice)
+{
+    if (!PWM_hasComplementary(pwmDevice)) {
+        return 0;
+    }
+    Timer_wake(pwmDevice->timer);
+    timer_flag_clear(pwmDevice->timer, TIMER_FLAG_BRK);
+    timer_primary_output_config(pwmDevice->timer, ENABLE);
+    return (TIMER_CCHP(pwmDevice->timer) & TIMER_CCHP_POEN) ? 1 : 0;
+}
+
+/*!
+    \brief      enable pwm interrupt
+    \param[in]  pwmDevice: pwm device
+    \param[out] none
+    \retval     none
+*/
+void PWM_enablePWMIT(pwmDevice_t *pwmDevice)
+{
+    uint32_t interrupt;
+    uint32_t interrupt_flag;
+    uint16_t ch = pwmDevice->channel;
+    switch (ch) {
+        case 0:
+            interrupt = TIMER_INT_CH0;
+            interrupt_flag = TIMER_INT_FLAG_CH0;
+            break;
+        case 1:
+            interrupt = TIMER_INT_CH1;
+            interrupt_flag = TIMER_INT_FLAG_CH1;
+            break;
+        case 2:
+            interrupt = TIMER_INT_CH2;
+            interrupt_flag = TIMER_INT_FLAG_CH2;
             break;
         case 3:
             interrupt = TIMER_INT_CH3;
@@ -899,57 +1758,666 @@ void PWM_enablePWMIT(pwmDevice_t *pwmDevice)
             //ToDo: better error handling in case of invalid params
             return;
     }
-    timer_interrupt_flag_clear(pwmDevice->timer, interrupt_flag);
-    timer_interrupt_enable(pwmDevice->timer, interrupt);
+    Timer_wake(pwmDevice->timer);
+    timer_interrupt_flag_clear(pwmDevice->timer, interrupt_flag);
+    timer_interrupt_enable(pwmDevice->timer, interrupt);
+}
+
+/*!
+    \brief      disable pwm interrupt
+    \param[in]  pwmDevice: pwm device
+    \param[out] none
+    \retval     none
+*/
+void PWM_disablePWMIT(pwmDevice_t *pwmDevice)
+{
+    uint32_t interrupt;
+    uint32_t interrupt_flag;
+    uint16_t ch = pwmDevice->channel;
+    switch (ch) {
+        case 0:
+            interrupt = TIMER_INT_CH0;
+            interrupt_flag = TIMER_INT_FLAG_CH0;
+            break;
+        case 1:
+            interrupt = TIMER_INT_CH1;
+            interrupt_flag = TIMER_INT_FLAG_CH1;
+            break;
+        case 2:
+            interrupt = TIMER_INT_CH2;
+            interrupt_flag = TIMER_INT_FLAG_CH2;
+            break;
+        case 3:
+            interrupt = TIMER_INT_CH3;
+            interrupt_flag = TIMER_INT_FLAG_CH3;
+            break;
+        default:
+            //ToDo: better error handling in case of invalid params
+            return;
+    }
+    Timer_wake(pwmDevice->timer);
+    timer_interrupt_flag_clear(pwmDevice->timer, interrupt_flag);
+    timer_interrupt_disable(pwmDevice->timer, interrupt);
+}
+
+/* one slot per timer index, see getTimerIndex() */
+#define PWM_DMA_TIMER_NUM   17
+typedef struct {
+    uint32_t timer;
+    const dma_channel_t *dma;
+    uint8_t loop;
+    volatile uint8_t busy;
+} pwmDmaState_t;
+
+static pwmDmaState_t pwmDmaState[PWM_DMA_TIMER_NUM];
+
+/*!
+    \brief      get the DMA channel serving the update request of a timer
+    \param[in]  timer: TIMERx
+    \param[out] none
+    \retval     DMA channel, NULL if the timer has no update DMA request
+*/
+static const dma_channel_t *getTimerUpDma(uint32_t timer)
+{
+#if defined(GD32F30x) || defined(GD32F10x) || defined(GD32E50X)
+    static const dma_channel_t timer0_up = {DMA0, DMA_CH4};
+    static const dma_channel_t timer1_up = {DMA0, DMA_CH1};
+    static const dma_channel_t timer2_up = {DMA0, DMA_CH2};
+    static const dma_channel_t timer3_up = {DMA0, DMA_CH6};
+#if DMA_CHANNEL_NUM > DMA_CHANNELS_PER_PERIPH
+    static const dma_channel_t timer4_up = {DMA1, DMA_CH1};
+    static const dma_channel_t timer5_up = {DMA1, DMA_CH2};
+    static const dma_channel_t timer6_up = {DMA1, DMA_CH3};
+    static const dma_channel_t timer7_up = {DMA1, DMA_CH0};
+#endif
+#else
+    static const dma_channel_t timer0_up = {0U, DMA_CH4};
+    static const dma_channel_t timer2_up = {0U, DMA_CH2};
+    static const dma_channel_t timer14_up = {0U, DMA_CH4};
+    static const dma_channel_t timer15_up = {0U, DMA_CH2};
+    static const dma_channel_t timer16_up = {0U, DMA_CH0};
+#if defined(TIMER1)
+    static const dma_channel_t timer1_up = {0U, DMA_CH1};
+#endif
+#if defined(TIMER5)
+    static const dma_channel_t timer5_up = {0U, DMA_CH2};
+#endif
+#endif
+
+    switch (timer) {
+        case TIMER0:
+            return &timer0_up;
+#if defined(TIMER1)
+        case TIMER1:
+            return &timer1_up;
+#endif
+        case TIMER2:
+            return &timer2_up;
+#if defined(GD32F30x) || defined(GD32F10x) || defined(GD32E50X)
+#if defined(TIMER3)
+        case TIMER3:
+            return &timer3_up;
+#endif
+#if DMA_CHANNEL_NUM > DMA_CHANNELS_PER_PERIPH
+#if defined(TIMER4)
+        case TIMER4:
+            return &timer4_up;
+#endif
+#if defined(TIMER5)
+        case TIMER5:
+            return &timer5_up;
+#endif
+#if defined(TIMER6)
+        case TIMER6:
+            return &timer6_up;
+#endif
+#if defined(TIMER7)
+        case TIMER7:
+            return &timer7_up;
+#endif
+#endif
+#else
+#if defined(TIMER5)
+        case TIMER5:
+            return &timer5_up;
+#endif
+        case TIMER14:
+            return &timer14_up;
+        case TIMER15:
+            return &timer15_up;
+        case TIMER16:
+            return &timer16_up;
+#endif
+        default:
+            return NULL;
+    }
+}
+
+/*!
+    \brief      get the DMA channel serving the capture/compare request of a timer channel
+    \param[in]  timer: TIMERx
+    \param[in]  channel: TIMER_CH_x(x=0..3)
+    \param[out] none
+    \retval     DMA channel, NULL if the channel has no DMA request
+*/
+static const dma_channel_t *getTimerChDma(uint32_t timer, uint8_t channel)
+{
+    typedef struct {
+        uint32_t timer;
+        uint8_t valid;          /* bit x set if channel x has a DMA request */
+        dma_channel_t dma[4];
+    } timerChDma_t;
+    static const timerChDma_t timerChDma[] = {
+#if defined(GD32F30x) || defined(GD32F10x) || defined(GD32E50X)
+        {TIMER0, 0x0F, {{DMA0, DMA_CH1}, {DMA0, DMA_CH2}, {DMA0, DMA_CH5}, {DMA0, DMA_CH3}}},
+        {TIMER1, 0x0F, {{DMA0, DMA_CH4}, {DMA0, DMA_CH6}, {DMA0, DMA_CH0}, {DMA0, DMA_CH6}}},
+        {TIMER2, 0x0D, {{DMA0, DMA_CH5}, {DMA0, DMA_CH0}, {DMA0, DMA_CH1}, {DMA0, DMA_CH2}}},
+#if defined(TIMER3)
+        {TIMER3, 0x07, {{DMA0, DMA_CH0}, {DMA0, DMA_CH3}, {DMA0, DMA_CH4}, {DMA0, DMA_CH0}}},
+#endif
+#if DMA_CHANNEL_NUM > DMA_CHANNELS_PER_PERIPH
+#if defined(TIMER4)
+        {TIMER4, 0x0F, {{DMA1, DMA_CH4}, {DMA1, DMA_CH3}, {DMA1, DMA_CH1}, {DMA1, DMA_CH0}}},
+#endif
+#if defined(TIMER7)
+        {TIMER7, 0x0F, {{DMA1, DMA_CH2}, {DMA1, DMA_CH4}, {DMA1, DMA_CH0}, {DMA1, DMA_CH1}}},
+#endif
+#endif
+#else
+        {TIMER0, 0x0F, {{0U, DMA_CH1}, {0U, DMA_CH2}, {0U, DMA_CH4}, {0U, DMA_CH3}}},
+#if defined(TIMER1)
+        {TIMER1, 0x0F, {{0U, DMA_CH4}, {0U, DMA_CH2}, {0U, DMA_CH0}, {0U, DMA_CH3}}},
+#endif
+        {TIMER2, 0x0D, {{0U, DMA_CH3}, {0U, DMA_CH0}, {0U, DMA_CH1}, {0U, DMA_CH2}}},
+        {TIMER14, 0x01, {{0U, DMA_CH4}, {0U, DMA_CH0}, {0U, DMA_CH0}, {0U, DMA_CH0}}},
+        {TIMER15, 0x01, {{0U, DMA_CH2}, {0U, DMA_CH0}, {0U, DMA_CH0}, {0U, DMA_CH0}}},
+        {TIMER16, 0x01, {{0U, DMA_CH0}, {0U, DMA_CH0}, {0U, DMA_CH0}, {0U, DMA_CH0}}},
+#endif
+    };
+    uint32_t i;
+
+    if (channel > TIMER_CH_3) {
+        return NULL;
+    }
+    for (i = 0; i < sizeof(timerChDma) / sizeof(timerChDma[0]); i++) {
+        if ((timerChDma[i].timer == timer) && (timerChDma[i].valid & (1U << channel))) {
+            return &timerChDma[i].dma[channel];
+        }
+    }
+    return NULL;
+}
+
+/*!
+    \brief      copy every capture of a timer channel into a ring buffer by DMA
+    \param[in]  instance: TIMERx, the channel must already be configured for input capture
+    \param[in]  channel: TIMER_CH_x(x=0..3)
+    \param[in]  buffer: ring buffer receiving the capture values, must stay valid while capturing
+    \param[in]  length: number of values in buffer
+    \param[in]  callback: called from the DMA interrupt when the first or second half is filled
+    \param[in]  arg: passed through to callback
+    \param[out] none
+    \retval     1 if capturing started, 0 if the channel has no DMA request or it is in use
+*/
+uint8_t Timer_captureDmaStart(uint32_t instance, uint8_t channel, uint16_t *buffer, size_t length,
+                              dma_callback_t callback, void *arg)
+{
+    dma_parameter_struct dma_init_struct;
+    const dma_channel_t *ch = getTimerChDma(instance, channel);
+
+    if ((ch == NULL) || (buffer == NULL) || (length == 0U)) {
+        return 0;
+    }
+    Timer_wake(instance);
+    Timer_captureDmaStop(instance, channel);
+    /* the map entry stands for this timer channel */
+    if (!dma_channel_claim(ch, ch)) {
+        return 0;
+    }
+
+    dma_channel_clock_enable(ch);
+    dma_deinit(DMA_SPL_ARGS(ch));
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.direction    = DMA_PERIPHERAL_TO_MEMORY;
+    dma_init_struct.memory_addr  = (uint32_t)buffer;
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_16BIT;
+    dma_init_struct.number       = length;
+    dma_init_struct.periph_addr  = (uint32_t)&TIMER_CH0CV(instance) + 4U * channel;
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_16BIT;
+    dma_init_struct.priority     = DMA_PRIORITY_HIGH;
+    dma_init(DMA_SPL_ARGS(ch), &dma_init_struct);
+    dma_circulation_enable(DMA_SPL_ARGS(ch));
+    dma_memory_to_memory_disable(DMA_SPL_ARGS(ch));
+    if (callback != NULL) {
+        dma_channel_attach_irq(ch, callback, arg, IRQ_LEVEL(IRQ_PRIO_TIMER_DMA));
+        dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_HTF);
+        dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_FTF);
+    }
+    dma_channel_enable(DMA_SPL_ARGS(ch));
+    timer_dma_enable(instance, (uint16_t)(TIMER_DMA_CH0D << channel));
+
+    return 1;
+}
+
+/*!
+    \brief      stop copying captures of a timer channel
+    \param[in]  instance: TIMERx
+    \param[in]  channel: TIMER_CH_x(x=0..3)
+    \param[out] none
+    \retval     none
+*/
+void Timer_captureDmaStop(uint32_t instance, uint8_t channel)
+{
+    const dma_channel_t *ch = getTimerChDma(instance, channel);
+
+    if ((ch == NULL) || (dma_channel_owner(ch) != ch)) {
+        return;
+    }
+    Timer_wake(instance);
+    timer_dma_disable(instance, (uint16_t)(TIMER_DMA_CH0D << channel));
+    dma_channel_disable(DMA_SPL_ARGS(ch));
+    dma_interrupt_disable(DMA_SPL_ARGS(ch), DMA_INT_HTF);
+    dma_interrupt_disable(DMA_SPL_ARGS(ch), DMA_INT_FTF);
+    dma_channel_detach_irq(ch);
+    dma_channel_release(ch, ch);
+}
+
+/*!
+    \brief      get the number of captures left until the DMA wraps to the start of the buffer
+    \param[in]  instance: TIMERx
+    \param[in]  channel: TIMER_CH_x(x=0..3)
+    \param[out] none
+    \retval     remaining transfers, 0 if the channel has no DMA request
+*/
+uint32_t Timer_captureDmaRemaining(uint32_t instance, uint8_t channel)
+{
+    const dma_channel_t *ch = getTimerChDma(instance, channel);
+
+    if (ch == NULL) {
+        return 0;
+    }
+    return dma_transfer_number_get(DMA_SPL_ARGS(ch));
+}
+
+/*!
+    \brief      write one word of a buffer to a peripheral register at every update event
+    \param[in]  instance: TIMERx with an update DMA request
+    \param[in]  periph_addr: address of the 32-bit register written, e.g. a GPIO_BOP
+    \param[in]  buffer: words to write, must stay valid until the transfer is done
+    \param[in]  length: number of words
+    \param[in]  loop: 1 to start over at the first word after the last one, until stopped
+    \param[in]  callback: called from the DMA interrupt once the last word is written, in a
+                loop also once the first half is
+    \param[in]  arg: passed through to callback
+    \param[out] none
+    \retval     1 if the transfer is armed, 0 if the timer has no update DMA request or it is in use
+*/
+uint8_t Timer_updateDmaStart(uint32_t instance, uint32_t periph_addr, const uint32_t *buffer,
+                             size_t length, uint8_t loop, dma_callback_t callback, void *arg)
+{
+    dma_parameter_struct dma_init_struct;
+    const dma_channel_t *ch = getTimerUpDma(instance);
+
+    if ((ch == NULL) || (buffer == NULL) || (length == 0U)) {
+        return 0;
+    }
+    Timer_wake(instance);
+    Timer_updateDmaStop(instance);
+    if (!dma_channel_claim(ch, ch)) {
+        return 0;
+    }
+
+    dma_channel_clock_enable(ch);
+    dma_deinit(DMA_SPL_ARGS(ch));
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.direction    = DMA_MEMORY_TO_PERIPHERAL;
+    dma_init_struct.memory_addr  = (uint32_t)buffer;
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_32BIT;
+    dma_init_struct.number       = length;
+    dma_init_struct.periph_addr  = periph_addr;
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_32BIT;
+    dma_init_struct.priority     = DMA_PRIORITY_ULTRA_HIGH;
+    dma_init(DMA_SPL_ARGS(ch), &dma_init_struct);
+    if (loop) {
+        dma_circulation_enable(DMA_SPL_ARGS(ch));
+    } else {
+        dma_circulation_disable(DMA_SPL_ARGS(ch));
+    }
+    dma_memory_to_memory_disable(DMA_SPL_ARGS(ch));
+    if (callback != NULL) {
+        dma_channel_attach_irq(ch, callback, arg, IRQ_LEVEL(IRQ_PRIO_TIMER_DMA));
+        if (loop) {
+            dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_HTF);
+        }
+        dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_FTF);
+    }
+    dma_channel_enable(DMA_SPL_ARGS(ch));
+    timer_dma_enable(instance, TIMER_DMA_UPD);
+
+    return 1;
+}
+
+/*!
+    \brief      read a peripheral register into a ring buffer at every update event, e.g. the input
+                register of a GPIO port
+    \param[in]  instance: TIMERx with an update DMA request
+    \param[in]  periph_addr: address of the register read
+    \param[in]  buffer: ring buffer, must stay valid until Timer_updateDmaStop()
+    \param[in]  length: number of values in buffer
+    \param[in]  width: bytes stored per event, 1 or 2; the register is read as a word, which all
+                peripherals take, and the DMA keeps its low bytes
+    \param[in]  callback: called from the DMA interrupt as each half of the buffer is filled
+    \param[in]  arg: passed through to callback
+    \param[out] none
+    \retval     1 if sampling is armed, 0 if the timer has no update DMA request or it is in use
+*/
+uint8_t Timer_updateDmaSample(uint32_t instance, uint32_t periph_addr, void *buffer, size_t length,
+                              uint8_t width, dma_callback_t callback, void *arg)
+{
+    dma_parameter_struct dma_init_struct;
+    const dma_channel_t *ch = getTimerUpDma(instance);
+
+    if ((ch == NULL) || (buffer == NULL) || (length == 0U) || ((width != 1U) && (width != 2U))) {
+        return 0;
+    }
+    Timer_wake(instance);
+    Timer_updateDmaStop(instance);
+    if (!dma_channel_claim(ch, ch)) {
+        return 0;
+    }
+
+    dma_channel_clock_enable(ch);
+    dma_deinit(DMA_SPL_ARGS(ch));
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.direction    = DMA_PERIPHERAL_TO_MEMORY;
+    dma_init_struct.memory_addr  = (uint32_t)buffer;
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = (width == 1U) ? DMA_MEMORY_WIDTH_8BIT : DMA_MEMORY_WIDTH_16BIT;
+    dma_init_struct.number       = length;
+    dma_init_struct.periph_addr  = periph_addr;
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_32BIT;
+    /* a late request is a lost sample, nothing else on the channel matters more */
+    dma_init_struct.priority     = DMA_PRIORITY_ULTRA_HIGH;
+    dma_init(DMA_SPL_ARGS(ch), &dma_init_struct);
+    dma_circulation_enable(DMA_SPL_ARGS(ch));
+    dma_memory_to_memory_disable(DMA_SPL_ARGS(ch));
+    if (callback != NULL) {
+        dma_channel_attach_irq(ch, callback, arg, IRQ_LEVEL(IRQ_PRIO_TIMER_DMA));
+        dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_HTF);
+        dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_FTF);
+    }
+    dma_channel_enable(DMA_SPL_ARGS(ch));
+    timer_dma_enable(instance, TIMER_DMA_UPD);
+
+    return 1;
 }
 
 /*!
-    \brief      disable pwm interrupt
+    \brief      read a peripheral register into a ring buffer at a compare event of a channel, once
+                per period at a set point of it; with Timer_updateDmaStart() writing a port at the
+                update, the read sees the pins a fixed time after every write
+    \param[in]  instance: TIMERx
+    \param[in]  channel: TIMER_CH_x(x=0..3) with a DMA request, not driving a pin
+    \param[in]  compare: counter value of the read, below the reload value
+    \param[in]  periph_addr: address of the register read
+    \param[in]  buffer: ring buffer, must stay valid until Timer_captureDmaStop()
+    \param[in]  length: number of values in buffer
+    \param[in]  width: bytes stored per event, 1 or 2
+    \param[in]  callback: called from the DMA interrupt as each half of the buffer is filled
+    \param[in]  arg: passed through to callback
+    \param[out] none
+    \retval     1 if sampling is armed, 0 if the channel has no DMA request or it is in use
+*/
+uint8_t Timer_compareDmaSample(uint32_t instance, uint8_t channel, uint32_t compare, uint32_t periph_addr,
+                               void *buffer, size_t length, uint8_t width, dma_callback_t callback, void *arg)
+{
+    dma_parameter_struct dma_init_struct;
+    timer_oc_parameter_struct timer_ocintpara;
+    const dma_channel_t *ch = getTimerChDma(instance, channel);
+
+    if ((ch == NULL) || (buffer == NULL) || (length == 0U) || ((width != 1U) && (width != 2U))) {
+        return 0;
+    }
+    Timer_wake(instance);
+    Timer_captureDmaStop(instance, channel);
+    if (!dma_channel_claim(ch, ch)) {
+        return 0;
+    }
+
+    /* a timing compare only raises the channel flag, and with it the DMA request */
+    timer_ocintpara.ocpolarity = TIMER_OC_POLARITY_HIGH;
+    timer_ocintpara.outputstate = TIMER_CCX_DISABLE;
+    timer_ocintpara.ocidlestate = TIMER_OC_IDLE_STATE_LOW;
+    timer_ocintpara.outputnstate = TIMER_CCXN_DISABLE;
+    timer_ocintpara.ocnpolarity = TIMER_OCN_POLARITY_HIGH;
+    timer_ocintpara.ocnidlestate = TIMER_OCN_IDLE_STATE_LOW;
+    timer_channel_output_config(instance, channel, &timer_ocintpara);
+    timer_channel_output_mode_config(instance, channel, TIMER_OC_MODE_TIMING);
+    timer_channel_output_shadow_config(instance, channel, TIMER_OC_SHADOW_DISABLE);
+    timer_channel_output_pulse_value_config(instance, channel, compare);
+
+    dma_channel_clock_enable(ch);
+    dma_deinit(DMA_SPL_ARGS(ch));
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.direction    = DMA_PERIPHERAL_TO_MEMORY;
+    dma_init_struct.memory_addr  = (uint32_t)buffer;
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = (width == 1U) ? DMA_MEMORY_WIDTH_8BIT : DMA_MEMORY_WIDTH_16BIT;
+    dma_init_struct.number       = length;
+    dma_init_struct.periph_addr  = periph_addr;
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_32BIT;
+    dma_init_struct.priority     = DMA_PRIORITY_ULTRA_HIGH;
+    dma_init(DMA_SPL_ARGS(ch), &dma_init_struct);
+    dma_circulation_enable(DMA_SPL_ARGS(ch));
+    dma_memory_to_memory_disable(DMA_SPL_ARGS(ch));
+    if (callback != NULL) {
+        dma_channel_attach_irq(ch, callback, arg, IRQ_LEVEL(IRQ_PRIO_TIMER_DMA));
+        dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_HTF);
+        dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_FTF);
+    }
+    dma_channel_enable(DMA_SPL_ARGS(ch));
+    timer_dma_enable(instance, (uint16_t)(TIMER_DMA_CH0D << channel));
+
+    return 1;
+}
+
+/*!
+    \brief      get the number of transfers left of Timer_updateDmaStart(), or until
+                Timer_updateDmaSample() wraps to the start
+    \param[in]  instance: TIMERx
+    \param[out] none
+    \retval     remaining transfers, 0 if the timer has no update DMA request
+*/
+uint32_t Timer_updateDmaRemaining(uint32_t instance)
+{
+    const dma_channel_t *ch = getTimerUpDma(instance);
+
+    if (ch == NULL) {
+        return 0;
+    }
+    return dma_transfer_number_get(DMA_SPL_ARGS(ch));
+}
+
+/*!
+    \brief      stop writing words at update events
+    \param[in]  instance: TIMERx
+    \param[out] none
+    \retval     none
+*/
+void Timer_updateDmaStop(uint32_t instance)
+{
+    const dma_channel_t *ch = getTimerUpDma(instance);
+
+    if ((ch == NULL) || (dma_channel_owner(ch) != ch)) {
+        return;
+    }
+    Timer_wake(instance);
+    timer_dma_disable(instance, TIMER_DMA_UPD);
+    dma_channel_disable(DMA_SPL_ARGS(ch));
+    dma_interrupt_disable(DMA_SPL_ARGS(ch), DMA_INT_HTF);
+    dma_interrupt_disable(DMA_SPL_ARGS(ch), DMA_INT_FTF);
+    dma_channel_detach_irq(ch);
+    dma_channel_release(ch, ch);
+}
+
+/*!
+    \brief      pwm stream DMA channel interrupt
+    \param[in]  arg: pwmDmaState_t of the timer
+    \param[in]  flags: DMA channel flags
+    \param[out] none
+    \retval     none
+*/
+static void PWM_dmaIrq(void *arg, uint32_t flags)
+{
+    pwmDmaState_t *state = (pwmDmaState_t *)arg;
+
+    if ((flags & DMA_CALLBACK_FLAG_FTF) && !state->loop) {
+        /* the last value stays in the shadow register and keeps being output */
+        timer_dma_disable(state->timer, TIMER_DMA_UPD);
+        dma_channel_disable(DMA_SPL_ARGS(state->dma));
+        state->busy = 0;
+    }
+}
+
+/*!
+    \brief      stream compare values to a pwm channel, one per timer period
+    \param[in]  pwmDevice: pwm device
+    \param[in]  buffer: compare values in timer ticks, must stay valid while streaming
+    \param[in]  length: number of values
+    \param[in]  loop: restart at the beginning of buffer after the last value
+    \param[out] none
+    \retval     1 if streaming started, 0 if the timer has no update DMA request or it is in use
+*/
+uint8_t PWM_playBuffer(pwmDevice_t *pwmDevice, const uint16_t *buffer, size_t length,
+                       uint8_t loop)
+{
+    dma_parameter_struct dma_init_struct;
+    uint32_t index = getTimerIndex(pwmDevice->timer);
+    const dma_channel_t *ch = getTimerUpDma(pwmDevice->timer);
+    pwmDmaState_t *state;
+
+    if ((ch == NULL) || (index >= PWM_DMA_TIMER_NUM) || (buffer == NULL) || (length == 0U)) {
+        return 0;
+    }
+    state = &pwmDmaState[index];
+    Timer_wake(pwmDevice->timer);
+    PWM_stopBuffer(pwmDevice);
+    if (!dma_channel_claim(ch, state)) {
+        return 0;
+    }
+
+    state->timer = pwmDevice->timer;
+    state->dma   = ch;
+    state->loop  = loop;
+
+    dma_channel_clock_enable(ch);
+    dma_deinit(DMA_SPL_ARGS(ch));
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.direction    = DMA_MEMORY_TO_PERIPHERAL;
+    dma_init_struct.memory_addr  = (uint32_t)buffer;
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_16BIT;
+    dma_init_struct.number       = length;
+    dma_init_struct.periph_addr  = (uint32_t)&TIMER_CH0CV(pwmDevice->timer) + 4U * pwmDevice->channel;
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_16BIT;
+    dma_init_struct.priority     = DMA_PRIORITY_HIGH;
+    dma_init(DMA_SPL_ARGS(ch), &dma_init_struct);
+    if (loop) {
+        dma_circulation_enable(DMA_SPL_ARGS(ch));
+    } else {
+        dma_circulation_disable(DMA_SPL_ARGS(ch));
+    }
+    dma_memory_to_memory_disable(DMA_SPL_ARGS(ch));
+    dma_channel_attach_irq(ch, PWM_dmaIrq, state, IRQ_LEVEL(IRQ_PRIO_TIMER_DMA));
+    dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_FTF);
+
+    /* a value written during a period takes effect at the next update event */
+    timer_channel_output_shadow_config(pwmDevice->timer, pwmDevice->channel, TIMER_OC_SHADOW_ENABLE);
+    state->busy = 1;
+    dma_channel_enable(DMA_SPL_ARGS(ch));
+    timer_dma_enable(pwmDevice->timer, TIMER_DMA_UPD);
+
+    return 1;
+}
+
+/*!
+    \brief      stop streaming compare values, the current compare value is kept
     \param[in]  pwmDevice: pwm device
     \param[out] none
     \retval     none
 */
-void PWM_disablePWMIT(pwmDevice_t *pwmDevice)
+void PWM_stopBuffer(pwmDevice_t *pwmDevice)
 {
-    uint32_t interrupt;
-    uint32_t interrupt_flag;
-    uint16_t ch = pwmDevice->channel;
-    switch (ch) {
-        case 0:
-            interrupt = TIMER_INT_CH0;
-            interrupt_flag = TIMER_INT_FLAG_CH0;
-            break;
-        case 1:
-            interrupt = TIMER_INT_CH1;
-            interrupt_flag = TIMER_INT_FLAG_CH1;
-            break;
-        case 2:
-            interrupt = TIMER_INT_CH2;
-            interrupt_flag = TIMER_INT_FLAG_CH2;
-            break;
-        case 3:
-            interrupt = TIMER_INT_CH3;
-            interrupt_flag = TIMER_INT_FLAG_CH3;
-            break;
-        default:
-            //ToDo: better error handling in case of invalid params
-            return;
+    uint32_t index = getTimerIndex(pwmDevice->timer);
+    pwmDmaState_t *state;
+
+    if (index >= PWM_DMA_TIMER_NUM) {
+        return;
     }
-    timer_interrupt_flag_clear(pwmDevice->timer, interrupt_flag);
-    timer_interrupt_disable(pwmDevice->timer, interrupt);
+    state = &pwmDmaState[index];
+    if ((state->dma == NULL) || (dma_channel_owner(state->dma) != state)) {
+        return;
+    }
+    Timer_wake(pwmDevice->timer);
+    timer_dma_disable(pwmDevice->timer, TIMER_DMA_UPD);
+    dma_channel_disable(DMA_SPL_ARGS(state->dma));
+    dma_channel_detach_irq(state->dma);
+    dma_channel_release(state->dma, state);
+    state->busy = 0;
+}
+
+/*!
+    \brief      check if compare values are being streamed
+    \param[in]  pwmDevice: pwm device
+    \param[out] none
+    \retval     1 while streaming, 0 otherwise
+*/
+uint8_t PWM_bufferBusy(pwmDevice_t *pwmDevice)
+{
+    uint32_t index = getTimerIndex(pwmDevice->timer);
+
+    if (index >= PWM_DMA_TIMER_NUM) {
+        return 0;
+    }
+    return pwmDmaState[index].busy;
+}
+
+/*
+ * Input clocks of the APB1 and APB2 timers, worked out once for the clock
+ * set-up in ‘cfg0’ and ‘generation’. clock_set_system() moves the
+ * generation on, and anything else that reprograms the bus prescalers
+ * changes RCU_CFG0, so either brings a recompute on the next call.
+ */
+static struct {
+    uint32_t hz[2];
+    uint32_t cfg0;
+    uint32_t generation;
+    uint8_t valid;
+} timer_clock_cache;
+
+/* an APB timer clock is the bus clock, doubled while the bus is divided */
+static uint32_t timer_bus_clock(rcu_clock_freq_enum bus, uint32_t divided)
+{
+    return (0U != divided) ? 2U * rcu_clock_freq_get(bus) : rcu_clock_freq_get(bus);
 }
 
 /*!
     \brief      get timer clock frequency
     \param[in]  instance: TIMERx(x=0..13)
     \param[out] none
-    \retval     none
+    \retval     timer input clock in Hz, 0 for an unknown timer
 */
 uint32_t getTimerClkFrequency(uint32_t instance)
 {
-    rcu_clock_freq_enum timerclkSrc =  NC;
-    uint32_t APBx_PSC = 0;
-    uint32_t clk_src = 0;
+    uint32_t bus = 2U;
+    uint32_t clk_src;
+    uint32_t state;
 
     if (instance != (uint32_t) NC) {
         switch ((uint32_t)instance) {
@@ -968,8 +2436,7 @@ uint32_t getTimerClkFrequency(uint32_t instance)
 #if defined(TIMER10)
             case (uint32_t)TIMER10:
 #endif
-                timerclkSrc = CK_APB2;
-                APBx_PSC = (RCU_CFG0 & RCU_CFG0_APB2PSC) >> 11;
+                bus = 1U;
                 break;
 #if defined(TIMER1)
             case (uint32_t)TIMER1:
@@ -983,7 +2450,7 @@ uint32_t getTimerClkFrequency(uint32_t instance)
 #if defined(TIMER4)
             case (uint32_t)TIMER4:
 #endif
-#if defined(TIMER5) && !defined(NO_TIMER_5)
+#if defined(TIMER5)
             case (uint32_t)TIMER5:
 #endif
 #if defined(TIMER6)
@@ -1007,18 +2474,27 @@ uint32_t getTimerClkFrequency(uint32_t instance)
 #if defined(TIMER16)
             case (uint32_t)TIMER16:
 #endif
-                timerclkSrc = CK_APB1;
-                APBx_PSC = (RCU_CFG0 & RCU_CFG0_APB1PSC) >> 8;
+                bus = 0U;
                 break;
             default:
                 break;
         }
     }
-    if (0 != (APBx_PSC & 0x04)) {
-        clk_src = 2 * rcu_clock_freq_get(timerclkSrc);
-    } else {
-        clk_src =  rcu_clock_freq_get(timerclkSrc);
+    if (bus > 1U) {
+        return 0U;
+    }
+
+    state = critical_enter();
+    if ((0U == timer_clock_cache.valid) || (timer_clock_cache.cfg0 != RCU_CFG0) ||
+            (timer_clock_cache.generation != clock_generation())) {
+        timer_clock_cache.cfg0 = RCU_CFG0;
+        timer_clock_cache.generation = clock_generation();
+        timer_clock_cache.hz[0] = timer_bus_clock(CK_APB1, ((timer_clock_cache.cfg0 & RCU_CFG0_APB1PSC) >> 8) & 0x04U);
+        timer_clock_cache.hz[1] = timer_bus_clock(CK_APB2, ((timer_clock_cache.cfg0 & RCU_CFG0_APB2PSC) >> 11) & 0x04U);
+        timer_clock_cache.valid = 1U;
     }
+    clk_src = timer_clock_cache.hz[bus];
+    critical_exit(state);
     return clk_src;
 }
 
@@ -1060,7 +2536,7 @@ IRQn_Type getTimerUpIrq(uint32_t tim)
                 IRQn = TIMER4_IRQn;
                 break;
 #endif
-#if defined(TIMER5) && !defined(NO_TIMER_5)
+#if defined(TIMER5)
             case (uint32_t)TIMER5:
                 IRQn = TIMER5_IRQ_Name;
                 break;
@@ -1168,7 +2644,7 @@ IRQn_Type getTimerCCIrq(uint32_t tim)
                 IRQn = TIMER4_IRQn;
                 break;
 #endif
-#if defined(TIMER5) && !defined(NO_TIMER_5)
+#if defined(TIMER5)
             case (uint32_t)TIMER5:
                 IRQn = TIMER5_IRQ_Name;
                 break;
@@ -1235,210 +2711,595 @@ IRQn_Type getTimerCCIrq(uint32_t tim)
     return IRQn;
 }
 
+/* every flag timerinterrupthandle() dispatches, UPIF and CH0IF..CH3IF */
+#define TIMER_IRQ_SOURCE_MASK       (TIMER_INTF_UPIF | TIMER_INTF_CH0IF | TIMER_INTF_CH1IF | \
+                                     TIMER_INTF_CH2IF | TIMER_INTF_CH3IF)
+#define TIMER_IRQ_TIMER_NUM         17
+
+typedef struct {
+    timerIrqCallback_t callback;
+    void *arg;
+} timerIrqInfor_t;
+
+/* one row per timer index, see getTimerIndex(), one column per TIMER_IRQ_SOURCE_x */
+static timerIrqInfor_t timerIrqInfor[TIMER_IRQ_TIMER_NUM][TIMER_IRQ_SOURCE_NUM];
+
 /*!
-    \brief      timer interrupt handler
-    \param[in]  timer: TIMERx(x=0..13)
+    \brief      route one timer interrupt source to a callback
+    \param[in]  instance: TIMERx(x=0..16)
+    \param[in]  source: TIMER_IRQ_SOURCE_UP or TIMER_IRQ_SOURCE_CH(x)(x=0..3)
+    \param[in]  callback: called from the timer interrupt as callback(arg, source)
+    \param[in]  arg: passed through to the callback
     \param[out] none
     \retval     none
 */
-void timerinterrupthandle(uint32_t timer)
+void Timer_attachIrqCallback(uint32_t instance, uint8_t source, timerIrqCallback_t callback,
+                             void *arg)
 {
-    if (timer_interrupt_flag_get(timer, TIMER_INT_FLAG_UP) != RESET) {
-        timer_interrupt_flag_clear(timer, TIMER_INT_FLAG_UP);
-        if (timerHandle.interruptHandle) {
-            timerHandle.interruptHandle(timer);
-        }
-    } else if (timer_interrupt_flag_get(timer, TIMER_INT_FLAG_CH0) != RESET) {
-        timer_interrupt_flag_clear(timer, TIMER_INT_FLAG_CH0);
-        if (pwmHandle.interruptHandle) {
-            pwmHandle.interruptHandle(timer, TIMER_CH_0);
-        }
-        if (timerHandle.captureInterruptHandle[0]) {
-            timerHandle.captureInterruptHandle[0](timer, 0);
-        }
-    } else if (timer_interrupt_flag_get(timer, TIMER_INT_FLAG_CH1) != RESET) {
-        timer_interrupt_flag_clear(timer, TIMER_INT_FLAG_CH1);
-        if (pwmHandle.interruptHandle) {
-            pwmHandle.interruptHandle(timer, TIMER_CH_1);
-        }
-        if (timerHandle.captureInterruptHandle[1]) {
-            timerHandle.captureInterruptHandle[1](timer, 1);
+    uint32_t index = getTimerIndex(instance);
+
+    if ((index >= TIMER_IRQ_TIMER_NUM) || (source >= TIMER_IRQ_SOURCE_NUM)) {
+        return;
+    }
+    /* clear the callback first so the interrupt never sees a new callback with an old arg */
+    timerIrqInfor[index][source].callback = NULL;
+    timerIrqInfor[index][source].arg = arg;
+    timerIrqInfor[index][source].callback = callback;
+}
+
+/*!
+    \brief      remove the callback of one timer interrupt source
+    \param[in]  instance: TIMERx(x=0..16)
+    \param[in]  source: TIMER_IRQ_SOURCE_UP or TIMER_IRQ_SOURCE_CH(x)(x=0..3)
+    \param[out] none
+    \retval     none
+*/
+void Timer_detachIrqCallback(uint32_t instance, uint8_t source)
+{
+    uint32_t index = getTimerIndex(instance);
+
+    if ((index >= TIMER_IRQ_TIMER_NUM) || (source >= TIMER_IRQ_SOURCE_NUM)) {
+        return;
+    }
+    timerIrqInfor[index][source].callback = NULL;
+    timerIrqInfor[index][source].arg = NULL;
+}
+
+/*!
+    \brief      check that a timer has the channel pair a pulse measurement needs
+    \param[in]  instance: TIMERx
+    \param[in]  lead: lower channel of the pair
+    \param[out] none
+    \retval     1 if both channels of the pair exist
+*/
+static uint8_t Timer_pulseHasPair(uint32_t instance, uint8_t lead)
+{
+    /* timers with a single channel */
+#if defined(TIMER9)
+    if (instance == TIMER9) {
+        return 0;
+    }
+#endif
+#if defined(TIMER10)
+    if (instance == TIMER10) {
+        return 0;
+    }
+#endif
+#if defined(TIMER12)
+    if (instance == TIMER12) {
+        return 0;
+    }
+#endif
+#if defined(TIMER13)
+    if (instance == TIMER13) {
+        return 0;
+    }
+#endif
+#if defined(TIMER15)
+    if (instance == TIMER15) {
+        return 0;
+    }
+#endif
+#if defined(TIMER16)
+    if (instance == TIMER16) {
+        return 0;
+    }
+#endif
+    /* two channel timers */
+#if defined(TIMER8)
+    if ((instance == TIMER8) && (lead > 0U)) {
+        return 0;
+    }
+#endif
+#if defined(TIMER11)
+    if ((instance == TIMER11) && (lead > 0U)) {
+        return 0;
+    }
+#endif
+#if defined(TIMER14)
+    if ((instance == TIMER14) && (lead > 0U)) {
+        return 0;
+    }
+#endif
+    return 1;
+}
+
+/*!
+    \brief      extend a 16 bit counter value of a pulse measurement to the 32 bit tick count
+    \param[in]  pulse: the measurement
+    \param[in]  value: counter or capture value, less than one counter wrap old
+    \param[out] none
+    \retval     ticks since the start of the measurement
+*/
+static uint32_t Timer_pulseTime(timerPulse_t *pulse, uint32_t value)
+{
+    uint32_t cnt = TIMER_CNT(pulse->instance);
+    uint32_t wraps = pulse->wraps;
+
+    /* an overflow raised but not counted yet happened before cnt if cnt is still small */
+    if ((TIMER_INTF(pulse->instance) & TIMER_INTF_UPIF) && (cnt < 0x8000U)) {
+        wraps++;
+    }
+    return ((wraps << 16) | cnt) - ((cnt - value) & 0xFFFFU);
+}
+
+/*!
+    \brief      end a pulse measurement and report the result
+    \param[in]  pulse: the measurement
+    \param[in]  width: pulse width in ticks, 0 on timeout
+    \param[out] none
+    \retval     none
+*/
+static void Timer_pulseFinish(timerPulse_t *pulse, uint32_t width)
+{
+    Timer_pulseStop(pulse);
+    pulse->width = width;
+    pulse->phase = TIMER_PULSE_DONE;
+    if (NULL != pulse->callback) {
+        pulse->callback(pulse->arg, width);
+    }
+}
+
+/*!
+    \brief      advance a pulse measurement, from the timer interrupt or Timer_pulsePoll()
+    \param[in]  arg: the timerPulse_t
+    \param[in]  source: TIMER_IRQ_SOURCE_UP or TIMER_IRQ_SOURCE_CH(x) of the channel pair
+    \param[out] none
+    \retval     none
+*/
+static void Timer_pulseEvent(void *arg, uint8_t source)
+{
+    timerPulse_t *pulse = (timerPulse_t *)arg;
+    uint32_t capture;
+
+    if (TIMER_IRQ_SOURCE_UP == source) {
+        pulse->wraps++;
+        if ((TIMER_PULSE_DONE != pulse->phase) &&
+                (Timer_pulseTime(pulse, TIMER_CNT(pulse->instance)) - pulse->start > pulse->timeout)) {
+            Timer_pulseFinish(pulse, 0U);
         }
-    } else if (timer_interrupt_flag_get(timer, TIMER_INT_FLAG_CH2) != RESET) {
-        timer_interrupt_flag_clear(timer, TIMER_INT_FLAG_CH2);
-        if (pwmHandle.interruptHandle) {
-            pwmHandle.interruptHandle(timer, TIMER_CH_2);
+    } else if (TIMER_IRQ_SOURCE_CH(pulse->lead) == source) {
+        capture = *(&TIMER_CH0CV(pulse->instance) + pulse->lead);
+        if (TIMER_PULSE_WAIT_EDGE == pulse->phase) {
+            pulse->edge = Timer_pulseTime(pulse, capture);
+            pulse->phase = TIMER_PULSE_WAIT_END;
         }
-        if (timerHandle.captureInterruptHandle[2]) {
-            timerHandle.captureInterruptHandle[2](timer, 2);
+    } else if (TIMER_IRQ_SOURCE_CH(pulse->lead + 1U) == source) {
+        capture = *(&TIMER_CH0CV(pulse->instance) + pulse->lead + 1U);
+        /* an end edge before any leading edge belongs to a pulse that was already running */
+        if (TIMER_PULSE_WAIT_END == pulse->phase) {
+            uint32_t width = Timer_pulseTime(pulse, capture) - pulse->edge;
+            Timer_pulseFinish(pulse, (width != 0U) ? width : 1U);
         }
-    } else if (timer_interrupt_flag_get(timer, TIMER_INT_FLAG_CH3) != RESET) {
-        timer_interrupt_flag_clear(timer, TIMER_INT_FLAG_CH3);
-        if (pwmHandle.interruptHandle) {
-            pwmHandle.interruptHandle(timer, TIMER_CH_3);
+    }
+}
+
+/*!
+    \brief      measure one pulse on a timer channel without busy waiting on the pin
+                The channel and its neighbour (CH0/CH1 or CH2/CH3) both capture the pin, one the
+                leading and one the trailing edge, so a pulse of any length down to one tick is
+                caught no matter how late the interrupt is served. The whole timer is used.
+    \param[in]  pulse: state of the measurement, must stay valid until it is done
+    \param[in]  instance: TIMERx
+    \param[in]  channel: TIMER_CH_x(x=0..3) the pin is routed to
+    \param[in]  level: 1 to measure a high pulse, 0 for a low pulse
+    \param[in]  timeout_us: give up when no complete pulse was seen after this long
+    \param[in]  callback: called from the timer interrupt when done, NULL to run the measurement
+                by calling Timer_pulsePoll(), which works with interrupts disabled
+    \param[in]  arg: passed through to the callback
+    \param[out] none
+    \retval     tick frequency in Hz, 0 if the timer has no channel pair for the channel
+*/
+uint32_t Timer_pulseStart(timerPulse_t *pulse, uint32_t instance, uint8_t channel,
+                          uint8_t level, uint32_t timeout_us, timerPulseCallback_t callback,
+                          void *arg)
+{
+    timer_parameter_struct timer_initpara;
+    timer_ic_parameter_struct timer_icinitpara;
+    uint8_t lead = channel & (uint8_t)~1U;
+    uint32_t clock;
+    uint32_t prescaler;
+    uint32_t tick_hz;
+    uint32_t flags;
+
+    if ((channel > 3U) || !Timer_pulseHasPair(instance, lead)) {
+        return 0;
+    }
+    Timer_wake(instance);
+    timer_clock_enable(instance);
+    clock = getTimerClkFrequency(instance);
+    /* keep a measurement below 2^31 ticks so the extended count never wraps */
+    prescaler = (uint32_t)(((uint64_t)timeout_us * clock / 1000000U) >> 31);
+    if (prescaler > 0xFFFFU) {
+        prescaler = 0xFFFFU;
+    }
+    tick_hz = clock / (prescaler + 1U);
+
+    timer_deinit(instance);
+    timer_struct_para_init(&timer_initpara);
+    timer_initpara.prescaler = prescaler;
+    timer_initpara.alignedmode = TIMER_COUNTER_EDGE;
+    timer_initpara.counterdirection = TIMER_COUNTER_UP;
+    timer_initpara.period = 0xFFFFU;
+    timer_initpara.clockdivision = TIMER_CKDIV_DIV1;
+    timer_init(instance, &timer_initpara);
+
+    timer_icinitpara.icprescaler = TIMER_IC_PSC_DIV1;
+    timer_icinitpara.icfilter = 0x0;
+    timer_icinitpara.icselection = (channel == lead) ? TIMER_IC_SELECTION_DIRECTTI :
+                                   TIMER_IC_SELECTION_INDIRECTTI;
+    timer_icinitpara.icpolarity = level ? TIMER_IC_POLARITY_RISING : TIMER_IC_POLARITY_FALLING;
+    timer_input_capture_config(instance, lead, &timer_icinitpara);
+    timer_icinitpara.icselection = (channel == lead) ? TIMER_IC_SELECTION_INDIRECTTI :
+                                   TIMER_IC_SELECTION_DIRECTTI;
+    timer_icinitpara.icpolarity = level ? TIMER_IC_POLARITY_FALLING : TIMER_IC_POLARITY_RISING;
+    timer_input_capture_config(instance, lead + 1U, &timer_icinitpara);
+
+    pulse->instance = instance;
+    pulse->lead = lead;
+    pulse->wraps = 0U;
+    pulse->start = 0U;
+    pulse->edge = 0U;
+    pulse->timeout = (uint32_t)((uint64_t)timeout_us * tick_hz / 1000000U);
+    pulse->width = 0U;
+    pulse->callback = callback;
+    pulse->arg = arg;
+    pulse->phase = TIMER_PULSE_WAIT_EDGE;
+
+    flags = TIMER_INTF_UPIF | (TIMER_INTF_CH0IF << lead) | (TIMER_INTF_CH0IF << (lead + 1U));
+    TIMER_INTF(instance) = ~flags;
+    if (NULL != callback) {
+        Timer_attachIrqCallback(instance, TIMER_IRQ_SOURCE_UP, Timer_pulseEvent, pulse);
+        Timer_attachIrqCallback(instance, TIMER_IRQ_SOURCE_CH(lead), Timer_pulseEvent, pulse);
+        Timer_attachIrqCallback(instance, TIMER_IRQ_SOURCE_CH(lead + 1U), Timer_pulseEvent, pulse);
+        irq_priority_enable(getTimerUpIrq(instance), IRQ_PRIO_TIMER);
+        irq_priority_enable(getTimerCCIrq(instance), IRQ_PRIO_TIMER);
+        timer_interrupt_enable(instance, TIMER_INT_UP | (TIMER_INT_CH0 << lead) |
+                               (TIMER_INT_CH0 << (lead + 1U)));
+    }
+    timer_enable(instance);
+    return tick_hz;
+}
+
+/*!
+    \brief      run a measurement started without callback, call until it returns 1
+    \param[in]  pulse: the measurement
+    \param[out] none
+    \retval     1 once the measurement is done (or was never started), 0 while it runs
+*/
+uint8_t Timer_pulsePoll(timerPulse_t *pulse)
+{
+    uint32_t pending;
+    uint8_t source;
+
+    if ((TIMER_PULSE_WAIT_EDGE != pulse->phase) && (TIMER_PULSE_WAIT_END != pulse->phase)) {
+        return 1;
+    }
+    if (NULL == pulse->callback) {
+        pending = TIMER_INTF(pulse->instance) & (TIMER_INTF_UPIF |
+                                                 (TIMER_INTF_CH0IF << pulse->lead) |
+                                                 (TIMER_INTF_CH0IF << (pulse->lead + 1U)));
+        TIMER_INTF(pulse->instance) = ~pending;
+        /* same order as the interrupt handler, overflows first */
+        for (source = 0U; (0U != pending) && (TIMER_PULSE_DONE != pulse->phase); source++, pending >>= 1) {
+            if (pending & 1U) {
+                Timer_pulseEvent(pulse, source);
+            }
         }
-        if (timerHandle.captureInterruptHandle[3]) {
-            timerHandle.captureInterruptHandle[3](timer, 3);
+    }
+    return (TIMER_PULSE_DONE == pulse->phase) ? 1 : 0;
+}
+
+/*!
+    \brief      stop a pulse measurement, the callback is not called
+    \param[in]  pulse: the measurement
+    \param[out] none
+    \retval     none
+*/
+void Timer_pulseStop(timerPulse_t *pulse)
+{
+    uint32_t instance = pulse->instance;
+    uint8_t lead = pulse->lead;
+
+    if (TIMER_PULSE_IDLE == pulse->phase) {
+        return;
+    }
+    Timer_wake(instance);
+    timer_disable(instance);
+    timer_interrupt_disable(instance, TIMER_INT_UP | (TIMER_INT_CH0 << lead) |
+                            (TIMER_INT_CH0 << (lead + 1U)));
+    if (NULL != pulse->callback) {
+        Timer_detachIrqCallback(instance, TIMER_IRQ_SOURCE_UP);
+        Timer_detachIrqCallback(instance, TIMER_IRQ_SOURCE_CH(lead));
+        Timer_detachIrqCallback(instance, TIMER_IRQ_SOURCE_CH(lead + 1U));
+    }
+    if (TIMER_PULSE_DONE != pulse->phase) {
+        pulse->phase = TIMER_PULSE_IDLE;
+    }
+}
+
+/*!
+    \brief      measure period and high time of a signal continuously in hardware (PWM input mode)
+                The pin's channel captures the rising edges, which also restart the counter, and
+                its neighbour the falling edges, so CHxCV holds the period and the other channel
+                the high time, both in ticks, without any interrupt. The whole timer is used.
+    \param[in]  instance: TIMERx
+    \param[in]  channel: TIMER_CH_0 or TIMER_CH_1, the one the pin is routed to
+    \param[in]  max_period_us: longest period to measure; the counter overflows when no rising
+                edge came for longer, which sets TIMER_INTF_UPIF
+    \param[out] none
+    \retval     tick frequency in Hz, 0 if the timer has no slave mode controller for the channel
+*/
+uint32_t Timer_pwmInputConfig(uint32_t instance, uint8_t channel, uint32_t max_period_us)
+{
+    timer_parameter_struct timer_initpara;
+    timer_ic_parameter_struct timer_icinitpara;
+    uint64_t max_ticks;
+    uint32_t prescaler;
+
+    if ((channel > TIMER_CH_1) || !Timer_pulseHasPair(instance, 0U)) {
+        return 0;
+    }
+    Timer_wake(instance);
+    timer_clock_enable(instance);
+    max_ticks = (uint64_t)max_period_us * getTimerClkFrequency(instance) / 1000000U;
+    prescaler = (uint32_t)(max_ticks / ((uint64_t)Timer_maxCount(instance) + 1U));
+    if (prescaler > 0xFFFFU) {
+        prescaler = 0xFFFFU;
+    }
+
+    timer_deinit(instance);
+    timer_struct_para_init(&timer_initpara);
+    timer_initpara.prescaler = prescaler;
+    timer_initpara.alignedmode = TIMER_COUNTER_EDGE;
+    timer_initpara.counterdirection = TIMER_COUNTER_UP;
+    timer_initpara.period = Timer_maxCount(instance);
+    timer_initpara.clockdivision = TIMER_CKDIV_DIV1;
+    timer_init(instance, &timer_initpara);
+
+    timer_icinitpara.icpolarity = TIMER_IC_POLARITY_RISING;
+    timer_icinitpara.icselection = TIMER_IC_SELECTION_DIRECTTI;
+    timer_icinitpara.icprescaler = TIMER_IC_PSC_DIV1;
+    timer_icinitpara.icfilter = 0x0;
+    /* configures the neighbour for the opposite edge of the same input */
+    timer_input_pwm_capture_config(instance, channel, &timer_icinitpara);
+    timer_input_trigger_source_select(instance, (TIMER_CH_0 == channel) ? TIMER_SMCFG_TRGSEL_CI0FE0 :
+                                      TIMER_SMCFG_TRGSEL_CI1FE1);
+    timer_slave_mode_select(instance, TIMER_SLAVE_MODE_RESTART);
+    /* only an overflow raises UPIF, not the restart on every edge */
+    timer_update_source_config(instance, TIMER_UPDATE_SRC_REGULAR);
+
+    /* overflow at once, the first capture measures from here and is no period */
+    timer_counter_value_config(instance, Timer_maxCount(instance));
+    TIMER_INTF(instance) = 0U;
+    timer_enable(instance);
+    return getTimerClkFrequency(instance) / (prescaler + 1U);
+}
+
+/*!
+    \brief      timer interrupt handler, services every pending source in one pass
+    \param[in]  timer: TIMERx(x=0..16)
+    \param[in]  index: timer index of TIMERx, see getTimerIndex()
+    \param[out] none
+    \retval     none
+*/
+GD_FASTCODE static void timerinterrupthandle(uint32_t timer, uint32_t index)
+{
+    uint32_t pending = TIMER_INTF(timer) & TIMER_DMAINTEN(timer) & TIMER_IRQ_SOURCE_MASK;
+    timerIrqInfor_t *infor = timerIrqInfor[index];
+    uint8_t source;
+
+    if (0U == pending) {
+        return;
+    }
+    /* the flags are cleared by writing 0, writing 1 leaves flags raised meanwhile untouched */
+    TIMER_INTF(timer) = ~pending;
+    for (source = 0U; 0U != pending; source++, pending >>= 1) {
+        if ((pending & 1U) && (NULL != infor[source].callback)) {
+            infor[source].callback(infor[source].arg, source);
         }
     }
 }
 
 #if defined(TIMER0)
-void TIMER0_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER0_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER0);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER0, 0);
 #if defined(TIMER9)
-    timerinterrupthandle(TIMER9);
+    timerinterrupthandle(TIMER9, 9);
 #endif
 }
 
-void TIMER0_Channel_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER0_Channel_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER0);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER0, 0);
 }
 
 /* some devices have this. */
-void TIMER0_BRK_UP_TRG_COM_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER0_BRK_UP_TRG_COM_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER0);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER0, 0);
 }
 
-void TIMER0_UP_TIMER9_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER0_UP_TIMER9_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER0);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER0, 0);
 #if defined(TIMER9)
-    timerinterrupthandle(TIMER9);
+    timerinterrupthandle(TIMER9, 9);
 #endif
 }
 
-void TIMER0_UP_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER0_UP_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER0);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER0, 0);
 }
 
 #endif /* TIMER0/TIMER9 handler */
 
 #if defined(TIMER1)
-void TIMER1_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER1_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER1);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER1, 1);
 }
 #endif /* TIMER1 handler */
 
 #if defined(TIMER2)
-void TIMER2_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER2_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER2);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER2, 2);
 }
 #endif /* TIMER2 handler */
 
 #if defined(TIMER3)
-void TIMER3_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER3_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER3);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER3, 3);
 }
 #endif /* TIMER3 handler */
 
 #if defined(TIMER4)
-void TIMER4_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER4_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER4);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER4, 4);
 }
 #endif /* TIMER4 handler */
 
-#if defined(TIMER5) && !defined(NO_TIMER_5)
-void TIMER5_IRQHandler(void)
+#if defined(TIMER5)
+__attribute__((used)) GD_FASTCODE void TIMER5_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER5);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER5, 5);
 }
 
 /* interrupt handler name for multiple F1x0, E50, F3x0, F4xx,.. chips */
-void TIMER5_DAC_IRQHandler(void) {
-    timerinterrupthandle(TIMER5);
+__attribute__((used)) GD_FASTCODE void TIMER5_DAC_IRQHandler(void) {
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER5, 5);
 }
 #endif /* TMER5 handler */
 
 #if defined(TIMER6)
-void TIMER6_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER6_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER6);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER6, 6);
 }
 #endif /* TIMER6 handler */
 
 #if defined(TIMER7)
-void TIMER7_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER7_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER7);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER7, 7);
 #if defined(TIMER12)
-    timerinterrupthandle(TIMER12);
+    timerinterrupthandle(TIMER12, 12);
 #endif
 }
 
-void TIMER7_Channel_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER7_Channel_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER7);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER7, 7);
 }
 #endif /* TIMER7/TIMER12 handler */
 
 #if defined(TIMER8)
-void TIMER8_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER8_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER8);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER8, 8);
 }
 #endif /* TIMER8 handler */
 
 #if defined(TIMER9) && !defined (TIMER0)
-void TIMER9_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER9_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER9);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER9, 9);
 }
 #endif /* TIMER9 handler */
 
 #if defined(TIMER10)
-void TIMER10_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER10_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER10);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER10, 10);
 }
 #endif /* TIMER10 handler */
 
 #if defined(TIMER11)
-void TIMER11_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER11_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER11);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER11, 11);
 }
 #endif /* TIMER11 handler */
 
 #if defined(TIMER12) && !defined (TIMER7)
-void TIMER12_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER12_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER12);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER12, 12);
 }
 #endif /* TIMER12 handler */
 
 #if defined(TIMER13)
-void TIMER13_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER13_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER13);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER13, 13);
 }
 #endif /* TIMER13 handler */
 
 #if defined(TIMER14)
-void TIMER14_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER14_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER14);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER14, 14);
 }
 #endif
 
 #if defined(TIMER15)
-void TIMER15_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER15_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER15);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER15, 15);
 }
 #endif
 
 #if defined(TIMER16)
-void TIMER16_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void TIMER16_IRQHandler(void)
 {
-    timerinterrupthandle(TIMER16);
+    IRQ_PROFILE();
+    timerinterrupthandle(TIMER16, 16);
 }
 #endif
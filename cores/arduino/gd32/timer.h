@@ -31,6 +31,7 @@ OF SUCH DAMAGE.
 #include "gd32xxyy.h"
 #include "PinNames.h"
 #include "PeripheralPins.h"
+#include "dma.h"
 
 /* ############# Timer interrupt definition ############# */
 #if defined(TIMER0) && !defined(TIMER0_IRQn)
@@ -57,51 +58,63 @@ OF SUCH DAMAGE.
 #endif
 #endif
 
-#if defined(GD32F30X_CL) || defined(GD32F30X_XD)
+/* the larger GD32F30x and GD32E50x parts share vectors between TIMER0/7 and TIMER8..13 */
+#if defined(GD32F30X_CL) || defined(GD32F30X_XD) || defined(GD32E50X_XD) || \
+    defined(GD32E50X_CL) || defined(GD32E508)
 #if defined(TIMER8) && !defined(TIMER8_IRQn)
-#if defined(GD32F30x)
+#if defined(GD32F30x) || defined(GD32E50X)
 #define TIMER8_IRQn TIMER0_BRK_TIMER8_IRQn
 #define TIMER8_IRQHandler TIMER0_BRK_TIMER8_IRQHandler
 #endif
 #endif
 
 #if defined(TIMER9) && !defined(TIMER9_IRQn)
-#if defined(GD32F30x)
+#if defined(GD32F30x) || defined(GD32E50X)
 #define TIMER9_IRQn TIMER0_UP_TIMER9_IRQn
 #define TIMER9_IRQHandler TIMER0_UP_TIMER9_IRQHandler
 #endif
 #endif
 
 #if defined(TIMER10) && !defined(TIMER10_IRQn)
-#if defined(GD32F30x)
+#if defined(GD32F30x) || defined(GD32E50X)
 #define TIMER10_IRQn TIMER0_TRG_CMT_TIMER10_IRQn
 #define TIMER10_IRQHandler TIMER0_TRG_CMT_TIMER10_IRQHandler
 #endif
 #endif
 
 #if defined(TIMER11) && !defined(TIMER11_IRQn)
-#if defined(GD32F30x)
+#if defined(GD32F30x) || defined(GD32E50X)
 #define TIMER11_IRQn TIMER7_BRK_TIMER11_IRQn
 #define TIMER11_IRQHandler TIMER7_BRK_TIMER11_IRQHandler
 #endif
 #endif
 
 #if defined(TIMER12) && !defined(TIMER12_IRQn)
-#if defined(GD32F30x)
+#if defined(GD32F30x) || defined(GD32E50X)
 #define TIMER12_IRQn TIMER7_UP_TIMER12_IRQn
 #define TIMER12_IRQHandler TIMER7_UP_TIMER12_IRQHandler
 #endif
 #endif
 
 #if defined(TIMER13) && !defined(TIMER13_IRQn)
-#if defined(GD32F30x)
+#if defined(GD32F30x) || defined(GD32E50X)
 #define TIMER13_IRQn TIMER7_TRG_CMT_TIMER13_IRQn
 #define TIMER13_IRQHandler TIMER7_TRG_CMT_TIMER13_IRQHandler
 #endif
 #endif
 #endif
 
-typedef void(*callBack_t)(uint32_t instance, uint8_t channel);
+/* TIMER1 counts in 32 bits on these series, every other timer in 16 */
+#if defined(GD32F1x0) || defined(GD32F3x0) || defined(GD32E50X)
+#define TIMER_HAS_32BIT_TIMER1
+#endif
+
+/* interrupt sources of a timer, numbered like their flag bits in TIMER_INTF */
+#define TIMER_IRQ_SOURCE_UP         0U
+#define TIMER_IRQ_SOURCE_CH(n)      (1U + (n))
+#define TIMER_IRQ_SOURCE_NUM        5U
+
+typedef void (*timerIrqCallback_t)(void *arg, uint8_t source);
 
 enum captureMode {
     RISING_EDGE,
@@ -109,6 +122,44 @@ enum captureMode {
     BOTH_EDGE
 };
 
+enum encoderMode {
+    ENCODER_X2_A,           /* count both edges of input A, direction from input B */
+    ENCODER_X2_B,           /* count both edges of input B, direction from input A */
+    ENCODER_X4              /* count both edges of both inputs */
+};
+
+/* event driven onto TRGO, the internal trigger output seen by other timers */
+enum timerTriggerOutput {
+    TRGO_RESET,             /* UPG bit / slave reset */
+    TRGO_ENABLE,            /* counter enable, starts slaves in TRIGGER mode together with the master */
+    TRGO_UPDATE,            /* update event, clocks a slave in EXTERNAL_CLOCK mode to chain counters */
+    TRGO_CH0,               /* channel 0 capture or compare match */
+    TRGO_O0CPRE,            /* channel 0..3 output references, e.g. to gate a slave */
+    TRGO_O1CPRE,
+    TRGO_O2CPRE,
+    TRGO_O3CPRE
+};
+
+/* what a slave timer does with its trigger input */
+enum timerSlaveMode {
+    SLAVE_DISABLE,          /* count on the internal clock */
+    SLAVE_RESET,            /* reset the counter on each trigger */
+    SLAVE_GATED,            /* count while the trigger is high */
+    SLAVE_TRIGGER,          /* start the counter on the trigger */
+    SLAVE_EXTERNAL_CLOCK    /* count trigger edges */
+};
+
+/* what starts a pulse of Timer_onePulseConfig() */
+enum timerPulseTrigger {
+    PULSE_TRIGGER_SOFTWARE, /* Timer_firePulse() only */
+    PULSE_TRIGGER_CH0,      /* an edge on the channel 0 input */
+    PULSE_TRIGGER_CH1,      /* an edge on the channel 1 input */
+    PULSE_TRIGGER_ITI0,     /* TRGO of another timer, see the trigger connection table of the user manual */
+    PULSE_TRIGGER_ITI1,
+    PULSE_TRIGGER_ITI2,
+    PULSE_TRIGGER_ITI3
+};
+
 enum timeFormat {
     FORMAT_TICK,
     FORMAT_US,
@@ -143,8 +194,6 @@ typedef struct timerhandle {
     void (*enableCaptureIT)(uint32_t instance, uint8_t channel);
     void (*disableUpdateIT)(uint32_t instance);
     void (*disableCaptureIT)(uint32_t instance, uint8_t channel);
-    void (*interruptHandle)(uint32_t instance);
-    callBack_t captureInterruptHandle[4];
 } timerhandle_t;
 
 typedef struct pwmhandle {
@@ -155,9 +204,30 @@ typedef struct pwmhandle {
     void (*writeCycleValue)(pwmDevice_t *pwmDevice, pwmPeriodCycle_t *pwmPeriodCycle);
     void (*enablePWMIT)(pwmDevice_t *pwmDevice);
     void (*disablePWMIT)(pwmDevice_t *pwmDevice);
-    void (*interruptHandle)(uint32_t instance, uint8_t channel);
 } pwmhandle_t;
 
+/* width in timer ticks, 0 if no complete pulse was seen before the timeout */
+typedef void (*timerPulseCallback_t)(void *arg, uint32_t ticks);
+
+/* state of a pulse measurement on a channel pair, see Timer_pulseStart() */
+typedef struct {
+    uint32_t instance;
+    uint8_t lead;                   /* lower channel of the pair, captures the start edge */
+    volatile uint8_t phase;
+    volatile uint32_t wraps;        /* counter overflows since the start */
+    uint32_t start;                 /* extended tick count of the start of the measurement */
+    uint32_t edge;                  /* extended tick count of the leading edge */
+    uint32_t timeout;               /* ticks */
+    volatile uint32_t width;        /* ticks */
+    timerPulseCallback_t callback;
+    void *arg;
+} timerPulse_t;
+
+#define TIMER_PULSE_IDLE            0U
+#define TIMER_PULSE_WAIT_EDGE       1U
+#define TIMER_PULSE_WAIT_END        2U
+#define TIMER_PULSE_DONE            3U
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -178,6 +248,7 @@ void Timer_init(uint32_t instance,
                 timerPeriod_t *imerPeriod);                        //initialize timer
 void Timer_start(uint32_t instance);                                                  //start timer
 void Timer_stop(uint32_t instance);                                                   //stop timer
+void Timer_wake(uint32_t instance);                                                   //ungate a timer PWM_stop() gated
 void Timer_setPeriodTime(uint32_t instance,
                          timerPeriod_t *timerPeriod);              //set timer period
 void Timer_rfresh(uint32_t
@@ -186,14 +257,10 @@ void Timer_enableUpdateIT(uint32_t
                           instance);                                         //enable timer update interrupt
 void Timer_disableUpdateIT(uint32_t
                            instance);                                        //disable timer update interrupt
-void Timer_updateHandle(uint32_t
-                        instance);                                           //timer update interrupt handler
 void Timer_enableCaptureIT(uint32_t instance,
                            uint8_t channel);                       //enable timer channel capture interrupt
 void Timer_disableCaptureIT(uint32_t instance,
                             uint8_t channel);                      //disable timer channel capture interrupt
-void Timer_captureHandle(uint32_t timer,
-                         uint8_t channel);                            //timer capture interrupt handler
 
 void PWM_init(pwmDevice_t *pwmDevice,
               pwmPeriodCycle_t *pwmPeriodCycle);              //initialize pwm
@@ -209,11 +276,64 @@ void PWM_enablePWMIT(pwmDevice_t
                      *pwmDevice);                                         //enable pwm interrupt
 void PWM_disablePWMIT(pwmDevice_t
                       *pwmDevice);                                        //disable pwm interrupt
-void PWM_irqHandle(uint32_t instance,
-                   uint8_t channel);                               //pwm capture/compare interrupt handler
+uint32_t PWM_setFrequency(pwmDevice_t *pwmDevice, uint32_t freq_hz);          //set frequency, max resolution
+uint32_t PWM_getPeriodTicks(pwmDevice_t *pwmDevice);                          //get period in timer ticks
+uint32_t PWM_groupInit(uint32_t timer, uint8_t channels, uint32_t freq_hz,
+                       uint8_t center_aligned);                                //init synchronized channels
+void PWM_groupWrite(uint32_t timer, uint8_t channels,
+                    const uint16_t *values);                                   //commit all compares at once
+uint8_t PWM_enableComplementary(pwmDevice_t *pwmDevice, PinName pin);        //enable CHx_ON output
+void PWM_disableComplementary(pwmDevice_t *pwmDevice);                        //disable CHx_ON output
+uint32_t PWM_setDeadTime(pwmDevice_t *pwmDevice, uint32_t dead_time_ns);      //set dead time in ns
+uint8_t PWM_enableBreak(pwmDevice_t *pwmDevice, PinName pin,
+                        uint8_t active_high);                                 //enable break input
+void PWM_disableBreak(pwmDevice_t *pwmDevice);                                //disable break input
+uint8_t PWM_clearBreak(pwmDevice_t *pwmDevice);                               //re-arm outputs after break
+void Timer_setMasterMode(uint32_t instance, enum timerTriggerOutput trgo,
+                         uint8_t sync);                                        //select TRGO source
+uint8_t Timer_setSlaveMode(uint32_t instance, enum timerSlaveMode mode,
+                           uint32_t master);                                   //slave to another timer
+void Timer_setSlaveModeITI(uint32_t instance, enum timerSlaveMode mode,
+                           uint8_t iti);                                       //slave to internal trigger ITIx
+uint32_t Timer_getInternalTrigger(uint32_t instance, uint32_t master);        //ITIx of master, 0xFF if none
+void Timer_onePulseConfig(uint32_t instance, uint8_t channel, uint32_t delay, uint32_t width,
+                          uint16_t prescaler, uint8_t active_high);            //one pulse per trigger on a channel
+uint8_t Timer_onePulseTrigger(uint32_t instance, enum timerPulseTrigger trigger, uint8_t falling,
+                              uint8_t retriggerable);                          //select what starts the pulse
+void Timer_firePulse(uint32_t instance);                                      //start a pulse from software
+void Timer_setCompareTrigger(uint32_t instance, uint8_t channel);             //compare event once per period
+uint8_t Timer_captureDmaStart(uint32_t instance, uint8_t channel, uint16_t *buffer, size_t length,
+                              dma_callback_t callback, void *arg);             //capture into ring buffer by DMA
+void Timer_captureDmaStop(uint32_t instance, uint8_t channel);                //stop capture DMA
+uint32_t Timer_captureDmaRemaining(uint32_t instance, uint8_t channel);       //transfers left until wrap
+uint8_t Timer_updateDmaStart(uint32_t instance, uint32_t periph_addr, const uint32_t *buffer,
+                             size_t length, uint8_t loop, dma_callback_t callback,
+                             void *arg);                                      //write a word per update by DMA
+uint8_t Timer_updateDmaSample(uint32_t instance, uint32_t periph_addr, void *buffer, size_t length,
+                              uint8_t width, dma_callback_t callback, void *arg);  //read a register per update by DMA
+uint8_t Timer_compareDmaSample(uint32_t instance, uint8_t channel, uint32_t compare, uint32_t periph_addr,
+                               void *buffer, size_t length, uint8_t width, dma_callback_t callback,
+                               void *arg);                                    //read a register per compare by DMA
+void Timer_updateDmaStop(uint32_t instance);                                  //stop update DMA
+uint32_t Timer_updateDmaRemaining(uint32_t instance);                          //transfers left until wrap
+uint32_t Timer_pulseStart(timerPulse_t *pulse, uint32_t instance, uint8_t channel,
+                          uint8_t level, uint32_t timeout_us, timerPulseCallback_t callback,
+                          void *arg);                                         //measure one pulse, ticks/s
+uint8_t Timer_pulsePoll(timerPulse_t *pulse);                                //run a polled measurement
+void Timer_pulseStop(timerPulse_t *pulse);                                   //abort a measurement
+uint32_t Timer_pwmInputConfig(uint32_t instance, uint8_t channel,
+                              uint32_t max_period_us);                         //measure period and duty, ticks/s
+void Timer_attachIrqCallback(uint32_t instance, uint8_t source, timerIrqCallback_t callback,
+                             void *arg);                                       //route one interrupt source
+void Timer_detachIrqCallback(uint32_t instance, uint8_t source);             //remove interrupt source callback
+uint8_t PWM_playBuffer(pwmDevice_t *pwmDevice, const uint16_t *buffer, size_t length,
+                       uint8_t loop);                                  //stream compare values by DMA
+void PWM_stopBuffer(pwmDevice_t *pwmDevice);                                 //stop streaming compare values
+uint8_t PWM_bufferBusy(pwmDevice_t *pwmDevice);                              //check if a stream is running
 
 uint32_t  getTimerClkFrequency(uint32_t
                                instance);                                    //get timer clock frequency
+uint32_t Timer_maxCount(uint32_t instance);                                   //largest counter value, 0xFFFF or 0xFFFFFFFF
 IRQn_Type getTimerUpIrq(uint32_t
                         tim);                                                //get timer update IRQn
 IRQn_Type getTimerCCIrq(uint32_t
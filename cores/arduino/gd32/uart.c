@@ -29,15 +29,32 @@ OF SUCH DAMAGE.
 
 #include "uart.h"
 #include "Arduino.h"
+#include "irq_profile.h"
+#include "irq_priority.h"
+
+/* the minimal core profile leaves the ports interrupt driven and the DMA code out */
+#if defined(GD32_CORE_MINIMAL)
+#define UART_DMA    0
+#else
+#define UART_DMA    1
+#endif
 
 #if defined(USART_DATA)
 #define GD32_USART_TX_DATA USART_DATA
 #define GD32_USART_RX_DATA USART_DATA
 #define GD32_USART_STAT    USART_STAT0
+#define GD32_USART_STAT_PERR  USART_STAT0_PERR
+#define GD32_USART_STAT_FERR  USART_STAT0_FERR
+#define GD32_USART_STAT_NERR  USART_STAT0_NERR
+#define GD32_USART_STAT_ORERR USART_STAT0_ORERR
 #elif defined(USART_RDATA) && defined(USART_TDATA)
 #define GD32_USART_TX_DATA USART_TDATA
 #define GD32_USART_RX_DATA USART_RDATA
 #define GD32_USART_STAT    USART_STAT
+#define GD32_USART_STAT_PERR  USART_STAT_PERR
+#define GD32_USART_STAT_FERR  USART_STAT_FERR
+#define GD32_USART_STAT_NERR  USART_STAT_NERR
+#define GD32_USART_STAT_ORERR USART_STAT_ORERR
 #else
 #error "We don't understand this USART peripheral."
 #endif
@@ -74,6 +91,56 @@ static IRQn_Type usart_irq_n[UART_NUM]      = {
 #endif
 };
 
+#if UART_DMA
+/* DMA request routing of the USART transmitters, periph 0 means no DMA request line */
+static const dma_channel_t usart_tx_dma[UART_NUM] = {
+#if defined(GD32F30x) || defined(GD32F10x) || defined(GD32E50X)
+    {DMA0, DMA_CH3},
+    {DMA0, DMA_CH6},
+#if defined(USART2)
+    {DMA0, DMA_CH1},
+#endif
+#if defined(UART3) || defined(USART3)
+    {DMA1, DMA_CH4},
+#endif
+#if defined(UART4) || defined(USART4)
+    {0U, DMA_CH0},
+#endif
+#else
+    {DMA, DMA_CH1},
+#if defined(USART1)
+    {DMA, DMA_CH3},
+#endif
+#endif
+};
+
+/* DMA request routing of the USART receivers, periph 0 means no DMA request line */
+static const dma_channel_t usart_rx_dma[UART_NUM] = {
+#if defined(GD32F30x) || defined(GD32F10x) || defined(GD32E50X)
+    {DMA0, DMA_CH4},
+    {DMA0, DMA_CH5},
+#if defined(USART2)
+    {DMA0, DMA_CH2},
+#endif
+#if defined(UART3) || defined(USART3)
+    {DMA1, DMA_CH2},
+#endif
+#if defined(UART4) || defined(USART4)
+    {0U, DMA_CH0},
+#endif
+#else
+    {DMA, DMA_CH2},
+#if defined(USART1)
+    {DMA, DMA_CH4},
+#endif
+#endif
+};
+#endif /* UART_DMA */
+
+/* the NVIC level to use for a port, no more urgent than serial_set_irq_priority() allows */
+#define usart_irq_level(p_obj, level) \
+    ((level) > (p_obj)->irq_level ? (level) : (p_obj)->irq_level)
+
 #define GET_SERIAL_S(obj) (obj)
 
 /** Initialize the USART peripheral.
@@ -96,6 +163,20 @@ static void usart_init(struct serial_s *obj_s)
     usart_transmit_config(obj_s->uart, USART_TRANSMIT_DISABLE);
 }
 
+/** Mute the receiver until the next address character for this node
+ *
+ * @param obj_s The serial object
+ */
+static void usart_mute_enter(struct serial_s *obj_s)
+{
+#if defined(USART_CMD_MMCMD)
+    usart_command_enable(obj_s->uart, USART_CMD_MMCMD);
+#else
+    /* sets RWU, the receiver is muted at once */
+    usart_mute_mode_enable(obj_s->uart);
+#endif
+}
+
 /**
  * Enable the serial after it's been initialized / serial formatted with the correct baud etc.
  * Otherwise, after serial init, the UART is formatted at 9600 baud is turned on immediatelly..
@@ -104,8 +185,28 @@ void serial_enable(struct serial_s *obj_s) {
     usart_enable(obj_s->uart);
     usart_receive_config(obj_s->uart, USART_RECEIVE_ENABLE);
     usart_transmit_config(obj_s->uart, USART_TRANSMIT_ENABLE);
+    if (obj_s->mp_address >= 0) {
+        usart_mute_enter(obj_s);
+    }
+}
+
+/** Recompute the baud rate of every open port after the APB clocks changed.
+ *
+ * @param arg Unused
+ */
+static void serial_clock_changed(void *arg)
+{
+    (void)arg;
+    for (uint8_t i = 0U; i < UART_NUM; i++) {
+        struct serial_s *obj_s = obj_s_buf[i];
+        if ((obj_s != NULL) && (obj_s->tx_state != OP_STATE_RESET)) {
+            serial_baud(obj_s, obj_s->baudrate);
+        }
+    }
 }
 
+static clock_listener_t serial_clock_listener = { serial_clock_changed, NULL, NULL };
+
 /** Initialize the serial peripheral. It sets the default parameters for serial
  *  peripheral, and configures its specifieds pins.
  *
@@ -170,12 +271,24 @@ void serial_init(serial_t *obj, PinName tx, PinName rx)
 
     p_obj->pin_tx = tx;
     p_obj->pin_rx = rx;
+    /* usart_init() leaves flow control, the driver enable and multiprocessor mode off */
+    p_obj->pin_rts = NC;
+    p_obj->pin_cts = NC;
+    p_obj->pin_de  = NC;
+    p_obj->de_hw   = 0U;
+    p_obj->mp_address = -1;
+    p_obj->char_match = 0U;
 
     p_obj->tx_state = OP_STATE_BUSY;
     p_obj->rx_state = OP_STATE_BUSY;
 
+    /* usart_init() resets the DMA request enables, start out interrupt driven */
+    p_obj->tx_dma = NULL;
+    p_obj->rx_dma = NULL;
+
     usart_init(p_obj);
     obj_s_buf[p_obj->index] = p_obj;
+    clock_listener_add(&serial_clock_listener);
 
     p_obj->tx_state = OP_STATE_READY;
     p_obj->rx_state = OP_STATE_READY;
@@ -191,6 +304,10 @@ void serial_free(serial_t *obj)
     struct serial_s *p_obj     = GET_SERIAL_S(obj);
     rcu_periph_enum rcu_periph = usart_clk[p_obj->index];
 
+    /* release the DMA channels */
+    serial_tx_dma_config(obj, 0U);
+    serial_rx_dma_stop(obj);
+
     /* reset USART and disable clock */
     usart_deinit(p_obj->uart);
     rcu_periph_clock_disable(rcu_periph);
@@ -199,10 +316,35 @@ void serial_free(serial_t *obj)
 #if defined(GD32F30x) || defined(GD32F10x)|| defined(GD32E50X)
     pin_function(p_obj->pin_tx, PIN_MODE_IN_FLOATING);
     pin_function(p_obj->pin_rx, PIN_MODE_IN_FLOATING);
+    if (p_obj->pin_rts != NC) {
+        pin_function(p_obj->pin_rts, PIN_MODE_IN_FLOATING);
+    }
+    if (p_obj->pin_cts != NC) {
+        pin_function(p_obj->pin_cts, PIN_MODE_IN_FLOATING);
+    }
+    if (p_obj->pin_de != NC) {
+        pin_function(p_obj->pin_de, PIN_MODE_IN_FLOATING);
+    }
 #else
     pin_function(p_obj->pin_tx, PIN_MODE_INPUT);
     pin_function(p_obj->pin_rx, PIN_MODE_INPUT);
+    if (p_obj->pin_rts != NC) {
+        pin_function(p_obj->pin_rts, PIN_MODE_INPUT);
+    }
+    if (p_obj->pin_cts != NC) {
+        pin_function(p_obj->pin_cts, PIN_MODE_INPUT);
+    }
+    if (p_obj->pin_de != NC) {
+        pin_function(p_obj->pin_de, PIN_MODE_INPUT);
+    }
 #endif
+    p_obj->pin_rts = NC;
+    p_obj->pin_cts = NC;
+    p_obj->pin_de  = NC;
+    p_obj->de_hw   = 0U;
+
+    p_obj->tx_state = OP_STATE_RESET;
+    p_obj->rx_state = OP_STATE_RESET;
 }
 
 /** Configure the baud rate
@@ -221,7 +363,17 @@ void serial_baud(serial_t *obj, int baudrate)
     /* disable the USART first */
     usart_disable(p_obj->uart);
 
+#if defined(USART_CTL0_OVSMOD)
+    /* oversample by 16 unless the divider would drop below 16, then by 8 to reach clock / 8 */
+    usart_oversample_config(p_obj->uart, USART_OVSMOD_16);
+    usart_baudrate_set(p_obj->uart, baudrate);
+    if ((USART_BAUD(p_obj->uart) & USART_BAUD_INTDIV) == 0U) {
+        usart_oversample_config(p_obj->uart, USART_OVSMOD_8);
+        usart_baudrate_set(p_obj->uart, baudrate);
+    }
+#else
     usart_baudrate_set(p_obj->uart, baudrate);
+#endif
 
     p_obj->baudrate = baudrate;
 
@@ -231,6 +383,79 @@ void serial_baud(serial_t *obj, int baudrate)
     }
 }
 
+/** Start or stop hardware auto baud rate detection. The start bit of the next
+ *  received character is measured (so its LSB must be 1, e.g. 'a' or 0x7F) and
+ *  the baud rate register is programmed from it. Only USART0 of GD32F3x0 and
+ *  GD32E23x has the detector.
+ *
+ * @param obj    The serial object
+ * @param enable Non-zero to detect the baud rate from the next character
+ * @return 1 if detection is armed (or was stopped), 0 if the USART has no detector
+ */
+uint8_t serial_auto_baud(serial_t *obj, uint8_t enable)
+{
+#if defined(USART_CTL1_ABDEN)
+    uint16_t uen_flag = 0U;
+    struct serial_s *p_obj = GET_SERIAL_S(obj);
+
+    if (p_obj->uart != USART0) {
+        return 0U;
+    }
+
+    /* ABDEN and ABDM can only be changed while the USART is disabled */
+    uen_flag = USART_CTL0(p_obj->uart) & USART_CTL0_UEN;
+    usart_disable(p_obj->uart);
+    if (enable) {
+        /* the detected value is an oversample by 16 divider */
+        usart_oversample_config(p_obj->uart, USART_OVSMOD_16);
+        usart_autobaud_detection_mode_config(p_obj->uart, USART_ABDM_FTOR);
+        usart_autobaud_detection_enable(p_obj->uart);
+    } else {
+        usart_autobaud_detection_disable(p_obj->uart);
+    }
+    if (RESET != uen_flag) {
+        usart_enable(p_obj->uart);
+    }
+    return 1U;
+#else
+    (void)obj;
+    (void)enable;
+    return 0U;
+#endif
+}
+
+/** Get the result of auto baud rate detection. A failed measurement re-arms
+ *  the detector for the next character.
+ *
+ * @param obj The serial object
+ * @return The detected baud rate, 0 while detection has not completed
+ */
+uint32_t serial_auto_baud_result(serial_t *obj)
+{
+#if defined(USART_CTL1_ABDEN)
+    struct serial_s *p_obj = GET_SERIAL_S(obj);
+    uint32_t div;
+
+    if ((p_obj->uart != USART0) || !(USART_CTL1(p_obj->uart) & USART_CTL1_ABDEN) ||
+            (RESET == usart_flag_get(p_obj->uart, USART_FLAG_ABD))) {
+        return 0U;
+    }
+    if (RESET != usart_flag_get(p_obj->uart, USART_FLAG_ABDE)) {
+        usart_command_enable(p_obj->uart, USART_CMD_ABDCMD);
+        return 0U;
+    }
+    div = USART_BAUD(p_obj->uart) & (USART_BAUD_INTDIV | USART_BAUD_FRADIV);
+    if (div == 0U) {
+        return 0U;
+    }
+    p_obj->baudrate = rcu_clock_freq_get(CK_USART) / div;
+    return p_obj->baudrate;
+#else
+    (void)obj;
+    return 0U;
+#endif
+}
+
 /** Configure the format. Set the number of bits, parity and the number of stop bits
  *
  * @param obj       The serial object
@@ -299,6 +524,275 @@ void serial_format(serial_t *obj, int data_bits, SerialParity parity, int stop_b
     }
 }
 
+/** Configure hardware flow control. The USART deasserts RTS while its receive
+ *  buffer is full and only starts a transmission while CTS is asserted.
+ *
+ * @param obj    The serial object
+ * @param type   Which of RTS and CTS to use
+ * @param rxflow The RTS pin, must be in PinMap_UART_RTS for this USART when used
+ * @param txflow The CTS pin, must be in PinMap_UART_CTS for this USART when used
+ * @return 1 if flow control was configured, 0 if a pin does not belong to this USART
+ */
+uint8_t serial_set_flow_control(serial_t *obj, FlowControl type, PinName rxflow, PinName txflow)
+{
+    uint16_t uen_flag = 0U;
+    uint32_t ctl2 = 0U;
+    struct serial_s *p_obj = GET_SERIAL_S(obj);
+    uint8_t use_rts = (type == FlowControlRTS) || (type == FlowControlRTSCTS);
+    uint8_t use_cts = (type == FlowControlCTS) || (type == FlowControlRTSCTS);
+
+    if (use_rts && (pinmap_peripheral(rxflow, PinMap_UART_RTS) != (uint32_t)p_obj->uart)) {
+        return 0U;
+    }
+    if (use_cts && (pinmap_peripheral(txflow, PinMap_UART_CTS) != (uint32_t)p_obj->uart)) {
+        return 0U;
+    }
+
+    /* store the UEN flag, RTSEN/CTSEN can only be changed while the USART is disabled */
+    uen_flag = USART_CTL0(p_obj->uart) & USART_CTL0_UEN;
+    usart_disable(p_obj->uart);
+
+    ctl2 = USART_CTL2(p_obj->uart) & ~(USART_CTL2_RTSEN | USART_CTL2_CTSEN);
+    p_obj->pin_rts = NC;
+    p_obj->pin_cts = NC;
+    if (use_rts) {
+        pinmap_pinout(rxflow, PinMap_UART_RTS);
+        p_obj->pin_rts = rxflow;
+        ctl2 |= USART_CTL2_RTSEN;
+    }
+    if (use_cts) {
+#if defined(GD32F30x) || defined(GD32F10x)|| defined(GD32E50X)
+        /* CTS is an input, keep the remap of the pinmap entry but don't drive the pin */
+        pin_function(txflow, (int)((pinmap_function(txflow, PinMap_UART_CTS) & ~(uint32_t)PIN_MODE_MASK) |
+                                   PIN_MODE_IN_FLOATING));
+#else
+        pinmap_pinout(txflow, PinMap_UART_CTS);
+#endif
+        p_obj->pin_cts = txflow;
+        ctl2 |= USART_CTL2_CTSEN;
+    }
+    USART_CTL2(p_obj->uart) = ctl2;
+
+    /* restore the UEN flag */
+    if (RESET != uen_flag) {
+        usart_enable(p_obj->uart);
+    }
+    return 1U;
+}
+
+/** Set the software driven RS-485 DE pin active or inactive
+ *
+ * @param obj_s  The serial object
+ * @param active Non-zero to enable the transceiver driver
+ */
+static inline void usart_de_write(struct serial_s *obj_s, uint8_t active)
+{
+    if ((obj_s->pin_de == NC) || obj_s->de_hw) {
+        return;
+    }
+    gpio_bit_write(gpio_port[GD_PORT_GET(obj_s->pin_de)], gpio_pin[GD_PIN_GET(obj_s->pin_de)],
+                   ((active != 0U) == (obj_s->de_active_high != 0U)) ? SET : RESET);
+}
+
+/** Drive the DE (driver enable) pin of an RS-485 transceiver around every
+ *  transmission. Where the USART has a driver enable output (GD32F3x0,
+ *  GD32F1x0, GD32E23x) and de is the RTS pin of this USART, the hardware
+ *  drives it. Otherwise DE is set when a transfer starts and released from
+ *  the transmission complete interrupt once nothing else is queued.
+ *
+ * @param obj         The serial object
+ * @param de          The DE pin, NC to stop driving it
+ * @param active_high Non-zero if DE is active high
+ * @return 1 if the DE pin is in use, 0 otherwise
+ */
+uint8_t serial_set_rs485(serial_t *obj, PinName de, uint8_t active_high)
+{
+    struct serial_s *p_obj = GET_SERIAL_S(obj);
+
+    /* release the previous pin */
+    usart_de_write(p_obj, 0U);
+#if defined(USART_CTL2_DEM)
+    if (p_obj->de_hw) {
+        uint16_t uen_flag = USART_CTL0(p_obj->uart) & USART_CTL0_UEN;
+
+        usart_disable(p_obj->uart);
+        usart_rs485_driver_disable(p_obj->uart);
+        if (RESET != uen_flag) {
+            usart_enable(p_obj->uart);
+        }
+    }
+#endif
+    p_obj->pin_de = NC;
+    p_obj->de_hw  = 0U;
+
+    if (de == NC) {
+        return 0U;
+    }
+    p_obj->de_active_high = (active_high != 0U);
+
+#if defined(USART_CTL2_DEM)
+    if (pinmap_peripheral(de, PinMap_UART_RTS) == (uint32_t)p_obj->uart) {
+        /* DEM and DEP can only be changed while the USART is disabled */
+        uint16_t uen_flag = USART_CTL0(p_obj->uart) & USART_CTL0_UEN;
+
+        usart_disable(p_obj->uart);
+        usart_depolarity_config(p_obj->uart, active_high ? USART_DEP_HIGH : USART_DEP_LOW);
+        usart_rs485_driver_enable(p_obj->uart);
+        pinmap_pinout(de, PinMap_UART_RTS);
+        p_obj->pin_de = de;
+        p_obj->de_hw  = 1U;
+        if (RESET != uen_flag) {
+            usart_enable(p_obj->uart);
+        }
+        return 1U;
+    }
+#endif
+
+#if defined(GD32F30x) || defined(GD32F10x)|| defined(GD32E50X)
+    pin_function(de, GD_PIN_FUNCTION3(PIN_MODE_OUT_PP, PIN_OTYPE_PP, 0));
+#else
+    pin_function(de, GD_PIN_FUNCTION3(PIN_MODE_OUTPUT, PIN_OTYPE_PP, 0));
+#endif
+    p_obj->pin_de = de;
+    usart_de_write(p_obj, serial_tx_active(obj));
+
+    return 1U;
+}
+
+/** Use the USART address match detector as a character match: with the
+ *  receiver out of mute mode it flags every received character equal to ADDR.
+ *  The resulting interrupt brings a circular DMA reception up to date right
+ *  away instead of on the next IDLE or half/full transfer interrupt; it is
+ *  only enabled while DMA reception runs, the receive interrupt sees every
+ *  character anyway.
+ *  The GD32F30x/F10x/E50x USART only compares 4 bits in mute mode, so there
+ *  the caller has to rely on the receive interrupts alone.
+ *
+ * @param obj The serial object
+ * @param c   The character to match, -1 to stop
+ * @return 1 if the USART matches c in hardware, 0 otherwise
+ */
+uint8_t serial_set_char_match(serial_t *obj, int c)
+{
+#if defined(USART_CTL0_AMIE)
+    uint16_t uen_flag = 0U;
+    struct serial_s *p_obj = GET_SERIAL_S(obj);
+
+    usart_interrupt_disable(p_obj->uart, USART_INT_AM);
+    usart_interrupt_flag_clear(p_obj->uart, USART_INT_FLAG_AM);
+    p_obj->char_match = 0U;
+    /* ADDR holds the node address in multiprocessor mode */
+    if ((c < 0) || (p_obj->mp_address >= 0)) {
+        return 0U;
+    }
+
+    /* ADDR and ADDM can only be changed while the USART is disabled */
+    uen_flag = USART_CTL0(p_obj->uart) & USART_CTL0_UEN;
+    usart_disable(p_obj->uart);
+    usart_address_detection_mode_config(p_obj->uart, USART_ADDM_FULLBIT);
+    usart_address_config(p_obj->uart, (uint8_t)c);
+    if (RESET != uen_flag) {
+        usart_enable(p_obj->uart);
+    }
+    p_obj->char_match = 1U;
+    if (p_obj->rx_dma != NULL) {
+        usart_interrupt_enable(p_obj->uart, USART_INT_AM);
+    }
+
+    return 1U;
+#else
+    (void)obj;
+    (void)c;
+    return 0U;
+#endif
+}
+
+/** Filter the traffic of a multi-drop bus in hardware. Frames are 8 data
+ *  bits with a 9th bit marking address characters (the USART must be
+ *  formatted 8N1 or 8N2); the receiver is muted, so it raises no interrupt
+ *  and DMA request, until an address character of address arrives. That
+ *  character and the data after it are received, up to the next address
+ *  character for another node, which mutes the receiver again. Address
+ *  characters are received as their low 8 bits. The GD32F30x/F10x/E50x
+ *  USART compares the low 4 bits only. Hardware character matching
+ *  (serial_set_char_match()) shares the address register and is given up
+ *  on GD32F3x0/F1x0/E23x. Transmission by DMA cannot send the 9th bit as
+ *  0, it is switched off.
+ *
+ * @param obj     The serial object
+ * @param address The node address, up to SERIAL_ADDRESS_MAX, -1 to stop
+ * @return 1 on success, 0 if the address is out of range or the format is not 8 data bits without parity
+ */
+uint8_t serial_set_address(serial_t *obj, int address)
+{
+    struct serial_s *p_obj = GET_SERIAL_S(obj);
+    uint32_t uen_flag;
+
+    if (address > SERIAL_ADDRESS_MAX) {
+        return 0U;
+    }
+    if ((address >= 0) && ((p_obj->databits != USART_WL_8BIT) || (p_obj->parity != USART_PM_NONE))) {
+        return 0U;
+    }
+    if (address >= 0) {
+        serial_tx_dma_config(obj, 0U);
+    }
+
+    /* the word length, wakeup method and ADDR can only be changed while the USART is disabled */
+    uen_flag = USART_CTL0(p_obj->uart) & USART_CTL0_UEN;
+    usart_disable(p_obj->uart);
+    if (address < 0) {
+        usart_mute_mode_disable(p_obj->uart);
+        usart_mute_mode_wakeup_config(p_obj->uart, USART_WM_IDLE);
+        usart_word_length_set(p_obj->uart, p_obj->databits);
+        p_obj->mp_address = -1;
+    } else {
+#if defined(USART_CMD_MMCMD)
+        usart_interrupt_disable(p_obj->uart, USART_INT_AM);
+        p_obj->char_match = 0U;
+        usart_address_detection_mode_config(p_obj->uart, USART_ADDM_FULLBIT);
+#endif
+        /* the 9th bit is the address mark, data characters keep it 0 */
+        usart_word_length_set(p_obj->uart, USART_WL_9BIT);
+        usart_mute_mode_wakeup_config(p_obj->uart, USART_WM_ADDR);
+        usart_address_config(p_obj->uart, (uint8_t)address);
+#if defined(USART_CMD_MMCMD)
+        usart_mute_mode_enable(p_obj->uart);
+#endif
+        p_obj->mp_address = (int16_t)address;
+    }
+    if (RESET != uen_flag) {
+        usart_enable(p_obj->uart);
+        if (address >= 0) {
+            usart_mute_enter(p_obj);
+        }
+    }
+
+    return 1U;
+}
+
+/** Send an address character, the 9th bit set, once the transmitter is free.
+ *  The RS-485 driver is asserted for it; with more the transmission started
+ *  next, the data of the frame, releases it from its complete interrupt,
+ *  otherwise this waits until the character is out and releases it.
+ *
+ * @param obj     The serial object
+ * @param address The address of the node the frame is for
+ * @param more    Non-zero if data follows
+ */
+void serial_putc_address(serial_t *obj, int address, uint8_t more)
+{
+    struct serial_s *p_obj = GET_SERIAL_S(obj);
+
+    usart_de_write(p_obj, 1U);
+    while (!serial_writable(obj));
+    usart_data_transmit(p_obj->uart, (uint32_t)(0x100 | (address & 0xFF)));
+    if (more == 0U) {
+        while (RESET == usart_flag_get(p_obj->uart, USART_FLAG_TC));
+        usart_de_write(p_obj, 0U);
+    }
+}
+
 /** Get character. This is a blocking call, waiting for a character
  *
  * @param obj The serial object
@@ -430,6 +924,7 @@ static gd_status_enum usart_rx_interrupt(struct serial_s *obj_s)
     uint16_t *temp;
 
     if (obj_s->rx_state == OP_STATE_BUSY_RX) {
+        obj_s->stats.rx_bytes++;
         if (obj_s->databits == USART_WL_9BIT) {
             temp = (uint16_t *) obj_s->rx_buffer_ptr;
             if (obj_s->parity == USART_PM_NONE) {
@@ -510,8 +1005,14 @@ static void usart_tx_complete_interrupt(struct serial_s *obj_s)
 {
     usart_interrupt_disable(obj_s->uart, USART_INT_TC);
 
+    obj_s->stats.tx_bytes += obj_s->tx_size;
     obj_s->tx_state = OP_STATE_READY;
     obj_s->tx_callback(obj_s);
+
+    /* the stop bit of the last character is out, turn the bus around unless more was queued */
+    if (obj_s->tx_state == OP_STATE_READY) {
+        usart_de_write(obj_s, 0U);
+    }
 }
 
 /**
@@ -573,6 +1074,132 @@ static gd_status_enum usart_rx_interrupt_preprocess(struct serial_s *obj_s, uint
     }
 }
 
+#if UART_DMA
+/** Handle the transmit DMA channel interrupt
+ *
+ * @param arg   The serial object
+ * @param flags The DMA channel flags
+ */
+static void usart_tx_dma_irq(void *arg, uint32_t flags)
+{
+    struct serial_s *obj_s = (struct serial_s *)arg;
+
+    (void)flags;
+    dma_channel_disable(DMA_SPL_ARGS(obj_s->tx_dma));
+
+    obj_s->tx_buffer_ptr += obj_s->tx_count;
+    obj_s->tx_count = 0U;
+
+    /* the last byte is still in the shift register, finish on TC as the interrupt path does */
+    usart_interrupt_enable(obj_s->uart, USART_INT_TC);
+}
+
+/**
+ * Preprocess the USART tx DMA transfer
+ *
+ * @param obj_s The serial object
+ * @param pData Pointer to tx buffer
+ * @param Size  Size of tx buffer
+ * @return Returns the status
+ */
+static gd_status_enum usart_tx_dma_preprocess(struct serial_s *obj_s, uint8_t *pData,
+                                              uint16_t Size)
+{
+    const dma_channel_t *ch = obj_s->tx_dma;
+
+    if (obj_s->tx_state == OP_STATE_READY) {
+        if ((pData == NULL) || (Size == 0U)) {
+            return GD_ERROR;
+        }
+
+        obj_s->tx_buffer_ptr = pData;
+        obj_s->tx_count      = Size;
+        obj_s->tx_state      = OP_STATE_BUSY_TX;
+
+        /* TC is still set from the previous frame, it must only fire after this transfer */
+        usart_flag_clear(obj_s->uart, USART_FLAG_TC);
+
+        dma_channel_disable(DMA_SPL_ARGS(ch));
+        dma_memory_address_config(DMA_SPL_ARGS(ch), (uint32_t)pData);
+        dma_transfer_number_config(DMA_SPL_ARGS(ch), Size);
+        dma_channel_enable(DMA_SPL_ARGS(ch));
+
+        return GD_OK;
+    } else {
+        return GD_BUSY;
+    }
+}
+
+/** Select DMA or interrupt driven transmission. With DMA a transfer handed to
+ *  serial_transmit() costs one DMA and one USART interrupt instead of one per
+ *  character. Must be called after serial_init() and while no TX is ongoing.
+ *
+ * @param obj    The serial object
+ * @param enable Non-zero to use DMA, 0 for interrupt driven transmission
+ * @return 1 if transmission is DMA driven, 0 otherwise
+ */
+uint8_t serial_tx_dma_config(serial_t *obj, uint8_t enable)
+{
+    struct serial_s *p_obj = GET_SERIAL_S(obj);
+    const dma_channel_t *ch;
+    dma_parameter_struct dma_init_struct;
+
+    if ((p_obj->index >= UART_NUM) || serial_tx_active(obj)) {
+        return (p_obj->tx_dma != NULL) ? 1 : 0;
+    }
+    ch = &usart_tx_dma[p_obj->index];
+
+    /* 9 data bits without parity need 16-bit transfers from an 8-bit ring buffer,
+       so does the 9th bit of multiprocessor mode */
+    if ((!enable) || (ch->periph == 0U) || (p_obj->mp_address >= 0) ||
+            ((p_obj->databits == USART_WL_9BIT) && (p_obj->parity == USART_PM_NONE))) {
+        if (p_obj->tx_dma != NULL) {
+            USART_CTL2(p_obj->uart) &= ~USART_CTL2_DENT;
+            dma_channel_disable(DMA_SPL_ARGS(p_obj->tx_dma));
+            dma_channel_detach_irq(p_obj->tx_dma);
+            dma_channel_release(p_obj->tx_dma, p_obj);
+            p_obj->tx_dma = NULL;
+        }
+        return 0;
+    }
+    /* a channel shared with another peripheral leaves this port interrupt driven */
+    if ((p_obj->tx_dma != ch) && !dma_channel_claim(ch, p_obj)) {
+        return 0;
+    }
+
+    dma_channel_clock_enable(ch);
+    dma_deinit(DMA_SPL_ARGS(ch));
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.direction    = DMA_MEMORY_TO_PERIPHERAL;
+    dma_init_struct.memory_addr  = 0U;
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_8BIT;
+    dma_init_struct.number       = 0U;
+    dma_init_struct.periph_addr  = (uint32_t)&GD32_USART_TX_DATA(p_obj->uart);
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_8BIT;
+    dma_init_struct.priority     = DMA_PRIORITY_MEDIUM;
+    dma_init(DMA_SPL_ARGS(ch), &dma_init_struct);
+    dma_circulation_disable(DMA_SPL_ARGS(ch));
+    dma_memory_to_memory_disable(DMA_SPL_ARGS(ch));
+
+    dma_channel_attach_irq(ch, usart_tx_dma_irq, p_obj, usart_irq_level(p_obj, IRQ_LEVEL(IRQ_PRIO_USART_TX)));
+    dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_FTF);
+
+    USART_CTL2(p_obj->uart) |= USART_CTL2_DENT;
+    p_obj->tx_dma = ch;
+
+    return 1;
+}
+#else
+uint8_t serial_tx_dma_config(serial_t *obj, uint8_t enable)
+{
+    (void)obj;
+    (void)enable;
+    return 0;
+}
+#endif /* UART_DMA */
+
 /** Begin asynchronous TX transfer.
  *
  * @param obj       The serial object
@@ -596,6 +1223,7 @@ int serial_transmit(serial_t *obj, const void *tx, size_t tx_length)
 
     obj->tx_buffer_ptr = (void *)tx;
     obj->tx_count = tx_length;
+    obj->tx_size = tx_length;
 
     /* enable interrupt */
     /* clear pending IRQ */
@@ -603,10 +1231,19 @@ int serial_transmit(serial_t *obj, const void *tx, size_t tx_length)
     /* disable the IRQ first */
     NVIC_DisableIRQ(irq);
     /* set the priority and vector */
-    NVIC_SetPriority(irq, 1);
+    NVIC_SetPriority(irq, usart_irq_level(p_obj, IRQ_LEVEL(IRQ_PRIO_USART_TX)));
+    critical_irq_clamp(irq);
     /* enable IRQ */
     NVIC_EnableIRQ(irq);
 
+    usart_de_write(p_obj, 1U);
+#if UART_DMA
+    if (p_obj->tx_dma != NULL) {
+        if (usart_tx_dma_preprocess(p_obj, (uint8_t *)tx, tx_length) != GD_OK) {
+            return 0;
+        }
+    } else
+#endif
     if (usart_tx_interrupt_preprocess(p_obj, (uint8_t *)tx, tx_length) != GD_OK) {
         return 0;
     }
@@ -643,20 +1280,457 @@ void serial_receive(serial_t *obj, void *rx, size_t rx_length)
     /* disable the IRQ first */
     NVIC_DisableIRQ(irq);
     /* set the priority(higher than Tx) and vector */
-    NVIC_SetPriority(irq, 0);
+    NVIC_SetPriority(irq, usart_irq_level(p_obj, IRQ_LEVEL(IRQ_PRIO_USART_RX)));
+    critical_irq_clamp(irq);
     /* enable IRQ */
     NVIC_EnableIRQ(irq);
 
     usart_rx_interrupt_preprocess(p_obj, (uint8_t *)rx, rx_length);
 }
 
+#if UART_DMA
+/** Move rx_head up to the position the receive DMA channel writes next and
+ *  notify the receive callback
+ *
+ * @param obj_s The serial object
+ */
+static void usart_rx_dma_update(struct serial_s *obj_s)
+{
+    uint16_t head = obj_s->rx_size - (uint16_t)dma_transfer_number_get(DMA_SPL_ARGS(obj_s->rx_dma));
+
+    if (head >= obj_s->rx_size) {
+        head = 0U;
+    }
+    if (head != obj_s->rx_head) {
+        uint16_t old_head = obj_s->rx_head;
+        uint16_t tail = obj_s->rx_tail;
+        uint16_t count = (head > old_head) ? (head - old_head) : (head + obj_s->rx_size - old_head);
+        uint16_t unread = (old_head >= tail) ? (old_head - tail) : (old_head + obj_s->rx_size - tail);
+        uint16_t room = obj_s->rx_size - 1U - unread;
+
+        obj_s->stats.rx_bytes += count;
+        if (count > room) {
+            /* the DMA has lapped the reader */
+            obj_s->stats.rx_dropped += count - room;
+            unread = obj_s->rx_size - 1U;
+        } else {
+            unread += count;
+        }
+        if (unread > obj_s->stats.rx_peak) {
+            obj_s->stats.rx_peak = unread;
+        }
+        obj_s->rx_head = head;
+        if (obj_s->rx_callback != NULL) {
+            obj_s->rx_callback(obj_s);
+        }
+    }
+}
+
+/** Handle the receive DMA channel interrupt (half and full transfer)
+ *
+ * @param arg   The serial object
+ * @param flags The DMA channel flags
+ */
+static void usart_rx_dma_irq(void *arg, uint32_t flags)
+{
+    (void)flags;
+    usart_rx_dma_update((struct serial_s *)arg);
+}
+
+/** Start circular DMA reception. The DMA channel keeps writing into rx and
+ *  wraps around at rx_length; rx_head is moved to the DMA write position on
+ *  the IDLE line interrupt and on DMA half/full transfer, so the interrupt
+ *  load is per burst instead of per character. Data that is not read in time
+ *  is overwritten.
+ *
+ * @param obj        The serial object
+ * @param rx         The receive ring buffer
+ * @param rx_length  The size of the receive ring buffer
+ * @return 1 if DMA reception was started, 0 if this USART has no receive DMA or
+ *         its channel is in use
+ */
+uint8_t serial_rx_dma_start(serial_t *obj, void *rx, size_t rx_length)
+{
+    struct serial_s *p_obj = GET_SERIAL_S(obj);
+    IRQn_Type irq;
+    const dma_channel_t *ch;
+    dma_parameter_struct dma_init_struct;
+
+    if ((p_obj->index >= UART_NUM) || (rx == NULL) || (rx_length == 0U)) {
+        return 0;
+    }
+    ch = &usart_rx_dma[p_obj->index];
+    irq = usart_irq_n[p_obj->index];
+    if ((ch->periph == 0U) ||
+            ((p_obj->databits == USART_WL_9BIT) && (p_obj->parity == USART_PM_NONE))) {
+        return 0;
+    }
+    if ((p_obj->rx_dma != ch) && !dma_channel_claim(ch, p_obj)) {
+        return 0;
+    }
+
+    /* stop an interrupt driven reception */
+    usart_interrupt_disable(p_obj->uart, USART_INT_RBNE);
+    usart_interrupt_disable(p_obj->uart, USART_INT_PERR);
+    usart_interrupt_disable(p_obj->uart, USART_INT_ERR);
+
+    dma_channel_clock_enable(ch);
+    dma_deinit(DMA_SPL_ARGS(ch));
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.direction    = DMA_PERIPHERAL_TO_MEMORY;
+    dma_init_struct.memory_addr  = (uint32_t)rx;
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_8BIT;
+    dma_init_struct.number       = rx_length;
+    dma_init_struct.periph_addr  = (uint32_t)&GD32_USART_RX_DATA(p_obj->uart);
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_8BIT;
+    dma_init_struct.priority     = DMA_PRIORITY_HIGH;
+    dma_init(DMA_SPL_ARGS(ch), &dma_init_struct);
+    dma_circulation_enable(DMA_SPL_ARGS(ch));
+    dma_memory_to_memory_disable(DMA_SPL_ARGS(ch));
+
+    p_obj->rx_buffer_ptr = rx;
+    p_obj->rx_size       = rx_length;
+    p_obj->rx_count      = 0U;
+    p_obj->rx_head       = 0U;
+    p_obj->rx_dma        = ch;
+    p_obj->rx_state      = OP_STATE_BUSY_RX_LISTEN;
+
+    dma_channel_attach_irq(ch, usart_rx_dma_irq, p_obj, usart_irq_level(p_obj, IRQ_LEVEL(IRQ_PRIO_USART_RX)));
+    dma_interrupt_enable(DMA_SPL_ARGS(ch), DMA_INT_HTF | DMA_INT_FTF);
+
+    /* the IDLE line interrupt goes through the USART vector */
+    NVIC_ClearPendingIRQ(irq);
+    NVIC_DisableIRQ(irq);
+    NVIC_SetPriority(irq, usart_irq_level(p_obj, IRQ_LEVEL(IRQ_PRIO_USART_RX)));
+    critical_irq_clamp(irq);
+    NVIC_EnableIRQ(irq);
+
+    usart_interrupt_enable(p_obj->uart, USART_INT_IDLE);
+#if defined(USART_CTL0_AMIE)
+    if (p_obj->char_match) {
+        usart_interrupt_flag_clear(p_obj->uart, USART_INT_FLAG_AM);
+        usart_interrupt_enable(p_obj->uart, USART_INT_AM);
+    }
+#endif
+    USART_CTL2(p_obj->uart) |= USART_CTL2_DENR;
+    dma_channel_enable(DMA_SPL_ARGS(ch));
+
+    return 1;
+}
+
+/** Stop circular DMA reception
+ *
+ * @param obj The serial object
+ */
+void serial_rx_dma_stop(serial_t *obj)
+{
+    struct serial_s *p_obj = GET_SERIAL_S(obj);
+
+    if (p_obj->rx_dma == NULL) {
+        return;
+    }
+
+    usart_interrupt_disable(p_obj->uart, USART_INT_IDLE);
+#if defined(USART_CTL0_AMIE)
+    usart_interrupt_disable(p_obj->uart, USART_INT_AM);
+#endif
+    USART_CTL2(p_obj->uart) &= ~USART_CTL2_DENR;
+    dma_channel_disable(DMA_SPL_ARGS(p_obj->rx_dma));
+    dma_channel_detach_irq(p_obj->rx_dma);
+    dma_channel_release(p_obj->rx_dma, p_obj);
+
+    p_obj->rx_dma   = NULL;
+    p_obj->rx_state = OP_STATE_READY;
+}
+#else
+uint8_t serial_rx_dma_start(serial_t *obj, void *rx, size_t rx_length)
+{
+    (void)obj;
+    (void)rx;
+    (void)rx_length;
+    return 0;
+}
+
+void serial_rx_dma_stop(serial_t *obj)
+{
+    (void)obj;
+}
+#endif /* UART_DMA */
+
+/* clock outputs of the USARTs in synchronous mode, UART3/4 have none */
+static const PinMap usart_ck_pins[] = {
+#if defined(GD32F30x) || defined(GD32F10x) || defined(GD32E50X)
+    {PORTA_8,  USART0, 7},
+    {PORTA_4,  USART1, 7},
+    {PORTD_7,  USART1, 7 | (4 << 3)},   /* GPIO_USART1_REMAP */
+#if defined(USART2)
+    {PORTB_12, USART2, 7},
+    {PORTC_12, USART2, 7 | (5 << 3)},   /* GPIO_USART2_PARTIAL_REMAP */
+    {PORTD_10, USART2, 7 | (6 << 3)},   /* GPIO_USART2_FULL_REMAP */
+#endif
+#else
+    {PORTA_8,  USART0, GD_PIN_FUNCTION4(PIN_MODE_AF, PIN_OTYPE_PP, PIN_PUPD_NONE, GPIO_AF_1)},
+#if defined(USART1)
+    {PORTA_4,  USART1, GD_PIN_FUNCTION4(PIN_MODE_AF, PIN_OTYPE_PP, PIN_PUPD_NONE, GPIO_AF_1)},
+#endif
+#endif
+    {NC,       NC,     0}
+};
+
+/** Get the index of a USART for the per-port tables.
+ *
+ * @param uart The USART
+ * @return The index, UART_NUM if the USART has no clock output
+ */
+static int usart_sync_index(uint32_t uart)
+{
+    switch (uart) {
+#if defined(USART0)
+        case USART0:
+            return UART0_INDEX;
+#endif
+#if defined(USART1)
+        case USART1:
+            return UART1_INDEX;
+#endif
+#if defined(USART2)
+        case USART2:
+            return UART2_INDEX;
+#endif
+        default:
+            return UART_NUM;
+    }
+}
+
+/** Initialize a USART as a synchronous master, an SPI master of 8-bit frames:
+ *  TX drives MOSI, RX samples MISO and CK clocks both. Takes the place of
+ *  serial_init() for the port, serial_free() releases it.
+ *
+ * @param obj The serial object
+ * @param tx  The MOSI pin
+ * @param rx  The MISO pin, NC to only transmit
+ * @param ck  The clock pin
+ * @return 1 if the pins belong to one USART with a clock output, 0 otherwise
+ */
+uint8_t serial_sync_init(serial_t *obj, PinName tx, PinName rx, PinName ck)
+{
+    struct serial_s *p_obj = GET_SERIAL_S(obj);
+    uint32_t uart = pinmap_merge(pinmap_peripheral(tx, PinMap_UART_TX), pinmap_peripheral(rx, PinMap_UART_RX));
+
+    uart = pinmap_merge(uart, pinmap_peripheral(ck, usart_ck_pins));
+    if ((tx == NC) || (ck == NC) || (uart == (uint32_t)NC)) {
+        return 0;
+    }
+    p_obj->index = usart_sync_index(uart);
+    if (p_obj->index >= UART_NUM) {
+        return 0;
+    }
+    serial_init(obj, tx, rx);
+    pinmap_pinout(ck, usart_ck_pins);
+    return 1;
+}
+
+/** Set the clock and frame format of a synchronous USART and enable it.
+ *
+ * @param obj       The serial object
+ * @param clock     The highest clock frequency, the USART goes down to clock / 8 at most
+ * @param mode      The SPI mode 0..3
+ * @param msb_first Non-zero to shift the most significant bit out first
+ * @return 1 if the bit order is done by the USART, 0 if it only shifts LSB first and
+ *         the caller has to reverse the bits for MSB first
+ */
+uint8_t serial_sync_format(serial_t *obj, uint32_t clock, uint8_t mode, uint8_t msb_first)
+{
+    struct serial_s *p_obj = GET_SERIAL_S(obj);
+    uint8_t order = 1U;
+
+    usart_disable(p_obj->uart);
+    p_obj->databits = USART_WL_8BIT;
+    p_obj->stopbits = USART_STB_1BIT;
+    p_obj->parity   = USART_PM_NONE;
+    usart_word_length_set(p_obj->uart, USART_WL_8BIT);
+    usart_stop_bit_set(p_obj->uart, USART_STB_1BIT);
+    usart_parity_config(p_obj->uart, USART_PM_NONE);
+    /* a clock pulse for the last bit too, 8 per frame as SPI devices expect */
+    usart_synchronous_clock_config(p_obj->uart, USART_CLEN_EN, (mode & 0x1U) ? USART_CPH_2CK : USART_CPH_1CK,
+                                   (mode & 0x2U) ? USART_CPL_HIGH : USART_CPL_LOW);
+    USART_CTL1(p_obj->uart) |= USART_CTL1_CKEN;
+#if defined(USART_MSBF_MSB)
+    usart_data_first_config(p_obj->uart, msb_first ? USART_MSBF_MSB : USART_MSBF_LSB);
+#else
+    order = msb_first ? 0U : 1U;
+#endif
+    serial_baud(obj, (clock != 0U) ? (int)clock : 1);
+    if ((USART_BAUD(p_obj->uart) & USART_BAUD_INTDIV) == 0U) {
+        /* faster than the USART goes, take its fastest */
+        USART_BAUD(p_obj->uart) = 0x10U;
+    }
+    serial_enable(p_obj);
+    return order;
+}
+
+/** Exchange one frame on a synchronous USART, polled.
+ *
+ * @param obj  The serial object
+ * @param data The frame sent
+ * @return The frame received meanwhile
+ */
+uint8_t serial_sync_exchange(serial_t *obj, uint8_t data)
+{
+    struct serial_s *p_obj = GET_SERIAL_S(obj);
+
+    while (RESET == usart_flag_get(p_obj->uart, USART_FLAG_TBE)) {
+    }
+    GD32_USART_TX_DATA(p_obj->uart) = data;
+    while (RESET == usart_flag_get(p_obj->uart, USART_FLAG_RBNE)) {
+    }
+    return (uint8_t)GD32_USART_RX_DATA(p_obj->uart);
+}
+
+#if UART_DMA
+/** Exchange a block of frames on a synchronous USART by DMA, waits until the
+ *  last one is in.
+ *
+ * @param obj    The serial object
+ * @param tx     The frames sent, NULL sends 0xFF
+ * @param rx     The frames received, NULL drops them
+ * @param length The number of frames
+ * @return 1 if done, 0 if the USART has no DMA request lines or a channel is in
+ *         use; the caller then goes through serial_sync_exchange()
+ */
+uint8_t serial_sync_transfer(serial_t *obj, const void *tx, void *rx, size_t length)
+{
+    static const uint8_t fill = 0xFFU;
+    static uint8_t drop;
+    struct serial_s *p_obj = GET_SERIAL_S(obj);
+    const dma_channel_t *ch_tx;
+    const dma_channel_t *ch_rx;
+    dma_parameter_struct dma_init_struct;
+
+    if ((p_obj->index >= UART_NUM) || (length == 0U)) {
+        return 0;
+    }
+    ch_tx = &usart_tx_dma[p_obj->index];
+    ch_rx = &usart_rx_dma[p_obj->index];
+    if ((ch_tx->periph == 0U) || (ch_rx->periph == 0U)) {
+        return 0;
+    }
+    if (!dma_channel_claim(ch_rx, p_obj)) {
+        return 0;
+    }
+    if (!dma_channel_claim(ch_tx, p_obj)) {
+        dma_channel_release(ch_rx, p_obj);
+        return 0;
+    }
+
+    dma_channel_clock_enable(ch_rx);
+    dma_deinit(DMA_SPL_ARGS(ch_rx));
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.direction    = DMA_PERIPHERAL_TO_MEMORY;
+    dma_init_struct.memory_addr  = (rx != NULL) ? (uint32_t)rx : (uint32_t)&drop;
+    dma_init_struct.memory_inc   = (rx != NULL) ? DMA_MEMORY_INCREASE_ENABLE : DMA_MEMORY_INCREASE_DISABLE;
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_8BIT;
+    dma_init_struct.number       = length;
+    dma_init_struct.periph_addr  = (uint32_t)&GD32_USART_RX_DATA(p_obj->uart);
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_8BIT;
+    /* above the transmit side, so a received frame is always taken before the next one comes */
+    dma_init_struct.priority     = DMA_PRIORITY_ULTRA_HIGH;
+    dma_init(DMA_SPL_ARGS(ch_rx), &dma_init_struct);
+
+    dma_channel_clock_enable(ch_tx);
+    dma_deinit(DMA_SPL_ARGS(ch_tx));
+    dma_init_struct.direction    = DMA_MEMORY_TO_PERIPHERAL;
+    dma_init_struct.memory_addr  = (tx != NULL) ? (uint32_t)tx : (uint32_t)&fill;
+    dma_init_struct.memory_inc   = (tx != NULL) ? DMA_MEMORY_INCREASE_ENABLE : DMA_MEMORY_INCREASE_DISABLE;
+    dma_init_struct.periph_addr  = (uint32_t)&GD32_USART_TX_DATA(p_obj->uart);
+    dma_init_struct.priority     = DMA_PRIORITY_HIGH;
+    dma_init(DMA_SPL_ARGS(ch_tx), &dma_init_struct);
+
+    /* a frame left over in the receiver would shift every one after it */
+    (void)GD32_USART_STAT(p_obj->uart);
+    (void)GD32_USART_RX_DATA(p_obj->uart);
+    dma_channel_enable(DMA_SPL_ARGS(ch_rx));
+    dma_channel_enable(DMA_SPL_ARGS(ch_tx));
+    USART_CTL2(p_obj->uart) |= USART_CTL2_DENR | USART_CTL2_DENT;
+
+    while (RESET == dma_flag_get(DMA_SPL_ARGS(ch_rx), DMA_FLAG_FTF)) {
+    }
+
+    USART_CTL2(p_obj->uart) &= ~(USART_CTL2_DENR | USART_CTL2_DENT);
+    dma_channel_disable(DMA_SPL_ARGS(ch_tx));
+    dma_channel_disable(DMA_SPL_ARGS(ch_rx));
+    dma_flag_clear(DMA_SPL_ARGS(ch_tx), DMA_FLAG_G);
+    dma_flag_clear(DMA_SPL_ARGS(ch_rx), DMA_FLAG_G);
+    dma_channel_release(ch_tx, p_obj);
+    dma_channel_release(ch_rx, p_obj);
+
+    return 1;
+}
+#else
+uint8_t serial_sync_transfer(serial_t *obj, const void *tx, void *rx, size_t length)
+{
+    (void)obj;
+    (void)tx;
+    (void)rx;
+    (void)length;
+    return 0;
+}
+#endif /* UART_DMA */
+
+/** Keep the interrupts of the port at or below a priority
+ *
+ * @param obj       The serial object
+ * @param priority  8 bit priority, as written to BASEPRI
+ */
+void serial_set_irq_priority(serial_t *obj, uint8_t priority)
+{
+    struct serial_s *p_obj = GET_SERIAL_S(obj);
+
+    p_obj->irq_level = priority >> (8U - __NVIC_PRIO_BITS);
+    /* transfers started from now on pick it up, move what is running */
+    NVIC_SetPriority(usart_irq_n[p_obj->index], usart_irq_level(p_obj, IRQ_LEVEL(IRQ_PRIO_USART_RX)));
+    critical_irq_clamp(usart_irq_n[p_obj->index]);
+#if UART_DMA
+    if (p_obj->rx_dma != NULL) {
+        dma_channel_attach_irq(p_obj->rx_dma, usart_rx_dma_irq, p_obj,
+                               usart_irq_level(p_obj, IRQ_LEVEL(IRQ_PRIO_USART_RX)));
+    }
+#endif
+}
+
+/** Count the receive errors reported in a status register value
+ *
+ * @param obj_s The serial object
+ * @param stat  The status register value
+ */
+static void usart_count_errors(struct serial_s *obj_s, uint32_t stat)
+{
+    if (stat & GD32_USART_STAT_ORERR) {
+        obj_s->stats.overrun_errors++;
+    }
+    if (stat & GD32_USART_STAT_NERR) {
+        obj_s->stats.noise_errors++;
+    }
+    if (stat & GD32_USART_STAT_FERR) {
+        obj_s->stats.framing_errors++;
+    }
+    if (stat & GD32_USART_STAT_PERR) {
+        obj_s->stats.parity_errors++;
+    }
+}
+
 /** This function handles USART interrupt handler
  *
  * @param usart_periph The UART peripheral
  */
-static void usart_irq(struct serial_s *obj_s)
+GD_FASTCODE static void usart_irq(struct serial_s *obj_s)
 {
     uint32_t err_flags = 0U;
+    /* sampled before the IDLE handling below, which clears the error flags on some parts */
+    uint32_t stat = GD32_USART_STAT(obj_s->uart);
 
     /* no error occurs */
     err_flags = (GD32_USART_STAT(obj_s->uart) & (uint32_t)(USART_FLAG_PERR | USART_FLAG_FERR |
@@ -671,6 +1745,47 @@ static void usart_irq(struct serial_s *obj_s)
         }
     }
 
+    if (usart_interrupt_flag_get(obj_s->uart, USART_INT_FLAG_IDLE) != RESET) {
+#if defined(USART_DATA)
+        /* IDLE is cleared by reading the status and then the data register */
+        (void)GD32_USART_STAT(obj_s->uart);
+        (void)GD32_USART_RX_DATA(obj_s->uart);
+#else
+        usart_interrupt_flag_clear(obj_s->uart, USART_INT_FLAG_IDLE);
+#endif
+#if UART_DMA
+        if (obj_s->rx_dma != NULL) {
+            usart_rx_dma_update(obj_s);
+        }
+#endif
+    }
+
+    /* the error interrupts are off during DMA reception, account for the flags here */
+    if ((obj_s->rx_dma != NULL) && ((stat & (GD32_USART_STAT_PERR | GD32_USART_STAT_FERR |
+                                             GD32_USART_STAT_NERR | GD32_USART_STAT_ORERR)) != 0U)) {
+        usart_count_errors(obj_s, stat);
+#if defined(USART_DATA)
+        /* cleared by the status read above followed by a data register read */
+        (void)GD32_USART_RX_DATA(obj_s->uart);
+#else
+        usart_flag_clear(obj_s->uart, USART_FLAG_PERR);
+        usart_flag_clear(obj_s->uart, USART_FLAG_FERR);
+        usart_flag_clear(obj_s->uart, USART_FLAG_NERR);
+        usart_flag_clear(obj_s->uart, USART_FLAG_ORERR);
+#endif
+    }
+
+#if defined(USART_CTL0_AMIE)
+    if (usart_interrupt_flag_get(obj_s->uart, USART_INT_FLAG_AM) != RESET) {
+        usart_interrupt_flag_clear(obj_s->uart, USART_INT_FLAG_AM);
+#if UART_DMA
+        if (obj_s->rx_dma != NULL) {
+            usart_rx_dma_update(obj_s);
+        }
+#endif
+    }
+#endif
+
     if (usart_interrupt_flag_get(obj_s->uart, USART_INT_FLAG_TBE) != RESET) {
         usart_tx_interrupt(obj_s);
         return;
@@ -683,18 +1798,21 @@ static void usart_irq(struct serial_s *obj_s)
     }
 
     if (usart_interrupt_flag_get(obj_s->uart, USART_INT_FLAG_ERR_ORERR) != RESET) {
+        obj_s->stats.overrun_errors++;
         /* clear ORERR error flag by reading USART DATA register */
         GD32_USART_RX_DATA(obj_s->uart);
         usart_interrupt_flag_clear(obj_s->uart, USART_INT_FLAG_ERR_ORERR);
     }
 
     if (usart_interrupt_flag_get(obj_s->uart, USART_INT_FLAG_ERR_NERR) != RESET) {
+        obj_s->stats.noise_errors++;
         /* clear NERR error flag by reading USART DATA register */
         GD32_USART_RX_DATA(obj_s->uart);
         usart_interrupt_flag_clear(obj_s->uart, USART_INT_FLAG_ERR_NERR);
     }
 
     if (usart_interrupt_flag_get(obj_s->uart, USART_INT_FLAG_ERR_FERR) != RESET) {
+        obj_s->stats.framing_errors++;
         /* clear FERR error flag by reading USART DATA register */
         GD32_USART_RX_DATA(obj_s->uart);
         /* also clear it by clearing the interrupt */
@@ -702,6 +1820,7 @@ static void usart_irq(struct serial_s *obj_s)
     }
 
     if (usart_interrupt_flag_get(obj_s->uart, USART_INT_FLAG_PERR) != RESET) {
+        obj_s->stats.parity_errors++;
         /* clear PERR error flag by reading USART DATA register */
         GD32_USART_RX_DATA(obj_s->uart);
         /* also clear it by clearing the interrupt */
@@ -713,8 +1832,9 @@ static void usart_irq(struct serial_s *obj_s)
  *
  */
 #if defined(USART0)
-void USART0_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void USART0_IRQHandler(void)
 {
+    IRQ_PROFILE();
     /* clear pending IRQ */
     NVIC_ClearPendingIRQ(usart_irq_n[UART0_INDEX]);
     usart_irq(obj_s_buf[UART0_INDEX]);
@@ -725,8 +1845,9 @@ void USART0_IRQHandler(void)
  *
  */
 #if defined(USART1)
-void USART1_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void USART1_IRQHandler(void)
 {
+    IRQ_PROFILE();
     /* clear pending IRQ */
     NVIC_ClearPendingIRQ(usart_irq_n[UART1_INDEX]);
     usart_irq(obj_s_buf[UART1_INDEX]);
@@ -737,8 +1858,9 @@ void USART1_IRQHandler(void)
  *
  */
 #if defined(USART2)
-void USART2_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void USART2_IRQHandler(void)
 {
+    IRQ_PROFILE();
     /* clear pending IRQ */
     NVIC_ClearPendingIRQ(usart_irq_n[UART2_INDEX]);
     usart_irq(obj_s_buf[UART2_INDEX]);
@@ -749,8 +1871,9 @@ void USART2_IRQHandler(void)
  *
  */
 #if defined(UART3)
-void UART3_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void UART3_IRQHandler(void)
 {
+    IRQ_PROFILE();
     /* clear pending IRQ */
     NVIC_ClearPendingIRQ(usart_irq_n[UART3_INDEX]);
     usart_irq(obj_s_buf[UART3_INDEX]);
@@ -758,8 +1881,9 @@ void UART3_IRQHandler(void)
 #endif
 
 #if defined(USART3)
-void USART3_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void USART3_IRQHandler(void)
 {
+    IRQ_PROFILE();
     /* clear pending IRQ */
     NVIC_ClearPendingIRQ(usart_irq_n[UART3_INDEX]);
     usart_irq(obj_s_buf[UART3_INDEX]);
@@ -770,8 +1894,9 @@ void USART3_IRQHandler(void)
  *
  */
 #if defined(UART4)
-void UART4_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void UART4_IRQHandler(void)
 {
+    IRQ_PROFILE();
     /* clear pending IRQ */
     NVIC_ClearPendingIRQ(usart_irq_n[UART4_INDEX]);
     usart_irq(obj_s_buf[UART4_INDEX]);
@@ -779,8 +1904,9 @@ void UART4_IRQHandler(void)
 #endif
 
 #if defined(USART4)
-void USART4_IRQHandler(void)
+__attribute__((used)) GD_FASTCODE void USART4_IRQHandler(void)
 {
+    IRQ_PROFILE();
     /* clear pending IRQ */
     NVIC_ClearPendingIRQ(usart_irq_n[UART4_INDEX]);
     usart_irq(obj_s_buf[UART4_INDEX]);
@@ -36,6 +36,8 @@ OF SUCH DAMAGE.
 #include "PeripheralNames.h"
 #include "pinmap.h"
 #include "PeripheralPins.h"
+#include "dma.h"
+#include "rx_sink.h"
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -75,6 +77,13 @@ extern "C" {
 
 #define SERIAL_RESERVED_CHAR_MATCH (255)
 
+/* highest node address serial_set_address() takes; the GD32F30x/F10x/E50x USART compares 4 bits */
+#if defined(USART_CMD_MMCMD)
+#define SERIAL_ADDRESS_MAX (0xFF)
+#else
+#define SERIAL_ADDRESS_MAX (0x0F)
+#endif
+
 // gd_{status,operation_state}_enum cribbed from previous library
 // and put here because they don’t appear in the GD firmware library
 // upstream, and appear to have been added after-the-fact in
@@ -113,6 +122,25 @@ typedef enum {
     ParityForced0 = 4
 } SerialParity;
 
+typedef enum {
+    FlowControlNone,
+    FlowControlRTS,
+    FlowControlCTS,
+    FlowControlRTSCTS
+} FlowControl;
+
+/* Per-port counters, see serial_s.stats */
+typedef struct {
+    uint32_t rx_bytes;          /* characters received */
+    uint32_t tx_bytes;          /* characters transmitted */
+    uint32_t overrun_errors;
+    uint32_t framing_errors;
+    uint32_t noise_errors;
+    uint32_t parity_errors;
+    uint32_t rx_dropped;        /* received into a full ring (dropped, or overwritten with DMA) */
+    uint16_t rx_peak;           /* highest number of unread bytes seen in the ring */
+} serial_stats_t;
+
 typedef struct serial_s serial_t;
 
 struct serial_s {
@@ -121,6 +149,14 @@ struct serial_s {
     int     index;
     PinName pin_tx;
     PinName pin_rx;
+    /* hardware flow control pins, NC when not in use */
+    PinName pin_rts;
+    PinName pin_cts;
+    /* RS-485 driver enable pin, NC when not in use */
+    PinName pin_de;
+    uint8_t de_active_high;
+    /* 1 when the USART drives DE itself (DEM), 0 when it is toggled from the TC interrupt */
+    uint8_t de_hw;
 
     /* configure information */
     uint32_t baudrate;
@@ -135,8 +171,29 @@ struct serial_s {
     //used in HardwareSerial
     uint8_t         *rx_buff;
     uint8_t         *tx_buff;
+    /* ring buffer size - 1, the sizes are powers of 2 */
+    uint16_t   rx_mask;
+    uint16_t   tx_mask;
+    /* frame delimiter, -1 when unused, and the ring index up to which it was searched */
+    int16_t    rx_delimiter;
+    uint16_t   rx_scan;
+    void (*delimiter_callback)(void);
+    /* node address on a multiprocessor bus, -1 when unused, see serial_set_address() */
+    int16_t    mp_address;
+    /* 1 while ADDR holds a character to match, see serial_set_char_match() */
+    uint8_t    char_match;
+    /* takes received bytes instead of rx_buff, NULL when unused */
+    const rx_sink_t *rx_sink;
+    /* NVIC level the port's interrupts are kept at or below, see serial_set_irq_priority() */
+    uint8_t    irq_level;
     uint16_t   tx_count;
     uint16_t   rx_count;
+    /* length of the transfer last started by serial_transmit() */
+    uint16_t   tx_size;
+    /* DMA channel feeding the transmitter, NULL when TX is interrupt driven */
+    const dma_channel_t *tx_dma;
+    /* circular DMA channel filling rx_buffer_ptr, NULL when RX is interrupt driven */
+    const dma_channel_t *rx_dma;
 
     volatile uint16_t rx_tail;
     volatile uint16_t tx_head;
@@ -144,6 +201,7 @@ struct serial_s {
     volatile uint16_t tx_tail;
 
     uint32_t   error_code;
+    volatile serial_stats_t stats;
     operation_state_enum  tx_state;
     operation_state_enum  rx_state;
 
@@ -178,8 +236,22 @@ void serial_enable(struct serial_s *obj_s);
 void serial_free(serial_t *obj);
 /* Configure the baud rate */
 void serial_baud(serial_t *obj, int baudrate);
+/* Start (enable != 0) or stop hardware auto baud detection. Returns 1 if the USART supports it. */
+uint8_t serial_auto_baud(serial_t *obj, uint8_t enable);
+/* Get the detected baud rate, 0 while auto baud detection has not completed. */
+uint32_t serial_auto_baud_result(serial_t *obj);
 /* Configure the format. Set the number of bits, parity and the number of stop bits. */
 void serial_format(serial_t *obj, int data_bits, SerialParity parity, int stop_bits);
+/* Configure hardware flow control. rxflow is the RTS pin, txflow the CTS pin. Returns 1 on success. */
+uint8_t serial_set_flow_control(serial_t *obj, FlowControl type, PinName rxflow, PinName txflow);
+/* Drive an RS-485 transceiver DE pin around every transmission, NC to stop. Returns 1 on success. */
+uint8_t serial_set_rs485(serial_t *obj, PinName de, uint8_t active_high);
+/* Raise the USART interrupt when c is received, -1 to stop. Returns 1 if the USART can match in hardware. */
+uint8_t serial_set_char_match(serial_t *obj, int c);
+/* Mute the receiver until a 9th bit address character of address arrives, -1 to stop. Returns 1 on success. */
+uint8_t serial_set_address(serial_t *obj, int address);
+/* Send an address character; more = 0 waits for it and releases DE, else the transmission after it does. */
+void serial_putc_address(serial_t *obj, int address, uint8_t more);
 /* Get character. This is a blocking call, waiting for a character. */
 int  serial_getc(serial_t *obj);
 /* Send a character. This is a blocking call, waiting for a peripheral to be available for writing. */
@@ -198,10 +270,22 @@ uint8_t serial_rx_active(serial_t *obj);
 void uart_attach_tx_callback(serial_t *obj, void (*callback)(serial_t *));
 /* Attach UART receive callback */
 void uart_attach_rx_callback(serial_t *obj, void (*callback)(serial_t *));
+/* Select DMA (enable != 0) or interrupt driven transmission. Returns 1 if DMA is in use. */
+uint8_t serial_tx_dma_config(serial_t *obj, uint8_t enable);
 /* Begin asynchronous TX transfer. */
 int serial_transmit(serial_t *obj, const void *tx, size_t tx_length);
 /* Begin asynchronous RX transfer (enable interrupt for data collecting). */
 void serial_receive(serial_t *obj, void *rx, size_t rx_length);
+/* Start circular DMA reception into rx, rx_head follows the DMA write position. Returns 1 on success. */
+uint8_t serial_rx_dma_start(serial_t *obj, void *rx, size_t rx_length);
+/* Stop circular DMA reception. */
+void serial_rx_dma_stop(serial_t *obj);
+/* Keep the port's interrupts at or below priority (8 bit, like BASEPRI), e.g. so they may call into an RTOS. */
+void serial_set_irq_priority(serial_t *obj, uint8_t priority);
+uint8_t serial_sync_init(serial_t *obj, PinName tx, PinName rx, PinName ck);
+uint8_t serial_sync_format(serial_t *obj, uint32_t clock, uint8_t mode, uint8_t msb_first);
+uint8_t serial_sync_exchange(serial_t *obj, uint8_t data);
+uint8_t serial_sync_transfer(serial_t *obj, const void *tx, void *rx, size_t length);
 
 #ifdef __cplusplus
 }
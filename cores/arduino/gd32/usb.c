@@ -1,16 +1,90 @@
 #ifdef USBCON
 #include "usb.h"
 
+#if USB_USBFS
+#include "Arduino.h"
+#include "drv_usb_hw.h"
+#else
 #include "usbd_lld_int.h"
+#endif
+#include "os_event.h"
+#include "irq_profile.h"
+#include "irq_priority.h"
+#include "clock.h"
 
 usb_dev usbd;
 
-static void rcu_config()
+/*
+ * Without a crystal (the IRC8M entries of the clock menu) the PLL is too
+ * far off for USB. Those builds clock USB from the IRC48M instead, which
+ * the CTC keeps trimmed to the 1 kHz start-of-frame packets of the host.
+ * -DUSB_CLOCK_IRC48M=1 or =0 overrides the choice.
+ */
+#ifndef USB_CLOCK_IRC48M
+#if defined(__SYSTEM_CLOCK_IRC8M) || defined(__SYSTEM_CLOCK_8M_IRC8M) || \
+    defined(__SYSTEM_CLOCK_48M_PLL_IRC8M) || defined(__SYSTEM_CLOCK_72M_PLL_IRC8M) || \
+    defined(__SYSTEM_CLOCK_72M_PLL_IRC8M_DIV2) || defined(__SYSTEM_CLOCK_108M_PLL_IRC8M) || \
+    defined(__SYSTEM_CLOCK_120M_PLL_IRC8M) || defined(__SYSTEM_CLOCK_168M_PLL_IRC8M) || \
+    defined(__SYSTEM_CLOCK_180M_PLL_IRC8M)
+#define USB_CLOCK_IRC48M        1
+#else
+#define USB_CLOCK_IRC48M        0
+#endif
+#endif
+
+/* the GD32F30x header lacks it, the CTC has it all the same */
+#ifndef CTC_REFSOURCE_USB_SOF
+#define CTC_REFSOURCE_USB_SOF   CTL1_REFSEL(2)
+#endif
+/* IRC48M cycles between two SOFs */
+#define USB_CTC_RELOAD          (48000000U / 1000U - 1U)
+/* half a trim step, 0.14 % of 48000 cycles; errors below it are left alone */
+#define USB_CTC_LIMIT           34U
+
+#if USB_USBFS
+/* the GD32F3x0 names the USBFS clock divider after the peripheral */
+#ifdef GD32F3x0
+#define rcu_usb_clock_config    rcu_usbfs_clock_config
+#define RCU_CKUSB_CKPLL_DIV1    RCU_USBFS_CKPLL_DIV1
+#define RCU_CKUSB_CKPLL_DIV1_5  RCU_USBFS_CKPLL_DIV1_5
+#define RCU_CKUSB_CKPLL_DIV2    RCU_USBFS_CKPLL_DIV2
+#define RCU_CKUSB_CKPLL_DIV2_5  RCU_USBFS_CKPLL_DIV2_5
+#endif
+#if USB_USBHS
+#define RCU_USB                 RCU_USBHS
+#define USB_IRQn                USBHS_IRQn
+#define USB_WKUP_IRQn           USBHS_WKUP_IRQn
+#else
+#define RCU_USB                 RCU_USBFS
+#define USB_IRQn                USBFS_IRQn
+#define USB_WKUP_IRQn           USBFS_WKUP_IRQn
+#endif
+#else
+#define RCU_USB                 RCU_USBD
+#endif
+
+static void irc48m_config()
 {
-    uint32_t system_clock = rcu_clock_freq_get(CK_SYS);
+    rcu_osci_on(RCU_IRC48M);
+    rcu_osci_stab_wait(RCU_IRC48M);
+    rcu_ck48m_clock_config(RCU_CK48MSRC_IRC48M);
 
-    /* enable USB pull-up pin clock */
-    rcu_periph_clock_enable(RCC_AHBPeriph_GPIO_PULLUP);
+    /* trims on its own from the first SOF on, no interrupt needed */
+    rcu_periph_clock_enable(RCU_CTC);
+    ctc_counter_disable();
+    ctc_refsource_signal_select(CTC_REFSOURCE_USB_SOF);
+    ctc_refsource_polarity_config(CTC_REFSOURCE_POLARITY_RISING);
+    ctc_refsource_prescaler_config(CTC_REFSOURCE_PSC_OFF);
+    ctc_counter_reload_value_config(USB_CTC_RELOAD);
+    ctc_clock_limit_value_config(USB_CTC_LIMIT);
+    ctc_hardware_trim_mode_config(CTC_HARDWARE_TRIM_MODE_ENABLE);
+    ctc_counter_enable();
+}
+
+/* divide the PLL down to 48 MHz, 0 if no divider gets there */
+static int pll_config()
+{
+    uint32_t system_clock = rcu_clock_freq_get(CK_SYS);
 
     if (48000000U == system_clock) {
         rcu_usb_clock_config(RCU_CKUSB_CKPLL_DIV1);
@@ -20,14 +94,104 @@ static void rcu_config()
         rcu_usb_clock_config(RCU_CKUSB_CKPLL_DIV2);
     } else if (120000000U == system_clock) {
         rcu_usb_clock_config(RCU_CKUSB_CKPLL_DIV2_5);
+#ifdef GD32E50X
+    /* the GD32E50x divides further, for its faster PLL */
+    } else if (144000000U == system_clock) {
+        rcu_usb_clock_config(RCU_CKUSB_CKPLL_DIV3);
+    } else if (168000000U == system_clock) {
+        rcu_usb_clock_config(RCU_CKUSB_CKPLL_DIV3_5);
+#endif
     } else {
-        /* TODO: panic if the clock doesn’t match assertions. */
+        return 0;
     }
+    return 1;
+}
 
-    /* enable USB APB1 clock */
-    rcu_periph_clock_enable(RCU_USBD);
+static void rcu_config()
+{
+#if !USB_USBFS
+    /* enable USB pull-up pin clock, for good: pin_function() does not count the pin */
+    clock_periph_acquire(RCC_AHBPeriph_GPIO_PULLUP);
+#endif
+
+    /* e.g. the GD32F350 at 108 MHz, which no divider brings to 48 MHz */
+    if (USB_CLOCK_IRC48M || !pll_config()) {
+        irc48m_config();
+    }
+#if USB_USBHS
+    /* the full-speed PHY runs off CK48M, not the 60 MHz ULPI clock */
+    rcu_usbhssel_config(RCU_USBHSSRC_48M);
+#endif
+
+    /* enable USB clock */
+    rcu_periph_clock_enable(RCU_USB);
+}
+
+#if USB_USBFS
+/* the delays the USBFS and USBHS drivers ask for */
+void usb_udelay(const uint32_t usec)
+{
+    delayMicroseconds(usec);
+}
+
+void usb_mdelay(const uint32_t msec)
+{
+    delay(msec);
+}
+
+static void nvic_config()
+{
+    /* enable the USBFS/USBHS interrupt */
+    irq_priority_enable(USB_IRQn, IRQ_PRIO_USB_LP);
+
+    /* enable the USBFS/USBHS wakeup interrupt */
+    irq_priority_enable(USB_WKUP_IRQn, IRQ_PRIO_USB_HP);
+}
+
+void usb_init(usb_desc* desc, usb_class* class_core)
+{
+    rcu_config();
+
+    /* ‘usbd_init’ connects straight away, wait for ‘usb_connect’ instead */
+#if USB_USBHS
+    usbd_init(&usbd, desc, class_core);
+#else
+    usbd_init(&usbd, USB_CORE_ENUM_FS, desc, class_core);
+#endif
+    usbd_disconnect(&usbd);
 }
 
+void usb_connect()
+{
+    nvic_config();
+    usbd_connect(&usbd);
+}
+
+/* the USBHS driver has no ‘usb_globalint_enable’, both gate on GINTEN */
+void usb_enable_interrupts()
+{
+    usbd.regs.gr->GAHBCS |= GAHBCS_GINTEN;
+}
+
+void usb_disable_interrupts()
+{
+    usbd.regs.gr->GAHBCS &= ~GAHBCS_GINTEN;
+}
+
+/*
+ * Move all the USB interrupts to one NVIC priority, given in the
+ * 8-bit form used by the priority registers.
+ */
+void usb_set_interrupt_priority(uint8_t priority)
+{
+    uint32_t level = priority >> (8U - __NVIC_PRIO_BITS);
+
+    NVIC_SetPriority(USB_IRQn, level);
+    NVIC_SetPriority(USB_WKUP_IRQn, level);
+    critical_irq_clamp(USB_IRQn);
+    critical_irq_clamp(USB_WKUP_IRQn);
+}
+#else
 static void gpio_config()
 {
     /* configure usb pull-up pin */
@@ -36,17 +200,14 @@ static void gpio_config()
 
 static void nvic_config()
 {
-    /* 2 bits for preemption priority, 2 bits for subpriority */
-    nvic_priority_group_set(NVIC_PRIGROUP_PRE2_SUB2);
-
     /* enable the USB low priority interrupt */
-    nvic_irq_enable((uint8_t)USBD_LP_CAN0_RX0_IRQn, 2U, 0U);
+    irq_priority_enable(USBD_LP_CAN0_RX0_IRQn, IRQ_PRIO_USB_LP);
 
-    /* enable the USB low priority interrupt */
-    nvic_irq_enable((uint8_t)USBD_HP_CAN0_TX_IRQn, 1U, 0U);
+    /* enable the USB high priority interrupt */
+    irq_priority_enable(USBD_HP_CAN0_TX_IRQn, IRQ_PRIO_USB_HP);
 
     /* enable the USB wakeup interrupt */
-    nvic_irq_enable((uint8_t)USBD_WKUP_IRQn, 1U, 0U);
+    irq_priority_enable(USBD_WKUP_IRQn, IRQ_PRIO_USB_HP);
 }
 
 void usb_init(usb_desc* desc, usb_class* class_core)
@@ -61,7 +222,6 @@ void usb_connect()
 {
     nvic_config();
     usbd_connect(&usbd);
-    while (usbd.cur_status != USBD_CONFIGURED) {}
 }
 
 void usb_enable_interrupts()
@@ -76,23 +236,90 @@ void usb_disable_interrupts()
     USBD_CTL &= ~(CTL_STIE | CTL_WKUPIE | CTL_SPSIE | CTL_SOFIE | CTL_ESOFIE | CTL_RSTIE);
 }
 
+/*
+ * Move all the USB interrupts to one NVIC priority, given in the
+ * 8-bit form used by the priority registers.
+ */
+void usb_set_interrupt_priority(uint8_t priority)
+{
+    uint32_t level = priority >> (8U - __NVIC_PRIO_BITS);
+
+    NVIC_SetPriority(USBD_LP_CAN0_RX0_IRQn, level);
+    NVIC_SetPriority(USBD_HP_CAN0_TX_IRQn, level);
+    NVIC_SetPriority(USBD_WKUP_IRQn, level);
+    critical_irq_clamp(USBD_LP_CAN0_RX0_IRQn);
+    critical_irq_clamp(USBD_HP_CAN0_TX_IRQn);
+    critical_irq_clamp(USBD_WKUP_IRQn);
+}
+#endif /* USB_USBFS */
+
+/* the generic driver hooks, unless an RTOS needs something USB specific */
+__attribute__((weak)) void usb_event_wait(void)
+{
+    os_event_wait();
+}
+
+__attribute__((weak)) void usb_event_signal(void)
+{
+    os_event_signal();
+}
+
+__attribute__((weak)) void usb_shared_can_tx_irq(void)
+{
+}
+
 void usb_disconnect()
 {
     usbd_disconnect(&usbd);
 }
 
-void USBD_HP_CAN0_TX_IRQHandler()
+#if USB_USBFS
+void usb_poll(void)
+{
+    /* let USBCore drop its endpoint state before the driver resets */
+    if ((usbd.regs.gr->GINTF & usbd.regs.gr->GINTEN & GINTF_RST) != 0U) {
+        usb_bus_reset();
+    }
+    usbd_isr(&usbd);
+}
+
+#if USB_USBHS
+__attribute__((used)) void USBHS_IRQHandler()
+#else
+__attribute__((used)) void USBFS_IRQHandler()
+#endif
+{
+    IRQ_PROFILE();
+    usb_poll();
+}
+
+#if USB_USBHS
+__attribute__((used)) void USBHS_WKUP_IRQHandler()
+#else
+__attribute__((used)) void USBFS_WKUP_IRQHandler()
+#endif
+{
+    IRQ_PROFILE();
+    exti_interrupt_flag_clear(EXTI_18);
+}
+#else
+__attribute__((used)) void USBD_HP_CAN0_TX_IRQHandler()
 {
+    IRQ_PROFILE();
     usbd_isr();
+    usb_shared_can_tx_irq();
 }
 
-void USBD_LP_CAN0_RX0_IRQHandler()
+__attribute__((used)) void USBD_LP_CAN0_RX0_IRQHandler()
 {
+    IRQ_PROFILE();
     usbd_isr();
 }
 
-void USBD_WKUP_IRQHandler()
+__attribute__((used)) void USBD_WKUP_IRQHandler()
 {
+    IRQ_PROFILE();
     exti_interrupt_flag_clear(EXTI_18);
 }
+#endif /* USB_USBFS */
 #endif
@@ -3,7 +3,14 @@
 
 #ifdef USBCON
 #include "usbd_core.h"
+#if USB_USBFS
+#include "drv_usbd_int.h"
+
+/* the USBFS library calls its class callbacks ‘usb_class_core’ */
+typedef usb_class_core usb_class;
+#else
 #include "usbd_lld_core.h"
+#endif
 
 extern usb_dev usbd;
 
@@ -12,6 +19,38 @@ void usb_connect();
 void usb_disconnect();
 void usb_enable_interrupts();
 void usb_disable_interrupts();
+void usb_set_interrupt_priority(uint8_t priority);
+
+/*
+ * Hooks for blocking on endpoint events. ‘usb_event_wait’ is called
+ * from thread context while waiting for the USB interrupt to finish a
+ * transfer, ‘usb_event_signal’ from the USB interrupt once it did.
+ * By default they call ‘os_event_wait’ and ‘os_event_signal’, see
+ * os_event.h.
+ */
+void usb_event_wait(void);
+void usb_event_signal(void);
+
+/*
+ * On parts where CAN0 TX shares the USBD high priority interrupt, the
+ * handler calls this after the USB driver. Does nothing by default, a
+ * CAN driver defines it to serve its transmit mailboxes.
+ */
+void usb_shared_can_tx_irq(void);
+
+#if USB_USBFS
+/*
+ * Run the USBFS interrupt handler once, for waiting on an endpoint
+ * where the interrupt can't get in.
+ */
+void usb_poll(void);
+
+/*
+ * Called by the USBFS interrupt handler when the host resets the bus,
+ * before the driver resets its endpoints. Defined by USBCore.
+ */
+void usb_bus_reset(void);
+#endif
 
 #endif
 #endif
@@ -0,0 +1,57 @@
+#ifndef __USB_CONF_H
+#define __USB_CONF_H
+
+/*
+ * Configuration of the USBFS and USBHS drivers, which include this file
+ * by name.
+ */
+#include "usbd_conf.h"
+
+#if USB_USBFS
+
+#include <stddef.h>
+
+#if USB_USBHS
+/* full speed through the embedded PHY, see usbd_conf.h */
+#define USB_EMBEDDED_FS_PHY_ENABLED
+#else
+#define USB_FS_CORE
+#endif
+
+/*
+ * The library marks its unaligned FIFO copies the Keil way. GCC has no
+ * such pointer qualifier and needs none, the Cortex-M4 does unaligned
+ * single word loads and stores.
+ */
+#ifndef __packed
+#define __packed
+#endif
+
+/*
+ * FIFO sizes, in 32-bit words, out of the 320 words of FIFO memory
+ * (1280 on USBHS). The receive FIFO is shared by all OUT endpoints,
+ * each IN endpoint has its own; endpoint 3 is the CDC-ACM data IN
+ * endpoint, so it gets room for a few packets in flight.
+ */
+#if USB_USBHS
+/* EP_COUNT caps the endpoints at four, 4 and 5 only need a FIFO entry */
+#define RX_FIFO_SIZE  128U
+#define TX0_FIFO_SIZE 32U
+#define TX1_FIFO_SIZE 32U
+#define TX2_FIFO_SIZE 32U
+#define TX3_FIFO_SIZE 96U
+#define TX4_FIFO_SIZE 0U
+#define TX5_FIFO_SIZE 0U
+#else
+#define RX_FIFO_FS_SIZE  128U
+#define TX0_FIFO_FS_SIZE 32U
+#define TX1_FIFO_FS_SIZE 32U
+#define TX2_FIFO_FS_SIZE 32U
+#define TX3_FIFO_FS_SIZE 96U
+#endif
+
+#define USB_SOF_OUTPUT 0U
+#define USB_LOW_POWER  0U
+
+#endif /* USB_USBFS */
+#endif /* __USB_CONF_H */
@@ -19,6 +19,51 @@
 /* link power mode support */
 #undef LPM_ENABLED
 
+/*
+ * GD32F30x connectivity line and GD32F350 parts have the USBFS (OTG)
+ * peripheral instead of USBD. It has four endpoints with their own
+ * FIFOs, and splits a transfer of several packets up by itself, so
+ * endpoint buffers there hold ‘USB_XFER_SIZE’ octets rather than one
+ * packet.
+ *
+ * The USBHS of the GD32E50x connectivity line and GD32E508 is the same
+ * core with more endpoints and FIFO memory, and goes through the same
+ * code, so ‘USB_USBFS’ is set for it too; ‘USB_USBHS’ marks where the
+ * two drivers differ. It runs on its embedded full-speed PHY, high
+ * speed would need the qualifier and other-speed descriptors.
+ */
+#if defined(GD32E50X_CL) || defined(GD32E508)
+#define USB_USBFS 1
+#define USB_USBHS 1
+#elif defined(GD32F30X_CL) || defined(GD32F350)
+#define USB_USBFS 1
+#define USB_USBHS 0
+#elif defined(GD32F3x0)
+#error "USB is only available on the GD32F350, the GD32F330 has no USB peripheral"
+#else
+#define USB_USBFS 0
+#define USB_USBHS 0
+#endif
+
+#if USB_USBFS
+
+#define USBD_CFG_MAX_NUM 1
+#define USBD_ITF_MAX_NUM 8
+
+#define EP_COUNT 4
+
+#define USB_STRING_COUNT 4
+
+#define USBD_EP0_MAX_SIZE 64U
+
+/*
+ * Size of endpoint buffers, and so the most one IN transfer carries.
+ * Also bounds the data stage of a control request, both ways.
+ */
+#define USB_XFER_SIZE 256
+
+#else
+
 /*
  * TODO: I’m currently using the maximum values allowed by the spec
  * for available interfaces and endpoints, because I can’t know this
@@ -55,5 +100,10 @@
 #define EP0_TX_ADDR 0x40
 #define EP0_RX_ADDR (EP0_TX_ADDR+USBD_EP0_MAX_SIZE)
 
+/* one packet at a time */
+#define USB_XFER_SIZE USBD_EP0_MAX_SIZE
+
+#endif /* USB_USBFS */
+
 #endif
 #endif /* __USBD_CONF_H */
@@ -0,0 +1,96 @@
+#include <stddef.h>
+#include "vectors.h"
+
+/* entries of the vector table in the startup file, 16 core exceptions included */
+#if defined(GD32E23x)
+#define VECTOR_NUM          51U
+#elif defined(GD32F1x0)
+#define VECTOR_NUM          90U
+#elif defined(GD32F3x0) || defined(GD32F30X_CL)
+#define VECTOR_NUM          84U
+#elif defined(GD32F30x)
+#define VECTOR_NUM          76U
+#else
+#define VECTOR_NUM          128U
+#endif
+#define VECTOR_CORE_NUM     16U
+
+/* VTOR wants the table aligned to its size rounded up to a power of two */
+static vector_handler_t vector_table[VECTOR_NUM] __attribute__((aligned(512)));
+/* the table VTOR pointed to before, for vector_detach() */
+static const vector_handler_t *vector_rom;
+
+static void vector_table_to_ram(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t i;
+
+    __disable_irq();
+    if (NULL == vector_rom) {
+        vector_rom = (const vector_handler_t *)SCB->VTOR;
+        for (i = 0U; i < VECTOR_NUM; i++) {
+            vector_table[i] = vector_rom[i];
+        }
+        __DSB();
+        SCB->VTOR = (uint32_t)vector_table;
+        __DSB();
+        __ISB();
+    }
+    __set_PRIMASK(primask);
+}
+
+/*!
+    \brief      install an interrupt handler directly in the vector table
+    \param[in]  irq: peripheral interrupt number, or a negative core exception number
+    \param[in]  handler: function the interrupt enters
+    \param[out] none
+    \retval     the handler installed before, NULL if irq is out of range
+*/
+vector_handler_t vector_attach(IRQn_Type irq, vector_handler_t handler)
+{
+    uint32_t index = (uint32_t)((int32_t)irq + (int32_t)VECTOR_CORE_NUM);
+    vector_handler_t previous;
+
+    if (index >= VECTOR_NUM) {
+        return NULL;
+    }
+    vector_table_to_ram();
+    previous = vector_table[index];
+    vector_table[index] = handler;
+    /* the next exception entry has to fetch the new address */
+    __DSB();
+    return previous;
+}
+
+/*!
+    \brief      put back the handler the vector table started with
+    \param[in]  irq: peripheral interrupt number, or a negative core exception number
+    \param[out] none
+    \retval     none
+*/
+void vector_detach(IRQn_Type irq)
+{
+    uint32_t index = (uint32_t)((int32_t)irq + (int32_t)VECTOR_CORE_NUM);
+
+    if ((index >= VECTOR_NUM) || (NULL == vector_rom)) {
+        return;
+    }
+    vector_table[index] = vector_rom[index];
+    __DSB();
+}
+
+/*!
+    \brief      get the handler an interrupt enters
+    \param[in]  irq: peripheral interrupt number, or a negative core exception number
+    \param[out] none
+    \retval     the handler, NULL if irq is out of range
+*/
+vector_handler_t vector_get(IRQn_Type irq)
+{
+    uint32_t index = (uint32_t)((int32_t)irq + (int32_t)VECTOR_CORE_NUM);
+
+    if (index >= VECTOR_NUM) {
+        return NULL;
+    }
+    return ((const vector_handler_t *)SCB->VTOR)[index];
+}
@@ -0,0 +1,35 @@
+#ifndef _GD32_VECTORS_H_
+#define _GD32_VECTORS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gd32xxyy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Interrupt handlers installed at run time. The first ‘vector_attach’
+ * copies the vector table from flash (or wherever VTOR points, e.g. past
+ * a bootloader) into RAM and moves VTOR there; after that a handler goes
+ * straight into the table, so its interrupt enters it directly instead of
+ * through the core's shared handler and callback tables.
+ *
+ * An attached handler replaces the core's one completely: it has to clear
+ * the peripheral's flags itself, and the driver that owned the vector (say
+ * the timer callbacks of the same timer) stops getting interrupts until
+ * ‘vector_detach’ puts the original handler back.
+ */
+typedef void (*vector_handler_t)(void);
+
+/* returns the handler that was installed before */
+vector_handler_t vector_attach(IRQn_Type irq, vector_handler_t handler);
+void vector_detach(IRQn_Type irq);
+vector_handler_t vector_get(IRQn_Type irq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_VECTORS_H_ */
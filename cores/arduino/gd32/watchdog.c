@@ -0,0 +1,179 @@
+#include "watchdog.h"
+#include "critical.h"
+
+/* the window watchdog resets the part when its counter drops below this */
+#define WATCHDOG_WINDOW_MIN     0x40U
+#define WATCHDOG_WINDOW_TICKS   64U
+
+uint32_t watchdog_window_reload;
+
+/* added clients and those checked in since the last refresh, one bit each */
+static volatile uint32_t watchdog_clients;
+static volatile uint32_t watchdog_checked;
+/* latched by watchdog_caused_reset(): 1 no, 2 yes */
+static uint8_t watchdog_reset;
+
+/*!
+    \brief      start the free watchdog, or change its timeout
+    \param[in]  timeout_ms: time without a refresh until the reset, nominal IRC40K
+    \param[out] none
+    \retval     the timeout it got in milliseconds, at least timeout_ms up to WATCHDOG_MAX_TIMEOUT_MS
+*/
+uint32_t watchdog_begin(uint32_t timeout_ms)
+{
+    uint32_t ticks;
+    uint32_t psc = 0U;
+
+    if (timeout_ms > WATCHDOG_MAX_TIMEOUT_MS) {
+        timeout_ms = WATCHDOG_MAX_TIMEOUT_MS;
+    }
+    /* ticks of the counter at /4, then the smallest prescaler that holds them in 12 bits */
+    ticks = (timeout_ms * (IRC40K_VALUE / 1000U) + 3U) / 4U;
+    while ((ticks > 4096U) && (psc < 6U)) {
+        ticks = (ticks + 1U) / 2U;
+        psc++;
+    }
+    if (ticks == 0U) {
+        ticks = 1U;
+    } else if (ticks > 4096U) {
+        ticks = 4096U;
+    }
+
+    dbg_periph_enable(DBG_FWDGT_HOLD);
+    /* starts the IRC40K, which the prescaler and reload registers need to take writes */
+    fwdgt_enable();
+    fwdgt_config((uint16_t)(ticks - 1U), (uint8_t)psc);
+    fwdgt_write_disable();
+    watchdog_refresh();
+    return (ticks << (psc + 2U)) / (IRC40K_VALUE / 1000U);
+}
+
+/*!
+    \brief      start the window watchdog
+    \param[in]  timeout_us: time without a refresh until the reset
+    \param[in]  window_us: refreshes sooner than this after the previous one reset the part too, 0 for none
+    \param[out] none
+    \retval     the timeout it got in microseconds, 0 if it doesn't fit the range of PCLK1
+*/
+uint32_t watchdog_window_begin(uint32_t timeout_us, uint32_t window_us)
+{
+    /* ticks per second at /1 */
+    uint32_t rate = rcu_clock_freq_get(CK_APB1) / 4096U;
+    uint32_t ticks;
+    uint32_t closed;
+    uint32_t psc;
+
+    if (rate == 0U) {
+        return 0U;
+    }
+    for (psc = 0U; psc < 4U; psc++) {
+        uint32_t hz = rate >> psc;
+
+        /* us * hz / 1000000 without overflowing 32 bits */
+        ticks = (timeout_us / 1000U) * hz + ((timeout_us % 1000U) * hz) / 1000U;
+        ticks = (ticks + 999U) / 1000U;
+        if (ticks <= WATCHDOG_WINDOW_TICKS) {
+            break;
+        }
+    }
+    if (psc == 4U) {
+        return 0U;
+    }
+    if (ticks == 0U) {
+        ticks = 1U;
+    }
+    /* refreshes allowed once the counter came down to the window value */
+    closed = ((window_us / 1000U) * (rate >> psc) + ((window_us % 1000U) * (rate >> psc)) / 1000U) / 1000U;
+    if (closed >= ticks) {
+        closed = ticks - 1U;
+    }
+
+    dbg_periph_enable(DBG_WWDGT_HOLD);
+    rcu_periph_clock_enable(RCU_WWDGT);
+    watchdog_window_reload = WWDGT_CTL_WDGTEN | (WATCHDOG_WINDOW_MIN - 1U + ticks);
+    wwdgt_config((uint16_t)(WATCHDOG_WINDOW_MIN - 1U + ticks), (uint16_t)(WATCHDOG_WINDOW_MIN - 1U + ticks - closed),
+                 CFG_PSC(psc));
+    watchdog_window_refresh();
+    return (ticks * 1000000U) / (rate >> psc);
+}
+
+/*!
+    \brief      tell whether a watchdog caused the last reset
+    \param[in]  none
+    \param[out] none
+    \retval     true for the free or the window watchdog
+*/
+bool watchdog_caused_reset(void)
+{
+    if (watchdog_reset == 0U) {
+        watchdog_reset = ((RESET != rcu_flag_get(RCU_FLAG_FWDGTRST)) ||
+                          (RESET != rcu_flag_get(RCU_FLAG_WWDGTRST))) ? 2U : 1U;
+        /* the flags stick through resets of other kinds until cleared */
+        rcu_all_reset_flag_clear();
+    }
+    return watchdog_reset == 2U;
+}
+
+/*!
+    \brief      add a client to the supervisor
+    \param[in]  none
+    \param[out] none
+    \retval     the client, -1 if all WATCHDOG_MAX_CLIENTS are taken
+*/
+int watchdog_client_add(void)
+{
+    uint32_t state;
+    int client;
+
+    state = critical_enter();
+    for (client = 0; client < WATCHDOG_MAX_CLIENTS; client++) {
+        if ((watchdog_clients & (1UL << client)) == 0U) {
+            watchdog_clients |= 1UL << client;
+            watchdog_checked &= ~(1UL << client);
+            break;
+        }
+    }
+    critical_exit(state);
+    return (client < WATCHDOG_MAX_CLIENTS) ? client : -1;
+}
+
+/*!
+    \brief      remove a client from the supervisor, the others no longer wait for it
+    \param[in]  client: from watchdog_client_add()
+    \param[out] none
+    \retval     none
+*/
+void watchdog_client_remove(int client)
+{
+    uint32_t state;
+
+    if ((client < 0) || (client >= WATCHDOG_MAX_CLIENTS)) {
+        return;
+    }
+    state = critical_enter();
+    watchdog_clients &= ~(1UL << client);
+    watchdog_checked &= ~(1UL << client);
+    critical_exit(state);
+}
+
+/*!
+    \brief      report a client alive, the last of a round refreshes the free watchdog
+    \param[in]  client: from watchdog_client_add()
+    \param[out] none
+    \retval     none
+*/
+void watchdog_check_in(int client)
+{
+    uint32_t state;
+
+    if ((client < 0) || (client >= WATCHDOG_MAX_CLIENTS)) {
+        return;
+    }
+    state = critical_enter();
+    watchdog_checked |= 1UL << client;
+    if ((watchdog_checked & watchdog_clients) == watchdog_clients) {
+        watchdog_checked = 0U;
+        watchdog_refresh();
+    }
+    critical_exit(state);
+}
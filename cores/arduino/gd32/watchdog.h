@@ -0,0 +1,67 @@
+#ifndef _GD32_WATCHDOG_H_
+#define _GD32_WATCHDOG_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gd32xxyy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Watchdogs. The free watchdog (FWDGT) runs from the 40 kHz IRC40K and
+ * resets the part unless refreshed within the timeout, 0.1 ms to 26 s;
+ * once started it can't be stopped, only given another timeout. The
+ * IRC40K is an RC oscillator, off by up to a third, so leave margin.
+ * The window watchdog (WWDGT) runs from PCLK1 for at most 64 ticks of
+ * 4096 to 32768 clocks, milliseconds, and resets the part as well on a
+ * refresh that comes too early, before the window opens.
+ *
+ * Both refreshes are a single register store. Both watchdogs stop while
+ * a debugger holds the core.
+ *
+ * The supervisor refreshes the free watchdog only once every added
+ * client, a task or a loop each, checked in since the last refresh, so
+ * a single one that hangs lets it expire. Check-ins may come from any
+ * context; one that comes twice in a round changes nothing.
+ */
+/* the longest free watchdog timeout */
+#define WATCHDOG_MAX_TIMEOUT_MS     26214U
+/* clients of the supervisor */
+#define WATCHDOG_MAX_CLIENTS        32
+
+/* start or re-time the free watchdog, returns the timeout it got in ms */
+uint32_t watchdog_begin(uint32_t timeout_ms);
+/* start the window watchdog: reset after timeout_us, or on a refresh sooner
+   than window_us after the previous one; returns the timeout it got in us,
+   0 if PCLK1 is too fast or slow for it */
+uint32_t watchdog_window_begin(uint32_t timeout_us, uint32_t window_us);
+/* the last reset came from a watchdog; the reset flags are read and cleared
+   on the first call */
+bool watchdog_caused_reset(void);
+
+/* a supervisor client, -1 if all WATCHDOG_MAX_CLIENTS are taken */
+int watchdog_client_add(void);
+void watchdog_client_remove(int client);
+/* the client is alive; the last one of a round refreshes the free watchdog */
+void watchdog_check_in(int client);
+
+/* counter value and enable bit watchdog_window_refresh() stores */
+extern uint32_t watchdog_window_reload;
+
+static inline void watchdog_refresh(void)
+{
+    FWDGT_CTL = FWDGT_KEY_RELOAD;
+}
+
+static inline void watchdog_window_refresh(void)
+{
+    WWDGT_CTL = watchdog_window_reload;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_WATCHDOG_H_ */
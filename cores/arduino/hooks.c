@@ -20,7 +20,9 @@
  * libraries or sketches that supports cooperative threads.
  *
  * Its defined as a weak symbol and it can be redefined to implement a
- * real cooperative scheduler.
+ * real cooperative scheduler, as the Scheduler library does. delay()
+ * calls it, and so do the drivers of the core while they wait, through
+ * os_event_wait().
  */
 static void __empty()
 {
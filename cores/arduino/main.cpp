@@ -33,7 +33,15 @@ extern "C" {
 #endif
 void init(void)
 {
+    memory_stack_paint();
+    clock_flash_tune();
+    irq_priority_init();
     systick_config();
+    exmc_early_init();
+#if defined(GD32_SWO_BAUD)
+    itm_init(GD32_SWO_BAUD);
+#endif
+    crash_check();
 }
 
 #ifdef __cplusplus
@@ -51,15 +59,23 @@ __attribute__((constructor(101))) void premain()
 int main(void)
 {
 #ifdef USBCON
-    // TODO: remove this and only call it when the USB is attempted to
-    // be used.
-    USBCore().connect();
+    // Modules plugged into PluggableUSB during static initialization
+    // expect the device to be on the bus from the start. Otherwise
+    // the first class used connects it, e.g. CDC on ‘begin’, so
+    // sketches that never touch USB skip its setup altogether.
+    if (PluggableUSB().ifCount() > PLUGGABLE_USB_FIRST_INTERFACE) {
+        USBCore().connect();
+    }
 #endif
 
     setup();
 
     while (1) {
         loop();
+        if (serialEventRun) {
+            serialEventRun();
+        }
+        deferred_run();
     }
     return 0;
 }
@@ -26,10 +26,24 @@ OF SUCH DAMAGE.
 */
 
 #include "pwm.h"
+#include "gd32/deferred.h"
 #include "pins_arduino.h"
 #define PWMNUMS   56
 PWM *pwmObj[PWMNUMS] = {NULL};
 
+/*!
+    \brief      timer channel interrupt callback, routes it to the owning PWM object
+    \param[in]  arg: the PWM object
+    \param[in]  source: TIMER_IRQ_SOURCE_CH(x)(x=0..3)
+    \param[out] none
+    \retval     none
+*/
+static void pwmIrq(void *arg, uint8_t source)
+{
+    (void)source;
+    ((PWM *)arg)->captureCompareCallback();
+}
+
 /*!
     \brief      PWM object construct
     \param[in]  instance: PWMx(x=0..11)
@@ -105,12 +119,15 @@ void PWM::writeCycleValue(uint32_t cycle, enum timeFormat format)
 /*!
     \brief      attach callback for capture/compare interrupt
     \param[in]  callback: callback function
+    \param[in]  deferred: queue the callback to run at thread level, see deferred.h
     \param[out] none
     \retval     none
 */
-void PWM::attachInterrupt(pwmCallback_t callback)
+void PWM::attachInterrupt(pwmCallback_t callback, bool deferred)
 {
     this->pwmCallback = callback;
+    this->pwmDeferred = deferred;
+    Timer_attachIrqCallback(pwmDevice.timer, TIMER_IRQ_SOURCE_CH(pwmDevice.channel), pwmIrq, this);
     pwmHandle.enablePWMIT(&pwmDevice);
 }
 
@@ -124,6 +141,7 @@ void PWM::detachInterrupt(void)
 {
     this->pwmCallback = NULL;
     pwmHandle.disablePWMIT(&pwmDevice);
+    Timer_detachIrqCallback(pwmDevice.timer, TIMER_IRQ_SOURCE_CH(pwmDevice.channel));
 }
 
 /*!
@@ -135,27 +153,356 @@ void PWM::detachInterrupt(void)
 void PWM::captureCompareCallback(void)
 {
     if (NULL != this->pwmCallback) {
-        this->pwmCallback();
-    }
-}
-
-extern "C"
-{
-    /*!
-        \brief      pwm capture/compare interrupt handler
-        \param[in]  timer: PWMx(x=0..11)
-        \param[in]  channel: TIMER_CH_x(x=0..4)
-        \param[out] none
-        \retval     none
-    */
-    void PWM_irqHandle(uint32_t timer, uint8_t channel)
-    {
-        uint32_t index = 0;
-        pwmDevice_t pwmDevice = {timer, channel};
-        index = getPWMIndex(pwmDevice);
-        if (pwmObj[index]) {
-            pwmObj[index]->captureCompareCallback();
+        if (this->pwmDeferred) {
+            deferred_post_call(this->pwmCallback);
+        } else {
+            this->pwmCallback();
+        }
+    }
+}
+
+/*!
+    \brief      set pwm frequency, the prescaler is chosen for the finest duty cycle resolution
+    \param[in]  freq_hz: frequency in Hz
+    \param[out] none
+    \retval     period in timer ticks, 0 if freq_hz is out of range
+*/
+uint32_t PWM::setFrequency(uint32_t freq_hz)
+{
+    return PWM_setFrequency(&pwmDevice, freq_hz);
+}
+
+/*!
+    \brief      get pwm period, compare values written with FORMAT_TICK range from 0 to this
+    \param[in]  none
+    \param[out] none
+    \retval     period in timer ticks
+*/
+uint32_t PWM::getPeriodTicks(void)
+{
+    return PWM_getPeriodTicks(&pwmDevice);
+}
+
+/*!
+    \brief      get the timer driving the pwm pin
+    \param[in]  none
+    \param[out] none
+    \retval     TIMERx
+*/
+uint32_t PWM::getTimer(void)
+{
+    return pwmDevice.timer;
+}
+
+/*!
+    \brief      enable the complementary output of the channel (TIMER0/TIMER7 CH0..2, TIMER14..16 CH0)
+    \param[in]  pin: pin of the complementary output
+    \param[out] none
+    \retval     true if enabled, false if the channel has no complementary output
+*/
+bool PWM::enableComplementary(uint32_t pin)
+{
+    return PWM_enableComplementary(&pwmDevice, DIGITAL_TO_PINNAME(pin)) != 0;
+}
+
+/*!
+    \brief      disable the complementary output of the channel
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void PWM::disableComplementary(void)
+{
+    PWM_disableComplementary(&pwmDevice);
+}
+
+/*!
+    \brief      set the dead time between the channel and its complementary output
+    \param[in]  ns: minimum dead time in nanoseconds, shared by all channels of the timer
+    \param[out] none
+    \retval     dead time actually programmed in nanoseconds, 0 if not supported
+*/
+uint32_t PWM::setDeadTime(uint32_t ns)
+{
+    return PWM_setDeadTime(&pwmDevice, ns);
+}
+
+/*!
+    \brief      enable the break input of the timer
+    \param[in]  pin: break input pin
+    \param[in]  activeHigh: true if a high level on the break input stops the outputs
+    \param[out] none
+    \retval     true if enabled, false if the timer has no break input
+*/
+bool PWM::enableBreak(uint32_t pin, bool activeHigh)
+{
+    return PWM_enableBreak(&pwmDevice, DIGITAL_TO_PINNAME(pin), activeHigh) != 0;
+}
+
+/*!
+    \brief      disable the break input of the timer
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void PWM::disableBreak(void)
+{
+    PWM_disableBreak(&pwmDevice);
+}
+
+/*!
+    \brief      re-enable the outputs after a break event
+    \param[in]  none
+    \param[out] none
+    \retval     true if the outputs run again, false while the break input is still active
+*/
+bool PWM::clearBreak(void)
+{
+    return PWM_clearBreak(&pwmDevice) != 0;
+}
+
+/*!
+    \brief      stream compare values to the channel by DMA, one per timer period
+    \param[in]  buffer: compare values in timer ticks, must stay valid while playing
+    \param[in]  length: number of values
+    \param[in]  loop: restart at the beginning of buffer after the last value
+    \param[out] none
+    \retval     true if streaming started, false if the timer has no update DMA request
+*/
+bool PWM::playBuffer(const uint16_t *buffer, size_t length, bool loop)
+{
+    return PWM_playBuffer(&pwmDevice, buffer, length, loop) != 0;
+}
+
+/*!
+    \brief      stop streaming compare values, the last value keeps being output
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void PWM::stopBuffer(void)
+{
+    PWM_stopBuffer(&pwmDevice);
+}
+
+/*!
+    \brief      check if compare values are being streamed
+    \param[in]  none
+    \param[out] none
+    \retval     true while streaming
+*/
+bool PWM::isPlaying(void)
+{
+    return PWM_bufferBusy(&pwmDevice) != 0;
+}
+
+/*!
+    \brief      PWMGroup object construct, all pins must be channels of the same timer
+    \param[in]  pin0..pin3: pins of the group, PWM_GROUP_NO_PIN for unused ones
+    \param[out] none
+    \retval     none
+*/
+PWMGroup::PWMGroup(uint32_t pin0, uint32_t pin1, uint32_t pin2, uint32_t pin3)
+{
+    uint32_t list[PWM_GROUP_MAX_CHANNELS] = {pin0, pin1, pin2, pin3};
+    pwmDevice_t device;
+    PinName name;
+
+    this->timer = 0;
+    this->period = 0;
+    this->count = 0;
+    this->channels = 0;
+    this->valid = true;
+    for (uint8_t i = 0; i < PWM_GROUP_MAX_CHANNELS; i++) {
+        if (list[i] == PWM_GROUP_NO_PIN) {
+            continue;
+        }
+        name = DIGITAL_TO_PINNAME(list[i]);
+        if (!pin_in_pinmap(name, PinMap_PWM)) {
+            this->valid = false;
+            continue;
+        }
+        device = getTimerDeviceFromPinname(name);
+        if ((this->count != 0) && (device.timer != this->timer)) {
+            this->valid = false;
         }
+        if (this->channels & (1U << device.channel)) {
+            this->valid = false;
+        }
+        this->timer = device.timer;
+        this->channels |= (1U << device.channel);
+        this->pins[this->count] = list[i];
+        this->channel[this->count] = device.channel;
+        this->compare[this->count] = 0;
+        this->count++;
+    }
+    if (this->count == 0) {
+        this->valid = false;
+    }
+}
+
+/*!
+    \brief      configure the timer and route the pins, the outputs stay off until start()
+    \param[in]  freq_hz: pwm frequency in Hz
+    \param[in]  centerAligned: center the pulses of all channels on each other
+    \param[out] none
+    \retval     false if the pins are not channels of one timer or freq_hz is out of range
+*/
+bool PWMGroup::begin(uint32_t freq_hz, bool centerAligned)
+{
+    if (!this->valid) {
+        return false;
+    }
+    this->period = PWM_groupInit(this->timer, this->channels, freq_hz, centerAligned);
+    if (this->period == 0) {
+        return false;
+    }
+    for (uint8_t i = 0; i < this->count; i++) {
+        pinmap_pinout(DIGITAL_TO_PINNAME(this->pins[i]), PinMap_PWM);
+    }
+    return true;
+}
+
+/*!
+    \brief      start all outputs of the group
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void PWMGroup::start(void)
+{
+    pwmDevice_t device = {this->timer, 0};
+
+    if (this->period == 0) {
+        return;
+    }
+    for (uint8_t i = 0; i < this->count; i++) {
+        device.channel = this->channel[i];
+        PWM_start(&device);
+    }
+}
+
+/*!
+    \brief      stop all outputs of the group
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void PWMGroup::stop(void)
+{
+    pwmDevice_t device = {this->timer, 0};
+
+    if (this->period == 0) {
+        return;
+    }
+    for (uint8_t i = 0; i < this->count; i++) {
+        device.channel = this->channel[i];
+        PWM_stop(&device);
     }
 }
 
+/*!
+    \brief      get the compare value for 100% duty cycle
+    \param[in]  none
+    \param[out] none
+    \retval     full scale compare value, 0 before begin()
+*/
+uint32_t PWMGroup::getPeriodTicks(void)
+{
+    return this->period;
+}
+
+/*!
+    \brief      get the timer shared by the channels of the group
+    \param[in]  none
+    \param[out] none
+    \retval     TIMERx, 0 if the pins are not on one timer
+*/
+uint32_t PWMGroup::getTimer(void)
+{
+    return this->valid ? this->timer : 0U;
+}
+
+/*!
+    \brief      stage the compare value of a channel, it is applied by commit()
+    \param[in]  index: position of the pin in the constructor
+    \param[in]  ticks: compare value, 0..getPeriodTicks()
+    \param[out] none
+    \retval     none
+*/
+void PWMGroup::setCompare(uint8_t index, uint32_t ticks)
+{
+    if (index >= this->count) {
+        return;
+    }
+    if (ticks > this->period) {
+        ticks = this->period;
+    }
+    this->compare[index] = (ticks > 0xFFFFU) ? 0xFFFFU : ticks;
+}
+
+/*!
+    \brief      stage the duty cycle of a channel, it is applied by commit()
+    \param[in]  index: position of the pin in the constructor
+    \param[in]  duty: duty cycle, 0..65535 for 0..100%
+    \param[out] none
+    \retval     none
+*/
+void PWMGroup::setDuty(uint8_t index, uint16_t duty)
+{
+    setCompare(index, (uint32_t)(((uint64_t)duty * this->period + 32767U) / 65535U));
+}
+
+/*!
+    \brief      write all staged compare values, they take effect together at the next update event
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void PWMGroup::commit(void)
+{
+    uint16_t values[PWM_GROUP_MAX_CHANNELS] = {0};
+
+    if (this->period == 0) {
+        return;
+    }
+    for (uint8_t i = 0; i < this->count; i++) {
+        values[this->channel[i]] = this->compare[i];
+    }
+    PWM_groupWrite(this->timer, this->channels, values);
+}
+
+/*!
+    \brief      enable the complementary output of a channel of the group
+    \param[in]  index: position of the pin in the constructor
+    \param[in]  pin: pin of the complementary output
+    \param[out] none
+    \retval     true if enabled, false if the channel has no complementary output
+*/
+bool PWMGroup::enableComplementary(uint8_t index, uint32_t pin)
+{
+    pwmDevice_t device = {this->timer, 0};
+
+    if (index >= this->count) {
+        return false;
+    }
+    device.channel = this->channel[index];
+    return PWM_enableComplementary(&device, DIGITAL_TO_PINNAME(pin)) != 0;
+}
+
+/*!
+    \brief      set the dead time of the complementary outputs of the group
+    \param[in]  ns: minimum dead time in nanoseconds
+    \param[out] none
+    \retval     dead time actually programmed in nanoseconds, 0 if not supported
+*/
+uint32_t PWMGroup::setDeadTime(uint32_t ns)
+{
+    pwmDevice_t device = {this->timer, 0};
+
+    if (this->count == 0) {
+        return 0;
+    }
+    device.channel = this->channel[0];
+    return PWM_setDeadTime(&device, ns);
+}
@@ -45,12 +45,36 @@ class PWM
                             enum timeFormat format = FORMAT_US);     //set pwm period and cyclye
         void writeCycleValue(uint32_t cycle,
                              enum timeFormat format = FORMAT_US);                   //set pwm cycle time with the inital format
-        void attachInterrupt(pwmCallback_t
-                             callback);                                               //attach callback for capture/compare interrupt
+        void attachInterrupt(pwmCallback_t callback,
+                             bool deferred = false);                                  //attach callback for capture/compare interrupt
         void detachInterrupt(
             void);                                                                 //detach callback for capture/compare interrupt
         void captureCompareCallback(
             void);                                                          //capture/compare callback handler
+        uint32_t setFrequency(
+            uint32_t freq_hz);                                                  //set frequency, returns period in ticks
+        uint32_t getPeriodTicks(
+            void);                                                                  //get period in timer ticks
+        uint32_t getTimer(
+            void);                                                                        //get TIMERx driving the pin
+        bool enableComplementary(
+            uint32_t pin);                                                      //enable complementary output CHx_ON on pin
+        void disableComplementary(
+            void);                                                              //disable complementary output
+        uint32_t setDeadTime(
+            uint32_t ns);                                                       //set dead time, returns programmed ns
+        bool enableBreak(uint32_t pin,
+                         bool activeHigh = false);                              //enable break input on pin
+        void disableBreak(
+            void);                                                                  //disable break input
+        bool clearBreak(
+            void);                                                                   //re-arm outputs after a break
+        bool playBuffer(const uint16_t *buffer, size_t length,
+                        bool loop = false);                                 //stream compare values (in ticks) by DMA, one per period
+        void stopBuffer(
+            void);                                                                      //stop streaming compare values
+        bool isPlaying(
+            void);                                                                       //check if compare values are being streamed
 
     private:
         uint32_t index;
@@ -58,6 +82,49 @@ class PWM
         pwmPeriodCycle_t pwmPeriodCycle;
         pwmDevice_t pwmDevice;
         pwmCallback_t pwmCallback;
+        bool pwmDeferred = false;
+};
+
+#define PWM_GROUP_MAX_CHANNELS  4
+#define PWM_GROUP_NO_PIN        0xFFFFFFFFU
+
+/* Channels of one timer sharing period and alignment, with compare values committed together */
+class PWMGroup
+{
+    public:
+        PWMGroup(uint32_t pin0, uint32_t pin1 = PWM_GROUP_NO_PIN,
+                 uint32_t pin2 = PWM_GROUP_NO_PIN,
+                 uint32_t pin3 = PWM_GROUP_NO_PIN);                          //PWMGroup object construct
+        bool begin(uint32_t freq_hz,
+                   bool centerAligned = true);                                  //configure timer and pins
+        void start(
+            void);                                                                           //start all outputs
+        void stop(
+            void);                                                                            //stop all outputs
+        uint32_t getPeriodTicks(
+            void);                                                                  //get full scale compare value
+        uint32_t getTimer(
+            void);                                                                        //get TIMERx shared by the channels
+        void setCompare(uint8_t index,
+                        uint32_t ticks);                                        //stage compare value of a channel
+        void setDuty(uint8_t index,
+                     uint16_t duty);                                            //stage duty cycle, 0..65535
+        void commit(
+            void);                                                                          //apply staged values at next update
+        bool enableComplementary(uint8_t index,
+                                 uint32_t pin);                                 //enable complementary output of a channel
+        uint32_t setDeadTime(
+            uint32_t ns);                                                       //set dead time, returns programmed ns
+
+    private:
+        uint32_t pins[PWM_GROUP_MAX_CHANNELS];
+        uint8_t channel[PWM_GROUP_MAX_CHANNELS];
+        uint16_t compare[PWM_GROUP_MAX_CHANNELS];
+        uint32_t timer;
+        uint32_t period;
+        uint8_t count;
+        uint8_t channels;
+        bool valid;
 };
 
 extern pwmhandle_t pwmHandle;
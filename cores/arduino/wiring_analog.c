@@ -28,7 +28,7 @@ extern "C" {
 
 static uint32_t analogIn_resolution = 10;
 static uint32_t analogOut_resolution = 8;
-static uint32_t analogOut_period_us = 1000; // 1000µS = 1ms = 1kHz
+static uint32_t analogOut_freq_hz = 1000;
 
 void analogReference(uint8_t mode)
 {
@@ -74,8 +74,8 @@ int analogRead(pin_size_t ulPin)
         if (internalChannel) {
             adc_tempsensor_vrefint_enable();
         }
-        value = get_adc_value(p);
-        value = mapResolution(value, 12, analogIn_resolution);
+        value = internalChannel ? get_adc_value(p) : get_adc_pin_value(ulPin);
+        value = mapResolution(value, get_adc_resolution(), analogIn_resolution);
         if (internalChannel) {
             adc_tempsensor_vrefint_disable();
         }
@@ -106,7 +106,7 @@ void analogWrite(pin_size_t ulPin, int ulValue)
             pinMode(ulPin, OUTPUT);
             digitalWrite(ulPin, HIGH);
         } else {
-            set_pwm_value_with_base_period(ulPin, analogOut_period_us, value);
+            set_pwm_value_with_frequency(ulPin, analogOut_freq_hz, value);
         }
     } else {
         // Defaults to digital write
@@ -128,6 +128,107 @@ void analogReadResolution(int res)
     } else {
         analogIn_resolution = 8;
     }
+    /* convert no finer than needed, fewer bits convert faster */
+    set_adc_resolution(analogIn_resolution);
+}
+
+//analog input sample time of one pin, ADC_SAMPLETIME_x
+void analogReadSampleTime(uint32_t ulPin, uint32_t sample_time)
+{
+    set_adc_sample_time((pin_size_t)ulPin, sample_time);
+}
+
+//analog input clock, RCU_CKADC_CKAPB2_DIVx (GD32F30x/E50x) or RCU_ADCCK_APB2_DIVx
+void analogReadClockPrescaler(uint32_t prescaler)
+{
+    set_adc_clock_prescaler(prescaler);
+}
+
+//average 2^ratio_log2 conversions per analogRead(), shifted right by shift bits
+int analogReadOversampling(uint8_t ratio_log2, uint8_t shift)
+{
+    return set_adc_oversampling(ratio_log2, shift);
+}
+
+static analogReadCallback_t analogIn_async_callback = NULL;
+
+//arg carries the pin number given to analogReadAsync()
+static void analogReadAsyncIrq(void *arg, uint16_t value)
+{
+    if (analogIn_async_callback != NULL) {
+        analogIn_async_callback((uint32_t)(uintptr_t)arg,
+                                mapResolution(value, get_adc_resolution(), analogIn_resolution));
+    }
+}
+
+//start converting a pin, returns 0 if the pin has no adc channel or a conversion is still pending
+int analogReadStart(uint32_t ulPin)
+{
+    if ((ulPin == ADC_TEMP) || (ulPin == ADC_VREF) || (DIGITAL_TO_PINNAME(ulPin) == NC)) {
+        return 0;
+    }
+    pinMode(ulPin, INPUT_ANALOG);
+    return adc_async_start((pin_size_t)ulPin, NULL, NULL);
+}
+
+//check if the conversion started by analogReadStart() has finished
+int analogReadReady(void)
+{
+    return adc_async_ready();
+}
+
+//get the result of analogReadStart(), waits for the conversion if it is still running
+int analogReadResult(void)
+{
+    return mapResolution(adc_async_result(), get_adc_resolution(), analogIn_resolution);
+}
+
+//start converting a pin, callback gets the result from the adc interrupt
+int analogReadAsync(uint32_t ulPin, analogReadCallback_t callback)
+{
+    if ((callback == NULL) || (ulPin == ADC_TEMP) || (ulPin == ADC_VREF)
+            || (DIGITAL_TO_PINNAME(ulPin) == NC)) {
+        return 0;
+    }
+    pinMode(ulPin, INPUT_ANALOG);
+    analogIn_async_callback = callback;
+    return adc_async_start((pin_size_t)ulPin, analogReadAsyncIrq, (void *)(uintptr_t)ulPin);
+}
+
+static analogWatchdogCallback_t analogIn_watchdog_callback = NULL;
+
+//arg carries the pin number given to analogWatchdog()
+static void analogWatchdogIrq(void *arg)
+{
+    if (analogIn_watchdog_callback != NULL) {
+        analogIn_watchdog_callback((uint32_t)(uintptr_t)arg);
+    }
+}
+
+//watch a pin in hardware, callback runs once when its value leaves low..high
+int analogWatchdog(uint32_t ulPin, uint32_t low, uint32_t high, analogWatchdogCallback_t callback)
+{
+    if ((ulPin == ADC_TEMP) || (ulPin == ADC_VREF) || (DIGITAL_TO_PINNAME(ulPin) == NC)) {
+        return 0;
+    }
+    pinMode(ulPin, INPUT_ANALOG);
+    analogIn_watchdog_callback = callback;
+    /* the window is compared with the 12-bit conversion result */
+    return adc_watchdog_start((pin_size_t)ulPin, (uint16_t)mapResolution(low, analogIn_resolution, 12),
+                              (uint16_t)mapResolution(high, analogIn_resolution, 12),
+                              analogWatchdogIrq, (void *)(uintptr_t)ulPin);
+}
+
+//stop the watchdog of a pin, analogRead() can use its ADC again
+void analogWatchdogEnd(uint32_t ulPin)
+{
+    adc_watchdog_stop((pin_size_t)ulPin);
+}
+
+//end analogRead() on the ADC of a pin, the ADC is switched off and its clock gated until the next read
+void analogReadEnd(uint32_t ulPin)
+{
+    adc_single_stop((pin_size_t)ulPin);
 }
 
 //analog output resolution
@@ -140,8 +241,12 @@ void analogWriteResolution(int res)
     }
 }
 
-void analogWriteFrequency(uint32_t freq_hz) {
-    analogOut_period_us = 1000000U / freq_hz ;
+//default pwm frequency of pins without their own analogWriteFrequency(pin, hz)
+void analogWriteFrequency(uint32_t freq_hz)
+{
+    if (freq_hz != 0) {
+        analogOut_freq_hz = freq_hz;
+    }
 }
 
 #ifdef __cplusplus
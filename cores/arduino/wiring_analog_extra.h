@@ -8,12 +8,37 @@ extern "C" {
 #endif
 
 void analogReadResolution(int res);
+/* per pin sample time, ADC_SAMPLETIME_x */
+void analogReadSampleTime(uint32_t pin, uint32_t sample_time);
+/* ADC clock, RCU_CKADC_CKAPB2_DIVx on GD32F30x/E50x, RCU_ADCCK_APB2_DIVx elsewhere */
+void analogReadClockPrescaler(uint32_t prescaler);
+/* hardware oversampling, ratio_log2 0 turns it off. Returns 0 if the series has no oversampler */
+int analogReadOversampling(uint8_t ratio_log2, uint8_t shift);
+/* non-blocking analogRead(), one conversion at a time. Internal channels are not supported */
+typedef void (*analogReadCallback_t)(uint32_t pin, int value);
+int analogReadStart(uint32_t pin);
+int analogReadReady(void);
+int analogReadResult(void);
+/* callback runs in the ADC interrupt with the result scaled like analogRead() */
+int analogReadAsync(uint32_t pin, analogReadCallback_t callback);
+/* hardware window comparator, low and high scaled like analogRead(). The callback runs once
+ * from the ADC interrupt when the pin leaves the window, call analogWatchdog() again to re-arm */
+typedef void (*analogWatchdogCallback_t)(uint32_t pin);
+int analogWatchdog(uint32_t pin, uint32_t low, uint32_t high, analogWatchdogCallback_t callback);
+void analogWatchdogEnd(uint32_t pin);
+/* switch the ADC of a pin off and gate its clock until the next analogRead() on it, it stays
+ * on while a scan, the inserted group or a watchdog still uses it */
+void analogReadEnd(uint32_t pin);
 
 void analogWriteResolution(int res);
 void analogWriteFrequency(uint32_t freq_hz);
 
 #ifdef __cplusplus
 }
+
+/* Pins on the same timer share one frequency, the last one set wins. 0 restores the default.
+ * Arduino.h includes this header inside extern "C", so the overload has to ask for C++ linkage. */
+extern "C++" void analogWriteFrequency(uint32_t pin, uint32_t freq_hz);
 #endif
 
 #endif /* _WIRING_ANALOG_EXTRA_H */
\ No newline at end of file
@@ -24,61 +24,147 @@
 extern "C" {
 #endif
 
-void pinMode(pin_size_t ulPin, PinMode ulMode)
+extern const int GD_GPIO_MODE[];
+extern const int GD_GPIO_SPEED[];
+#if defined(GD32F3x0) || defined(GD32F1x0) || defined(GD32E23x)
+extern const int GD_GPIO_PULL_UP_DOWN[];
+extern const int GD_GPIO_OUTPUT_MODE[];
+#endif
+
+#if defined(GD32F3x0)
+#define PINMODE_OSPD(gpio)      GPIO_OSPD0(gpio)
+#elif defined(GD32F1x0) || defined(GD32E23x)
+#define PINMODE_OSPD(gpio)      GPIO_OSPD(gpio)
+#endif
+
+//pin_function() setting of a pinMode() mode, -1 if the mode is unknown
+static int pinmode_function(PinMode ulMode)
 {
-    PinName p = DIGITAL_TO_PINNAME(ulPin);
     switch (ulMode) {
         case INPUT:
         #if defined(GD32F30x) || defined(GD32F10x)|| defined(GD32E50X)
-            pin_function(p, GD_PIN_FUNCTION3(PIN_MODE_IN_FLOATING, 0, 0));
+            return GD_PIN_FUNCTION3(PIN_MODE_IN_FLOATING, 0, 0);
         #else
-            pin_function(p, GD_PIN_FUNCTION3(PIN_MODE_INPUT, 0, 0));
+            return GD_PIN_FUNCTION3(PIN_MODE_INPUT, 0, 0);
         #endif
-            break;
         case INPUT_PULLUP:
             // different chip series have different APIs and options for pin modes
             // for one, we have "Input pullup" as a mode, for the other, we have
             // "Input" as a mode with "Pullup"/"Pulldown" as a "pull mode".
             // transport the information to the underlying function accordingly. 
         #if defined(GD32F30x) || defined(GD32F10x)|| defined(GD32E50X)
-            pin_function(p, GD_PIN_FUNCTION3(PIN_MODE_IPU, 0, 0));
+            return GD_PIN_FUNCTION3(PIN_MODE_IPU, 0, 0);
         #else
-            pin_function(p, GD_PIN_FUNCTION4(PIN_MODE_INPUT, 0, PIN_PUPD_PULLUP, 0));
+            return GD_PIN_FUNCTION4(PIN_MODE_INPUT, 0, PIN_PUPD_PULLUP, 0);
         #endif
-            break;
         case INPUT_PULLDOWN:
         #if defined(GD32F30x) || defined(GD32F10x)|| defined(GD32E50X)
-            pin_function(p, GD_PIN_FUNCTION3(PIN_MODE_IPD, 0, 0));
+            return GD_PIN_FUNCTION3(PIN_MODE_IPD, 0, 0);
         #else
-            pin_function(p, GD_PIN_FUNCTION4(PIN_MODE_INPUT, 0, PIN_PUPD_PULLDOWN, 0));
+            return GD_PIN_FUNCTION4(PIN_MODE_INPUT, 0, PIN_PUPD_PULLDOWN, 0);
         #endif
-            break;
         case OUTPUT:
         #if defined(GD32F30x) || defined(GD32F10x)|| defined(GD32E50X)
-            pin_function(p, GD_PIN_FUNCTION3(PIN_MODE_OUT_PP, PIN_OTYPE_PP, 0));
+            return GD_PIN_FUNCTION3(PIN_MODE_OUT_PP, PIN_OTYPE_PP, 0);
         #else
-            pin_function(p, GD_PIN_FUNCTION3(PIN_MODE_OUTPUT, PIN_OTYPE_PP, 0));
+            return GD_PIN_FUNCTION3(PIN_MODE_OUTPUT, PIN_OTYPE_PP, 0);
         #endif
-            break;
 #pragma GCC diagnostic ignored "-Wswitch"
         case INPUT_ANALOG: // From PinModeExtension
         #if defined(GD32F30x) || defined(GD32F10x)|| defined(GD32E50X)
-            pin_function(p, GD_PIN_FUNCTION3(PIN_MODE_AIN, 0, 0));
+            return GD_PIN_FUNCTION3(PIN_MODE_AIN, 0, 0);
         #else
-            pin_function(p, GD_PIN_FUNCTION3(PIN_MODE_ANALOG, 0, 0));
+            return GD_PIN_FUNCTION3(PIN_MODE_ANALOG, 0, 0);
         #endif
-            break;
 #pragma GCC diagnostic ignored "-Wswitch"
         case OUTPUT_OPEN_DRAIN: // From PinModeExtension
         #if defined(GD32F30x) || defined(GD32F10x)|| defined(GD32E50X)
-            pin_function(p, GD_PIN_FUNCTION3(PIN_MODE_OUT_OD, PIN_OTYPE_OD, 0));
+            return GD_PIN_FUNCTION3(PIN_MODE_OUT_OD, PIN_OTYPE_OD, 0);
         #else
-            pin_function(p, GD_PIN_FUNCTION3(PIN_MODE_OUTPUT, PIN_OTYPE_OD, 0));
+            return GD_PIN_FUNCTION3(PIN_MODE_OUTPUT, PIN_OTYPE_OD, 0);
         #endif
-            break;
         default:
-            break;
+            return -1;
+    }
+}
+
+
+/* mode of every pin whose pinmode_configured bit is set */
+static uint8_t pinmode_cache[GPIO_PORT_NUM][16];
+
+//reprogram the mode of a pin whose clock and alternate function are already set up, writing
+//the registers of that pin only instead of going through the SPL, which loops over all 16 pins
+static void pinmode_switch(PinName p, int function)
+{
+    uint32_t gpio = gpio_port[GD_PORT_GET(p)];
+    uint32_t index = GD_PIN_GET(p);
+    uint32_t gpio_mode = (uint32_t)GD_GPIO_MODE[GD_PIN_MODE_GET(function)];
+    uint32_t speed = (uint32_t)GD_GPIO_SPEED[GD_PIN_SPEED_GET(function)];
+
+#if defined(GPIO_OSPEED_MAX)
+    if (GPIO_OSPEED_MAX == speed) {
+        /* needs the extra speed register, leave it to the SPL */
+        pin_function(p, function);
+        return;
+    }
+#endif
+#if defined(GD32F30x) || defined(GD32F10x)|| defined(GD32E50X)
+    uint32_t ctl = gpio_mode & 0x0FU;
+    volatile uint32_t *reg = (index < 8U) ? &GPIO_CTL0(gpio) : &GPIO_CTL1(gpio);
+
+    if (0U != (gpio_mode & 0x10U)) {
+        ctl |= speed;
+    }
+    /* the pull direction of IPU/IPD is the output latch */
+    if (GPIO_MODE_IPD == gpio_mode) {
+        GPIO_BC(gpio) = gpio_pin[index];
+    } else if (GPIO_MODE_IPU == gpio_mode) {
+        GPIO_BOP(gpio) = gpio_pin[index];
+    }
+    *reg = (*reg & ~GPIO_MODE_MASK(index & 7U)) | GPIO_MODE_SET(index & 7U, ctl);
+#else
+    uint32_t pull = (uint32_t)GD_GPIO_PULL_UP_DOWN[GD_PIN_PULL_STATE_GET(function)];
+
+    /* output type and speed go first so the pin never drives with stale options */
+    if (GPIO_MODE_OUTPUT == gpio_mode) {
+        if (GPIO_OTYPE_OD == GD_GPIO_OUTPUT_MODE[GD_PIN_OUTPUT_MODE_GET(function)]) {
+            GPIO_OMODE(gpio) |= gpio_pin[index];
+        } else {
+            GPIO_OMODE(gpio) &= ~gpio_pin[index];
+        }
+        PINMODE_OSPD(gpio) = (PINMODE_OSPD(gpio) & ~GPIO_OSPEED_MASK(index)) | GPIO_OSPEED_SET(index, speed);
+    }
+    GPIO_PUD(gpio) = (GPIO_PUD(gpio) & ~GPIO_PUPD_MASK(index)) | GPIO_PUPD_SET(index, pull);
+    GPIO_CTL(gpio) = (GPIO_CTL(gpio) & ~GPIO_MODE_MASK(index)) | GPIO_MODE_SET(index, gpio_mode);
+#endif
+}
+
+void pinMode(pin_size_t ulPin, PinMode ulMode)
+{
+    PinName p = DIGITAL_TO_PINNAME(ulPin);
+    int function = pinmode_function(ulMode);
+
+    if (function < 0) {
+        return;
+    }
+    if ((PinName)NC == p) {
+        /* reports the bad pin */
+        pin_function(p, function);
+        return;
+    }
+    uint8_t cached = pinmode_cache[GD_PORT_GET(p)][GD_PIN_GET(p)];
+    /* a pin moving to or from analog changes whether its port needs the clock, pin_function() counts that */
+    if (CHECK_PIN_STATE(p, pinmode_configured) &&
+            ((cached == (uint8_t)INPUT_ANALOG) == ((uint8_t)ulMode == (uint8_t)INPUT_ANALOG))) {
+        /* bidirectional protocols flip INPUT/OUTPUT every bit, skip everything that is already done */
+        if (cached != (uint8_t)ulMode) {
+            pinmode_switch(p, function);
+        }
+    } else {
+        pin_function(p, function);
     }
+    pinmode_cache[GD_PORT_GET(p)][GD_PIN_GET(p)] = (uint8_t)ulMode;
+    SET_PIN_STATE(p, pinmode_configured);
 }
 
 void digitalWrite(pin_size_t ulPin, PinStatus status)
@@ -97,12 +183,44 @@ PinStatus digitalRead(pin_size_t ulPin)
     return (int)gpio_input_bit_get(port, pin);
 }
 
+//toggle the output latch (not the input level) of a pin with a single register store
 void digitalToggle(pin_size_t ulPin)
 {
     PinName pinname = DIGITAL_TO_PINNAME(ulPin);
     uint32_t pin =  gpio_pin[GD_PIN_GET(pinname)];
     uint32_t port = gpio_port[GD_PORT_GET(pinname)];
-    gpio_bit_write(port, pin, (bit_status)(1 - (int)gpio_input_bit_get(port, pin)));
+    port_toggle(port, pin);
+}
+
+//write the bits of value selected by mask to a port in one store, other pins of the port keep their state
+void portWrite(PortName port, uint16_t mask, uint16_t value)
+{
+    uint32_t gpio_periph;
+
+    if ((uint32_t)port >= GPIO_PORT_NUM) {
+        return;
+    }
+    gpio_periph = gpio_port[port];
+    if (gpio_periph == 0U) {
+        return;
+    }
+    /* the upper half of the bit operation register clears, the lower half sets */
+    GPIO_BOP(gpio_periph) = ((uint32_t)(~value & mask) << 16) | (uint32_t)(value & mask);
+}
+
+//read the input levels of all pins of a port
+uint16_t portRead(PortName port)
+{
+    uint32_t gpio_periph;
+
+    if ((uint32_t)port >= GPIO_PORT_NUM) {
+        return 0;
+    }
+    gpio_periph = gpio_port[port];
+    if (gpio_periph == 0U) {
+        return 0;
+    }
+    return (uint16_t)GPIO_ISTAT(gpio_periph);
 }
 
 const uint32_t gpio_port[] = {
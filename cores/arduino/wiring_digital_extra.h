@@ -3,12 +3,33 @@
 
 #include "gd32/PinConfigured.h"
 #include "gd32/PinNames.h"
+#include "gd32/PortNames.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 void digitalToggle(pin_size_t ulPin);
+/* Parallel access to the 16 pins of a GPIO port, e.g. portWrite(PORTB, 0x00FF, data) drives
+ * PB0..PB7 in a single atomic store. The pins have to be set up with pinMode() first */
+void portWrite(PortName port, uint16_t mask, uint16_t value);
+uint16_t portRead(PortName port);
+/* Cycle count (see getCurrentCycles()) latched on entry of the interrupt that serviced the last
+ * edge of an attachInterrupt() pin. Divide differences by SystemCoreClock for seconds */
+uint32_t interruptTimestamp(pin_size_t pin);
+/* NVIC preemption priority of the EXTI vector of a pin, 0 to 15 (0 to 3 on GD32E23x), lower is
+ * more urgent; the default is IRQ_PRIO_EXTI (gd32/irq_priority.h). Pins on a shared vector
+ * (e.g. lines 10..15) all get the new priority */
+void setInterruptPriority(pin_size_t pin, uint8_t priority);
+void attachInterruptPriority(pin_size_t pin, voidFuncPtr callback, PinStatus mode, uint8_t priority);
+/* Like attachInterrupt(), but the interrupt only queues the callback, which then runs at
+ * thread level in the order the edges came in (see gd32/deferred.h) */
+void attachInterruptDeferred(pin_size_t pin, voidFuncPtr callback, PinStatus mode);
+/* Install callback straight into the vector table of irq, which moves to RAM for this. The
+ * callback replaces the core's handler, so it must clear the peripheral's flags itself; see
+ * gd32/vectors.h. detachVector() puts the core's handler back */
+void attachVector(IRQn_Type irq, voidFuncPtr callback);
+void detachVector(IRQn_Type irq);
 
 
 #if defined(GD32F30x) || defined(GD32F10x)|| defined(GD32E50X)
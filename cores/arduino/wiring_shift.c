@@ -17,26 +17,150 @@
 */
 
 #include "Arduino.h"
+#include "gd32/PinConfigured.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* highest clock shiftIn()/shiftOut() drive when their pins belong to an SPI peripheral */
+#ifndef SHIFT_SPI_MAX_HZ
+#define SHIFT_SPI_MAX_HZ    4000000U
+#endif
+
+/* the SPI peripheral shiftIn()/shiftOut() routed their pins to last */
+typedef struct {
+    uint32_t spi;
+    PinName data;
+    PinName clock;
+    uint8_t input;
+    BitOrder order;
+} shift_spi_t;
+
+/* a read back of the port stalls until the previous store has reached the pin, it keeps clock
+   pulses and data setup of the GPIO loop above the ~20ns that shift registers need */
+#define SHIFT_GPIO_SETTLE(port)     ((void)GPIO_ISTAT(port))
+
+static shift_spi_t shift_spi = {(uint32_t)NC, NC, NC, 0, MSBFIRST};
+
+//clock enable and input clock of an SPI peripheral, 0 if it does not exist
+static uint32_t shift_spi_clock(uint32_t spi)
+{
+    switch (spi) {
+        case SPI0:
+            rcu_periph_clock_enable(RCU_SPI0);
+            return rcu_clock_freq_get(CK_APB2);
+        case SPI1:
+            rcu_periph_clock_enable(RCU_SPI1);
+            return rcu_clock_freq_get(CK_APB1);
+#ifdef SPI2
+        case SPI2:
+            rcu_periph_clock_enable(RCU_SPI2);
+            return rcu_clock_freq_get(CK_APB1);
+#endif
+        default:
+            return 0;
+    }
+}
+
+//Route data and clock pin to their SPI peripheral if they have one, the pins stay routed until
+//pinMode() is called on them. Mode 0 matches the bit timing of shiftOut(), mode 1 (sampling on
+//the falling edge) the one of shiftIn(). Returns the SPI, or NC to fall back to the GPIO loop
+static uint32_t shift_spi_get(pin_size_t ulDataPin, pin_size_t ulClockPin, BitOrder ulBitOrder,
+                              uint8_t input)
+{
+    PinName data = DIGITAL_TO_PINNAME(ulDataPin);
+    PinName clock = DIGITAL_TO_PINNAME(ulClockPin);
+    const PinMap *map = input ? PinMap_SPI_MISO : PinMap_SPI_MOSI;
+    spi_parameter_struct spi_init_struct;
+    uint32_t spi;
+    uint32_t spi_clock;
+    uint32_t prescale;
+
+    if ((NC == data) || (NC == clock)) {
+        return (uint32_t)NC;
+    }
+    spi = pinmap_merge(pinmap_peripheral(data, map), pinmap_peripheral(clock, PinMap_SPI_SCLK));
+    if ((uint32_t)NC == spi) {
+        return (uint32_t)NC;
+    }
+    if ((spi == shift_spi.spi) && (data == shift_spi.data) && (clock == shift_spi.clock) &&
+            (input == shift_spi.input) && (ulBitOrder == shift_spi.order) &&
+            !CHECK_PIN_STATE(data, pinmode_configured) && !CHECK_PIN_STATE(clock, pinmode_configured)) {
+        return spi;
+    }
+    spi_clock = shift_spi_clock(spi);
+    /* the SPI library has the peripheral */
+    if ((0U == spi_clock) || ((spi != shift_spi.spi) && (SPI_CTL0(spi) & SPI_CTL0_SPIEN))) {
+        return (uint32_t)NC;
+    }
+    for (prescale = 0U; (prescale < 7U) && ((spi_clock >> (prescale + 1U)) > SHIFT_SPI_MAX_HZ); prescale++) {
+    }
+
+    spi_disable(spi);
+    spi_struct_para_init(&spi_init_struct);
+    spi_init_struct.trans_mode = SPI_TRANSMODE_FULLDUPLEX;
+    spi_init_struct.device_mode = SPI_MASTER;
+    spi_init_struct.frame_size = SPI_FRAMESIZE_8BIT;
+    spi_init_struct.clock_polarity_phase = input ? SPI_CK_PL_LOW_PH_2EDGE : SPI_CK_PL_LOW_PH_1EDGE;
+    spi_init_struct.nss = SPI_NSS_SOFT;
+    spi_init_struct.prescale = CTL0_PSC(prescale);
+    spi_init_struct.endian = (ulBitOrder == LSBFIRST) ? SPI_ENDIAN_LSB : SPI_ENDIAN_MSB;
+    spi_init(spi, &spi_init_struct);
+    pinmap_pinout(data, map);
+    pinmap_pinout(clock, PinMap_SPI_SCLK);
+    spi_enable(spi);
+
+    shift_spi.spi = spi;
+    shift_spi.data = data;
+    shift_spi.clock = clock;
+    shift_spi.input = input;
+    shift_spi.order = ulBitOrder;
+    return spi;
+}
+
+//clock one byte through the SPI, returns the byte shifted in
+static uint8_t shift_spi_transfer(uint32_t spi, uint8_t value)
+{
+    while (RESET == spi_i2s_flag_get(spi, SPI_FLAG_TBE)) {
+    }
+    spi_i2s_data_transmit(spi, value);
+    /* receiving the byte means it has been clocked out completely */
+    while (RESET == spi_i2s_flag_get(spi, SPI_FLAG_RBNE)) {
+    }
+    return (uint8_t)spi_i2s_data_receive(spi);
+}
+
 uint8_t shiftIn(pin_size_t ulDataPin, pin_size_t ulClockPin, BitOrder ulBitOrder)
 {
+    uint32_t spi = shift_spi_get(ulDataPin, ulClockPin, ulBitOrder, 1U);
     uint8_t value = 0 ;
     uint8_t i ;
 
+    if ((uint32_t)NC != spi) {
+        return shift_spi_transfer(spi, 0xFFU);
+    }
+
+    /* port and mask once, not per bit */
+    uint32_t data_port = DIGITAL_PIN_TO_PORT(ulDataPin);
+    uint32_t data_mask = DIGITAL_PIN_TO_BIT_MASK(ulDataPin);
+    uint32_t clock_port = DIGITAL_PIN_TO_PORT(ulClockPin);
+    uint32_t clock_mask = DIGITAL_PIN_TO_BIT_MASK(ulClockPin);
+
+    if ((0U == data_port) || (0U == clock_port)) {
+        return 0;
+    }
     for (i = 0 ; i < 8 ; ++i) {
-        digitalWrite(ulClockPin, HIGH) ;
+        GPIO_BOP(clock_port) = clock_mask;
+        SHIFT_GPIO_SETTLE(clock_port);
 
         if (ulBitOrder == LSBFIRST) {
-            value |= digitalRead(ulDataPin) << i ;
+            value |= ((GPIO_ISTAT(data_port) & data_mask) ? 1U : 0U) << i ;
         } else {
-            value |= digitalRead(ulDataPin) << (7 - i) ;
+            value |= ((GPIO_ISTAT(data_port) & data_mask) ? 1U : 0U) << (7 - i) ;
         }
 
-        digitalWrite(ulClockPin, LOW) ;
+        GPIO_BOP(clock_port) = clock_mask << 16;
     }
 
     return value ;
@@ -44,17 +168,37 @@ uint8_t shiftIn(pin_size_t ulDataPin, pin_size_t ulClockPin, BitOrder ulBitOrder
 
 void shiftOut(pin_size_t ulDataPin, pin_size_t ulClockPin, BitOrder ulBitOrder, uint8_t ulVal)
 {
+    uint32_t spi = shift_spi_get(ulDataPin, ulClockPin, ulBitOrder, 0U);
     uint8_t i ;
 
+    if ((uint32_t)NC != spi) {
+        shift_spi_transfer(spi, ulVal);
+        return;
+    }
+
+    /* port and mask once, not per bit */
+    uint32_t data_port = DIGITAL_PIN_TO_PORT(ulDataPin);
+    uint32_t data_mask = DIGITAL_PIN_TO_BIT_MASK(ulDataPin);
+    uint32_t clock_port = DIGITAL_PIN_TO_PORT(ulClockPin);
+    uint32_t clock_mask = DIGITAL_PIN_TO_BIT_MASK(ulClockPin);
+
+    if ((0U == data_port) || (0U == clock_port)) {
+        return;
+    }
     for (i = 0 ; i < 8 ; i++) {
+        uint32_t bit;
+
         if (ulBitOrder == LSBFIRST) {
-            digitalWrite(ulDataPin, !!(ulVal & (1 << i))) ;
+            bit = ulVal & (1 << i);
         } else {
-            digitalWrite(ulDataPin, !!(ulVal & (1 << (7 - i)))) ;
+            bit = ulVal & (1 << (7 - i));
         }
+        GPIO_BOP(data_port) = bit ? data_mask : (data_mask << 16);
+        SHIFT_GPIO_SETTLE(data_port);
 
-        digitalWrite(ulClockPin, HIGH) ;
-        digitalWrite(ulClockPin, LOW) ;
+        GPIO_BOP(clock_port) = clock_mask;
+        SHIFT_GPIO_SETTLE(clock_port);
+        GPIO_BOP(clock_port) = clock_mask << 16;
     }
 }
 
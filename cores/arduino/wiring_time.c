@@ -35,16 +35,67 @@ uint32_t micros(void)
     return getCurrentMicros();
 }
 
+uint64_t millis64(void)
+{
+    return getCurrentMillis64();
+}
+
+uint64_t micros64(void)
+{
+    return getCurrentMicros64();
+}
+
+/* sleep until the next interrupt, SysTick ends it within a millisecond */
+void delayIdleWfi(void)
+{
+    __WFI();
+}
+void delay_idle(void) __attribute__((weak, alias("delayIdleWfi")));
+
 void delay(uint32_t ms)
 {
     if (ms != 0) {
         uint32_t start = getCurrentMillis();
         do {
-            __NOP();
+            yield();
+            delay_idle();
         } while (getCurrentMillis() - start < ms);
     }
 }
 
+/* free running CPU cycle counter, wraps every 2^32 cycles */
+uint32_t cycles(void)
+{
+    return getCurrentCycles();
+}
+
+#if CLOCK_SET_SYSTEM
+bool setSystemClock(uint32_t hz, clock_source_t source)
+{
+    return clock_set_system(hz, source);
+}
+#endif
+
+#if defined(DWT_CTRL_CYCCNTENA_Msk)
+/* long delays are waited out in pieces so that the cycle count fits in 32 bits */
+#define DELAY_US_CHUNK 1000000U
+
+void delayMicroseconds(unsigned int us)
+{
+    uint32_t start = DWT->CYCCNT;
+    const uint32_t cyclesPerUs = SystemCoreClock / 1000000U;
+
+    while (us > DELAY_US_CHUNK) {
+        while ((DWT->CYCCNT - start) < (DELAY_US_CHUNK * cyclesPerUs)) {
+        }
+        start += DELAY_US_CHUNK * cyclesPerUs;
+        us -= DELAY_US_CHUNK;
+    }
+    const uint32_t nbCycles = us * cyclesPerUs;
+    while ((DWT->CYCCNT - start) < nbCycles) {
+    }
+}
+#else
 void delayMicroseconds(unsigned int us)
 {
     __IO uint32_t currentTicks = SysTick->VAL;
@@ -62,6 +113,7 @@ void delayMicroseconds(unsigned int us)
         oldTicks = currentTicks;
     } while (nbTicks > elapsedTicks);
 }
+#endif
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,37 @@
+#ifndef _WIRING_TIME_EXTRA_H
+#define _WIRING_TIME_EXTRA_H
+
+#include <stdint.h>
+#include "gd32/clock.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* millis() and micros() extended to 64 bits, so they never wrap. Safe to call from interrupts
+ * and with interrupts masked */
+uint64_t millis64(void);
+uint64_t micros64(void);
+
+/* CPU cycle counter for cheap timestamping, wraps every 2^32 cycles. Backed by the DWT on
+ * Cortex-M3/M4/M33 parts and derived from SysTick on GD32E23x */
+uint32_t cycles(void);
+
+/* Called by delay() between calls to yield() while it waits. It executes WFI, so the core
+ * sleeps until the next interrupt; define it as an empty function to spin instead, e.g. if
+ * a debugger loses the connection during WFI */
+void delay_idle(void);
+
+#if CLOCK_SET_SYSTEM
+/* Switch the system clock to hz, made from source through the PLL where needed. millis(),
+ * serial baud rates and timer periods set with setPeriodTime() follow; PWM frequencies and
+ * timer prescalers set by hand do not. Fails while USB is in use. Only declared where
+ * CLOCK_SET_SYSTEM is 1, GD32F30x for now */
+bool setSystemClock(uint32_t hz, clock_source_t source);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _WIRING_TIME_EXTRA_H */
@@ -0,0 +1,55 @@
+/*
+  Two coroutines sharing loop(): one reads a temperature sensor (an
+  LM75 at I2C address 0x48) every second, the other echoes lines typed
+  on Serial1 back in upper case. Neither blocks; each waits with
+  co_await while the I2C interrupt or the receive ring does the work.
+
+  Needs Tools > C++ standard > GNU C++20 and a GCC 10 or later
+  toolchain.
+*/
+#include <Wire.h>
+
+#if !ASYNC_COROUTINES
+#error "select Tools > C++ standard > GNU C++20, with GCC 10 or later"
+#endif
+
+AsyncTask readTemperature(void)
+{
+    const uint8_t reg = 0x00;
+    uint8_t value[2];
+
+    for (;;) {
+        uint8_t status = co_await Wire.transferAsync(0x48, &reg, 1, value, 2);
+        if (status == 0) {
+            Serial1.print("temperature ");
+            Serial1.println((int16_t)((value[0] << 8) | value[1]) / 256.0f);
+        } else {
+            Serial1.print("sensor error ");
+            Serial1.println(status);
+        }
+        co_await asyncDelay(1000);
+    }
+}
+
+AsyncTask echo(void)
+{
+    uint8_t c;
+
+    for (;;) {
+        co_await Serial1.readAsync(&c, 1);
+        Serial1.write(toupper(c));
+    }
+}
+
+void setup()
+{
+    Serial1.begin(115200);
+    Wire.begin();
+    Async.spawn(readTemperature());
+    Async.spawn(echo());
+}
+
+void loop()
+{
+    Async.poll();
+}
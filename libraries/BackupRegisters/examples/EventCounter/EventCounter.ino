@@ -0,0 +1,36 @@
+/*
+  Count button presses and restarts in backup registers, which keep
+  them through resets and standby, and through power loss with a
+  battery on VBAT. Every press is saved at once, there is no flash
+  to wear out.
+*/
+#include <BackupRegisters.h>
+
+#define BUTTON_PIN      PA0
+#define PRESSES         0
+#define RESTARTS        1
+
+bool wasPressed = false;
+
+void setup()
+{
+    Serial.begin(115200);
+    pinMode(BUTTON_PIN, INPUT_PULLUP);
+    BackupRegisters.begin();
+
+    Serial.print("restart ");
+    Serial.print(BackupRegisters.increment(RESTARTS));
+    Serial.print(", presses so far ");
+    Serial.println(BackupRegisters.read(PRESSES));
+}
+
+void loop()
+{
+    bool pressed = digitalRead(BUTTON_PIN) == LOW;
+
+    if (pressed && !wasPressed) {
+        Serial.println(BackupRegisters.increment(PRESSES));
+    }
+    wasPressed = pressed;
+    delay(20);
+}
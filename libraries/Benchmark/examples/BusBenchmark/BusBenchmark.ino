@@ -0,0 +1,79 @@
+/*
+  SPI and Wire benchmark
+
+  SPI block transfers at a few clocks, nothing needs to be connected. The
+  Wire figures time a one-byte write and a 16-byte read of the device at
+  DEVICE_ADDRESS (an AT24C EEPROM by default); with no device answering
+  they show how long a NACK takes to come back.
+*/
+
+#include <Benchmark.h>
+#include <SPI.h>
+#include <Wire.h>
+
+#define BLOCK_SIZE      256
+#define DEVICE_ADDRESS  0x50
+
+Benchmark bench(Serial);
+static uint8_t block[BLOCK_SIZE];
+
+static const uint32_t spiClocks[] = {1000000, 8000000, 18000000};
+
+static void benchSpiByte(void)
+{
+    (void)SPI.transfer(0x55);
+}
+
+static void benchWireWrite(void)
+{
+    Wire.beginTransmission(DEVICE_ADDRESS);
+    Wire.write(0);
+    (void)Wire.endTransmission();
+}
+
+static void benchWireRead(void)
+{
+    (void)Wire.requestFrom((uint8_t)DEVICE_ADDRESS, (uint8_t)16);
+    while (Wire.available()) {
+        (void)Wire.read();
+    }
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    while (!Serial) {
+    }
+    delay(100);
+
+    bench.begin("SPI and Wire");
+    SPI.begin();
+    for (uint8_t i = 0; i < sizeof(spiClocks) / sizeof(spiClocks[0]); i++) {
+        char name[32];
+
+        SPI.beginTransaction(SPISettings(spiClocks[i], MSBFIRST, SPI_MODE0));
+        snprintf(name, sizeof(name), "SPI.transfer %lu Hz", (unsigned long)spiClocks[i]);
+        bench.run(name, benchSpiByte);
+        uint32_t start = cycles();
+        SPI.transfer(block, BLOCK_SIZE);
+        uint32_t spent = cycles() - start;
+        snprintf(name, sizeof(name), "SPI block %lu Hz", (unsigned long)spiClocks[i]);
+        bench.rate(name, BLOCK_SIZE, spent);
+        SPI.endTransaction();
+    }
+    SPI.end();
+
+    Wire.begin();
+    Wire.setClock(100000);
+    bench.run("Wire write 1 byte 100 kHz", benchWireWrite, 4);
+    bench.run("Wire read 16 bytes 100 kHz", benchWireRead, 4);
+    Wire.setClock(400000);
+    bench.run("Wire write 1 byte 400 kHz", benchWireWrite, 4);
+    bench.run("Wire read 16 bytes 400 kHz", benchWireRead, 4);
+    Wire.beginTransmission(DEVICE_ADDRESS);
+    Serial.println(Wire.endTransmission() == 0 ? "device answered" : "no device, NACK timings");
+}
+
+void loop()
+{
+}
@@ -0,0 +1,129 @@
+/*
+  Core benchmark
+
+  Cycle counts of the GPIO, ADC and PWM calls and the latency from raising
+  an EXTI line or a timer update to the start of its interrupt and to the
+  attached callback. The EXTI line is raised in software, nothing needs to
+  be wired; the analog input reads whatever is on A0. The timer figures
+  borrow TIMER_TONE, so don't run tone() alongside.
+*/
+
+#include <Benchmark.h>
+#include <FastPin.h>
+#include <HardwareTimer.h>
+
+#define LATENCY_RUNS    16
+
+Benchmark bench(Serial);
+HardwareTimer timer(TIMER_TONE);
+
+static volatile uint32_t raised;
+static volatile uint32_t handled;
+
+static void benchDigitalWrite(void)
+{
+    digitalWrite(LED_BUILTIN, HIGH);
+}
+
+static void benchDigitalRead(void)
+{
+    (void)digitalRead(LED_BUILTIN);
+}
+
+static void benchDigitalToggle(void)
+{
+    digitalToggle(LED_BUILTIN);
+}
+
+static void benchFastPin(void)
+{
+    FastDigitalPin<LED_BUILTIN>::high();
+}
+
+static void benchAnalogRead(void)
+{
+    (void)analogRead(A0);
+}
+
+static void benchAnalogWrite(void)
+{
+    analogWrite(PWM0, 128);
+}
+
+static void onInterrupt(void)
+{
+    handled = cycles();
+}
+
+/* best case of LATENCY_RUNS, from raise() to entry of the vector and to the callback */
+static void latency(const char *entry, const char *callback, void (*raise)(void), uint32_t (*stamp)(void))
+{
+    uint32_t bestEntry = 0xFFFFFFFFU;
+    uint32_t bestCallback = 0xFFFFFFFFU;
+
+    for (uint8_t i = 0; i < LATENCY_RUNS; i++) {
+        handled = 0;
+        raise();
+        while (handled == 0) {
+        }
+        if (stamp != NULL) {
+            bestEntry = min(bestEntry, stamp() - raised);
+        }
+        bestCallback = min(bestCallback, handled - raised);
+    }
+    if (stamp != NULL) {
+        bench.row(entry, bestEntry);
+    } else {
+        bench.skip(entry, "n/a");
+    }
+    bench.row(callback, bestCallback);
+}
+
+static void raiseExti(void)
+{
+    raised = cycles();
+    exti_software_interrupt_enable((exti_line_enum)BIT(GD_PIN_GET(DIGITAL_TO_PINNAME(LED_BUILTIN))));
+}
+
+static uint32_t extiEntry(void)
+{
+    return interruptTimestamp(LED_BUILTIN);
+}
+
+static void raiseTimer(void)
+{
+    raised = cycles();
+    timer_event_software_generate(TIMER_TONE, TIMER_EVENT_SRC_UPG);
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    while (!Serial) {
+    }
+    delay(100);
+
+    bench.begin("Core");
+    pinMode(LED_BUILTIN, OUTPUT);
+    bench.run("digitalWrite", benchDigitalWrite);
+    bench.run("digitalRead", benchDigitalRead);
+    bench.run("digitalToggle", benchDigitalToggle);
+    bench.run("FastDigitalPin::high", benchFastPin);
+    bench.run("analogRead", benchAnalogRead, 20);
+    bench.run("analogWrite", benchAnalogWrite);
+
+    attachInterrupt(LED_BUILTIN, onInterrupt, RISING);
+    latency("EXTI entry", "EXTI callback", raiseExti, extiEntry);
+    detachInterrupt(LED_BUILTIN);
+
+    /* a long period, so only the software update event fires in between */
+    timer.setPeriodTime(1000, FORMAT_MS);
+    timer.attachInterrupt(onInterrupt);
+    timer.start();
+    latency("timer entry", "timer callback", raiseTimer, NULL);
+    timer.stop();
+}
+
+void loop()
+{
+}
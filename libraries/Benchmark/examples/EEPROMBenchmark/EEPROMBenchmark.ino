@@ -0,0 +1,46 @@
+/*
+  EEPROM benchmark
+
+  Cost of EEPROM.write() into the RAM copy and of EEPROM.commit() putting
+  a few changed bytes and then every byte into flash. Each run wears the
+  flash page, don't leave it in a loop.
+*/
+
+#include <Benchmark.h>
+#include <EEPROM.h>
+
+Benchmark bench(Serial);
+
+void setup()
+{
+    Serial.begin(115200);
+    while (!Serial) {
+    }
+    delay(100);
+
+    bench.begin("EEPROM");
+    EEPROM.begin();
+
+    uint8_t seed = EEPROM.read(0) + 1;
+    uint32_t start = cycles();
+    EEPROM.write(0, seed);
+    bench.row("EEPROM.write", cycles() - start);
+
+    for (uint32_t i = 1; i < 4; i++) {
+        EEPROM.write(i, seed);
+    }
+    start = cycles();
+    EEPROM.commit();
+    bench.row("EEPROM.commit 4 bytes", cycles() - start);
+
+    for (uint32_t i = 0; i < EEPROM.length(); i++) {
+        EEPROM.write(i, seed + i);
+    }
+    start = cycles();
+    EEPROM.commit();
+    bench.row("EEPROM.commit all bytes", cycles() - start);
+}
+
+void loop()
+{
+}
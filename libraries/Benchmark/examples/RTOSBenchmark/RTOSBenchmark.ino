@@ -0,0 +1,84 @@
+/*
+  FreeRTOS benchmark
+
+  Two tasks of the same priority hand a task notification back and forth;
+  every hand-over is one give and one context switch. Also times a yield
+  with nothing else ready and a queue send/receive without blocking.
+*/
+
+#include <Benchmark.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+
+#define ROUNDS          1000
+#define STACK_SIZE      256
+#define PRIORITY        2
+
+Benchmark bench(Serial);
+static StaticTask_t pingBuffer;
+static StaticTask_t pongBuffer;
+static StackType_t pingStack[STACK_SIZE];
+static StackType_t pongStack[STACK_SIZE];
+static TaskHandle_t ping;
+static TaskHandle_t pong;
+static StaticQueue_t queueBuffer;
+static uint8_t queueStorage[sizeof(uint32_t)];
+static QueueHandle_t queue;
+
+static void benchYield(void)
+{
+    taskYIELD();
+}
+
+static void benchQueue(void)
+{
+    uint32_t value = 0;
+
+    xQueueSend(queue, &value, 0);
+    xQueueReceive(queue, &value, 0);
+}
+
+static void pongTask(void *arg)
+{
+    (void)arg;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        xTaskNotifyGive(ping);
+    }
+}
+
+static void pingTask(void *arg)
+{
+    (void)arg;
+    bench.begin("FreeRTOS");
+    bench.run("taskYIELD, nothing else ready", benchYield);
+    bench.run("queue send + receive", benchQueue);
+
+    pong = xTaskCreateStatic(pongTask, "pong", STACK_SIZE, NULL, PRIORITY, pongStack, &pongBuffer);
+    uint32_t start = cycles();
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+        xTaskNotifyGive(pong);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    bench.row("notify + context switch", (cycles() - start) / (2U * ROUNDS));
+    while (true) {
+        vTaskDelay(portMAX_DELAY);
+    }
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    while (!Serial) {
+    }
+    delay(100);
+
+    queue = xQueueCreateStatic(1, sizeof(uint32_t), queueStorage, &queueBuffer);
+    ping = xTaskCreateStatic(pingTask, "ping", STACK_SIZE, NULL, PRIORITY, pingStack, &pingBuffer);
+    vTaskStartScheduler();
+}
+
+void loop()
+{
+}
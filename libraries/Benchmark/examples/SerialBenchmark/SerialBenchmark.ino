@@ -0,0 +1,68 @@
+/*
+  Serial benchmark
+
+  Time to send a block through Serial2 at several baud rates, until the
+  last stop bit is out, against the ideal time on the wire. TX2 needs no
+  connection. Built with USB CDC as Serial (USB support menu), the same
+  block is also written to the host, which must have the port open.
+*/
+
+#include <Benchmark.h>
+
+#define BLOCK_SIZE      1024
+
+Benchmark bench(Serial);
+static uint8_t block[BLOCK_SIZE];
+
+static const uint32_t bauds[] = {115200, 460800, 921600, 2000000};
+
+void setup()
+{
+    Serial.begin(115200);
+    while (!Serial) {
+    }
+    delay(100);
+
+    for (uint32_t i = 0; i < BLOCK_SIZE; i++) {
+        block[i] = (uint8_t)i;
+    }
+
+    bench.begin("Serial");
+#if defined(HAVE_HWSERIAL2)
+    for (uint8_t i = 0; i < sizeof(bauds) / sizeof(bauds[0]); i++) {
+        char name[32];
+
+        Serial2.begin(bauds[i]);
+        uint32_t start = cycles();
+        Serial2.write(block, BLOCK_SIZE);
+        Serial2.flush();
+        uint32_t spent = cycles() - start;
+        Serial2.end();
+
+        snprintf(name, sizeof(name), "Serial2 %lu baud", (unsigned long)bauds[i]);
+        bench.rate(name, BLOCK_SIZE, spent);
+        /* 10 bits per character on the wire */
+        snprintf(name, sizeof(name), "  wire limit");
+        bench.rate(name, BLOCK_SIZE, (uint32_t)((uint64_t)BLOCK_SIZE * 10U * SystemCoreClock / bauds[i]));
+    }
+#else
+    bench.skip("Serial2", "no Serial2");
+#endif
+
+#if defined(USBD_USE_CDC)
+    {
+        uint32_t start = cycles();
+        for (uint8_t i = 0; i < 16; i++) {
+            Serial.write(block, BLOCK_SIZE);
+        }
+        Serial.flush();
+        bench.rate("USB CDC", 16U * BLOCK_SIZE, cycles() - start);
+    }
+#else
+    bench.skip("USB CDC", "USB off");
+#endif
+}
+
+void loop()
+{
+}
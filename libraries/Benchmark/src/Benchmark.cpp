@@ -0,0 +1,89 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "Benchmark.h"
+
+static void benchmark_empty(void)
+{
+}
+
+Benchmark::Benchmark(Print &out) : out(out), overhead(0U)
+{
+}
+
+void Benchmark::begin(const char *title)
+{
+    overhead = 0U;
+    overhead = measure(benchmark_empty, 100U);
+
+    out.printf("\n%s, %lu MHz\n", title, (unsigned long)(SystemCoreClock / 1000000U));
+    out.printf("%-32s %12s %12s\n", "test", "cycles", "ns / KB/s");
+}
+
+uint32_t Benchmark::measure(void (*fn)(void), uint32_t count)
+{
+    uint32_t best = 0xFFFFFFFFU;
+
+    if (count == 0U) {
+        return 0U;
+    }
+    for (uint8_t batch = 0U; batch < BENCHMARK_BATCHES; batch++) {
+        uint32_t start = cycles();
+        for (uint32_t i = 0U; i < count; i++) {
+            fn();
+        }
+        uint32_t each = (cycles() - start) / count;
+        if (each < best) {
+            best = each;
+        }
+    }
+    return (best > overhead) ? (best - overhead) : 0U;
+}
+
+void Benchmark::run(const char *name, void (*fn)(void), uint32_t count)
+{
+    row(name, measure(fn, count));
+}
+
+void Benchmark::row(const char *name, uint32_t cycles)
+{
+    uint32_t ns = (uint32_t)((uint64_t)cycles * 1000000000U / SystemCoreClock);
+
+    out.printf("%-32s %12lu %12lu\n", name, (unsigned long)cycles, (unsigned long)ns);
+}
+
+void Benchmark::rate(const char *name, uint32_t bytes, uint32_t cycles)
+{
+    uint32_t kbps = (cycles == 0U) ? 0U : (uint32_t)((uint64_t)bytes * SystemCoreClock / cycles / 1024U);
+
+    out.printf("%-32s %12lu %12lu\n", name, (unsigned long)cycles, (unsigned long)kbps);
+}
+
+void Benchmark::skip(const char *name, const char *why)
+{
+    out.printf("%-32s %12s %12s\n", name, "-", why);
+}
@@ -0,0 +1,58 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "Arduino.h"
+
+/* batches measure() takes the best of */
+#ifndef BENCHMARK_BATCHES
+#define BENCHMARK_BATCHES   5
+#endif
+
+/* Table of cycle counts for the benchmark sketches. Every figure comes from cycles() (the
+   DWT cycle counter, SysTick on GD32E23x) and is the best of BENCHMARK_BATCHES batches, so an
+   interrupt landing in one batch doesn't skew it, less the cost of the call through the
+   function pointer. One row per figure, to diff runs across series and core versions */
+class Benchmark
+{
+    public:
+        Benchmark(Print &out);                                                    //Benchmark object construct
+        void begin(const char *title);                                           //print the heading, calibrate
+        uint32_t measure(void (*fn)(void), uint32_t count);                      //best cycles per call of fn
+        void run(const char *name, void (*fn)(void), uint32_t count = 100);      //measure and print a row
+        void row(const char *name, uint32_t cycles);                             //print cycles and ns
+        void rate(const char *name, uint32_t bytes, uint32_t cycles);            //print KB/s
+        void skip(const char *name, const char *why);                            //print why there is no figure
+
+    private:
+        Print &out;
+        uint32_t overhead;
+};
+
+#endif /* BENCHMARK_H */
@@ -0,0 +1,51 @@
+/*
+  CAN filter
+
+  Runs CAN0 at 1 Mbit/s in loopback mode, so it needs no transceiver, and
+  takes only identifiers 0x100 to 0x10F and the extended identifier 0x18DAF110
+  from the bus. Frames to other identifiers are dropped by the hardware filters
+  and never reach the CPU.
+*/
+
+#include <CAN.h>
+
+uint32_t sent = 0;
+
+void setup()
+{
+    Serial.begin(115200);
+    if (!CAN.begin(1000000, CAN_BUS_LOOPBACK)) {
+        Serial.println("CAN bitrate not possible with this clock");
+        while (1);
+    }
+    CAN.filter(0, 0x100, 0x7F0);
+    CAN.filterList(1, 0x18DAF110, 0x18DAF110, true);
+}
+
+void loop()
+{
+    CANMessage msg;
+
+    msg.id = 0x0FC + (sent % 24);
+    msg.extended = false;
+    msg.remote = false;
+    msg.length = 4;
+    memcpy(msg.data, &sent, 4);
+    if (CAN.write(msg)) {
+        sent++;
+    }
+
+    while (CAN.read(msg)) {
+        Serial.print("0x");
+        Serial.print(msg.id, HEX);
+        Serial.print(" [");
+        Serial.print(msg.length);
+        Serial.print("]");
+        for (uint8_t i = 0; i < msg.length; i++) {
+            Serial.print(" ");
+            Serial.print(msg.data[i], HEX);
+        }
+        Serial.println();
+    }
+    delay(100);
+}
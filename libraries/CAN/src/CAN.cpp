@@ -0,0 +1,541 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "CAN.h"
+
+#if defined(GD32F30x) || defined(GD32E50X)
+
+#if defined(GD32F30X_CL) || defined(GD32E50X_CL) || defined(GD32E508)
+#define CAN_TX_IRQN             CAN0_TX_IRQn
+#else
+/* shared with the USBD high priority interrupt */
+#define CAN_TX_IRQN             USBD_HP_CAN0_TX_IRQn
+#define CAN_TX_IRQ_SHARED       1
+#endif
+
+#if defined(GD32E50X)
+#define CAN_FILTER_INIT(f)      can_filter_init(CAN0, (f))
+#else
+#define CAN_FILTER_INIT(f)      can_filter_init((f))
+#endif
+
+/* time quanta per bit tried, the bit segment 1 takes at most 16 of them */
+#define CAN_TQ_MAX              19U
+#define CAN_TQ_MIN              8U
+
+HardwareCAN CAN;
+
+/* the first CAN0 pin of a pin map */
+static PinName canDefaultPin(const PinMap *map)
+{
+    for (; map->pin != NC; map++) {
+        if (map->peripheral == (int)CAN0) {
+            return map->pin;
+        }
+    }
+    return NC;
+}
+
+/* bit timing with the sample point near 87.5%, as many time quanta as the clock divides into */
+static bool canBitTiming(uint32_t clock, uint32_t bitrate, can_parameter_struct *param)
+{
+    uint32_t tq, bs1, bs2, sjw;
+
+    if (bitrate == 0U) {
+        return false;
+    }
+    for (tq = CAN_TQ_MAX; tq >= CAN_TQ_MIN; tq--) {
+        if ((clock % (bitrate * tq)) != 0U) {
+            continue;
+        }
+        if ((clock / (bitrate * tq)) > 1024U) {
+            break;
+        }
+        /* one quantum of synchronization segment comes first */
+        bs1 = (tq * 7U + 4U) / 8U - 1U;
+        bs2 = tq - 1U - bs1;
+        sjw = (bs2 < 4U) ? bs2 : 4U;
+        param->prescaler = clock / (bitrate * tq);
+        param->time_segment_1 = bs1 - 1U;
+        param->time_segment_2 = bs2 - 1U;
+        param->resync_jump_width = sjw - 1U;
+        return true;
+    }
+    return false;
+}
+
+/* filter register value of an identifier, 32-bit scale */
+static uint32_t canFilterId(uint32_t id, bool extended)
+{
+    if (extended) {
+        return ((id & CAN_EXTENDED_ID_MASK) << 3) | CAN_FF_EXTENDED;
+    }
+    return (id & CAN_STANDARD_ID_MASK) << 21;
+}
+
+/*!
+    \brief      HardwareCAN object construct
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+HardwareCAN::HardwareCAN(void)
+{
+    this->rxPin = NC;
+    this->txPin = NC;
+    this->running = false;
+    this->acceptAll = true;
+    this->rxHead = 0;
+    this->rxTail = 0;
+    this->txHead = 0;
+    this->txTail = 0;
+    this->lost = 0;
+    this->callback = NULL;
+    this->callbackArg = NULL;
+}
+
+/*!
+    \brief      use other pins than the first CAN0 ones of PinMap_CAN_RD and PinMap_CAN_TD
+    \param[in]  rx: receive pin
+    \param[in]  tx: transmit pin
+    \param[out] none
+    \retval     none
+*/
+void HardwareCAN::setPins(uint32_t rx, uint32_t tx)
+{
+    this->rxPin = DIGITAL_TO_PINNAME(rx);
+    this->txPin = DIGITAL_TO_PINNAME(tx);
+}
+
+/*!
+    \brief      start CAN0 and take every frame until a filter is set
+    \param[in]  bitrate: bits per second, the APB1 clock must divide into 8 to 19 time quanta of it
+    \param[in]  mode: CAN_BUS_NORMAL, CAN_BUS_LOOPBACK, CAN_BUS_SILENT or CAN_BUS_SILENT_LOOPBACK
+    \param[out] none
+    \retval     false if the pins aren't CAN0 pins or the bitrate can't be set
+*/
+bool HardwareCAN::begin(uint32_t bitrate, can_bus_mode_t mode)
+{
+    can_parameter_struct param;
+
+    if (this->running) {
+        end();
+    }
+    if (this->rxPin == NC) {
+        this->rxPin = canDefaultPin(PinMap_CAN_RD);
+        this->txPin = canDefaultPin(PinMap_CAN_TD);
+    }
+    if ((pinmap_peripheral(this->rxPin, PinMap_CAN_RD) != CAN0)
+            || (pinmap_peripheral(this->txPin, PinMap_CAN_TD) != CAN0)) {
+        return false;
+    }
+    can_struct_para_init(CAN_INIT_STRUCT, &param);
+    if (!canBitTiming(rcu_clock_freq_get(CK_APB1), bitrate, &param)) {
+        return false;
+    }
+    param.working_mode = (uint8_t)mode;
+    param.time_triggered = DISABLE;
+    param.auto_bus_off_recovery = ENABLE;
+    param.auto_wake_up = DISABLE;
+    param.auto_retrans = ENABLE;
+    param.rec_fifo_overwrite = DISABLE;
+    /* mailboxes go out in the order they were filled, so queued frames keep theirs */
+    param.trans_fifo_order = ENABLE;
+
+    rcu_periph_clock_enable(RCU_CAN0);
+    can_deinit(CAN0);
+    if (SUCCESS != can_init(CAN0, &param)) {
+        rcu_periph_clock_disable(RCU_CAN0);
+        return false;
+    }
+    pinmap_pinout(this->rxPin, PinMap_CAN_RD);
+    pinmap_pinout(this->txPin, PinMap_CAN_TD);
+
+    this->rxHead = this->rxTail = 0;
+    this->txHead = this->txTail = 0;
+    this->lost = 0;
+    this->running = true;
+    clearFilters();
+
+    can_interrupt_enable(CAN0, CAN_INT_RFNE1 | CAN_INT_RFO1 | CAN_INT_TME);
+    irq_priority_enable(CAN0_RX1_IRQn, IRQ_PRIO_CAN);
+    irq_priority_enable(CAN_TX_IRQN, IRQ_PRIO_CAN);
+    return true;
+}
+
+/*!
+    \brief      stop CAN0, frames not sent yet are dropped
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void HardwareCAN::end(void)
+{
+    if (!this->running) {
+        return;
+    }
+    can_interrupt_disable(CAN0, CAN_INT_RFNE1 | CAN_INT_RFO1 | CAN_INT_TME);
+    nvic_irq_disable(CAN0_RX1_IRQn);
+#if !defined(CAN_TX_IRQ_SHARED) || !defined(USBCON)
+    nvic_irq_disable(CAN_TX_IRQN);
+#endif
+    this->running = false;
+    can_deinit(CAN0);
+    rcu_periph_clock_disable(RCU_CAN0);
+    pin_function(this->rxPin, GD_PIN_FUNCTION1(PIN_MODE_IN_FLOATING, 0));
+    pin_function(this->txPin, GD_PIN_FUNCTION1(PIN_MODE_IN_FLOATING, 0));
+}
+
+void HardwareCAN::filterConfig(uint8_t bank, uint32_t high, uint32_t low, bool list, bool enable)
+{
+    can_filter_parameter_struct filter;
+
+    can_struct_para_init(CAN_FILTER_STRUCT, &filter);
+    filter.filter_number = bank;
+    filter.filter_mode = list ? CAN_FILTERMODE_LIST : CAN_FILTERMODE_MASK;
+    filter.filter_bits = CAN_FILTERBITS_32BIT;
+    filter.filter_list_high = (uint16_t)(high >> 16);
+    filter.filter_list_low = (uint16_t)high;
+    filter.filter_mask_high = (uint16_t)(low >> 16);
+    filter.filter_mask_low = (uint16_t)low;
+    filter.filter_fifo_number = CAN_FIFO1;
+    filter.filter_enable = enable ? ENABLE : DISABLE;
+    CAN_FILTER_INIT(&filter);
+}
+
+/*!
+    \brief      take the frames whose identifier equals id in the bits set in mask,
+                the first filter ends taking every frame
+    \param[in]  bank: filter bank, 0 to CAN_FILTER_BANKS - 1
+    \param[in]  id: identifier
+    \param[in]  mask: identifier bits compared
+    \param[in]  extended: true for 29-bit identifiers, false for 11-bit ones
+    \param[out] none
+    \retval     false if CAN isn't started or the bank doesn't exist
+*/
+bool HardwareCAN::filter(uint8_t bank, uint32_t id, uint32_t mask, bool extended)
+{
+    if (!this->running || (bank >= CAN_FILTER_BANKS)) {
+        return false;
+    }
+    if (this->acceptAll) {
+        this->acceptAll = false;
+        if (bank != 0U) {
+            filterConfig(0, 0, 0, false, false);
+        }
+    }
+    /* the frame format always has to match */
+    filterConfig(bank, canFilterId(id, extended), canFilterId(mask, extended) | CAN_FF_EXTENDED, false, true);
+    return true;
+}
+
+/*!
+    \brief      take the data frames of exactly two identifiers, the first filter ends
+                taking every frame
+    \param[in]  bank: filter bank, 0 to CAN_FILTER_BANKS - 1
+    \param[in]  id1: identifier
+    \param[in]  id2: identifier, id1 again for a single one
+    \param[in]  extended: true for 29-bit identifiers, false for 11-bit ones
+    \param[out] none
+    \retval     false if CAN isn't started or the bank doesn't exist
+*/
+bool HardwareCAN::filterList(uint8_t bank, uint32_t id1, uint32_t id2, bool extended)
+{
+    if (!this->running || (bank >= CAN_FILTER_BANKS)) {
+        return false;
+    }
+    if (this->acceptAll) {
+        this->acceptAll = false;
+        if (bank != 0U) {
+            filterConfig(0, 0, 0, false, false);
+        }
+    }
+    filterConfig(bank, canFilterId(id1, extended), canFilterId(id2, extended), true, true);
+    return true;
+}
+
+/*!
+    \brief      remove all filters and take every frame
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void HardwareCAN::clearFilters(void)
+{
+    uint8_t bank;
+
+    if (!this->running) {
+        return;
+    }
+    for (bank = 1U; bank < CAN_FILTER_BANKS; bank++) {
+        filterConfig(bank, 0, 0, false, false);
+    }
+    filterConfig(0, 0, 0, false, true);
+    this->acceptAll = true;
+}
+
+/* put a frame in a free mailbox, false if all three are busy */
+bool HardwareCAN::transmit(const CANMessage &msg)
+{
+    can_trasnmit_message_struct tx;
+
+    can_struct_para_init(CAN_TX_MESSAGE_STRUCT, &tx);
+    if (msg.extended) {
+        tx.tx_efid = msg.id & CAN_EXTENDED_ID_MASK;
+        tx.tx_ff = CAN_FF_EXTENDED;
+    } else {
+        tx.tx_sfid = msg.id & CAN_STANDARD_ID_MASK;
+        tx.tx_ff = CAN_FF_STANDARD;
+    }
+    tx.tx_ft = msg.remote ? CAN_FT_REMOTE : CAN_FT_DATA;
+    tx.tx_dlen = (msg.length > 8U) ? 8U : msg.length;
+    memcpy(tx.tx_data, msg.data, tx.tx_dlen);
+    return can_message_transmit(CAN0, &tx) != CAN_NOMAILBOX;
+}
+
+/*!
+    \brief      send a frame, or queue it behind the busy mailboxes
+    \param[in]  msg: frame, length 0 to 8
+    \param[out] none
+    \retval     false if CAN isn't started or the queue is full
+*/
+bool HardwareCAN::write(const CANMessage &msg)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint16_t next;
+    bool queued = false;
+
+    if (!this->running) {
+        return false;
+    }
+    __disable_irq();
+    /* frames already queued go first */
+    if ((this->txHead == this->txTail) && transmit(msg)) {
+        queued = true;
+    } else {
+        next = (this->txHead + 1U) % CAN_TX_QUEUE_SIZE;
+        if (next != this->txTail) {
+            this->txQueue[this->txHead] = msg;
+            this->txHead = next;
+            queued = true;
+        }
+    }
+    __set_PRIMASK(primask);
+    return queued;
+}
+
+/*!
+    \brief      get the number of frames write() still queues
+    \param[in]  none
+    \param[out] none
+    \retval     free queue entries
+*/
+int HardwareCAN::availableForWrite(void)
+{
+    return (CAN_TX_QUEUE_SIZE - 1) - ((this->txHead + CAN_TX_QUEUE_SIZE - this->txTail) % CAN_TX_QUEUE_SIZE);
+}
+
+/*!
+    \brief      take the oldest frame received
+    \param[in]  none
+    \param[out] msg: frame
+    \retval     false if none is waiting
+*/
+bool HardwareCAN::read(CANMessage &msg)
+{
+    if (this->rxHead == this->rxTail) {
+        return false;
+    }
+    msg = this->rxBuffer[this->rxTail];
+    this->rxTail = (this->rxTail + 1U) % CAN_RX_BUFFER_SIZE;
+    return true;
+}
+
+/*!
+    \brief      get the number of frames waiting for read()
+    \param[in]  none
+    \param[out] none
+    \retval     frames received
+*/
+int HardwareCAN::available(void)
+{
+    return (this->rxHead + CAN_RX_BUFFER_SIZE - this->rxTail) % CAN_RX_BUFFER_SIZE;
+}
+
+/*!
+    \brief      call back from the receive interrupt after frames were buffered
+    \param[in]  callback: function called, NULL for none
+    \param[in]  arg: passed through to callback
+    \param[out] none
+    \retval     none
+*/
+void HardwareCAN::onReceive(CANReceiveCallback callback, void *arg)
+{
+    this->callback = NULL;
+    this->callbackArg = arg;
+    this->callback = callback;
+}
+
+/*!
+    \brief      get the number of frames lost because the receive buffer or FIFO was full
+    \param[in]  none
+    \param[out] none
+    \retval     frames lost since begin()
+*/
+uint32_t HardwareCAN::dropped(void)
+{
+    return this->lost;
+}
+
+/*!
+    \brief      check if too many transmit errors took CAN0 off the bus, it comes back by itself
+                after 128 times 11 recessive bits
+    \param[in]  none
+    \param[out] none
+    \retval     true while bus-off
+*/
+bool HardwareCAN::isBusOff(void)
+{
+    return this->running && (SET == can_flag_get(CAN0, CAN_FLAG_BOERR));
+}
+
+/*!
+    \brief      get the receive error counter
+    \param[in]  none
+    \param[out] none
+    \retval     0 to 255
+*/
+uint8_t HardwareCAN::receiveErrors(void)
+{
+    return this->running ? can_receive_error_number_get(CAN0) : 0U;
+}
+
+/*!
+    \brief      get the transmit error counter
+    \param[in]  none
+    \param[out] none
+    \retval     0 to 255
+*/
+uint8_t HardwareCAN::transmitErrors(void)
+{
+    return this->running ? can_transmit_error_number_get(CAN0) : 0U;
+}
+
+/*!
+    \brief      move the frames of receive FIFO 1 to the buffer, called from its interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void HardwareCAN::rxIrq(void)
+{
+    can_receive_message_struct rx;
+    CANMessage *msg;
+    uint16_t next;
+    bool received = false;
+
+    while (can_receive_message_length_get(CAN0, CAN_FIFO1) > 0U) {
+        can_message_receive(CAN0, CAN_FIFO1, &rx);
+        next = (this->rxHead + 1U) % CAN_RX_BUFFER_SIZE;
+        if (next == this->rxTail) {
+            this->lost++;
+            continue;
+        }
+        msg = &this->rxBuffer[this->rxHead];
+        msg->extended = (rx.rx_ff == CAN_FF_EXTENDED);
+        msg->id = msg->extended ? rx.rx_efid : rx.rx_sfid;
+        msg->remote = (rx.rx_ft == CAN_FT_REMOTE);
+        msg->length = (rx.rx_dlen > 8U) ? 8U : rx.rx_dlen;
+        memcpy(msg->data, rx.rx_data, msg->length);
+        msg->filter = rx.rx_fi;
+        this->rxHead = next;
+        received = true;
+    }
+    /* the FIFO holds three frames, a fourth one was lost */
+    if (SET == can_interrupt_flag_get(CAN0, CAN_INT_FLAG_RFO1)) {
+        can_interrupt_flag_clear(CAN0, CAN_INT_FLAG_RFO1);
+        this->lost++;
+    }
+    if (received && (this->callback != NULL)) {
+        this->callback(this->callbackArg);
+    }
+}
+
+/*!
+    \brief      refill the mailboxes from the queue, called from the mailbox empty interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void HardwareCAN::txIrq(void)
+{
+    /* the vector may be shared with USBD */
+    if (!this->running) {
+        return;
+    }
+    if (SET == can_interrupt_flag_get(CAN0, CAN_INT_FLAG_MTF0)) {
+        can_interrupt_flag_clear(CAN0, CAN_INT_FLAG_MTF0);
+    }
+    if (SET == can_interrupt_flag_get(CAN0, CAN_INT_FLAG_MTF1)) {
+        can_interrupt_flag_clear(CAN0, CAN_INT_FLAG_MTF1);
+    }
+    if (SET == can_interrupt_flag_get(CAN0, CAN_INT_FLAG_MTF2)) {
+        can_interrupt_flag_clear(CAN0, CAN_INT_FLAG_MTF2);
+    }
+    while ((this->txTail != this->txHead) && transmit(this->txQueue[this->txTail])) {
+        this->txTail = (this->txTail + 1U) % CAN_TX_QUEUE_SIZE;
+    }
+}
+
+extern "C" {
+
+__attribute__((used)) void CAN0_RX1_IRQHandler(void)
+{
+    CAN.rxIrq();
+}
+
+#if !defined(CAN_TX_IRQ_SHARED)
+__attribute__((used)) void CAN0_TX_IRQHandler(void)
+{
+    CAN.txIrq();
+}
+#elif defined(USBCON)
+/* the USB driver owns the vector and calls this */
+void usb_shared_can_tx_irq(void)
+{
+    CAN.txIrq();
+}
+#else
+__attribute__((used)) void USBD_HP_CAN0_TX_IRQHandler(void)
+{
+    CAN.txIrq();
+}
+#endif
+
+}
+
+#endif /* GD32F30x || GD32E50X */
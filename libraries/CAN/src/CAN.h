@@ -0,0 +1,119 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef CAN_H
+#define CAN_H
+
+#include "Arduino.h"
+
+#if defined(GD32F30x) || defined(GD32E50X)
+
+/* frames the receive interrupt can hold until read() */
+#ifndef CAN_RX_BUFFER_SIZE
+#define CAN_RX_BUFFER_SIZE      32
+#endif
+/* frames write() can queue behind the three transmit mailboxes */
+#ifndef CAN_TX_QUEUE_SIZE
+#define CAN_TX_QUEUE_SIZE       16
+#endif
+/* filter banks of CAN0 */
+#define CAN_FILTER_BANKS        14
+
+#define CAN_STANDARD_ID_MASK    0x7FFU
+#define CAN_EXTENDED_ID_MASK    0x1FFFFFFFU
+
+typedef enum {
+    CAN_BUS_NORMAL = 0,
+    CAN_BUS_LOOPBACK,                           /* frames sent are received back, nothing goes to the bus */
+    CAN_BUS_SILENT,                             /* listen only, no ACK and no error frames */
+    CAN_BUS_SILENT_LOOPBACK
+} can_bus_mode_t;
+
+typedef struct {
+    uint32_t id;
+    bool extended;                              /* 29-bit identifier */
+    bool remote;                                /* remote frame, no data */
+    uint8_t length;
+    uint8_t data[8];
+    uint8_t filter;                             /* index of the filter that matched, received frames only */
+} CANMessage;
+
+/* called from the receive interrupt after frames were buffered */
+typedef void (*CANReceiveCallback)(void *arg);
+
+/* CAN0 on interrupts. Frames passing the acceptance filters go to receive FIFO 1, whose
+   interrupt moves them to a ring buffer, so the CPU only sees the frames it asked for.
+   write() fills a free transmit mailbox or queues the frame, the mailbox empty interrupt
+   sends the queue in order. Until the first filter() or filterList() every frame is taken */
+class HardwareCAN
+{
+    public:
+        HardwareCAN(void);                                                        //HardwareCAN object construct
+        void setPins(uint32_t rx, uint32_t tx);                                   //pins other than the first in PinMap_CAN_RD/TD
+        bool begin(uint32_t bitrate = 500000, can_bus_mode_t mode = CAN_BUS_NORMAL); //start at a bitrate
+        void end(void);                                                           //stop and release the pins
+        bool filter(uint8_t bank, uint32_t id, uint32_t mask, bool extended = false); //take ids matching id in the mask bits
+        bool filterList(uint8_t bank, uint32_t id1, uint32_t id2,
+                        bool extended = false);                                   //take exactly two ids
+        void clearFilters(void);                                                  //take every frame again
+        bool write(const CANMessage &msg);                                        //send or queue a frame
+        int availableForWrite(void);                                              //frames write() still takes
+        bool read(CANMessage &msg);                                               //take the oldest frame received
+        int available(void);                                                      //frames waiting for read()
+        void onReceive(CANReceiveCallback callback, void *arg = NULL);             //call back on reception
+        uint32_t dropped(void);                                                   //frames lost to full buffers
+        bool isBusOff(void);                                                      //check for the bus-off state
+        uint8_t receiveErrors(void);                                              //receive error counter
+        uint8_t transmitErrors(void);                                             //transmit error counter
+
+        void rxIrq(void);
+        void txIrq(void);
+
+    private:
+        void filterConfig(uint8_t bank, uint32_t high, uint32_t low, bool list, bool enable);
+        bool transmit(const CANMessage &msg);
+
+        PinName rxPin;
+        PinName txPin;
+        bool running;
+        bool acceptAll;
+        CANMessage rxBuffer[CAN_RX_BUFFER_SIZE];
+        volatile uint16_t rxHead;
+        volatile uint16_t rxTail;
+        CANMessage txQueue[CAN_TX_QUEUE_SIZE];
+        volatile uint16_t txHead;
+        volatile uint16_t txTail;
+        volatile uint32_t lost;
+        CANReceiveCallback callback;
+        void *callbackArg;
+};
+
+extern HardwareCAN CAN;
+
+#endif /* GD32F30x || GD32E50X */
+
+#endif /* CAN_H */
@@ -0,0 +1,58 @@
+/*
+  Vibration FFT
+
+  Samples an accelerometer (or any analog signal) on A0 at 2 kHz, removes
+  the DC offset, applies a Hann window and prints the strongest frequency
+  and its amplitude once per block of 1024 samples. Select the hardware FPU
+  in the Floating point menu for the float math to run on the FPU.
+*/
+
+#include <arm_math.h>
+
+#define FFT_SIZE 1024
+#define SAMPLE_RATE 2000
+
+float32_t samples[FFT_SIZE];
+float32_t window[FFT_SIZE];
+float32_t spectrum[FFT_SIZE];
+float32_t magnitude[FFT_SIZE / 2];
+arm_rfft_fast_instance_f32 fft;
+
+void setup()
+{
+    Serial.begin(115200);
+    arm_rfft_fast_init_f32(&fft, FFT_SIZE);
+    arm_hanning_f32(window, FFT_SIZE);
+}
+
+void loop()
+{
+    uint32_t next = micros();
+    float32_t mean, peak;
+    uint32_t bin;
+
+    for (int i = 0; i < FFT_SIZE; i++) {
+        while ((int32_t)(micros() - next) < 0) {
+        }
+        next += 1000000 / SAMPLE_RATE;
+        samples[i] = analogRead(A0);
+    }
+
+    arm_mean_f32(samples, FFT_SIZE, &mean);
+    for (int i = 0; i < FFT_SIZE; i++) {
+        samples[i] -= mean;
+    }
+    arm_mult_f32(samples, window, samples, FFT_SIZE);
+    arm_rfft_fast_f32(&fft, samples, spectrum, 0);
+    // bin 0 holds DC and Nyquist, both left out of the search
+    spectrum[0] = 0;
+    spectrum[1] = 0;
+    arm_cmplx_mag_f32(spectrum, magnitude, FFT_SIZE / 2);
+    arm_max_f32(magnitude, FFT_SIZE / 2, &peak, &bin);
+
+    Serial.print("peak ");
+    Serial.print((float)bin * SAMPLE_RATE / FFT_SIZE);
+    Serial.print(" Hz, amplitude ");
+    // a Hann window halves the amplitude of a bin-centred tone
+    Serial.println(peak * 4 / FFT_SIZE);
+}
@@ -0,0 +1,189 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef _ARM_MATH_H
+#define _ARM_MATH_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "gd32xxyy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A subset of CMSIS-DSP with its interface, so code written against
+ * arm_math.h builds unchanged as long as it sticks to these functions.
+ *
+ * - Float functions use the FPU when the sketch is built for it (Floating
+ *   point menu, -mfloat-abi=hard); otherwise they run on the soft-float
+ *   library and are correct but slow.
+ * - q15 FIR filters and dot products use the dual 16-bit multiply-accumulate
+ *   instructions (SMLALD) of Cortex-M4 and M33, plain C elsewhere.
+ * - FFTs take 16 to 4096 complex points (32 to 4096 real points) and use
+ *   one 1025-entry cosine table (4 KB of flash) for all lengths. Real FFT
+ *   output is packed like CMSIS: DC and Nyquist real parts first, then
+ *   bins 1 to N/2-1 as real/imaginary pairs.
+ * - FIR coefficients are stored time reversed and biquad a1/a2 are the
+ *   negated feedback coefficients, as in CMSIS.
+ */
+
+typedef float float32_t;
+typedef double float64_t;
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+typedef int64_t q63_t;
+
+typedef enum {
+    ARM_MATH_SUCCESS = 0,
+    ARM_MATH_ARGUMENT_ERROR = -1,
+    ARM_MATH_LENGTH_ERROR = -2,
+    ARM_MATH_SIZE_MISMATCH = -3,
+    ARM_MATH_NANINF = -4,
+    ARM_MATH_SINGULAR = -5,
+    ARM_MATH_TEST_FAILURE = -6
+} arm_status;
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#define ARM_MATH_DSP            1
+#endif
+
+/* transforms */
+typedef struct {
+    uint16_t fftLen;
+    uint16_t twidCoefModifier;  /* table step per twiddle index */
+} arm_cfft_instance_f32;
+
+typedef struct {
+    arm_cfft_instance_f32 Sint; /* the fftLen/2 complex FFT */
+    uint16_t fftLenRFFT;
+    uint16_t twidCoefRModifier;
+} arm_rfft_fast_instance_f32;
+
+arm_status arm_cfft_init_f32(arm_cfft_instance_f32 *S, uint16_t fftLen);
+/* in place on fftLen interleaved real/imaginary pairs; the inverse is
+   scaled by 1/fftLen; bitReverseFlag 0 leaves the output bit reversed */
+void arm_cfft_f32(const arm_cfft_instance_f32 *S, float32_t *p1, uint8_t ifftFlag, uint8_t bitReverseFlag);
+arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32 *S, uint16_t fftLen);
+/* p is used as scratch and overwritten */
+void arm_rfft_fast_f32(const arm_rfft_fast_instance_f32 *S, float32_t *p, float32_t *pOut, uint8_t ifftFlag);
+
+/* filters */
+typedef struct {
+    uint16_t numTaps;
+    float32_t *pState;          /* numTaps + blockSize - 1 */
+    const float32_t *pCoeffs;   /* numTaps, time reversed */
+} arm_fir_instance_f32;
+
+typedef struct {
+    uint16_t numTaps;
+    q15_t *pState;              /* numTaps + blockSize - 1 */
+    const q15_t *pCoeffs;       /* numTaps, time reversed */
+} arm_fir_instance_q15;
+
+typedef struct {
+    uint32_t numStages;
+    float32_t *pState;          /* 4 per stage: x[n-1], x[n-2], y[n-1], y[n-2] */
+    const float32_t *pCoeffs;   /* 5 per stage: b0, b1, b2, a1, a2 */
+} arm_biquad_casd_df1_inst_f32;
+
+typedef struct {
+    uint8_t numStages;
+    float32_t *pState;          /* 2 per stage */
+    const float32_t *pCoeffs;   /* 5 per stage: b0, b1, b2, a1, a2 */
+} arm_biquad_cascade_df2T_instance_f32;
+
+void arm_fir_init_f32(arm_fir_instance_f32 *S, uint16_t numTaps, const float32_t *pCoeffs,
+                      float32_t *pState, uint32_t blockSize);
+void arm_fir_f32(const arm_fir_instance_f32 *S, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+/* numTaps must be even and at least 4 */
+arm_status arm_fir_init_q15(arm_fir_instance_q15 *S, uint16_t numTaps, const q15_t *pCoeffs,
+                            q15_t *pState, uint32_t blockSize);
+void arm_fir_q15(const arm_fir_instance_q15 *S, const q15_t *pSrc, q15_t *pDst, uint32_t blockSize);
+void arm_biquad_cascade_df1_init_f32(arm_biquad_casd_df1_inst_f32 *S, uint8_t numStages,
+                                     const float32_t *pCoeffs, float32_t *pState);
+void arm_biquad_cascade_df1_f32(const arm_biquad_casd_df1_inst_f32 *S, const float32_t *pSrc,
+                                float32_t *pDst, uint32_t blockSize);
+void arm_biquad_cascade_df2T_init_f32(arm_biquad_cascade_df2T_instance_f32 *S, uint8_t numStages,
+                                      const float32_t *pCoeffs, float32_t *pState);
+void arm_biquad_cascade_df2T_f32(const arm_biquad_cascade_df2T_instance_f32 *S, const float32_t *pSrc,
+                                 float32_t *pDst, uint32_t blockSize);
+
+/* matrices, row major */
+typedef struct {
+    uint16_t numRows;
+    uint16_t numCols;
+    float32_t *pData;
+} arm_matrix_instance_f32;
+
+void arm_mat_init_f32(arm_matrix_instance_f32 *S, uint16_t nRows, uint16_t nColumns, float32_t *pData);
+arm_status arm_mat_add_f32(const arm_matrix_instance_f32 *pSrcA, const arm_matrix_instance_f32 *pSrcB,
+                           arm_matrix_instance_f32 *pDst);
+arm_status arm_mat_sub_f32(const arm_matrix_instance_f32 *pSrcA, const arm_matrix_instance_f32 *pSrcB,
+                           arm_matrix_instance_f32 *pDst);
+arm_status arm_mat_scale_f32(const arm_matrix_instance_f32 *pSrc, float32_t scale,
+                             arm_matrix_instance_f32 *pDst);
+arm_status arm_mat_trans_f32(const arm_matrix_instance_f32 *pSrc, arm_matrix_instance_f32 *pDst);
+arm_status arm_mat_mult_f32(const arm_matrix_instance_f32 *pSrcA, const arm_matrix_instance_f32 *pSrcB,
+                            arm_matrix_instance_f32 *pDst);
+/* pSrc is destroyed */
+arm_status arm_mat_inverse_f32(const arm_matrix_instance_f32 *pSrc, arm_matrix_instance_f32 *pDst);
+
+/* vectors and statistics */
+void arm_add_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize);
+void arm_mult_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize);
+void arm_scale_f32(const float32_t *pSrc, float32_t scale, float32_t *pDst, uint32_t blockSize);
+void arm_dot_prod_f32(const float32_t *pSrcA, const float32_t *pSrcB, uint32_t blockSize, float32_t *result);
+/* 34.30 result, no saturation */
+void arm_dot_prod_q15(const q15_t *pSrcA, const q15_t *pSrcB, uint32_t blockSize, q63_t *result);
+void arm_cmplx_mag_f32(const float32_t *pSrc, float32_t *pDst, uint32_t numSamples);
+void arm_cmplx_mag_squared_f32(const float32_t *pSrc, float32_t *pDst, uint32_t numSamples);
+void arm_max_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult, uint32_t *pIndex);
+void arm_mean_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult);
+void arm_rms_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult);
+void arm_hanning_f32(float32_t *pDst, uint32_t blockSize);
+void arm_q15_to_float(const q15_t *pSrc, float32_t *pDst, uint32_t blockSize);
+void arm_float_to_q15(const float32_t *pSrc, q15_t *pDst, uint32_t blockSize);
+
+/* the FPU instruction with -mfloat-abi=hard or softfp */
+static inline arm_status arm_sqrt_f32(float32_t in, float32_t *pOut)
+{
+    if (in >= 0.0f) {
+        *pOut = __builtin_sqrtf(in);
+        return ARM_MATH_SUCCESS;
+    }
+    *pOut = 0.0f;
+    return ARM_MATH_ARGUMENT_ERROR;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ARM_MATH_H */
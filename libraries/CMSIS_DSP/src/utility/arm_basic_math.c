@@ -0,0 +1,167 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "../arm_math.h"
+
+/*!
+    \brief      element-wise sum of two vectors
+    \param[in]  pSrcA: first vector
+    \param[in]  pSrcB: second vector
+    \param[out] pDst: sum, may be a source
+    \param[in]  blockSize: number of elements
+    \retval     none
+*/
+void arm_add_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize)
+{
+    uint32_t i;
+
+    for (i = 0U; i < blockSize; i++) {
+        pDst[i] = pSrcA[i] + pSrcB[i];
+    }
+}
+
+/*!
+    \brief      element-wise product of two vectors, e.g. a window and a block
+    \param[in]  pSrcA: first vector
+    \param[in]  pSrcB: second vector
+    \param[out] pDst: product, may be a source
+    \param[in]  blockSize: number of elements
+    \retval     none
+*/
+void arm_mult_f32(const float32_t *pSrcA, const float32_t *pSrcB, float32_t *pDst, uint32_t blockSize)
+{
+    uint32_t i;
+
+    for (i = 0U; i < blockSize; i++) {
+        pDst[i] = pSrcA[i] * pSrcB[i];
+    }
+}
+
+/*!
+    \brief      multiply a vector by a scalar
+    \param[in]  pSrc: vector
+    \param[in]  scale: factor
+    \param[out] pDst: result, may be pSrc
+    \param[in]  blockSize: number of elements
+    \retval     none
+*/
+void arm_scale_f32(const float32_t *pSrc, float32_t scale, float32_t *pDst, uint32_t blockSize)
+{
+    uint32_t i;
+
+    for (i = 0U; i < blockSize; i++) {
+        pDst[i] = pSrc[i] * scale;
+    }
+}
+
+/*!
+    \brief      dot product of two vectors
+    \param[in]  pSrcA: first vector
+    \param[in]  pSrcB: second vector
+    \param[in]  blockSize: number of elements
+    \param[out] result: the sum of the products
+    \retval     none
+*/
+void arm_dot_prod_f32(const float32_t *pSrcA, const float32_t *pSrcB, uint32_t blockSize, float32_t *result)
+{
+    float32_t acc0 = 0.0f, acc1 = 0.0f;
+    uint32_t i;
+
+    /* two chains so the FPU pipeline doesn't wait on every add */
+    for (i = 0U; i + 1U < blockSize; i += 2U) {
+        acc0 += pSrcA[i] * pSrcB[i];
+        acc1 += pSrcA[i + 1U] * pSrcB[i + 1U];
+    }
+    if (i < blockSize) {
+        acc0 += pSrcA[i] * pSrcB[i];
+    }
+    *result = acc0 + acc1;
+}
+
+/*!
+    \brief      dot product of two q15 vectors
+    \param[in]  pSrcA: first vector
+    \param[in]  pSrcB: second vector
+    \param[in]  blockSize: number of elements
+    \param[out] result: the sum of the products, 34.30 format
+    \retval     none
+*/
+void arm_dot_prod_q15(const q15_t *pSrcA, const q15_t *pSrcB, uint32_t blockSize, q63_t *result)
+{
+    int64_t acc = 0;
+    uint32_t i = 0U;
+
+#if defined(ARM_MATH_DSP)
+    uint32_t a, b;
+
+    for (; i + 1U < blockSize; i += 2U) {
+        memcpy(&a, &pSrcA[i], sizeof(a));
+        memcpy(&b, &pSrcB[i], sizeof(b));
+        acc = (int64_t)__SMLALD(a, b, (uint64_t)acc);
+    }
+#endif
+    for (; i < blockSize; i++) {
+        acc += (int32_t)pSrcA[i] * pSrcB[i];
+    }
+    *result = acc;
+}
+
+/*!
+    \brief      magnitudes of complex values
+    \param[in]  pSrc: numSamples interleaved real/imaginary pairs
+    \param[out] pDst: numSamples magnitudes
+    \param[in]  numSamples: number of complex values
+    \retval     none
+*/
+void arm_cmplx_mag_f32(const float32_t *pSrc, float32_t *pDst, uint32_t numSamples)
+{
+    uint32_t i;
+
+    for (i = 0U; i < numSamples; i++) {
+        float32_t re = pSrc[2U * i], im = pSrc[2U * i + 1U];
+
+        pDst[i] = __builtin_sqrtf(re * re + im * im);
+    }
+}
+
+/*!
+    \brief      squared magnitudes of complex values, e.g. a power spectrum
+    \param[in]  pSrc: numSamples interleaved real/imaginary pairs
+    \param[out] pDst: numSamples squared magnitudes
+    \param[in]  numSamples: number of complex values
+    \retval     none
+*/
+void arm_cmplx_mag_squared_f32(const float32_t *pSrc, float32_t *pDst, uint32_t numSamples)
+{
+    uint32_t i;
+
+    for (i = 0U; i < numSamples; i++) {
+        float32_t re = pSrc[2U * i], im = pSrc[2U * i + 1U];
+
+        pDst[i] = re * re + im * im;
+    }
+}
@@ -0,0 +1,59 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef _ARM_COMMON_TABLES_H
+#define _ARM_COMMON_TABLES_H
+
+#include "../arm_math.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* one turn is ARM_COS_TABLE_LENGTH steps, the table holds the first quarter */
+#define ARM_COS_TABLE_LENGTH    4096U
+#define ARM_COS_TABLE_QUARTER   1024U
+
+extern const float32_t arm_cos_table_f32[ARM_COS_TABLE_QUARTER + 1];
+
+/* cos and sin of 2 pi index / ARM_COS_TABLE_LENGTH, index below half a turn */
+static inline void arm_cos_sin_f32(uint32_t index, float32_t *c, float32_t *s)
+{
+    if (index <= ARM_COS_TABLE_QUARTER) {
+        *c = arm_cos_table_f32[index];
+        *s = arm_cos_table_f32[ARM_COS_TABLE_QUARTER - index];
+    } else {
+        *c = -arm_cos_table_f32[2U * ARM_COS_TABLE_QUARTER - index];
+        *s = arm_cos_table_f32[index - ARM_COS_TABLE_QUARTER];
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ARM_COMMON_TABLES_H */
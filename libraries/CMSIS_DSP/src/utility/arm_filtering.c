@@ -0,0 +1,260 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "../arm_math.h"
+
+/*!
+    \brief      set up an FIR filter
+    \param[in]  S: instance to set up
+    \param[in]  numTaps: number of coefficients
+    \param[in]  pCoeffs: coefficients, time reversed (b[numTaps-1] first)
+    \param[in]  pState: numTaps + blockSize - 1 samples, cleared here
+    \param[in]  blockSize: most samples per arm_fir_f32() call
+    \param[out] none
+    \retval     none
+*/
+void arm_fir_init_f32(arm_fir_instance_f32 *S, uint16_t numTaps, const float32_t *pCoeffs,
+                      float32_t *pState, uint32_t blockSize)
+{
+    S->numTaps = numTaps;
+    S->pCoeffs = pCoeffs;
+    S->pState = pState;
+    memset(pState, 0, (numTaps + blockSize - 1U) * sizeof(float32_t));
+}
+
+/*!
+    \brief      run an FIR filter
+    \param[in]  S: instance from arm_fir_init_f32()
+    \param[in]  pSrc: blockSize input samples
+    \param[out] pDst: blockSize output samples
+    \param[in]  blockSize: at most the blockSize given to arm_fir_init_f32()
+    \retval     none
+*/
+void arm_fir_f32(const arm_fir_instance_f32 *S, const float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+    uint32_t taps = S->numTaps;
+    float32_t *state = S->pState;
+    const float32_t *coeffs = S->pCoeffs;
+    uint32_t n, i;
+
+    /* the history is in front of the new samples, so every output is one
+       straight dot product over the state */
+    memcpy(&state[taps - 1U], pSrc, blockSize * sizeof(float32_t));
+    for (n = 0U; n < blockSize; n++) {
+        const float32_t *x = &state[n];
+        float32_t acc0 = 0.0f, acc1 = 0.0f;
+
+        for (i = 0U; i + 1U < taps; i += 2U) {
+            acc0 += x[i] * coeffs[i];
+            acc1 += x[i + 1U] * coeffs[i + 1U];
+        }
+        if (i < taps) {
+            acc0 += x[i] * coeffs[i];
+        }
+        pDst[n] = acc0 + acc1;
+    }
+    memmove(state, &state[blockSize], (taps - 1U) * sizeof(float32_t));
+}
+
+/*!
+    \brief      set up a q15 FIR filter
+    \param[in]  S: instance to set up
+    \param[in]  numTaps: number of coefficients, even and at least 4
+    \param[in]  pCoeffs: coefficients, time reversed (b[numTaps-1] first)
+    \param[in]  pState: numTaps + blockSize - 1 samples, cleared here
+    \param[in]  blockSize: most samples per arm_fir_q15() call
+    \param[out] none
+    \retval     ARM_MATH_SUCCESS, or ARM_MATH_ARGUMENT_ERROR for an odd or short filter
+*/
+arm_status arm_fir_init_q15(arm_fir_instance_q15 *S, uint16_t numTaps, const q15_t *pCoeffs,
+                            q15_t *pState, uint32_t blockSize)
+{
+    if ((numTaps < 4U) || ((numTaps & 1U) != 0U)) {
+        return ARM_MATH_ARGUMENT_ERROR;
+    }
+    S->numTaps = numTaps;
+    S->pCoeffs = pCoeffs;
+    S->pState = pState;
+    memset(pState, 0, (numTaps + blockSize - 1U) * sizeof(q15_t));
+    return ARM_MATH_SUCCESS;
+}
+
+#if defined(ARM_MATH_DSP)
+/* two q15 values as one word, any alignment */
+static inline uint32_t arm_read_q15x2(const q15_t *p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+#endif
+
+/*!
+    \brief      run a q15 FIR filter, 34.30 accumulation, saturated 1.15 output
+    \param[in]  S: instance from arm_fir_init_q15()
+    \param[in]  pSrc: blockSize input samples
+    \param[out] pDst: blockSize output samples
+    \param[in]  blockSize: at most the blockSize given to arm_fir_init_q15()
+    \retval     none
+*/
+void arm_fir_q15(const arm_fir_instance_q15 *S, const q15_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+    uint32_t taps = S->numTaps;
+    q15_t *state = S->pState;
+    const q15_t *coeffs = S->pCoeffs;
+    uint32_t n, i;
+
+    memcpy(&state[taps - 1U], pSrc, blockSize * sizeof(q15_t));
+    for (n = 0U; n < blockSize; n++) {
+        const q15_t *x = &state[n];
+        int64_t acc = 0;
+
+#if defined(ARM_MATH_DSP)
+        /* two multiply-accumulates per instruction */
+        for (i = 0U; i < taps; i += 2U) {
+            acc = (int64_t)__SMLALD(arm_read_q15x2(&x[i]), arm_read_q15x2(&coeffs[i]), (uint64_t)acc);
+        }
+#else
+        for (i = 0U; i < taps; i++) {
+            acc += (int32_t)x[i] * coeffs[i];
+        }
+#endif
+        acc >>= 15;
+        pDst[n] = (q15_t)((acc > INT16_MAX) ? INT16_MAX : ((acc < INT16_MIN) ? INT16_MIN : acc));
+    }
+    memmove(state, &state[blockSize], (taps - 1U) * sizeof(q15_t));
+}
+
+/*!
+    \brief      set up a cascade of direct form I biquads
+    \param[in]  S: instance to set up
+    \param[in]  numStages: number of second order sections
+    \param[in]  pCoeffs: b0, b1, b2, a1, a2 per stage, a1/a2 negated
+    \param[in]  pState: 4 * numStages values, cleared here
+    \param[out] none
+    \retval     none
+*/
+void arm_biquad_cascade_df1_init_f32(arm_biquad_casd_df1_inst_f32 *S, uint8_t numStages,
+                                     const float32_t *pCoeffs, float32_t *pState)
+{
+    S->numStages = numStages;
+    S->pCoeffs = pCoeffs;
+    S->pState = pState;
+    memset(pState, 0, 4U * numStages * sizeof(float32_t));
+}
+
+/*!
+    \brief      run a cascade of direct form I biquads
+    \param[in]  S: instance from arm_biquad_cascade_df1_init_f32()
+    \param[in]  pSrc: blockSize input samples
+    \param[out] pDst: blockSize output samples, may be pSrc
+    \param[in]  blockSize: number of samples
+    \retval     none
+*/
+void arm_biquad_cascade_df1_f32(const arm_biquad_casd_df1_inst_f32 *S, const float32_t *pSrc,
+                                float32_t *pDst, uint32_t blockSize)
+{
+    const float32_t *c = S->pCoeffs;
+    float32_t *st = S->pState;
+    const float32_t *in = pSrc;
+    uint32_t stage, n;
+
+    for (stage = 0U; stage < S->numStages; stage++, c += 5, st += 4) {
+        float32_t b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+        float32_t x1 = st[0], x2 = st[1], y1 = st[2], y2 = st[3];
+
+        for (n = 0U; n < blockSize; n++) {
+            float32_t x0 = in[n];
+            float32_t y0 = b0 * x0 + b1 * x1 + b2 * x2 + a1 * y1 + a2 * y2;
+
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y0;
+            pDst[n] = y0;
+        }
+        st[0] = x1;
+        st[1] = x2;
+        st[2] = y1;
+        st[3] = y2;
+        /* later stages filter the output of the previous one */
+        in = pDst;
+    }
+}
+
+/*!
+    \brief      set up a cascade of transposed direct form II biquads
+    \param[in]  S: instance to set up
+    \param[in]  numStages: number of second order sections
+    \param[in]  pCoeffs: b0, b1, b2, a1, a2 per stage, a1/a2 negated
+    \param[in]  pState: 2 * numStages values, cleared here
+    \param[out] none
+    \retval     none
+*/
+void arm_biquad_cascade_df2T_init_f32(arm_biquad_cascade_df2T_instance_f32 *S, uint8_t numStages,
+                                      const float32_t *pCoeffs, float32_t *pState)
+{
+    S->numStages = numStages;
+    S->pCoeffs = pCoeffs;
+    S->pState = pState;
+    memset(pState, 0, 2U * numStages * sizeof(float32_t));
+}
+
+/*!
+    \brief      run a cascade of transposed direct form II biquads
+    \param[in]  S: instance from arm_biquad_cascade_df2T_init_f32()
+    \param[in]  pSrc: blockSize input samples
+    \param[out] pDst: blockSize output samples, may be pSrc
+    \param[in]  blockSize: number of samples
+    \retval     none
+*/
+void arm_biquad_cascade_df2T_f32(const arm_biquad_cascade_df2T_instance_f32 *S, const float32_t *pSrc,
+                                 float32_t *pDst, uint32_t blockSize)
+{
+    const float32_t *c = S->pCoeffs;
+    float32_t *st = S->pState;
+    const float32_t *in = pSrc;
+    uint32_t stage, n;
+
+    for (stage = 0U; stage < S->numStages; stage++, c += 5, st += 2) {
+        float32_t b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+        float32_t d1 = st[0], d2 = st[1];
+
+        for (n = 0U; n < blockSize; n++) {
+            float32_t x0 = in[n];
+            float32_t y0 = b0 * x0 + d1;
+
+            d1 = b1 * x0 + a1 * y0 + d2;
+            d2 = b2 * x0 + a2 * y0;
+            pDst[n] = y0;
+        }
+        st[0] = d1;
+        st[1] = d2;
+        in = pDst;
+    }
+}
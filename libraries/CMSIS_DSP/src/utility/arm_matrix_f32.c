@@ -0,0 +1,222 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <stdbool.h>
+#include "../arm_math.h"
+
+/*!
+    \brief      describe a row major matrix
+    \param[in]  S: instance to set up
+    \param[in]  nRows: number of rows
+    \param[in]  nColumns: number of columns
+    \param[in]  pData: nRows * nColumns values
+    \param[out] none
+    \retval     none
+*/
+void arm_mat_init_f32(arm_matrix_instance_f32 *S, uint16_t nRows, uint16_t nColumns, float32_t *pData)
+{
+    S->numRows = nRows;
+    S->numCols = nColumns;
+    S->pData = pData;
+}
+
+static bool arm_mat_same_size(const arm_matrix_instance_f32 *a, const arm_matrix_instance_f32 *b)
+{
+    return (a->numRows == b->numRows) && (a->numCols == b->numCols);
+}
+
+/*!
+    \brief      element-wise sum of two matrices
+    \param[in]  pSrcA: first matrix
+    \param[in]  pSrcB: second matrix, same size
+    \param[out] pDst: sum, same size, may be a source
+    \retval     ARM_MATH_SUCCESS, or ARM_MATH_SIZE_MISMATCH
+*/
+arm_status arm_mat_add_f32(const arm_matrix_instance_f32 *pSrcA, const arm_matrix_instance_f32 *pSrcB,
+                           arm_matrix_instance_f32 *pDst)
+{
+    if (!arm_mat_same_size(pSrcA, pSrcB) || !arm_mat_same_size(pSrcA, pDst)) {
+        return ARM_MATH_SIZE_MISMATCH;
+    }
+    arm_add_f32(pSrcA->pData, pSrcB->pData, pDst->pData, (uint32_t)pSrcA->numRows * pSrcA->numCols);
+    return ARM_MATH_SUCCESS;
+}
+
+/*!
+    \brief      element-wise difference of two matrices
+    \param[in]  pSrcA: first matrix
+    \param[in]  pSrcB: matrix subtracted, same size
+    \param[out] pDst: difference, same size, may be a source
+    \retval     ARM_MATH_SUCCESS, or ARM_MATH_SIZE_MISMATCH
+*/
+arm_status arm_mat_sub_f32(const arm_matrix_instance_f32 *pSrcA, const arm_matrix_instance_f32 *pSrcB,
+                           arm_matrix_instance_f32 *pDst)
+{
+    uint32_t i, count;
+
+    if (!arm_mat_same_size(pSrcA, pSrcB) || !arm_mat_same_size(pSrcA, pDst)) {
+        return ARM_MATH_SIZE_MISMATCH;
+    }
+    count = (uint32_t)pSrcA->numRows * pSrcA->numCols;
+    for (i = 0U; i < count; i++) {
+        pDst->pData[i] = pSrcA->pData[i] - pSrcB->pData[i];
+    }
+    return ARM_MATH_SUCCESS;
+}
+
+/*!
+    \brief      multiply every element of a matrix by a scalar
+    \param[in]  pSrc: matrix
+    \param[in]  scale: factor
+    \param[out] pDst: result, same size, may be pSrc
+    \retval     ARM_MATH_SUCCESS, or ARM_MATH_SIZE_MISMATCH
+*/
+arm_status arm_mat_scale_f32(const arm_matrix_instance_f32 *pSrc, float32_t scale,
+                             arm_matrix_instance_f32 *pDst)
+{
+    if (!arm_mat_same_size(pSrc, pDst)) {
+        return ARM_MATH_SIZE_MISMATCH;
+    }
+    arm_scale_f32(pSrc->pData, scale, pDst->pData, (uint32_t)pSrc->numRows * pSrc->numCols);
+    return ARM_MATH_SUCCESS;
+}
+
+/*!
+    \brief      transpose a matrix
+    \param[in]  pSrc: rows x columns matrix
+    \param[out] pDst: columns x rows matrix, not pSrc
+    \retval     ARM_MATH_SUCCESS, or ARM_MATH_SIZE_MISMATCH
+*/
+arm_status arm_mat_trans_f32(const arm_matrix_instance_f32 *pSrc, arm_matrix_instance_f32 *pDst)
+{
+    uint32_t r, c;
+
+    if ((pSrc->numRows != pDst->numCols) || (pSrc->numCols != pDst->numRows)) {
+        return ARM_MATH_SIZE_MISMATCH;
+    }
+    for (r = 0U; r < pSrc->numRows; r++) {
+        for (c = 0U; c < pSrc->numCols; c++) {
+            pDst->pData[c * pDst->numCols + r] = pSrc->pData[r * pSrc->numCols + c];
+        }
+    }
+    return ARM_MATH_SUCCESS;
+}
+
+/*!
+    \brief      matrix product
+    \param[in]  pSrcA: m x n matrix
+    \param[in]  pSrcB: n x p matrix
+    \param[out] pDst: m x p matrix, neither source
+    \retval     ARM_MATH_SUCCESS, or ARM_MATH_SIZE_MISMATCH
+*/
+arm_status arm_mat_mult_f32(const arm_matrix_instance_f32 *pSrcA, const arm_matrix_instance_f32 *pSrcB,
+                            arm_matrix_instance_f32 *pDst)
+{
+    uint32_t r, c, i;
+    uint32_t n = pSrcA->numCols;
+    uint32_t p = pSrcB->numCols;
+
+    if ((n != pSrcB->numRows) || (pDst->numRows != pSrcA->numRows) || (pDst->numCols != p)) {
+        return ARM_MATH_SIZE_MISMATCH;
+    }
+    for (r = 0U; r < pSrcA->numRows; r++) {
+        const float32_t *a = &pSrcA->pData[r * n];
+
+        for (c = 0U; c < p; c++) {
+            const float32_t *b = &pSrcB->pData[c];
+            float32_t acc = 0.0f;
+
+            for (i = 0U; i < n; i++) {
+                acc += a[i] * b[i * p];
+            }
+            pDst->pData[r * p + c] = acc;
+        }
+    }
+    return ARM_MATH_SUCCESS;
+}
+
+/*!
+    \brief      invert a square matrix, Gauss-Jordan with partial pivoting
+    \param[in]  pSrc: n x n matrix, destroyed
+    \param[out] pDst: n x n inverse, not pSrc
+    \retval     ARM_MATH_SUCCESS, ARM_MATH_SIZE_MISMATCH or ARM_MATH_SINGULAR
+*/
+arm_status arm_mat_inverse_f32(const arm_matrix_instance_f32 *pSrc, arm_matrix_instance_f32 *pDst)
+{
+    uint32_t n = pSrc->numRows;
+    float32_t *a = pSrc->pData;
+    float32_t *inv = pDst->pData;
+    uint32_t col, row, i, pivot;
+    float32_t t;
+
+    if ((pSrc->numCols != n) || (pDst->numRows != n) || (pDst->numCols != n)) {
+        return ARM_MATH_SIZE_MISMATCH;
+    }
+    for (i = 0U; i < n * n; i++) {
+        inv[i] = ((i % (n + 1U)) == 0U) ? 1.0f : 0.0f;
+    }
+    for (col = 0U; col < n; col++) {
+        /* the largest element left in the column keeps the rounding small */
+        pivot = col;
+        for (row = col + 1U; row < n; row++) {
+            if (fabsf(a[row * n + col]) > fabsf(a[pivot * n + col])) {
+                pivot = row;
+            }
+        }
+        if (a[pivot * n + col] == 0.0f) {
+            return ARM_MATH_SINGULAR;
+        }
+        if (pivot != col) {
+            for (i = 0U; i < n; i++) {
+                t = a[col * n + i];
+                a[col * n + i] = a[pivot * n + i];
+                a[pivot * n + i] = t;
+                t = inv[col * n + i];
+                inv[col * n + i] = inv[pivot * n + i];
+                inv[pivot * n + i] = t;
+            }
+        }
+        t = 1.0f / a[col * n + col];
+        for (i = 0U; i < n; i++) {
+            a[col * n + i] *= t;
+            inv[col * n + i] *= t;
+        }
+        for (row = 0U; row < n; row++) {
+            if (row == col) {
+                continue;
+            }
+            t = a[row * n + col];
+            if (t != 0.0f) {
+                for (i = 0U; i < n; i++) {
+                    a[row * n + i] -= t * a[col * n + i];
+                    inv[row * n + i] -= t * inv[col * n + i];
+                }
+            }
+        }
+    }
+    return ARM_MATH_SUCCESS;
+}
@@ -0,0 +1,84 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "../arm_math.h"
+
+/*!
+    \brief      largest value of a vector
+    \param[in]  pSrc: vector
+    \param[in]  blockSize: number of elements, at least 1
+    \param[out] pResult: the largest value
+    \param[out] pIndex: its first index
+    \retval     none
+*/
+void arm_max_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult, uint32_t *pIndex)
+{
+    float32_t max = pSrc[0];
+    uint32_t index = 0U, i;
+
+    for (i = 1U; i < blockSize; i++) {
+        if (pSrc[i] > max) {
+            max = pSrc[i];
+            index = i;
+        }
+    }
+    *pResult = max;
+    *pIndex = index;
+}
+
+/*!
+    \brief      mean of a vector
+    \param[in]  pSrc: vector
+    \param[in]  blockSize: number of elements, at least 1
+    \param[out] pResult: the mean
+    \retval     none
+*/
+void arm_mean_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult)
+{
+    float32_t sum = 0.0f;
+    uint32_t i;
+
+    for (i = 0U; i < blockSize; i++) {
+        sum += pSrc[i];
+    }
+    *pResult = sum / (float32_t)blockSize;
+}
+
+/*!
+    \brief      root mean square of a vector
+    \param[in]  pSrc: vector
+    \param[in]  blockSize: number of elements, at least 1
+    \param[out] pResult: the RMS value
+    \retval     none
+*/
+void arm_rms_f32(const float32_t *pSrc, uint32_t blockSize, float32_t *pResult)
+{
+    float32_t sum;
+
+    arm_dot_prod_f32(pSrc, pSrc, blockSize, &sum);
+    *pResult = __builtin_sqrtf(sum / (float32_t)blockSize);
+}
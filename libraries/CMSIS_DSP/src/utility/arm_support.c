@@ -0,0 +1,93 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "arm_common_tables.h"
+
+/*!
+    \brief      Hann window, periodic, for spectra of blocks of blockSize samples
+    \param[out] pDst: blockSize window values
+    \param[in]  blockSize: number of samples
+    \retval     none
+*/
+void arm_hanning_f32(float32_t *pDst, uint32_t blockSize)
+{
+    uint32_t i;
+    float32_t c, s;
+
+    if (blockSize == 0U) {
+        return;
+    }
+    if ((blockSize <= ARM_COS_TABLE_LENGTH) && ((ARM_COS_TABLE_LENGTH % blockSize) == 0U)) {
+        /* power of 2 blocks: table steps, the second half mirrors the first */
+        for (i = 0U; i <= blockSize / 2U; i++) {
+            arm_cos_sin_f32(i * (ARM_COS_TABLE_LENGTH / blockSize), &c, &s);
+            pDst[i] = 0.5f - 0.5f * c;
+        }
+        for (; i < blockSize; i++) {
+            pDst[i] = pDst[blockSize - i];
+        }
+        return;
+    }
+    for (i = 0U; i < blockSize; i++) {
+        pDst[i] = 0.5f - 0.5f * cosf(2.0f * (float32_t)M_PI * (float32_t)i / (float32_t)blockSize);
+    }
+}
+
+/*!
+    \brief      convert 1.15 fixed point to float
+    \param[in]  pSrc: blockSize q15 values
+    \param[out] pDst: blockSize values in [-1, 1)
+    \param[in]  blockSize: number of values
+    \retval     none
+*/
+void arm_q15_to_float(const q15_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+    uint32_t i;
+
+    for (i = 0U; i < blockSize; i++) {
+        pDst[i] = (float32_t)pSrc[i] * (1.0f / 32768.0f);
+    }
+}
+
+/*!
+    \brief      convert float to 1.15 fixed point, rounded and saturated
+    \param[in]  pSrc: blockSize values
+    \param[out] pDst: blockSize q15 values
+    \param[in]  blockSize: number of values
+    \retval     none
+*/
+void arm_float_to_q15(const float32_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+    uint32_t i;
+
+    for (i = 0U; i < blockSize; i++) {
+        float32_t v = pSrc[i] * 32768.0f;
+        int32_t q = (int32_t)(v + ((v >= 0.0f) ? 0.5f : -0.5f));
+
+        pDst[i] = (q15_t)((q > INT16_MAX) ? INT16_MAX : ((q < INT16_MIN) ? INT16_MIN : q));
+    }
+}
@@ -0,0 +1,188 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <stdbool.h>
+#include "arm_common_tables.h"
+
+#define ARM_CFFT_MIN_LENGTH     16U
+#define ARM_CFFT_MAX_LENGTH     4096U
+
+static bool arm_fft_length_valid(uint32_t length, uint32_t min)
+{
+    return (length >= min) && (length <= ARM_CFFT_MAX_LENGTH) && ((length & (length - 1U)) == 0U);
+}
+
+/* swap the pairs at bit reversed indices */
+static void arm_bitreversal_f32(float32_t *p, uint32_t n)
+{
+    uint32_t i, j = 0U, bit;
+    float32_t t;
+
+    for (i = 1U; i < n; i++) {
+        for (bit = n >> 1; (j & bit) != 0U; bit >>= 1) {
+            j ^= bit;
+        }
+        j |= bit;
+        if (i < j) {
+            t = p[2U * i];
+            p[2U * i] = p[2U * j];
+            p[2U * j] = t;
+            t = p[2U * i + 1U];
+            p[2U * i + 1U] = p[2U * j + 1U];
+            p[2U * j + 1U] = t;
+        }
+    }
+}
+
+/*!
+    \brief      set up a complex FFT
+    \param[in]  S: instance to set up
+    \param[in]  fftLen: number of complex points, a power of 2 from 16 to 4096
+    \param[out] none
+    \retval     ARM_MATH_SUCCESS, or ARM_MATH_ARGUMENT_ERROR for other lengths
+*/
+arm_status arm_cfft_init_f32(arm_cfft_instance_f32 *S, uint16_t fftLen)
+{
+    if (!arm_fft_length_valid(fftLen, ARM_CFFT_MIN_LENGTH)) {
+        return ARM_MATH_ARGUMENT_ERROR;
+    }
+    S->fftLen = fftLen;
+    S->twidCoefModifier = (uint16_t)(ARM_COS_TABLE_LENGTH / fftLen);
+    return ARM_MATH_SUCCESS;
+}
+
+/*!
+    \brief      complex FFT in place, radix-2 decimation in frequency
+    \param[in]  S: instance from arm_cfft_init_f32()
+    \param[in]  p1: fftLen interleaved real/imaginary pairs, replaced by the result
+    \param[in]  ifftFlag: 1 for the inverse transform, scaled by 1/fftLen
+    \param[in]  bitReverseFlag: 1 for the output in natural order
+    \param[out] none
+    \retval     none
+*/
+void arm_cfft_f32(const arm_cfft_instance_f32 *S, float32_t *p1, uint8_t ifftFlag, uint8_t bitReverseFlag)
+{
+    uint32_t n = S->fftLen;
+    uint32_t len, half, k, i, j;
+    uint32_t step = S->twidCoefModifier;
+    float32_t wr, wi, ar, ai;
+
+    for (len = n; len >= 2U; len >>= 1, step <<= 1) {
+        half = len >> 1;
+        for (k = 0U; k < half; k++) {
+            /* e^-j2pik/len forward, its conjugate inverse */
+            arm_cos_sin_f32(k * step, &wr, &wi);
+            if (!ifftFlag) {
+                wi = -wi;
+            }
+            for (i = k; i < n; i += len) {
+                j = i + half;
+                ar = p1[2U * i] - p1[2U * j];
+                ai = p1[2U * i + 1U] - p1[2U * j + 1U];
+                p1[2U * i] += p1[2U * j];
+                p1[2U * i + 1U] += p1[2U * j + 1U];
+                p1[2U * j] = ar * wr - ai * wi;
+                p1[2U * j + 1U] = ar * wi + ai * wr;
+            }
+        }
+    }
+    if (bitReverseFlag) {
+        arm_bitreversal_f32(p1, n);
+    }
+    if (ifftFlag) {
+        float32_t scale = 1.0f / (float32_t)n;
+
+        for (i = 0U; i < 2U * n; i++) {
+            p1[i] *= scale;
+        }
+    }
+}
+
+/*!
+    \brief      set up a real FFT
+    \param[in]  S: instance to set up
+    \param[in]  fftLen: number of real points, a power of 2 from 32 to 4096
+    \param[out] none
+    \retval     ARM_MATH_SUCCESS, or ARM_MATH_ARGUMENT_ERROR for other lengths
+*/
+arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32 *S, uint16_t fftLen)
+{
+    if (!arm_fft_length_valid(fftLen, 2U * ARM_CFFT_MIN_LENGTH)) {
+        return ARM_MATH_ARGUMENT_ERROR;
+    }
+    S->fftLenRFFT = fftLen;
+    S->twidCoefRModifier = (uint16_t)(ARM_COS_TABLE_LENGTH / fftLen);
+    return arm_cfft_init_f32(&S->Sint, fftLen / 2U);
+}
+
+/*!
+    \brief      real FFT through a complex FFT of half the length
+    \param[in]  S: instance from arm_rfft_fast_init_f32()
+    \param[in]  p: forward, fftLen real samples; inverse, the packed spectrum;
+                overwritten either way
+    \param[in]  ifftFlag: 1 for the inverse transform
+    \param[out] pOut: forward, the packed spectrum (DC, Nyquist, then bins 1 to
+                fftLen/2-1 as pairs); inverse, fftLen real samples
+    \retval     none
+*/
+void arm_rfft_fast_f32(const arm_rfft_fast_instance_f32 *S, float32_t *p, float32_t *pOut, uint8_t ifftFlag)
+{
+    uint32_t m = S->fftLenRFFT / 2U;
+    uint32_t k;
+    float32_t c, s, er, ei, dr, di;
+
+    if (!ifftFlag) {
+        /* even samples as real, odd as imaginary parts */
+        arm_cfft_f32(&S->Sint, p, 0U, 1U);
+        pOut[0] = p[0] + p[1];
+        pOut[1] = p[0] - p[1];
+        for (k = 1U; k < m; k++) {
+            /* halves of Z[k] + conj(Z[m-k]) and Z[k] - conj(Z[m-k]) */
+            er = 0.5f * (p[2U * k] + p[2U * (m - k)]);
+            ei = 0.5f * (p[2U * k + 1U] - p[2U * (m - k) + 1U]);
+            dr = 0.5f * (p[2U * k] - p[2U * (m - k)]);
+            di = 0.5f * (p[2U * k + 1U] + p[2U * (m - k) + 1U]);
+            arm_cos_sin_f32(k * S->twidCoefRModifier, &c, &s);
+            pOut[2U * k] = er + c * di - s * dr;
+            pOut[2U * k + 1U] = ei - s * di - c * dr;
+        }
+    } else {
+        pOut[0] = 0.5f * (p[0] + p[1]);
+        pOut[1] = 0.5f * (p[0] - p[1]);
+        for (k = 1U; k < m; k++) {
+            er = 0.5f * (p[2U * k] + p[2U * (m - k)]);
+            ei = 0.5f * (p[2U * k + 1U] - p[2U * (m - k) + 1U]);
+            dr = 0.5f * (p[2U * k] - p[2U * (m - k)]);
+            di = 0.5f * (p[2U * k + 1U] + p[2U * (m - k) + 1U]);
+            arm_cos_sin_f32(k * S->twidCoefRModifier, &c, &s);
+            /* even part plus j times the odd part turned back by W^-k */
+            pOut[2U * k] = er - (dr * s + di * c);
+            pOut[2U * k + 1U] = ei + (dr * c - di * s);
+        }
+        arm_cfft_f32(&S->Sint, pOut, 1U, 1U);
+    }
+}
@@ -0,0 +1,54 @@
+/*
+  Over-current cutoff
+
+  Drives a 20 kHz PWM on PA8, TIMER0 channel 0, and watches the voltage of
+  a current shunt on PA1 with comparator 0. When the shunt voltage rises
+  above 0.6 V, VREFINT / 2, the comparator trips the TIMER0 break input and
+  the hardware drives the PWM output to its idle level within a
+  microsecond; the interrupt only reports it. Sending 'r' re-arms the
+  output once the current is back down.
+
+  GD32F350. With a DAC threshold instead, begin(COMPARATOR_DAC, ...) and
+  setThreshold(millivolts).
+*/
+
+#include <Comparator.h>
+
+PWM pwm(PA8);
+volatile bool tripped = false;
+
+void overCurrent(void *arg)
+{
+    (void)arg;
+    tripped = true;
+}
+
+void setup()
+{
+    Serial.begin(115200);
+
+    pwm.setPeriodCycle(50, 25, FORMAT_US);
+    pwm.enableBreak(COMPARATOR_ROUTED, true);
+    pwm.start();
+
+    Comparator0.setHysteresis(COMPARATOR_HYSTERESIS_LOW);
+    Comparator0.begin(COMPARATOR_VREF_1_2, COMPARATOR_OUT_TIMER0_BREAK);
+    Comparator0.attachInterrupt(overCurrent, NULL, RISING);
+    // nothing can turn the protection off any more
+    Comparator0.lock();
+}
+
+void loop()
+{
+    if (tripped) {
+        tripped = false;
+        Serial.println("over-current, output off; 'r' to re-arm");
+    }
+    if (Serial.read() == 'r') {
+        if (pwm.clearBreak()) {
+            Serial.println("re-armed");
+        } else {
+            Serial.println("current still too high");
+        }
+    }
+}
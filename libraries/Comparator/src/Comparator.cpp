@@ -0,0 +1,314 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "Comparator.h"
+
+#if (defined(GD32F3x0) && defined(GD32F350)) || (defined(GD32E50X) && (defined(GD32E50X_CL) || defined(GD32E508)))
+
+#if defined(GD32F3x0)
+#define COMPARATOR_RCU          RCU_CFGCMP
+#define COMPARATOR_DAC_INPUT    CMP_DAC
+#define COMPARATOR_EXTI(cmp)    (((cmp) == CMP0) ? EXTI_21 : EXTI_22)
+
+ComparatorClass Comparator0(CMP0, PORTA_1);
+ComparatorClass Comparator1(CMP1, PORTA_3);
+
+/* routing of comparator_output_t */
+static const cmp_output_enum comparatorOutputs[] = {
+    CMP_OUTPUT_NONE,
+    CMP_OUTPUT_TIMER0BKIN,
+    CMP_OUTPUT_TIMER0IC0,
+    CMP_OUTPUT_TIMER1IC3,
+    CMP_OUTPUT_TIMER2IC0,
+    CMP_OUTPUT_TIMER0OCPRECLR,
+    CMP_OUTPUT_TIMER1OCPRECLR,
+    CMP_OUTPUT_TIMER2OCPRECLR,
+};
+#else
+#define COMPARATOR_RCU          RCU_CMP
+#define COMPARATOR_DAC_INPUT    CMP_PA4
+
+ComparatorClass Comparator1(CMP1, PORTA_7);
+ComparatorClass Comparator3(CMP3, PORTB_0);
+ComparatorClass Comparator5(CMP5, PORTB_11);
+
+static const cmp_output_enum comparatorOutputs[] = {
+    CMP_OUTPUT_NONE,
+    CMP_OUTPUT_TIMER0_BKIN,
+    CMP_OUTPUT_TIMER0IC0,
+    CMP_OUTPUT_TIMER1IC3,
+    CMP_OUTPUT_TIMER2IC0,
+};
+#endif
+
+/* pin of an inverting input taken from outside */
+static PinName comparatorRefPin(uint32_t cmp, comparator_ref_t ref)
+{
+    switch (ref) {
+        case COMPARATOR_DAC:
+            return PORTA_4;
+        case COMPARATOR_PA5:
+            return PORTA_5;
+        case COMPARATOR_PIN:
+#if defined(GD32F3x0)
+            return (cmp == CMP0) ? PORTA_0 : PORTA_2;
+#else
+            (void)cmp;
+            return PORTA_2;
+#endif
+        default:
+            return NC;
+    }
+}
+
+/*!
+    \brief      ComparatorClass object construct
+    \param[in]  cmp: comparator of the firmware library
+    \param[in]  input: its non-inverting input pin
+    \param[out] none
+    \retval     none
+*/
+ComparatorClass::ComparatorClass(uint32_t cmp, PinName input)
+{
+    this->cmp = cmp;
+    this->input = input;
+    this->ref = COMPARATOR_VREF_1_2;
+    this->hysteresis = COMPARATOR_HYSTERESIS_NONE;
+    this->running = false;
+    this->callback = NULL;
+    this->callbackArg = NULL;
+}
+
+/*!
+    \brief      set up and enable the comparator in high speed mode
+    \param[in]  ref: the threshold on the inverting input
+    \param[in]  output: timer input the output is routed to
+    \param[in]  inverted: the output is high below the threshold
+    \param[out] none
+    \retval     false if the routing doesn't exist on this part or the comparator is locked
+*/
+bool ComparatorClass::begin(comparator_ref_t ref, comparator_output_t output, bool inverted)
+{
+    PinName refPin = comparatorRefPin(this->cmp, ref);
+
+    if ((uint32_t)output >= (sizeof(comparatorOutputs) / sizeof(comparatorOutputs[0]))) {
+        return false;
+    }
+    rcu_periph_clock_enable(COMPARATOR_RCU);
+#if defined(GD32F3x0)
+    if ((CMP_CS & ((this->cmp == CMP0) ? CMP_CS_CMP0LK : CMP_CS_CMP1LK)) != 0U) {
+        return false;
+    }
+#else
+    if ((CMP_CS((cmp_enum)this->cmp) & CMP_CS_CMPLK) != 0U) {
+        return false;
+    }
+#endif
+    pin_function(this->input, GD_PIN_FUNC_ANALOG_CH(0));
+    /* the DAC sets its own pin up when setThreshold() starts it */
+    if ((refPin != NC) && (pinmap_find_peripheral(refPin, PinMap_DAC) == (uint32_t)NC)) {
+        pin_function(refPin, GD_PIN_FUNC_ANALOG_CH(0));
+    }
+
+#if defined(GD32F3x0)
+    cmp_mode_init(this->cmp, CMP_HIGHSPEED, (ref == COMPARATOR_DAC) ? COMPARATOR_DAC_INPUT : (inverting_input_enum)ref,
+                  (cmp_hysteresis_enum)this->hysteresis);
+    cmp_output_init(this->cmp, comparatorOutputs[output],
+                    inverted ? CMP_OUTPUT_POLARITY_INVERTED : CMP_OUTPUT_POLARITY_NOINVERTED);
+    cmp_enable(this->cmp);
+#else
+    cmp_input_init((cmp_enum)this->cmp, (ref == COMPARATOR_DAC) ? COMPARATOR_DAC_INPUT : (inverting_input_enum)ref);
+    cmp_output_init((cmp_enum)this->cmp, comparatorOutputs[output],
+                    inverted ? CMP_OUTPUT_POLARITY_INVERTED : CMP_OUTPUT_POLARITY_NOINVERTED);
+    cmp_enable((cmp_enum)this->cmp);
+#endif
+    this->ref = ref;
+    this->running = true;
+    return true;
+}
+
+/*!
+    \brief      disable the comparator and its interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void ComparatorClass::end(void)
+{
+    if (!this->running) {
+        return;
+    }
+    detachInterrupt();
+#if defined(GD32F3x0)
+    cmp_disable(this->cmp);
+#else
+    cmp_disable((cmp_enum)this->cmp);
+#endif
+    this->running = false;
+}
+
+/*!
+    \brief      put a threshold on the DAC the inverting input uses
+    \param[in]  millivolts: threshold, of COMPARATOR_VDDA_MV at full scale
+    \param[out] none
+    \retval     false unless begin() took COMPARATOR_DAC, or COMPARATOR_PA5 on a part with a DAC there
+*/
+bool ComparatorClass::setThreshold(uint16_t millivolts)
+{
+    PinName refPin = comparatorRefPin(this->cmp, this->ref);
+    uint32_t value;
+
+    if (!this->running || (refPin == NC) || (pinmap_find_peripheral(refPin, PinMap_DAC) == (uint32_t)NC)) {
+        return false;
+    }
+    value = ((uint32_t)millivolts * 4095U + COMPARATOR_VDDA_MV / 2U) / COMPARATOR_VDDA_MV;
+    set_dac_value(refPin, (uint16_t)((value > 4095U) ? 4095U : value));
+    return true;
+}
+
+/*!
+    \brief      set the hysteresis the next begin() takes, against chatter on slow or noisy inputs
+    \param[in]  hysteresis: COMPARATOR_HYSTERESIS_NONE, _LOW, _MEDIUM or _HIGH
+    \param[out] none
+    \retval     none
+*/
+void ComparatorClass::setHysteresis(comparator_hysteresis_t hysteresis)
+{
+    this->hysteresis = hysteresis;
+}
+
+/*!
+    \brief      read the comparator output, after the polarity
+    \param[in]  none
+    \param[out] none
+    \retval     true while high
+*/
+bool ComparatorClass::read(void)
+{
+#if defined(GD32F3x0)
+    return cmp_output_level_get(this->cmp) == CMP_OUTPUTLEVEL_HIGH;
+#else
+    return cmp_output_level_get((cmp_enum)this->cmp) == CMP_OUTPUTLEVEL_HIGH;
+#endif
+}
+
+/*!
+    \brief      call back from the interrupt on edges of the output
+    \param[in]  callback: the function
+    \param[in]  arg: passed to it
+    \param[in]  mode: RISING, FALLING or CHANGE
+    \param[out] none
+    \retval     false if the comparator has no interrupt
+*/
+bool ComparatorClass::attachInterrupt(ComparatorCallback callback, void *arg, PinStatus mode)
+{
+#if defined(GD32F3x0)
+    exti_line_enum line = COMPARATOR_EXTI(this->cmp);
+    exti_trig_type_enum trig = (mode == FALLING) ? EXTI_TRIG_FALLING : ((mode == CHANGE) ? EXTI_TRIG_BOTH : EXTI_TRIG_RISING);
+
+    exti_interrupt_disable(line);
+    this->callback = callback;
+    this->callbackArg = arg;
+    exti_init(line, EXTI_INTERRUPT, trig);
+    exti_interrupt_flag_clear(line);
+    /* shared with the ADC, which sets the same priority */
+    irq_priority_enable(ADC_CMP_IRQn, IRQ_PRIO_ADC);
+    return true;
+#else
+    (void)callback;
+    (void)arg;
+    (void)mode;
+    return false;
+#endif
+}
+
+/*!
+    \brief      stop calling back, the shared interrupt line stays enabled
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void ComparatorClass::detachInterrupt(void)
+{
+#if defined(GD32F3x0)
+    exti_interrupt_disable(COMPARATOR_EXTI(this->cmp));
+    exti_interrupt_flag_clear(COMPARATOR_EXTI(this->cmp));
+#endif
+    this->callback = NULL;
+}
+
+/*!
+    \brief      make the set-up read-only until the next reset, so that a runaway program
+                can't turn the protection off
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void ComparatorClass::lock(void)
+{
+#if defined(GD32F3x0)
+    cmp_lock_enable(this->cmp);
+#else
+    cmp_lock_enable((cmp_enum)this->cmp);
+#endif
+}
+
+/*!
+    \brief      comparator interrupt: call back on a pending edge
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void ComparatorClass::irq(void)
+{
+#if defined(GD32F3x0)
+    exti_line_enum line = COMPARATOR_EXTI(this->cmp);
+
+    if (RESET == exti_interrupt_flag_get(line)) {
+        return;
+    }
+    exti_interrupt_flag_clear(line);
+    if (this->callback != NULL) {
+        this->callback(this->callbackArg);
+    }
+#endif
+}
+
+#if defined(GD32F3x0)
+extern "C" {
+
+/* the ADC driver owns the vector and calls this */
+void adc_shared_cmp_irq(void)
+{
+    Comparator0.irq();
+    Comparator1.irq();
+}
+
+}
+#endif
+
+#endif /* GD32F350 || GD32E50x with comparators */
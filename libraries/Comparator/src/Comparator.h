@@ -0,0 +1,123 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef COMPARATOR_H
+#define COMPARATOR_H
+
+#include "Arduino.h"
+
+#if (defined(GD32F3x0) && defined(GD32F350)) || (defined(GD32E50X) && (defined(GD32E50X_CL) || defined(GD32E508)))
+
+/* analog supply, for the thresholds setThreshold() puts on the DAC */
+#ifndef COMPARATOR_VDDA_MV
+#define COMPARATOR_VDDA_MV      3300U
+#endif
+/* pin of PWM::enableBreak() for a break input a comparator drives, no pin is set up */
+#define COMPARATOR_ROUTED       0xFFFFFFFFU
+
+/* the inverting input, the threshold */
+typedef enum {
+    COMPARATOR_VREF_1_4 = 0,                    /* VREFINT / 4, about 0.3 V */
+    COMPARATOR_VREF_1_2,                        /* VREFINT / 2 */
+    COMPARATOR_VREF_3_4,                        /* VREFINT * 3 / 4 */
+    COMPARATOR_VREF,                            /* VREFINT, about 1.2 V */
+    COMPARATOR_DAC,                             /* PA4, the DAC0 output setThreshold() sets */
+    COMPARATOR_PA5,                             /* PA5, the DAC1 output where there is one */
+    COMPARATOR_PIN                              /* GD32F350: PA0 for comparator 0, PA2 for 1; GD32E50x: PA2 */
+} comparator_ref_t;
+
+/* where the output goes besides the interrupt */
+typedef enum {
+    COMPARATOR_OUT_NONE = 0,
+    COMPARATOR_OUT_TIMER0_BREAK,                /* stops the TIMER0 outputs, see PWM::enableBreak() */
+    COMPARATOR_OUT_TIMER0_CH0,                  /* input capture of TIMER0 channel 0 */
+    COMPARATOR_OUT_TIMER1_CH3,                  /* input capture of TIMER1 channel 3 */
+    COMPARATOR_OUT_TIMER2_CH0,                  /* input capture of TIMER2 channel 0 */
+    COMPARATOR_OUT_TIMER0_CLEAR,                /* GD32F350: OCPRE_CLR, ends the TIMER0 pulses until the next period */
+    COMPARATOR_OUT_TIMER1_CLEAR,
+    COMPARATOR_OUT_TIMER2_CLEAR
+} comparator_output_t;
+
+/* GD32F350 only, ignored on the GD32E50x */
+typedef enum {
+    COMPARATOR_HYSTERESIS_NONE = 0,
+    COMPARATOR_HYSTERESIS_LOW,
+    COMPARATOR_HYSTERESIS_MEDIUM,
+    COMPARATOR_HYSTERESIS_HIGH
+} comparator_hysteresis_t;
+
+typedef void (*ComparatorCallback)(void *arg);
+
+/* An analog comparator in high speed mode. The non-inverting input is a fixed pin, PA1 and
+   PA3 for comparators 0 and 1 of the GD32F350, PA7, PB0 and PB11 for comparators 1, 3 and 5
+   of the GD32E50x; the output is high while it is above the threshold, or below with
+   inverted. Routed to a timer, the output acts there within the propagation delay, tens of
+   ns, without the CPU: to the TIMER0 break input it drives the PWM outputs to their idle
+   level, over-current protection that doesn't wait for an ADC conversion or interrupt.
+
+   attachInterrupt() calls back on output edges, through EXTI lines 21 and 22 on the
+   GD32F350, which share the ADC interrupt; the GD32E50x comparators have no EXTI line */
+class ComparatorClass
+{
+    public:
+        ComparatorClass(uint32_t cmp, PinName input);                             //ComparatorClass object construct
+        bool begin(comparator_ref_t ref = COMPARATOR_VREF_1_2,
+                   comparator_output_t output = COMPARATOR_OUT_NONE,
+                   bool inverted = false);                                        //start comparing
+        void end(void);                                                           //stop, the pins are left alone
+        bool setThreshold(uint16_t millivolts);                                   //DAC level of COMPARATOR_DAC or COMPARATOR_PA5
+        void setHysteresis(comparator_hysteresis_t hysteresis);                   //hysteresis from the next begin()
+        bool read(void);                                                          //output level
+        bool attachInterrupt(ComparatorCallback callback, void *arg = NULL,
+                             PinStatus mode = RISING);                            //call back on output edges
+        void detachInterrupt(void);                                               //no more call backs
+        void lock(void);                                                          //freeze the set-up until reset
+
+        void irq(void);
+
+    private:
+        uint32_t cmp;
+        PinName input;
+        comparator_ref_t ref;
+        comparator_hysteresis_t hysteresis;
+        bool running;
+        ComparatorCallback callback;
+        void *callbackArg;
+};
+
+#if defined(GD32F3x0)
+extern ComparatorClass Comparator0;
+extern ComparatorClass Comparator1;
+#else
+extern ComparatorClass Comparator1;
+extern ComparatorClass Comparator3;
+extern ComparatorClass Comparator5;
+#endif
+
+#endif /* GD32F350 || GD32E50x with comparators */
+
+#endif /* COMPARATOR_H */
@@ -0,0 +1,46 @@
+/*
+  Deferred log
+
+  Logs a reading of A0 every 10 ms and the time each log call took, from
+  loop() and from a button interrupt. Nothing is formatted on the board:
+  the output on Serial is binary. Turn it back into text on the host with
+  the ELF file of this build (Sketch > Export compiled binary):
+
+    python3 tools/deferred_log.py DeferredLog.ino.elf --port /dev/ttyUSB0 --baud 115200
+*/
+
+#include <DeferredLog.h>
+
+#ifdef KEY0
+static volatile uint32_t presses;
+
+static void buttonPressed(void)
+{
+    presses++;
+    DLOG("button pressed, %u so far", (unsigned)presses);
+}
+#endif
+
+void setup()
+{
+    Serial.begin(115200);
+    DeferredLog.begin(Serial);
+    DLOG("started at %lu Hz, %s", SystemCoreClock, "deferred log example");
+#ifdef KEY0
+    pinMode(KEY0, INPUT);
+    attachInterrupt(digitalPinToInterrupt(KEY0), buttonPressed, FALLING);
+#endif
+}
+
+void loop()
+{
+    uint32_t start;
+    uint32_t took;
+    int value = analogRead(A0);
+
+    start = cycles();
+    DLOG("A0 = %d (%f V)", value, value * 3.3f / 4095);
+    took = cycles() - start;
+    DLOG("last DLOG took %u cycles", (unsigned)took);
+    delay(10);
+}
@@ -0,0 +1,217 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "DeferredLog.h"
+
+#if (DEFERRED_LOG_BUFFER_SIZE & (DEFERRED_LOG_BUFFER_SIZE - 1)) != 0
+#error "DEFERRED_LOG_BUFFER_SIZE must be a power of two"
+#endif
+#if DEFERRED_LOG_FRAME_SIZE > 254
+#error "DEFERRED_LOG_FRAME_SIZE must fit a COBS block"
+#endif
+
+DeferredLogger DeferredLog;
+
+/*!
+    \brief      DeferredLogger object construct
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+DeferredLogger::DeferredLogger(void)
+{
+    this->out = NULL;
+    this->head = 0;
+    this->tail = 0;
+    this->lost = 0;
+    this->reported = 0;
+    this->posted = false;
+}
+
+/*!
+    \brief      send the buffered and all later frames to out
+    \param[in]  out: where the frames go, Serial, SerialUSB, SWO or any other Print
+    \param[out] none
+    \retval     none
+*/
+void DeferredLogger::begin(Print &out)
+{
+    this->out = &out;
+    this->posted = true;
+    deferred_post(drain, this);
+}
+
+/*!
+    \brief      stop sending, frames stay buffered until the buffer is full
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void DeferredLogger::end(void)
+{
+    this->out = NULL;
+}
+
+/*!
+    \brief      send all buffered frames now, from thread level
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void DeferredLogger::flush(void)
+{
+    drain(this);
+}
+
+/*!
+    \brief      frames lost because the buffer was full
+    \param[in]  none
+    \param[out] none
+    \retval     number of frames since start-up
+*/
+uint32_t DeferredLogger::dropped(void)
+{
+    return this->lost;
+}
+
+/* the ID and a timestamp in microseconds, little endian like the arguments */
+size_t DeferredLogger::header(uint8_t *frame, uint32_t id)
+{
+    uint32_t now = micros();
+
+    memcpy(frame, &id, 4);
+    memcpy(frame + 4, &now, 4);
+    return 8;
+}
+
+/* a length byte and the characters, cut at DEFERRED_LOG_STRING_MAX */
+size_t DeferredLogger::packOne(uint8_t *frame, size_t length, const char *value)
+{
+    uint8_t size = 0;
+
+    if (value == NULL) {
+        value = "(null)";
+    }
+    while ((size < DEFERRED_LOG_STRING_MAX) && (value[size] != '\0')) {
+        size++;
+    }
+    if (length + 1 + size > DEFERRED_LOG_FRAME_SIZE) {
+        return truncate(frame, length);
+    }
+    frame[length] = size;
+    return put(frame, length + 1, value, size);
+}
+
+/* copy the frame into the ring buffer, or count it lost */
+void DeferredLogger::commit(const uint8_t *frame, size_t length)
+{
+    uint32_t primask = __get_PRIMASK();
+    bool post = false;
+    size_t i;
+
+    __disable_irq();
+    if (DEFERRED_LOG_BUFFER_SIZE - (this->head - this->tail) < length + 1) {
+        this->lost++;
+    } else {
+        this->buffer[this->head++ % DEFERRED_LOG_BUFFER_SIZE] = (uint8_t)length;
+        for (i = 0; i < length; i++) {
+            this->buffer[this->head++ % DEFERRED_LOG_BUFFER_SIZE] = frame[i];
+        }
+        if (!this->posted && (this->out != NULL)) {
+            this->posted = true;
+            post = true;
+        }
+    }
+    __set_PRIMASK(primask);
+
+    if (post) {
+        deferred_post(drain, this);
+    }
+}
+
+/* take the oldest frame out of the ring buffer, 0 if there is none */
+size_t DeferredLogger::pop(uint8_t *frame)
+{
+    uint32_t primask = __get_PRIMASK();
+    size_t length = 0;
+    size_t i;
+
+    __disable_irq();
+    if (this->head != this->tail) {
+        length = this->buffer[this->tail++ % DEFERRED_LOG_BUFFER_SIZE];
+        for (i = 0; i < length; i++) {
+            frame[i] = this->buffer[this->tail++ % DEFERRED_LOG_BUFFER_SIZE];
+        }
+    }
+    __set_PRIMASK(primask);
+    return length;
+}
+
+/* COBS-encode the frame, so it holds no 0 byte, and end it with one */
+void DeferredLogger::send(const uint8_t *frame, size_t length)
+{
+    uint8_t encoded[DEFERRED_LOG_FRAME_SIZE + 2];
+    size_t code = 0;
+    size_t n = 1;
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        if (frame[i] == 0) {
+            encoded[code] = (uint8_t)(n - code);
+            code = n++;
+        } else {
+            encoded[n++] = frame[i];
+        }
+    }
+    encoded[code] = (uint8_t)(n - code);
+    encoded[n++] = 0;
+    this->out->write(encoded, n);
+}
+
+/* deferred call: send every buffered frame, then how many were lost since the last report */
+void DeferredLogger::drain(void *arg)
+{
+    DeferredLogger *log = (DeferredLogger *)arg;
+    uint8_t frame[DEFERRED_LOG_FRAME_SIZE];
+    uint32_t lost;
+    size_t length;
+
+    log->posted = false;
+    if (log->out == NULL) {
+        return;
+    }
+    while ((length = log->pop(frame)) > 0) {
+        log->send(frame, length);
+    }
+    lost = log->lost - log->reported;
+    if (lost != 0) {
+        length = log->header(frame, DEFERRED_LOG_ID_DROPPED);
+        length = put(frame, length, &lost, 4);
+        log->send(frame, length);
+        log->reported += lost;
+    }
+}
@@ -0,0 +1,181 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef DEFERREDLOG_H
+#define DEFERREDLOG_H
+
+#include "Arduino.h"
+
+/* bytes of log frames buffered until thread level sends them, a power of two */
+#ifndef DEFERRED_LOG_BUFFER_SIZE
+#define DEFERRED_LOG_BUFFER_SIZE    512
+#endif
+/* largest frame: ID, timestamp and arguments; arguments past it are cut off */
+#ifndef DEFERRED_LOG_FRAME_SIZE
+#define DEFERRED_LOG_FRAME_SIZE     64
+#endif
+/* most characters a %s argument carries */
+#ifndef DEFERRED_LOG_STRING_MAX
+#define DEFERRED_LOG_STRING_MAX     32
+#endif
+
+/* ID of the frame that reports how many frames the full buffer lost */
+#define DEFERRED_LOG_ID_DROPPED     0xFFFFFFFFU
+/* set in the ID of a frame whose arguments did not all fit, the .gd32_log section starts at 0 */
+#define DEFERRED_LOG_ID_TRUNCATED   0x80000000U
+
+/* printf-style logging formatted on the host. DLOG("adc %d: %f V", ch, volts) keeps the
+   format string in the .gd32_log section of the ELF file, which is never loaded, and
+   copies only the string's address, a micros() timestamp and the raw arguments into a
+   ring buffer: a few dozen cycles instead of formatting text, from threads and interrupts
+   alike. Thread level (deferred_run(), after every loop()) sends the frames COBS-encoded,
+   each ended by a 0 byte, to the Print given to begin(); tools/deferred_log.py turns them
+   back into text with the ELF file of the build.
+
+   Arguments go out by their C++ type: 32 bit integers, pointers and chars in 4 bytes,
+   64 bit integers in 8, float and double as a 4 byte float, strings as a length byte and
+   at most DEFERRED_LOG_STRING_MAX characters. The format must match: %d, %u, %x, %c, %p
+   and the like for 32 bit values, %lld and %llu for 64 bit ones, %f, %e and %g for floats,
+   %s for strings. An argument that does not fit the DEFERRED_LOG_FRAME_SIZE byte frame is
+   dropped with all that follow it, and the decoder marks the line as cut. Frames logged
+   before begin() wait in the buffer */
+class DeferredLogger
+{
+    public:
+        DeferredLogger(void);                                                     //DeferredLogger object construct
+        void begin(Print &out);                                                   //send frames to out
+        void end(void);                                                           //stop sending, keep logging
+        void flush(void);                                                         //send all buffered frames now
+        uint32_t dropped(void);                                                   //frames lost to a full buffer
+
+        template<typename... Args>
+        void log(uint32_t id, Args... args)                                       //buffer one frame
+        {
+            uint8_t frame[DEFERRED_LOG_FRAME_SIZE];
+            size_t length = header(frame, id);
+
+            length = pack(frame, length, args...);
+            commit(frame, length);
+        }
+
+    private:
+        static void drain(void *arg);
+        size_t header(uint8_t *frame, uint32_t id);
+        void commit(const uint8_t *frame, size_t length);
+        size_t pop(uint8_t *frame);
+        void send(const uint8_t *frame, size_t length);
+
+        static size_t put(uint8_t *frame, size_t length, const void *value, size_t size)
+        {
+            if (length + size > DEFERRED_LOG_FRAME_SIZE) {
+                return truncate(frame, length);
+            }
+            memcpy(frame + length, value, size);
+            return length + size;
+        }
+        /* flag the ID, the frame ends with the arguments that fit */
+        static size_t truncate(uint8_t *frame, size_t length)
+        {
+            frame[3] |= (uint8_t)(DEFERRED_LOG_ID_TRUNCATED >> 24);
+            return length;
+        }
+        static bool truncated(const uint8_t *frame)
+        {
+            return (frame[3] & (uint8_t)(DEFERRED_LOG_ID_TRUNCATED >> 24)) != 0;
+        }
+        static size_t pack(uint8_t *frame, size_t length)
+        {
+            (void)frame;
+            return length;
+        }
+        template<typename T, typename... Args>
+        static size_t pack(uint8_t *frame, size_t length, T value, Args... args)
+        {
+            length = packOne(frame, length, value);
+            /* the arguments after a dropped one would be decoded at the wrong place */
+            if (truncated(frame)) {
+                return length;
+            }
+            return pack(frame, length, args...);
+        }
+        static size_t packOne(uint8_t *frame, size_t length, int value)
+        {
+            return put(frame, length, &value, 4);
+        }
+        static size_t packOne(uint8_t *frame, size_t length, unsigned int value)
+        {
+            return put(frame, length, &value, 4);
+        }
+        static size_t packOne(uint8_t *frame, size_t length, long value)
+        {
+            int32_t v = (int32_t)value;
+            return put(frame, length, &v, 4);
+        }
+        static size_t packOne(uint8_t *frame, size_t length, unsigned long value)
+        {
+            uint32_t v = (uint32_t)value;
+            return put(frame, length, &v, 4);
+        }
+        static size_t packOne(uint8_t *frame, size_t length, long long value)
+        {
+            return put(frame, length, &value, 8);
+        }
+        static size_t packOne(uint8_t *frame, size_t length, unsigned long long value)
+        {
+            return put(frame, length, &value, 8);
+        }
+        static size_t packOne(uint8_t *frame, size_t length, double value)
+        {
+            float v = (float)value;
+            return put(frame, length, &v, 4);
+        }
+        static size_t packOne(uint8_t *frame, size_t length, const void *value)
+        {
+            uint32_t v = (uint32_t)(uintptr_t)value;
+            return put(frame, length, &v, 4);
+        }
+        static size_t packOne(uint8_t *frame, size_t length, const char *value);
+
+        Print *out;
+        uint8_t buffer[DEFERRED_LOG_BUFFER_SIZE];
+        volatile uint32_t head;
+        volatile uint32_t tail;
+        volatile uint32_t lost;
+        uint32_t reported;
+        volatile bool posted;
+};
+
+extern DeferredLogger DeferredLog;
+
+/* log a format string and its arguments, the string must be a literal */
+#define DLOG(format, ...)                                                                  \
+    do {                                                                                   \
+        static const char dlog_format_[] __attribute__((section(".gd32_log"), used)) = format; \
+        DeferredLog.log((uint32_t)(uintptr_t)dlog_format_, ##__VA_ARGS__);                 \
+    } while (0)
+
+#endif /* DEFERREDLOG_H */
@@ -35,4 +35,21 @@
 #define EEPROM_EMULATION_SIZE 4096
 #endif
 
+/*
+ * Parts with only a few KB of RAM can't spare a RAM copy of the whole
+ * storage, so they read straight from flash and cache a single page.
+ * Define EEPROM_EMULATION_DIRECT to 0 or 1 to choose either way.
+ */
+#ifndef EEPROM_EMULATION_DIRECT
+#if defined(GD32F1x0) || defined(GD32F3x0) || defined(GD32E23x)
+#define EEPROM_EMULATION_DIRECT 1
+#else
+#define EEPROM_EMULATION_DIRECT 0
+#endif
+#endif
+
+#if EEPROM_EMULATION_DIRECT
+static EEPROMClass<EEPROM_EMULATION_SIZE, FlashDirectStorage<EEPROM_EMULATION_SIZE>> EEPROM;
+#else
 static EEPROMClass<EEPROM_EMULATION_SIZE> EEPROM;
+#endif
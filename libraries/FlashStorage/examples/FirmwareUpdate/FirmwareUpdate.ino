@@ -0,0 +1,27 @@
+/*
+  Blink while taking a new firmware image on Serial, then switch to it:
+
+    tools/firmware_update.py --port /dev/ttyUSB0 build/sketch.ino.bin
+
+  The LED keeps blinking during the transfer, as the image is written
+  to the spare flash bank while the sketch runs. Nothing else may use
+  Serial meanwhile.
+*/
+#include <FirmwareUpdate.h>
+
+void setup()
+{
+    pinMode(LED_BUILTIN, OUTPUT);
+    Serial.begin(115200);
+}
+
+void loop()
+{
+    digitalWrite(LED_BUILTIN, (millis() / 250) % 2);
+
+    if (FirmwareUpdate.poll(Serial) == FirmwareUpdateClass::READY) {
+        // let the 'D' reach the host, then reset into the new image
+        Serial.flush();
+        FirmwareUpdate.apply();
+    }
+}
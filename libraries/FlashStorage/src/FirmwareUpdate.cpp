@@ -0,0 +1,272 @@
+/* -*- mode: c++ -*-
+ * Copyright (c) 2020  GigaDevice Semiconductor Inc.
+ *               2021, 2022  Keyboard.io, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "FirmwareUpdate.h"
+#include "FlashRam.h"
+
+#define FIRMWARE_UPDATE_MAGIC 0x55464447U /* "GDFU" */
+
+/* from the linker script, the initial values of .data are the last thing in flash */
+extern "C" uint32_t _sidata[], _sdata[], _edata[];
+
+struct FirmwareUpdateHeader {
+    uint32_t magic;
+    uint32_t size;
+    uint32_t crc;
+    uint32_t check;                                           //all of the above xor'ed, inverted
+};
+
+static constexpr uint32_t flash_base = FlashGeometry::base_address;
+static constexpr bool dual_bank = ARDUINO_UPLOAD_MAXIMUM_SIZE > FLASH_BANK0_SIZE;
+// The second bank, or the upper half of a single one.
+static constexpr uint32_t slot_start = dual_bank ? FlashGeometry::bank0_end + 1
+                                       : flash_base + ARDUINO_UPLOAD_MAXIMUM_SIZE / 2 / FLASH_BANK0_PAGE_SIZE * FLASH_BANK0_PAGE_SIZE;
+static constexpr uint32_t slot_end = flash_base + ARDUINO_UPLOAD_MAXIMUM_SIZE - FIRMWARE_UPDATE_RESERVED;
+// A page for the header, then the image.
+static constexpr uint32_t header_address = slot_start;
+static constexpr uint32_t image_start = slot_start + FlashGeometry::pageSize(slot_start);
+static constexpr uint32_t image_max = slot_end <= image_start ? 0
+                                      : (slot_end - image_start < slot_start - flash_base ? slot_end - image_start
+                                         : slot_start - flash_base);
+
+static_assert(FlashGeometry::pageAligned(slot_end), "FIRMWARE_UPDATE_RESERVED must be whole flash pages.");
+
+FirmwareUpdateClass FirmwareUpdate;
+
+static uint32_t headerCheck(const FirmwareUpdateHeader *header)
+{
+    return ~(header->magic ^ header->size ^ header->crc);
+}
+
+// Copy the image over the program and reset into it. Runs from RAM with
+// interrupts off, as the program it runs for is being erased.
+FLASH_RAMFUNC static void __attribute__((noreturn)) firmwareUpdateCopy(uint32_t size)
+{
+    const uint32_t *source = (const uint32_t *)image_start;
+    uint32_t address = flash_base;
+    uint32_t left = (size + 3) / 4;
+
+    while (left > 0) {
+        uint32_t words = (address > FlashGeometry::bank0_end ? FLASH_BANK1_PAGE_SIZE : FLASH_BANK0_PAGE_SIZE) / 4;
+
+        if (words > left) {
+            words = left;
+        }
+        flash_ram_page_erase(address);
+        flash_ram_program(address, source, words);
+        address += words * 4;
+        source += words;
+        left -= words;
+    }
+    // only now, so a copy cut short starts over
+    flash_ram_page_erase(header_address);
+
+    __DSB();
+    SCB->AIRCR = (0x5FAUL << SCB_AIRCR_VECTKEY_Pos) | SCB_AIRCR_SYSRESETREQ_Msk;
+    __DSB();
+    while (true)
+        ;
+}
+
+// Install an image end() left in the slot, right after init().
+__attribute__((constructor(102))) static void firmwareUpdateInstall(void)
+{
+    const FirmwareUpdateHeader *header = (const FirmwareUpdateHeader *)header_address;
+
+    if (image_max == 0 || header->magic != FIRMWARE_UPDATE_MAGIC) {
+        return;
+    }
+    fmc_unlock();
+    if (header->check != headerCheck(header) || header->size > image_max
+            || HardwareCRC::crc32((const void *)image_start, header->size) != header->crc) {
+        flash_ram_page_erase(header_address);
+        return;
+    }
+    __disable_irq();
+    firmwareUpdateCopy(header->size);
+}
+
+bool FirmwareUpdateClass::fail(Status error)
+{
+    state = error;
+    return false;
+}
+
+uint32_t FirmwareUpdateClass::maxSize(void)
+{
+    return image_max;
+}
+
+// Erase the header page, so nothing is pending, and take an image of
+// size bytes. Its pages are erased as write() gets to them.
+bool FirmwareUpdateClass::begin(uint32_t size)
+{
+    uint32_t program_end = (uint32_t)_sidata + ((uint32_t)_edata - (uint32_t)_sdata);
+
+    if (size == 0 || size > image_max || program_end > slot_start) {
+        return fail(ERROR_SIZE);
+    }
+    fmc_unlock();
+    if (flash_ram_page_erase(header_address) != FMC_READY) {
+        return fail(ERROR_FLASH);
+    }
+    this->size = size;
+    offset = 0;
+    state = RECEIVING;
+    return true;
+}
+
+// Program the image a word at a time, erasing each page as it is reached.
+// The wait for the controller runs from RAM; with the slot in the second
+// bank the program and its interrupts carry on meanwhile.
+size_t FirmwareUpdateClass::write(const uint8_t *data, size_t length)
+{
+    size_t done = 0;
+
+    if (state != RECEIVING) {
+        return 0;
+    }
+    if (length > size - offset) {
+        length = size - offset;
+    }
+    while (done < length) {
+        carry[offset % 4] = data[done++];
+        offset++;
+        if (offset % 4 != 0 && offset != size) {
+            continue;
+        }
+        for (uint32_t i = offset % 4; i != 0 && i < 4; i++) {
+            carry[i] = 0xff;
+        }
+
+        uint32_t address = image_start + (offset - 1) / 4 * 4;
+        uint32_t word;
+
+        memcpy(&word, carry, 4);
+
+        if (FlashGeometry::pageAligned(address) && flash_ram_page_erase(address) != FMC_READY) {
+            fail(ERROR_FLASH);
+            break;
+        }
+        if (flash_ram_word_program(address, word) != FMC_READY) {
+            fail(ERROR_FLASH);
+            break;
+        }
+    }
+    return done;
+}
+
+// Check the image in flash against crc, the CRC-32 of zlib, and mark it
+// for installation.
+bool FirmwareUpdateClass::end(uint32_t crc)
+{
+    FirmwareUpdateHeader header = { FIRMWARE_UPDATE_MAGIC, size, crc, 0 };
+
+    if (state != RECEIVING || offset != size) {
+        return fail(state == RECEIVING ? ERROR_SIZE : state);
+    }
+    if (HardwareCRC::crc32((const void *)image_start, size) != crc) {
+        return fail(ERROR_CRC);
+    }
+    header.check = headerCheck(&header);
+    if (flash_ram_program(header_address, (const uint32_t *)&header, sizeof(header) / 4) != FMC_READY) {
+        return fail(ERROR_FLASH);
+    }
+    state = READY;
+    return true;
+}
+
+void FirmwareUpdateClass::abort(void)
+{
+    if (state != IDLE) {
+        flash_ram_page_erase(header_address);
+    }
+    state = IDLE;
+    headerLength = 0;
+}
+
+// The protocol of tools/firmware_update.py: "GDFU", size and CRC-32 as
+// little-endian words, answered by 'R' or 'E'; then the image, with a 'K'
+// after every FIRMWARE_UPDATE_CHUNK bytes, and 'D' or 'E' after the last.
+FirmwareUpdateClass::Status FirmwareUpdateClass::poll(Stream &stream)
+{
+    static const char magic[] = "GDFU";
+    int c;
+
+    while (state != RECEIVING && (c = stream.read()) >= 0) {
+        if (headerLength < 4 && c != magic[headerLength]) {
+            // resynchronize on the next "GDFU"
+            headerLength = 0;
+            if (c != magic[0]) {
+                continue;
+            }
+        }
+        header[headerLength++] = c;
+        if (headerLength == sizeof(header)) {
+            uint32_t length;
+
+            headerLength = 0;
+            memcpy(&length, header + 4, 4);
+            memcpy(&crc, header + 8, 4);
+            chunk = 0;
+            stream.write(begin(length) ? 'R' : 'E');
+        }
+    }
+
+    if (state == RECEIVING) {
+        uint8_t buffer[FIRMWARE_UPDATE_CHUNK];
+        size_t length = stream.available();
+
+        if (length > FIRMWARE_UPDATE_CHUNK - chunk) {
+            length = FIRMWARE_UPDATE_CHUNK - chunk;
+        }
+        if (length > size - offset) {
+            length = size - offset;
+        }
+        length = stream.readBytes(buffer, length);
+        write(buffer, length);
+        chunk += length;
+        if (state != RECEIVING) {
+            stream.write('E');
+        } else if (offset == size) {
+            stream.write(end(crc) ? 'D' : 'E');
+        } else if (chunk == FIRMWARE_UPDATE_CHUNK) {
+            stream.write('K');
+            chunk = 0;
+        }
+    }
+    return state;
+}
+
+void FirmwareUpdateClass::apply(void)
+{
+    if (state == READY) {
+        NVIC_SystemReset();
+    }
+}
@@ -0,0 +1,107 @@
+/* -*- mode: c++ -*-
+ * Copyright (c) 2020  GigaDevice Semiconductor Inc.
+ *               2021, 2022  Keyboard.io, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "FlashGeometry.h"
+
+/*
+ * Firmware updates while the application runs. The new image goes into an
+ * update slot: the second flash bank on parts that have one, so writing it
+ * never stalls the program running from the first, otherwise the upper
+ * half of flash, where each page erase stalls the CPU as a FlashStorage
+ * commit does. end() checks the image against its CRC-32 with the CRC
+ * unit; apply() resets, and during start-up the image is copied over the
+ * running program from RAM and the part resets into it.
+ *
+ * The GD32 parts can't run an image from the second bank in place, so the
+ * copy is what swaps; the old program is gone afterwards. The copy takes
+ * a second or two, as long as erasing and programming the image; power
+ * lost meanwhile leaves a part that needs its bootloader or SWD. An update
+ * interrupted any time before that does no harm.
+ *
+ * The slot ends where FlashStorage areas at the end of flash start: define
+ * FIRMWARE_UPDATE_RESERVED to the flash they take. The program doing the
+ * update must end below the slot, and images can't be bigger than it.
+ *
+ * Feed the image with write() from any source, a CAN or network protocol
+ * for instance, or let poll() take it from a Stream (Serial, a CDC port)
+ * as tools/firmware_update.py sends it.
+ */
+#ifndef FIRMWARE_UPDATE_RESERVED
+#define FIRMWARE_UPDATE_RESERVED 0
+#endif
+
+/* bytes poll() takes before it acknowledges, at most the receive buffer of the Stream */
+#ifndef FIRMWARE_UPDATE_CHUNK
+#define FIRMWARE_UPDATE_CHUNK 64
+#endif
+
+class FirmwareUpdateClass
+{
+    public:
+        enum Status {
+            IDLE,                                             //no update in progress
+            RECEIVING,                                        //begin() done, image coming
+            READY,                                            //image checked, apply() installs it
+            ERROR_SIZE,                                       //image doesn't fit the slot
+            ERROR_FLASH,                                      //erase or program failed
+            ERROR_CRC,                                        //image doesn't match its CRC
+        };
+
+        uint32_t maxSize(void);                               //biggest image the slot takes
+        bool begin(uint32_t size);                            //start receiving an image of size bytes
+        size_t write(const uint8_t *data, size_t length);     //next bytes of the image, in order
+        bool end(uint32_t crc);                               //check the image against its CRC-32
+        void abort(void);                                     //drop the image
+        Status poll(Stream &stream);                          //receive from tools/firmware_update.py
+        void apply(void);                                     //reset and install the READY image
+        Status status(void)                                   //state of the update
+        {
+            return state;
+        }
+        uint32_t received(void)                               //image bytes so far
+        {
+            return offset;
+        }
+
+    private:
+        bool fail(Status error);
+        Status state = IDLE;
+        uint32_t size = 0;                                    //of the image
+        uint32_t offset = 0;                                  //bytes written to the slot or carried
+        uint8_t carry[4];                                      //bytes short of a whole word
+        uint8_t header[12];                                   //poll(): magic, size and CRC
+        uint8_t headerLength = 0;
+        uint32_t crc = 0;
+        uint32_t chunk = 0;                                   //poll(): bytes since the last acknowledge
+};
+
+extern FirmwareUpdateClass FirmwareUpdate;
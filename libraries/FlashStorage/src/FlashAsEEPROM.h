@@ -29,12 +29,20 @@
 #pragma once
 
 #include "FlashStorage.h"
+#include "FlashLogStorage.h"
+#include "FlashDirectStorage.h"
 
-template <uint32_t _size>
+/*
+ * The storage defaults to FlashLogStorage, so a commit only programs the
+ * bytes that changed. Pass FlashStorage<_size> as the second argument for
+ * the plain image layout, which takes less flash, or FlashDirectStorage<_size>
+ * to keep only one flash page in RAM.
+ */
+template <uint32_t _size, typename _storage = FlashLogStorage<_size>>
 class EEPROMClass
 {
     private:
-        FlashStorage<_size> storage_;
+        _storage storage_;
 
     public:
         template<typename T>
@@ -62,7 +70,8 @@ class EEPROMClass
         }
         void update(uint32_t offset, uint8_t val)
         {
-            write(offset, val);
+            if (read(offset) != val)
+                write(offset, val);
         }
 
         void commit()
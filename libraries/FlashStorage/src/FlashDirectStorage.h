@@ -0,0 +1,138 @@
+/* -*- mode: c++ -*-
+ * Copyright (c) 2020  GigaDevice Semiconductor Inc.
+ *               2021, 2022  Keyboard.io, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "FlashGeometry.h"
+#include "FlashRam.h"
+
+/*
+ * Flash storage without a RAM copy, with the same interface as
+ * FlashStorage.
+ *
+ * Reads come straight from the memory-mapped flash, and writes go into a
+ * cache of a single flash page. The cached page is written back by
+ * commit(), or as soon as a write touches a different page, so data can
+ * reach flash before commit() is called. In exchange it needs one page of
+ * RAM instead of the whole storage size, and begin() doesn't copy
+ * anything.
+ */
+template <uint32_t _storage_size,
+          uint32_t _fmc_end = ARDUINO_UPLOAD_MAXIMUM_SIZE>
+class FlashDirectStorage
+{
+    private:
+        static constexpr uint32_t fmc_end_address = FlashGeometry::base_address + _fmc_end;
+        static constexpr uint32_t data_area_start = fmc_end_address - _storage_size;
+        static constexpr uint32_t page_size = FlashGeometry::pageSize(data_area_start);
+
+        static_assert(FlashGeometry::pageAligned(data_area_start)
+                      && FlashGeometry::pageAligned(fmc_end_address),
+                      "Storage must start and end on a flash page boundary.");
+        static_assert(FlashGeometry::pageSize(fmc_end_address - 1) == page_size,
+                      "Storage must not straddle flash banks with different page sizes.");
+
+        uint8_t cache_[page_size] __attribute__((aligned(4)));
+        // Flash address of the cached page, 0 if the cache is empty.
+        uint32_t cache_page_ = 0;
+        bool cache_dirty_ = false;
+
+        void flushCache()
+        {
+            if (!cache_dirty_)
+                return;
+            cache_dirty_ = false;
+
+            if (memcmp((const void *)cache_page_, cache_, page_size) == 0)
+                return;
+
+            flash_ram_page_erase(cache_page_);
+            flash_ram_program(cache_page_, (const uint32_t *)cache_, page_size / 4);
+        }
+
+        void loadCache(uint32_t page)
+        {
+            if (page == cache_page_)
+                return;
+
+            flushCache();
+            memcpy(cache_, (const void *)page, page_size);
+            cache_page_ = page;
+        }
+
+    public:
+        void begin()
+        {
+            fmc_unlock();
+        }
+
+        uint32_t length()
+        {
+            return _storage_size;
+        }
+
+        void read(uint32_t offset, uint8_t *data, uint32_t data_size)
+        {
+            // If we're out of bounds, or try to read too much, bail out.
+            if (offset > _storage_size || (data_size > (_storage_size - offset)))
+                return;
+
+            // Bytes in the cached page may be newer than flash.
+            uint32_t address = data_area_start + offset;
+            for (uint32_t i = 0; i < data_size; i++, address++) {
+                if (address - cache_page_ < page_size)
+                    data[i] = cache_[address - cache_page_];
+                else
+                    data[i] = *(const uint8_t *)address;
+            }
+        }
+
+        void write(uint32_t offset, const uint8_t *data, uint32_t data_size)
+        {
+            // If we're out of bounds, or try to write too much, bail out.
+            if (offset > _storage_size || (data_size > (_storage_size - offset)))
+                return;
+
+            uint32_t address = data_area_start + offset;
+            for (uint32_t i = 0; i < data_size; i++, address++) {
+                loadCache(address & ~(page_size - 1));
+                uint8_t &cached = cache_[address - cache_page_];
+                if (cached != data[i]) {
+                    cached = data[i];
+                    cache_dirty_ = true;
+                }
+            }
+        }
+
+        void commit()
+        {
+            flushCache();
+        }
+};
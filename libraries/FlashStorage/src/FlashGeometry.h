@@ -0,0 +1,83 @@
+/* -*- mode: c++ -*-
+ * Copyright (c) 2020  GigaDevice Semiconductor Inc.
+ *               2021, 2022  Keyboard.io, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+/*
+ * Erase page layout of the on-chip flash, by series and product line as
+ * set in boards.txt. Parts with more than FLASH_BANK0_SIZE of flash have a
+ * second bank with its own page size. A variant can override the page
+ * sizes by defining both FLASH_BANK0_PAGE_SIZE and FLASH_BANK1_PAGE_SIZE.
+ */
+#ifndef FLASH_BANK0_PAGE_SIZE
+#if defined(GD32F1x0) || defined(GD32F3x0) || defined(GD32E23x) || defined(GD32F10X_MD)
+#define FLASH_BANK0_PAGE_SIZE 1024
+#define FLASH_BANK1_PAGE_SIZE 1024
+#elif defined(GD32E50X)
+#define FLASH_BANK0_PAGE_SIZE 8192
+#define FLASH_BANK1_PAGE_SIZE 8192
+#else
+#define FLASH_BANK0_PAGE_SIZE 2048
+#define FLASH_BANK1_PAGE_SIZE 4096
+#endif
+#endif
+
+#ifndef FLASH_BANK0_SIZE
+#define FLASH_BANK0_SIZE (512 * 1024)
+#endif
+
+#ifdef __cplusplus
+struct FlashGeometry {
+    static constexpr uint32_t base_address = 0x08000000;
+    static constexpr uint32_t bank0_end = base_address + FLASH_BANK0_SIZE - 1;
+    static constexpr uint32_t max_page_size =
+        FLASH_BANK1_PAGE_SIZE > FLASH_BANK0_PAGE_SIZE ? FLASH_BANK1_PAGE_SIZE : FLASH_BANK0_PAGE_SIZE;
+
+    // Size of the erase page holding addr.
+    static constexpr uint32_t pageSize(uint32_t addr)
+    {
+        return addr > bank0_end ? FLASH_BANK1_PAGE_SIZE : FLASH_BANK0_PAGE_SIZE;
+    }
+
+    // Whether addr is the first byte of an erase page.
+    static constexpr bool pageAligned(uint32_t addr)
+    {
+        return addr % pageSize(addr) == 0;
+    }
+
+    // Round size up to whole pages of the largest size, so an area of that
+    // size ending on a page boundary also starts on one.
+    static constexpr uint32_t roundToPages(uint32_t size)
+    {
+        return (size + max_page_size - 1) / max_page_size * max_page_size;
+    }
+};
+#endif
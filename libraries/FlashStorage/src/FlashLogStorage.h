@@ -0,0 +1,247 @@
+/* -*- mode: c++ -*-
+ * Copyright (c) 2020  GigaDevice Semiconductor Inc.
+ *               2021, 2022  Keyboard.io, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "FlashGeometry.h"
+#include "FlashRam.h"
+
+/*
+ * Log-structured flash storage, with the same interface as FlashStorage.
+ *
+ * The area at the end of flash is split into two slots, each holding a
+ * header, a full image of the storage and a log of byte updates:
+ *
+ *   | magic | sequence | image (_storage_size) | log ...            |
+ *
+ * A commit appends one word per changed byte to the log of the active
+ * slot. Only once the log is full is the current contents written as a
+ * fresh image into the other slot, which then becomes the active one. So a
+ * small update costs a word program per byte instead of erasing every
+ * page, and erases alternate between the two slots.
+ *
+ * The header is programmed last, so a slot only counts once its image is
+ * complete, and the previous slot is left alone until the next time round.
+ * A commit interrupted by a reset loses at most the updates that were
+ * being written.
+ *
+ * Data written by FlashStorage (a bare image in the last _storage_size
+ * bytes) is picked up by begin() if no slot has been written yet.
+ */
+template <uint32_t _storage_size,
+          uint32_t _log_size = 2048,
+          uint32_t _fmc_end = ARDUINO_UPLOAD_MAXIMUM_SIZE>
+class FlashLogStorage
+{
+    static_assert(_storage_size % 4 == 0 && _storage_size < 0xffff,
+                  "Storage must be a multiple of 4 bytes, and smaller than 64K.");
+
+    private:
+        static constexpr uint32_t fmc_end_address = FlashGeometry::base_address + _fmc_end;
+
+        static constexpr uint32_t slot_magic = 0x4e564c31; // "NVL1"
+        static constexpr uint32_t header_size = 8;
+        static constexpr uint32_t slot_size =
+            FlashGeometry::roundToPages(header_size + _storage_size + _log_size);
+        static constexpr uint32_t log_offset = header_size + _storage_size;
+        static constexpr uint32_t log_words = (slot_size - log_offset) / 4;
+        static constexpr uint32_t data_area_start = fmc_end_address - 2 * slot_size;
+        static constexpr uint32_t legacy_area_start = fmc_end_address - _storage_size;
+        static constexpr uint32_t erased = 0xffffffff;
+
+        static_assert(FlashGeometry::pageAligned(fmc_end_address),
+                      "Storage must end on a flash page boundary.");
+
+        uint8_t buffer_[_storage_size];
+        // One bit per byte of buffer_ that differs from flash.
+        uint8_t dirty_[(_storage_size + 7) / 8];
+        bool any_dirty_ = false;
+
+        // Slot holding the current image, or -1 if none has been written.
+        int8_t active_ = -1;
+        uint32_t sequence_ = 0;
+        // Words of the active slot's log in use.
+        uint32_t log_used_ = 0;
+
+        static uint32_t slotAddress(int8_t slot)
+        {
+            return data_area_start + slot * slot_size;
+        }
+
+        static uint32_t word(uint32_t address)
+        {
+            return *(volatile uint32_t *)address;
+        }
+
+        // A log record: which byte, its new value, and a check byte to
+        // throw out words torn by a reset while programming.
+        static uint32_t record(uint16_t offset, uint8_t value)
+        {
+            uint8_t check = (offset >> 8) ^ (offset & 0xff) ^ value ^ 0xa5;
+            return ((uint32_t)offset << 16) | ((uint32_t)value << 8) | check;
+        }
+
+        static bool slotValid(int8_t slot)
+        {
+            return word(slotAddress(slot)) == slot_magic;
+        }
+
+        void replayLog()
+        {
+            uint32_t address = slotAddress(active_) + log_offset;
+
+            for (log_used_ = 0; log_used_ < log_words; log_used_++, address += 4) {
+                uint32_t w = word(address);
+                if (w == erased)
+                    break;
+
+                uint16_t offset = w >> 16;
+                uint8_t value = w >> 8;
+                if (offset < _storage_size && w == record(offset, value))
+                    buffer_[offset] = value;
+            }
+        }
+
+        void eraseSlot(int8_t slot)
+        {
+            uint32_t address = slotAddress(slot);
+            uint32_t end = address + slot_size;
+
+            while (address < end) {
+                flash_ram_page_erase(address);
+                address += FlashGeometry::pageSize(address);
+            }
+        }
+
+        // Write all of buffer_ as a new image into the other slot, and make
+        // that the active one.
+        void compact()
+        {
+            int8_t next = active_ == 0 ? 1 : 0;
+            uint32_t address = slotAddress(next);
+
+            eraseSlot(next);
+            flash_ram_program(address + header_size, (const uint32_t *)buffer_, _storage_size / 4);
+            flash_ram_word_program(address + 4, sequence_ + 1);
+            flash_ram_word_program(address, slot_magic);
+
+            active_ = next;
+            sequence_++;
+            log_used_ = 0;
+        }
+
+    public:
+        void begin()
+        {
+            fmc_unlock();
+
+            bool valid0 = slotValid(0);
+            bool valid1 = slotValid(1);
+            if (valid0 && valid1) {
+                active_ = word(slotAddress(1) + 4) > word(slotAddress(0) + 4) ? 1 : 0;
+            } else if (valid0 || valid1) {
+                active_ = valid0 ? 0 : 1;
+            } else {
+                active_ = -1;
+            }
+
+            uint8_t *src = active_ < 0 ? (uint8_t *)legacy_area_start
+                                       : (uint8_t *)(slotAddress(active_) + header_size);
+            for (uint32_t i = 0; i < _storage_size; i++) {
+                buffer_[i] = src[i];
+            }
+            memset(dirty_, 0, sizeof(dirty_));
+            any_dirty_ = false;
+
+            if (active_ >= 0) {
+                sequence_ = word(slotAddress(active_) + 4);
+                replayLog();
+            }
+        }
+
+        uint32_t length()
+        {
+            return _storage_size;
+        }
+
+        void read(uint32_t offset, uint8_t *data, uint32_t data_size)
+        {
+            // If we're out of bounds, or try to read too much, bail out.
+            if (offset > _storage_size || (data_size > (_storage_size - offset)))
+                return;
+
+            for (uint32_t i = 0; i < data_size; i++) {
+                data[i] = buffer_[i + offset];
+            }
+        }
+
+        void write(uint32_t offset, const uint8_t *data, uint32_t data_size)
+        {
+            // If we're out of bounds, or try to write too much, bail out.
+            if (offset > _storage_size || (data_size > (_storage_size - offset)))
+                return;
+
+            for (uint32_t i = 0; i < data_size; i++) {
+                uint32_t at = offset + i;
+                if (buffer_[at] != data[i]) {
+                    buffer_[at] = data[i];
+                    dirty_[at / 8] |= 1 << (at % 8);
+                    any_dirty_ = true;
+                }
+            }
+        }
+
+        void commit()
+        {
+            if (!any_dirty_)
+                return;
+
+            uint32_t changed = 0;
+            for (uint32_t i = 0; i < sizeof(dirty_); i++) {
+                changed += __builtin_popcount(dirty_[i]);
+            }
+
+            if (active_ < 0 || changed > log_words - log_used_) {
+                compact();
+            } else {
+                uint32_t address = slotAddress(active_) + log_offset + log_used_ * 4;
+                for (uint32_t i = 0; i < _storage_size; i++) {
+                    if (dirty_[i / 8] & (1 << (i % 8))) {
+                        flash_ram_word_program(address, record(i, buffer_[i]));
+                        address += 4;
+                    }
+                }
+                log_used_ += changed;
+            }
+
+            memset(dirty_, 0, sizeof(dirty_));
+            any_dirty_ = false;
+        }
+};
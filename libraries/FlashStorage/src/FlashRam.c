@@ -0,0 +1,311 @@
+/* -*- mode: c -*-
+ * Copyright (c) 2020  GigaDevice Semiconductor Inc.
+ *               2021, 2022  Keyboard.io, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "FlashRam.h"
+
+/* Registers of each bank, at the same offsets on every series. */
+#define FLASH_RAM_STAT(bank) REG32(FMC + 0x0cU + (bank) * 0x40U)
+#define FLASH_RAM_CTL(bank)  REG32(FMC + 0x10U + (bank) * 0x40U)
+#define FLASH_RAM_ADDR(bank) REG32(FMC + 0x14U + (bank) * 0x40U)
+
+#define FLASH_RAM_BUSY  BIT(0)
+#define FLASH_RAM_PGERR BIT(2)
+#define FLASH_RAM_WPERR BIT(4)
+#define FLASH_RAM_ENDF  BIT(5)
+#define FLASH_RAM_PG    BIT(0)
+#define FLASH_RAM_PER   BIT(1)
+#define FLASH_RAM_START BIT(6)
+
+static uint32_t ram_vectors[FLASH_RAM_VECTOR_COUNT]
+__attribute__((aligned(FLASH_RAM_VECTOR_COUNT * 4)));
+
+void flash_ram_vectors_init(void)
+{
+    if (SCB->VTOR == (uint32_t)ram_vectors) {
+        return;
+    }
+
+    const uint32_t *flash_vectors = (const uint32_t *)SCB->VTOR;
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    for (uint32_t i = 0; i < FLASH_RAM_VECTOR_COUNT; i++) {
+        ram_vectors[i] = flash_vectors[i];
+    }
+    __DSB();
+    SCB->VTOR = (uint32_t)ram_vectors;
+    __DSB();
+    __set_PRIMASK(primask);
+}
+
+void flash_ram_set_handler(IRQn_Type irq, void (*handler)(void))
+{
+    flash_ram_vectors_init();
+    ram_vectors[16 + irq] = (uint32_t)handler;
+    __DSB();
+}
+
+/* Only the parts with more than FLASH_BANK0_SIZE of flash have a second
+ * set of controller registers. */
+static inline __attribute__((always_inline)) uint32_t flash_ram_bank(uint32_t address)
+{
+#if defined(FMC_CTL1)
+    return address >= FLASH_BASE + FLASH_BANK0_SIZE ? 1 : 0;
+#else
+    (void)address;
+    return 0;
+#endif
+}
+
+/* Wait for the bank to finish, then read and clear its result. Runs in
+ * RAM, so interrupts taken meanwhile only stall if they touch flash. */
+static inline __attribute__((always_inline)) fmc_state_enum flash_ram_wait(uint32_t bank)
+{
+    while (FLASH_RAM_STAT(bank) & FLASH_RAM_BUSY)
+        ;
+
+    uint32_t stat = FLASH_RAM_STAT(bank);
+    FLASH_RAM_STAT(bank) = FLASH_RAM_ENDF | FLASH_RAM_PGERR | FLASH_RAM_WPERR;
+
+    if (stat & FLASH_RAM_WPERR) {
+        return FMC_WPERR;
+    } else if (stat & FLASH_RAM_PGERR) {
+        return FMC_PGERR;
+    }
+    return FMC_READY;
+}
+
+/* Start erasing the page holding address, once its bank is idle. */
+static inline __attribute__((always_inline)) fmc_state_enum flash_ram_erase_start(uint32_t bank,
+                                                                                 uint32_t address)
+{
+    fmc_state_enum state = flash_ram_wait(bank);
+
+    if (state == FMC_READY) {
+        FLASH_RAM_CTL(bank) |= FLASH_RAM_PER;
+        FLASH_RAM_ADDR(bank) = address;
+        FLASH_RAM_CTL(bank) |= FLASH_RAM_START;
+    }
+    return state;
+}
+
+/* Drop what the flash caches hold of the old contents, on the series
+ * that have them; a cache is only reset while it is off. */
+static inline __attribute__((always_inline)) void flash_ram_cache_reset(void)
+{
+#if defined(FMC_WS_ICEN)
+    uint32_t enabled = FMC_WS & (FMC_WS_ICEN | FMC_WS_DCEN);
+
+    FMC_WS &= ~(FMC_WS_ICEN | FMC_WS_DCEN);
+    FMC_WS |= FMC_WS_ICRST | FMC_WS_DCRST;
+    FMC_WS &= ~(FMC_WS_ICRST | FMC_WS_DCRST);
+    FMC_WS |= enabled;
+#endif
+}
+
+static inline __attribute__((always_inline)) fmc_state_enum flash_ram_erase_end(uint32_t bank)
+{
+    fmc_state_enum state = flash_ram_wait(bank);
+
+    FLASH_RAM_CTL(bank) &= ~FLASH_RAM_PER;
+    flash_ram_cache_reset();
+    return state;
+}
+
+struct flash_ram_run {
+    uint32_t address;
+    const uint32_t *data;
+    uint32_t count;
+    uint32_t bank;
+};
+
+/* Start programming the next unit of run that isn't left erased. Returns
+ * false once the run is done. */
+static inline __attribute__((always_inline)) bool flash_ram_program_start(struct flash_ram_run *run)
+{
+    while (run->count > 0 && run->data[0] == 0xffffffff) {
+        run->address += 4;
+        run->data++;
+        run->count--;
+    }
+    if (run->count == 0) {
+        return false;
+    }
+
+#if defined(FMC_WS_PGW)
+    if (run->count >= 2 && run->address % 8 == 0) {
+        FMC_WS |= FMC_WS_PGW;
+        REG32(run->address) = run->data[0];
+        REG32(run->address + 4) = run->data[1];
+        run->address += 8;
+        run->data += 2;
+        run->count -= 2;
+        return true;
+    }
+    FMC_WS &= ~FMC_WS_PGW;
+#endif
+    REG32(run->address) = run->data[0];
+    run->address += 4;
+    run->data++;
+    run->count--;
+    return true;
+}
+
+/* Program runs, which are all in different banks, a unit from each at a
+ * time. */
+static inline __attribute__((always_inline)) fmc_state_enum flash_ram_program_runs(struct flash_ram_run *runs,
+                                                                                  uint32_t n)
+{
+    fmc_state_enum state = FMC_READY;
+    bool started[2];
+
+    for (uint32_t i = 0; i < n; i++) {
+        state = flash_ram_wait(runs[i].bank);
+        if (state != FMC_READY) {
+            return state;
+        }
+        FLASH_RAM_CTL(runs[i].bank) |= FLASH_RAM_PG;
+    }
+
+    do {
+        bool any = false;
+
+        for (uint32_t i = 0; i < n; i++) {
+            started[i] = flash_ram_program_start(&runs[i]);
+            any |= started[i];
+        }
+        if (!any) {
+            break;
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            if (started[i]) {
+                fmc_state_enum result = flash_ram_wait(runs[i].bank);
+                if (state == FMC_READY) {
+                    state = result;
+                }
+            }
+        }
+    } while (state == FMC_READY);
+
+    for (uint32_t i = 0; i < n; i++) {
+        FLASH_RAM_CTL(runs[i].bank) &= ~FLASH_RAM_PG;
+    }
+#if defined(FMC_WS_PGW)
+    FMC_WS &= ~FMC_WS_PGW;
+#endif
+    flash_ram_cache_reset();
+    return state;
+}
+
+FLASH_RAMFUNC fmc_state_enum flash_ram_page_erase(uint32_t address)
+{
+    uint32_t bank = flash_ram_bank(address);
+    fmc_state_enum state = flash_ram_erase_start(bank, address);
+
+    if (state != FMC_READY) {
+        return state;
+    }
+    return flash_ram_erase_end(bank);
+}
+
+FLASH_RAMFUNC fmc_state_enum flash_ram_word_program(uint32_t address, uint32_t data)
+{
+    struct flash_ram_run run = { address, &data, 1, flash_ram_bank(address) };
+
+    if (data == 0xffffffff) {
+        return FMC_READY;
+    }
+    return flash_ram_program_runs(&run, 1);
+}
+
+FLASH_RAMFUNC fmc_state_enum flash_ram_program(uint32_t address, const uint32_t *data,
+                                               uint32_t count)
+{
+    struct flash_ram_run run = { address, data, count, flash_ram_bank(address) };
+
+    return flash_ram_program_runs(&run, 1);
+}
+
+FLASH_RAMFUNC fmc_state_enum flash_ram_page_erase_pair(uint32_t address0, uint32_t address1)
+{
+    uint32_t bank0 = flash_ram_bank(address0);
+    uint32_t bank1 = flash_ram_bank(address1);
+    fmc_state_enum state = FMC_READY;
+
+    if (address0 == 0 || address1 == 0 || bank0 == bank1) {
+        if (address0 != 0) {
+            state = flash_ram_erase_start(bank0, address0);
+            if (state == FMC_READY) {
+                state = flash_ram_erase_end(bank0);
+            }
+        }
+        if (address1 != 0 && state == FMC_READY) {
+            state = flash_ram_erase_start(bank1, address1);
+            if (state == FMC_READY) {
+                state = flash_ram_erase_end(bank1);
+            }
+        }
+        return state;
+    }
+
+    state = flash_ram_erase_start(bank0, address0);
+    if (state != FMC_READY) {
+        return state;
+    }
+    state = flash_ram_erase_start(bank1, address1);
+    fmc_state_enum state0 = flash_ram_erase_end(bank0);
+    if (state == FMC_READY) {
+        state = flash_ram_erase_end(bank1);
+    }
+    return state0 != FMC_READY ? state0 : state;
+}
+
+FLASH_RAMFUNC fmc_state_enum flash_ram_program_pair(uint32_t address0, const uint32_t *data0,
+                                                    uint32_t count0, uint32_t address1,
+                                                    const uint32_t *data1, uint32_t count1)
+{
+    struct flash_ram_run runs[2] = {
+        { address0, data0, address0 != 0 ? count0 : 0, flash_ram_bank(address0) },
+        { address1, data1, address1 != 0 ? count1 : 0, flash_ram_bank(address1) },
+    };
+    fmc_state_enum state;
+
+    if (runs[0].count == 0) {
+        return flash_ram_program_runs(&runs[1], 1);
+    } else if (runs[1].count == 0) {
+        return flash_ram_program_runs(&runs[0], 1);
+    } else if (runs[0].bank != runs[1].bank) {
+        return flash_ram_program_runs(runs, 2);
+    }
+    state = flash_ram_program_runs(&runs[0], 1);
+    if (state == FMC_READY) {
+        state = flash_ram_program_runs(&runs[1], 1);
+    }
+    return state;
+}
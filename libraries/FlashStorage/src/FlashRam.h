@@ -0,0 +1,97 @@
+/* -*- mode: c++ -*-
+ * Copyright (c) 2020  GigaDevice Semiconductor Inc.
+ *               2021, 2022  Keyboard.io, Inc.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *  3. Neither the name of the copyright holder nor the names of its contributors
+ *     may be used to endorse or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include "FlashGeometry.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Flash erase and program routines that run from RAM.
+ *
+ * While the flash controller erases a page, every fetch from that bank
+ * stalls, so an interrupt whose handler or vector lives in flash waits
+ * for the whole erase. These routines wait for the controller in RAM
+ * with interrupts enabled. Together with a vector table moved to RAM by
+ * flash_ram_vectors_init() and handlers marked FLASH_RAMFUNC, the
+ * interrupts that matter keep running during a commit.
+ *
+ * A FLASH_RAMFUNC handler must only call other FLASH_RAMFUNC code while
+ * flash is busy; anything else it touches in flash stalls it again.
+ */
+#define FLASH_RAMFUNC __attribute__((section(".data.ramfunc"), noinline, long_call))
+
+/*
+ * Entries in the RAM vector table, enough for the 16 system exceptions
+ * and every interrupt of the supported series.
+ */
+#ifndef FLASH_RAM_VECTOR_COUNT
+#define FLASH_RAM_VECTOR_COUNT 128
+#endif
+
+/*
+ * Copy the vector table into RAM and point the core at the copy. Safe to
+ * call more than once.
+ */
+void flash_ram_vectors_init(void);
+
+/*
+ * Install a handler in the RAM vector table, moving it there first if
+ * needed.
+ */
+void flash_ram_set_handler(IRQn_Type irq, void (*handler)(void));
+
+FLASH_RAMFUNC fmc_state_enum flash_ram_page_erase(uint32_t address);
+FLASH_RAMFUNC fmc_state_enum flash_ram_word_program(uint32_t address, uint32_t data);
+
+/*
+ * Program count words, in the widest unit the controller has: double
+ * words on the GD32E23x, words elsewhere. Words of data that are still
+ * erased are skipped.
+ */
+FLASH_RAMFUNC fmc_state_enum flash_ram_program(uint32_t address, const uint32_t *data,
+                                               uint32_t count);
+
+/*
+ * As above, for a page or run in each bank. On parts with two banks the
+ * controllers work on both at once, otherwise one after the other. An
+ * address of 0 leaves that half out.
+ */
+FLASH_RAMFUNC fmc_state_enum flash_ram_page_erase_pair(uint32_t address0, uint32_t address1);
+FLASH_RAMFUNC fmc_state_enum flash_ram_program_pair(uint32_t address0, const uint32_t *data0,
+                                                    uint32_t count0, uint32_t address1,
+                                                    const uint32_t *data1, uint32_t count1);
+
+#ifdef __cplusplus
+}
+#endif
@@ -30,30 +30,49 @@
 #pragma once
 
 #include <Arduino.h>
+#include "FlashGeometry.h"
+#include "FlashRam.h"
 
 template <uint32_t _storage_size,
           uint32_t _fmc_end = ARDUINO_UPLOAD_MAXIMUM_SIZE>
 class FlashStorage
 {
-    static_assert(_storage_size % 4096 == 0,
-                  "Storage must be page aligned, with a size multiple of 4096.");
-
     private:
-        uint8_t buffer_[_storage_size];
-        static constexpr uint32_t fmc_base_address = 0x08000000;
-        static constexpr uint32_t bank0_size = 512 * 1024;
-        static constexpr uint32_t bank0_end = fmc_base_address + bank0_size - 1;
-        static constexpr uint32_t fmc_end_address = fmc_base_address + _fmc_end;
+        uint8_t buffer_[_storage_size] __attribute__((aligned(4)));
+        static constexpr uint32_t fmc_end_address = FlashGeometry::base_address + _fmc_end;
         static constexpr uint32_t data_area_start = fmc_end_address - _storage_size;
+        // Where the area crosses into the second bank, or its end if it
+        // doesn't. The two halves are committed side by side.
+        static constexpr uint32_t bank_split =
+            data_area_start <= FlashGeometry::bank0_end && fmc_end_address - 1 > FlashGeometry::bank0_end
+            ? FlashGeometry::bank0_end + 1 : fmc_end_address;
+        // Next page of each half of a commit in progress.
+        uint32_t commit_address_ = bank_split;
+        uint32_t commit_address1_ = fmc_end_address;
+
+        uint32_t *bufferAt(uint32_t address)
+        {
+            return (uint32_t *)(buffer_ + (address - data_area_start));
+        }
 
-        uint16_t pageSizeForAddress(uint32_t addr)
+        // Move cursor past its next page, if there is one before end.
+        // Returns that page if the buffer differs from it, 0 otherwise.
+        uint32_t takePage(uint32_t &cursor, uint32_t end)
         {
-            if (addr > bank0_end)
-                return 4096;
-            else
-                return 2048;
+            if (cursor >= end)
+                return 0;
+
+            uint32_t address = cursor;
+            uint32_t page_size = FlashGeometry::pageSize(address);
+
+            cursor += page_size;
+            return memcmp((const void *)address, bufferAt(address), page_size) == 0 ? 0 : address;
         }
 
+        static_assert(FlashGeometry::pageAligned(data_area_start)
+                      && FlashGeometry::pageAligned(fmc_end_address),
+                      "Storage must start and end on a flash page boundary.");
+
     public:
         void begin()
         {
@@ -98,20 +117,41 @@ class FlashStorage
 
         void commit()
         {
-            uint32_t address = data_area_start;
-            uint32_t *ptrs = (uint32_t *)buffer_;
+            commitAsync();
+            while (commitStep())
+                ;
+        }
+
+        // Start writing the buffer back to flash, a page per commitStep()
+        // call, so the caller decides when the CPU is given to flash.
+        // Writes made meanwhile to pages already done need another commit.
+        void commitAsync()
+        {
+            commit_address_ = data_area_start;
+            commit_address1_ = bank_split;
+        }
 
-            do {
-                uint16_t page_size = pageSizeForAddress(address);
-                fmc_page_erase(address);
+        bool commitBusy()
+        {
+            return commit_address_ < bank_split || commit_address1_ < fmc_end_address;
+        }
 
-                uint32_t word_count = page_size / 4;
-                uint32_t i = 0;
+        // Write back the next page of a commit, or one from each bank if
+        // the area spans both, which the two controllers erase and program
+        // at once. Only pages that differ from flash are erased and
+        // programmed, and words left erased are skipped. The erase and
+        // programming run from RAM, see FlashRam.h. Returns whether there
+        // is more to do.
+        bool commitStep()
+        {
+            uint32_t address0 = takePage(commit_address_, bank_split);
+            uint32_t address1 = takePage(commit_address1_, fmc_end_address);
 
-                do {
-                    fmc_word_program(address, *ptrs++);
-                    address += 4U;
-                } while (++i < word_count);
-            } while (address < fmc_end_address);
+            if (address0 != 0 || address1 != 0) {
+                flash_ram_page_erase_pair(address0, address1);
+                flash_ram_program_pair(address0, bufferAt(address0), FlashGeometry::pageSize(address0) / 4,
+                                       address1, bufferAt(address1), FlashGeometry::pageSize(address1) / 4);
+            }
+            return commitBusy();
         }
 };
@@ -23,7 +23,13 @@
 #include <string.h>
 
 #include "cmsis_os2.h"                  // ::CMSIS:RTOS2
+#if __has_include("cmsis_compiler.h")
 #include "cmsis_compiler.h"             // Compiler agnostic definitions
+#else
+/* the CMSIS 4 headers of the older series predate cmsis_compiler.h */
+#define __WEAK                          __attribute__((weak))
+#define __NO_RETURN                     __attribute__((__noreturn__))
+#endif
 #include "os_tick.h"                    // OS Tick API
 
 #include "FreeRTOS.h"                   // ARM.FreeRTOS::RTOS:Core
@@ -142,27 +148,13 @@ static osKernelState_t KernelState = osKernelInactive;
 #endif /* configAPPLICATION_ALLOCATED_HEAP */
 #endif /* USE_FreeRTOS_HEAP_5 */
 
-#if defined(SysTick)
-#undef SysTick_Handler
-
-/* CMSIS SysTick interrupt handler prototype */
-extern void SysTick_Handler     (void);
-/* FreeRTOS tick timer interrupt handler prototype */
-extern void xPortSysTickHandler (void);
-
 /*
-  SysTick handler implementation that also clears overflow flag.
+  There is no SysTick_Handler here: the core's own handler counts millis()
+  and calls osSystickHandler(), which drives the kernel tick (see
+  GD32_Arduino.c). The core's count of SysTick interrupts is also what the
+  system timer below is built on.
 */
-void SysTick_Handler (void) {
-  /* Clear overflow flag */
-  SysTick->CTRL;
-
-  if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
-    /* Call tick handler */
-    xPortSysTickHandler();
-  }
-}
-#endif /* SysTick */
+extern volatile uint32_t gd_ticks;
 
 /*
   Setup SVC to reset value.
@@ -472,12 +464,14 @@ uint32_t osKernelGetTickFreq (void) {
 */
 uint32_t osKernelGetSysTimerCount (void) {
   uint32_t irqmask = IS_IRQ_MASKED();
-  TickType_t ticks;
+  uint32_t ticks;
   uint32_t val;
 
   __disable_irq();
 
-  ticks = xTaskGetTickCount();
+  /* counted since reset, so unlike the kernel tick count it already runs
+     before osKernelStart, and tickless idle steps it forward as well */
+  ticks = gd_ticks;
   val   = OS_Tick_GetCount();
 
   /* Update tick count and timer value when timer overflows */
@@ -1068,10 +1062,11 @@ osStatus_t osDelayUntil (uint32_t ticks) {
 
     /* Check if target tick has not expired */
     if((delay != 0U) && (0 == (delay >> (8 * sizeof(TickType_t) - 1)))) {
-      if (xTaskDelayUntil (&tcnt, delay) == pdFALSE) {
-        /* Did not delay */
-        stat = osError;
-      }
+      /* The wake time is tcnt + delay, the target itself, so periodic
+         callers that advance their target by the period do not drift.
+         If the tick moved on to the target in the meantime there is
+         nothing left to wait for, which is not an error. */
+      (void)xTaskDelayUntil (&tcnt, delay);
     }
     else
     {
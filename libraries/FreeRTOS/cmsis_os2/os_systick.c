@@ -1,6 +1,6 @@
 /**************************************************************************//**
  * @file     os_systick.c
- * @brief    CMSIS OS Tick SysTick implementation
+ * @brief    CMSIS OS Tick SysTick implementation, on the core's SysTick
  * @version  V1.0.1
  * @date     29. November 2017
  ******************************************************************************/
@@ -29,32 +29,19 @@
 
 #ifdef  SysTick
 
-#ifndef SYSTICK_IRQ_PRIORITY
-#define SYSTICK_IRQ_PRIORITY    0xFFU
-#endif
-
 static uint8_t PendST;
 
 // Setup OS Tick.
+// The core's systick_config() has SysTick running at the kernel tick rate
+// from before main(), and millis() depends on it, so it is left as it is;
+// only a request for another rate fails.
 __WEAK int32_t OS_Tick_Setup (uint32_t freq, IRQHandler_t handler) {
-  uint32_t load;
   (void)handler;
 
-  if (freq == 0U) {
-    return (-1);
-  }
-
-  load = (SystemCoreClock / freq) - 1U;
-  if (load > 0x00FFFFFFU) {
+  if ((freq == 0U) || ((SystemCoreClock / freq) != (SysTick->LOAD + 1U))) {
     return (-1);
   }
 
-  NVIC_SetPriority(SysTick_IRQn, SYSTICK_IRQ_PRIORITY);
-
-  SysTick->CTRL =  SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk;
-  SysTick->LOAD =  load;
-  SysTick->VAL  =  0U;
-
   PendST = 0U;
 
   return (0);
@@ -109,8 +96,10 @@ __WEAK uint32_t OS_Tick_GetCount (void) {
 }
 
 // Get OS Tick overflow status.
+// COUNTFLAG clears on any read of CTRL, which the SysTick handler and
+// tickless idle both do, so look for the pending interrupt instead.
 __WEAK uint32_t OS_Tick_GetOverflow (void) {
-  return ((SysTick->CTRL >> 16) & 1U);
+  return ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0U) ? 1U : 0U;
 }
 
 #endif  // SysTick
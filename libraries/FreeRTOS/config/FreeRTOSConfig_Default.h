@@ -23,32 +23,129 @@
 #define configASSERT_DEFINED                             1
 extern void vAssertCalled( void );
 #define configASSERT( x )    if( ( x ) == 0 ) vAssertCalled()
+
+/* Set configUSE_CMSIS_RTOS_V2 to 1 to build the CMSIS-RTOS2 API
+ * (cmsis_os2.h) on top of the kernel. It needs the 56 priorities of
+ * osPriority_t, which rules out port optimised task selection, so it
+ * takes precedence over the profiles below for those. */
+#ifndef configUSE_CMSIS_RTOS_V2
+#define configUSE_CMSIS_RTOS_V2                          0
+#endif
+#if configUSE_CMSIS_RTOS_V2
+#ifndef configMAX_PRIORITIES
+#define configMAX_PRIORITIES                             ( 56 )
+#endif
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION          0
+#endif
+#ifndef configUSE_TRACE_FACILITY
+#define configUSE_TRACE_FACILITY                         1
+#endif
+#define INCLUDE_xTaskGetCurrentTaskHandle                1
+#endif
+
+/* Profiles picked with the board menu's "FreeRTOS profile"; each only
+ * changes defaults, so any of them can still be overridden.
+ *
+ * GD32_FREERTOS_PROFILE_FAST (Cortex-M3/M4): the next task is found with
+ * CLZ rather than by walking the ready lists, and tasks of equal priority
+ * share the CPU.  The menu entry also builds for the hardware FPU on
+ * Cortex-M4F, whose context the port only saves for tasks that used it.
+ *
+ * GD32_FREERTOS_PROFILE_MINIMAL (Cortex-M23, which has no CLZ): fewer
+ * priorities to scan and no queue registry or trace bookkeeping. */
+#if defined(GD32_FREERTOS_PROFILE_FAST)
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION          1
+#endif
+#ifndef configUSE_TIME_SLICING
+#define configUSE_TIME_SLICING                           1
+#endif
+#elif defined(GD32_FREERTOS_PROFILE_MINIMAL)
+#ifndef configMAX_PRIORITIES
+#define configMAX_PRIORITIES                             ( 5 )
+#endif
+#ifndef configQUEUE_REGISTRY_SIZE
+#define configQUEUE_REGISTRY_SIZE                        0
+#endif
+#ifndef configUSE_TRACE_FACILITY
+/* still needed to report run time stats */
+#define configUSE_TRACE_FACILITY                         configGENERATE_RUN_TIME_STATS
+#endif
+#endif
+
+#ifndef configQUEUE_REGISTRY_SIZE
 #define configQUEUE_REGISTRY_SIZE                        20
+#endif
 
 #define configUSE_PREEMPTION                             1
+#ifndef configUSE_TIME_SLICING
 #define configUSE_TIME_SLICING                           0
+#endif
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION          0
+#endif
+#if (configUSE_PORT_OPTIMISED_TASK_SELECTION == 1) && defined(GD32E23x)
+#error "configUSE_PORT_OPTIMISED_TASK_SELECTION needs CLZ, which Cortex-M23 lacks"
+#endif
 
 #define configUSE_IDLE_HOOK                              1
 #define configUSE_TICK_HOOK                              1
+/* Set to 1 to stop the tick while idle; millis() stays correct. */
+#ifndef configUSE_TICKLESS_IDLE
+#define configUSE_TICKLESS_IDLE                          0
+#endif
 #define configUSE_DAEMON_TASK_STARTUP_HOOK               0
 extern uint32_t SystemCoreClock;
 #define configCPU_CLOCK_HZ                               ( ( unsigned long ) SystemCoreClock )
 #define configTICK_RATE_HZ                               ( ( TickType_t ) 1000 )
 #define configMINIMAL_STACK_SIZE                         ( ( unsigned short ) 128 )
+#ifndef configTOTAL_HEAP_SIZE
 #define configTOTAL_HEAP_SIZE                            ( ( size_t ) ( 512 ) )
+#endif
 #define configMAX_TASK_NAME_LEN                          ( 10 )
+#ifndef configUSE_TRACE_FACILITY
 #define configUSE_TRACE_FACILITY                         1
+#endif
 #define configUSE_16_BIT_TICKS                           0
 #define configIDLE_SHOULD_YIELD                          1
 #define configUSE_CO_ROUTINES                            0
 
+#ifndef configMAX_PRIORITIES
 #define configMAX_PRIORITIES                             ( 10 )
+#endif
 #define configMAX_CO_ROUTINE_PRIORITIES                  ( 2 )
 #define configTIMER_QUEUE_LENGTH                         3
 #define configTIMER_TASK_PRIORITY                        ( configMAX_PRIORITIES - 1 )
 #define configUSE_COUNTING_SEMAPHORES                    1
+/* Heap implementation: 4 is a static array of configTOTAL_HEAP_SIZE, 5
+ * takes all the RAM the linker script leaves between .bss and the stack.
+ * With 5 newlib's own heap would sit in the same RAM, so malloc() has to
+ * go to the FreeRTOS heap as well. */
+#ifndef configMEMMANG_HEAP_NB
+#define configMEMMANG_HEAP_NB                            4
+#endif
+/* Set GD32_FREERTOS_MALLOC to 1 to have malloc(), and so new, allocate from
+ * the FreeRTOS heap; size it with configTOTAL_HEAP_SIZE. */
+#ifndef GD32_FREERTOS_MALLOC
+#if configMEMMANG_HEAP_NB == 5
+#define GD32_FREERTOS_MALLOC                             1
+#else
+#define GD32_FREERTOS_MALLOC                             0
+#endif
+#endif
+#if (configMEMMANG_HEAP_NB == 5) && !GD32_FREERTOS_MALLOC
+#error "configMEMMANG_HEAP_NB 5 needs GD32_FREERTOS_MALLOC, newlib's heap would overlap it"
+#endif
+#if GD32_FREERTOS_MALLOC
+#define configSUPPORT_DYNAMIC_ALLOCATION                 1
+#else
 #define configSUPPORT_DYNAMIC_ALLOCATION                 0
+#endif
+/* Set to 1 to give each task its own errno and stdio state. */
+#ifndef configUSE_NEWLIB_REENTRANT
+#define configUSE_NEWLIB_REENTRANT                       0
+#endif
 #define configSUPPORT_STATIC_ALLOCATION                  1
 #define configNUM_TX_DESCRIPTORS                         3
 #define configSTREAM_BUFFER_TRIGGER_LEVEL_TEST_MARGIN    2
@@ -56,6 +153,29 @@ extern uint32_t SystemCoreClock;
 /* don't use trust zone, MPU */
 #define configENABLE_TRUSTZONE 0
 #define configENABLE_MPU 0
+
+/* Set configUSE_MPU_STACK_GUARD to 1 (Cortex-M3/M4 with an MPU, e.g.
+ * GD32F30x) to have the MPU fence off the lowest 32 bytes of the running
+ * task's stack. An overflow then faults at the first write past the end
+ * and lands in vApplicationStackOverflowHook(), instead of being found,
+ * if at all, by configCHECK_FOR_STACK_OVERFLOW's checks on every switch.
+ * Moving the guard costs two register writes per switch. The guard sits
+ * on the first 32 byte boundary in the stack, so allow up to 56 bytes
+ * for it when sizing stacks. */
+#ifndef configUSE_MPU_STACK_GUARD
+#define configUSE_MPU_STACK_GUARD                        0
+#endif
+#if configUSE_MPU_STACK_GUARD
+void vPortStackGuardSet( void * pvStackStart );
+#define traceTASK_SWITCHED_IN() vPortStackGuardSet( pxCurrentTCB->pxStack )
+#endif
+/* With GD32_SWO_EVENTS (the "SWO trace" board menu) every switch sends
+ * the TCB address of the task switched in to ITM stimulus port 2
+ * (ITM_PORT_TASK in gd32/itm.h). The stack guard takes the hook first. */
+#if defined(GD32_SWO_EVENTS) && !defined(traceTASK_SWITCHED_IN)
+void itm_event( uint8_t port, uint32_t value );
+#define traceTASK_SWITCHED_IN() itm_event( 2U, ( uint32_t ) pxCurrentTCB )
+#endif
 /* enable FPU for those chips having an FPU.. */
 #if defined(GD32F4xx) || defined(GD32F403) || defined(GD32F3x0) || defined(GD32F30x) || defined(GD32E10X) || defined(GD32E50X)
 #define configENABLE_FPU 1
@@ -63,11 +183,15 @@ extern uint32_t SystemCoreClock;
 #define configENABLE_FPU 0
 #endif
 
-/* runtime stats generation. can be turned off to save space. */
-#define configGENERATE_RUN_TIME_STATS	0
+/* Set to 1 to count the CPU time each task uses, for printRunTimeStats()
+ * and vTaskGetRunTimeStats(). */
+#ifndef configGENERATE_RUN_TIME_STATS
+#define configGENERATE_RUN_TIME_STATS                    0
+#endif
 #if configGENERATE_RUN_TIME_STATS == 1
-/* Constants related to the generation of run time stats.  Run time stats
-are gathered in the full demo, not the blinky demo. */
+#ifndef configUSE_STATS_FORMATTING_FUNCTIONS
+#define configUSE_STATS_FORMATTING_FUNCTIONS             1
+#endif
 void vConfigureTimerForRunTimeStats( void );
 uint32_t ulGetRunTimeCounterValue( void );
 #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() vConfigureTimerForRunTimeStats()
@@ -102,8 +226,6 @@ uint32_t ulGetRunTimeCounterValue( void );
 #define INCLUDE_xTaskAbortDelay                   1
 //#define INCLUDE_xTaskGetCurrentTaskHandle         1
 
-unsigned long ulGetRunTimeCounterValue( void ); /* Prototype of function that returns run time counter. */
-
 #define projCOVERAGE_TEST                       0
 
 #define configKERNEL_INTERRUPT_PRIORITY         255
@@ -0,0 +1,87 @@
+#include <Arduino.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <cmsis_os2.h>
+
+/* Runs a 1 kHz loop with osDelayUntil() and reports, once a second, the
+ * worst jitter between its iterations, timed with osKernelGetSysTimerCount().
+ * GD32FreeRTOSConfig_extra.h turns on configUSE_CMSIS_RTOS_V2. */
+#define STACK_SIZE 256
+static StaticTask_t controlTaskBuffer;
+static StackType_t controlStack[STACK_SIZE];
+static StaticTask_t reportTaskBuffer;
+static StackType_t reportStack[STACK_SIZE];
+
+static volatile uint32_t worstJitterCycles;
+static volatile uint32_t overruns;
+
+static void ControlTask(void *arg) {
+    (void) arg; /* unused */
+    const uint32_t period = osKernelGetTickFreq() / 1000;
+    const uint32_t periodCycles = period * (osKernelGetSysTimerFreq() / osKernelGetTickFreq());
+    uint32_t next = osKernelGetTickCount();
+    uint32_t last = osKernelGetSysTimerCount();
+
+    while (true) {
+        /* advance the target, not the time we woke, so the period does
+         * not drift by however late each wake-up was */
+        next += period;
+        if (osDelayUntil(next) != osOK) {
+            /* the previous iteration ran past this one's start */
+            overruns++;
+            next = osKernelGetTickCount();
+        }
+
+        uint32_t now = osKernelGetSysTimerCount();
+        uint32_t elapsed = now - last;
+        uint32_t jitter = (elapsed > periodCycles) ? elapsed - periodCycles : periodCycles - elapsed;
+        if (jitter > worstJitterCycles) {
+            worstJitterCycles = jitter;
+        }
+        last = now;
+        /* the control work goes here */
+    }
+}
+
+static void ReportTask(void *arg) {
+    (void) arg; /* unused */
+    while (true) {
+        osDelay(1000);
+        Serial.print("worst jitter: ");
+        Serial.print(worstJitterCycles / (osKernelGetSysTimerFreq() / 1000000));
+        Serial.print(" us, overruns: ");
+        Serial.println(overruns);
+        worstJitterCycles = 0;
+    }
+}
+
+void setup(void)
+{
+    Serial.begin(115200);
+
+    osKernelInitialize();
+
+    const osThreadAttr_t controlAttr = {
+        .name = "Control",
+        .cb_mem = &controlTaskBuffer,
+        .cb_size = sizeof(controlTaskBuffer),
+        .stack_mem = controlStack,
+        .stack_size = sizeof(controlStack),
+        .priority = osPriorityRealtime,
+    };
+    osThreadNew(ControlTask, NULL, &controlAttr);
+
+    const osThreadAttr_t reportAttr = {
+        .name = "Report",
+        .cb_mem = &reportTaskBuffer,
+        .cb_size = sizeof(reportTaskBuffer),
+        .stack_mem = reportStack,
+        .stack_size = sizeof(reportStack),
+        .priority = osPriorityLow,
+    };
+    osThreadNew(ReportTask, NULL, &reportAttr);
+
+    /* start scheduler. should never return. */
+    osKernelStart();
+}
+void loop(void) { /* never reached */ }
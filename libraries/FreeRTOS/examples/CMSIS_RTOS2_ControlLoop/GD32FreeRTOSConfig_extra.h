@@ -0,0 +1,2 @@
+/* Build the CMSIS-RTOS2 API on top of the default config. */
+#define configUSE_CMSIS_RTOS_V2 1
@@ -0,0 +1,46 @@
+#include <Arduino.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <FreeRTOSStats.h>
+
+/* Prints which task takes how much of the CPU, every two seconds.
+ * GD32FreeRTOSConfig_extra.h turns on configGENERATE_RUN_TIME_STATS. */
+#define STACK_SIZE 256
+StaticTask_t xBusyTaskBuffer;
+StackType_t xBusyStack[STACK_SIZE];
+StaticTask_t xReportTaskBuffer;
+StackType_t xReportStack[STACK_SIZE];
+
+static void BusyTask(void* arg) {
+    (void) arg; /* unused */
+    while (true) {
+        /* spin for 30 ms out of every 100 */
+        uint32_t start = millis();
+        while (millis() - start < 30) {
+        }
+        vTaskDelay(70 / portTICK_PERIOD_MS);
+    }
+}
+
+static void ReportTask(void* arg) {
+    (void) arg; /* unused */
+    while (true) {
+        vTaskDelay(2000 / portTICK_PERIOD_MS);
+        printRunTimeStats(Serial);
+        Serial.println();
+    }
+}
+
+void setup(void)
+{
+    Serial.begin(115200);
+
+    xTaskCreateStatic(BusyTask, "Busy", STACK_SIZE, (void *)0,
+                      tskIDLE_PRIORITY + 1, xBusyStack, &xBusyTaskBuffer);
+    xTaskCreateStatic(ReportTask, "Report", STACK_SIZE, (void *)0,
+                      tskIDLE_PRIORITY + 2, xReportStack, &xReportTaskBuffer);
+
+    /* start scheduler. should never return. */
+    vTaskStartScheduler();
+}
+void loop(void) { /* never reached */ }
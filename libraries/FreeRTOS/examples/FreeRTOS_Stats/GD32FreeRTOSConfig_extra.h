@@ -0,0 +1,2 @@
+/* Count the CPU time each task uses, on top of the default config. */
+#define configGENERATE_RUN_TIME_STATS 1
@@ -0,0 +1,53 @@
+#include <Arduino.h>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <Watchdog.h>
+
+/* Two tasks check in with the watchdog supervisor, which refreshes the
+ * watchdog only once both did. Send 's' on Serial to stall the slow task
+ * for good: the fast one keeps checking in, yet the board resets. */
+#define STACK_SIZE 256
+static StaticTask_t fastTaskBuffer;
+static StackType_t fastStack[STACK_SIZE];
+static StaticTask_t slowTaskBuffer;
+static StackType_t slowStack[STACK_SIZE];
+
+static int fastClient;
+static int slowClient;
+
+static void FastTask(void *arg) {
+    (void) arg; /* unused */
+    while (true) {
+        Watchdog.checkIn(fastClient);
+        vTaskDelay(10 / portTICK_PERIOD_MS);
+    }
+}
+
+static void SlowTask(void *arg) {
+    (void) arg; /* unused */
+    while (true) {
+        if (Serial.read() == 's') {
+            Serial.println("slow task stalled");
+            vTaskSuspend(NULL);
+        }
+        Watchdog.checkIn(slowClient);
+        vTaskDelay(500 / portTICK_PERIOD_MS);
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+    Serial.println(Watchdog.causedReset() ? "restarted by the watchdog" : "started");
+
+    fastClient = Watchdog.addClient();
+    slowClient = Watchdog.addClient();
+    /* comfortably longer than the slowest round, the IRC40K may run fast */
+    Watchdog.begin(2000);
+
+    xTaskCreateStatic(FastTask, "fast", STACK_SIZE, NULL, tskIDLE_PRIORITY + 2, fastStack, &fastTaskBuffer);
+    xTaskCreateStatic(SlowTask, "slow", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, slowStack, &slowTaskBuffer);
+    vTaskStartScheduler();
+}
+
+void loop() {
+}
@@ -18,4 +18,9 @@
     #include "../config/FreeRTOSConfig_Default.h"
 #endif
 
+/* heap_4 unless the config picks another heap */
+#ifndef configMEMMANG_HEAP_NB
+    #define configMEMMANG_HEAP_NB 4
+#endif
+
 #endif /* _ARDUINO_FREERTOS_CONFIG_H */
@@ -0,0 +1,95 @@
+#include "FreeRTOSStats.h"
+
+#if configGENERATE_RUN_TIME_STATS == 1
+
+static TaskStatus_t taskStatus[FREERTOS_STATS_MAX_TASKS];
+
+/*
+ * Run time counters as of the previous report, so the kernel's totals
+ * can be turned into the load over the last interval.
+ */
+static struct {
+    UBaseType_t taskNumber;
+    uint32_t runTime;
+} lastRunTime[FREERTOS_STATS_MAX_TASKS];
+static UBaseType_t lastCount = 0;
+static uint32_t lastTotal = 0;
+
+static uint32_t previousRunTime(UBaseType_t taskNumber)
+{
+    for (UBaseType_t i = 0; i < lastCount; i++) {
+        if (lastRunTime[i].taskNumber == taskNumber) {
+            return lastRunTime[i].runTime;
+        }
+    }
+    // Created since the last report.
+    return 0;
+}
+
+static char stateLetter(eTaskState state)
+{
+    switch (state) {
+        case eRunning:
+            return 'X';
+        case eReady:
+            return 'R';
+        case eBlocked:
+            return 'B';
+        case eSuspended:
+            return 'S';
+        default:
+            return 'D';
+    }
+}
+
+static void printPadded(Print& out, const char* text, size_t width)
+{
+    size_t len = out.print(text);
+    while (len++ < width) {
+        out.print(' ');
+    }
+}
+
+void printRunTimeStats(Print& out)
+{
+    uint32_t total;
+    UBaseType_t count = uxTaskGetSystemState(taskStatus, FREERTOS_STATS_MAX_TASKS, &total);
+
+    if (count == 0) {
+        out.println(F("More tasks than FREERTOS_STATS_MAX_TASKS"));
+        return;
+    }
+
+    // Unsigned arithmetic keeps this right across a wrap of the counter.
+    uint32_t interval = total - lastTotal;
+
+    printPadded(out, "Task", configMAX_TASK_NAME_LEN + 1);
+    out.println(F("State Prio Stack CPU"));
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t& task = taskStatus[i];
+        uint32_t used = task.ulRunTimeCounter - previousRunTime(task.xTaskNumber);
+        uint32_t permille = interval ? (uint32_t)((uint64_t)used * 1000 / interval) : 0;
+        char number[8];
+
+        printPadded(out, task.pcTaskName, configMAX_TASK_NAME_LEN + 1);
+        out.print(stateLetter(task.eCurrentState));
+        out.print(F("     "));
+        snprintf(number, sizeof(number), "%u", (unsigned)task.uxCurrentPriority);
+        printPadded(out, number, 5);
+        snprintf(number, sizeof(number), "%u", (unsigned)task.usStackHighWaterMark);
+        printPadded(out, number, 6);
+        out.print(permille / 10);
+        out.print('.');
+        out.print(permille % 10);
+        out.println('%');
+    }
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        lastRunTime[i].taskNumber = taskStatus[i].xTaskNumber;
+        lastRunTime[i].runTime = taskStatus[i].ulRunTimeCounter;
+    }
+    lastCount = count;
+    lastTotal = total;
+}
+
+#endif
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Arduino.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*
+ * Most tasks printRunTimeStats() can report on.
+ */
+#ifndef FREERTOS_STATS_MAX_TASKS
+#define FREERTOS_STATS_MAX_TASKS 16
+#endif
+
+/*
+ * Print a line per task to ‘out’, e.g. Serial: its name, state,
+ * priority, the least stack it has had free (in words) and the share
+ * of the CPU it took since the previous call, or since it was created.
+ *
+ * Needs configGENERATE_RUN_TIME_STATS set to 1. Call it from one task
+ * at a time, never from an interrupt.
+ */
+void printRunTimeStats(Print& out);
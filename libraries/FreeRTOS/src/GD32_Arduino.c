@@ -1,8 +1,15 @@
 #include "FreeRTOS.h"
 #include "task.h"
+#include "timers.h"
 #include "gd32_def.h"
+#include "systick.h"
+#include "deferred.h"
+#include "memory.h"
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <reent.h>
 
 /* implemented per-port */
 extern void xPortSysTickHandler (void);
@@ -17,6 +24,425 @@ void osSystickHandler (void) {
     xPortSysTickHandler();
   }
 }
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+/* SysTick drives both the kernel tick and millis(), which counts its
+ * interrupts, so the port's own version would lose every tick it
+ * suppresses. This one stretches a single SysTick period over the idle
+ * time, and on waking steps both counts forward by the ticks that passed
+ * before re-enabling interrupts, so even the interrupt that woke us sees
+ * the right millis(). For deeper sleep modes, define
+ * configPRE_SLEEP_PROCESSING / configPOST_SLEEP_PROCESSING. */
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime) {
+  const uint32_t countsPerTick = SysTick->LOAD + 1;
+  const TickType_t maxIdleTime = SysTick_LOAD_RELOAD_Msk / countsPerTick;
+  uint32_t reload, remaining, completeTicks;
+  TickType_t modifiableIdleTime;
+
+  if (xExpectedIdleTime > maxIdleTime) {
+    xExpectedIdleTime = maxIdleTime;
+  }
+
+  /* leave interrupts masked, they still end the wfi */
+  __disable_irq();
+  __DSB();
+  __ISB();
+  if (eTaskConfirmSleepModeStatus() == eAbortSleep) {
+    __enable_irq();
+    return;
+  }
+
+  SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+  /* a tick that came due just now is handled first */
+  if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    __enable_irq();
+    return;
+  }
+
+  /* the rest of this tick, plus whole ticks up to the expected idle time */
+  reload = SysTick->VAL + countsPerTick * (xExpectedIdleTime - 1);
+  SysTick->LOAD = reload;
+  SysTick->VAL = 0;
+  SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+  modifiableIdleTime = xExpectedIdleTime;
+  configPRE_SLEEP_PROCESSING(modifiableIdleTime);
+  if (modifiableIdleTime > 0) {
+    __DSB();
+    __WFI();
+    __ISB();
+  }
+  configPOST_SLEEP_PROCESSING(xExpectedIdleTime);
+
+  /* stop the counter without clearing COUNTFLAG */
+  SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk;
+
+  if (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk) {
+    /* slept the whole time; the pending tick interrupt accounts for the
+     * last tick, and the counter has started over from reload */
+    completeTicks = xExpectedIdleTime - 1;
+    remaining = countsPerTick - (reload - SysTick->VAL);
+    if (remaining == 0 || remaining > countsPerTick) {
+      remaining = countsPerTick;
+    }
+  } else {
+    /* woken early by another interrupt */
+    uint32_t elapsed = xExpectedIdleTime * countsPerTick - SysTick->VAL;
+
+    completeTicks = elapsed / countsPerTick;
+    remaining = (completeTicks + 1) * countsPerTick - elapsed;
+  }
+
+  /* finish the current tick, then carry on with normal ones */
+  SysTick->LOAD = remaining - 1;
+  SysTick->VAL = 0;
+  SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+  SysTick->LOAD = countsPerTick - 1;
+
+  systick_ticks_add(completeTicks);
+  vTaskStepTick(completeTicks);
+  __enable_irq();
+}
+#endif
+
+/* newlib's malloc keeps one heap for all tasks; hold the scheduler off
+ * while it works on it. Allocating from interrupts isn't safe either way. */
+static int mallocNeedsLock(void) {
+  return __get_IPSR() == 0 && xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED;
+}
+
+void __malloc_lock(struct _reent *r) {
+  (void)r;
+  if (mallocNeedsLock()) {
+    vTaskSuspendAll();
+  }
+}
+
+void __malloc_unlock(struct _reent *r) {
+  (void)r;
+  if (mallocNeedsLock()) {
+    (void)xTaskResumeAll();
+  }
+}
+
+#if GD32_FREERTOS_MALLOC
+/* malloc() and friends, and with them new, allocate from the FreeRTOS
+ * heap, so there is only the one heap to size. */
+
+/* heap_4 and heap_5 put each block's size, with the top bit set while it is in
+ * use, in a header just before the memory it hands out. */
+typedef struct {
+  void *next;
+  size_t size;
+} HeapBlockHeader;
+
+static size_t heapBlockUsableSize(void *ptr) {
+  const size_t headerSize = (sizeof(HeapBlockHeader) + portBYTE_ALIGNMENT - 1) & ~((size_t)portBYTE_ALIGNMENT_MASK);
+  const HeapBlockHeader *header = (const HeapBlockHeader *)((uint8_t *)ptr - headerSize);
+
+  return (header->size & ~((size_t)1 << (sizeof(size_t) * 8 - 1))) - headerSize;
+}
+
+void *_malloc_r(struct _reent *r, size_t size) {
+  void *ptr = pvPortMalloc(size);
+
+  if (ptr == NULL) {
+    r->_errno = ENOMEM;
+  }
+  return ptr;
+}
+
+void _free_r(struct _reent *r, void *ptr) {
+  (void)r;
+  vPortFree(ptr);
+}
+
+void *_calloc_r(struct _reent *r, size_t count, size_t size) {
+  size_t total = count * size;
+  void *ptr;
+
+  if (size != 0 && total / size != count) {
+    r->_errno = ENOMEM;
+    return NULL;
+  }
+  ptr = _malloc_r(r, total);
+  if (ptr != NULL) {
+    memset(ptr, 0, total);
+  }
+  return ptr;
+}
+
+void *_realloc_r(struct _reent *r, void *ptr, size_t size) {
+  void *resized;
+  size_t old;
+
+  if (ptr == NULL) {
+    return _malloc_r(r, size);
+  }
+  if (size == 0) {
+    vPortFree(ptr);
+    return NULL;
+  }
+  old = heapBlockUsableSize(ptr);
+  if (size <= old) {
+    return ptr;
+  }
+  resized = _malloc_r(r, size);
+  if (resized != NULL) {
+    memcpy(resized, ptr, old);
+    vPortFree(ptr);
+  }
+  return resized;
+}
+
+void *malloc(size_t size) {
+  return _malloc_r(_REENT, size);
+}
+
+void free(void *ptr) {
+  vPortFree(ptr);
+}
+
+void *calloc(size_t count, size_t size) {
+  return _calloc_r(_REENT, count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  return _realloc_r(_REENT, ptr, size);
+}
+#endif
+
+#if GD32_FREERTOS_MALLOC && ((configMEMMANG_HEAP_NB == 4) || (configMEMMANG_HEAP_NB == 5))
+#if configMEMMANG_HEAP_NB == 5
+extern uint8_t end[];
+extern uint8_t _eheap[];
+#endif
+
+/* malloc allocates from the FreeRTOS heap, so memoryStats() reports that one */
+void memory_heap_stats(memory_stats_t *stats) {
+  HeapStats_t heap;
+#if configMEMMANG_HEAP_NB == 5
+  size_t size = ((uint32_t)_eheap > (uint32_t)end) ? (size_t)(_eheap - end) : 0;
+#else
+  size_t size = configTOTAL_HEAP_SIZE;
+#endif
+
+  vPortGetHeapStats(&heap);
+  stats->heap_size = size;
+  stats->heap_used = size - heap.xAvailableHeapSpaceInBytes;
+  stats->heap_peak = size - heap.xMinimumEverFreeBytesRemaining;
+  stats->heap_largest_free = heap.xSizeOfLargestFreeBlockInBytes;
+  stats->heap_fragmentation = (heap.xAvailableHeapSpaceInBytes == 0) ? 0 :
+                              (uint8_t)(100 - (heap.xSizeOfLargestFreeBlockInBytes * 100) / heap.xAvailableHeapSpaceInBytes);
+}
+#endif
+
+#if (configSUPPORT_DYNAMIC_ALLOCATION == 1) && (configMEMMANG_HEAP_NB == 5)
+/* from the linker script: the start and the end of the heap, which is in
+ * external RAM if the variant linked it there */
+extern uint8_t end[];
+extern uint8_t _eheap[];
+
+/* Hand the RAM between the two to heap_5. This has to happen before any
+ * constructor can call new, so it runs ahead of them, but after premain()
+ * and its exmc_early_init() has made external RAM reachable. */
+__attribute__((constructor(102))) static void heapRegionsInit(void) {
+  const HeapRegion_t regions[] = {
+    { end, (size_t)(_eheap - end) },
+    { NULL, 0 }
+  };
+
+  /* an empty or inverted region would corrupt heap_5, better no heap */
+  if ((uint32_t)_eheap <= (uint32_t)end) {
+    return;
+  }
+  vPortDefineHeapRegions(regions);
+}
+#endif
+
+/* tasks blocked in os_event_wait */
+#ifndef OS_EVENT_WAITERS
+#define OS_EVENT_WAITERS 4
+#endif
+static TaskHandle_t volatile osEventWaiters[OS_EVENT_WAITERS];
+
+/* will be called by the core's drivers while waiting for their interrupt */
+void os_event_wait(void) {
+  TaskHandle_t self;
+  int slot = -1;
+
+  /* spin as before in interrupts, with interrupts masked or before the
+   * scheduler runs */
+  if (__get_IPSR() != 0 || __get_PRIMASK() != 0
+      || xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+    return;
+  }
+#if (__CORTEX_M == 3U) || (__CORTEX_M == 4U)
+  /* or in a critical section */
+  if (__get_BASEPRI() != 0) {
+    return;
+  }
+#endif
+
+  self = xTaskGetCurrentTaskHandle();
+  taskENTER_CRITICAL();
+  for (int i = 0; i < OS_EVENT_WAITERS; i++) {
+    if (osEventWaiters[i] == NULL) {
+      osEventWaiters[i] = self;
+      slot = i;
+      break;
+    }
+  }
+  taskEXIT_CRITICAL();
+
+  /* without a slot, or if the signal is missed, the timeout still gives
+   * the CPU away for a tick; the driver re-checks either way */
+  ulTaskNotifyTake(pdTRUE, 1);
+  if (slot >= 0) {
+    osEventWaiters[slot] = NULL;
+  }
+}
+
+/* interrupts above configMAX_SYSCALL_INTERRUPT_PRIORITY may not call
+ * into the kernel */
+static int interruptMayCallKernel(uint32_t irq) {
+  return irq < 16 || (NVIC_GetPriority((IRQn_Type)(irq - 16)) << (8 - __NVIC_PRIO_BITS))
+         >= configMAX_SYSCALL_INTERRUPT_PRIORITY;
+}
+
+/* will be called by the core's drivers from their interrupts */
+void os_event_signal(void) {
+  BaseType_t woken = pdFALSE;
+
+  /* their waiters wake on the timeout instead */
+  if (!interruptMayCallKernel(__get_IPSR())) {
+    return;
+  }
+  for (int i = 0; i < OS_EVENT_WAITERS; i++) {
+    TaskHandle_t task = osEventWaiters[i];
+    if (task != NULL) {
+      vTaskNotifyGiveFromISR(task, &woken);
+    }
+  }
+  portYIELD_FROM_ISR(woken);
+}
+
+#if ( configUSE_TIMERS == 1 ) && ( INCLUDE_xTimerPendFunctionCall == 1 )
+/* The core's deferred calls (see deferred.h) run in the timer daemon
+ * task, at its priority, so they must not block. Interrupts that may not
+ * call into the kernel - the core's timer, RTC and EXTI ones by default -
+ * leave theirs for the tick hook to pend, a tick later at most. */
+static volatile uint8_t deferredPended = 0;
+
+static void deferredRunPended(void *unused, uint32_t unused2) {
+  (void)unused;
+  (void)unused2;
+  deferredPended = 0;
+  deferred_run();
+}
+
+static void deferredPend(void) {
+  BaseType_t woken = pdFALSE;
+  UBaseType_t state;
+  uint8_t pended;
+
+  if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+    return;
+  }
+  state = taskENTER_CRITICAL_FROM_ISR();
+  pended = deferredPended;
+  deferredPended = 1;
+  taskEXIT_CRITICAL_FROM_ISR(state);
+  if (pended) {
+    return;
+  }
+
+  if (__get_IPSR() != 0) {
+    if (xTimerPendFunctionCallFromISR(deferredRunPended, NULL, 0, &woken) != pdPASS) {
+      deferredPended = 0;
+    }
+    portYIELD_FROM_ISR(woken);
+  } else if (xTimerPendFunctionCall(deferredRunPended, NULL, 0, 0) != pdPASS) {
+    deferredPended = 0;
+  }
+}
+
+/* will be called by the core after queueing a deferred call */
+void deferred_signal(void) {
+  if (!interruptMayCallKernel(__get_IPSR())) {
+    return;
+  }
+  deferredPend();
+}
+#endif
+
+#if configUSE_MPU_STACK_GUARD
+#if !defined(__MPU_PRESENT) || (__MPU_PRESENT != 1) || ((__CORTEX_M != 3U) && (__CORTEX_M != 4U))
+#error "configUSE_MPU_STACK_GUARD needs a Cortex-M3/M4 with an MPU"
+#endif
+/* the highest numbered region takes precedence where regions overlap */
+#define STACK_GUARD_REGION  7U
+#define STACK_GUARD_SIZE    32U
+/* MemManage fault status bits in CFSR, not named by the older CMSIS headers */
+#define STACK_GUARD_MSTKERR     (1UL << 4)
+#define STACK_GUARD_MMARVALID   (1UL << 7)
+
+/* task.h only declares it along with configCHECK_FOR_STACK_OVERFLOW */
+void vApplicationStackOverflowHook(TaskHandle_t pxTask, char *pcTaskName);
+
+static uint32_t stackGuardBase(const void *stackStart) {
+  return ((uint32_t)stackStart + STACK_GUARD_SIZE - 1U) & ~(STACK_GUARD_SIZE - 1U);
+}
+
+/* Size and access of the guard never change, only its base does. The MPU
+ * stays off until the first task is switched in. */
+__attribute__((constructor(101))) static void stackGuardInit(void) {
+  MPU->RNR = STACK_GUARD_REGION;
+  MPU->RBAR = 0;
+  /* 32 bytes, not executable, read only so the stack high water mark
+   * can still be measured from the bottom up */
+  MPU->RASR = MPU_RASR_XN_Msk | (6U << MPU_RASR_AP_Pos) | ((5U - 1U) << MPU_RASR_SIZE_Pos)
+              | MPU_RASR_ENABLE_Msk;
+  SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk;
+}
+
+/* called from the kernel's context switch, see traceTASK_SWITCHED_IN; the
+ * exception return that follows makes the new region take effect */
+void vPortStackGuardSet(void *pvStackStart) {
+  MPU->RBAR = stackGuardBase(pvStackStart) | MPU_RBAR_VALID_Msk | STACK_GUARD_REGION;
+  MPU->CTRL = MPU_CTRL_PRIVDEFENA_Msk | MPU_CTRL_ENABLE_Msk;
+}
+
+__attribute__((used)) void MemManage_Handler(void) {
+  uint32_t cfsr = SCB->CFSR;
+  uint32_t base = MPU->RBAR & MPU_RBAR_ADDR_Msk;
+
+  /* stacking the interrupted context, or a write, ran into the guard */
+  if ((cfsr & STACK_GUARD_MSTKERR)
+      || ((cfsr & STACK_GUARD_MMARVALID) && SCB->MMFAR - base < STACK_GUARD_SIZE)) {
+    vApplicationStackOverflowHook(xTaskGetCurrentTaskHandle(), pcTaskGetName(NULL));
+  }
+  for (;;) {
+  }
+}
+#endif
+
+#ifdef USBCON
+extern void usb_set_interrupt_priority(uint8_t priority);
+
+/* will be called by Arduino core's USB stack while waiting on an endpoint */
+void usb_event_wait(void) {
+  static uint8_t usbPriorityLowered = 0;
+
+  /* the USB interrupt has to be allowed to call into the kernel */
+  if (!usbPriorityLowered && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+    usb_set_interrupt_priority(configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    usbPriorityLowered = 1;
+  }
+  os_event_wait();
+}
+#endif
 StackType_t uxTimerTaskStack[ configTIMER_TASK_STACK_DEPTH ];
 
 
@@ -44,8 +470,9 @@ void vApplicationStackOverflowHook( TaskHandle_t pxTask,
     ( void ) pxTask;
 
     /* Run time stack overflow checking is performed if
-     * configCHECK_FOR_STACK_OVERFLOW is defined to 1 or 2.  This hook
-     * function is called if a stack overflow is detected. */
+     * configCHECK_FOR_STACK_OVERFLOW is defined to 1 or 2, or by the MPU
+     * if configUSE_MPU_STACK_GUARD is 1.  This hook function is called if
+     * a stack overflow is detected. */
     taskDISABLE_INTERRUPTS();
 
     for( ; ; )
@@ -75,6 +502,25 @@ void vApplicationIdleHook( void )
 
 void vApplicationTickHook( void )
 {
+    #if ( configGENERATE_RUN_TIME_STATS == 1 )
+        {
+            /* Read the counter at least once a tick, so a task that never
+             * yields cannot hide a wrap of the cycle count. */
+            ( void ) ulGetRunTimeCounterValue();
+        }
+    #endif
+
+    #if ( configUSE_TIMERS == 1 ) && ( INCLUDE_xTimerPendFunctionCall == 1 )
+        {
+            /* Pick up deferred calls posted where the kernel could not
+             * be told. */
+            if( deferred_pending() )
+            {
+                deferredPend();
+            }
+        }
+    #endif
+
     #if ( mainCREATE_FULL_DEMO_ONLY == 1 )
         {
             vFullDemoTickHookFunction();
@@ -162,14 +608,11 @@ void vApplicationGetTimerTaskMemory( StaticTask_t ** ppxTimerTaskTCBBuffer,
 
 /* runtime stats */
 #if configGENERATE_RUN_TIME_STATS == 1
-/* Addresses of registers in the Cortex-M debug hardware. */
-#define rtsDWT_CYCCNT 			( *( ( unsigned long * ) 0xE0001004 ) )
-#define rtsDWT_CONTROL 			( *( ( unsigned long * ) 0xE0001000 ) )
-#define rtsSCB_DEMCR 			( *( ( unsigned long * ) 0xE000EDFC ) )
-#define rtsTRCENA_BIT			( 0x01000000UL )
-#define rtsCOUNTER_ENABLE_BIT	( 0x01UL )
-
-/* Simple shift divide for scaling to avoid an overflow occurring too soon. */
+/* The core keeps a free running cycle count: DWT CYCCNT on Cortex-M3/M4,
+ * rebuilt from SysTick on the Cortex-M23, which has no DWT counter.
+ * It is scaled down so the kernel's 32 bit per-task totals last days
+ * rather than seconds, with the wraps of the cycle count kept in
+ * software. */
 #define runtimeSHIFT_13				13
 #define runtimeOVERFLOW_BIT_13		( 1UL << ( 32UL - runtimeSHIFT_13 ) )
 static const uint32_t ulPrescaleBits = runtimeSHIFT_13;
@@ -179,23 +622,20 @@ static const uint32_t ulOverflowBit = runtimeOVERFLOW_BIT_13;
 
 void vConfigureTimerForRunTimeStats( void )
 {
-	/* Enable TRCENA. */
-	rtsSCB_DEMCR = rtsSCB_DEMCR | rtsTRCENA_BIT;
-
-	/* Reset counter. */
-	rtsDWT_CYCCNT = 0;
-
-	/* Enable counter. */
-	rtsDWT_CONTROL = rtsDWT_CONTROL | rtsCOUNTER_ENABLE_BIT;
+	/* Nothing to do, systick_config() has started the counter. */
 }
 /*-----------------------------------------------------------*/
 
 uint32_t ulGetRunTimeCounterValue( void )
 {
-static unsigned long ulLastCounterValue = 0UL, ulOverflows = 0;
-unsigned long ulValueNow;
+static uint32_t ulLastCounterValue = 0UL, ulOverflows = 0;
+uint32_t ulValueNow;
+uint32_t primask = __get_PRIMASK();
 
-	ulValueNow = rtsDWT_CYCCNT;
+	/* Called both on a context switch and from the tick. */
+	__disable_irq();
+
+	ulValueNow = getCurrentCycles();
 
 	/* Has the value overflowed since it was last read. */
 	if( ulValueNow < ulLastCounterValue )
@@ -204,9 +644,9 @@ unsigned long ulValueNow;
 	}
 	ulLastCounterValue = ulValueNow;
 
-	/* There is no prescale on the counter, so simulate in software. */
-	ulValueNow = ( ulValueNow >> ulPrescaleBits ) + ulOverflows;
+	__set_PRIMASK( primask );
 
-	return ulValueNow;
+	/* There is no prescale on the counter, so simulate in software. */
+	return ( ulValueNow >> ulPrescaleBits ) + ulOverflows;
 }
 #endif
\ No newline at end of file
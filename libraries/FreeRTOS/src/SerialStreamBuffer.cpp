@@ -0,0 +1,74 @@
+#include "SerialStreamBuffer.h"
+
+#ifdef USBD_USE_CDC
+extern "C" {
+#include "gd32/usb.h"
+}
+#endif
+
+SerialStreamBuffer::SerialStreamBuffer(StreamBufferHandle_t buffer)
+    : buffer(buffer)
+{
+    this->sink.space = SerialStreamBuffer::space;
+    this->sink.write = SerialStreamBuffer::write;
+    this->sink.arg = buffer;
+}
+
+void SerialStreamBuffer::attach(HardwareSerial& port)
+{
+    this->detach();
+    port.setInterruptPriority(configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    port.setRxSink(&this->sink);
+    this->serial = &port;
+}
+
+#ifdef USBD_USE_CDC
+void SerialStreamBuffer::attach(CDCACM_& port)
+{
+    this->detach();
+    usb_set_interrupt_priority(configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    port.setRxSink(&this->sink);
+    this->usb = &port;
+}
+#endif
+
+void SerialStreamBuffer::detach()
+{
+    if (this->serial != nullptr) {
+        this->serial->setRxSink(NULL);
+        this->serial = nullptr;
+    }
+#ifdef USBD_USE_CDC
+    if (this->usb != nullptr) {
+        this->usb->setRxSink(NULL);
+        this->usb = nullptr;
+    }
+#endif
+}
+
+size_t SerialStreamBuffer::receive(void* data, size_t len, TickType_t wait)
+{
+    size_t n = xStreamBufferReceive(this->buffer, data, len, wait);
+#ifdef USBD_USE_CDC
+    // A packet may be waiting on the endpoint for the room just made.
+    if (this->usb != nullptr) {
+        this->usb->rxSinkReady();
+    }
+#endif
+    return n;
+}
+
+size_t SerialStreamBuffer::space(void* arg)
+{
+    return xStreamBufferSpacesAvailable((StreamBufferHandle_t)arg);
+}
+
+// Called from the receive interrupt, or from ‘rxSinkReady’ in a task,
+// where the FromISR call is just as safe.
+void SerialStreamBuffer::write(void* arg, const uint8_t* data, size_t len)
+{
+    BaseType_t woken = pdFALSE;
+
+    xStreamBufferSendFromISR((StreamBufferHandle_t)arg, data, len, &woken);
+    portYIELD_FROM_ISR(woken);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Arduino.h>
+#include "FreeRTOS.h"
+#include "stream_buffer.h"
+
+/*
+ * Feeds what a serial port receives into a stream buffer straight from
+ * its interrupt, so a task can block in ‘receive’ instead of polling
+ * ‘available’, and the bytes are not copied through the port's own
+ * ring first:
+ *
+ *   static StaticStreamBuffer_t rxControl;
+ *   static uint8_t rxStorage[256 + 1];
+ *   SerialStreamBuffer rx(xStreamBufferCreateStatic(sizeof(rxStorage) - 1, 1,
+ *                                                   rxStorage, &rxControl));
+ *   ...
+ *   rx.attach(Serial1);
+ *   n = rx.receive(data, sizeof(data), portMAX_DELAY);
+ *
+ * Attaching lowers the port's interrupt priority to
+ * configMAX_SYSCALL_INTERRUPT_PRIORITY, as the kernel requires of
+ * interrupts that call it. A UART drops what doesn't fit in the buffer;
+ * USB holds off the host until ‘receive’ has made room.
+ */
+class SerialStreamBuffer
+{
+    public:
+        explicit SerialStreamBuffer(StreamBufferHandle_t buffer);
+
+        void attach(HardwareSerial& port);
+#ifdef USBD_USE_CDC
+        void attach(CDCACM_& port);
+#endif
+        // Give the port its receive ring back.
+        void detach();
+
+        /*
+         * Wait up to ‘wait’ ticks for data, then return up to ‘len’
+         * octets of it.
+         */
+        size_t receive(void* data, size_t len, TickType_t wait);
+
+        StreamBufferHandle_t handle()
+        {
+            return this->buffer;
+        }
+
+    private:
+        StreamBufferHandle_t buffer;
+        rx_sink_t sink;
+        HardwareSerial* serial = nullptr;
+#ifdef USBD_USE_CDC
+        CDCACM_* usb = nullptr;
+#endif
+
+        static size_t space(void* arg);
+        static void write(void* arg, const uint8_t* data, size_t len);
+};
@@ -0,0 +1,11 @@
+/*
+ * @file    cmsis_os2.c
+ * @brief   Include the CMSIS-RTOS2 wrapper when configUSE_CMSIS_RTOS_V2 is set,
+ *          to match Arduino library format
+ */
+#include "FreeRTOS.h"
+
+#if defined(configUSE_CMSIS_RTOS_V2) && configUSE_CMSIS_RTOS_V2
+#include "../cmsis_os2/cmsis_os2.c"
+#include "../cmsis_os2/os_systick.c"
+#endif
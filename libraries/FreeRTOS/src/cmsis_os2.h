@@ -0,0 +1,5 @@
+/*
+ * @file    cmsis_os2.h
+ * @brief   Include header of the CMSIS-RTOS2 wrapper to match Arduino library format
+ */
+#include "../cmsis_os2/cmsis_os2.h"
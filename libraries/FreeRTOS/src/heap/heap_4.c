@@ -46,7 +46,7 @@
 
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
-#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 ) && ( configMEMMANG_HEAP_NB == 4 )
 
 /* Block sizes must not get too small. */
 #define heapMINIMUM_BLOCK_SIZE    ( ( size_t ) ( xHeapStructSize << 1 ) )
@@ -60,6 +60,10 @@
 /* The application writer has already defined the array used for the RTOS
 * heap - probably so it can be placed in a special segment or address. */
     extern uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+#elif ( portUSING_MPU_WRAPPERS == 0 )
+    /* The heap never relies on its contents, so keep it out of .bss and
+     * spare the startup code from zeroing it. */
+    static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ] __attribute__( ( section( ".noinit" ) ) );
 #else
     PRIVILEGED_DATA static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
 #endif /* configAPPLICATION_ALLOCATED_HEAP */
@@ -0,0 +1,54 @@
+/*
+  UDP stream
+
+  Sends 1024 samples of analog input A0 per packet to 192.168.1.10 port 5000,
+  as fast as the link takes them, and answers a packet to port 5001 with the
+  number of packets sent so far. The board answers ping at 192.168.1.177.
+
+  Receive with e.g. "nc -ul 5000 | pv > /dev/null".
+*/
+
+#include <GD32Ethernet.h>
+
+uint8_t mac[] = {0x02, 0x00, 0x00, 0x32, 0x30, 0x37};
+IPAddress ip(192, 168, 1, 177);
+IPAddress host(192, 168, 1, 10);
+
+EthernetUDP stream;
+EthernetUDP control;
+uint32_t packets = 0;
+
+void setup()
+{
+    Serial.begin(115200);
+    while (!Ethernet.begin(mac, ip)) {
+        Serial.println("no link, retrying");
+        delay(1000);
+    }
+    stream.begin(5000);
+    control.begin(5001);
+}
+
+void loop()
+{
+    uint16_t samples[1024];
+
+    if (control.parsePacket() > 0) {
+        IPAddress from = control.remoteIP();
+        uint16_t port = control.remotePort();
+        control.flush();
+        control.beginPacket(from, port);
+        control.print(packets);
+        control.endPacket();
+    }
+
+    for (uint16_t i = 0; i < 1024; i++) {
+        samples[i] = analogRead(A0);
+    }
+    if (stream.beginPacket(host, 5000)) {
+        stream.write((const uint8_t *)samples, sizeof(samples));
+        if (stream.endPacket()) {
+            packets++;
+        }
+    }
+}
@@ -0,0 +1,235 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "GD32Ethernet.h"
+
+#if defined(ENET_DRIVER)
+
+/* what fits in a frame after the Ethernet, IPv4 and UDP headers */
+#define UDP_PAYLOAD_MAX         (ENET_FRAME_MAX - 42U)
+
+EthernetUDP::EthernetUDP(void)
+    : next(NULL), port(0), rxData(NULL), rxLength(0), rxPos(0), rxIP(0), rxPort(0), txData(NULL),
+      txLength(0), txIP(0), txPort(0)
+{
+    memset(txMac, 0, sizeof(txMac));
+}
+
+EthernetUDP::~EthernetUDP(void)
+{
+    stop();
+}
+
+/*!
+    \brief      listen on a port, any port not already open
+    \param[in]  port: local port, also the source port of sent packets
+    \param[out] none
+    \retval     1 if the socket is open, 0 if another socket has the port
+*/
+uint8_t EthernetUDP::begin(uint16_t port)
+{
+    stop();
+    this->port = port;
+    if (!Ethernet.attach(this)) {
+        this->port = 0;
+        return 0;
+    }
+    return 1;
+}
+
+void EthernetUDP::stop(void)
+{
+    flush();
+    if (txData != NULL) {
+        Ethernet.txCancel(this);
+        txData = NULL;
+    }
+    if (port != 0) {
+        Ethernet.detach(this);
+        port = 0;
+    }
+}
+
+/*!
+    \brief      look up the receiver and take the transmit buffer, write() fills it in place
+    \param[in]  ip: receiver
+    \param[in]  port: receiver port
+    \param[out] none
+    \retval     1 if the packet can be written, 0 if the MAC address of ip isn't known in time,
+                or another socket is building a packet
+*/
+int EthernetUDP::beginPacket(IPAddress ip, uint16_t port)
+{
+    if (txData != NULL) {
+        Ethernet.txCancel(this);
+        txData = NULL;
+    }
+    if (!Ethernet.ready || !Ethernet.resolve((uint32_t)ip, txMac)) {
+        return 0;
+    }
+    txData = Ethernet.txTake(this);
+    if (txData == NULL) {
+        return 0;
+    }
+    txIP = (uint32_t)ip;
+    txPort = port;
+    txLength = 0;
+    return 1;
+}
+
+int EthernetUDP::beginPacket(const char *host, uint16_t port)
+{
+    IPAddress ip;
+
+    if (!ip.fromString(host)) {
+        return 0;
+    }
+    return beginPacket(ip, port);
+}
+
+int EthernetUDP::endPacket(void)
+{
+    bool sent;
+
+    if (txData == NULL) {
+        return 0;
+    }
+    txData = NULL;
+    sent = Ethernet.udpSend(this, txMac, txIP, port, txPort, txLength);
+    return sent ? 1 : 0;
+}
+
+size_t EthernetUDP::write(uint8_t data)
+{
+    return write(&data, 1);
+}
+
+/*!
+    \brief      add bytes to the packet, straight into the DMA buffer
+    \param[in]  buffer: bytes to add
+    \param[in]  size: number of bytes
+    \param[out] none
+    \retval     bytes added, fewer once the packet fills a frame
+*/
+size_t EthernetUDP::write(const uint8_t *buffer, size_t size)
+{
+    if (txData == NULL) {
+        return 0;
+    }
+    if (size > UDP_PAYLOAD_MAX - txLength) {
+        size = UDP_PAYLOAD_MAX - txLength;
+    }
+    memcpy(txData + txLength, buffer, size);
+    txLength += size;
+    return size;
+}
+
+/*!
+    \brief      drop the current packet and look for the next one for this socket
+    \param[in]  none
+    \param[out] none
+    \retval     payload size of the packet, 0 if none came in
+*/
+int EthernetUDP::parsePacket(void)
+{
+    flush();
+    if (!Ethernet.poll() || (Ethernet.rxOwner != this)) {
+        return 0;
+    }
+    return rxLength;
+}
+
+int EthernetUDP::available(void)
+{
+    return (rxData != NULL) ? (rxLength - rxPos) : 0;
+}
+
+int EthernetUDP::read(void)
+{
+    if (available() <= 0) {
+        return -1;
+    }
+    return rxData[rxPos++];
+}
+
+int EthernetUDP::read(unsigned char *buffer, size_t len)
+{
+    size_t count = available();
+
+    if (count > len) {
+        count = len;
+    }
+    if (count > 0) {
+        memcpy(buffer, rxData + rxPos, count);
+        rxPos += count;
+    }
+    return count;
+}
+
+int EthernetUDP::read(char *buffer, size_t len)
+{
+    return read((unsigned char *)buffer, len);
+}
+
+int EthernetUDP::peek(void)
+{
+    if (available() <= 0) {
+        return -1;
+    }
+    return rxData[rxPos];
+}
+
+/*!
+    \brief      give the frame of the current packet back to the MAC
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void EthernetUDP::flush(void)
+{
+    if (rxData != NULL) {
+        rxData = NULL;
+        Ethernet.rxRelease(this);
+    }
+}
+
+IPAddress EthernetUDP::remoteIP(void)
+{
+    return IPAddress(rxIP);
+}
+
+uint16_t EthernetUDP::remotePort(void)
+{
+    return rxPort;
+}
+
+uint16_t EthernetUDP::localPort(void)
+{
+    return port;
+}
+
+#endif /* ENET_DRIVER */
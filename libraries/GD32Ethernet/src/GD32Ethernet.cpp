@@ -0,0 +1,477 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "GD32Ethernet.h"
+
+#if defined(ENET_DRIVER)
+
+#define ETH_HEADER              14U
+#define IP_HEADER               20U
+#define UDP_HEADER              8U
+#define ARP_LENGTH              28U
+#define ETH_TYPE_IP             0x0800U
+#define ETH_TYPE_ARP            0x0806U
+#define IP_PROTO_ICMP           1U
+#define IP_PROTO_UDP            17U
+#define IP_FLAG_DF              0x4000U
+#define IP_FLAG_MF_OFFSET       0x3FFFU
+#define IP_TTL                  64U
+#define ARP_OP_REQUEST          1U
+#define ARP_OP_REPLY            2U
+#define ICMP_ECHO_REQUEST       8U
+#define ICMP_ECHO_REPLY         0U
+
+/* how long a MAC address is trusted, and waited for */
+#define ETHERNET_ARP_LIFETIME_MS    300000UL
+#define ETHERNET_ARP_TIMEOUT_MS     250UL
+#define ETHERNET_ARP_RETRY_MS       50UL
+/* how long a frame may wait for a transmit buffer */
+#define ETHERNET_TX_TIMEOUT_MS      10UL
+
+static const uint8_t broadcastMac[ENET_MAC_LENGTH] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+static inline uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline void put16(uint8_t *p, uint16_t value)
+{
+    p[0] = (uint8_t)(value >> 8);
+    p[1] = (uint8_t)value;
+}
+
+static inline uint32_t get32(const uint8_t *p)
+{
+    uint32_t value;
+
+    memcpy(&value, p, 4);
+    return value;
+}
+
+static inline void put32(uint8_t *p, uint32_t value)
+{
+    memcpy(p, &value, 4);
+}
+
+GD32EthernetClass::GD32EthernetClass(void)
+    : ready(false), ip(0), subnet(0), gateway(0), ipId(0), sockets(NULL), rxOwner(NULL),
+      txOwner(NULL), txFrame(NULL)
+{
+    memset(mac, 0, sizeof(mac));
+    memset(arp, 0, sizeof(arp));
+}
+
+/*!
+    \brief      start the MAC and wait for the link
+    \param[in]  mac: own MAC address, 6 bytes
+    \param[in]  ip: own address
+    \param[in]  gateway: where packets off the subnet go, 0.0.0.0 for none
+    \param[in]  subnet: subnet mask
+    \param[out] none
+    \retval     true if the link is up
+*/
+bool GD32EthernetClass::begin(const uint8_t *mac, IPAddress ip, IPAddress gateway, IPAddress subnet)
+{
+    end();
+    memcpy(this->mac, mac, ENET_MAC_LENGTH);
+    this->ip = (uint32_t)ip;
+    this->gateway = (uint32_t)gateway;
+    this->subnet = (uint32_t)subnet;
+    memset(arp, 0, sizeof(arp));
+    ready = enet_driver_init(mac);
+    return ready;
+}
+
+/*!
+    \brief      stop the MAC, open sockets stay open but receive nothing
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void GD32EthernetClass::end(void)
+{
+    if (ready) {
+        enet_driver_deinit();
+        ready = false;
+    }
+    if (rxOwner != NULL) {
+        rxOwner->rxData = NULL;
+        rxOwner = NULL;
+    }
+    if (txOwner != NULL) {
+        txOwner->txData = NULL;
+        txOwner = NULL;
+    }
+}
+
+/*!
+    \brief      answer ARP and ping, and stop at the first UDP packet for an open socket
+    \param[in]  none
+    \param[out] none
+    \retval     true if a socket has a packet to read
+*/
+bool GD32EthernetClass::poll(void)
+{
+    uint8_t *frame;
+    uint16_t length;
+
+    if (!ready || (rxOwner != NULL)) {
+        return rxOwner != NULL;
+    }
+    while ((length = enet_driver_rx_frame(&frame)) != 0U) {
+        if (input(frame, length, true)) {
+            return true;
+        }
+        enet_driver_rx_release();
+    }
+    return false;
+}
+
+EthernetLinkStatus GD32EthernetClass::linkStatus(void)
+{
+    if (!ready) {
+        return Unknown;
+    }
+    return enet_driver_link_up() ? LinkON : LinkOFF;
+}
+
+IPAddress GD32EthernetClass::localIP(void)
+{
+    return IPAddress(ip);
+}
+
+IPAddress GD32EthernetClass::subnetMask(void)
+{
+    return IPAddress(subnet);
+}
+
+IPAddress GD32EthernetClass::gatewayIP(void)
+{
+    return IPAddress(gateway);
+}
+
+void GD32EthernetClass::MACAddress(uint8_t *mac)
+{
+    memcpy(mac, this->mac, ENET_MAC_LENGTH);
+}
+
+uint32_t GD32EthernetClass::dropped(void)
+{
+    return ready ? enet_driver_dropped() : 0;
+}
+
+/* true if the frame went to a socket, which releases it then */
+bool GD32EthernetClass::input(uint8_t *frame, uint16_t length, bool deliver)
+{
+    const uint8_t *ipHeader = frame + ETH_HEADER;
+    const uint8_t *udp;
+    uint16_t ipLength, headerLength, dstPort;
+    uint32_t dst;
+
+    if (length < ETH_HEADER) {
+        return false;
+    }
+    if (get16(frame + 12) == ETH_TYPE_ARP) {
+        arpInput(frame, length);
+        return false;
+    }
+    if ((get16(frame + 12) != ETH_TYPE_IP) || (length < ETH_HEADER + IP_HEADER)) {
+        return false;
+    }
+    headerLength = (ipHeader[0] & 0x0FU) * 4U;
+    ipLength = get16(ipHeader + 2);
+    dst = get32(ipHeader + 16);
+    /* no fragments, and only frames for this host or a broadcast */
+    if (((ipHeader[0] >> 4) != 4U) || (headerLength < IP_HEADER) || (ipLength < headerLength)
+            || (ipLength > length - ETH_HEADER) || ((get16(ipHeader + 6) & IP_FLAG_MF_OFFSET) != 0U)
+            || ((dst != ip) && (dst != 0xFFFFFFFFUL) && (dst != (ip | ~subnet)))) {
+        return false;
+    }
+    if (ipHeader[9] == IP_PROTO_ICMP) {
+        icmpInput(frame, ETH_HEADER + ipLength);
+        return false;
+    }
+    if ((ipHeader[9] != IP_PROTO_UDP) || (ipLength < headerLength + UDP_HEADER) || !deliver) {
+        return false;
+    }
+    udp = ipHeader + headerLength;
+    dstPort = get16(udp + 2);
+    for (EthernetUDP *socket = sockets; socket != NULL; socket = socket->next) {
+        if (socket->port == dstPort) {
+            /* the sender is most likely answered next */
+            if (((get32(ipHeader + 12) ^ ip) & subnet) == 0U) {
+                arpLearn(get32(ipHeader + 12), frame + 6);
+            }
+            socket->rxIP = get32(ipHeader + 12);
+            socket->rxPort = get16(udp);
+            socket->rxData = udp + UDP_HEADER;
+            socket->rxLength = get16(udp + 4);
+            if ((socket->rxLength < UDP_HEADER) || (socket->rxLength > ipLength - headerLength)) {
+                socket->rxData = NULL;
+                return false;
+            }
+            socket->rxLength -= UDP_HEADER;
+            socket->rxPos = 0;
+            rxOwner = socket;
+            return true;
+        }
+    }
+    return false;
+}
+
+void GD32EthernetClass::arpInput(const uint8_t *frame, uint16_t length)
+{
+    const uint8_t *packet = frame + ETH_HEADER;
+    uint8_t *reply;
+
+    if ((length < ETH_HEADER + ARP_LENGTH) || (get16(packet) != 1U) || (get16(packet + 2) != ETH_TYPE_IP)
+            || (get32(packet + 24) != ip)) {
+        return;
+    }
+    arpLearn(get32(packet + 14), packet + 8);
+    if ((get16(packet + 6) != ARP_OP_REQUEST) || (txOwner != NULL)) {
+        return;
+    }
+    reply = enet_driver_tx_buffer();
+    if (reply == NULL) {
+        return;
+    }
+    memcpy(reply, packet + 8, ENET_MAC_LENGTH);
+    memcpy(reply + 6, mac, ENET_MAC_LENGTH);
+    put16(reply + 12, ETH_TYPE_ARP);
+    memcpy(reply + ETH_HEADER, packet, 6);
+    put16(reply + ETH_HEADER + 6, ARP_OP_REPLY);
+    memcpy(reply + ETH_HEADER + 8, mac, ENET_MAC_LENGTH);
+    put32(reply + ETH_HEADER + 14, ip);
+    memcpy(reply + ETH_HEADER + 18, packet + 8, 10);
+    enet_driver_tx_send(ETH_HEADER + ARP_LENGTH);
+}
+
+void GD32EthernetClass::arpLearn(uint32_t ip, const uint8_t *mac)
+{
+    arpEntry_t *slot = &arp[0];
+
+    /* refresh the entry of ip, or replace the unused or oldest one */
+    for (uint8_t i = 0; i < ETHERNET_ARP_ENTRIES; i++) {
+        if (arp[i].ip == ip) {
+            slot = &arp[i];
+            break;
+        }
+        if ((arp[i].ip == 0U) || ((slot->ip != 0U) && ((int32_t)(arp[i].time - slot->time) < 0))) {
+            slot = &arp[i];
+        }
+    }
+    slot->ip = ip;
+    memcpy(slot->mac, mac, ENET_MAC_LENGTH);
+    slot->time = millis();
+}
+
+bool GD32EthernetClass::arpRequest(uint32_t ip)
+{
+    uint8_t *request = enet_driver_tx_buffer();
+
+    if (request == NULL) {
+        return false;
+    }
+    memcpy(request, broadcastMac, ENET_MAC_LENGTH);
+    memcpy(request + 6, mac, ENET_MAC_LENGTH);
+    put16(request + 12, ETH_TYPE_ARP);
+    put16(request + ETH_HEADER, 1U);
+    put16(request + ETH_HEADER + 2, ETH_TYPE_IP);
+    request[ETH_HEADER + 4] = ENET_MAC_LENGTH;
+    request[ETH_HEADER + 5] = 4U;
+    put16(request + ETH_HEADER + 6, ARP_OP_REQUEST);
+    memcpy(request + ETH_HEADER + 8, mac, ENET_MAC_LENGTH);
+    put32(request + ETH_HEADER + 14, this->ip);
+    memset(request + ETH_HEADER + 18, 0, ENET_MAC_LENGTH);
+    put32(request + ETH_HEADER + 24, ip);
+    return enet_driver_tx_send(ETH_HEADER + ARP_LENGTH);
+}
+
+/* echo requests come back from the transmit buffer, the MAC fills in the checksum */
+void GD32EthernetClass::icmpInput(const uint8_t *frame, uint16_t length)
+{
+    const uint8_t *ipHeader = frame + ETH_HEADER;
+    uint16_t headerLength = (ipHeader[0] & 0x0FU) * 4U;
+    uint8_t *reply;
+
+    if ((length < ETH_HEADER + headerLength + 8U) || (ipHeader[headerLength] != ICMP_ECHO_REQUEST)
+            || (get32(ipHeader + 16) != ip) || (txOwner != NULL)) {
+        return;
+    }
+    reply = enet_driver_tx_buffer();
+    if (reply == NULL) {
+        return;
+    }
+    memcpy(reply, frame + 6, ENET_MAC_LENGTH);
+    memcpy(reply + 6, mac, ENET_MAC_LENGTH);
+    memcpy(reply + 12, frame + 12, length - 12U);
+    reply[ETH_HEADER + 8] = IP_TTL;
+    put16(reply + ETH_HEADER + 10, 0U);
+    put32(reply + ETH_HEADER + 12, ip);
+    put32(reply + ETH_HEADER + 16, get32(ipHeader + 12));
+    reply[ETH_HEADER + headerLength] = ICMP_ECHO_REPLY;
+    put16(reply + ETH_HEADER + headerLength + 2, 0U);
+    enet_driver_tx_send(length);
+}
+
+/* the MAC address ip is reached at, asking for it if it isn't known */
+bool GD32EthernetClass::resolve(uint32_t ip, uint8_t *mac)
+{
+    uint32_t start, sent;
+    uint8_t *frame;
+    uint16_t length;
+
+    if ((ip == 0xFFFFFFFFUL) || (ip == (this->ip | ~subnet))) {
+        memcpy(mac, broadcastMac, ENET_MAC_LENGTH);
+        return true;
+    }
+    if (((ip ^ this->ip) & subnet) != 0U) {
+        if (gateway == 0U) {
+            return false;
+        }
+        ip = gateway;
+    }
+    start = millis();
+    sent = start - ETHERNET_ARP_RETRY_MS;
+    while (true) {
+        for (uint8_t i = 0; i < ETHERNET_ARP_ENTRIES; i++) {
+            if ((arp[i].ip == ip) && ((millis() - arp[i].time) < ETHERNET_ARP_LIFETIME_MS)) {
+                memcpy(mac, arp[i].mac, ENET_MAC_LENGTH);
+                return true;
+            }
+        }
+        /* a frame held by a socket blocks the answer behind it */
+        if ((rxOwner != NULL) || ((millis() - start) >= ETHERNET_ARP_TIMEOUT_MS)) {
+            return false;
+        }
+        if ((millis() - sent) >= ETHERNET_ARP_RETRY_MS) {
+            if (arpRequest(ip)) {
+                sent = millis();
+            }
+        }
+        /* waiting for the answer, UDP packets meanwhile are lost */
+        while ((length = enet_driver_rx_frame(&frame)) != 0U) {
+            input(frame, length, false);
+            enet_driver_rx_release();
+        }
+    }
+}
+
+/* the payload part of the next transmit buffer, for owner alone until udpSend() or txCancel() */
+uint8_t *GD32EthernetClass::txTake(EthernetUDP *owner)
+{
+    uint32_t start = millis();
+
+    if (!ready || ((txOwner != NULL) && (txOwner != owner))) {
+        return NULL;
+    }
+    while ((txFrame = enet_driver_tx_buffer()) == NULL) {
+        if ((millis() - start) >= ETHERNET_TX_TIMEOUT_MS) {
+            return NULL;
+        }
+    }
+    txOwner = owner;
+    return txFrame + ETH_HEADER + IP_HEADER + UDP_HEADER;
+}
+
+/* put the headers before the payload of txTake() and send it, the MAC inserts both checksums */
+bool GD32EthernetClass::udpSend(EthernetUDP *owner, const uint8_t *mac, uint32_t ip, uint16_t srcPort,
+                                uint16_t dstPort, uint16_t length)
+{
+    uint8_t *header = txFrame + ETH_HEADER;
+
+    if (txOwner != owner) {
+        return false;
+    }
+    txOwner = NULL;
+    memcpy(txFrame, mac, ENET_MAC_LENGTH);
+    memcpy(txFrame + 6, this->mac, ENET_MAC_LENGTH);
+    put16(txFrame + 12, ETH_TYPE_IP);
+    header[0] = 0x45U;
+    header[1] = 0U;
+    put16(header + 2, IP_HEADER + UDP_HEADER + length);
+    put16(header + 4, ipId++);
+    put16(header + 6, IP_FLAG_DF);
+    header[8] = IP_TTL;
+    header[9] = IP_PROTO_UDP;
+    put16(header + 10, 0U);
+    put32(header + 12, this->ip);
+    put32(header + 16, ip);
+    header += IP_HEADER;
+    put16(header, srcPort);
+    put16(header + 2, dstPort);
+    put16(header + 4, UDP_HEADER + length);
+    put16(header + 6, 0U);
+    return enet_driver_tx_send(ETH_HEADER + IP_HEADER + UDP_HEADER + length);
+}
+
+void GD32EthernetClass::txCancel(EthernetUDP *owner)
+{
+    if (txOwner == owner) {
+        txOwner = NULL;
+    }
+}
+
+void GD32EthernetClass::rxRelease(EthernetUDP *owner)
+{
+    if (rxOwner == owner) {
+        rxOwner = NULL;
+        enet_driver_rx_release();
+    }
+}
+
+bool GD32EthernetClass::attach(EthernetUDP *socket)
+{
+    for (EthernetUDP *other = sockets; other != NULL; other = other->next) {
+        if ((other == socket) || (other->port == socket->port)) {
+            return false;
+        }
+    }
+    socket->next = sockets;
+    sockets = socket;
+    return true;
+}
+
+void GD32EthernetClass::detach(EthernetUDP *socket)
+{
+    EthernetUDP **link = &sockets;
+
+    while (*link != NULL) {
+        if (*link == socket) {
+            *link = socket->next;
+            break;
+        }
+        link = &(*link)->next;
+    }
+    socket->next = NULL;
+}
+
+GD32EthernetClass Ethernet;
+
+#endif /* ENET_DRIVER */
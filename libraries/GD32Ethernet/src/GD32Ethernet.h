@@ -0,0 +1,156 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef GD32ETHERNET_H
+#define GD32ETHERNET_H
+
+#include "Arduino.h"
+#include "Udp.h"
+extern "C" {
+#include "utility/enet_driver.h"
+}
+
+#if defined(ENET_DRIVER)
+
+/* hosts whose MAC address is kept */
+#ifndef ETHERNET_ARP_ENTRIES
+#define ETHERNET_ARP_ENTRIES    8
+#endif
+
+enum EthernetLinkStatus {
+    Unknown,
+    LinkON,
+    LinkOFF
+};
+
+class EthernetUDP;
+
+/* IPv4 on the ENET MAC with a static address: ARP, ping replies and UDP, no TCP. Incoming
+   frames are handled from poll(), or from parsePacket() of any socket; a packet stays in its
+   DMA buffer while the socket reads it, and an outgoing one is written straight into the
+   DMA buffer it leaves from. With lwIP in the sketch, see utility/enet_lwip.h instead */
+class GD32EthernetClass
+{
+    public:
+        GD32EthernetClass(void);                                                      //GD32EthernetClass object construct
+        bool begin(const uint8_t *mac, IPAddress ip, IPAddress gateway = IPAddress(0, 0, 0, 0),
+                   IPAddress subnet = IPAddress(255, 255, 255, 0));                   //bring the link up
+        void end(void);                                                               //stop the MAC
+        bool poll(void);                                                              //handle incoming frames
+        EthernetLinkStatus linkStatus(void);                                          //check the PHY link
+        IPAddress localIP(void);                                                      //own address
+        IPAddress subnetMask(void);                                                   //subnet mask
+        IPAddress gatewayIP(void);                                                    //default gateway
+        void MACAddress(uint8_t *mac);                                                //own MAC address
+        uint32_t dropped(void);                                                       //frames lost to full buffers
+
+    private:
+        friend class EthernetUDP;
+
+        typedef struct {
+            uint32_t ip;
+            uint8_t mac[ENET_MAC_LENGTH];
+            uint32_t time;                                                            //millis() of the last answer
+        } arpEntry_t;
+
+        bool input(uint8_t *frame, uint16_t length, bool deliver);
+        void arpInput(const uint8_t *frame, uint16_t length);
+        void arpLearn(uint32_t ip, const uint8_t *mac);
+        bool arpRequest(uint32_t ip);
+        void icmpInput(const uint8_t *frame, uint16_t length);
+        bool resolve(uint32_t ip, uint8_t *mac);
+        uint8_t *txTake(EthernetUDP *owner);
+        bool udpSend(EthernetUDP *owner, const uint8_t *mac, uint32_t ip, uint16_t srcPort,
+                     uint16_t dstPort, uint16_t length);
+        void txCancel(EthernetUDP *owner);
+        void rxRelease(EthernetUDP *owner);
+        bool attach(EthernetUDP *socket);
+        void detach(EthernetUDP *socket);
+
+        bool ready;
+        uint8_t mac[ENET_MAC_LENGTH];
+        uint32_t ip;
+        uint32_t subnet;
+        uint32_t gateway;
+        uint16_t ipId;
+        arpEntry_t arp[ETHERNET_ARP_ENTRIES];
+        EthernetUDP *sockets;
+        EthernetUDP *rxOwner;                                                         //socket reading a frame
+        EthernetUDP *txOwner;                                                         //socket building a frame
+        uint8_t *txFrame;
+};
+
+/* UDP socket, see GD32EthernetClass. Only one socket holds a received packet at a time, and
+   others receive nothing until it moves on with parsePacket(), flush() or stop(); the same
+   goes for building a packet between beginPacket() and endPacket(). No name lookup,
+   beginPacket() takes the host as a dotted address */
+class EthernetUDP : public UDP
+{
+    public:
+        EthernetUDP(void);                                                            //EthernetUDP object construct
+        ~EthernetUDP(void);
+        uint8_t begin(uint16_t port) override;                                        //listen on a port
+        void stop(void) override;                                                     //close the socket
+        int beginPacket(IPAddress ip, uint16_t port) override;                        //start a packet to ip
+        int beginPacket(const char *host, uint16_t port) override;                    //start a packet to a dotted address
+        int endPacket(void) override;                                                 //send the packet
+        size_t write(uint8_t data) override;                                          //add a byte to the packet
+        size_t write(const uint8_t *buffer, size_t size) override;                    //add bytes to the packet
+        using Print::write;
+        int parsePacket(void) override;                                               //move to the next packet
+        int available(void) override;                                                 //bytes left in the packet
+        int read(void) override;                                                      //read a byte
+        int read(unsigned char *buffer, size_t len) override;                         //read bytes
+        int read(char *buffer, size_t len) override;                                  //read bytes
+        int peek(void) override;                                                      //next byte, not read
+        void flush(void) override;                                                    //drop the rest of the packet
+        IPAddress remoteIP(void) override;                                            //sender of the packet
+        uint16_t remotePort(void) override;                                           //sender port of the packet
+        uint16_t localPort(void);                                                     //port listened on
+
+    private:
+        friend class GD32EthernetClass;
+
+        EthernetUDP *next;
+        uint16_t port;
+        const uint8_t *rxData;
+        uint16_t rxLength;
+        uint16_t rxPos;
+        uint32_t rxIP;
+        uint16_t rxPort;
+        uint8_t *txData;
+        uint16_t txLength;
+        uint32_t txIP;
+        uint16_t txPort;
+        uint8_t txMac[ENET_MAC_LENGTH];
+};
+
+extern GD32EthernetClass Ethernet;
+
+#endif /* ENET_DRIVER */
+
+#endif /* GD32ETHERNET_H */
@@ -0,0 +1,249 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <stddef.h>
+#include "enet_driver.h"
+#include "PinNames.h"
+#include "pinmap.h"
+#include "irq_priority.h"
+
+#if defined(ENET_DRIVER)
+
+/* the descriptor rings of gd32f30x_enet.c */
+extern enet_descriptors_struct txdesc_tab[ENET_TXBUF_NUM];
+extern enet_descriptors_struct *dma_current_txdesc;
+extern enet_descriptors_struct *dma_current_rxdesc;
+
+static const PinName enet_pins_out[] = {PORTA_2, PORTC_1, PORTB_11, PORTB_12, PORTB_13};
+static const PinName enet_pins_in[] = {PORTA_1, PORTA_7, PORTC_4, PORTC_5};
+
+static enet_driver_callback_t enet_rx_callback;
+static void *enet_rx_arg;
+static uint32_t enet_dropped;
+
+static void enet_pins_init(uint32_t out_mode, uint32_t in_mode)
+{
+    uint8_t i;
+
+    for (i = 0U; i < sizeof(enet_pins_out) / sizeof(enet_pins_out[0]); i++) {
+        pin_function(enet_pins_out[i], GD_PIN_FUNCTION1(out_mode, 0));
+    }
+    for (i = 0U; i < sizeof(enet_pins_in) / sizeof(enet_pins_in[0]); i++) {
+        pin_function(enet_pins_in[i], GD_PIN_FUNCTION1(in_mode, 0));
+    }
+}
+
+/*!
+    \brief      bring the MAC up on the PHY, waits for the link and auto-negotiation
+    \param[in]  mac: station address
+    \param[out] none
+    \retval     true if the link is up, false if the PHY doesn't answer or has no link
+*/
+bool enet_driver_init(const uint8_t mac[ENET_MAC_LENGTH])
+{
+    uint8_t address[ENET_MAC_LENGTH];
+    uint8_t i;
+
+    rcu_periph_clock_enable(RCU_AF);
+    gpio_ethernet_phy_select(GPIO_ENET_PHY_RMII);
+    enet_pins_init(PIN_MODE_AF_PP, PIN_MODE_IN_FLOATING);
+    rcu_periph_clock_enable(RCU_ENET);
+    rcu_periph_clock_enable(RCU_ENETTX);
+    rcu_periph_clock_enable(RCU_ENETRX);
+
+    enet_deinit();
+    if (ERROR == enet_software_reset()) {
+        enet_driver_deinit();
+        return false;
+    }
+    /* frames with a bad IP, TCP or UDP checksum never reach the descriptors */
+    if (ERROR == enet_init(ENET_AUTO_NEGOTIATION, ENET_AUTOCHECKSUM_DROP_FAILFRAMES, ENET_BROADCAST_FRAMES_PASS)) {
+        enet_driver_deinit();
+        return false;
+    }
+    for (i = 0U; i < ENET_MAC_LENGTH; i++) {
+        address[i] = mac[i];
+    }
+    enet_mac_address_set(ENET_MAC_ADDRESS0, address);
+
+    enet_descriptors_chain_init(ENET_DMA_TX);
+    enet_descriptors_chain_init(ENET_DMA_RX);
+    /* the checksum mode stays in each descriptor, enet_frame_transmit() only adds to it */
+    for (i = 0U; i < ENET_TXBUF_NUM; i++) {
+        enet_transmit_checksum_config(&txdesc_tab[i], ENET_CHECKSUM_TCPUDPICMP_FULL);
+    }
+    enet_missed_frame_counter_get(&enet_dropped, &enet_dropped);
+    enet_dropped = 0U;
+
+    enet_interrupt_enable(ENET_DMA_INT_NIE);
+    enet_interrupt_enable(ENET_DMA_INT_RIE);
+    irq_priority_enable(ENET_IRQn, IRQ_PRIO_ENET);
+    enet_enable();
+    return true;
+}
+
+/*!
+    \brief      stop the MAC and release its pins
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void enet_driver_deinit(void)
+{
+    nvic_irq_disable(ENET_IRQn);
+    enet_disable();
+    enet_deinit();
+    rcu_periph_clock_disable(RCU_ENETRX);
+    rcu_periph_clock_disable(RCU_ENETTX);
+    rcu_periph_clock_disable(RCU_ENET);
+    enet_pins_init(PIN_MODE_IN_FLOATING, PIN_MODE_IN_FLOATING);
+}
+
+/*!
+    \brief      read the link state from the PHY
+    \param[in]  none
+    \param[out] none
+    \retval     true if a link is established
+*/
+bool enet_driver_link_up(void)
+{
+    uint16_t status = 0U;
+
+    if (ERROR == enet_phy_write_read(ENET_PHY_READ, PHY_ADDRESS, PHY_REG_BSR, &status)) {
+        return false;
+    }
+    return (status & PHY_LINKED_STATUS) != 0U;
+}
+
+/*!
+    \brief      find the oldest received frame, frames with errors are dropped on the way
+    \param[in]  none
+    \param[out] frame: where the frame is, in the DMA buffer
+    \retval     length of the frame without the CRC, 0 if no frame is waiting
+*/
+uint16_t enet_driver_rx_frame(uint8_t **frame)
+{
+    uint32_t length;
+
+    /* 1 means a frame with an error was dropped, the next one may be good */
+    do {
+        length = enet_rxframe_size_get();
+    } while (length == 1U);
+    if ((length == 0U) || (length > ENET_FRAME_MAX)) {
+        if (length != 0U) {
+            enet_driver_rx_release();
+        }
+        return 0U;
+    }
+    *frame = (uint8_t *)dma_current_rxdesc->buffer1_addr;
+    return (uint16_t)length;
+}
+
+/*!
+    \brief      give the frame of enet_driver_rx_frame() back to the DMA
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void enet_driver_rx_release(void)
+{
+    ENET_NOCOPY_FRAME_RECEIVE();
+}
+
+/*!
+    \brief      get the DMA buffer the next frame is sent from
+    \param[in]  none
+    \param[out] none
+    \retval     ENET_FRAME_MAX bytes to build the frame in, NULL while the DMA still sends from it
+*/
+uint8_t *enet_driver_tx_buffer(void)
+{
+    if ((dma_current_txdesc->status & ENET_TDES0_DAV) != 0U) {
+        return NULL;
+    }
+    return (uint8_t *)dma_current_txdesc->buffer1_addr;
+}
+
+/*!
+    \brief      queue the frame built in the enet_driver_tx_buffer() buffer
+    \param[in]  length: frame length without the CRC, the MAC pads short frames
+    \param[out] none
+    \retval     true if the frame is queued
+*/
+bool enet_driver_tx_send(uint16_t length)
+{
+    if (length > ENET_FRAME_MAX) {
+        return false;
+    }
+    return SUCCESS == ENET_NOCOPY_FRAME_TRANSMIT(length);
+}
+
+/*!
+    \brief      set the function called from the ENET interrupt when a frame came in
+    \param[in]  callback: the function, NULL for none
+    \param[in]  arg: passed through to callback
+    \param[out] none
+    \retval     none
+*/
+void enet_driver_on_receive(enet_driver_callback_t callback, void *arg)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    enet_rx_callback = callback;
+    enet_rx_arg = arg;
+    __set_PRIMASK(primask);
+}
+
+/*!
+    \brief      count the frames lost to full receive buffers since enet_driver_init()
+    \param[in]  none
+    \param[out] none
+    \retval     number of frames
+*/
+uint32_t enet_driver_dropped(void)
+{
+    uint32_t by_fifo = 0U, by_dma = 0U;
+
+    /* the hardware counters clear when read */
+    enet_missed_frame_counter_get(&by_fifo, &by_dma);
+    enet_dropped += by_fifo + by_dma;
+    return enet_dropped;
+}
+
+__attribute__((used)) void ENET_IRQHandler(void)
+{
+    if (RESET != enet_interrupt_flag_get(ENET_DMA_INT_FLAG_RS)) {
+        enet_interrupt_flag_clear(ENET_DMA_INT_FLAG_RS_CLR);
+        if (enet_rx_callback != NULL) {
+            enet_rx_callback(enet_rx_arg);
+        }
+    }
+    enet_interrupt_flag_clear(ENET_DMA_INT_FLAG_NI_CLR);
+}
+
+#endif /* ENET_DRIVER */
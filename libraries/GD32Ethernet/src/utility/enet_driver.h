@@ -0,0 +1,87 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef __ENET_DRIVER_H
+#define __ENET_DRIVER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gd32xxyy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(GD32F30X_CL)
+#define ENET_DRIVER             1
+#endif
+
+#if defined(ENET_DRIVER)
+
+#define ENET_MAC_LENGTH         6U
+/* largest frame handed in or out, without the CRC */
+#define ENET_FRAME_MAX          1514U
+
+typedef void (*enet_driver_callback_t)(void *arg);
+
+/*
+ * Ethernet MAC on an RMII PHY, on the descriptor rings of the standard
+ * peripheral library (ENET_RXBUF_NUM and ENET_TXBUF_NUM frame buffers each,
+ * chained mode). Frames are never copied: a received frame is read where the
+ * DMA wrote it and handed back with enet_driver_rx_release(), a frame to send
+ * is built in the DMA buffer of enet_driver_tx_buffer() and queued with
+ * enet_driver_tx_send(). The MAC inserts the IPv4 header, TCP, UDP and ICMP
+ * checksums of outgoing frames and drops incoming frames with a bad one.
+ *
+ * The pins are fixed: PA1 REF_CLK, PA2 MDIO, PA7 CRS_DV, PC1 MDC, PC4 RXD0,
+ * PC5 RXD1, PB11 TX_EN, PB12 TXD0, PB13 TXD1. The PHY runs from its own 50 MHz
+ * clock and answers at PHY_ADDRESS (gd32f30x_enet.h, DP83848 registers).
+ */
+/* false if the PHY doesn't answer or no link came up */
+bool enet_driver_init(const uint8_t mac[ENET_MAC_LENGTH]);
+void enet_driver_deinit(void);
+bool enet_driver_link_up(void);
+/* length of the oldest received frame and where it is, 0 if there is none */
+uint16_t enet_driver_rx_frame(uint8_t **frame);
+/* give the frame of enet_driver_rx_frame() back to the DMA */
+void enet_driver_rx_release(void);
+/* the buffer the next frame goes out of, NULL while the DMA still owns it */
+uint8_t *enet_driver_tx_buffer(void);
+/* send length bytes of the enet_driver_tx_buffer() buffer */
+bool enet_driver_tx_send(uint16_t length);
+/* callback(arg) from the ENET interrupt whenever a frame came in, NULL for none */
+void enet_driver_on_receive(enet_driver_callback_t callback, void *arg);
+/* frames lost because every receive buffer was full */
+uint32_t enet_driver_dropped(void);
+
+#endif /* ENET_DRIVER */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ENET_DRIVER_H */
@@ -0,0 +1,100 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "enet_lwip.h"
+
+#if defined(ENET_LWIP)
+
+#include <string.h>
+#include <lwip/pbuf.h>
+#include <lwip/etharp.h>
+
+static err_t enet_lwip_output(struct netif *netif, struct pbuf *p)
+{
+    uint8_t *frame = enet_driver_tx_buffer();
+
+    (void)netif;
+    if ((frame == NULL) || (p->tot_len > ENET_FRAME_MAX)) {
+        return ERR_MEM;
+    }
+    pbuf_copy_partial(p, frame, p->tot_len, 0);
+    return enet_driver_tx_send(p->tot_len) ? ERR_OK : ERR_IF;
+}
+
+/*!
+    \brief      start the MAC for an lwIP interface, for netif_add()
+    \param[in]  netif: the interface, hwaddr holds the MAC address
+    \param[out] none
+    \retval     ERR_OK, ERR_IF if the PHY has no link
+*/
+err_t enet_lwip_netif_init(struct netif *netif)
+{
+    netif->name[0] = 'e';
+    netif->name[1] = 'n';
+    netif->output = etharp_output;
+    netif->linkoutput = enet_lwip_output;
+    netif->mtu = 1500;
+    netif->hwaddr_len = ETH_HWADDR_LEN;
+    netif->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP | NETIF_FLAG_ETHERNET;
+    if (!enet_driver_init(netif->hwaddr)) {
+        return ERR_IF;
+    }
+    netif->flags |= NETIF_FLAG_LINK_UP;
+    return ERR_OK;
+}
+
+/*!
+    \brief      hand the received frames to lwIP
+    \param[in]  netif: the interface of enet_lwip_netif_init()
+    \param[out] none
+    \retval     number of frames passed on
+*/
+uint32_t enet_lwip_input(struct netif *netif)
+{
+    uint32_t count = 0U;
+    uint16_t length;
+    uint8_t *frame;
+    struct pbuf *p;
+
+    while ((length = enet_driver_rx_frame(&frame)) != 0U) {
+        p = pbuf_alloc(PBUF_RAW, length, PBUF_POOL);
+        if (p != NULL) {
+            pbuf_take(p, frame, length);
+        }
+        enet_driver_rx_release();
+        if (p == NULL) {
+            continue;
+        }
+        if (netif->input(p, netif) != ERR_OK) {
+            pbuf_free(p);
+        }
+        count++;
+    }
+    return count;
+}
+
+#endif /* ENET_LWIP */
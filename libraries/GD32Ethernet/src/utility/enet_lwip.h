@@ -0,0 +1,68 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef __ENET_LWIP_H
+#define __ENET_LWIP_H
+
+#include "enet_driver.h"
+
+#if defined(ENET_DRIVER) && defined(__has_include)
+#if __has_include(<lwip/netif.h>)
+#define ENET_LWIP               1
+#endif
+#endif
+
+#if defined(ENET_LWIP)
+#include <lwip/netif.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * lwIP port on the ENET driver, built when lwIP is among the sketch
+ * libraries; GD32EthernetClass is not used then. Add the interface with
+ *
+ *     netif_add(&netif, &ip, &mask, &gw, NULL, enet_lwip_netif_init, ethernet_input);
+ *
+ * and call enet_lwip_input() from the main loop (NO_SYS) or the lwIP thread.
+ * Set the MAC address in netif->hwaddr before netif_add(). The MAC computes
+ * the checksums, so lwipopts.h can turn CHECKSUM_GEN_* and CHECKSUM_CHECK_*
+ * off. Outgoing pbuf chains are gathered into the DMA buffer, incoming frames
+ * are copied from theirs into a PBUF_POOL pbuf so the DMA gets it back at once.
+ */
+err_t enet_lwip_netif_init(struct netif *netif);
+/* pass the received frames to netif->input, returns how many */
+uint32_t enet_lwip_input(struct netif *netif);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ENET_LWIP */
+
+#endif /* __ENET_LWIP_H */
@@ -0,0 +1,62 @@
+/*
+  Play and record
+
+  I2S1 plays a 1 kHz tone at 48 kHz, 16 bits, to a DAC as master, with MCK
+  for the DAC on PC6. I2S2 records an ADC as slave on the same clock: wire
+  I2S2 WS (PA15) to I2S1 WS (PB12) and I2S2 CK (PB3) to I2S1 CK (PB13). Both
+  run from DMA, the CPU only fills and reads half a buffer at a time.
+*/
+
+#include <I2S.h>
+
+#define FRAMES 256
+
+int16_t playBuffer[2 * FRAMES];
+int16_t recordBuffer[2 * FRAMES];
+volatile int16_t peak = 0;
+uint32_t phase = 0;
+
+void play(void *buffer, size_t count, void *arg)
+{
+    int16_t *samples = (int16_t *)buffer;
+
+    for (size_t i = 0; i < count; i += 2) {
+        int16_t value = 8000 * sin(2 * PI * phase / 48);
+        samples[i] = value;
+        samples[i + 1] = value;
+        phase = (phase + 1) % 48;
+    }
+}
+
+void record(void *buffer, size_t count, void *arg)
+{
+    int16_t *samples = (int16_t *)buffer;
+    int16_t max = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (abs(samples[i]) > max) {
+            max = abs(samples[i]);
+        }
+    }
+    peak = max;
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    I2S1.setMasterClock(true);
+    // the slave waits for the clock of the master
+    I2S2.begin(I2S_SLAVE_RECEIVE, 48000, 16, recordBuffer, 2 * FRAMES, record);
+    if (!I2S1.begin(I2S_MASTER_TRANSMIT, 48000, 16, playBuffer, 2 * FRAMES, play)) {
+        Serial.println("I2S1 not started");
+    }
+    Serial.print("sample rate ");
+    Serial.println(I2S1.sampleRate());
+}
+
+void loop()
+{
+    Serial.print("input peak ");
+    Serial.println(peak);
+    delay(500);
+}
@@ -0,0 +1,359 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "I2S.h"
+#include "gd32/clock.h"
+
+#if defined(GD32F30x) || defined(GD32E50X)
+
+/* the DMA counts 16-bit transfers */
+#define I2S_DMA_MAX             0xFFFFU
+
+enum {
+    I2S_PIN_WS = 0,
+    I2S_PIN_CK,
+    I2S_PIN_SD,
+    I2S_PIN_MCK,
+    I2S_PIN_COUNT
+};
+
+static const PinName i2s1_pins[I2S_PIN_COUNT] = {PORTB_12, PORTB_13, PORTB_15, PORTC_6};
+static const PinName i2s2_pins[I2S_PIN_COUNT] = {PORTA_15, PORTB_3, PORTB_5, PORTC_7};
+
+/*!
+    \brief      I2SClass object construct
+    \param[in]  spi: SPI1 or SPI2
+    \param[out] none
+    \retval     none
+*/
+I2SClass::I2SClass(uint32_t spi)
+{
+    this->spi = spi;
+    this->standard = I2S_STD_PHILLIPS;
+    this->polarity = I2S_CKPL_LOW;
+    this->masterClock = false;
+    this->direction = I2S_MASTER_TRANSMIT;
+    this->buffer = NULL;
+    this->length = 0;
+    this->bits = 16;
+    this->callback = NULL;
+    this->arg = NULL;
+    this->running = false;
+}
+
+/*!
+    \brief      stop streaming, the DMA must not touch the buffer of a destroyed object
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+I2SClass::~I2SClass(void)
+{
+    end();
+}
+
+/*!
+    \brief      set the frame format, takes effect with the next begin()
+    \param[in]  standard: I2S_STD_PHILLIPS, I2S_STD_MSB, I2S_STD_LSB, I2S_STD_PCMSHORT or I2S_STD_PCMLONG
+    \param[in]  polarity: idle level of CK, I2S_CKPL_LOW or I2S_CKPL_HIGH
+    \param[out] none
+    \retval     none
+*/
+void I2SClass::setFormat(uint32_t standard, uint32_t polarity)
+{
+    this->standard = standard;
+    this->polarity = polarity;
+}
+
+/*!
+    \brief      output MCK at 256 times the sample rate from a master, takes effect with the next begin()
+    \param[in]  enable: true to output MCK
+    \param[out] none
+    \retval     none
+*/
+void I2SClass::setMasterClock(bool enable)
+{
+    this->masterClock = enable;
+}
+
+/*!
+    \brief      swap the 16-bit halves of 32-bit samples, the bus takes the upper half first but
+                the DMA moves the lower one first
+    \param[in]  first: index of the first sample
+    \param[in]  count: number of samples
+    \param[out] none
+    \retval     none
+*/
+void I2SClass::swapHalves(size_t first, size_t count)
+{
+    uint32_t *sample = (uint32_t *)this->buffer + first;
+
+    if (this->bits == 16) {
+        return;
+    }
+    while (count-- > 0U) {
+        *sample = __ROR(*sample, 16);
+        sample++;
+    }
+}
+
+/*!
+    \brief      route the pins to the I2S, or back to inputs
+    \param[in]  enable: true to route them
+    \param[out] none
+    \retval     none
+*/
+void I2SClass::pinsInit(bool enable)
+{
+    const PinName *pins = (this->spi == SPI1) ? i2s1_pins : i2s2_pins;
+    bool master = (this->direction == I2S_MASTER_TRANSMIT) || (this->direction == I2S_MASTER_RECEIVE);
+    bool transmit = (this->direction == I2S_MASTER_TRANSMIT) || (this->direction == I2S_SLAVE_TRANSMIT);
+    uint32_t clockMode = (enable && master) ? PIN_MODE_AF_PP : PIN_MODE_IN_FLOATING;
+
+    pin_function(pins[I2S_PIN_WS], GD_PIN_FUNCTION1(clockMode, 0));
+    pin_function(pins[I2S_PIN_CK], GD_PIN_FUNCTION1(clockMode, 0));
+    pin_function(pins[I2S_PIN_SD], GD_PIN_FUNCTION1((enable && transmit) ? PIN_MODE_AF_PP : PIN_MODE_IN_FLOATING, 0));
+    if (master && this->masterClock) {
+        pin_function(pins[I2S_PIN_MCK], GD_PIN_FUNCTION1(enable ? PIN_MODE_AF_PP : PIN_MODE_IN_FLOATING, 0));
+    }
+}
+
+/*!
+    \brief      DMA callback, hands each half of the buffer to the user callback; samples received
+                get their halves swapped before it, samples to send after it
+    \param[in]  arg: the I2SClass object
+    \param[in]  flags: DMA_CALLBACK_FLAG_x
+    \param[out] none
+    \retval     none
+*/
+void I2SClass::dmaIrq(void *arg, uint32_t flags)
+{
+    I2SClass *i2s = (I2SClass *)arg;
+    bool transmit = (i2s->direction == I2S_MASTER_TRANSMIT) || (i2s->direction == I2S_SLAVE_TRANSMIT);
+    size_t half = i2s->length / 2;
+    size_t first;
+
+    if ((flags & (DMA_CALLBACK_FLAG_HTF | DMA_CALLBACK_FLAG_FTF)) == 0U) {
+        return;
+    }
+    first = (flags & DMA_CALLBACK_FLAG_HTF) ? 0U : half;
+    if (!transmit) {
+        i2s->swapHalves(first, half);
+    }
+    i2s->callback((uint8_t *)i2s->buffer + first * ((i2s->bits == 16) ? 2U : 4U), half, i2s->arg);
+    if (transmit) {
+        i2s->swapHalves(first, half);
+    }
+}
+
+/*!
+    \brief      start streaming the buffer over and over
+    \param[in]  direction: I2S_MASTER_TRANSMIT, I2S_MASTER_RECEIVE, I2S_SLAVE_TRANSMIT or I2S_SLAVE_RECEIVE
+    \param[in]  sampleRate: samples per second and channel, a master comes as close as its clock allows
+    \param[in]  bits: 16, 24 or 32
+    \param[in]  buffer: ring buffer of int16_t or int32_t samples, must stay valid while streaming
+    \param[in]  length: number of samples in buffer, a multiple of 4 so each half holds whole frames
+    \param[in]  callback: called from the DMA interrupt with each half of the buffer, NULL to send
+                the buffer as it is or to receive without being told
+    \param[in]  arg: passed through to callback
+    \param[out] none
+    \retval     false if a parameter is out of range or the DMA channel is taken
+*/
+bool I2SClass::begin(i2s_direction_t direction, uint32_t sampleRate, uint8_t bits, void *buffer,
+                     size_t length, i2sCallback_t callback, void *arg)
+{
+    static const uint32_t modes[] = {
+        I2S_MODE_MASTERTX, I2S_MODE_MASTERRX, I2S_MODE_SLAVETX, I2S_MODE_SLAVERX
+    };
+    dma_parameter_struct dma_init_struct;
+    bool transmit = (direction == I2S_MASTER_TRANSMIT) || (direction == I2S_SLAVE_TRANSMIT);
+    uint32_t format;
+    size_t transfers;
+
+    end();
+    if (bits == 16) {
+        format = I2S_FRAMEFORMAT_DT16B_CH16B;
+    } else if (bits == 24) {
+        format = I2S_FRAMEFORMAT_DT24B_CH32B;
+    } else if (bits == 32) {
+        format = I2S_FRAMEFORMAT_DT32B_CH32B;
+    } else {
+        return false;
+    }
+    transfers = (bits == 16) ? length : 2U * length;
+    if ((buffer == NULL) || (length == 0U) || ((length % 4U) != 0U) || (transfers > I2S_DMA_MAX)
+            || (sampleRate == 0U)) {
+        return false;
+    }
+    this->dma.periph = (this->spi == SPI1) ? DMA0 : DMA1;
+    this->dma.channel = (this->spi == SPI1) ? (transmit ? DMA_CH4 : DMA_CH3) : (transmit ? DMA_CH1 : DMA_CH0);
+    if (!dma_channel_claim(&this->dma, this)) {
+        return false;
+    }
+    this->direction = direction;
+    this->bits = bits;
+    this->buffer = buffer;
+    this->length = length;
+    this->callback = callback;
+    this->arg = arg;
+
+    /* the first buffer goes out as soon as the clock runs */
+    if (transmit) {
+        if (callback != NULL) {
+            callback(buffer, length / 2, arg);
+            callback((uint8_t *)buffer + (length / 2) * ((bits == 16) ? 2U : 4U), length / 2, arg);
+        }
+        swapHalves(0, length);
+    }
+
+    if (this->spi == SPI2) {
+        afio_cfg_debug_ports(AFIO_DEBUG_SW_ONLY);
+    }
+    pinsInit(true);
+    /* held until end(), the SPI library gates it too once neither uses the SPI */
+    clock_periph_acquire((this->spi == SPI1) ? RCU_SPI1 : RCU_SPI2);
+    spi_i2s_deinit(this->spi);
+    i2s_init(this->spi, modes[direction], this->standard, this->polarity);
+    i2s_psc_config(this->spi, sampleRate, format, this->masterClock ? I2S_MCKOUT_ENABLE : I2S_MCKOUT_DISABLE);
+
+    dma_channel_clock_enable(&this->dma);
+    dma_deinit(DMA_SPL_ARGS(&this->dma));
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.direction    = transmit ? DMA_MEMORY_TO_PERIPHERAL : DMA_PERIPHERAL_TO_MEMORY;
+    dma_init_struct.memory_addr  = (uint32_t)buffer;
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_16BIT;
+    dma_init_struct.number       = transfers;
+    dma_init_struct.periph_addr  = (uint32_t)&SPI_DATA(this->spi);
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_16BIT;
+    dma_init_struct.priority     = DMA_PRIORITY_HIGH;
+    dma_init(DMA_SPL_ARGS(&this->dma), &dma_init_struct);
+    dma_circulation_enable(DMA_SPL_ARGS(&this->dma));
+    dma_memory_to_memory_disable(DMA_SPL_ARGS(&this->dma));
+    if (callback != NULL) {
+        dma_channel_attach_irq(&this->dma, dmaIrq, this, IRQ_LEVEL(IRQ_PRIO_I2S));
+        dma_interrupt_enable(DMA_SPL_ARGS(&this->dma), DMA_INT_HTF);
+        dma_interrupt_enable(DMA_SPL_ARGS(&this->dma), DMA_INT_FTF);
+    }
+    dma_channel_enable(DMA_SPL_ARGS(&this->dma));
+
+    spi_dma_enable(this->spi, transmit ? SPI_DMA_TRANSMIT : SPI_DMA_RECEIVE);
+    i2s_enable(this->spi);
+    this->running = true;
+    return true;
+}
+
+/*!
+    \brief      stop streaming, a buffer sent without callback gets its samples back as they were
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void I2SClass::end(void)
+{
+    bool transmit = (this->direction == I2S_MASTER_TRANSMIT) || (this->direction == I2S_SLAVE_TRANSMIT);
+
+    if (!this->running) {
+        return;
+    }
+    i2s_disable(this->spi);
+    spi_dma_disable(this->spi, transmit ? SPI_DMA_TRANSMIT : SPI_DMA_RECEIVE);
+    dma_channel_disable(DMA_SPL_ARGS(&this->dma));
+    if (this->callback != NULL) {
+        dma_interrupt_disable(DMA_SPL_ARGS(&this->dma), DMA_INT_HTF);
+        dma_interrupt_disable(DMA_SPL_ARGS(&this->dma), DMA_INT_FTF);
+        dma_channel_detach_irq(&this->dma);
+    } else if (transmit) {
+        swapHalves(0, this->length);
+    }
+    dma_channel_release(&this->dma, this);
+    spi_i2s_deinit(this->spi);
+    clock_periph_release((this->spi == SPI1) ? RCU_SPI1 : RCU_SPI2);
+    pinsInit(false);
+    this->callback = NULL;
+    this->running = false;
+}
+
+/*!
+    \brief      check if streaming
+    \param[in]  none
+    \param[out] none
+    \retval     true while streaming
+*/
+bool I2SClass::isRunning(void)
+{
+    return this->running;
+}
+
+/*!
+    \brief      get the sample rate the master clock divider gives, from the system clock
+    \param[in]  none
+    \param[out] none
+    \retval     samples per second and channel, 0 unless running as a master
+*/
+uint32_t I2SClass::sampleRate(void)
+{
+    uint32_t psc, divider, bitClocks;
+
+    if (!this->running || (this->direction == I2S_SLAVE_TRANSMIT) || (this->direction == I2S_SLAVE_RECEIVE)) {
+        return 0;
+    }
+    psc = SPI_I2SPSC(this->spi);
+    divider = 2U * (psc & SPI_I2SPSC_DIV) + ((psc & SPI_I2SPSC_OF) ? 1U : 0U);
+    if (psc & SPI_I2SPSC_MCKOEN) {
+        bitClocks = 256U;
+    } else {
+        bitClocks = (SPI_I2SCTL(this->spi) & SPI_I2SCTL_CHLEN) ? 64U : 32U;
+    }
+    return rcu_clock_freq_get(CK_SYS) / (bitClocks * divider);
+}
+
+/*!
+    \brief      get the buffer index of the next sample the DMA moves
+    \param[in]  none
+    \param[out] none
+    \retval     index into the sample buffer
+*/
+size_t I2SClass::bufferIndex(void)
+{
+    size_t remaining;
+
+    if (!this->running) {
+        return 0;
+    }
+    remaining = dma_transfer_number_get(DMA_SPL_ARGS(&this->dma));
+    if (this->bits != 16) {
+        remaining /= 2U;
+    }
+    return (remaining == 0U) ? 0U : this->length - remaining;
+}
+
+I2SClass I2S1(SPI1);
+I2SClass I2S2(SPI2);
+
+#endif /* GD32F30x || GD32E50X */
@@ -0,0 +1,91 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef I2S_H
+#define I2S_H
+
+#include "Arduino.h"
+
+#if defined(GD32F30x) || defined(GD32E50X)
+
+typedef enum {
+    I2S_MASTER_TRANSMIT = 0,
+    I2S_MASTER_RECEIVE,
+    I2S_SLAVE_TRANSMIT,
+    I2S_SLAVE_RECEIVE
+} i2s_direction_t;
+
+/* buffer points at the half of the sample buffer that was just sent and may be refilled, or
+   that was just received and may be read, count is its number of samples */
+typedef void (*i2sCallback_t)(void *buffer, size_t count, void *arg);
+
+/* Audio on the I2S mode of SPI1 or SPI2, DMA moves the samples between a ring buffer and the
+   bus without interrupts per sample, the callback runs once per half buffer. 16-bit samples
+   are int16_t, 24 and 32-bit samples int32_t (24-bit ones in the upper three bytes), both
+   channels interleaved left first. A master drives CK and WS, and MCK at 256 times the sample
+   rate if enabled; a slave follows them, so a transmitter and a receiver wired to the same
+   CK and WS play and record in step: begin() the slave first, the master starts the clock.
+   Pins WS, CK, SD, MCK: I2S1 PB12, PB13, PB15, PC6; I2S2 PA15, PB3, PB5, PC7 (JTAG is
+   turned off for them, SWD stays) */
+class I2SClass
+{
+    public:
+        I2SClass(uint32_t spi);                                                     //I2SClass object construct
+        ~I2SClass(void);                                                            //stop streaming
+        void setFormat(uint32_t standard, uint32_t polarity = I2S_CKPL_LOW);        //I2S_STD_x, before begin()
+        void setMasterClock(bool enable);                                           //MCK output, before begin()
+        bool begin(i2s_direction_t direction, uint32_t sampleRate, uint8_t bits, void *buffer,
+                   size_t length, i2sCallback_t callback = NULL, void *arg = NULL); //stream buffer over and over
+        void end(void);                                                             //stop streaming
+        bool isRunning(void);                                                       //check if streaming
+        uint32_t sampleRate(void);                                                  //sample rate the master runs at
+        size_t bufferIndex(void);                                                   //index of the next sample
+
+    private:
+        static void dmaIrq(void *arg, uint32_t flags);
+        void swapHalves(size_t first, size_t count);
+        void pinsInit(bool enable);
+        uint32_t spi;
+        uint32_t standard;
+        uint32_t polarity;
+        bool masterClock;
+        i2s_direction_t direction;
+        dma_channel_t dma;
+        void *buffer;
+        size_t length;
+        uint8_t bits;
+        i2sCallback_t callback;
+        void *arg;
+        bool running;
+};
+
+extern I2SClass I2S1;
+extern I2SClass I2S2;
+
+#endif /* GD32F30x || GD32E50X */
+
+#endif /* I2S_H */
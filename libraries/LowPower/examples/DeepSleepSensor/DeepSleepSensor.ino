@@ -0,0 +1,38 @@
+/*
+  Wake up every 10 seconds from deep-sleep, or early when a button is
+  pressed or a character arrives on Serial, take a reading and go back to
+  sleep. The timed wakeup uses the RTC alarm and needs a 32.768 kHz crystal.
+*/
+#include <LowPower.h>
+
+#define BUTTON_PIN PA0
+
+volatile bool buttonPressed = false;
+
+void onButton(void)
+{
+    buttonPressed = true;
+}
+
+void setup()
+{
+    pinMode(LED2, OUTPUT);
+    pinMode(BUTTON_PIN, INPUT_PULLUP);
+    Serial.begin(115200);
+    LowPower.attachInterruptWakeup(BUTTON_PIN, onButton, FALLING);
+    LowPower.enableWakeupFrom(&Serial);
+}
+
+void loop()
+{
+    digitalWrite(LED2, HIGH);
+    Serial.print("A0 = ");
+    Serial.print(analogRead(A0));
+    Serial.println(buttonPressed ? " (button)" : "");
+    buttonPressed = false;
+    digitalWrite(LED2, LOW);
+
+    // what is still in the transmit FIFO would be lost
+    Serial.flush();
+    LowPower.deepSleep(10000);
+}
@@ -0,0 +1 @@
+#erro DO NOTHING,JUST FOR ACCESS LIBRARY EXAMPLES
\ No newline at end of file
@@ -0,0 +1,64 @@
+/*
+  SD card benchmark
+
+  Writes and reads back 4 MB at the end of the card through the SDIO, 32 KB
+  per call, and prints the throughput. It overwrites whatever is stored
+  there, use a card without data you need.
+*/
+
+#include <SDCard.h>
+
+#define CHUNK_BLOCKS    64
+#define TOTAL_BLOCKS    8192
+
+static uint32_t buffer[CHUNK_BLOCKS * SD_BLOCK_SIZE / 4];
+
+void setup()
+{
+    Serial.begin(115200);
+    if (!SDCard.begin()) {
+        Serial.print("no card, error ");
+        Serial.println(SDCard.error());
+        while (1);
+    }
+    Serial.print("blocks: ");
+    Serial.println(SDCard.blockCount());
+    Serial.print("bus clock: ");
+    Serial.println(SDCard.clock());
+
+    uint32_t first = SDCard.blockCount() - TOTAL_BLOCKS;
+    for (uint32_t i = 0; i < sizeof(buffer) / 4; i++) {
+        buffer[i] = i;
+    }
+
+    uint32_t start = micros();
+    for (uint32_t b = 0; b < TOTAL_BLOCKS; b += CHUNK_BLOCKS) {
+        if (!SDCard.writeBlocks(first + b, (const uint8_t *)buffer, CHUNK_BLOCKS)) {
+            Serial.println("write failed");
+            while (1);
+        }
+    }
+    SDCard.sync();
+    report("write", micros() - start);
+
+    start = micros();
+    for (uint32_t b = 0; b < TOTAL_BLOCKS; b += CHUNK_BLOCKS) {
+        if (!SDCard.readBlocks(first + b, (uint8_t *)buffer, CHUNK_BLOCKS)) {
+            Serial.println("read failed");
+            while (1);
+        }
+    }
+    report("read", micros() - start);
+}
+
+void report(const char *what, uint32_t us)
+{
+    Serial.print(what);
+    Serial.print(": ");
+    Serial.print((float)TOTAL_BLOCKS * SD_BLOCK_SIZE / us);
+    Serial.println(" MB/s");
+}
+
+void loop()
+{
+}
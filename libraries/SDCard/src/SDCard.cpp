@@ -0,0 +1,190 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "SDCard.h"
+
+SDCardClass SDCard;
+
+/*!
+    \brief      SDCardClass object construct
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+SDCardClass::SDCardClass(void)
+{
+    this->card.ready = false;
+    this->card.block_count = 0;
+    this->card.clock = 0;
+    this->detectPin = NC;
+    this->lastError = SD_ERROR_NOT_READY;
+}
+
+/*!
+    \brief      power the card up and identify it
+    \param[in]  clock: bus clock in Hz, at most SD_CLOCK_MAX
+    \param[in]  detectPin: card detect switch, low with a card in, NC for none
+    \param[out] none
+    \retval     false if there is no usable card, error() tells why
+*/
+bool SDCardClass::begin(uint32_t clock, uint32_t detectPin)
+{
+#if defined(SD_CARD_SDIO)
+    this->detectPin = detectPin;
+    if (this->detectPin != (uint32_t)NC) {
+        pinMode(this->detectPin, INPUT_PULLUP);
+    }
+    if (!isPresent()) {
+        this->lastError = SD_ERROR_NO_CARD;
+        return false;
+    }
+    this->lastError = sd_card_init(&this->card, clock);
+    return this->lastError == SD_OK;
+#else
+    (void)clock;
+    (void)detectPin;
+    this->lastError = SD_ERROR_UNSUPPORTED;
+    return false;
+#endif
+}
+
+/*!
+    \brief      power the card off and release the pins
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void SDCardClass::end(void)
+{
+#if defined(SD_CARD_SDIO)
+    if (this->card.ready) {
+        sd_card_sync(&this->card);
+        sd_card_deinit(&this->card);
+    }
+#endif
+    this->lastError = SD_ERROR_NOT_READY;
+}
+
+/*!
+    \brief      check the card detect pin
+    \param[in]  none
+    \param[out] none
+    \retval     true if a card is in, or there is no detect pin
+*/
+bool SDCardClass::isPresent(void)
+{
+    return (this->detectPin == (uint32_t)NC) || (digitalRead(this->detectPin) == LOW);
+}
+
+/*!
+    \brief      read blocks
+    \param[in]  block: first block
+    \param[in]  count: number of blocks
+    \param[out] buffer: count * blockSize() bytes, word aligned ones are read in place by DMA
+    \retval     false on failure, error() tells why
+*/
+bool SDCardClass::readBlocks(uint32_t block, uint8_t *buffer, uint32_t count)
+{
+#if defined(SD_CARD_SDIO)
+    this->lastError = sd_card_read(&this->card, block, buffer, count);
+#endif
+    return this->lastError == SD_OK;
+}
+
+/*!
+    \brief      write blocks, the card goes on programming them after the call returns
+    \param[in]  block: first block
+    \param[in]  buffer: count * blockSize() bytes, word aligned ones are written in place by DMA
+    \param[in]  count: number of blocks
+    \param[out] none
+    \retval     false on failure, error() tells why
+*/
+bool SDCardClass::writeBlocks(uint32_t block, const uint8_t *buffer, uint32_t count)
+{
+#if defined(SD_CARD_SDIO)
+    this->lastError = sd_card_write(&this->card, block, buffer, count);
+#endif
+    return this->lastError == SD_OK;
+}
+
+/*!
+    \brief      wait until the card has programmed all blocks written
+    \param[in]  none
+    \param[out] none
+    \retval     false on failure, error() tells why
+*/
+bool SDCardClass::sync(void)
+{
+#if defined(SD_CARD_SDIO)
+    this->lastError = sd_card_sync(&this->card);
+#endif
+    return this->lastError == SD_OK;
+}
+
+/*!
+    \brief      get the card size
+    \param[in]  none
+    \param[out] none
+    \retval     number of blocks, 0 without a card
+*/
+uint32_t SDCardClass::blockCount(void)
+{
+    return this->card.ready ? this->card.block_count : 0U;
+}
+
+/*!
+    \brief      get the block size
+    \param[in]  none
+    \param[out] none
+    \retval     SD_BLOCK_SIZE
+*/
+uint16_t SDCardClass::blockSize(void)
+{
+    return SD_BLOCK_SIZE;
+}
+
+/*!
+    \brief      get the bus clock
+    \param[in]  none
+    \param[out] none
+    \retval     clock in Hz, 0 without a card
+*/
+uint32_t SDCardClass::clock(void)
+{
+    return this->card.ready ? this->card.clock : 0U;
+}
+
+/*!
+    \brief      get the result of the last call
+    \param[in]  none
+    \param[out] none
+    \retval     SD_OK or the error
+*/
+sd_error_t SDCardClass::error(void)
+{
+    return this->lastError;
+}
@@ -0,0 +1,62 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef SDCARD_H
+#define SDCARD_H
+
+#include "Arduino.h"
+extern "C" {
+#include "utility/sd_card.h"
+}
+
+/* Block device on an SD card at the SDIO, 4-bit bus and DMA multi-block transfers. The
+   block functions fit USBMSC and the disk layer of FAT libraries as they are. GD32F30x and
+   GD32E50x high and extra density parts, see sd_card.h for the pins */
+class SDCardClass
+{
+    public:
+        SDCardClass(void);                                                        //SDCardClass object construct
+        bool begin(uint32_t clock = SD_CLOCK_MAX, uint32_t detectPin = NC);       //identify the card
+        void end(void);                                                           //power the card off
+        bool isPresent(void);                                                     //check the card detect pin
+        bool readBlocks(uint32_t block, uint8_t *buffer, uint32_t count);         //read blocks
+        bool writeBlocks(uint32_t block, const uint8_t *buffer, uint32_t count);  //write blocks
+        bool sync(void);                                                          //wait for writes to be programmed
+        uint32_t blockCount(void);                                                //card size in blocks
+        uint16_t blockSize(void);                                                 //bytes per block
+        uint32_t clock(void);                                                     //bus clock in Hz
+        sd_error_t error(void);                                                   //result of the last call
+
+    private:
+        sd_card_t card;
+        uint32_t detectPin;
+        sd_error_t lastError;
+};
+
+extern SDCardClass SDCard;
+
+#endif /* SDCARD_H */
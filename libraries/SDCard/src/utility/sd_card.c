@@ -0,0 +1,491 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+#include "sd_card.h"
+#include "PinNames.h"
+#include "pinmap.h"
+#include "systick.h"
+#include "os_event.h"
+
+#if defined(SD_CARD_SDIO)
+
+#define SD_INIT_CLOCK           400000U
+#define SD_POWER_UP_MS          2U
+#define SD_OP_COND_TIMEOUT_MS   1000U
+#define SD_BUSY_TIMEOUT_MS      500U
+/* read and write data timeout, in ms */
+#define SD_DATA_TIMEOUT_MS      500U
+
+#define SD_CMD_GO_IDLE_STATE        0U
+#define SD_CMD_ALL_SEND_CID         2U
+#define SD_CMD_SEND_RELATIVE_ADDR   3U
+#define SD_CMD_SELECT_CARD          7U
+#define SD_CMD_SEND_IF_COND         8U
+#define SD_CMD_SEND_CSD             9U
+#define SD_CMD_STOP_TRANSMISSION    12U
+#define SD_CMD_SEND_STATUS          13U
+#define SD_CMD_SET_BLOCKLEN         16U
+#define SD_CMD_READ_SINGLE_BLOCK    17U
+#define SD_CMD_READ_MULTIPLE_BLOCK  18U
+#define SD_CMD_WRITE_BLOCK          24U
+#define SD_CMD_WRITE_MULTIPLE_BLOCK 25U
+#define SD_CMD_APP_CMD              55U
+#define SD_ACMD_SET_BUS_WIDTH       6U
+#define SD_ACMD_SET_WR_BLK_ERASE_COUNT 23U
+#define SD_ACMD_SD_SEND_OP_COND     41U
+
+#define SD_IF_COND_PATTERN      0x1AAU          /* 2.7-3.6 V, check pattern 0xAA */
+#define SD_OCR_VOLTAGE          0x00FF8000U     /* 2.7-3.6 V */
+#define SD_OCR_HCS              0x40000000U
+#define SD_OCR_BUSY             0x80000000U
+#define SD_R1_ERRORS            0xFDFFE008U
+#define SD_R1_READY_FOR_DATA    0x00000100U
+#define SD_R1_STATE(r)          (((r) >> 9) & 0x0FU)
+#define SD_STATE_TRAN           4U
+
+#define SD_CMD_FLAGS            (SDIO_FLAG_CCRCERR | SDIO_FLAG_CMDTMOUT | SDIO_FLAG_CMDRECV | SDIO_FLAG_CMDSEND)
+#define SD_DATA_ERROR_FLAGS     (SDIO_FLAG_DTCRCERR | SDIO_FLAG_DTTMOUT | SDIO_FLAG_TXURE | SDIO_FLAG_RXORE | \
+                                 SDIO_FLAG_STBITE)
+#define SD_DATA_FLAGS           (SD_DATA_ERROR_FLAGS | SDIO_FLAG_DTEND | SDIO_FLAG_DTBLKEND)
+
+static const PinName sd_card_pins[] = {PORTC_8, PORTC_9, PORTC_10, PORTC_11, PORTC_12, PORTD_2};
+
+/* for buffers the DMA can't take in place */
+static uint32_t sd_card_bounce[SD_BLOCK_SIZE / 4U];
+
+/* divider field for a bus clock of at most clock, SDIO_CLK = HCLK / (div + 2) */
+static uint16_t sd_clock_division(uint32_t clock)
+{
+    uint32_t hclk = rcu_clock_freq_get(CK_AHB);
+    uint32_t div = (hclk + clock - 1U) / clock;
+
+    if (div <= 2U) {
+        return 0U;
+    }
+    return (div - 2U > 511U) ? 511U : (uint16_t)(div - 2U);
+}
+
+static void sd_set_clock(sd_card_t *card, uint32_t clock)
+{
+    uint16_t div = sd_clock_division(clock);
+
+    sdio_clock_config(SDIO_SDIOCLKEDGE_RISING, SDIO_CLOCKBYPASS_DISABLE, SDIO_CLOCKPWRSAVE_DISABLE, div);
+    card->clock = rcu_clock_freq_get(CK_AHB) / (div + 2U);
+    card->data_timeout = card->clock / 1000U * SD_DATA_TIMEOUT_MS;
+}
+
+static sd_error_t sd_command(uint32_t index, uint32_t argument, uint32_t response)
+{
+    uint32_t flags;
+
+    sdio_flag_clear(SD_CMD_FLAGS);
+    sdio_command_response_config(index, argument, response);
+    sdio_wait_type_set(SDIO_WAITTYPE_NO);
+    sdio_csm_enable();
+    /* the SDIO gives up on a response after 64 bus clocks */
+    if (response == SDIO_RESPONSETYPE_NO) {
+        while (RESET == sdio_flag_get(SDIO_FLAG_CMDSEND)) {
+        }
+        sdio_flag_clear(SD_CMD_FLAGS);
+        return SD_OK;
+    }
+    do {
+        flags = SDIO_STAT;
+    } while ((flags & (SDIO_FLAG_CMDRECV | SDIO_FLAG_CCRCERR | SDIO_FLAG_CMDTMOUT)) == 0U);
+    sdio_flag_clear(SD_CMD_FLAGS);
+    if (flags & SDIO_FLAG_CMDTMOUT) {
+        return SD_ERROR_CMD_TIMEOUT;
+    }
+    if (flags & SDIO_FLAG_CCRCERR) {
+        return SD_ERROR_CMD_CRC;
+    }
+    return SD_OK;
+}
+
+/* command with an R1 or R1b response, *status gets the card status if not NULL */
+static sd_error_t sd_command_r1(uint32_t index, uint32_t argument, uint32_t *status)
+{
+    sd_error_t err = sd_command(index, argument, SDIO_RESPONSETYPE_SHORT);
+    uint32_t r1;
+
+    if (err != SD_OK) {
+        return err;
+    }
+    if (sdio_command_index_get() != index) {
+        return SD_ERROR_CMD_CRC;
+    }
+    r1 = sdio_response_get(SDIO_RESPONSE0);
+    if (status != NULL) {
+        *status = r1;
+    }
+    return (r1 & SD_R1_ERRORS) ? SD_ERROR_CARD_STATUS : SD_OK;
+}
+
+static sd_error_t sd_app_command_r1(sd_card_t *card, uint32_t index, uint32_t argument)
+{
+    sd_error_t err = sd_command_r1(SD_CMD_APP_CMD, card->rca << 16, NULL);
+
+    if (err != SD_OK) {
+        return err;
+    }
+    return sd_command_r1(index, argument, NULL);
+}
+
+/* wait for the card to finish programming and be back in the transfer state */
+static sd_error_t sd_wait_ready(sd_card_t *card)
+{
+    uint32_t start = getCurrentMillis();
+    uint32_t status;
+    sd_error_t err;
+
+    do {
+        err = sd_command_r1(SD_CMD_SEND_STATUS, card->rca << 16, &status);
+        if (err != SD_OK) {
+            return err;
+        }
+        if ((status & SD_R1_READY_FOR_DATA) && (SD_R1_STATE(status) == SD_STATE_TRAN)) {
+            return SD_OK;
+        }
+        /* programming takes milliseconds, let others run meanwhile */
+        os_event_wait();
+    } while ((getCurrentMillis() - start) < SD_BUSY_TIMEOUT_MS);
+    return SD_ERROR_BUSY_TIMEOUT;
+}
+
+/* number of 512-byte blocks from the CSD, version 1 (SDSC) or 2 (SDHC/SDXC) */
+static uint32_t sd_csd_blocks(const uint32_t *csd)
+{
+    uint32_t c_size, mult, read_bl_len;
+
+    if ((csd[0] >> 30) == 1U) {
+        c_size = ((csd[1] & 0x3FU) << 16) | (csd[2] >> 16);
+        return (c_size + 1U) << 10;
+    }
+    read_bl_len = (csd[1] >> 16) & 0x0FU;
+    c_size = ((csd[1] & 0x3FFU) << 2) | (csd[2] >> 30);
+    mult = (csd[2] >> 15) & 0x07U;
+    return (c_size + 1U) << (mult + 2U + read_bl_len - 9U);
+}
+
+static void sd_long_response(uint32_t *out)
+{
+    out[0] = sdio_response_get(SDIO_RESPONSE0);
+    out[1] = sdio_response_get(SDIO_RESPONSE1);
+    out[2] = sdio_response_get(SDIO_RESPONSE2);
+    out[3] = sdio_response_get(SDIO_RESPONSE3);
+}
+
+/* from idle to the transfer state, 4-bit bus */
+static sd_error_t sd_identify(sd_card_t *card)
+{
+    uint32_t start, ocr, argument = SD_OCR_VOLTAGE;
+    sd_error_t err;
+
+    sd_command(SD_CMD_GO_IDLE_STATE, 0U, SDIO_RESPONSETYPE_NO);
+    /* version 2 cards answer, they may be high capacity */
+    err = sd_command(SD_CMD_SEND_IF_COND, SD_IF_COND_PATTERN, SDIO_RESPONSETYPE_SHORT);
+    if (err == SD_OK) {
+        if ((sdio_response_get(SDIO_RESPONSE0) & 0xFFFU) != SD_IF_COND_PATTERN) {
+            return SD_ERROR_UNSUPPORTED;
+        }
+        argument |= SD_OCR_HCS;
+    } else if (err != SD_ERROR_CMD_TIMEOUT) {
+        return err;
+    }
+
+    start = getCurrentMillis();
+    do {
+        err = sd_command_r1(SD_CMD_APP_CMD, 0U, NULL);
+        if (err != SD_OK) {
+            return (err == SD_ERROR_CMD_TIMEOUT) ? SD_ERROR_NO_CARD : err;
+        }
+        /* the R3 response has no CRC */
+        err = sd_command(SD_ACMD_SD_SEND_OP_COND, argument, SDIO_RESPONSETYPE_SHORT);
+        if ((err != SD_OK) && (err != SD_ERROR_CMD_CRC)) {
+            return SD_ERROR_UNSUPPORTED;
+        }
+        ocr = sdio_response_get(SDIO_RESPONSE0);
+        if (ocr & SD_OCR_BUSY) {
+            break;
+        }
+        os_event_wait();
+    } while ((getCurrentMillis() - start) < SD_OP_COND_TIMEOUT_MS);
+    if (!(ocr & SD_OCR_BUSY)) {
+        return SD_ERROR_UNSUPPORTED;
+    }
+    card->high_capacity = (ocr & SD_OCR_HCS) != 0U;
+
+    err = sd_command(SD_CMD_ALL_SEND_CID, 0U, SDIO_RESPONSETYPE_LONG);
+    if (err != SD_OK) {
+        return err;
+    }
+    sd_long_response(card->cid);
+    err = sd_command(SD_CMD_SEND_RELATIVE_ADDR, 0U, SDIO_RESPONSETYPE_SHORT);
+    if (err != SD_OK) {
+        return err;
+    }
+    card->rca = sdio_response_get(SDIO_RESPONSE0) >> 16;
+    err = sd_command(SD_CMD_SEND_CSD, card->rca << 16, SDIO_RESPONSETYPE_LONG);
+    if (err != SD_OK) {
+        return err;
+    }
+    sd_long_response(card->csd);
+    card->block_count = sd_csd_blocks(card->csd);
+
+    err = sd_command_r1(SD_CMD_SELECT_CARD, card->rca << 16, NULL);
+    if ((err == SD_OK) && !card->high_capacity) {
+        err = sd_command_r1(SD_CMD_SET_BLOCKLEN, SD_BLOCK_SIZE, NULL);
+    }
+    if (err == SD_OK) {
+        err = sd_app_command_r1(card, SD_ACMD_SET_BUS_WIDTH, 2U);
+    }
+    return err;
+}
+
+/*!
+    \brief      power the card up, identify it and switch to the 4-bit bus
+    \param[in]  card: card state
+    \param[in]  clock: bus clock in Hz, at most SD_CLOCK_MAX, the divider of HCLK picks the next lower one
+    \param[out] none
+    \retval     SD_OK, or why the card can't be used
+*/
+sd_error_t sd_card_init(sd_card_t *card, uint32_t clock)
+{
+    uint32_t start;
+    uint8_t i;
+    sd_error_t err;
+
+    memset(card, 0, sizeof(*card));
+    card->dma.periph = DMA1;
+    card->dma.channel = DMA_CH3;
+
+    for (i = 0U; i < sizeof(sd_card_pins) / sizeof(sd_card_pins[0]); i++) {
+        pin_function(sd_card_pins[i], GD_PIN_FUNCTION1(PIN_MODE_AF_PP, 0));
+    }
+    rcu_periph_clock_enable(RCU_SDIO);
+    sdio_deinit();
+    sd_set_clock(card, SD_INIT_CLOCK);
+    sdio_bus_mode_set(SDIO_BUSMODE_1BIT);
+    sdio_hardware_clock_disable();
+    sdio_power_state_set(SDIO_POWER_ON);
+    sdio_clock_enable();
+    /* at least 74 clocks before the first command */
+    start = getCurrentMillis();
+    while ((getCurrentMillis() - start) < SD_POWER_UP_MS) {
+    }
+
+    err = sd_identify(card);
+    if (err != SD_OK) {
+        sd_card_deinit(card);
+        return err;
+    }
+    sdio_bus_mode_set(SDIO_BUSMODE_4BIT);
+    sd_set_clock(card, (clock > SD_CLOCK_MAX) ? SD_CLOCK_MAX : clock);
+    card->ready = true;
+    return SD_OK;
+}
+
+/*!
+    \brief      power the SDIO off and release the pins
+    \param[in]  card: card state
+    \param[out] none
+    \retval     none
+*/
+void sd_card_deinit(sd_card_t *card)
+{
+    uint8_t i;
+
+    card->ready = false;
+    sdio_clock_disable();
+    sdio_power_state_set(SDIO_POWER_OFF);
+    sdio_deinit();
+    rcu_periph_clock_disable(RCU_SDIO);
+    for (i = 0U; i < sizeof(sd_card_pins) / sizeof(sd_card_pins[0]); i++) {
+        pin_function(sd_card_pins[i], GD_PIN_FUNCTION1(PIN_MODE_IN_FLOATING, 0));
+    }
+}
+
+static void sd_dma_start(sd_card_t *card, void *buffer, uint32_t count, bool write)
+{
+    dma_parameter_struct dma_init_struct;
+
+    dma_deinit(DMA_SPL_ARGS(&card->dma));
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.direction    = write ? DMA_MEMORY_TO_PERIPHERAL : DMA_PERIPHERAL_TO_MEMORY;
+    dma_init_struct.memory_addr  = (uint32_t)buffer;
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_32BIT;
+    dma_init_struct.number       = count * (SD_BLOCK_SIZE / 4U);
+    dma_init_struct.periph_addr  = (uint32_t)&SDIO_FIFO;
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_32BIT;
+    dma_init_struct.priority     = DMA_PRIORITY_ULTRA_HIGH;
+    dma_init(DMA_SPL_ARGS(&card->dma), &dma_init_struct);
+    dma_circulation_disable(DMA_SPL_ARGS(&card->dma));
+    dma_memory_to_memory_disable(DMA_SPL_ARGS(&card->dma));
+    dma_channel_enable(DMA_SPL_ARGS(&card->dma));
+}
+
+/* one multi-block transfer, buffer aligned to 4 bytes, count up to SD_TRANSFER_MAX_BLOCKS */
+static sd_error_t sd_transfer(sd_card_t *card, uint32_t block, void *buffer, uint32_t count, bool write)
+{
+    uint32_t address = card->high_capacity ? block : block * SD_BLOCK_SIZE;
+    uint32_t flags;
+    sd_error_t err;
+
+    err = sd_wait_ready(card);
+    if (err != SD_OK) {
+        return err;
+    }
+    if (!dma_channel_claim(&card->dma, card)) {
+        return SD_ERROR_DMA_BUSY;
+    }
+    dma_channel_clock_enable(&card->dma);
+    sd_dma_start(card, buffer, count, write);
+    sdio_flag_clear(SD_DATA_FLAGS);
+    sdio_data_config(card->data_timeout, count * SD_BLOCK_SIZE, SDIO_DATABLOCKSIZE_512BYTES);
+
+    if (write) {
+        /* lets the card erase ahead, which speeds multi-block writes up */
+        if (count > 1U) {
+            sd_app_command_r1(card, SD_ACMD_SET_WR_BLK_ERASE_COUNT, count);
+        }
+        err = sd_command_r1((count > 1U) ? SD_CMD_WRITE_MULTIPLE_BLOCK : SD_CMD_WRITE_BLOCK, address, NULL);
+        sdio_data_transfer_config(SDIO_TRANSMODE_BLOCK, SDIO_TRANSDIRECTION_TOCARD);
+    } else {
+        sdio_data_transfer_config(SDIO_TRANSMODE_BLOCK, SDIO_TRANSDIRECTION_TOSDIO);
+    }
+    if (err == SD_OK) {
+        sdio_dma_enable();
+        sdio_dsm_enable();
+        if (!write) {
+            err = sd_command_r1((count > 1U) ? SD_CMD_READ_MULTIPLE_BLOCK : SD_CMD_READ_SINGLE_BLOCK, address, NULL);
+        }
+    }
+    if (err == SD_OK) {
+        /* bounded by the data timeout of the SDIO */
+        do {
+            flags = SDIO_STAT;
+        } while ((flags & (SD_DATA_ERROR_FLAGS | SDIO_FLAG_DTEND)) == 0U);
+        if (flags & SDIO_FLAG_DTTMOUT) {
+            err = SD_ERROR_DATA_TIMEOUT;
+        } else if (flags & SDIO_FLAG_DTCRCERR) {
+            err = SD_ERROR_DATA_CRC;
+        } else if (flags & SD_DATA_ERROR_FLAGS) {
+            err = SD_ERROR_FIFO;
+        } else if (!write) {
+            /* the last words may still be on their way out of the FIFO */
+            while (RESET == dma_flag_get(DMA_SPL_ARGS(&card->dma), DMA_FLAG_FTF)) {
+            }
+        }
+        if (count > 1U) {
+            sd_command_r1(SD_CMD_STOP_TRANSMISSION, 0U, NULL);
+        }
+    }
+    sdio_dsm_disable();
+    sdio_dma_disable();
+    sdio_flag_clear(SD_DATA_FLAGS);
+    dma_channel_disable(DMA_SPL_ARGS(&card->dma));
+    dma_channel_release(&card->dma, card);
+    return err;
+}
+
+static sd_error_t sd_access(sd_card_t *card, uint32_t block, uint8_t *buffer, uint32_t count, bool write)
+{
+    uint32_t n;
+    sd_error_t err = SD_OK;
+
+    if (!card->ready) {
+        return SD_ERROR_NOT_READY;
+    }
+    if ((block >= card->block_count) || (count > card->block_count - block)) {
+        return SD_ERROR_RANGE;
+    }
+    while ((count > 0U) && (err == SD_OK)) {
+        if (((uint32_t)buffer & 3U) == 0U) {
+            n = (count > SD_TRANSFER_MAX_BLOCKS) ? SD_TRANSFER_MAX_BLOCKS : count;
+            err = sd_transfer(card, block, buffer, n, write);
+        } else {
+            n = 1U;
+            if (write) {
+                memcpy(sd_card_bounce, buffer, SD_BLOCK_SIZE);
+            }
+            err = sd_transfer(card, block, sd_card_bounce, 1U, write);
+            if (!write) {
+                memcpy(buffer, sd_card_bounce, SD_BLOCK_SIZE);
+            }
+        }
+        block += n;
+        buffer += n * SD_BLOCK_SIZE;
+        count -= n;
+    }
+    return err;
+}
+
+/*!
+    \brief      read blocks
+    \param[in]  card: card state
+    \param[in]  block: first block
+    \param[in]  count: number of blocks
+    \param[out] buffer: count * SD_BLOCK_SIZE bytes
+    \retval     SD_OK or the error
+*/
+sd_error_t sd_card_read(sd_card_t *card, uint32_t block, void *buffer, uint32_t count)
+{
+    return sd_access(card, block, (uint8_t *)buffer, count, false);
+}
+
+/*!
+    \brief      write blocks, the card goes on programming them after the call returns
+    \param[in]  card: card state
+    \param[in]  block: first block
+    \param[in]  buffer: count * SD_BLOCK_SIZE bytes
+    \param[in]  count: number of blocks
+    \param[out] none
+    \retval     SD_OK or the error
+*/
+sd_error_t sd_card_write(sd_card_t *card, uint32_t block, const void *buffer, uint32_t count)
+{
+    return sd_access(card, block, (uint8_t *)buffer, count, true);
+}
+
+/*!
+    \brief      wait until the card has programmed everything written
+    \param[in]  card: card state
+    \param[out] none
+    \retval     SD_OK or the error
+*/
+sd_error_t sd_card_sync(sd_card_t *card)
+{
+    if (!card->ready) {
+        return SD_ERROR_NOT_READY;
+    }
+    return sd_wait_ready(card);
+}
+
+#endif /* SD_CARD_SDIO */
@@ -0,0 +1,99 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef __SD_CARD_H
+#define __SD_CARD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gd32xxyy.h"
+#include "dma.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(GD32F30X_HD) || defined(GD32F30X_XD) || defined(GD32E50X_HD) || defined(GD32E50X_XD)
+#define SD_CARD_SDIO            1
+#endif
+
+#define SD_BLOCK_SIZE           512U
+/* default speed bus clock, the highest a card takes without switching to high speed */
+#define SD_CLOCK_MAX            25000000U
+
+typedef enum {
+    SD_OK = 0,
+    SD_ERROR_NO_CARD,                           /* no answer to the first commands */
+    SD_ERROR_UNSUPPORTED,                       /* not an SD memory card, or a voltage it can't take */
+    SD_ERROR_CMD_TIMEOUT,
+    SD_ERROR_CMD_CRC,
+    SD_ERROR_CARD_STATUS,                       /* the card flagged an error in its status */
+    SD_ERROR_DATA_TIMEOUT,
+    SD_ERROR_DATA_CRC,
+    SD_ERROR_FIFO,                              /* the DMA didn't keep up with the bus */
+    SD_ERROR_BUSY_TIMEOUT,                      /* the card didn't come back to the transfer state */
+    SD_ERROR_DMA_BUSY,                          /* another driver holds the SDIO DMA channel */
+    SD_ERROR_RANGE,
+    SD_ERROR_NOT_READY                          /* sd_card_init() didn't succeed */
+} sd_error_t;
+
+/*
+ * SD memory card on the SDIO, 4-bit bus, data moved by DMA1 channel 3 in
+ * multi-block transfers of up to SD_TRANSFER_MAX_BLOCKS. The pins are fixed:
+ * PC8-PC11 data, PC12 clock, PD2 command, each with a pull-up on the board.
+ *
+ * A write returns once the data is on the card, the card then programs it
+ * while the CPU goes on; the next command waits for it, or sd_card_sync().
+ * Buffers not aligned to 4 bytes go through a bounce buffer one block at a
+ * time, aligned ones are transferred in place.
+ */
+typedef struct {
+    bool ready;
+    bool high_capacity;                         /* SDHC/SDXC, addressed in blocks rather than bytes */
+    uint32_t rca;                               /* relative card address */
+    uint32_t block_count;
+    uint32_t clock;                             /* bus clock in Hz */
+    uint32_t data_timeout;                      /* in bus clock periods */
+    uint32_t cid[4];
+    uint32_t csd[4];
+    dma_channel_t dma;
+} sd_card_t;
+
+/* most blocks one DMA transfer moves */
+#define SD_TRANSFER_MAX_BLOCKS  511U
+
+sd_error_t sd_card_init(sd_card_t *card, uint32_t clock);
+void sd_card_deinit(sd_card_t *card);
+sd_error_t sd_card_read(sd_card_t *card, uint32_t block, void *buffer, uint32_t count);
+sd_error_t sd_card_write(sd_card_t *card, uint32_t block, const void *buffer, uint32_t count);
+sd_error_t sd_card_sync(sd_card_t *card);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_CARD_H */
@@ -0,0 +1,34 @@
+// a second SPI master on USART1 in synchronous mode: PA2 MOSI, PA3 MISO, PA4 SCK
+// connect PA2 to PA3 to read back what is sent
+#include <USARTSPI.h>
+
+#define arraysize         64
+
+USARTSPIClass USARTSPI(PORTA_2, PORTA_3, PORTA_4);
+
+uint8_t send_array[arraysize];
+uint8_t receive_array[arraysize];
+
+void setup()
+{
+    Serial.begin(115200);
+
+    for (uint8_t n = 0; n < arraysize; n++) {
+        send_array[n] = n * 3;
+    }
+    if (!USARTSPI.begin()) {
+        Serial.println("PA2/PA3/PA4 are not TX/RX/CK of one USART");
+        return;
+    }
+    USARTSPI.beginTransaction(SPISettings(2000000, MSBFIRST, SPI_MODE0));
+    // a block goes by DMA, the call returns once the last byte is in
+    USARTSPI.transfer(send_array, receive_array, arraysize);
+    USARTSPI.endTransaction();
+
+    Serial.println(memcmp(send_array, receive_array, arraysize) == 0 ? "loopback ok" : "loopback failed");
+}
+
+void loop()
+{
+
+}
@@ -35,6 +35,13 @@ SPIClass::SPIClass(void)
     _spi.pin_sclk = DIGITAL_TO_PINNAME(SCK);
     _spi.pin_ssel = NC;
 
+    _spi.pin_io2 = NC;
+    _spi.pin_io3 = NC;
+    _spi.async_head = NULL;
+    _spi.async_tail = NULL;
+    _spi.async_count = 0;
+    _spi.slave_len = 0;
+
     initialized = false;
 }
 
@@ -45,6 +52,13 @@ SPIClass::SPIClass(PinName mosi, PinName miso, PinName sclk, PinName ssel)
     _spi.pin_sclk = sclk;
     _spi.pin_ssel = ssel;
 
+    _spi.pin_io2 = NC;
+    _spi.pin_io3 = NC;
+    _spi.async_head = NULL;
+    _spi.async_tail = NULL;
+    _spi.async_count = 0;
+    _spi.slave_len = 0;
+
     initialized = false;
 }
 
@@ -55,6 +69,13 @@ SPIClass::SPIClass(PinName mosi, PinName miso, PinName sclk)
     _spi.pin_sclk = sclk;
     _spi.pin_ssel = NC;
 
+    _spi.pin_io2 = NC;
+    _spi.pin_io3 = NC;
+    _spi.async_head = NULL;
+    _spi.async_tail = NULL;
+    _spi.async_count = 0;
+    _spi.slave_len = 0;
+
     initialized = false;
 }
 
@@ -65,7 +86,7 @@ void SPIClass::begin()
         return;
     }
 
-    spi_begin(&_spi, spisettings.speed, spisettings.datamode, spisettings.bitorder);
+    applySettings();
 
     initialized = true;
 }
@@ -80,19 +101,23 @@ void SPIClass::end()
 
 void SPIClass::beginTransaction(SPISettings settings)
 {
-    config(settings);
-
-    spi_begin(&_spi, spisettings.speed, spisettings.datamode, spisettings.bitorder);
-
-    initialized = true;
+    if (!initialized) {
+        config(settings);
+        applySettings();
+        initialized = true;
+    } else if (settings != spisettings || clockGeneration != clock_generation()) {
+        /* only the format changes between transactions, the pins and clock stay as they are;
+         * the prescaler is recomputed too when the system clock was switched since */
+        config(settings);
+        applySettings();
+    } else if (spisettings.crcpolynomial != 0) {
+        spi_master_crc_reset(&_spi);
+    }
 }
 
 void SPIClass::endTransaction(void)
 {
-    if (initialized) {
-        spi_free(&_spi);
-        initialized = false;
-    }
+    /* the peripheral stays set up for the next transaction, end() releases it */
 }
 
 uint8_t SPIClass::transfer(uint8_t val8)
@@ -106,24 +131,17 @@ uint8_t SPIClass::transfer(uint8_t val8)
 uint16_t SPIClass::transfer16(uint16_t val16)
 {
     uint16_t out_halfword;
-    uint8_t trans_data0, trans_data1, rec_data0, rec_data1;
-
-    trans_data0 = uint8_t(val16 & 0x00FF);
-    trans_data1 = uint8_t((val16 & 0xFF00) >> 8);
 
-    if (spisettings.bitorder == LSBFIRST) {
-        rec_data0 = transfer(trans_data0);
-        rec_data1 = transfer(trans_data1);
-        out_halfword = uint16_t(rec_data0 | (rec_data1 << 8));
-    } else {
-        rec_data0 = transfer(trans_data1);
-        rec_data1 = transfer(trans_data0);
-        out_halfword = uint16_t(rec_data1 | (rec_data0 << 8));
-    }
+    spi_master_block_write16(&_spi, &val16, &out_halfword, 1);
 
     return out_halfword;
 }
 
+void SPIClass::transfer16(uint16_t *buf, size_t count)
+{
+    spi_master_block_write16(&_spi, buf, buf, count);
+}
+
 void SPIClass::transfer(void *buf, size_t count)
 {
     spi_master_block_write(&_spi, ((uint8_t *)buf), ((uint8_t *)buf), count);
@@ -134,16 +152,67 @@ void SPIClass::transfer(void *bufout, void *bufin, size_t count)
     spi_master_block_write(&_spi, ((uint8_t *)bufout), ((uint8_t *)bufin), count);
 }
 
+/* transmit only, the received bytes are thrown away */
+void SPIClass::transmit(const void *buf, size_t count)
+{
+    spi_master_block_write(&_spi, ((const uint8_t *)buf), NULL, count);
+}
+
+bool SPIClass::transferAsync(const void *bufout, void *bufin, size_t count, SPIAsyncCallback callback, void *arg)
+{
+    spi_async_t xfer;
+
+    xfer.tx_buffer = (const uint8_t *)bufout;
+    xfer.rx_buffer = (uint8_t *)bufin;
+    xfer.len = count;
+    xfer.format = SPI_FORMAT_INVALID;
+    xfer.cs_port = 0;
+    xfer.cs_mask = 0;
+    xfer.callback = callback;
+    xfer.arg = arg;
+
+    return spi_master_async_transfer(&_spi, &xfer) != 0;
+}
+
+bool SPIClass::transferAsync(SPISettings settings, pin_size_t cs, const void *bufout, void *bufin, size_t count,
+                             SPIAsyncCallback callback, void *arg)
+{
+    spi_async_t xfer;
+
+    xfer.tx_buffer = (const uint8_t *)bufout;
+    xfer.rx_buffer = (uint8_t *)bufin;
+    xfer.len = count;
+    xfer.format = spi_format_get(&_spi, settings.speed, settings.datamode, settings.bitorder);
+    xfer.cs_port = 0;
+    xfer.cs_mask = 0;
+    if (DIGITAL_PIN_VALID(cs)) {
+        /* idle high before it becomes an output */
+        digitalWrite(cs, HIGH);
+        pinMode(cs, OUTPUT);
+        xfer.cs_port = DIGITAL_PIN_TO_PORT(cs);
+        xfer.cs_mask = DIGITAL_PIN_TO_BIT_MASK(cs);
+    }
+    xfer.callback = callback;
+    xfer.arg = arg;
+
+    return spi_master_async_transfer(&_spi, &xfer) != 0;
+}
+
+uint32_t SPIClass::asyncPending(void)
+{
+    return spi_master_async_pending(&_spi);
+}
+
 void SPIClass::setBitOrder(BitOrder order)
 {
     spisettings.bitorder = order;
-    spi_begin(&_spi, spisettings.speed, spisettings.datamode, spisettings.bitorder);
+    applySettings();
 }
 
 void SPIClass::setDataMode(uint8_t mode)
 {
     spisettings.datamode = mode;
-    spi_begin(&_spi, spisettings.speed, spisettings.datamode, spisettings.bitorder);
+    applySettings();
 }
 
 void SPIClass::setClockDivider(uint32_t divider)
@@ -155,7 +224,7 @@ void SPIClass::setClockDivider(uint32_t divider)
         spisettings.speed = dev_spi_clock_source_frequency_get(&_spi) / divider;
     }
 
-    spi_begin(&_spi, spisettings.speed, spisettings.datamode, spisettings.bitorder);
+    applySettings();
 }
 
 void SPIClass::config(SPISettings settings)
@@ -163,4 +232,75 @@ void SPIClass::config(SPISettings settings)
     spisettings.speed = settings.speed;
     spisettings.datamode = settings.datamode;
     spisettings.bitorder = settings.bitorder;
+    spisettings.framebits = settings.framebits;
+    spisettings.crcpolynomial = settings.crcpolynomial;
+}
+
+bool SPIClass::beginSlave(uint8_t dataMode, BitOrder bitOrder, void *rxbuf, const void *txbuf, size_t count,
+                          SPISlaveCallback callback, void *arg)
+{
+    end();
+    if (!spi_slave_begin(&_spi, dataMode, bitOrder, (uint8_t *)rxbuf, (const uint8_t *)txbuf, count, callback,
+                         arg)) {
+        return false;
+    }
+    initialized = true;
+    return true;
+}
+
+void SPIClass::setSlaveBuffers(void *rxbuf, const void *txbuf, size_t count)
+{
+    spi_slave_buffers_set(&_spi, (uint8_t *)rxbuf, (const uint8_t *)txbuf, count);
+}
+
+bool SPIClass::beginQuad(PinName io2, PinName io3)
+{
+    return spi_quad_begin(&_spi, io2, io3) != 0;
+}
+
+void SPIClass::endQuad(void)
+{
+    spi_quad_end(&_spi);
+}
+
+void SPIClass::quadRead(void *buf, size_t count)
+{
+    spi_master_quad_read(&_spi, (uint8_t *)buf, count);
+}
+
+void SPIClass::quadWrite(const void *buf, size_t count)
+{
+    spi_master_quad_write(&_spi, (const uint8_t *)buf, count);
+}
+
+uint16_t SPIClass::getCRC(void)
+{
+    return spi_master_crc_get(&_spi, SPI_CRC_RX);
+}
+
+uint16_t SPIClass::getTxCRC(void)
+{
+    return spi_master_crc_get(&_spi, SPI_CRC_TX);
+}
+
+void SPIClass::resetCRC(void)
+{
+    spi_master_crc_reset(&_spi);
+}
+
+/* reprogram CTL0 of a running SPI, after a full spi_begin() the first time */
+void SPIClass::applySettings(void)
+{
+    uint32_t format;
+
+    if (!initialized) {
+        spi_begin(&_spi, spisettings.speed, spisettings.datamode, spisettings.bitorder);
+    }
+    format = spi_format_get(&_spi, spisettings.speed, spisettings.datamode, spisettings.bitorder);
+    if (spisettings.framebits == 16) {
+        format |= SPI_FORMAT_FRAME16;
+    }
+    spi_format_set(&_spi, format);
+    spi_master_crc_config(&_spi, spisettings.crcpolynomial);
+    clockGeneration = clock_generation();
 }
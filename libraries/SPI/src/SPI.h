@@ -46,6 +46,20 @@ class SPISettings
             this->speed = speedMax;
             this->bitorder = bitOrder;
             this->datamode = dataMode;
+            this->framebits = 8;
+            this->crcpolynomial = 0;
+        }
+
+        /* frameBits 8 or 16. A non-zero crcPolynomial turns the hardware CRC on, it is computed over
+         * frames of that size, so 16-bit CRCs need frameBits 16 and transfer16() */
+        SPISettings(uint32_t speedMax, BitOrder bitOrder, uint8_t dataMode, uint8_t frameBits,
+                    uint16_t crcPolynomial = 0)
+        {
+            this->speed = speedMax;
+            this->bitorder = bitOrder;
+            this->datamode = dataMode;
+            this->framebits = frameBits;
+            this->crcpolynomial = crcPolynomial;
         }
 
         /* Set speed to default, SPI mode set to MODE 0 and Bit order set to MSB first. */
@@ -54,18 +68,43 @@ class SPISettings
             this->speed = SPI_SPEED_DEFAULT;
             this->bitorder = MSBFIRST;
             this->datamode = SPI_MODE0;
+            this->framebits = 8;
+            this->crcpolynomial = 0;
+        }
+
+        bool operator==(const SPISettings &rhs) const
+        {
+            return (speed == rhs.speed) && (bitorder == rhs.bitorder) && (datamode == rhs.datamode) &&
+                   (framebits == rhs.framebits) && (crcpolynomial == rhs.crcpolynomial);
+        }
+
+        bool operator!=(const SPISettings &rhs) const
+        {
+            return !(*this == rhs);
         }
 
     private:
         uint32_t speed;
         uint8_t datamode;
         BitOrder bitorder;
+        uint8_t framebits;
+        uint16_t crcpolynomial;
 
         friend class SPIClass;
+        friend class USARTSPIClass;
 };
 
 const SPISettings DEFAULT_SPI_SETTINGS = SPISettings();
 
+/* called from the DMA interrupt when an asynchronous transfer is done */
+typedef void (*SPIAsyncCallback)(void *arg);
+/* called from the NSS interrupt at the end of every frame received in slave mode */
+typedef void (*SPISlaveCallback)(void *arg, uint32_t received);
+
+#if ASYNC_COROUTINES
+class AsyncSPITransfer;
+#endif
+
 class SPIClass
 {
     public:
@@ -81,22 +120,111 @@ class SPIClass
 
         uint8_t transfer(uint8_t val8);
         uint16_t transfer16(uint16_t val16);
+        /* in place transfer of 16-bit frames, sent MSB or LSB first as a whole */
+        void transfer16(uint16_t *buf, size_t count);
         void transfer(void *buf, size_t count);
         void transfer(void *bufout, void *bufin, size_t count);
+        void transmit(const void *buf, size_t count);
+        /* queue a DMA transfer and return at once, false if SPI_ASYNC_POOL_SIZE transfers are already queued
+         * on all SPIs together.
+         * bufout NULL sends 0xFF, bufin NULL drops the received data */
+        bool transferAsync(const void *bufout, void *bufin, size_t count, SPIAsyncCallback callback,
+                           void *arg = NULL);
+        /* same, in the format of settings with cs held low for the transfer, so that transfers to
+         * several devices can be queued back to back */
+        bool transferAsync(SPISettings settings, pin_size_t cs, const void *bufout, void *bufin, size_t count,
+                           SPIAsyncCallback callback, void *arg = NULL);
+        /* number of asynchronous transfers queued or in flight */
+        uint32_t asyncPending(void);
+#if ASYNC_COROUTINES
+        /* co_await transferAsync(...) lets the other tasks run until the transfer is done, true, or
+         * false if it could not be queued. The buffers belong to the transfer until then. See Async.h */
+        AsyncSPITransfer transferAsync(const void *bufout, void *bufin, size_t count);
+        AsyncSPITransfer transferAsync(SPISettings settings, pin_size_t cs, const void *bufout, void *bufin,
+                                       size_t count);
+#endif
 
         void setBitOrder(BitOrder order);
         void setDataMode(uint8_t mode);
         void setClockDivider(uint32_t divider);
 
+        /* hardware CRC of the frames received / sent since beginTransaction() or resetCRC() */
+        uint16_t getCRC(void);
+        uint16_t getTxCRC(void);
+        void resetCRC(void);
+
+        /* quad-SPI on SPI0 of GD32F30x/E50x, false if this SPI or the pins can't do it. The quad
+         * calls move data over four lines, commands and addresses go out with the usual calls.
+         * Without quad mode they fall back to single line transfers */
+        /* slave mode, needs the SSEL pin for NSS. Each frame goes into rxbuf and is answered from
+         * txbuf by DMA, end() stops it */
+        bool beginSlave(uint8_t dataMode, BitOrder bitOrder, void *rxbuf, const void *txbuf, size_t count,
+                        SPISlaveCallback callback, void *arg = NULL);
+        /* buffers for the following frames, may be called from the callback */
+        void setSlaveBuffers(void *rxbuf, const void *txbuf, size_t count);
+
+        bool beginQuad(PinName io2, PinName io3);
+        void endQuad(void);
+        void quadRead(void *buf, size_t count);
+        void quadWrite(const void *buf, size_t count);
+
     private:
         void config(SPISettings settings);
+        void applySettings(void);
 
         SPISettings spisettings;
         bool initialized;
+        uint32_t clockGeneration = 0;    /* clock_generation() the prescaler was computed for */
         spi_t         _spi;
 
 };
 
 extern SPIClass SPI;
 
+#if ASYNC_COROUTINES
+/* awaitable of SPIClass::transferAsync(), completed from the DMA interrupt */
+class AsyncSPITransfer : public AsyncOperation<AsyncSPITransfer, bool>
+{
+    public:
+        AsyncSPITransfer(SPIClass *spi, const SPISettings *settings, pin_size_t cs, const void *bufout,
+                         void *bufin, size_t count)
+            : AsyncOperation(false), spi(spi), settings(settings ? *settings : SPISettings()),
+              withSettings(settings != NULL), cs(cs), bufout(bufout), bufin(bufin), count(count)
+        {
+        }
+        bool start(void)
+        {
+            if (withSettings) {
+                return spi->transferAsync(settings, cs, bufout, bufin, count, &AsyncSPITransfer::done, this);
+            }
+            return spi->transferAsync(bufout, bufin, count, &AsyncSPITransfer::done, this);
+        }
+
+    private:
+        static void done(void *arg)
+        {
+            ((AsyncSPITransfer *)arg)->complete(true);
+        }
+
+        SPIClass *spi;
+        SPISettings settings;
+        bool withSettings;
+        pin_size_t cs;
+        const void *bufout;
+        void *bufin;
+        size_t count;
+};
+
+inline AsyncSPITransfer SPIClass::transferAsync(const void *bufout, void *bufin, size_t count)
+{
+    return AsyncSPITransfer(this, NULL, 0, bufout, bufin, count);
+}
+
+inline AsyncSPITransfer SPIClass::transferAsync(SPISettings settings, pin_size_t cs, const void *bufout,
+                                                void *bufin, size_t count)
+{
+    return AsyncSPITransfer(this, &settings, cs, bufout, bufin, count);
+}
+#endif
+
 #endif
@@ -0,0 +1,157 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "USARTSPI.h"
+
+USARTSPIClass::USARTSPIClass(PinName mosi, PinName miso, PinName sclk)
+{
+    pin_mosi = mosi;
+    pin_miso = miso;
+    pin_sclk = sclk;
+    reverseBits = false;
+    initialized = false;
+}
+
+bool USARTSPIClass::begin()
+{
+    if (initialized) {
+        return true;
+    }
+    if (!serial_sync_init(&_serial, pin_mosi, pin_miso, pin_sclk)) {
+        return false;
+    }
+    initialized = true;
+    applySettings();
+
+    return true;
+}
+
+void USARTSPIClass::end()
+{
+    if (initialized) {
+        serial_free(&_serial);
+        initialized = false;
+    }
+}
+
+void USARTSPIClass::beginTransaction(SPISettings settings)
+{
+    if (!initialized) {
+        spisettings = settings;
+        begin();
+    } else if (settings != spisettings) {
+        spisettings = settings;
+        applySettings();
+    }
+}
+
+void USARTSPIClass::endTransaction(void)
+{
+    /* the USART stays set up for the next transaction, end() releases it */
+}
+
+/* one frame, bits reversed on parts whose USART can't shift MSB first */
+uint8_t USARTSPIClass::exchange(uint8_t val8)
+{
+    if (reverseBits) {
+        return (uint8_t)(__RBIT(serial_sync_exchange(&_serial, (uint8_t)(__RBIT(val8) >> 24))) >> 24);
+    }
+    return serial_sync_exchange(&_serial, val8);
+}
+
+uint8_t USARTSPIClass::transfer(uint8_t val8)
+{
+    return exchange(val8);
+}
+
+uint16_t USARTSPIClass::transfer16(uint16_t val16)
+{
+    uint16_t in;
+
+    if (spisettings.bitorder == MSBFIRST) {
+        in = (uint16_t)exchange((uint8_t)(val16 >> 8)) << 8;
+        in |= exchange((uint8_t)val16);
+    } else {
+        in = exchange((uint8_t)val16);
+        in |= (uint16_t)exchange((uint8_t)(val16 >> 8)) << 8;
+    }
+    return in;
+}
+
+void USARTSPIClass::transfer(void *buf, size_t count)
+{
+    transfer(buf, buf, count);
+}
+
+void USARTSPIClass::transfer(void *bufout, void *bufin, size_t count)
+{
+    const uint8_t *out = (const uint8_t *)bufout;
+    uint8_t *in = (uint8_t *)bufin;
+
+    /* the transmit DMA stays ahead of the receive one, so in place is fine */
+    if (!reverseBits && serial_sync_transfer(&_serial, out, in, count)) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        uint8_t rx = exchange((out != NULL) ? out[i] : 0xFF);
+        if (in != NULL) {
+            in[i] = rx;
+        }
+    }
+}
+
+void USARTSPIClass::transmit(const void *buf, size_t count)
+{
+    transfer((void *)buf, NULL, count);
+}
+
+void USARTSPIClass::setBitOrder(BitOrder order)
+{
+    spisettings.bitorder = order;
+    applySettings();
+}
+
+void USARTSPIClass::setDataMode(uint8_t mode)
+{
+    spisettings.datamode = mode;
+    applySettings();
+}
+
+void USARTSPIClass::setClockDivider(uint32_t divider)
+{
+    spisettings.speed = (divider == 0) ? SPI_SPEED_DEFAULT : SystemCoreClock / divider;
+    applySettings();
+}
+
+void USARTSPIClass::applySettings(void)
+{
+    if (!initialized) {
+        return;
+    }
+    reverseBits = !serial_sync_format(&_serial, spisettings.speed, spisettings.datamode,
+                                      spisettings.bitorder == MSBFIRST);
+}
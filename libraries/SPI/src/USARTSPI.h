@@ -0,0 +1,78 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef _USARTSPI_H_INCLUDED
+#define _USARTSPI_H_INCLUDED
+
+#include "SPI.h"
+#include "uart.h"
+
+/*
+ * An SPI master on a USART in synchronous mode, for when the SPI peripherals are taken: TX is
+ * MOSI, RX is MISO and the CK pin of the USART is SCK. Frames are 8 bits, no NSS, the clock
+ * reaches the USART clock / 8 on parts that oversample by 8 and / 16 on the others (GD32F30x,
+ * GD32F10x). Block transfers go by DMA where the USART has request lines, the call returns
+ * when they are done. USART0..2 only, UART3/4 have no clock output
+ */
+class USARTSPIClass
+{
+    public:
+        USARTSPIClass(PinName mosi, PinName miso, PinName sclk);
+
+        /* false if the pins are not TX, RX and CK of one USART */
+        bool begin();
+        void end();
+
+        void beginTransaction(SPISettings settings);
+        void endTransaction(void);
+
+        uint8_t transfer(uint8_t val8);
+        uint16_t transfer16(uint16_t val16);
+        void transfer(void *buf, size_t count);
+        void transfer(void *bufout, void *bufin, size_t count);
+        /* transmit only, the received bytes are thrown away */
+        void transmit(const void *buf, size_t count);
+
+        void setBitOrder(BitOrder order);
+        void setDataMode(uint8_t mode);
+        /* of the system clock */
+        void setClockDivider(uint32_t divider);
+
+    private:
+        void applySettings(void);
+        uint8_t exchange(uint8_t val8);
+
+        SPISettings spisettings;
+        bool initialized;
+        bool reverseBits;               /* MSB first in software, the USART only shifts LSB first */
+        PinName pin_mosi;
+        PinName pin_miso;
+        PinName pin_sclk;
+        serial_t _serial;
+};
+
+#endif
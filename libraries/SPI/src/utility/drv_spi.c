@@ -28,6 +28,12 @@ OF SUCH DAMAGE.
 */
 
 #include "drv_spi.h"
+#include "dma.h"
+#include "irq_priority.h"
+#include "gpio_interrupt.h"
+#include "os_event.h"
+#include "pool.h"
+#include "clock.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -36,6 +42,96 @@ extern "C" {
 #define SPI_S(obj)    (( struct spi_s *)(obj))
 #define SPI_PINS_FREE_MODE   0x00000001
 
+/* blocks shorter than this are cheaper to poll than to set DMA channels up for */
+#ifndef SPI_DMA_MIN_LENGTH
+#define SPI_DMA_MIN_LENGTH   16U
+#endif
+/* a DMA channel moves at most 0xFFFF frames per transfer */
+#define SPI_DMA_MAX_LENGTH   0xFFFFU
+/* clocked out when only receiving */
+#define SPI_FILL_VALUE       0xFFFFU
+/* CTL0 bits that make up the format of a transfer */
+#define SPI_FORMAT_MASK      (SPI_CTL0_PSC | SPI_CTL0_CKPL | SPI_CTL0_CKPH | SPI_CTL0_LF | SPI_CTL0_FF16)
+
+typedef struct {
+    dma_channel_t rx;
+    dma_channel_t tx;
+} spi_dma_t;
+
+/* descriptors of the queued asynchronous transfers of all SPIs, taken and
+   given back from thread and interrupt context alike */
+POOL_DEFINE(spi_async_pool, spi_async_node_t, SPI_ASYNC_POOL_SIZE);
+
+/* SPIs holding a clock reference from spi_init() until spi_free(), one bit each */
+static uint8_t spi_clock_held;
+
+/* the clock enable of an SPI and its bit in spi_clock_held, 0 if it does not exist */
+static uint32_t dev_spi_rcu(SPIName spi, uint8_t *bit)
+{
+    switch ((uint32_t)spi) {
+        case SPI0:
+            *bit = 1U << 0;
+            return RCU_SPI0;
+        case SPI1:
+            *bit = 1U << 1;
+            return RCU_SPI1;
+#ifdef SPI2
+        case SPI2:
+            *bit = 1U << 2;
+            return RCU_SPI2;
+#endif
+        default:
+            return 0U;
+    }
+}
+
+/* turn the clock of an SPI on, spi_init() may run again for the same SPI */
+static void dev_spi_clock_acquire(SPIName spi)
+{
+    uint8_t bit;
+    uint32_t rcu = dev_spi_rcu(spi, &bit);
+    uint32_t state;
+
+    if (rcu == 0U) {
+        return;
+    }
+    state = critical_enter();
+    if (!(spi_clock_held & bit)) {
+        spi_clock_held |= bit;
+        clock_periph_acquire((rcu_periph_enum)rcu);
+    }
+    critical_exit(state);
+}
+
+/* gate the clock of an SPI off unless I2S still uses it */
+static void dev_spi_clock_release(SPIName spi)
+{
+    uint8_t bit;
+    uint32_t rcu = dev_spi_rcu(spi, &bit);
+    uint32_t state;
+
+    if (rcu == 0U) {
+        return;
+    }
+    state = critical_enter();
+    if (spi_clock_held & bit) {
+        spi_clock_held &= ~bit;
+        clock_periph_release((rcu_periph_enum)rcu);
+    }
+    critical_exit(state);
+}
+
+/** Wait for the queued asynchronous transfers to finish
+ *
+ * @param spiobj The SPI object
+ */
+static void dev_spi_async_wait(struct spi_s *spiobj)
+{
+    while (spiobj->async_count != 0U) {
+        os_event_wait();
+    }
+}
+
 /** Initialize the SPI structure
  *
  * Configures the pins used by SPI, sets a default format and frequency, and enables the peripheral
@@ -83,6 +179,138 @@ uint32_t dev_spi_clock_source_frequency_get(spi_t *obj)
     return spi_freq;
 }
 
+/** Work out the CTL0 format bits of a setting
+ *
+ * @param obj    The SPI object, its peripheral has to be known already
+ * @param speed  Maximum SCK frequency
+ * @param mode   One of the SPI modes
+ * @param endian 1 for MSB first
+ * @return       Prescaler, clock polarity/phase and bit order bits, SPI_FORMAT_INVALID for an unknown mode
+ */
+uint32_t spi_format_get(spi_t *obj, uint32_t speed, uint8_t mode, uint8_t endian)
+{
+    uint32_t format;
+    uint32_t spi_freq = dev_spi_clock_source_frequency_get(obj);
+
+    if (speed >= (spi_freq / SPI_CLOCK_DIV2)) {
+        format = SPI_PSC_2;
+    } else if (speed >= (spi_freq / SPI_CLOCK_DIV4)) {
+        format = SPI_PSC_4;
+    } else if (speed >= (spi_freq / SPI_CLOCK_DIV8)) {
+        format = SPI_PSC_8;
+    } else if (speed >= (spi_freq / SPI_CLOCK_DIV16)) {
+        format = SPI_PSC_16;
+    } else if (speed >= (spi_freq / SPI_CLOCK_DIV32)) {
+        format = SPI_PSC_32;
+    } else if (speed >= (spi_freq / SPI_CLOCK_DIV64)) {
+        format = SPI_PSC_64;
+    } else if (speed >= (spi_freq / SPI_CLOCK_DIV128)) {
+        format = SPI_PSC_128;
+    } else {
+        /*
+         * As it is not possible to go below (spi_freq / SPI_SPEED_CLOCK_DIV256_MHZ).
+         * Set prescaler at max value so get the lowest frequency possible.
+         */
+        format = SPI_PSC_256;
+    }
+
+    if (mode == SPI_MODE0) {
+        format |= SPI_CK_PL_LOW_PH_1EDGE;
+    } else if (mode == SPI_MODE1) {
+        format |= SPI_CK_PL_LOW_PH_2EDGE;
+    } else if (mode == SPI_MODE2) {
+        format |= SPI_CK_PL_HIGH_PH_1EDGE;
+    } else if (mode == SPI_MODE3) {
+        format |= SPI_CK_PL_HIGH_PH_2EDGE;
+    } else {
+        return SPI_FORMAT_INVALID;
+    }
+
+    if (endian == 0) {
+        format |= SPI_ENDIAN_LSB;
+    } else {
+        format |= SPI_ENDIAN_MSB;
+    }
+    return format;
+}
+
+/** Switch the running SPI to other format bits
+ *
+ * @param obj    The SPI object
+ * @param format Bits returned by spi_format_get()
+ */
+static void dev_spi_format_apply(struct spi_s *spiobj, uint32_t format)
+{
+    uint32_t ctl0 = SPI_CTL0(spiobj->spi);
+
+    if ((ctl0 & SPI_FORMAT_MASK) == format) {
+        return;
+    }
+    /* the format bits may only change while the SPI is disabled */
+    SPI_CTL0(spiobj->spi) = ctl0 & ~SPI_CTL0_SPIEN;
+    SPI_CTL0(spiobj->spi) = (ctl0 & ~SPI_FORMAT_MASK) | format;
+}
+
+/** Switch an initialized SPI to another format, touching CTL0 only
+ *
+ * @param obj    The SPI object
+ * @param format Bits returned by spi_format_get()
+ */
+void spi_format_set(spi_t *obj, uint32_t format)
+{
+    struct spi_s *spiobj = SPI_S(obj);
+
+    if (format == SPI_FORMAT_INVALID) {
+        return;
+    }
+    dev_spi_async_wait(spiobj);
+#if defined(GD32E23x)
+    if (spiobj->spi == SPI1) {
+        /* FF16 has no meaning next to the FIFO of SPI1 */
+        format &= ~SPI_CTL0_FF16;
+    }
+#endif
+    spiobj->spi_struct.prescale             = format & SPI_CTL0_PSC;
+    spiobj->spi_struct.clock_polarity_phase = format & (SPI_CTL0_CKPL | SPI_CTL0_CKPH);
+    spiobj->spi_struct.endian               = format & SPI_CTL0_LF;
+    spiobj->format = format;
+    dev_spi_format_apply(spiobj, format);
+}
+
+/** Switch between 8-bit and 16-bit frames, the bus has to be idle
+ *
+ * @param spiobj  The SPI object
+ * @param frame16 Non-zero for 16-bit frames
+ * @return        Non-zero if the SPI runs the requested frame size
+ */
+static int dev_spi_frame16_set(struct spi_s *spiobj, int frame16)
+{
+    uint32_t ctl0 = SPI_CTL0(spiobj->spi);
+    uint32_t want = frame16 ? (ctl0 | SPI_CTL0_FF16) : (ctl0 & ~SPI_CTL0_FF16);
+
+#if defined(GD32E23x)
+    /* SPI1 has a data FIFO and takes the frame size from CTL1, it keeps 8-bit frames */
+    if (spiobj->spi == SPI1) {
+        return !frame16;
+    }
+#endif
+    if (want != ctl0) {
+        /* FF16 may only change while the SPI is disabled */
+        SPI_CTL0(spiobj->spi) = ctl0 & ~SPI_CTL0_SPIEN;
+        SPI_CTL0(spiobj->spi) = want;
+    }
+    return 1;
+}
+
+/** Go back to the frame size of the configured format
+ *
+ * @param spiobj The SPI object
+ */
+static void dev_spi_frame_restore(struct spi_s *spiobj)
+{
+    (void)dev_spi_frame16_set(spiobj, (spiobj->format & SPI_CTL0_FF16) != 0U);
+}
+
 /**
   * @brief  SPI initialization function
   * @param  obj : pointer to spi_t structure
@@ -95,7 +323,9 @@ void spi_begin(spi_t *obj, uint32_t speed, uint8_t mode, uint8_t endian)
 {
     struct spi_s *spiobj = SPI_S(obj);
 
-    uint32_t spi_freq = 0;
+    uint32_t format;
+
+    dev_spi_async_wait(spiobj);
 
     /* Determine the SPI to use */
     SPIName spi_mosi = (SPIName)pinmap_peripheral(spiobj->pin_mosi, PinMap_SPI_MOSI);
@@ -110,17 +340,7 @@ void spi_begin(spi_t *obj, uint32_t speed, uint8_t mode, uint8_t endian)
     spiobj->spi = (SPIName)pinmap_merge(spi_data, spi_cntl);
 
     /* enable SPI clock */
-    if (spiobj->spi == SPI0) {
-        rcu_periph_clock_enable(RCU_SPI0);
-    }
-    if (spiobj->spi == SPI1) {
-        rcu_periph_clock_enable(RCU_SPI1);
-    }
-#ifdef SPI2    
-    if (spiobj->spi == SPI2) {
-        rcu_periph_clock_enable(RCU_SPI2);
-    }
-#endif
+    dev_spi_clock_acquire(spiobj->spi);
 
     /* configure GPIO mode of SPI pins */
     pinmap_pinout(spiobj->pin_mosi, PinMap_SPI_MOSI);
@@ -136,46 +356,14 @@ void spi_begin(spi_t *obj, uint32_t speed, uint8_t mode, uint8_t endian)
         spiobj->spi_struct.nss = SPI_NSS_SOFT;
     }
 
-    spi_freq = dev_spi_clock_source_frequency_get(obj);
-    if (speed >= (spi_freq / SPI_CLOCK_DIV2)) {
-        spiobj->spi_struct.prescale             = SPI_PSC_2;
-    } else if (speed >= (spi_freq / SPI_CLOCK_DIV4)) {
-        spiobj->spi_struct.prescale             = SPI_PSC_4;
-    } else if (speed >= (spi_freq / SPI_CLOCK_DIV8)) {
-        spiobj->spi_struct.prescale             = SPI_PSC_8;
-    } else if (speed >= (spi_freq / SPI_CLOCK_DIV16)) {
-        spiobj->spi_struct.prescale             = SPI_PSC_16;
-    } else if (speed >= (spi_freq / SPI_CLOCK_DIV32)) {
-        spiobj->spi_struct.prescale             = SPI_PSC_32;
-    } else if (speed >= (spi_freq / SPI_CLOCK_DIV64)) {
-        spiobj->spi_struct.prescale             = SPI_PSC_64;
-    } else if (speed >= (spi_freq / SPI_CLOCK_DIV128)) {
-        spiobj->spi_struct.prescale             = SPI_PSC_128;
-    } else {
-        /*
-         * As it is not possible to go below (spi_freq / SPI_SPEED_CLOCK_DIV256_MHZ).
-         * Set prescaler at max value so get the lowest frequency possible.
-         */
-        spiobj->spi_struct.prescale             = SPI_PSC_256;
-    }
-
-    if (mode == SPI_MODE0) {
-        spiobj->spi_struct.clock_polarity_phase = SPI_CK_PL_LOW_PH_1EDGE;
-    } else if (mode == SPI_MODE1) {
-        spiobj->spi_struct.clock_polarity_phase = SPI_CK_PL_LOW_PH_2EDGE;
-    } else if (mode == SPI_MODE2) {
-        spiobj->spi_struct.clock_polarity_phase =  SPI_CK_PL_HIGH_PH_1EDGE;
-    } else if (mode == SPI_MODE3) {
-        spiobj->spi_struct.clock_polarity_phase = SPI_CK_PL_HIGH_PH_2EDGE;
-    } else {
+    format = spi_format_get(obj, speed, mode, endian);
+    if (format == SPI_FORMAT_INVALID) {
         return;
     }
-
-    if (endian == 0) {
-        spiobj->spi_struct.endian               = SPI_ENDIAN_LSB;
-    } else {
-        spiobj->spi_struct.endian               = SPI_ENDIAN_MSB;
-    }
+    spiobj->spi_struct.prescale             = format & SPI_CTL0_PSC;
+    spiobj->spi_struct.clock_polarity_phase = format & (SPI_CTL0_CKPL | SPI_CTL0_CKPH);
+    spiobj->spi_struct.endian               = format & SPI_CTL0_LF;
+    spiobj->format = format;
 
     /* Default values */
     spiobj->spi_struct.trans_mode           = SPI_TRANSMODE_FULLDUPLEX;
@@ -194,23 +382,24 @@ void spi_begin(spi_t *obj, uint32_t speed, uint8_t mode, uint8_t endian)
 void spi_free(spi_t *obj)
 {
     struct spi_s *spiobj = SPI_S(obj);
+
+    dev_spi_async_wait(spiobj);
+    spi_slave_end(obj);
     spi_disable(spiobj->spi);
 
     /* Disable and deinit SPI */
     if (spiobj->spi == SPI0) {
         spi_i2s_deinit(SPI0);
-        rcu_periph_clock_disable(RCU_SPI0);
     }
     if (spiobj->spi == SPI1) {
         spi_i2s_deinit(SPI1);
-        rcu_periph_clock_disable(RCU_SPI1);
     }
 #ifdef SPI2
     if (spiobj->spi == SPI2) {
         spi_i2s_deinit(SPI2);
-        rcu_periph_clock_disable(RCU_SPI2);
     }
 #endif
+    dev_spi_clock_release(spiobj->spi);
     /* Deinit GPIO mode of SPI pins */
     pin_function(spiobj->pin_miso, SPI_PINS_FREE_MODE);
     pin_function(spiobj->pin_mosi, SPI_PINS_FREE_MODE);
@@ -219,6 +408,7 @@ void spi_free(spi_t *obj)
         pin_function(spiobj->pin_ssel, SPI_PINS_FREE_MODE);
         spi_nss_output_disable(spiobj->spi);
     }
+    spi_quad_end(obj);
 }
 
 /**
@@ -230,41 +420,883 @@ void spi_free(spi_t *obj)
 uint32_t spi_master_write(spi_t *obj, uint8_t value)
 {
     int count = 0;
+    uint32_t result = (uint32_t) -1;
     struct spi_s *spiobj = SPI_S(obj);
 
+    dev_spi_async_wait(spiobj);
+    (void)dev_spi_frame16_set(spiobj, 0);
+
     /* wait the SPI transmit buffer is empty */
     while ((RESET == spi_i2s_flag_get(spiobj->spi, SPI_FLAG_TBE)) && (count++ < 1000));
-    if (count >= 1000) {
-        return -1;
-    } else {
+    if (count < 1000) {
         spi_i2s_data_transmit(spiobj->spi, value);
+
+        count = 0;
+        /* wait the SPI receive buffer is not empty */
+        while ((RESET == spi_i2s_flag_get(spiobj->spi, SPI_FLAG_RBNE)) && (count++ < 1000));
+        if (count < 1000) {
+            result = spi_i2s_data_receive(spiobj->spi);
+        }
+    }
+
+    dev_spi_frame_restore(spiobj);
+    return result;
+}
+
+/** Get the DMA channels serving the requests of an SPI
+ *
+ * @param spi The SPI peripheral
+ * @return    The receive/transmit channel pair, NULL if the SPI has none
+ */
+static const spi_dma_t *dev_spi_dma_get(SPIName spi)
+{
+#if defined(DMA0)
+    static const spi_dma_t spi0_dma = {{DMA0, DMA_CH1}, {DMA0, DMA_CH2}};
+    static const spi_dma_t spi1_dma = {{DMA0, DMA_CH3}, {DMA0, DMA_CH4}};
+#if defined(SPI2) && (DMA_CHANNEL_NUM > DMA_CHANNELS_PER_PERIPH)
+    static const spi_dma_t spi2_dma = {{DMA1, DMA_CH0}, {DMA1, DMA_CH1}};
+#endif
+#else
+    static const spi_dma_t spi0_dma = {{0U, DMA_CH1}, {0U, DMA_CH2}};
+    static const spi_dma_t spi1_dma = {{0U, DMA_CH3}, {0U, DMA_CH4}};
+#endif
+
+    switch ((int)spi) {
+        case SPI0:
+            return &spi0_dma;
+        case SPI1:
+            return &spi1_dma;
+#if defined(DMA0) && defined(SPI2) && (DMA_CHANNEL_NUM > DMA_CHANNELS_PER_PERIPH)
+        case SPI2:
+            return &spi2_dma;
+#endif
+        default:
+            return NULL;
     }
+}
+
+/** Load one DMA channel for a block transfer between memory and the SPI data register
+ *
+ * @param ch         The DMA channel
+ * @param spi        The SPI peripheral
+ * @param direction  DMA_MEMORY_TO_PERIPHERAL or DMA_PERIPHERAL_TO_MEMORY
+ * @param buffer     The memory side of the transfer
+ * @param memory_inc DMA_MEMORY_INCREASE_ENABLE to walk the buffer, DISABLE to repeat one frame
+ * @param len        Number of frames
+ * @param frame16    Non-zero for 16-bit frames
+ */
+static void dev_spi_dma_channel_load(const dma_channel_t *ch, uint32_t spi, uint8_t direction,
+                                     const void *buffer, uint8_t memory_inc, uint32_t len, int frame16)
+{
+    dma_parameter_struct dma_init_struct;
+
+    dma_deinit(DMA_SPL_ARGS(ch));
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.direction    = direction;
+    dma_init_struct.memory_addr  = (uint32_t)buffer;
+    dma_init_struct.memory_inc   = memory_inc;
+    dma_init_struct.memory_width = frame16 ? DMA_MEMORY_WIDTH_16BIT : DMA_MEMORY_WIDTH_8BIT;
+    dma_init_struct.number       = len;
+    dma_init_struct.periph_addr  = (uint32_t)&SPI_DATA(spi);
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = frame16 ? DMA_PERIPHERAL_WIDTH_16BIT : DMA_PERIPHERAL_WIDTH_8BIT;
+    dma_init_struct.priority     = (direction == DMA_PERIPHERAL_TO_MEMORY) ? DMA_PRIORITY_HIGH :
+                                   DMA_PRIORITY_MEDIUM;
+    dma_init(DMA_SPL_ARGS(ch), &dma_init_struct);
+    dma_circulation_disable(DMA_SPL_ARGS(ch));
+    dma_memory_to_memory_disable(DMA_SPL_ARGS(ch));
+    dma_channel_enable(DMA_SPL_ARGS(ch));
+}
+
+/** Load the receive channel, NULL throws the received frames into a sink
+ *
+ * @param spi       The SPI peripheral
+ * @param dma       The channel pair of the SPI
+ * @param rx_buffer Received data
+ * @param len       Number of frames
+ * @param frame16   Non-zero for 16-bit frames
+ */
+static void dev_spi_dma_rx_load(uint32_t spi, const spi_dma_t *dma, void *rx_buffer, uint32_t len, int frame16)
+{
+    static uint16_t sink;
 
-    count = 0;
-    /* wait the SPI receive buffer is not empty */
-    while ((RESET == spi_i2s_flag_get(spiobj->spi, SPI_FLAG_RBNE)) && (count++ < 1000));
-    if (count >= 1000) {
-        return -1;
+    /* a stale frame would otherwise be the first one the receive channel picks up */
+    (void)SPI_DATA(spi);
+    (void)SPI_STAT(spi);
+    if (rx_buffer != NULL) {
+        dev_spi_dma_channel_load(&dma->rx, spi, DMA_PERIPHERAL_TO_MEMORY, rx_buffer,
+                                 DMA_MEMORY_INCREASE_ENABLE, len, frame16);
     } else {
-        return spi_i2s_data_receive(spiobj->spi);
+        dev_spi_dma_channel_load(&dma->rx, spi, DMA_PERIPHERAL_TO_MEMORY, &sink,
+                                 DMA_MEMORY_INCREASE_DISABLE, len, frame16);
+    }
+    spi_dma_enable(spi, SPI_DMA_RECEIVE);
+}
+
+/** Load the transmit channel and start the transfer, NULL sends SPI_FILL_VALUE
+ *
+ * @param spi       The SPI peripheral
+ * @param dma       The channel pair of the SPI
+ * @param tx_buffer Data to send
+ * @param len       Number of frames
+ * @param frame16   Non-zero for 16-bit frames
+ */
+static void dev_spi_dma_tx_start(uint32_t spi, const spi_dma_t *dma, const void *tx_buffer, uint32_t len,
+                                 int frame16)
+{
+    static const uint16_t fill = SPI_FILL_VALUE;
+
+    if (tx_buffer != NULL) {
+        dev_spi_dma_channel_load(&dma->tx, spi, DMA_MEMORY_TO_PERIPHERAL, tx_buffer,
+                                 DMA_MEMORY_INCREASE_ENABLE, len, frame16);
+    } else {
+        dev_spi_dma_channel_load(&dma->tx, spi, DMA_MEMORY_TO_PERIPHERAL, &fill,
+                                 DMA_MEMORY_INCREASE_DISABLE, len, frame16);
+    }
+    /* the first transmit request starts the clock */
+    spi_dma_enable(spi, SPI_DMA_TRANSMIT);
+}
+
+/** Stop the channels of a finished block
+ *
+ * @param spi The SPI peripheral
+ * @param dma The channel pair of the SPI
+ * @param rx  Non-zero if the receive channel was used as well
+ */
+static void dev_spi_dma_stop(uint32_t spi, const spi_dma_t *dma, int rx)
+{
+    if (rx) {
+        spi_dma_disable(spi, SPI_DMA_RECEIVE);
+        dma_channel_disable(DMA_SPL_ARGS(&dma->rx));
+    }
+    spi_dma_disable(spi, SPI_DMA_TRANSMIT);
+    dma_channel_disable(DMA_SPL_ARGS(&dma->tx));
+}
+
+/** Wait until the last frame has left the shift register, then drop what was received
+ *
+ * @param spi The SPI peripheral
+ */
+static void dev_spi_tx_drain(uint32_t spi)
+{
+    while (RESET == spi_i2s_flag_get(spi, SPI_FLAG_TBE));
+    while (SET == spi_i2s_flag_get(spi, SPI_FLAG_TRANS));
+    /* reading DATA then STAT clears RBNE and the overrun left by the unread frames */
+    (void)SPI_DATA(spi);
+    (void)SPI_STAT(spi);
+}
+
+/** Claim the DMA channels of an SPI
+ *
+ * @param spiobj  The SPI object, owner of the claim
+ * @param dma     The channel pair of the SPI, may be NULL
+ * @param need_rx Non-zero if the receive channel is needed as well
+ * @return        Non-zero if the channels exist and now belong to spiobj
+ */
+static int dev_spi_dma_claim(struct spi_s *spiobj, const spi_dma_t *dma, int need_rx)
+{
+    if (dma == NULL) {
+        return 0;
+    }
+    /* the channels are shared with other peripherals, leave them to whoever holds them;
+     * one enabled without a claim was set up by the sketch itself */
+    if (dma_channel_is_enabled(&dma->tx) || (need_rx && dma_channel_is_enabled(&dma->rx))) {
+        return 0;
+    }
+    if (!dma_channel_claim(&dma->tx, spiobj)) {
+        return 0;
+    }
+    if (need_rx && !dma_channel_claim(&dma->rx, spiobj)) {
+        dma_channel_release(&dma->tx, spiobj);
+        return 0;
+    }
+    return 1;
+}
+
+/** Give back the channels taken by dev_spi_dma_claim()
+ *
+ * @param spiobj The SPI object
+ * @param dma    The channel pair of the SPI
+ */
+static void dev_spi_dma_release(struct spi_s *spiobj, const spi_dma_t *dma)
+{
+    dma_channel_release(&dma->tx, spiobj);
+    dma_channel_release(&dma->rx, spiobj);
+}
+
+/** Move one block of at most SPI_DMA_MAX_LENGTH frames with DMA, blocking until it is done
+ *
+ * @param spi       The SPI peripheral
+ * @param dma       The channel pair of the SPI
+ * @param tx_buffer Data to send, NULL to send SPI_FILL_VALUE
+ * @param rx_buffer Received data, NULL to discard it
+ * @param len       Number of frames
+ * @param frame16   Non-zero for 16-bit frames
+ */
+static void dev_spi_dma_block(uint32_t spi, const spi_dma_t *dma, const void *tx_buffer,
+                              void *rx_buffer, uint32_t len, int frame16)
+{
+    if (rx_buffer != NULL) {
+        dev_spi_dma_rx_load(spi, dma, rx_buffer, len, frame16);
+    }
+    dev_spi_dma_tx_start(spi, dma, tx_buffer, len, frame16);
+
+    if (rx_buffer != NULL) {
+        /* the last frame is received after it was sent, so this covers the transmit side too */
+        while (RESET == dma_flag_get(DMA_SPL_ARGS(&dma->rx), DMA_FLAG_FTF));
+    } else {
+        while (RESET == dma_flag_get(DMA_SPL_ARGS(&dma->tx), DMA_FLAG_FTF));
+        dev_spi_tx_drain(spi);
+    }
+    dev_spi_dma_stop(spi, dma, rx_buffer != NULL);
+}
+
+/** Apply the format of a queued transfer and drive its chip select low
+ *
+ * @param spiobj The SPI object
+ * @param xfer   The transfer
+ */
+static void dev_spi_async_select(struct spi_s *spiobj, const spi_async_t *xfer)
+{
+    /* queued transfers move bytes */
+    dev_spi_format_apply(spiobj, (xfer->format != SPI_FORMAT_INVALID) ? xfer->format :
+                         (spiobj->format & ~SPI_CTL0_FF16));
+    if (xfer->cs_port != 0U) {
+        GPIO_BC(xfer->cs_port) = xfer->cs_mask;
+    }
+}
+
+/** Release the chip select of a queued transfer
+ *
+ * @param xfer The transfer
+ */
+static void dev_spi_async_deselect(const spi_async_t *xfer)
+{
+    if (xfer->cs_port != 0U) {
+        GPIO_BOP(xfer->cs_port) = xfer->cs_mask;
+    }
+}
+
+/** Start the next block of the transfer at the head of the asynchronous queue
+ *
+ * @param spiobj The SPI object
+ */
+static void dev_spi_async_block(struct spi_s *spiobj)
+{
+    const spi_dma_t *dma = dev_spi_dma_get(spiobj->spi);
+    spi_async_t *xfer = &spiobj->async_head->xfer;
+    uint32_t block = xfer->len - spiobj->async_done;
+
+    if (block > SPI_DMA_MAX_LENGTH) {
+        block = SPI_DMA_MAX_LENGTH;
     }
+    /* the receive channel always runs so its completion marks the end of the block */
+    dev_spi_dma_rx_load(spiobj->spi, dma, (xfer->rx_buffer != NULL) ? (xfer->rx_buffer + spiobj->async_done) : NULL,
+                        block, 0);
+    dma_interrupt_enable(DMA_SPL_ARGS(&dma->rx), DMA_INT_FTF);
+    dma_interrupt_enable(DMA_SPL_ARGS(&dma->rx), DMA_INT_ERR);
+    dev_spi_dma_tx_start(spiobj->spi, dma, (xfer->tx_buffer != NULL) ? (xfer->tx_buffer + spiobj->async_done) : NULL,
+                         block, 0);
+    spiobj->async_done += block;
+}
+
+/** Begin the transfer at the head of the asynchronous queue
+ *
+ * @param spiobj The SPI object
+ */
+static void dev_spi_async_begin(struct spi_s *spiobj)
+{
+    dev_spi_async_select(spiobj, &spiobj->async_head->xfer);
+    spiobj->async_done = 0U;
+    dev_spi_async_block(spiobj);
+}
+
+/** Receive channel interrupt of an asynchronous transfer
+ *
+ * @param arg   The SPI object
+ * @param flags The channel flags that were set
+ */
+static void dev_spi_async_irq(void *arg, uint32_t flags)
+{
+    struct spi_s *spiobj = SPI_S(arg);
+    const spi_dma_t *dma = dev_spi_dma_get(spiobj->spi);
+    spi_async_node_t *node = spiobj->async_head;
+    spi_async_t *xfer = &node->xfer;
+    spi_async_callback_t callback;
+    void *callback_arg;
+
+    /* the vector may be shared with another channel */
+    if ((flags & (DMA_CALLBACK_FLAG_FTF | DMA_CALLBACK_FLAG_ERR)) == 0U) {
+        return;
+    }
+    dev_spi_dma_stop(spiobj->spi, dma, 1);
+    if (((flags & DMA_CALLBACK_FLAG_ERR) == 0U) && (spiobj->async_done < xfer->len)) {
+        dev_spi_async_block(spiobj);
+        return;
+    }
+    dev_spi_async_deselect(xfer);
+    callback = xfer->callback;
+    callback_arg = xfer->arg;
+    spiobj->async_head = node->next;
+    spiobj->async_count--;
+    pool_free(&spi_async_pool, node);
+    if (spiobj->async_count != 0U) {
+        dev_spi_async_begin(spiobj);
+    } else {
+        dma_channel_detach_irq(&dma->rx);
+        dev_spi_dma_release(spiobj, dma);
+        /* back to the format of the synchronous transfers */
+        dev_spi_format_apply(spiobj, spiobj->format);
+    }
+    os_event_signal();
+    if (callback != NULL) {
+        callback(callback_arg);
+    }
+}
+
+/**
+  * @brief Queue a transfer that runs by DMA in the background
+  * @param  obj : pointer to spi_t structure
+  * @param  xfer : the transfer, copied into the queue
+  * @retval 1 if queued or already done, 0 if all SPI_ASYNC_POOL_SIZE descriptors are in use
+  */
+int spi_master_async_transfer(spi_t *obj, const spi_async_t *xfer)
+{
+    struct spi_s *spiobj = SPI_S(obj);
+    const spi_dma_t *dma = dev_spi_dma_get(spiobj->spi);
+    spi_async_node_t *node;
+    uint32_t primask;
+    uint8_t count;
+
+    /* lock-free, so the critical section below stays short */
+    node = (spi_async_node_t *)pool_alloc(&spi_async_pool);
+    if (node == NULL) {
+        return 0;
+    }
+    node->xfer = *xfer;
+    node->next = NULL;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    count = spiobj->async_count;
+    if ((count == 0U) && ((xfer->len == 0U) || !dev_spi_dma_claim(spiobj, dma, 1))) {
+        /* nothing to queue behind and no DMA to run it on, do it right here */
+        __set_PRIMASK(primask);
+        pool_free(&spi_async_pool, node);
+        dev_spi_async_select(spiobj, xfer);
+        spi_master_block_write(obj, xfer->tx_buffer, xfer->rx_buffer, xfer->len);
+        dev_spi_async_deselect(xfer);
+        dev_spi_format_apply(spiobj, spiobj->format);
+        if (xfer->callback != NULL) {
+            xfer->callback(xfer->arg);
+        }
+        return 1;
+    }
+    if (count == 0U) {
+        spiobj->async_head = node;
+    } else {
+        spiobj->async_tail->next = node;
+    }
+    spiobj->async_tail = node;
+    spiobj->async_count = count + 1U;
+    if (count == 0U) {
+        dma_channel_clock_enable(&dma->rx);
+        dma_channel_attach_irq(&dma->rx, dev_spi_async_irq, spiobj, IRQ_LEVEL(IRQ_PRIO_SPI));
+        dev_spi_async_begin(spiobj);
+    }
+    __set_PRIMASK(primask);
+    return 1;
+}
+
+/**
+  * @brief Number of asynchronous transfers queued or in flight
+  * @param  obj : pointer to spi_t structure
+  * @retval the count
+  */
+uint32_t spi_master_async_pending(spi_t *obj)
+{
+    return SPI_S(obj)->async_count;
+}
+
+/** Full duplex polled transfer that keeps the transmit buffer fed while draining the receive side
+ *
+ * @param spi       The SPI peripheral
+ * @param tx_buffer Data to send, NULL to send SPI_FILL_VALUE
+ * @param rx_buffer Received data
+ * @param len       Number of frames
+ * @param frame16   Non-zero for 16-bit frames
+ */
+static void dev_spi_poll_block(uint32_t spi, const void *tx_buffer, void *rx_buffer, uint32_t len, int frame16)
+{
+    uint32_t sent = 0U;
+    uint32_t received = 0U;
+
+    while (received < len) {
+        /* one frame shifting and one waiting in the buffer, so RBNE is never overrun */
+        if ((sent < len) && ((sent - received) < 2U) && (SPI_STAT(spi) & SPI_STAT_TBE)) {
+            uint32_t value = SPI_FILL_VALUE;
+            if (tx_buffer != NULL) {
+                value = frame16 ? ((const uint16_t *)tx_buffer)[sent] : ((const uint8_t *)tx_buffer)[sent];
+            }
+            SPI_DATA(spi) = value;
+            sent++;
+        }
+        if (SPI_STAT(spi) & SPI_STAT_RBNE) {
+            uint32_t value = SPI_DATA(spi);
+            if (frame16) {
+                ((uint16_t *)rx_buffer)[received] = (uint16_t)value;
+            } else {
+                ((uint8_t *)rx_buffer)[received] = (uint8_t)value;
+            }
+            received++;
+        }
+    }
+}
+
+/** Transmit only polled transfer, the receive side is never waited for
+ *
+ * @param spi       The SPI peripheral
+ * @param tx_buffer Data to send, NULL to send SPI_FILL_VALUE
+ * @param len       Number of frames
+ * @param frame16   Non-zero for 16-bit frames
+ */
+static void dev_spi_poll_tx(uint32_t spi, const void *tx_buffer, uint32_t len, int frame16)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        uint32_t value = SPI_FILL_VALUE;
+        if (tx_buffer != NULL) {
+            value = frame16 ? ((const uint16_t *)tx_buffer)[i] : ((const uint8_t *)tx_buffer)[i];
+        }
+        while (0U == (SPI_STAT(spi) & SPI_STAT_TBE));
+        SPI_DATA(spi) = value;
+    }
+    dev_spi_tx_drain(spi);
+}
+
+/** Move a block by DMA when it is long enough and the channels are free, polled otherwise
+ *
+ * @param spiobj    The SPI object
+ * @param tx_buffer Data to send, NULL to send SPI_FILL_VALUE
+ * @param rx_buffer Received data, NULL to only transmit
+ * @param len       Number of frames
+ * @param frame16   Non-zero for 16-bit frames
+ */
+static void dev_spi_block(struct spi_s *spiobj, const void *tx_buffer, void *rx_buffer, uint32_t len, int frame16)
+{
+    const spi_dma_t *dma = dev_spi_dma_get(spiobj->spi);
+    uint32_t size = frame16 ? 2U : 1U;
+
+    if ((len >= SPI_DMA_MIN_LENGTH) && dev_spi_dma_claim(spiobj, dma, rx_buffer != NULL)) {
+        dma_channel_clock_enable(&dma->tx);
+        while (len > 0U) {
+            uint32_t block = (len > SPI_DMA_MAX_LENGTH) ? SPI_DMA_MAX_LENGTH : len;
+
+            dev_spi_dma_block(spiobj->spi, dma, tx_buffer, rx_buffer, block, frame16);
+            if (tx_buffer != NULL) {
+                tx_buffer = (const uint8_t *)tx_buffer + block * size;
+            }
+            if (rx_buffer != NULL) {
+                rx_buffer = (uint8_t *)rx_buffer + block * size;
+            }
+            len -= block;
+        }
+        dev_spi_dma_release(spiobj, dma);
+    } else if (rx_buffer == NULL) {
+        dev_spi_poll_tx(spiobj->spi, tx_buffer, len, frame16);
+    } else {
+        dev_spi_poll_block(spiobj->spi, tx_buffer, rx_buffer, len, frame16);
+    }
+}
+
+/**
+  * @brief Turn the hardware CRC on with a polynomial, or off
+  * @param  obj : pointer to spi_t structure
+  * @param  polynomial : CRC polynomial without the top bit, 0 turns the CRC off
+  * @retval None
+  */
+void spi_master_crc_config(spi_t *obj, uint16_t polynomial)
+{
+    struct spi_s *spiobj = SPI_S(obj);
+    uint32_t ctl0;
+
+    dev_spi_async_wait(spiobj);
+    ctl0 = SPI_CTL0(spiobj->spi);
+    if ((polynomial == 0U) && ((ctl0 & SPI_CTL0_CRCEN) == 0U)) {
+        return;
+    }
+    /* CRCEN may only change while the SPI is disabled, clearing it resets both CRC registers */
+    SPI_CTL0(spiobj->spi) = ctl0 & ~(SPI_CTL0_SPIEN | SPI_CTL0_CRCEN);
+    if (polynomial != 0U) {
+        spi_crc_polynomial_set(spiobj->spi, polynomial);
+        SPI_CTL0(spiobj->spi) = (ctl0 & ~SPI_CTL0_SPIEN) | SPI_CTL0_CRCEN;
+        SPI_CTL0(spiobj->spi) = ctl0 | SPI_CTL0_CRCEN;
+    } else {
+        SPI_CTL0(spiobj->spi) = ctl0 & ~SPI_CTL0_CRCEN;
+    }
+}
+
+/**
+  * @brief Restart the CRC calculation, e.g. at the start of a block
+  * @param  obj : pointer to spi_t structure
+  * @retval None
+  */
+void spi_master_crc_reset(spi_t *obj)
+{
+    struct spi_s *spiobj = SPI_S(obj);
+
+    if (SPI_CTL0(spiobj->spi) & SPI_CTL0_CRCEN) {
+        spi_master_crc_config(obj, spi_crc_polynomial_get(spiobj->spi));
+    }
+}
+
+/**
+  * @brief Read the CRC of the frames moved since the last reset
+  * @param  obj : pointer to spi_t structure
+  * @param  crc : SPI_CRC_RX for the received frames, SPI_CRC_TX for the sent ones
+  * @retval the CRC, 8 or 16 bits wide following the frame size
+  */
+uint16_t spi_master_crc_get(spi_t *obj, uint8_t crc)
+{
+    return spi_crc_get(SPI_S(obj)->spi, crc);
 }
 
 /**
   * @brief This function is implemented by user to send/receive data over
   *         SPI interface
   * @param  obj : pointer to spi_t structure
-  * @param  tx_buffer : tx data to send before reception
-  * @param  rx_buffer : data to receive
+  * @param  tx_buffer : tx data to send before reception, NULL to send 0xFF
+  * @param  rx_buffer : data to receive, NULL to only transmit
   * @param  len : length in byte of the data to send and receive
-  * @retval status of the send operation (0) in case of error
+  * @retval None
+  */
+void spi_master_block_write(spi_t *obj, const uint8_t *tx_buffer, uint8_t *rx_buffer, uint32_t len)
+{
+    struct spi_s *spiobj = SPI_S(obj);
+
+    dev_spi_async_wait(spiobj);
+    (void)dev_spi_frame16_set(spiobj, 0);
+    dev_spi_block(spiobj, tx_buffer, rx_buffer, len, 0);
+    dev_spi_frame_restore(spiobj);
+}
+
+/**
+  * @brief Send/receive 16-bit frames, the bit order of spi_begin() applies to the whole frame
+  * @param  obj : pointer to spi_t structure
+  * @param  tx_buffer : frames to send, NULL to send 0xFFFF
+  * @param  rx_buffer : frames received, NULL to only transmit
+  * @param  len : number of frames
+  * @retval None
+  */
+void spi_master_block_write16(spi_t *obj, const uint16_t *tx_buffer, uint16_t *rx_buffer, uint32_t len)
+{
+    struct spi_s *spiobj = SPI_S(obj);
+
+    dev_spi_async_wait(spiobj);
+    if (dev_spi_frame16_set(spiobj, 1)) {
+        dev_spi_block(spiobj, tx_buffer, rx_buffer, len, 1);
+        dev_spi_frame_restore(spiobj);
+        return;
+    }
+    /* byte pairs in the order a 16-bit frame would go out */
+    for (uint32_t i = 0; i < len; i++) {
+        uint16_t out = (tx_buffer != NULL) ? tx_buffer[i] : 0xFFFFU;
+        uint8_t bytes[2];
+
+        if (spiobj->format & SPI_CTL0_LF) {
+            bytes[0] = (uint8_t)out;
+            bytes[1] = (uint8_t)(out >> 8);
+        } else {
+            bytes[0] = (uint8_t)(out >> 8);
+            bytes[1] = (uint8_t)out;
+        }
+        dev_spi_block(spiobj, bytes, (rx_buffer != NULL) ? bytes : NULL, 2U, 0);
+        if (rx_buffer != NULL) {
+            rx_buffer[i] = (spiobj->format & SPI_CTL0_LF) ? (uint16_t)(bytes[0] | (bytes[1] << 8)) :
+                           (uint16_t)((bytes[0] << 8) | bytes[1]);
+        }
+    }
+}
+
+/** Put up a slave pin
+ *
+ * On the GD32F30x style GPIO the alternate function output would fight the master on the lines the
+ * slave only listens to, so those become floating inputs with the same remap
+ * @param pin   The pin
+ * @param map   Its peripheral map
+ * @param input Non-zero for SCK, MOSI and NSS
+ */
+static void dev_spi_slave_pinout(PinName pin, const PinMap *map, int input)
+{
+#if defined(GD32F30x) || defined(GD32F10x) || defined(GD32E50X)
+    if (input) {
+        uint32_t function = pinmap_find_function(pin, map);
+
+        function = (function & ~((uint32_t)PIN_MODE_MASK << PIN_MODE_SHIFT)) |
+                   ((uint32_t)PIN_MODE_IN_FLOATING << PIN_MODE_SHIFT);
+        pin_function(pin, (int)function);
+        return;
+    }
+#else
+    (void)input;
+#endif
+    pinmap_pinout(pin, map);
+}
+
+/** Get the slave ready for the next frame
+ *
+ * @param spiobj The SPI object
+ */
+static void dev_spi_slave_arm(struct spi_s *spiobj)
+{
+    const spi_dma_t *dma = dev_spi_dma_get(spiobj->spi);
+
+    /* the reset drops whatever the last frame left in the transmit buffer */
+    spi_i2s_deinit(spiobj->spi);
+    spi_init(spiobj->spi, &spiobj->spi_struct);
+    dev_spi_dma_rx_load(spiobj->spi, dma, spiobj->slave_rx_buffer, spiobj->slave_len, 0);
+    /* preloads the first byte, the master clocks the rest out */
+    dev_spi_dma_tx_start(spiobj->spi, dma, spiobj->slave_tx_buffer, spiobj->slave_len, 0);
+    spi_enable(spiobj->spi);
+}
+
+/** NSS rising edge, the master has finished a frame
+ *
+ * @param arg The SPI object
+ */
+static void dev_spi_slave_nss(void *arg)
+{
+    struct spi_s *spiobj = SPI_S(arg);
+    const spi_dma_t *dma = dev_spi_dma_get(spiobj->spi);
+    uint32_t received;
+
+    /* let the receive channel pick up the last byte */
+    while ((SPI_STAT(spiobj->spi) & SPI_STAT_RBNE) && (dma_transfer_number_get(DMA_SPL_ARGS(&dma->rx)) != 0U));
+    received = spiobj->slave_len - dma_transfer_number_get(DMA_SPL_ARGS(&dma->rx));
+    if (received == 0U) {
+        return;
+    }
+    dev_spi_dma_stop(spiobj->spi, dma, 1);
+    if (spiobj->slave_callback != NULL) {
+        spiobj->slave_callback(spiobj->slave_arg, received);
+    }
+    dev_spi_slave_arm(spiobj);
+}
+
+/**
+  * @brief Start slave mode framed by NSS
+  * @param  obj : pointer to spi_t structure, pin_ssel is the NSS input
+  * @param  mode : one of the spi modes
+  * @param  endian : set to 1 for msb first
+  * @param  rx_buffer : frame data received, NULL to drop it
+  * @param  tx_buffer : frame data sent, NULL to send 0xFF
+  * @param  len : buffer length, longer frames are cut off
+  * @param  callback : called at the end of every frame
+  * @param  arg : passed to callback
+  * @retval 1 on success, 0 otherwise
+  */
+int spi_slave_begin(spi_t *obj, uint8_t mode, uint8_t endian, uint8_t *rx_buffer, const uint8_t *tx_buffer,
+                    uint32_t len, spi_slave_callback_t callback, void *arg)
+{
+    struct spi_s *spiobj = SPI_S(obj);
+    const spi_dma_t *dma;
+    uint32_t format;
+
+    dev_spi_async_wait(spiobj);
+    if ((spiobj->pin_ssel == NC) || (len == 0U) || (len > SPI_DMA_MAX_LENGTH)) {
+        return 0;
+    }
+    SPIName spi_data = (SPIName)pinmap_merge(pinmap_peripheral(spiobj->pin_mosi, PinMap_SPI_MOSI),
+                                             pinmap_peripheral(spiobj->pin_miso, PinMap_SPI_MISO));
+    SPIName spi_cntl = (SPIName)pinmap_merge(pinmap_peripheral(spiobj->pin_sclk, PinMap_SPI_SCLK),
+                                             pinmap_peripheral(spiobj->pin_ssel, PinMap_SPI_SSEL));
+    spiobj->spi = (SPIName)pinmap_merge(spi_data, spi_cntl);
+    dma = dev_spi_dma_get(spiobj->spi);
+    format = spi_format_get(obj, 0U, mode, endian);
+    if ((format == SPI_FORMAT_INVALID) || !dev_spi_dma_claim(spiobj, dma, 1)) {
+        return 0;
+    }
+
+    dev_spi_clock_acquire(spiobj->spi);
+    dma_channel_clock_enable(&dma->rx);
+
+    dev_spi_slave_pinout(spiobj->pin_mosi, PinMap_SPI_MOSI, 1);
+    dev_spi_slave_pinout(spiobj->pin_miso, PinMap_SPI_MISO, 0);
+    dev_spi_slave_pinout(spiobj->pin_sclk, PinMap_SPI_SCLK, 1);
+    dev_spi_slave_pinout(spiobj->pin_ssel, PinMap_SPI_SSEL, 1);
+
+    /* the prescaler has no effect on a slave, SCK comes from the master */
+    spiobj->spi_struct.prescale             = format & SPI_CTL0_PSC;
+    spiobj->spi_struct.clock_polarity_phase = format & (SPI_CTL0_CKPL | SPI_CTL0_CKPH);
+    spiobj->spi_struct.endian               = format & SPI_CTL0_LF;
+    spiobj->spi_struct.trans_mode           = SPI_TRANSMODE_FULLDUPLEX;
+    spiobj->spi_struct.device_mode          = SPI_SLAVE;
+    spiobj->spi_struct.frame_size           = SPI_FRAMESIZE_8BIT;
+    spiobj->spi_struct.nss                  = SPI_NSS_HARD;
+    spiobj->format = format;
+
+    spiobj->slave_rx_buffer = rx_buffer;
+    spiobj->slave_tx_buffer = tx_buffer;
+    spiobj->slave_len = len;
+    spiobj->slave_callback = callback;
+    spiobj->slave_arg = arg;
+    dev_spi_slave_arm(spiobj);
+
+    gpio_interrupt_enable_param(GD_PORT_GET(spiobj->pin_ssel), GD_PIN_GET(spiobj->pin_ssel), dev_spi_slave_nss,
+                                spiobj, EXTI_TRIG_RISING);
+    return 1;
+}
+
+/**
+  * @brief Change the slave buffers, they take effect with the next frame
+  * @param  obj : pointer to spi_t structure
+  * @param  rx_buffer : frame data received, NULL to drop it
+  * @param  tx_buffer : frame data sent, NULL to send 0xFF
+  * @param  len : buffer length, 1..65535
+  * @retval None
   */
-void spi_master_block_write(spi_t *obj, uint8_t *tx_buffer, uint8_t *rx_buffer, uint16_t len)
+void spi_slave_buffers_set(spi_t *obj, uint8_t *rx_buffer, const uint8_t *tx_buffer, uint32_t len)
 {
-    for (int i = 0; i < len; i++) {
-        char in = spi_master_write(obj, tx_buffer[i]);
-        rx_buffer[i] = in;
+    struct spi_s *spiobj = SPI_S(obj);
+    uint32_t primask = __get_PRIMASK();
+
+    if ((spiobj->slave_len == 0U) || (len == 0U) || (len > SPI_DMA_MAX_LENGTH)) {
+        return;
     }
+    __disable_irq();
+    spiobj->slave_rx_buffer = rx_buffer;
+    spiobj->slave_tx_buffer = tx_buffer;
+    spiobj->slave_len = len;
+    __set_PRIMASK(primask);
+}
+
+/**
+  * @brief Leave slave mode, no-op if the SPI isn't a slave
+  * @param  obj : pointer to spi_t structure
+  * @retval None
+  */
+void spi_slave_end(spi_t *obj)
+{
+    struct spi_s *spiobj = SPI_S(obj);
+
+    /* slave_len is only non-zero between spi_slave_begin() and here */
+    if (spiobj->slave_len == 0U) {
+        return;
+    }
+    gpio_interrupt_disable(GD_PIN_GET(spiobj->pin_ssel));
+    dev_spi_dma_stop(spiobj->spi, dev_spi_dma_get(spiobj->spi), 1);
+    dev_spi_dma_release(spiobj, dev_spi_dma_get(spiobj->spi));
+    spiobj->slave_callback = NULL;
+    spiobj->slave_len = 0U;
+}
+
+/**
+  * @brief Take IO2/IO3 for quad-SPI transfers
+  * @param  obj : pointer to spi_t structure
+  * @param  io2 : pin for SPI_IO2
+  * @param  io3 : pin for SPI_IO3
+  * @retval 1 on success, 0 if the SPI has no quad mode or the pins don't belong to it
+  */
+int spi_quad_begin(spi_t *obj, PinName io2, PinName io3)
+{
+#if defined(SPI_QCTL)
+    struct spi_s *spiobj = SPI_S(obj);
+
+    /* only SPI0 has the quad mode control register */
+    if ((spiobj->spi != SPI0) || (pinmap_peripheral(io2, PinMap_SPI_IO2) != SPI0) ||
+            (pinmap_peripheral(io3, PinMap_SPI_IO3) != SPI0)) {
+        return 0;
+    }
+    pinmap_pinout(io2, PinMap_SPI_IO2);
+    pinmap_pinout(io3, PinMap_SPI_IO3);
+    spiobj->pin_io2 = io2;
+    spiobj->pin_io3 = io3;
+    return 1;
+#else
+    (void)obj;
+    (void)io2;
+    (void)io3;
+    return 0;
+#endif
+}
+
+/**
+  * @brief Give IO2/IO3 back
+  * @param  obj : pointer to spi_t structure
+  * @retval None
+  */
+void spi_quad_end(spi_t *obj)
+{
+    struct spi_s *spiobj = SPI_S(obj);
+
+    if (spiobj->pin_io2 != NC) {
+        pin_function(spiobj->pin_io2, SPI_PINS_FREE_MODE);
+        pin_function(spiobj->pin_io3, SPI_PINS_FREE_MODE);
+        spiobj->pin_io2 = NC;
+        spiobj->pin_io3 = NC;
+    }
+}
+
+#if defined(SPI_QCTL)
+/** Run one block in quad mode, by DMA when it is long enough
+ *
+ * @param spiobj    The SPI object
+ * @param qctl      SPI_QCTL value for the direction
+ * @param tx_buffer Data to send, NULL when reading
+ * @param rx_buffer Received data, NULL when writing
+ * @param len       Number of bytes
+ */
+static void dev_spi_quad_block(struct spi_s *spiobj, uint32_t qctl, const uint8_t *tx_buffer,
+                               uint8_t *rx_buffer, uint32_t len)
+{
+    dev_spi_async_wait(spiobj);
+    /* quad frames are 8 bits, QMOD may only change while nothing is being sent */
+    (void)dev_spi_frame16_set(spiobj, 0);
+    while (SET == spi_i2s_flag_get(spiobj->spi, SPI_FLAG_TRANS));
+    SPI_QCTL(spiobj->spi) = qctl;
+    dev_spi_block(spiobj, tx_buffer, rx_buffer, len, 0);
+    SPI_QCTL(spiobj->spi) = 0U;
+    dev_spi_frame_restore(spiobj);
+}
+#endif
+
+/**
+  * @brief Read a block over four data lines, each transmitted dummy byte clocks in one byte
+  * @param  obj : pointer to spi_t structure
+  * @param  rx_buffer : data to receive
+  * @param  len : number of bytes
+  * @retval None
+  */
+void spi_master_quad_read(spi_t *obj, uint8_t *rx_buffer, uint32_t len)
+{
+#if defined(SPI_QCTL)
+    struct spi_s *spiobj = SPI_S(obj);
+
+    if (spiobj->pin_io2 != NC) {
+        dev_spi_quad_block(spiobj, SPI_QCTL_QMOD | SPI_QCTL_QRD, NULL, rx_buffer, len);
+        return;
+    }
+#endif
+    spi_master_block_write(obj, NULL, rx_buffer, len);
+}
+
+/**
+  * @brief Write a block over four data lines
+  * @param  obj : pointer to spi_t structure
+  * @param  tx_buffer : data to send
+  * @param  len : number of bytes
+  * @retval None
+  */
+void spi_master_quad_write(spi_t *obj, const uint8_t *tx_buffer, uint32_t len)
+{
+#if defined(SPI_QCTL)
+    struct spi_s *spiobj = SPI_S(obj);
+
+    if (spiobj->pin_io2 != NC) {
+        dev_spi_quad_block(spiobj, SPI_QCTL_QMOD | SPI_QCTL_IO23_DRV, tx_buffer, NULL, len);
+        return;
+    }
+#endif
+    spi_master_block_write(obj, tx_buffer, NULL, len);
 }
 
 #ifdef __cplusplus
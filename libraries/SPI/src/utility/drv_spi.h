@@ -55,6 +55,38 @@ extern "C" {
 #define SPI_CLOCK_DIV128  ((uint32_t)128)
 #define SPI_CLOCK_DIV256  ((uint32_t)256)
 
+/* asynchronous transfers that can be queued at once, shared by all SPIs */
+#ifndef SPI_ASYNC_POOL_SIZE
+#define SPI_ASYNC_POOL_SIZE   8
+#endif
+
+/* spi_format_get() result for an unknown mode, as spi_async_t.format: use the spi_begin() format */
+#define SPI_FORMAT_INVALID    0xFFFFFFFFU
+
+/* format bit for 16-bit frames, added to a spi_format_get() result */
+#define SPI_FORMAT_FRAME16    SPI_CTL0_FF16
+
+typedef void (*spi_async_callback_t)(void *arg);
+/* end of a slave frame, received is the number of bytes clocked in while NSS was low */
+typedef void (*spi_slave_callback_t)(void *arg, uint32_t received);
+
+typedef struct {
+    const uint8_t *tx_buffer;       /* NULL sends 0xFF */
+    uint8_t *rx_buffer;             /* NULL drops the received data */
+    uint32_t len;
+    uint32_t format;                /* from spi_format_get(), SPI_FORMAT_INVALID for the spi_begin() one */
+    uint32_t cs_port;               /* GPIO port of a chip select driven low for the transfer, 0 for none */
+    uint32_t cs_mask;
+    spi_async_callback_t callback;  /* called from the DMA interrupt once the transfer is done */
+    void *arg;
+} spi_async_t;
+
+/* a queued transfer, from the pool of SPI_ASYNC_POOL_SIZE */
+typedef struct spi_async_node {
+    spi_async_t xfer;
+    struct spi_async_node *next;
+} spi_async_node_t;
+
 struct spi_s {
     spi_parameter_struct spi_struct;
     SPIName spi;
@@ -62,14 +94,57 @@ struct spi_s {
     PinName pin_mosi;
     PinName pin_sclk;
     PinName pin_ssel;
+    PinName pin_io2;                /* quad-SPI data lines, NC until spi_quad_begin() */
+    PinName pin_io3;
+    uint32_t format;
+    spi_async_node_t *async_head;   /* the transfer in flight */
+    spi_async_node_t *async_tail;
+    volatile uint8_t async_count;
+    uint32_t async_done;
+    uint8_t *slave_rx_buffer;
+    const uint8_t *slave_tx_buffer;
+    uint32_t slave_len;
+    spi_slave_callback_t slave_callback;
+    void *slave_arg;
 };
 
 typedef struct spi_s spi_t;
 
 void spi_begin(spi_t *obj, uint32_t speed, uint8_t mode, uint8_t endian);
 uint32_t spi_master_write(spi_t *obj, uint8_t value);
-void spi_master_block_write(spi_t *obj, uint8_t *tx_buffer, uint8_t *rx_buffer, uint16_t len);
+/* Blocks of at least SPI_DMA_MIN_LENGTH bytes go by DMA when the channels are free.
+ * tx_buffer NULL sends 0xFF, rx_buffer NULL skips the receive side */
+void spi_master_block_write(spi_t *obj, const uint8_t *tx_buffer, uint8_t *rx_buffer, uint32_t len);
+/* Same with 16-bit frames */
+void spi_master_block_write16(spi_t *obj, const uint16_t *tx_buffer, uint16_t *rx_buffer, uint32_t len);
 uint32_t dev_spi_clock_source_frequency_get(spi_t *obj);
+uint32_t spi_format_get(spi_t *obj, uint32_t speed, uint8_t mode, uint8_t endian);
+/* Change prescaler, mode, bit order and frame size of a running SPI without reinitializing it.
+ * With SPI_FORMAT_FRAME16 the SPI idles in 16-bit frames, byte transfers switch to 8 bits while they run */
+void spi_format_set(spi_t *obj, uint32_t format);
+/* Hardware CRC, polynomial 0 turns it off. crc is SPI_CRC_RX or SPI_CRC_TX */
+void spi_master_crc_config(spi_t *obj, uint16_t polynomial);
+void spi_master_crc_reset(spi_t *obj);
+uint16_t spi_master_crc_get(spi_t *obj, uint8_t crc);
+/* Quad-SPI on SPI0 of GD32F30x/E50x. spi_quad_begin() returns 0 where the SPI or the pins can't do it.
+ * The quad transfers run with 4 data lines and go back to normal SPI when done, so commands and
+ * addresses are sent with the usual calls */
+/* Slave mode framed by the NSS pin (pin_ssel). Every frame is received into rx_buffer and answered
+ * from tx_buffer by DMA, the callback runs from the NSS rising edge interrupt. Returns 0 if the pins,
+ * the DMA channels or len (1..65535) don't allow it. spi_free() ends it */
+int spi_slave_begin(spi_t *obj, uint8_t mode, uint8_t endian, uint8_t *rx_buffer, const uint8_t *tx_buffer,
+                    uint32_t len, spi_slave_callback_t callback, void *arg);
+/* Buffers for the frames after the current one, may be called from the callback */
+void spi_slave_buffers_set(spi_t *obj, uint8_t *rx_buffer, const uint8_t *tx_buffer, uint32_t len);
+void spi_slave_end(spi_t *obj);
+int spi_quad_begin(spi_t *obj, PinName io2, PinName io3);
+void spi_quad_end(spi_t *obj);
+void spi_master_quad_read(spi_t *obj, uint8_t *rx_buffer, uint32_t len);
+void spi_master_quad_write(spi_t *obj, const uint8_t *tx_buffer, uint32_t len);
+/* Queue a DMA transfer and return at once, 0 if the queue is full. Without free DMA channels
+ * the transfer runs before returning. Synchronous calls wait for the queue to drain */
+int spi_master_async_transfer(spi_t *obj, const spi_async_t *xfer);
+uint32_t spi_master_async_pending(spi_t *obj);
 void spi_free(spi_t *obj);
 
 #ifdef __cplusplus
@@ -0,0 +1,29 @@
+/*
+  Blink the LED from a loop of its own while loop() echoes Serial. Both
+  wait without blocking the other: delay() and the serial driver yield
+  to the next task while they wait.
+*/
+#include <Scheduler.h>
+
+void blink()
+{
+    digitalWrite(LED_BUILTIN, HIGH);
+    delay(100);
+    digitalWrite(LED_BUILTIN, LOW);
+    delay(900);
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    pinMode(LED_BUILTIN, OUTPUT);
+    Scheduler.startLoop(blink);
+}
+
+void loop()
+{
+    if (Serial.available()) {
+        Serial.write(Serial.read());
+    }
+    yield();
+}
@@ -0,0 +1,23 @@
+#include "Scheduler.h"
+
+SchedulerClass Scheduler;
+
+static void runTask(void* arg)
+{
+    ((SchedulerTask)arg)();
+}
+
+bool SchedulerClass::startLoop(SchedulerTask task, uint32_t stackSize)
+{
+    return coop_start(runTask, (void*)task, stackSize, 1) != 0;
+}
+
+bool SchedulerClass::start(SchedulerTask task, uint32_t stackSize)
+{
+    return coop_start(runTask, (void*)task, stackSize, 0) != 0;
+}
+
+bool SchedulerClass::start(SchedulerParametricTask task, void* data, uint32_t stackSize)
+{
+    return coop_start(task, data, stackSize, 0) != 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Arduino.h"
+#include "coop.h"
+
+typedef void (*SchedulerTask)(void);
+typedef void (*SchedulerParametricTask)(void*);
+
+/*
+ * Runs loops next to ‘loop’, each on a stack of its own, taking turns
+ * whenever the running one calls ‘yield’ or ‘delay’ or waits on a
+ * peripheral of the core. The API of Arduino's Scheduler library.
+ *
+ *   void blink() { digitalToggle(LED_BUILTIN); delay(250); }
+ *   ...
+ *   Scheduler.startLoop(blink);
+ *
+ * The stacks come from the heap, COOP_STACK_SIZE bytes unless given.
+ * See coop.h for what to look out for.
+ */
+class SchedulerClass
+{
+    public:
+        /* call task over and over, like ‘loop’; false if out of memory */
+        static bool startLoop(SchedulerTask task, uint32_t stackSize = COOP_STACK_SIZE);
+        /* call task once, the stack is freed when it returns */
+        static bool start(SchedulerTask task, uint32_t stackSize = COOP_STACK_SIZE);
+        static bool start(SchedulerParametricTask task, void* data,
+                          uint32_t stackSize = COOP_STACK_SIZE);
+
+        static void yield()
+        {
+            ::yield();
+        }
+        /* tasks running, ‘loop’ included */
+        static uint32_t tasks()
+        {
+            return coop_task_count();
+        }
+};
+
+extern SchedulerClass Scheduler;
@@ -0,0 +1,198 @@
+#include <stdlib.h>
+#include "coop.h"
+#include "critical.h"
+#include "wiring_time_extra.h"
+
+void yield(void);
+
+typedef struct coop_task {
+    uint32_t *sp;                   /* saved stack pointer while switched out */
+    struct coop_task *next;         /* ring of all tasks */
+    coop_task_fn fn;
+    void *arg;
+    uint8_t loop;
+    uint8_t done;                   /* fn returned, unlinked at its next yield() */
+} coop_task_t;
+
+/* loop()'s, on the main stack; the ring holds it alone until a task starts */
+static coop_task_t coop_main = { NULL, &coop_main, NULL, NULL, 1U, 0U };
+static coop_task_t *coop_current = &coop_main;
+/* a task that ended, freed once off its stack */
+static coop_task_t *coop_zombie;
+static uint32_t coop_count = 1U;
+
+/*!
+    \brief      save the callee-saved registers on the stack, switch stacks and restore them
+                from the other one; returns into the other task
+    \param[in]  save: where the stack pointer of the running task goes
+    \param[in]  sp: stack pointer of the task to resume
+    \param[out] none
+    \retval     none
+*/
+__attribute__((naked, noinline)) static void coop_switch(uint32_t **save, uint32_t *sp)
+{
+    /* Thumb-1 only, for the Cortex-M23 of GD32E23x as well */
+    __ASM volatile(
+        "push {r4-r7, lr}\n"
+        "mov r4, r8\n"
+        "mov r5, r9\n"
+        "mov r6, r10\n"
+        "mov r7, r11\n"
+        "push {r4-r7}\n"
+#if defined(__ARM_FP)
+        "vpush {s16-s31}\n"
+#endif
+        "mov r2, sp\n"
+        "str r2, [r0]\n"
+        "mov sp, r1\n"
+#if defined(__ARM_FP)
+        "vpop {s16-s31}\n"
+#endif
+        "pop {r4-r7}\n"
+        "mov r8, r4\n"
+        "mov r9, r5\n"
+        "mov r10, r6\n"
+        "mov r11, r7\n"
+        "pop {r4-r7, pc}\n"
+    );
+}
+
+/*!
+    \brief      free a task that ended, from the stack of another
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void coop_reap(void)
+{
+    if (NULL != coop_zombie) {
+        free(coop_zombie);
+        coop_zombie = NULL;
+    }
+}
+
+/*!
+    \brief      first code a new task runs, what coop_switch() returns into
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void coop_entry(void)
+{
+    coop_task_t *task = coop_current;
+
+    coop_reap();
+    do {
+        task->fn(task->arg);
+        yield();
+    } while (task->loop);
+    task->done = 1U;
+    for (;;) {
+        yield();
+    }
+}
+
+/*!
+    \brief      start a cooperative task
+    \param[in]  fn: task function
+    \param[in]  arg: passed to fn
+    \param[in]  stack_size: stack of the task in bytes
+    \param[in]  loop: non-zero to call fn again every time it returns, 0 to end the task
+    \param[out] none
+    \retval     1 if started, 0 if the heap has no room for the stack
+*/
+uint8_t coop_start(coop_task_fn fn, void *arg, uint32_t stack_size, uint8_t loop)
+{
+    coop_task_t *task;
+    uint32_t *sp;
+    uint32_t frame;
+    uint32_t state;
+
+    stack_size = (stack_size + 7U) & ~7U;
+    task = (coop_task_t *)malloc(sizeof(coop_task_t) + stack_size);
+    if (NULL == task) {
+        return 0U;
+    }
+    task->fn = fn;
+    task->arg = arg;
+    task->loop = loop;
+    task->done = 0U;
+
+    /* what coop_switch() pops: s16-s31, r8-r11, r4-r7 and coop_entry as pc */
+    sp = (uint32_t *)(((uintptr_t)(task + 1) + stack_size) & ~(uintptr_t)7U);
+    *--sp = (uint32_t)coop_entry;
+#if defined(__ARM_FP)
+    frame = 4U + 4U + 16U;
+#else
+    frame = 4U + 4U;
+#endif
+    while (frame-- != 0U) {
+        *--sp = 0U;
+    }
+    task->sp = sp;
+
+    state = critical_enter();
+    task->next = coop_current->next;
+    coop_current->next = task;
+    coop_count++;
+    critical_exit(state);
+    return 1U;
+}
+
+/*!
+    \brief      get the number of tasks
+    \param[in]  none
+    \param[out] none
+    \retval     tasks running, loop() included
+*/
+uint32_t coop_task_count(void)
+{
+    return coop_count;
+}
+
+/*!
+    \brief      switch to the next task, replaces the empty yield() of hooks.c
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void yield(void)
+{
+    coop_task_t *prev = coop_current;
+    coop_task_t *next = prev->next;
+    coop_task_t *task;
+
+    if ((next == prev) || (0U != __get_IPSR()) || (0U != __get_PRIMASK())) {
+        return;
+    }
+#if CRITICAL_HAS_BASEPRI
+    if (0U != __get_BASEPRI()) {
+        return;
+    }
+#endif
+    if (prev->done) {
+        /* out of the ring, its memory is freed from the next task's stack */
+        for (task = next; task->next != prev; task = task->next) {
+        }
+        task->next = next;
+        coop_count--;
+        coop_zombie = prev;
+    }
+    coop_current = next;
+    coop_switch(&prev->sp, next->sp);
+    coop_reap();
+}
+
+/*!
+    \brief      wait in delay(), replaces the WFI of wiring_time.c
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void delay_idle(void)
+{
+    /* with other tasks to run, sleeping until the next tick would hold them up */
+    if (coop_current->next == coop_current) {
+        __WFI();
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef _GD32_COOP_H_
+#define _GD32_COOP_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Cooperative tasks for sketches without an RTOS. Every task has a
+ * stack of its own, taken from the heap, and runs until it calls
+ * yield(); the next task then carries on where it left off, loop()
+ * being one of them. delay() yields, and so do the core's drivers
+ * while they wait on their interrupt (os_event_wait()), so tasks
+ * that wait on time or on the peripherals share the CPU without
+ * further ado. A task that never yields holds up all others.
+ *
+ * yield() only switches from thread mode with interrupts enabled,
+ * never from an interrupt handler or a critical section. A switch
+ * saves the callee-saved registers alone, 36 bytes on the task's
+ * stack (100 with the FPU), but the interrupts that come while a task
+ * runs are stacked there as well. A few hundred bytes do for a task
+ * that calls nothing deep; printf-style formatting wants more.
+ * Nothing detects a stack overflow, size generously.
+ *
+ * Like tasks of an RTOS, two tasks don't use one peripheral at the
+ * same time, a task can be switched out in the middle of a write.
+ *
+ * This library replaces the empty yield() of the core and delay()'s
+ * idle wait once it is included; not for use together with FreeRTOS.
+ */
+#ifndef COOP_STACK_SIZE
+#define COOP_STACK_SIZE     512U
+#endif
+
+typedef void (*coop_task_fn)(void *arg);
+
+/* start a task running fn(arg) on a stack of stack_size bytes, over and over
+   when loop is non-zero, else it ends when fn returns. 0 if out of memory */
+uint8_t coop_start(coop_task_fn fn, void *arg, uint32_t stack_size, uint8_t loop);
+/* tasks running, loop() included */
+uint32_t coop_task_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _GD32_COOP_H_ */
@@ -22,8 +22,6 @@
 #include "HardwareTimer.h"
 
 static servo_t servos[MAX_SERVOS];          // static array of servo structures
-// counter for the servo being pulsed for each timer (or -1 if refresh interval)
-static volatile int8_t timerChannel[_Nbr_16timers] = {-1};
 static HardwareTimer TimerServo(TIMER_SERVO);
 
 uint8_t ServoCount = 0;         // the total number of attached servos
@@ -33,34 +31,98 @@ uint8_t ServoCount = 0;         // the total number of attached servos
 
 #define SERVO_TIMER(_timer_id)  ((timer16_Sequence_t)(_timer_id))
 
+// pulses ending closer together than this end in the same interrupt, the resolution of min/max
+#define SERVO_GROUP_US          4
+
 /************ static functions common to all instances ***********************/
-volatile uint32_t CumulativeCountSinceRefresh = 0;
-// Servo  period callback handle
-static void Servo_PeriodElapsedCallback()
+// The software servos of a frame, by pulse width. All pulses start together at the
+// beginning of the frame and end in this order, so a frame takes one interrupt to
+// start plus one per distinct pulse end.
+static uint8_t frameOrder[SERVOS_PER_TIMER];
+static uint16_t frameEnd[SERVOS_PER_TIMER];     // widths latched at the frame start
+static uint8_t frameCount = 0;
+static uint8_t frameNext = 0;                   // next entry of frameOrder to end
+static uint16_t frameElapsed = 0;               // us since the frame start
+
+// Latch the widths of the active software servos, sorted, and raise their pins
+static void servoFrameStart()
 {
-    timer16_Sequence_t timer_id = _timer1;
+    uint32_t port = 0;
+    uint32_t mask = 0;
 
-    if (timerChannel[timer_id] < 0) {
-        CumulativeCountSinceRefresh = 0;
-    } else {
-        if (timerChannel[timer_id] < ServoCount && servos[timerChannel[timer_id]].Pin.isActive == true) {
-            digitalWrite(servos[timerChannel[timer_id]].Pin.nbr, LOW);
+    frameCount = 0;
+    for (uint8_t i = 0; i < ServoCount && i < SERVOS_PER_TIMER; i++) {
+        if (servos[i].Pin.isActive && !servos[i].Pin.isHardware) {
+            uint16_t width = servos[i].ticks;
+            uint8_t k = frameCount++;
+            // insertion sort, a dozen entries at most
+            while (k > 0 && frameEnd[k - 1] > width) {
+                frameEnd[k] = frameEnd[k - 1];
+                frameOrder[k] = frameOrder[k - 1];
+                k--;
+            }
+            frameEnd[k] = width;
+            frameOrder[k] = i;
         }
     }
-    timerChannel[timer_id]++;
-    if (timerChannel[timer_id] < ServoCount && timerChannel[timer_id] < SERVOS_PER_TIMER) {
-        TimerServo.setReloadValue(servos[timerChannel[timer_id]].ticks);
-        CumulativeCountSinceRefresh += servos[timerChannel[timer_id]].ticks;
-        if (servos[timerChannel[timer_id]].Pin.isActive == true) {
-            digitalWrite(servos[timerChannel[timer_id]].Pin.nbr, HIGH);
+    // one store per run of pins on the same port
+    for (uint8_t k = 0; k < frameCount; k++) {
+        servo_t *servo = &servos[frameOrder[k]];
+        if (servo->port != port) {
+            if (mask != 0) {
+                GPIO_BOP(port) = mask;
+            }
+            port = servo->port;
+            mask = 0;
         }
-    } else {
-        if (CumulativeCountSinceRefresh + 4 < REFRESH_INTERVAL) {
-            TimerServo.setReloadValue(REFRESH_INTERVAL - CumulativeCountSinceRefresh);
-        } else {
-            TimerServo.refresh();
+        mask |= servo->mask;
+    }
+    if (mask != 0) {
+        GPIO_BOP(port) = mask;
+    }
+    frameNext = 0;
+    frameElapsed = 0;
+}
+
+// End every pulse due now or within SERVO_GROUP_US
+static void servoFrameEnd()
+{
+    uint32_t port = 0;
+    uint32_t mask = 0;
+    uint16_t now = frameEnd[frameNext];
+
+    while (frameNext < frameCount && frameEnd[frameNext] <= now + SERVO_GROUP_US) {
+        servo_t *servo = &servos[frameOrder[frameNext++]];
+        if (servo->port != port) {
+            if (mask != 0) {
+                GPIO_BOP(port) = mask << 16;
+            }
+            port = servo->port;
+            mask = 0;
         }
-        timerChannel[timer_id] = -1;
+        mask |= servo->mask;
+    }
+    if (mask != 0) {
+        GPIO_BOP(port) = mask << 16;
+    }
+    frameElapsed = now;
+}
+
+// Servo  period callback handle
+static void Servo_PeriodElapsedCallback()
+{
+    uint16_t next;
+
+    if (frameNext >= frameCount) {
+        servoFrameStart();
+    } else {
+        servoFrameEnd();
+    }
+    next = (frameNext < frameCount) ? frameEnd[frameNext] : REFRESH_INTERVAL;
+    TimerServo.setReloadValue(next - frameElapsed);
+    // a late interrupt may find the counter past the new reload, which would wrap at 65536
+    if (TimerServo.getCounter() + 1 >= (uint32_t)(next - frameElapsed)) {
+        TimerServo.refresh();
     }
 }
 
@@ -78,13 +140,32 @@ static void TimerServoInit()
 static bool isTimerActive()
 {
     for (uint8_t channel = 0; channel < SERVOS_PER_TIMER; channel++) {
-        if (servos[channel].Pin.isActive == true) {
+        if (servos[channel].Pin.isActive == true && !servos[channel].Pin.isHardware) {
             return true;
         }
     }
     return false;
 }
 
+// The counter runs at 1 MHz, so the compare value is the pulse width in us
+static void servoPwmWrite(servo_t *servo)
+{
+    timer_channel_output_pulse_value_config(servo->pwm.timer, servo->pwm.channel, servo->ticks);
+}
+
+// Start a 50 Hz PWM at 1 us per tick on the timer channel of a servo
+static void servoPwmStart(servo_t *servo, PinName pin)
+{
+    pwmPeriodCycle_t periodCycle = {REFRESH_INTERVAL, servo->ticks, FORMAT_US};
+
+    servo->pwm = getTimerDeviceFromPinname(pin);
+    pinmap_pinout(pin, PinMap_PWM);
+    PWM_init(&servo->pwm, &periodCycle);
+    PWM_setPeriodCycle(&servo->pwm, &periodCycle);
+    servoPwmWrite(servo);
+    PWM_start(&servo->pwm);
+}
+
 /********************** class servo function *******************************/
 
 Servo::Servo()
@@ -106,15 +187,26 @@ Servo::Servo()
 uint8_t Servo::attach(int pin, int min, int max)
 {
     if (this->servoIndex < MAX_SERVOS) {
-        pinMode(pin, OUTPUT);                      // set servo pin to output
+        PinName pinname = DIGITAL_TO_PINNAME(pin);
         servos[this->servoIndex].Pin.nbr = pin;
         servos[this->servoIndex].ticks = DEFAULT_PULSE_WIDTH;
         // todo min/max check: abs(min - MIN_PULSE_WIDTH) /4 < 128
         this->min  = (MIN_PULSE_WIDTH - min) / 4; //resolution of min/max is 4 uS
         this->max  = (MAX_PULSE_WIDTH - max) / 4;
-        // initialize the timer if it has not already been initialized
-        if (isTimerActive() == false) {
-            TimerServoInit();
+        if (pinmap_peripheral(pinname, PinMap_PWM) != (uint32_t)NC) {
+            // the timer channel makes the pulses, no interrupts and no jitter
+            servos[this->servoIndex].Pin.isHardware = true;
+            servoPwmStart(&servos[this->servoIndex], pinname);
+        } else {
+            servos[this->servoIndex].Pin.isHardware = false;
+            // resolved once here, the interrupt writes the bit operation register directly
+            servos[this->servoIndex].port = gpio_port[GD_PORT_GET(pinname)];
+            servos[this->servoIndex].mask = 1UL << GD_PIN_GET(pinname);
+            pinMode(pin, OUTPUT);                      // set servo pin to output
+            // initialize the timer if it has not already been initialized
+            if (isTimerActive() == false) {
+                TimerServoInit();
+            }
         }
         servos[this->servoIndex].Pin.isActive = true;  // this must be set after the check for isTimerActive
     }
@@ -124,6 +216,10 @@ uint8_t Servo::attach(int pin, int min, int max)
 void Servo::detach()
 {
     servos[this->servoIndex].Pin.isActive = false;
+    if (servos[this->servoIndex].Pin.isHardware) {
+        PWM_stop(&servos[this->servoIndex].pwm);
+        return;
+    }
 
     if (isTimerActive() == false) {
         TimerServo.stop();
@@ -155,6 +251,10 @@ void Servo::writeMicroseconds(int value)
             value = SERVO_MAX();
         }
         servos[channel].ticks = value;
+        if (servos[channel].Pin.isHardware && servos[channel].Pin.isActive) {
+            // takes effect with the next period, the compare register is shadowed
+            servoPwmWrite(&servos[channel]);
+        }
     }
 }
 
@@ -44,11 +44,15 @@ typedef enum {
 typedef struct {
     uint8_t nbr;            // a pin number from 0 to 255
     uint8_t isActive;       // true if this channel is enabled, pin not pulsed if false
+    uint8_t isHardware;     // true if a timer channel generates the pulses, see pwm
 } ServoPin_t;
 
 typedef struct {
     ServoPin_t Pin;
     volatile unsigned int ticks;
+    pwmDevice_t pwm;        // timer channel of the pin, if it is in PinMap_PWM
+    uint32_t port;          // GPIOx of the pin otherwise
+    uint32_t mask;          // bit of the pin in GPIOx
 } servo_t;
 
 /** Class for interfacing with RC servomotors. */
@@ -29,8 +29,14 @@ The latest version of this library can always be found at
 http://arduiniana.org.
 */
 #include "SoftwareSerial.h"
+#include "os_event.h"
 
-#define OVERSAMPLE 3 // in RX, Timer will generate interruption OVERSAMPLE time during a bit. Thus OVERSAMPLE ticks in a bit. (interrupt not synchonized with edge).
+#define OVERSAMPLE 3 // Timer will generate interruption OVERSAMPLE time during a bit. Thus OVERSAMPLE ticks in a bit.
+
+// A TX pin with a timer channel is driven by that timer instead: its update events DMA
+// precomputed GPIO_BOP words, one per bit, so the waveform does not depend on interrupts.
+// The timer only runs while a byte is sent or received. An idle receiver waits for the
+// edge of the start bit on the EXTI line of its RX pin, which is masked again for the frame.
 
 //#define TIMER_SERIAL TIMER1    TIMER1 timer1 is occupied
 
@@ -65,16 +71,15 @@ http://arduiniana.org.
 #endif
 
 HardwareTimer SoftwareSerial::timer(TIMER_SERIAL);
-SoftwareSerial *SoftwareSerial::active_listener = nullptr;
+SoftwareSerial *volatile SoftwareSerial::listeners[_SS_MAX_LISTENERS] = {nullptr};
+volatile uint8_t SoftwareSerial::listener_count = 0;
 SoftwareSerial *volatile SoftwareSerial::active_out = nullptr;
-SoftwareSerial *volatile SoftwareSerial::active_in = nullptr;
 int32_t SoftwareSerial::tx_tick_cnt = 0; // OVERSAMPLE ticks needed for a bit
-int32_t volatile SoftwareSerial::rx_tick_cnt = 0;  // OVERSAMPLE ticks needed for a bit
 uint32_t SoftwareSerial::tx_buffer = 0;
 int32_t SoftwareSerial::tx_bit_cnt = 0;
-uint32_t SoftwareSerial::rx_buffer = 0;
-int32_t SoftwareSerial::rx_bit_cnt = -1; // rx_bit_cnt = -1 :  waiting for start bit
 uint32_t SoftwareSerial::cur_speed = 0;
+uint32_t SoftwareSerial::tick_reload = 0;
+volatile bool SoftwareSerial::timer_running = false;
 
 SoftwareSerial::SoftwareSerial(uint16_t receivePin, uint16_t transmitPin,
                                bool inverse_logic /* = false */)
@@ -85,16 +90,21 @@ SoftwareSerial::SoftwareSerial(uint16_t receivePin, uint16_t transmitPin,
     _receivePinPort = DIGITAL_PIN_TO_PORT((receivePin));
     _receivePinNumber = gpio_pin[GD_PIN_GET(DIGITAL_TO_PINNAME(receivePin))];
     _transmitPinNumber = gpio_pin[GD_PIN_GET(DIGITAL_TO_PINNAME(transmitPin))];
+    _receiveExtiLine = BIT(GD_PIN_GET(DIGITAL_TO_PINNAME(receivePin)));
+    _txTimer = 0;
+    _rx_tick_cnt = 0;
+    _rx_bit_cnt = -1;
+    _rx_buffer = 0;
     _speed = 0;
     _buffer_overflow = false;
     _inverse_logic = inverse_logic;
-    _output_pending = 0;
 }
 
 void SoftwareSerial::setSpeed(uint32_t speed)
 {
     if (speed != cur_speed) {
         timer.stop();
+        timer_running = false;
         if (speed != 0) {
             // Disable the timer
             uint32_t clock_rate, cmp_value;
@@ -111,11 +121,10 @@ void SoftwareSerial::setSpeed(uint32_t speed)
             } while (cmp_value >= UINT16_MAX);
             timer.setPrescaler(pre);
             timer.setReloadValue(cmp_value);
-            timer.setCounter(0);
+            tick_reload = cmp_value;
 
+            // started by the first start bit or write()
             timer.attachInterrupt(&handleInterrupt);
-            timer.start();
-            timer.refresh();
         } else {
             timer.detachInterrupt();
         }
@@ -123,21 +132,51 @@ void SoftwareSerial::setSpeed(uint32_t speed)
     }
 }
 
-// This function sets the current object as the "listening"
-// one and returns true if it replaces another
-bool SoftwareSerial::listen()
+// This function sets the current object as the "listening" one, or with exclusive
+// false one of several listening at the same speed, and returns true if it was not
+// listening before
+bool SoftwareSerial::listen(bool exclusive)
 {
-    if (active_listener != this) {
-        // wait for any transmit to complete as we may change speed
-        while (active_out);
-        active_listener->stopListening();
-        rx_tick_cnt =
-            1; // 1 : next interrupt will decrease rx_tick_cnt to 0 which means RX pin level will be considered.
-        rx_bit_cnt = -1; // rx_bit_cnt = -1 :  waiting for start bit
-        setSpeed(_speed);
-        active_listener = this;
-        active_in = this;
-        return true;
+    if (exclusive) {
+        // stop everybody else, from the end as stopListening() closes the gap
+        for (uint8_t i = listener_count; i > 0; i--) {
+            if (listeners[i - 1] != this) {
+                listeners[i - 1]->stopListening();
+            }
+        }
+    } else if (!isListening()) {
+        // the timer ticks at one speed, and each pin number has one EXTI line
+        if (listener_count >= _SS_MAX_LISTENERS || (listener_count > 0 && _speed != cur_speed)) {
+            return false;
+        }
+        for (uint8_t i = 0; i < listener_count; i++) {
+            if (listeners[i]->_receiveExtiLine == _receiveExtiLine) {
+                return false;
+            }
+        }
+    }
+    if (isListening()) {
+        return false;
+    }
+    // wait for any transmit to complete as we may change speed
+    while (active_out) {
+        os_event_wait();
+    }
+    _rx_bit_cnt = -1; // _rx_bit_cnt = -1 :  waiting for start bit
+    setSpeed(_speed);
+    noInterrupts();
+    listeners[listener_count++] = this;
+    interrupts();
+    attachInterruptParam(_receivePin, &handleStartBit, _inverse_logic ? RISING : FALLING, this);
+    return true;
+}
+
+bool SoftwareSerial::isListening()
+{
+    for (uint8_t i = 0; i < listener_count; i++) {
+        if (listeners[i] == this) {
+            return true;
+        }
     }
     return false;
 }
@@ -145,13 +184,26 @@ bool SoftwareSerial::listen()
 // Stop listening. Returns true if we were actually listening.
 bool SoftwareSerial::stopListening()
 {
-    if (active_listener == this) {
+    if (isListening()) {
         // wait for any output to complete
-        while (active_out);
-        active_listener = nullptr;
-        active_in = nullptr;
+        while (active_out) {
+            os_event_wait();
+        }
+        detachInterrupt(_receivePin);
+        exti_interrupt_disable((exti_line_enum)_receiveExtiLine);
+        noInterrupts();
+        for (uint8_t i = 0, j = 0; i < listener_count; i++) {
+            if (listeners[i] != this) {
+                listeners[j++] = listeners[i];
+            }
+        }
+        listener_count--;
+        _rx_bit_cnt = -1;
+        interrupts();
         // turn off ints
-        setSpeed(0);
+        if (listener_count == 0) {
+            setSpeed(0);
+        }
         return true;
     }
     return false;
@@ -172,24 +224,110 @@ inline void SoftwareSerial::send()
             tx_buffer >>= 1;
             tx_tick_cnt = OVERSAMPLE; // Wait OVERSAMPLE tick to send next bit
         } else { // Transmission finished
-            tx_tick_cnt = 1;
-            if (_output_pending) {
-                active_out = nullptr;
-            }
+            active_out = nullptr;
+            os_event_signal();
         }
     }
 }
 
+// Called with interrupts disabled. from_edge: the first tick is half a tick away, otherwise a whole one
+void SoftwareSerial::startTimer(bool from_edge)
+{
+    if (!timer_running) {
+        timer.setCounter(from_edge ? tick_reload / 2 + 1 : 1);
+        timer.start();
+        timer_running = true;
+    }
+}
+
 inline void SoftwareSerial::handleInterrupt()
 {
-    if (active_in) {
-        active_in->recv();
+    SoftwareSerial *out = active_out;
+    bool receiving = false;
+
+    // every listener has its own bit state machine, sampled from the same tick
+    for (uint8_t i = 0; i < listener_count; i++) {
+        SoftwareSerial *in = listeners[i];
+        in->recv();
+        receiving |= (in->_rx_bit_cnt != -1);
+    }
+    if (out && out->_txTimer == 0) {
+        out->send();
     }
-    if (active_out) {
-        active_out->send();
+    out = active_out;
+    if ((!out || out->_txTimer != 0) && !receiving) {
+        // nothing left to time until the next start bit or write()
+        timer.stop();
+        timer_running = false;
     }
 }
 
+// Run the timer of the TX pin at the bit rate, stopped until write()
+void SoftwareSerial::txTimerInit(uint32_t txTimer)
+{
+    timer_parameter_struct timer_initpara;
+    uint32_t clock_rate = getTimerClkFrequency(txTimer);
+    uint32_t pre = 1;
+    uint32_t period;
+
+    if (txTimer == TIMER_SERIAL || _speed == 0) {
+        return;
+    }
+    // round to the nearest tick, the prescaler only grows until the period fits 16 bits
+    while ((period = (clock_rate / pre + _speed / 2) / _speed) > 0x10000U) {
+        pre *= 2;
+    }
+    if (period < 2) {
+        return;
+    }
+    timer_clock_enable(txTimer);
+    timer_deinit(txTimer);
+    timer_initpara.prescaler = pre - 1;
+    timer_initpara.period = period - 1;
+    timer_initpara.repetitioncounter = 0;
+    timer_initpara.alignedmode = TIMER_COUNTER_EDGE;
+    timer_initpara.counterdirection = TIMER_COUNTER_UP;
+    timer_initpara.clockdivision = TIMER_CKDIV_DIV1;
+    timer_init(txTimer, &timer_initpara);
+    _txTimer = txTimer;
+}
+
+// DMA interrupt, the last word went out at the end of the stop bit
+void SoftwareSerial::txDmaDone(void *arg, uint32_t flags)
+{
+    SoftwareSerial *self = (SoftwareSerial *)arg;
+
+    if (flags & DMA_CALLBACK_FLAG_FTF) {
+        timer_disable(self->_txTimer);
+        Timer_updateDmaStop(self->_txTimer);
+        active_out = nullptr;
+        os_event_signal();
+    }
+}
+
+// EXTI edge of a start bit
+void SoftwareSerial::handleStartBit(void *arg)
+{
+    SoftwareSerial *in = (SoftwareSerial *)arg;
+
+    if (in->_rx_bit_cnt != -1) {
+        return;
+    }
+    noInterrupts();
+    exti_interrupt_disable((exti_line_enum)in->_receiveExtiLine);
+    in->_rx_bit_cnt = 0; // _rx_bit_cnt == 0 : start bit received
+    in->_rx_buffer = 0;
+    if (timer_running) {
+        // ticks keep the phase of the transmitter or another receiver, the first one comes within a tick
+        in->_rx_tick_cnt = OVERSAMPLE + 1;
+    } else {
+        // ticks at 1/2, 3/2, 5/2 ... of a tick after the edge, the 5th one is in the middle of bit 0
+        in->_rx_tick_cnt = OVERSAMPLE + 2;
+        startTimer(true);
+    }
+    interrupts();
+}
+
 SoftwareSerial::~SoftwareSerial()
 {
     end();
@@ -213,6 +351,11 @@ void SoftwareSerial::begin(long speed)
     }
     pinMode(_transmitPin, OUTPUT);
     pinMode(_receivePin, _inverse_logic ? INPUT_PULLDOWN : INPUT_PULLUP);
+    _txTimer = 0;
+    if (pinmap_peripheral(DIGITAL_TO_PINNAME(_transmitPin), PinMap_PWM) != (uint32_t)NC) {
+        // only the timer is used, the pin stays a GPIO output
+        txTimerInit(getTimerDeviceFromPinname(DIGITAL_TO_PINNAME(_transmitPin)).timer);
+    }
     listen();
 }
 
@@ -224,8 +367,33 @@ void SoftwareSerial::end()
 size_t SoftwareSerial::write(uint8_t b)
 {
     // wait for previous transmit to complete
-    _output_pending = 1;
-    while (active_out);
+    while (active_out) {
+        os_event_wait();
+    }
+    if (_txTimer != 0) {
+        // start bit, 8 data bits and the stop bit twice: the DMA is done once it has lasted a bit
+        uint32_t frame = b << 1 | 0x600;
+        if (_inverse_logic) {
+            frame = ~frame;
+        }
+        for (uint8_t i = 0; i < 11; i++) {
+            _txBits[i] = (frame & (1U << i)) ? _transmitPinNumber : _transmitPinNumber << 16;
+        }
+        active_out = this;
+        // each update writes the level of the next bit, the start bit is written here
+        if (Timer_updateDmaStart(_txTimer, (uint32_t)&GPIO_BOP(_transmitPinPort), &_txBits[1], 10, 0,
+                                 txDmaDone, this)) {
+            noInterrupts();
+            timer_counter_value_config(_txTimer, 0);
+            GPIO_BOP(_transmitPinPort) = _txBits[0];
+            timer_enable(_txTimer);
+            interrupts();
+            return 1;
+        }
+        // no update DMA request on this timer
+        _txTimer = 0;
+        active_out = nullptr;
+    }
     // add start and stop bits.
     tx_buffer = b << 1 | 0x200;
     if (_inverse_logic) {
@@ -234,86 +402,62 @@ size_t SoftwareSerial::write(uint8_t b)
     tx_bit_cnt = 0;
     tx_tick_cnt = OVERSAMPLE;
     setSpeed(_speed);
-    _output_pending = 0;
     // make us active
+    noInterrupts();
     active_out = this;
+    startTimer(false);
+    interrupts();
     return 1;
 }
 
 // Read data from buffer
 int SoftwareSerial::read()
 {
-    // Empty buffer?
-    if (_receive_buffer.head == _receive_buffer.tail) {
-        return -1;
-    } else {
-        // Read from "head"
-        uint8_t c = _receive_buffer.buffer[_receive_buffer.head]; // grab next byte
-        _receive_buffer.head = (_receive_buffer.head + 1) % _SS_MAX_RX_BUFF;
-        return c;
-    }
+    return _receive_buffer.pop();
 }
 
 int SoftwareSerial::available()
 {
-    return (_receive_buffer.tail + _SS_MAX_RX_BUFF - _receive_buffer.head) % _SS_MAX_RX_BUFF;
+    return _receive_buffer.available();
 }
 
 void SoftwareSerial::flush()
 {
-    noInterrupts();
-    _receive_buffer.head = _receive_buffer.tail = 0;
-    interrupts();
+    _receive_buffer.clear();
 }
 
 int SoftwareSerial::peek(void)
 {
-    if (_receive_buffer.head == _receive_buffer.tail) {
-        return -1;
-    } else {
-        return _receive_buffer.buffer[_receive_buffer.head];
-    }
+    return _receive_buffer.peek();
 }
 
 inline void SoftwareSerial::recv()
 {
-    if (--rx_tick_cnt <=
-        0) {  // if rx_tick_cnt > 0 interrupt is discarded. Only when rx_tick_cnt reach 0 RX pin is considered
+    if (_rx_bit_cnt == -1) {  // _rx_bit_cnt = -1 :  waiting for start bit, on the EXTI line
+        return;
+    }
+    if (--_rx_tick_cnt <=
+        0) {  // if _rx_tick_cnt > 0 interrupt is discarded. Only when _rx_tick_cnt reach 0 RX pin is considered
         bool inbit = gpio_input_bit_get(_receivePinPort, _receivePinNumber) ^ _inverse_logic;
-        if (rx_bit_cnt == -1) {  // rx_bit_cnt = -1 :  waiting for start bit
-            if (!inbit) {
-                // got start bit
-                rx_bit_cnt = 0; // rx_bit_cnt == 0 : start bit received
-                rx_tick_cnt = OVERSAMPLE +
-                              1; // Wait 1 bit (OVERSAMPLE ticks) + 1 tick in order to sample RX pin in the middle of the edge (and not too close to the edge)
-                rx_buffer = 0;
-            } else {
-                rx_tick_cnt =
-                    1; // Waiting for start bit, but we don't get right level. Wait for next Interrupt to check RX pin level
-            }
-        } else if (rx_bit_cnt >= 8) { // rx_bit_cnt >= 8 : waiting for stop bit
+        if (_rx_bit_cnt >= 8) { // _rx_bit_cnt >= 8 : waiting for stop bit
             if (inbit) {
                 // stop bit read complete add to buffer
-                uint8_t next = (_receive_buffer.tail + 1) % _SS_MAX_RX_BUFF;
-                if (next != _receive_buffer.head) {
-                    // save new data in buffer: tail points to where byte goes
-                    _receive_buffer.buffer[_receive_buffer.tail] = rx_buffer; // save new byte
-                    _receive_buffer.tail = next;
-                } else { // rx_bit_cnt = x  with x = [0..7] correspond to new bit x received
+                if (!_receive_buffer.push(_rx_buffer)) {
                     _buffer_overflow = true;
                 }
             }
-            // Full frame received. Restart waiting for start bit at next interrupt
-            rx_tick_cnt = 1;
-            rx_bit_cnt = -1;
+            // Full frame received. Edges of the data bits latched the line, only the next one counts
+            _rx_bit_cnt = -1;
+            exti_interrupt_flag_clear((exti_line_enum)_receiveExtiLine);
+            exti_interrupt_enable((exti_line_enum)_receiveExtiLine);
         } else {
             // data bits
-            rx_buffer >>= 1;
+            _rx_buffer >>= 1;
             if (inbit) {
-                rx_buffer |= 0x80;
+                _rx_buffer |= 0x80;
             }
-            rx_bit_cnt++; // Prepare for next bit
-            rx_tick_cnt = OVERSAMPLE; // Wait OVERSAMPLE ticks before sampling next bit
+            _rx_bit_cnt++; // Prepare for next bit
+            _rx_tick_cnt = OVERSAMPLE; // Wait OVERSAMPLE ticks before sampling next bit
         }
     }
 }
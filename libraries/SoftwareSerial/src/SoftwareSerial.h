@@ -40,18 +40,16 @@
 //}
 #include <Arduino.h>
 #include <Stream.h>
+#include <RingBuffer.h>
 /******************************************************************************
 * Definitions
 ******************************************************************************/
 #ifndef _SS_MAX_RX_BUFF
-#define _SS_MAX_RX_BUFF 64 // RX buffer size
+#define _SS_MAX_RX_BUFF 64 // RX buffer size, a power of two
+#endif
+#ifndef _SS_MAX_LISTENERS
+#define _SS_MAX_LISTENERS 4 // ports receiving at the same time, see listen(false)
 #endif
-
-typedef struct {
-    unsigned char buffer[_SS_MAX_RX_BUFF];
-    volatile uint8_t head;
-    volatile uint8_t tail;
-} receive_buffer;
 
 class SoftwareSerial : public Stream
 {
@@ -63,48 +61,49 @@ class SoftwareSerial : public Stream
         uint32_t _receivePinNumber;
         uint32_t _transmitPinPort;
         uint32_t _transmitPinNumber;
+        uint32_t _receiveExtiLine;
+        uint32_t _txTimer;          // timer of the TX pin when its update DMA sends, 0 otherwise
+        uint32_t _txBits[11];       // GPIO_BOP word of each bit of the byte being sent
         uint32_t _speed;
 
         uint16_t _buffer_overflow: 1;
         uint16_t _inverse_logic: 1;
-        uint16_t _output_pending: 1;
-
-        receive_buffer _receive_buffer;
 
-        //unsigned char _receive_buffer[_SS_MAX_RX_BUFF];
-        //volatile uint8_t _receive_buffer_tail;
-        //volatile uint8_t _receive_buffer_head;
+        arduino::SPSCRingBufferN<_SS_MAX_RX_BUFF> _receive_buffer;  // filled by the timer interrupt
+        int32_t _rx_tick_cnt;
+        volatile int32_t _rx_bit_cnt;
+        uint32_t _rx_buffer;
 
         // static data
         static HardwareTimer timer;
-        static SoftwareSerial *active_listener;
+        static SoftwareSerial *volatile listeners[_SS_MAX_LISTENERS];
+        static volatile uint8_t listener_count;
         static SoftwareSerial *volatile active_out;
-        static SoftwareSerial *volatile active_in;
         static int32_t tx_tick_cnt;
-        static volatile int32_t rx_tick_cnt;
         static uint32_t tx_buffer;
         static int32_t tx_bit_cnt;
-        static uint32_t rx_buffer;
-        static int32_t rx_bit_cnt;
         static uint32_t cur_speed;
+        static uint32_t tick_reload;
+        static volatile bool timer_running;
 
         // private methods
         void send();
         void recv();
         void setSpeed(uint32_t speed);
+        static void startTimer(bool from_edge);
         static void handleInterrupt();
+        static void handleStartBit(void *arg);
+        void txTimerInit(uint32_t txTimer);
+        static void txDmaDone(void *arg, uint32_t flags);
 
     public:
         // public methods
         SoftwareSerial(uint16_t receivePin, uint16_t transmitPin, bool inverse_logic = false);
         virtual ~SoftwareSerial();
         void begin(long speed);
-        bool listen();
+        bool listen(bool exclusive = true);     // false: receive alongside the other listeners
         void end();
-        bool isListening()
-        {
-            return active_listener == this;
-        }
+        bool isListening();
         bool stopListening();
         bool overflow()
         {
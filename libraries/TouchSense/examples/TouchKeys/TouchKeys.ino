@@ -0,0 +1,53 @@
+/*
+  Touch keys
+
+  Three keys on TSI group 1: electrodes on PA4, PA5 and PA6 through 10k
+  resistors, and a 10 nF sampling capacitor from PA7 to ground. The TSI
+  scans them in the background; the sketch lights the LED while any key
+  is touched and prints each change together with the counts.
+
+  Keep the keys untouched while begin() calibrates.
+*/
+
+#include <TouchSense.h>
+
+int keys[3];
+volatile bool changed = false;
+
+void touchChanged(uint32_t touched)
+{
+    (void)touched;
+    changed = true;
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    pinMode(LED_BUILTIN, OUTPUT);
+
+    keys[0] = TouchSense.addKey(PA4, PA7);
+    keys[1] = TouchSense.addKey(PA5, PA7);
+    keys[2] = TouchSense.addKey(PA6, PA7);
+    TouchSense.onChange(touchChanged);
+    if (!TouchSense.begin()) {
+        Serial.println("no acquisitions, check the sampling capacitor");
+        while (1);
+    }
+}
+
+void loop()
+{
+    digitalWrite(LED_BUILTIN, TouchSense.touchedMask() != 0 ? HIGH : LOW);
+
+    if (changed) {
+        changed = false;
+        for (int i = 0; i < 3; i++) {
+            Serial.print(TouchSense.touched(keys[i]) ? "[X] " : "[ ] ");
+            Serial.print(TouchSense.read(keys[i]));
+            Serial.print('/');
+            Serial.print(TouchSense.baseline(keys[i]));
+            Serial.print("  ");
+        }
+        Serial.println();
+    }
+}
@@ -0,0 +1,514 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "TouchSense.h"
+
+#if defined(GD32F3x0) || defined(GD32F1x0)
+
+/* the charge transfer clock, the fastest HCLK divides down to that stays below it */
+#ifndef TOUCH_CTCLK_MAX
+#define TOUCH_CTCLK_MAX         8000000U
+#endif
+/* time the idle pins, driven low, take to empty the sampling capacitors between acquisitions */
+#ifndef TOUCH_DISCHARGE_US
+#define TOUCH_DISCHARGE_US      5U
+#endif
+
+#if defined(GD32F1x0)
+#define TOUCH_CTCDIV(n)         CTL_CTCDIV(n)
+#else
+#define TOUCH_CTCDIV(n)         (n)
+#endif
+
+#define TOUCH_PIN_BIT(g, io)    (1UL << ((g) * 4U + (io)))
+/* counts of an acquisition that hit the max cycle number */
+#define TOUCH_COUNT_MAX         8191U
+#define TOUCH_CYCN(g)           REG32(TSI + 0x00000034U + 4U * (g))
+
+TouchSenseClass TouchSense;
+
+/* TSI pins of the groups, alternate function 3 */
+static const PinName touchPins[TOUCH_GROUPS][4] = {
+    {PORTA_0,  PORTA_1,  PORTA_2,  PORTA_3},
+    {PORTA_4,  PORTA_5,  PORTA_6,  PORTA_7},
+    {PORTC_5,  PORTB_0,  PORTB_1,  PORTB_2},
+    {PORTA_9,  PORTA_10, PORTA_11, PORTA_12},
+    {PORTB_3,  PORTB_4,  PORTB_6,  PORTB_7},
+    {PORTB_11, PORTB_12, PORTB_13, PORTB_14},
+};
+
+/* group and pin in the group of a TSI pin */
+static bool touchPinFind(PinName pin, uint8_t *group, uint8_t *io)
+{
+    uint8_t g, i;
+
+    for (g = 0U; g < TOUCH_GROUPS; g++) {
+        for (i = 0U; i < 4U; i++) {
+            if (touchPins[g][i] == pin) {
+                *group = g;
+                *io = i;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/*!
+    \brief      TouchSenseClass object construct
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+TouchSenseClass::TouchSenseClass(void)
+{
+    uint8_t g;
+
+    for (g = 0U; g < TOUCH_GROUPS; g++) {
+        this->samplePins[g] = NC;
+        this->groupKeys[g] = 0;
+    }
+    this->keyCount = 0;
+    this->rounds = 0;
+    this->round = 0;
+    this->calibrating = 0;
+    this->running = false;
+    this->touchedKeys = 0;
+    this->scanCount = 0;
+    this->errorCount = 0;
+    this->callback = NULL;
+}
+
+/*!
+    \brief      add a key, before begin()
+    \param[in]  pin: TSI pin wired to the electrode
+    \param[in]  samplePin: TSI pin of the same group wired to the sampling capacitor,
+                the same for all keys of a group
+    \param[in]  threshold: drop in count that means touched, 0 for 1/16 of the baseline
+    \param[out] none
+    \retval     the key, -1 if the pins don't fit or TSI is running
+*/
+int TouchSenseClass::addKey(uint32_t pin, uint32_t samplePin, uint16_t threshold)
+{
+    PinName keyPin = DIGITAL_TO_PINNAME(pin);
+    PinName sample = DIGITAL_TO_PINNAME(samplePin);
+    uint8_t group, io, sampleGroup, sampleIo, k;
+    TouchKey *key;
+
+    if (this->running || (this->keyCount >= TOUCH_MAX_KEYS)) {
+        return -1;
+    }
+    if (!touchPinFind(keyPin, &group, &io) || !touchPinFind(sample, &sampleGroup, &sampleIo)
+            || (group != sampleGroup) || (io == sampleIo)) {
+        return -1;
+    }
+    if ((this->samplePins[group] != NC) && (this->samplePins[group] != sample)) {
+        return -1;
+    }
+    for (k = 0U; k < this->keyCount; k++) {
+        if (this->keys[k].pin == keyPin) {
+            return -1;
+        }
+    }
+    this->samplePins[group] = sample;
+
+    key = &this->keys[this->keyCount];
+    key->pin = keyPin;
+    key->group = group;
+    key->io = io;
+    key->round = this->groupKeys[group]++;
+    key->touched = false;
+    key->count = 0;
+    key->threshold = threshold;
+    key->baseline = 0;
+    key->sum = 0;
+    if (this->groupKeys[group] > this->rounds) {
+        this->rounds = this->groupKeys[group];
+    }
+    return this->keyCount++;
+}
+
+/*!
+    \brief      set up the TSI and scan continuously, the first scans calibrate; keys must
+                not be touched until it returns
+    \param[in]  none
+    \param[out] none
+    \retval     false if no key was added or the calibration scans didn't end
+*/
+bool TouchSenseClass::begin(void)
+{
+    uint32_t hclk = rcu_clock_freq_get(CK_AHB);
+    uint32_t div = 0U;
+    uint32_t samples = 0U;
+    uint32_t pins = 0U;
+    uint8_t g, k;
+
+    if (this->keyCount == 0U) {
+        return false;
+    }
+    if (this->running) {
+        end();
+    }
+    while (((hclk >> div) > TOUCH_CTCLK_MAX) && (div < 7U)) {
+        div++;
+    }
+
+    rcu_periph_clock_enable(RCU_TSI);
+    tsi_deinit();
+    /* acquisitions start by software after the reset */
+    tsi_init(TOUCH_CTCDIV(div), TSI_CHARGE_2CTCLK, TSI_TRANSFER_2CTCLK, TSI_MAXNUM8191);
+    tsi_pin_mode_config(TSI_OUTPUT_LOW);
+
+    for (g = 0U; g < TOUCH_GROUPS; g++) {
+        uint8_t sampleGroup, sampleIo;
+
+        if (this->samplePins[g] == NC) {
+            continue;
+        }
+        touchPinFind(this->samplePins[g], &sampleGroup, &sampleIo);
+        samples |= TOUCH_PIN_BIT(g, sampleIo);
+        pin_function(this->samplePins[g], GD_PIN_FUNCTION4(PIN_MODE_AF, PIN_OTYPE_OD, PIN_PUPD_NONE, GPIO_AF_3));
+    }
+    for (k = 0U; k < this->keyCount; k++) {
+        pins |= TOUCH_PIN_BIT(this->keys[k].group, this->keys[k].io);
+        this->keys[k].touched = false;
+        pin_function(this->keys[k].pin, GD_PIN_FUNCTION4(PIN_MODE_AF, PIN_OTYPE_PP, PIN_PUPD_NONE, GPIO_AF_3));
+    }
+    /* the Schmitt triggers would only draw current on the slowly rising sample pins */
+    tsi_hysteresis_off(samples | pins);
+    tsi_sample_pin_enable(samples);
+    tsi_enable();
+
+    this->touchedKeys = 0;
+    this->scanCount = 0;
+    this->errorCount = 0;
+    this->round = 0;
+    this->calibrating = TOUCH_CALIBRATION_SCANS;
+    this->running = true;
+
+    TSI_INTC = TSI_INTC_CCTCF | TSI_INTC_CMNERR;
+    TSI_INTEN = TSI_INTEN_CTCFIE | TSI_INTEN_MNERRIE;
+    irq_priority_enable(TSI_IRQn, IRQ_PRIO_TSI);
+    startRound();
+    return waitCalibration();
+}
+
+/*!
+    \brief      stop scanning and release the pins
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void TouchSenseClass::end(void)
+{
+    uint8_t g, k;
+
+    if (!this->running) {
+        return;
+    }
+    this->running = false;
+    nvic_irq_disable(TSI_IRQn);
+    TSI_INTEN = 0U;
+    tsi_software_stop();
+    tsi_deinit();
+    rcu_periph_clock_disable(RCU_TSI);
+    for (g = 0U; g < TOUCH_GROUPS; g++) {
+        if (this->samplePins[g] != NC) {
+            pin_function(this->samplePins[g], GD_PIN_FUNCTION4(PIN_MODE_INPUT, PIN_OTYPE_PP, PIN_PUPD_NONE, 0));
+        }
+    }
+    for (k = 0U; k < this->keyCount; k++) {
+        pin_function(this->keys[k].pin, GD_PIN_FUNCTION4(PIN_MODE_INPUT, PIN_OTYPE_PP, PIN_PUPD_NONE, 0));
+    }
+    this->touchedKeys = 0;
+}
+
+/*!
+    \brief      take new baselines from the next scans; keys must not be touched meanwhile
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void TouchSenseClass::calibrate(void)
+{
+    if (!this->running) {
+        return;
+    }
+    this->calibrating = TOUCH_CALIBRATION_SCANS;
+    waitCalibration();
+}
+
+/* until the calibration scans are over, false if they stall */
+bool TouchSenseClass::waitCalibration(void)
+{
+    uint32_t start = millis();
+    uint32_t scans = this->scanCount;
+
+    while (this->calibrating != 0U) {
+        /* a scan never takes long, even at the max cycle number on every acquisition */
+        if (this->scanCount != scans) {
+            scans = this->scanCount;
+            start = millis();
+        } else if ((millis() - start) > 100U) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* select the keys of this round and start the acquisition */
+void TouchSenseClass::startRound(void)
+{
+    uint32_t channels = 0U;
+    uint32_t groups = 0U;
+    uint8_t k;
+
+    for (k = 0U; k < this->keyCount; k++) {
+        if (this->keys[k].round == this->round) {
+            channels |= TOUCH_PIN_BIT(this->keys[k].group, this->keys[k].io);
+            groups |= 1UL << this->keys[k].group;
+        }
+    }
+    TSI_CHCFG = channels;
+    TSI_GCTL = groups;
+    tsi_software_start();
+}
+
+/* update baselines and touches from the counts of a complete scan */
+void TouchSenseClass::scanDone(void)
+{
+    uint32_t touched = 0U;
+    uint8_t k;
+
+    for (k = 0U; k < this->keyCount; k++) {
+        TouchKey *key = &this->keys[k];
+        int32_t delta;
+
+        if (this->calibrating != 0U) {
+            key->sum = ((this->calibrating == TOUCH_CALIBRATION_SCANS) ? 0U : key->sum) + key->count;
+            if (this->calibrating == 1U) {
+                key->baseline = (key->sum << 4) / TOUCH_CALIBRATION_SCANS;
+                key->touched = false;
+            }
+            continue;
+        }
+        delta = (int32_t)(key->baseline >> 4) - (int32_t)key->count;
+        if (key->touched) {
+            key->touched = (delta > (int32_t)(key->threshold / 2U));
+        } else {
+            key->touched = (delta >= (int32_t)key->threshold);
+        }
+        if (key->touched) {
+            touched |= 1UL << k;
+        } else {
+            /* follow temperature and humidity, the count rising or falling slowly */
+            key->baseline = (uint32_t)((int32_t)key->baseline
+                                       + (((int32_t)(key->count << 4) - (int32_t)key->baseline) >> TOUCH_DRIFT_SHIFT));
+        }
+    }
+    if (this->calibrating != 0U) {
+        if (--this->calibrating == 0U) {
+            for (k = 0U; k < this->keyCount; k++) {
+                if (this->keys[k].threshold == 0U) {
+                    this->keys[k].threshold = (uint16_t)((this->keys[k].baseline >> 8) > 0U ? (this->keys[k].baseline >> 8) : 1U);
+                }
+            }
+        }
+    }
+    this->scanCount++;
+    if (touched != this->touchedKeys) {
+        this->touchedKeys = touched;
+        if (this->callback != NULL) {
+            this->callback(touched);
+        }
+    }
+}
+
+/*!
+    \brief      tell whether a key is touched
+    \param[in]  key: from addKey()
+    \param[out] none
+    \retval     true while touched
+*/
+bool TouchSenseClass::touched(int key)
+{
+    return (key >= 0) && (key < this->keyCount) && ((this->touchedKeys & (1UL << key)) != 0U);
+}
+
+/*!
+    \brief      the keys touched after the last scan
+    \param[in]  none
+    \param[out] none
+    \retval     bit n set for key n touched
+*/
+uint32_t TouchSenseClass::touchedMask(void)
+{
+    return this->touchedKeys;
+}
+
+/*!
+    \brief      cycles the last acquisition of a key took, fewer when touched
+    \param[in]  key: from addKey()
+    \param[out] none
+    \retval     the count, 0 for a key that doesn't exist
+*/
+uint16_t TouchSenseClass::read(int key)
+{
+    if ((key < 0) || (key >= this->keyCount)) {
+        return 0;
+    }
+    return this->keys[key].count;
+}
+
+/*!
+    \brief      how far a key's count is below its baseline
+    \param[in]  key: from addKey()
+    \param[out] none
+    \retval     baseline minus count, negative above the baseline
+*/
+int32_t TouchSenseClass::delta(int key)
+{
+    if ((key < 0) || (key >= this->keyCount)) {
+        return 0;
+    }
+    return (int32_t)(this->keys[key].baseline >> 4) - (int32_t)this->keys[key].count;
+}
+
+/*!
+    \brief      count of a key not touched, as calibrated and drifted since
+    \param[in]  key: from addKey()
+    \param[out] none
+    \retval     the baseline
+*/
+uint16_t TouchSenseClass::baseline(int key)
+{
+    if ((key < 0) || (key >= this->keyCount)) {
+        return 0;
+    }
+    return (uint16_t)(this->keys[key].baseline >> 4);
+}
+
+/*!
+    \brief      set the drop in count that means touched
+    \param[in]  key: from addKey()
+    \param[in]  threshold: counts below the baseline, 0 for 1/16 of the baseline
+    \param[out] none
+    \retval     none
+*/
+void TouchSenseClass::setThreshold(int key, uint16_t threshold)
+{
+    if ((key < 0) || (key >= this->keyCount)) {
+        return;
+    }
+    if ((threshold == 0U) && (this->keys[key].baseline != 0U)) {
+        threshold = (uint16_t)((this->keys[key].baseline >> 8) > 0U ? (this->keys[key].baseline >> 8) : 1U);
+    }
+    this->keys[key].threshold = threshold;
+}
+
+/*!
+    \brief      call back from the TSI interrupt when a scan changes the touched keys
+    \param[in]  callback: gets touchedMask(), NULL for none
+    \param[out] none
+    \retval     none
+*/
+void TouchSenseClass::onChange(TouchCallback callback)
+{
+    this->callback = callback;
+}
+
+/*!
+    \brief      complete scans of all keys since begin()
+    \param[in]  none
+    \param[out] none
+    \retval     the count
+*/
+uint32_t TouchSenseClass::scans(void)
+{
+    return this->scanCount;
+}
+
+/*!
+    \brief      acquisitions that hit the max cycle number, for a sampling capacitor
+                too large or a pin not wired
+    \param[in]  none
+    \param[out] none
+    \retval     the count
+*/
+uint32_t TouchSenseClass::errors(void)
+{
+    return this->errorCount;
+}
+
+/*!
+    \brief      end of acquisition: take the counts, start the next acquisition
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void TouchSenseClass::irq(void)
+{
+    uint32_t flags = TSI_INTF;
+    uint32_t done = TSI_GCTL;
+    uint8_t k;
+
+    TSI_INTC = TSI_INTC_CCTCF | TSI_INTC_CMNERR;
+    tsi_software_stop();
+    if (!this->running) {
+        return;
+    }
+    if ((flags & TSI_INTF_MNERR) != 0U) {
+        this->errorCount++;
+    }
+    for (k = 0U; k < this->keyCount; k++) {
+        TouchKey *key = &this->keys[k];
+
+        if (key->round != this->round) {
+            continue;
+        }
+        /* a group the max cycle number stopped isn't complete */
+        key->count = ((done & (TSI_GCTL_GC0 << key->group)) != 0U) ? (uint16_t)TOUCH_CYCN(key->group)
+                     : (uint16_t)TOUCH_COUNT_MAX;
+    }
+    if (++this->round >= this->rounds) {
+        this->round = 0;
+        scanDone();
+    }
+    delayMicroseconds(TOUCH_DISCHARGE_US);
+    startRound();
+}
+
+extern "C" {
+
+__attribute__((used)) void TSI_IRQHandler(void)
+{
+    TouchSense.irq();
+}
+
+}
+
+#endif /* GD32F3x0 || GD32F1x0 */
@@ -0,0 +1,119 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef TOUCHSENSE_H
+#define TOUCHSENSE_H
+
+#include "Arduino.h"
+
+#if defined(GD32F3x0) || defined(GD32F1x0)
+
+/* keys, up to three per group: the fourth pin of a group is its sample pin */
+#ifndef TOUCH_MAX_KEYS
+#define TOUCH_MAX_KEYS          18
+#endif
+/* scans averaged into the baseline by begin() and calibrate() */
+#ifndef TOUCH_CALIBRATION_SCANS
+#define TOUCH_CALIBRATION_SCANS 16
+#endif
+/* the baseline of a key not touched follows its count by 1/2^TOUCH_DRIFT_SHIFT a scan */
+#ifndef TOUCH_DRIFT_SHIFT
+#define TOUCH_DRIFT_SHIFT       6
+#endif
+#define TOUCH_GROUPS            6
+
+/* called from the TSI interrupt after a scan changed which keys are touched, one bit a key */
+typedef void (*TouchCallback)(uint32_t touched);
+
+/* Touch keys on the TSI. Each group has a sample pin, wired to a sampling capacitor of some
+   nF to ground, and up to three key pins, wired to the electrodes. An acquisition charges
+   one electrode of every group and transfers the charge to the sampling capacitor until it
+   reaches the input threshold; the cycles that took drop when a finger adds capacitance.
+   All groups are measured at once, so a scan takes as many acquisitions as the group with
+   the most keys has keys, and the end-of-acquisition interrupt starts the next one: the
+   CPU only reads the results.
+
+   A key is touched once its count fell threshold below the baseline and released once it
+   is back within half of that. Until begin() ends, the first TOUCH_CALIBRATION_SCANS scans
+   set the baselines, so keys must not be touched then */
+class TouchSenseClass
+{
+    public:
+        TouchSenseClass(void);                                                    //TouchSenseClass object construct
+        int addKey(uint32_t pin, uint32_t samplePin,
+                   uint16_t threshold = 0);                                       //add a key before begin(), its index
+        bool begin(void);                                                         //calibrate and scan continuously
+        void end(void);                                                           //stop and release the pins
+        void calibrate(void);                                                     //take new baselines, blocks a few scans
+        bool touched(int key);                                                    //key is touched
+        uint32_t touchedMask(void);                                               //touched keys, one bit each
+        uint16_t read(int key);                                                   //cycles of the last acquisition
+        int32_t delta(int key);                                                   //baseline minus count
+        uint16_t baseline(int key);                                               //count of the key not touched
+        void setThreshold(int key, uint16_t threshold);                           //drop in count that means touched
+        void onChange(TouchCallback callback);                                    //call back on touches and releases
+        uint32_t scans(void);                                                     //complete scans so far
+        uint32_t errors(void);                                                    //acquisitions that hit the max cycle number
+
+        void irq(void);
+
+    private:
+        typedef struct {
+            PinName pin;
+            uint8_t group;
+            uint8_t io;                                                           //pin 0 to 3 of the group
+            uint8_t round;                                                        //acquisition of the scan it is in
+            bool touched;
+            volatile uint16_t count;
+            uint16_t threshold;                                                   //0 until calibration sets it
+            uint32_t baseline;                                                    //count << 4
+            uint32_t sum;
+        } TouchKey;
+
+        void startRound(void);
+        void scanDone(void);
+        bool waitCalibration(void);
+
+        TouchKey keys[TOUCH_MAX_KEYS];
+        uint8_t keyCount;
+        PinName samplePins[TOUCH_GROUPS];
+        uint8_t groupKeys[TOUCH_GROUPS];
+        uint8_t rounds;
+        volatile uint8_t round;
+        volatile uint8_t calibrating;
+        bool running;
+        volatile uint32_t touchedKeys;
+        volatile uint32_t scanCount;
+        volatile uint32_t errorCount;
+        TouchCallback callback;
+};
+
+extern TouchSenseClass TouchSense;
+
+#endif /* GD32F3x0 || GD32F1x0 */
+
+#endif /* TOUCHSENSE_H */
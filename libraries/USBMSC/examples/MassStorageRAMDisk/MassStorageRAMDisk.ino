@@ -0,0 +1,30 @@
+/*
+ * Shows a 16 KiB RAM disk to the host. It comes up unformatted, so the
+ * host will offer to format it. The contents are lost on reset.
+ */
+#include <USBMSC.h>
+
+#define BLOCK_SIZE  512
+#define BLOCK_COUNT 32
+
+USBMSC msc;
+uint8_t disk[BLOCK_COUNT * BLOCK_SIZE];
+
+bool readBlocks(uint32_t lba, uint8_t* buffer, uint32_t count) {
+  memcpy(buffer, &disk[lba * BLOCK_SIZE], count * BLOCK_SIZE);
+  return true;
+}
+
+bool writeBlocks(uint32_t lba, const uint8_t* buffer, uint32_t count) {
+  memcpy(&disk[lba * BLOCK_SIZE], buffer, count * BLOCK_SIZE);
+  return true;
+}
+
+void setup() {
+  msc.setIdentity("GD32", "RAM Disk", "1.0");
+  msc.begin(BLOCK_COUNT, BLOCK_SIZE, readBlocks, writeBlocks);
+}
+
+void loop() {
+  msc.task();
+}
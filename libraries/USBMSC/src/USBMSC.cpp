@@ -0,0 +1,456 @@
+#include "USBMSC.h"
+
+#if defined(USBCON)
+
+#include "USBCore.h"
+
+#define MSC_CBW_SIGNATURE 0x43425355U
+#define MSC_CSW_SIGNATURE 0x53425355U
+#define MSC_CBW_DIR_IN    0x80
+
+#define MSC_CSW_PASSED    0x00
+#define MSC_CSW_FAILED    0x01
+
+/* SCSI operation codes */
+#define SCSI_TEST_UNIT_READY           0x00
+#define SCSI_REQUEST_SENSE             0x03
+#define SCSI_INQUIRY                   0x12
+#define SCSI_MODE_SENSE6               0x1a
+#define SCSI_START_STOP_UNIT           0x1b
+#define SCSI_PREVENT_ALLOW_REMOVAL     0x1e
+#define SCSI_READ_FORMAT_CAPACITIES    0x23
+#define SCSI_READ_CAPACITY10           0x25
+#define SCSI_READ10                    0x28
+#define SCSI_WRITE10                   0x2a
+#define SCSI_VERIFY10                  0x2f
+#define SCSI_SYNCHRONIZE_CACHE10       0x35
+#define SCSI_MODE_SENSE10              0x5a
+
+/* sense keys and the additional sense codes used with them */
+#define SENSE_NOT_READY                0x02
+#define SENSE_MEDIUM_ERROR             0x03
+#define SENSE_ILLEGAL_REQUEST          0x05
+#define SENSE_DATA_PROTECT             0x07
+
+#define ASC_WRITE_FAULT                0x03
+#define ASC_UNRECOVERED_READ_ERROR     0x11
+#define ASC_INVALID_COMMAND            0x20
+#define ASC_LBA_OUT_OF_RANGE           0x21
+#define ASC_WRITE_PROTECTED            0x27
+#define ASC_MEDIUM_NOT_PRESENT         0x3a
+
+static uint32_t get_be32(const uint8_t* p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint16_t get_be16(const uint8_t* p)
+{
+    return ((uint16_t)p[0] << 8) | p[1];
+}
+
+static void put_be32(uint8_t* p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+// Copy ‘str’ into a fixed width, space padded SCSI string field.
+static void put_string(uint8_t* p, const char* str, size_t width)
+{
+    size_t i = 0;
+    for (; i < width && str[i] != '\0'; i++) {
+        p[i] = str[i];
+    }
+    for (; i < width; i++) {
+        p[i] = ' ';
+    }
+}
+
+USBMSC::USBMSC() : PluggableUSBModule(2, 1, epType)
+{
+    this->epType[0] = EPDesc(USB_TRX_IN, USB_ENDPOINT_TYPE_BULK).val;
+    this->epType[1] = EPDesc(USB_TRX_OUT, USB_ENDPOINT_TYPE_BULK).val;
+    PluggableUSB().plug(this);
+}
+
+bool USBMSC::begin(uint32_t blockCount, uint16_t blockSize, USBMSCReadCallback read,
+                   USBMSCWriteCallback write)
+{
+    if (read == NULL || blockSize == 0 || blockSize > USBMSC_BUFFER_SIZE
+        || (USBMSC_BUFFER_SIZE % blockSize) != 0) {
+        return false;
+    }
+    this->blockCount = blockCount;
+    this->blockSize = blockSize;
+    this->readCallback = read;
+    this->writeCallback = write;
+    this->mediaPresent = true;
+    USBCore().connect();
+    return true;
+}
+
+void USBMSC::end()
+{
+    this->mediaPresent = false;
+    this->readCallback = NULL;
+    this->writeCallback = NULL;
+}
+
+void USBMSC::setMediaPresent(bool present)
+{
+    this->mediaPresent = present && this->readCallback != NULL;
+}
+
+void USBMSC::setIdentity(const char* vendor, const char* product, const char* revision)
+{
+    this->vendor = vendor;
+    this->product = product;
+    this->revision = revision;
+}
+
+uint8_t USBMSC::inEndpoint()
+{
+    return this->pluggedEndpoint;
+}
+
+uint8_t USBMSC::outEndpoint()
+{
+    return this->pluggedEndpoint + 1;
+}
+
+bool USBMSC::setup(arduino::USBSetup& setup)
+{
+    if (setup.wIndex != this->pluggedInterface) {
+        return false;
+    }
+
+    if (setup.bmRequestType == REQUEST_HOSTTODEVICE_CLASS_INTERFACE
+        && setup.bRequest == MSC_REQUEST_RESET) {
+        // Commands are run to the end inside ‘task’, so there is no
+        // half-done state to throw away.
+        return true;
+    } else if (setup.bmRequestType == REQUEST_DEVICETOHOST_CLASS_INTERFACE
+               && setup.bRequest == MSC_REQUEST_GET_MAX_LUN) {
+        uint8_t maxLun = 0;
+        USB_SendControl(TRANSFER_RELEASE, &maxLun, sizeof(maxLun));
+        return true;
+    }
+    return false;
+}
+
+int USBMSC::getInterface(uint8_t* interfaceCount)
+{
+    *interfaceCount += 1;
+
+    MSCDescriptor desc = {
+        D_INTERFACE(this->pluggedInterface, 2, MSC_INTERFACE_CLASS, MSC_SUBCLASS_SCSI, MSC_PROTOCOL_BULK_ONLY),
+        D_ENDPOINT(USB_ENDPOINT_IN(this->inEndpoint()), USB_ENDPOINT_TYPE_BULK, USB_EP_SIZE, 0),
+        D_ENDPOINT(USB_ENDPOINT_OUT(this->outEndpoint()), USB_ENDPOINT_TYPE_BULK, USB_EP_SIZE, 0)
+    };
+    return USB_SendControl(0, &desc, sizeof(desc));
+}
+
+int USBMSC::getDescriptor(arduino::USBSetup& setup)
+{
+    (void)setup;
+    return 0;
+}
+
+void USBMSC::task()
+{
+    if (this->readCallback == NULL || !USBCore().configured()) {
+        return;
+    }
+
+    // Non-blocking, and re-arms the endpoint once it is drained.
+    auto n = USB_Recv(this->outEndpoint(), &this->cbw, sizeof(this->cbw));
+    if (n <= 0) {
+        return;
+    }
+    // Anything but a well formed CBW is dropped, the host times out
+    // and resets the device.
+    if (n != sizeof(this->cbw) || this->cbw.dCBWSignature != MSC_CBW_SIGNATURE) {
+        return;
+    }
+
+    this->online = true;
+    this->residue = this->cbw.dCBWDataTransferLength;
+    bool ok;
+    if (this->cbw.bCBWLUN != 0) {
+        ok = this->fail(SENSE_ILLEGAL_REQUEST, ASC_INVALID_COMMAND, 0);
+    } else {
+        ok = this->scsiCommand();
+    }
+
+    // Whatever the host asked for and didn't get is padded (IN) or
+    // soaked up (OUT), so the data stage always has the expected
+    // length and the residue tells the host how much was real.
+    if (this->residue > 0) {
+        if (this->cbw.bmCBWFlags & MSC_CBW_DIR_IN) {
+            this->padIn();
+        } else {
+            this->drainOut();
+        }
+    }
+    if (this->online) {
+        // The status has to go in a packet of its own.
+        USB_Flush(this->inEndpoint());
+        this->sendStatus(ok ? MSC_CSW_PASSED : MSC_CSW_FAILED);
+    }
+}
+
+// Queue ‘len’ octets on the IN endpoint. Full packets go out as they
+// fill, the tail waits for more data or the status.
+void USBMSC::transferIn(const void* data, uint32_t len)
+{
+    USB_Send(this->inEndpoint(), data, len);
+    if (!USBCore().configured()) {
+        this->online = false;
+    }
+}
+
+// Receive exactly ‘len’ octets from the OUT endpoint.
+void USBMSC::transferOut(void* data, uint32_t len)
+{
+    auto d = (uint8_t*)data;
+    while (len > 0 && this->online) {
+        auto seen = EPBuffers().events();
+        auto n = USB_Recv(this->outEndpoint(), d, len);
+        if (n > 0) {
+            d += n;
+            len -= n;
+        } else if (!EPBuffers().waitForEvent(seen)) {
+            this->online = false;
+        }
+    }
+}
+
+// Data stage of the current command, clipped to what the host asked
+// for.
+void USBMSC::sendData(const void* data, uint32_t len)
+{
+    len = min(len, this->residue);
+    this->transferIn(data, len);
+    this->residue -= len;
+}
+
+void USBMSC::recvData(void* data, uint32_t len)
+{
+    len = min(len, this->residue);
+    this->transferOut(data, len);
+    this->residue -= len;
+}
+
+void USBMSC::padIn()
+{
+    memset(this->buffer, 0, USB_EP_SIZE);
+    for (uint32_t left = this->residue; left > 0 && this->online;) {
+        auto n = min(left, (uint32_t)USB_EP_SIZE);
+        this->transferIn(this->buffer, n);
+        left -= n;
+    }
+}
+
+void USBMSC::drainOut()
+{
+    for (uint32_t left = this->residue; left > 0 && this->online;) {
+        auto n = min(left, (uint32_t)USBMSC_BUFFER_SIZE);
+        this->transferOut(this->buffer, n);
+        left -= n;
+    }
+}
+
+void USBMSC::sendStatus(uint8_t status)
+{
+    MSCCommandStatus csw = {
+        .dCSWSignature = MSC_CSW_SIGNATURE,
+        .dCSWTag = this->cbw.dCBWTag,
+        .dCSWDataResidue = this->residue,
+        .bCSWStatus = status
+    };
+    USB_Send(this->inEndpoint() | TRANSFER_RELEASE, &csw, sizeof(csw));
+}
+
+// Record the sense data for the next REQUEST SENSE, returns false to
+// fail the command.
+bool USBMSC::fail(uint8_t key, uint8_t asc, uint8_t ascq)
+{
+    this->senseKey = key;
+    this->senseAsc = asc;
+    this->senseAscq = ascq;
+    return false;
+}
+
+bool USBMSC::scsiCommand()
+{
+    auto op = this->cbw.CBWCB[0];
+    if (op != SCSI_REQUEST_SENSE) {
+        this->senseKey = 0;
+        this->senseAsc = 0;
+        this->senseAscq = 0;
+    }
+
+    switch (op) {
+        case SCSI_TEST_UNIT_READY:
+            if (!this->mediaPresent) {
+                return this->fail(SENSE_NOT_READY, ASC_MEDIUM_NOT_PRESENT, 0);
+            }
+            return true;
+        case SCSI_REQUEST_SENSE:
+            return this->scsiRequestSense();
+        case SCSI_INQUIRY:
+            return this->scsiInquiry();
+        case SCSI_MODE_SENSE6:
+            return this->scsiModeSense(false);
+        case SCSI_MODE_SENSE10:
+            return this->scsiModeSense(true);
+        case SCSI_READ_FORMAT_CAPACITIES:
+            return this->scsiReadFormatCapacities();
+        case SCSI_READ_CAPACITY10:
+            return this->scsiReadCapacity();
+        case SCSI_READ10:
+            return this->scsiRead();
+        case SCSI_WRITE10:
+            return this->scsiWrite();
+        case SCSI_START_STOP_UNIT:
+        case SCSI_PREVENT_ALLOW_REMOVAL:
+        case SCSI_VERIFY10:
+        case SCSI_SYNCHRONIZE_CACHE10:
+            return true;
+        default:
+            return this->fail(SENSE_ILLEGAL_REQUEST, ASC_INVALID_COMMAND, 0);
+    }
+}
+
+bool USBMSC::scsiInquiry()
+{
+    uint8_t r[36] = {
+        0x00,           // direct access block device
+        0x80,           // removable
+        0x04,           // SPC-2
+        0x02,           // response data format
+        sizeof(r) - 5,  // additional length
+        0x00, 0x00, 0x00
+    };
+    put_string(&r[8], this->vendor, 8);
+    put_string(&r[16], this->product, 16);
+    put_string(&r[32], this->revision, 4);
+    this->sendData(r, min((uint32_t)sizeof(r), (uint32_t)this->cbw.CBWCB[4]));
+    return true;
+}
+
+bool USBMSC::scsiRequestSense()
+{
+    uint8_t r[18] = {0};
+    r[0] = 0x70;        // current error, fixed format
+    r[2] = this->senseKey;
+    r[7] = sizeof(r) - 8;
+    r[12] = this->senseAsc;
+    r[13] = this->senseAscq;
+    this->sendData(r, min((uint32_t)sizeof(r), (uint32_t)this->cbw.CBWCB[4]));
+
+    this->senseKey = 0;
+    this->senseAsc = 0;
+    this->senseAscq = 0;
+    return true;
+}
+
+bool USBMSC::scsiModeSense(bool ten)
+{
+    uint8_t wp = this->writeCallback == NULL ? 0x80 : 0x00;
+    if (ten) {
+        const uint8_t r[8] = {0x00, 0x06, 0x00, wp, 0x00, 0x00, 0x00, 0x00};
+        this->sendData(r, min((uint32_t)sizeof(r), (uint32_t)get_be16(&this->cbw.CBWCB[7])));
+    } else {
+        const uint8_t r[4] = {0x03, 0x00, wp, 0x00};
+        this->sendData(r, min((uint32_t)sizeof(r), (uint32_t)this->cbw.CBWCB[4]));
+    }
+    return true;
+}
+
+bool USBMSC::scsiReadFormatCapacities()
+{
+    if (!this->mediaPresent) {
+        return this->fail(SENSE_NOT_READY, ASC_MEDIUM_NOT_PRESENT, 0);
+    }
+    uint8_t r[12] = {0x00, 0x00, 0x00, 0x08};
+    put_be32(&r[4], this->blockCount);
+    put_be32(&r[8], this->blockSize);
+    r[8] = 0x02;        // formatted media
+    this->sendData(r, min((uint32_t)sizeof(r), (uint32_t)get_be16(&this->cbw.CBWCB[7])));
+    return true;
+}
+
+bool USBMSC::scsiReadCapacity()
+{
+    if (!this->mediaPresent) {
+        return this->fail(SENSE_NOT_READY, ASC_MEDIUM_NOT_PRESENT, 0);
+    }
+    uint8_t r[8];
+    put_be32(&r[0], this->blockCount - 1);
+    put_be32(&r[4], this->blockSize);
+    this->sendData(r, sizeof(r));
+    return true;
+}
+
+// READ(10): blocks go out through the transfer buffer as many at a
+// time as it holds.
+bool USBMSC::scsiRead()
+{
+    if (!this->mediaPresent) {
+        return this->fail(SENSE_NOT_READY, ASC_MEDIUM_NOT_PRESENT, 0);
+    }
+    uint32_t lba = get_be32(&this->cbw.CBWCB[2]);
+    uint32_t count = get_be16(&this->cbw.CBWCB[7]);
+    if (lba >= this->blockCount || count > this->blockCount - lba) {
+        return this->fail(SENSE_ILLEGAL_REQUEST, ASC_LBA_OUT_OF_RANGE, 0);
+    }
+
+    const uint32_t perRun = USBMSC_BUFFER_SIZE / this->blockSize;
+    while (count > 0 && this->residue > 0 && this->online) {
+        auto n = min(count, perRun);
+        if (!this->readCallback(lba, this->buffer, n)) {
+            return this->fail(SENSE_MEDIUM_ERROR, ASC_UNRECOVERED_READ_ERROR, 0);
+        }
+        this->sendData(this->buffer, n * this->blockSize);
+        lba += n;
+        count -= n;
+    }
+    return count == 0;
+}
+
+bool USBMSC::scsiWrite()
+{
+    if (!this->mediaPresent) {
+        return this->fail(SENSE_NOT_READY, ASC_MEDIUM_NOT_PRESENT, 0);
+    }
+    if (this->writeCallback == NULL) {
+        return this->fail(SENSE_DATA_PROTECT, ASC_WRITE_PROTECTED, 0);
+    }
+    uint32_t lba = get_be32(&this->cbw.CBWCB[2]);
+    uint32_t count = get_be16(&this->cbw.CBWCB[7]);
+    if (lba >= this->blockCount || count > this->blockCount - lba
+        || (uint64_t)count * this->blockSize > this->residue) {
+        return this->fail(SENSE_ILLEGAL_REQUEST, ASC_LBA_OUT_OF_RANGE, 0);
+    }
+
+    const uint32_t perRun = USBMSC_BUFFER_SIZE / this->blockSize;
+    while (count > 0 && this->online) {
+        auto n = min(count, perRun);
+        this->recvData(this->buffer, n * this->blockSize);
+        if (!this->online) {
+            return false;
+        }
+        if (!this->writeCallback(lba, this->buffer, n)) {
+            return this->fail(SENSE_MEDIUM_ERROR, ASC_WRITE_FAULT, 0);
+        }
+        lba += n;
+        count -= n;
+    }
+    return true;
+}
+
+#endif
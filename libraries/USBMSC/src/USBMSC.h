@@ -0,0 +1,144 @@
+#pragma once
+
+#include "Arduino.h"
+
+#if defined(USBCON)
+
+#include "api/PluggableUSB.h"
+
+/*
+ * Size of the transfer buffer. READ(10)/WRITE(10) commands are handed
+ * to the callbacks in runs of this many octets' worth of blocks, so it
+ * has to be at least one block and ideally several.
+ */
+#ifndef USBMSC_BUFFER_SIZE
+#define USBMSC_BUFFER_SIZE 2048
+#endif
+
+#define MSC_INTERFACE_CLASS     0x08
+#define MSC_SUBCLASS_SCSI       0x06
+#define MSC_PROTOCOL_BULK_ONLY  0x50
+
+#define MSC_REQUEST_RESET       0xff
+#define MSC_REQUEST_GET_MAX_LUN 0xfe
+
+#pragma pack(push, 1)
+typedef struct {
+    InterfaceDescriptor msc;
+    EndpointDescriptor in;
+    EndpointDescriptor out;
+} MSCDescriptor;
+
+/* Command block wrapper, the first packet of every command */
+typedef struct {
+    uint32_t dCBWSignature;
+    uint32_t dCBWTag;
+    uint32_t dCBWDataTransferLength;
+    uint8_t bmCBWFlags;
+    uint8_t bCBWLUN;
+    uint8_t bCBWCBLength;
+    uint8_t CBWCB[16];
+} MSCCommandBlock;
+
+/* Command status wrapper, sent back once the command is done */
+typedef struct {
+    uint32_t dCSWSignature;
+    uint32_t dCSWTag;
+    uint32_t dCSWDataResidue;
+    uint8_t bCSWStatus;
+} MSCCommandStatus;
+#pragma pack(pop)
+
+/*
+ * Block device callbacks, ‘count’ blocks from block ‘lba’ on. Both
+ * return false on failure, which is reported to the host as a medium
+ * error.
+ */
+typedef bool (*USBMSCReadCallback)(uint32_t lba, uint8_t* buffer, uint32_t count);
+typedef bool (*USBMSCWriteCallback)(uint32_t lba, const uint8_t* buffer, uint32_t count);
+
+/*
+ * Single-LUN USB mass storage device using the bulk-only transport.
+ *
+ * Declare one at global scope so it is plugged in before USB
+ * enumerates, give it the block device with ‘begin’ and call ‘task’
+ * from ‘loop’. The callbacks run from ‘task’, never from the USB
+ * interrupt, so they may take their time.
+ */
+class USBMSC : public arduino::PluggableUSBModule
+{
+    public:
+        USBMSC();
+
+        /*
+         * ‘write’ may be NULL for a read-only drive. ‘blockSize’ must
+         * divide USBMSC_BUFFER_SIZE.
+         */
+        bool begin(uint32_t blockCount, uint16_t blockSize, USBMSCReadCallback read,
+                   USBMSCWriteCallback write = NULL);
+        void end();
+
+        /*
+         * Whether there is a medium behind the drive. Without one the
+         * host sees an empty card reader.
+         */
+        void setMediaPresent(bool present);
+
+        /*
+         * Serve the host, handles at most one command per call.
+         */
+        void task();
+
+        void setIdentity(const char* vendor, const char* product, const char* revision);
+
+    protected:
+        bool setup(arduino::USBSetup& setup);
+        int getInterface(uint8_t* interfaceCount);
+        int getDescriptor(arduino::USBSetup& setup);
+
+    private:
+        unsigned int epType[2];
+
+        uint32_t blockCount = 0;
+        uint16_t blockSize = 0;
+        USBMSCReadCallback readCallback = NULL;
+        USBMSCWriteCallback writeCallback = NULL;
+        bool mediaPresent = false;
+
+        const char* vendor = "GD32";
+        const char* product = "Mass Storage";
+        const char* revision = "1.0";
+
+        MSCCommandBlock cbw;
+        uint32_t residue;
+        uint8_t senseKey = 0;
+        uint8_t senseAsc = 0;
+        uint8_t senseAscq = 0;
+        /* cleared when the host resets the device in the middle of a command */
+        bool online;
+
+        uint8_t buffer[USBMSC_BUFFER_SIZE] __attribute__((aligned(4)));
+
+        uint8_t inEndpoint();
+        uint8_t outEndpoint();
+
+        void transferIn(const void* data, uint32_t len);
+        void transferOut(void* data, uint32_t len);
+        void sendData(const void* data, uint32_t len);
+        void recvData(void* data, uint32_t len);
+        void padIn();
+        void drainOut();
+        void sendStatus(uint8_t status);
+        bool fail(uint8_t key, uint8_t asc, uint8_t ascq);
+
+        bool scsiCommand();
+        bool scsiInquiry();
+        bool scsiModeSense(bool ten);
+        bool scsiReadCapacity();
+        bool scsiReadFormatCapacities();
+        bool scsiRequestSense();
+        bool scsiRead();
+        bool scsiWrite();
+};
+
+#endif
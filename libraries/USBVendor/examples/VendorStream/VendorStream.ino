@@ -0,0 +1,31 @@
+/*
+ * Streams a counting pattern to the host as fast as it takes it, and
+ * echoes the first octet of whatever the host sends back into the
+ * stream as a marker.
+ *
+ * On Windows the device binds to WinUSB by itself; open it with
+ * libusb, or WinUSB through the GUID in USBVENDOR_INTERFACE_GUID, and
+ * read from the bulk IN endpoint in multiples of 64 octets.
+ */
+#include <USBVendor.h>
+
+USBVendor vendor;
+uint8_t block[512];
+uint8_t counter = 0;
+
+void setup() {
+  vendor.begin();
+}
+
+void loop() {
+  if (!vendor) {
+    return;
+  }
+  if (vendor.available() > 0) {
+    counter = vendor.read();
+  }
+  for (size_t i = 0; i < sizeof(block); i++) {
+    block[i] = counter++;
+  }
+  vendor.write(block, sizeof(block));
+}
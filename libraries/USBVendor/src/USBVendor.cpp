@@ -0,0 +1,421 @@
+#include "USBVendor.h"
+
+#if defined(USBCON)
+
+#include "USBCore.h"
+
+extern "C" {
+#include "gd32/usb.h"
+}
+
+/* {D8DD60DF-4589-4CC7-9CD2-659D9E648A9F}, in wire order */
+static const uint8_t msOS20PlatformUUID[16] = {
+    0xdf, 0x60, 0xdd, 0xd8, 0x89, 0x45, 0xc7, 0x4c,
+    0x9c, 0xd2, 0x65, 0x9d, 0x9e, 0x64, 0x8a, 0x9f
+};
+
+static const char interfaceGUIDsName[] = "DeviceInterfaceGUIDs";
+
+/* the instance that serves the BOS and MS OS 2.0 descriptors */
+static USBVendor* msOS20Owner = nullptr;
+
+USBVendor::USBVendor(const char* interfaceGUID, uint8_t vendorCode)
+    : PluggableUSBModule(2, 1, epType),
+      interfaceGUID(interfaceGUID)
+{
+    this->epType[0] = EPDesc(USB_TRX_IN, USB_ENDPOINT_TYPE_BULK).val;
+    this->epType[1] = EPDesc(USB_TRX_OUT, USB_ENDPOINT_TYPE_BULK).val;
+    if (!PluggableUSB().plug(this)) {
+        return;
+    }
+    USBCore().attachTranscIn(this->inEndpoint(), USBVendor::transcIn, this);
+    USBCore().attachTranscOut(this->outEndpoint(), USBVendor::transcOut, this);
+
+    if (msOS20Owner != nullptr) {
+        return;
+    }
+    msOS20Owner = this;
+    this->bos = {
+        .bLength = 5,
+        .bDescriptorType = USB_DESCTYPE_BOS,
+        .wTotalLength = sizeof(MSOS20BOSDescriptor),
+        .bNumDeviceCaps = 1,
+        .capLength = sizeof(MSOS20BOSDescriptor) - 5,
+        .capDescriptorType = USB_DESCTYPE_DEVICE_CAPABILITY,
+        .bDevCapabilityType = USB_DEVCAP_PLATFORM,
+        .bReserved = 0,
+        .platformCapabilityUUID = {},
+        .dwWindowsVersion = MS_OS_20_WINDOWS_VERSION,
+        .wMSOSDescriptorSetTotalLength = sizeof(MSOS20DescriptorSet),
+        .bMS_VendorCode = vendorCode,
+        .bAltEnumCode = 0
+    };
+    memcpy(this->bos.platformCapabilityUUID, msOS20PlatformUUID, sizeof(msOS20PlatformUUID));
+    USBCore().setBOSDescriptor((const uint8_t*)&this->bos);
+}
+
+void USBVendor::begin()
+{
+    USBCore().connect();
+}
+
+void USBVendor::end()
+{
+}
+
+USBVendor::operator bool()
+{
+    USBCore().connect();
+    return this->configured();
+}
+
+uint8_t USBVendor::inEndpoint()
+{
+    return this->pluggedEndpoint;
+}
+
+uint8_t USBVendor::outEndpoint()
+{
+    return this->pluggedEndpoint + 1;
+}
+
+bool USBVendor::configured()
+{
+    return USBCore().configured();
+}
+
+bool USBVendor::setup(arduino::USBSetup& setup)
+{
+    if (this == msOS20Owner
+        && setup.bmRequestType == (REQUEST_DEVICETOHOST | REQUEST_VENDOR | REQUEST_DEVICE)
+        && setup.bRequest == this->bos.bMS_VendorCode
+        && setup.wIndex == MS_OS_20_DESCRIPTOR_INDEX) {
+        this->sendDescriptorSet();
+        return true;
+    }
+    return false;
+}
+
+int USBVendor::getInterface(uint8_t* interfaceCount)
+{
+    *interfaceCount += 1;
+
+    VendorDescriptor desc = {
+        D_INTERFACE(this->pluggedInterface, 2, VENDOR_INTERFACE_CLASS, 0, 0),
+        D_ENDPOINT(USB_ENDPOINT_IN(this->inEndpoint()), USB_ENDPOINT_TYPE_BULK, USB_EP_SIZE, 0),
+        D_ENDPOINT(USB_ENDPOINT_OUT(this->outEndpoint()), USB_ENDPOINT_TYPE_BULK, USB_EP_SIZE, 0)
+    };
+    return USB_SendControl(0, &desc, sizeof(desc));
+}
+
+int USBVendor::getDescriptor(arduino::USBSetup& setup)
+{
+    (void)setup;
+    return 0;
+}
+
+// The MS OS 2.0 descriptor set: WinUSB as the compatible ID of the
+// vendor interface, and the GUID it is registered under. Built here
+// because the interface number is only known once plugged.
+void USBVendor::sendDescriptorSet()
+{
+    MSOS20DescriptorSet set = {
+        .header = {
+            .wLength = sizeof(MSOS20SetHeader),
+            .wDescriptorType = MS_OS_20_SET_HEADER_DESCRIPTOR,
+            .dwWindowsVersion = MS_OS_20_WINDOWS_VERSION,
+            .wTotalLength = sizeof(MSOS20DescriptorSet)
+        },
+        .configuration = {
+            .wLength = sizeof(MSOS20ConfigurationSubset),
+            .wDescriptorType = MS_OS_20_SUBSET_HEADER_CONFIGURATION,
+            // The index of the configuration, not its value.
+            .bConfigurationValue = 0,
+            .bReserved = 0,
+            .wTotalLength = sizeof(MSOS20DescriptorSet) - sizeof(MSOS20SetHeader)
+        },
+        .function = {
+            .wLength = sizeof(MSOS20FunctionSubset),
+            .wDescriptorType = MS_OS_20_SUBSET_HEADER_FUNCTION,
+            .bFirstInterface = this->pluggedInterface,
+            .bReserved = 0,
+            .wSubsetLength = sizeof(MSOS20FunctionSubset) + sizeof(MSOS20CompatibleID)
+                             + sizeof(MSOS20InterfaceGUIDs)
+        },
+        .compatibleID = {
+            .wLength = sizeof(MSOS20CompatibleID),
+            .wDescriptorType = MS_OS_20_FEATURE_COMPATIBLE_ID,
+            .compatibleID = {'W', 'I', 'N', 'U', 'S', 'B', 0, 0},
+            .subCompatibleID = {}
+        },
+        .interfaceGUIDs = {
+            .wLength = sizeof(MSOS20InterfaceGUIDs),
+            .wDescriptorType = MS_OS_20_FEATURE_REG_PROPERTY,
+            .wPropertyDataType = MS_OS_20_REG_MULTI_SZ,
+            .wPropertyNameLength = sizeof(set.interfaceGUIDs.propertyName),
+            .propertyName = {},
+            .wPropertyDataLength = sizeof(set.interfaceGUIDs.propertyData),
+            .propertyData = {}
+        }
+    };
+
+    // UTF-16LE, with the terminators the zero fill left.
+    for (size_t i = 0; i < sizeof(interfaceGUIDsName) - 1; i++) {
+        set.interfaceGUIDs.propertyName[i] = interfaceGUIDsName[i];
+    }
+    for (size_t i = 0; i < USBVENDOR_GUID_LENGTH && this->interfaceGUID[i] != '\0'; i++) {
+        set.interfaceGUIDs.propertyData[i] = this->interfaceGUID[i];
+    }
+    USB_SendControl(TRANSFER_RELEASE, &set, sizeof(set));
+}
+
+int USBVendor::available()
+{
+    USBCore().connect();
+    this->rxPull();
+    return this->rxPending() + USB_Available(this->outEndpoint());
+}
+
+int USBVendor::peek()
+{
+    USBCore().connect();
+    this->rxPull();
+    if (this->rxPending() == 0) {
+        return -1;
+    }
+    return this->rxBuffer[this->rxTail];
+}
+
+int USBVendor::read()
+{
+    uint8_t c;
+    if (this->rxRead(&c, sizeof(c)) == 0) {
+        return -1;
+    }
+    return c;
+}
+
+// Like ‘Stream::readBytes’, but takes whatever is buffered at once
+// instead of one octet per call.
+size_t USBVendor::readBytes(char* buffer, size_t length)
+{
+    size_t count = 0;
+    auto start = millis();
+    while (count < length) {
+        auto n = this->rxRead((uint8_t*)buffer + count, length - count);
+        if (n > 0) {
+            count += n;
+            start = millis();
+        } else if (millis() - start >= this->_timeout) {
+            break;
+        } else {
+            yield();
+        }
+    }
+    return count;
+}
+
+size_t USBVendor::rxPending()
+{
+    uint16_t head = this->rxHead;
+    uint16_t tail = this->rxTail;
+    return (head + USBVENDOR_RX_BUFFER_SIZE - tail) % USBVENDOR_RX_BUFFER_SIZE;
+}
+
+size_t USBVendor::rxSpace()
+{
+    return USBVENDOR_RX_BUFFER_SIZE - 1 - this->rxPending();
+}
+
+// Move whatever the OUT endpoint holds into the ring, as
+// ‘CDCACM_::rxPull’ does. Once the packet is used up ‘EPBuffer::pop’
+// re-arms the endpoint.
+void USBVendor::rxPull()
+{
+    auto& ep = EPBuffers().buf(this->outEndpoint());
+    if (ep.available() == 0) {
+        // A zero length packet still has to free the endpoint.
+        if (!ep.rxWaiting) {
+            usb_disable_interrupts();
+            ep.enableOutEndpoint();
+            usb_enable_interrupts();
+        }
+        return;
+    }
+
+    usb_disable_interrupts();
+    if (this->rxPulling) {
+        usb_enable_interrupts();
+        return;
+    }
+    this->rxPulling = true;
+    usb_enable_interrupts();
+
+    for (;;) {
+        size_t n = min(ep.available(), this->rxSpace());
+        if (n == 0) {
+            break;
+        }
+        uint16_t head = this->rxHead;
+        n = min(n, (size_t)(USBVENDOR_RX_BUFFER_SIZE - head));
+        ep.pop(&this->rxBuffer[head], n);
+        this->rxHead = (head + n) % USBVENDOR_RX_BUFFER_SIZE;
+    }
+
+    this->rxPulling = false;
+
+    // A packet that came in while we were busy bounced off
+    // ‘rxPulling’.
+    if (ep.available() > 0 && this->rxSpace() > 0) {
+        this->rxPull();
+    }
+}
+
+size_t USBVendor::rxRead(uint8_t* d, size_t len)
+{
+    USBCore().connect();
+    size_t r = 0;
+    this->rxPull();
+    while (r < len) {
+        size_t n = min(this->rxPending(), len - r);
+        if (n == 0) {
+            break;
+        }
+        uint16_t tail = this->rxTail;
+        n = min(n, (size_t)(USBVENDOR_RX_BUFFER_SIZE - tail));
+        memcpy(d + r, &this->rxBuffer[tail], n);
+        this->rxTail = (tail + n) % USBVENDOR_RX_BUFFER_SIZE;
+        r += n;
+        this->rxPull();
+    }
+    return r;
+}
+
+int USBVendor::availableForWrite()
+{
+    return this->txSpace();
+}
+
+size_t USBVendor::write(uint8_t c)
+{
+    return this->write(&c, sizeof(c));
+}
+
+// Queue all of ‘d’, waiting for the host only while the ring is full.
+// Returns short if the device is unconfigured or reset meanwhile.
+size_t USBVendor::write(const uint8_t* d, size_t len)
+{
+    USBCore().connect();
+
+    size_t wrote = 0;
+    while (wrote < len && this->configured()) {
+        auto seen = EPBuffers().events();
+        auto space = this->txSpace();
+        if (space == 0) {
+            this->txKick();
+            if (!EPBuffers().waitForEvent(seen)) {
+                break;
+            }
+            continue;
+        }
+
+        // Only this side moves the head, so copy without masking
+        // interrupts and publish the new head afterwards.
+        uint16_t head = this->txHead;
+        auto n = min(space, len - wrote);
+        auto first = min(n, (size_t)(USBVENDOR_TX_BUFFER_SIZE - head));
+        memcpy(&this->txBuffer[head], d + wrote, first);
+        memcpy(this->txBuffer, d + wrote + first, n - first);
+        this->txHead = (head + n) % USBVENDOR_TX_BUFFER_SIZE;
+        wrote += n;
+
+        this->txKick();
+    }
+
+    if (wrote < len) {
+        this->setWriteError();
+    }
+    return wrote;
+}
+
+void USBVendor::flush()
+{
+    for (;;) {
+        auto seen = EPBuffers().events();
+        if (this->txPending() == 0 || !this->configured()) {
+            return;
+        }
+        this->txKick();
+        if (this->txPending() > 0 && !EPBuffers().waitForEvent(seen)) {
+            return;
+        }
+    }
+}
+
+size_t USBVendor::txPending()
+{
+    uint16_t head = this->txHead;
+    uint16_t tail = this->txTail;
+    return (head + USBVENDOR_TX_BUFFER_SIZE - tail) % USBVENDOR_TX_BUFFER_SIZE;
+}
+
+// One slot stays empty to tell a full ring from an empty one.
+size_t USBVendor::txSpace()
+{
+    return USBVENDOR_TX_BUFFER_SIZE - 1 - this->txPending();
+}
+
+// Move queued data into the IN endpoint while one of its buffers is
+// free, a packet at a time. Runs from both ‘write’ and the USB
+// interrupt, whichever gets here first does the work.
+void USBVendor::txKick()
+{
+    usb_disable_interrupts();
+    if (this->txKicking) {
+        usb_enable_interrupts();
+        return;
+    }
+    this->txKicking = true;
+    usb_enable_interrupts();
+
+    auto& ep = EPBuffers().buf(this->inEndpoint());
+    for (;;) {
+        auto pending = this->txPending();
+        if (pending == 0 || ep.txWaiting || !this->configured()) {
+            break;
+        }
+        // A packet running off the end of the ring is put together
+        // from both ends, so it still goes out full.
+        uint16_t tail = this->txTail;
+        size_t n = min(pending, (size_t)USB_EP_SIZE);
+        size_t first = min(n, (size_t)(USBVENDOR_TX_BUFFER_SIZE - tail));
+        ep.push(&this->txBuffer[tail], first);
+        ep.push(this->txBuffer, n - first);
+        USB_Flush(this->inEndpoint());
+        this->txTail = (tail + n) % USBVENDOR_TX_BUFFER_SIZE;
+    }
+
+    this->txKicking = false;
+
+    // An IN complete that came in while we were busy bounced off
+    // ‘txKicking’, so pick up its work here.
+    if (!ep.txWaiting && this->txPending() > 0 && this->configured()) {
+        this->txKick();
+    }
+}
+
+// Called in interrupt context once the host has taken a packet.
+void USBVendor::transcIn(void* arg, uint8_t ep)
+{
+    (void)ep;
+    ((USBVendor*)arg)->txKick();
+}
+
+// Called in interrupt context with a packet from the host.
+void USBVendor::transcOut(void* arg, uint8_t ep)
+{
+    (void)ep;
+    ((USBVendor*)arg)->rxPull();
+}
+
+#endif
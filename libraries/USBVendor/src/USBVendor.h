@@ -0,0 +1,244 @@
+#pragma once
+
+#include "Arduino.h"
+
+#if defined(USBCON)
+
+#include "api/PluggableUSB.h"
+#include "USBCore.h"
+
+/*
+ * Octets ‘write’ can queue before it has to wait for the host. The
+ * IN endpoint is refilled from this in the USB interrupt, so the
+ * more there is, the longer the sketch can look away without the
+ * bus going idle.
+ */
+#ifndef USBVENDOR_TX_BUFFER_SIZE
+#define USBVENDOR_TX_BUFFER_SIZE 1024
+#endif
+
+/*
+ * Octets received from the host that can wait for ‘read’. The host
+ * is only NAKed when this is full.
+ */
+#ifndef USBVENDOR_RX_BUFFER_SIZE
+#define USBVENDOR_RX_BUFFER_SIZE 512
+#endif
+
+/*
+ * bRequest of the vendor request Windows fetches the MS OS 2.0
+ * descriptor set with. Anything not used by other vendor requests.
+ */
+#ifndef USBVENDOR_MS_VENDOR_CODE
+#define USBVENDOR_MS_VENDOR_CODE 0x20
+#endif
+
+/*
+ * Device interface GUID Windows registers the interface under, what
+ * the host application opens it by. Give each product its own.
+ */
+#ifndef USBVENDOR_INTERFACE_GUID
+#define USBVENDOR_INTERFACE_GUID "{A5BDF9F2-AA31-46CF-B015-29E8F4B960C5}"
+#endif
+
+#define VENDOR_INTERFACE_CLASS  0xff
+
+/* BOS device capability of the MS OS 2.0 platform */
+#define USB_DESCTYPE_DEVICE_CAPABILITY 0x10
+#define USB_DEVCAP_PLATFORM            0x05
+
+/* MS OS 2.0 descriptor types and the vendor request index */
+#define MS_OS_20_SET_HEADER_DESCRIPTOR       0x00
+#define MS_OS_20_SUBSET_HEADER_CONFIGURATION 0x01
+#define MS_OS_20_SUBSET_HEADER_FUNCTION      0x02
+#define MS_OS_20_FEATURE_COMPATIBLE_ID       0x03
+#define MS_OS_20_FEATURE_REG_PROPERTY        0x04
+#define MS_OS_20_DESCRIPTOR_INDEX            0x07
+
+/* Windows 8.1, the first with MS OS 2.0 descriptors */
+#define MS_OS_20_WINDOWS_VERSION 0x06030000UL
+
+#define MS_OS_20_REG_MULTI_SZ    7
+
+/* a GUID in braces, as Windows writes them */
+#define USBVENDOR_GUID_LENGTH    38
+
+#pragma pack(push, 1)
+typedef struct {
+    InterfaceDescriptor vendor;
+    EndpointDescriptor in;
+    EndpointDescriptor out;
+} VendorDescriptor;
+
+/* BOS descriptor with the one capability telling Windows to ask */
+typedef struct {
+    uint8_t bLength;
+    uint8_t bDescriptorType;
+    uint16_t wTotalLength;
+    uint8_t bNumDeviceCaps;
+
+    uint8_t capLength;
+    uint8_t capDescriptorType;
+    uint8_t bDevCapabilityType;
+    uint8_t bReserved;
+    uint8_t platformCapabilityUUID[16];
+    uint32_t dwWindowsVersion;
+    uint16_t wMSOSDescriptorSetTotalLength;
+    uint8_t bMS_VendorCode;
+    uint8_t bAltEnumCode;
+} MSOS20BOSDescriptor;
+
+typedef struct {
+    uint16_t wLength;
+    uint16_t wDescriptorType;
+    uint32_t dwWindowsVersion;
+    uint16_t wTotalLength;
+} MSOS20SetHeader;
+
+typedef struct {
+    uint16_t wLength;
+    uint16_t wDescriptorType;
+    uint8_t bConfigurationValue;
+    uint8_t bReserved;
+    uint16_t wTotalLength;
+} MSOS20ConfigurationSubset;
+
+typedef struct {
+    uint16_t wLength;
+    uint16_t wDescriptorType;
+    uint8_t bFirstInterface;
+    uint8_t bReserved;
+    uint16_t wSubsetLength;
+} MSOS20FunctionSubset;
+
+typedef struct {
+    uint16_t wLength;
+    uint16_t wDescriptorType;
+    char compatibleID[8];
+    char subCompatibleID[8];
+} MSOS20CompatibleID;
+
+/* DeviceInterfaceGUIDs, a REG_MULTI_SZ holding the one GUID */
+typedef struct {
+    uint16_t wLength;
+    uint16_t wDescriptorType;
+    uint16_t wPropertyDataType;
+    uint16_t wPropertyNameLength;
+    uint16_t propertyName[21];
+    uint16_t wPropertyDataLength;
+    uint16_t propertyData[USBVENDOR_GUID_LENGTH + 2];
+} MSOS20InterfaceGUIDs;
+
+/*
+ * Everything below the set header is for the vendor interface alone,
+ * so the CDC-ACM or other functions next to it keep their drivers.
+ */
+typedef struct {
+    MSOS20SetHeader header;
+    MSOS20ConfigurationSubset configuration;
+    MSOS20FunctionSubset function;
+    MSOS20CompatibleID compatibleID;
+    MSOS20InterfaceGUIDs interfaceGUIDs;
+} MSOS20DescriptorSet;
+#pragma pack(pop)
+
+/*
+ * Vendor-specific interface with a bulk IN and a bulk OUT endpoint:
+ * a raw pipe to libusb or WinUSB on the host, without the line state
+ * CDC-ACM waits for or its class requests.
+ *
+ * ‘write’ queues into a ring the USB interrupt drains a packet at a
+ * time into the double-buffered IN endpoint, so the host finds a
+ * packet ready on every IN token and the pipe runs at the full-speed
+ * bulk rate as long as the ring is kept topped up. While the host
+ * keeps up small writes go out at once; once it falls behind they
+ * collect into full packets. The host should read in multiples of
+ * the packet size, no zero length packets are sent.
+ *
+ * The BOS and MS OS 2.0 descriptors bind WinUSB to the interface on
+ * Windows 8.1 and later without an INF, and register it under
+ * ‘interfaceGUID’. Only the first instance serves them.
+ *
+ * Declare at global scope, so it is plugged in before USB enumerates.
+ */
+class USBVendor : public arduino::PluggableUSBModule, public Stream
+{
+    public:
+        USBVendor(const char* interfaceGUID = USBVENDOR_INTERFACE_GUID,
+                  uint8_t vendorCode = USBVENDOR_MS_VENDOR_CODE);
+
+        void begin();
+        void end();
+
+        /*
+         * Whether the host has configured the device, so writes go
+         * anywhere.
+         */
+        operator bool();
+
+        int available();
+        int peek();
+        int read();
+        size_t readBytes(char* buffer, size_t length);
+        size_t readBytes(uint8_t* buffer, size_t length)
+        {
+            return this->readBytes((char*)buffer, length);
+        }
+        int availableForWrite();
+        size_t write(uint8_t c);
+        size_t write(const uint8_t* d, size_t len);
+        /*
+         * Wait until everything queued is in the endpoint.
+         */
+        void flush();
+        using Print::write;
+
+    protected:
+        bool setup(arduino::USBSetup& setup);
+        int getInterface(uint8_t* interfaceCount);
+        int getDescriptor(arduino::USBSetup& setup);
+
+    private:
+        unsigned int epType[2];
+
+        const char* interfaceGUID;
+        MSOS20BOSDescriptor bos;
+
+        uint8_t inEndpoint();
+        uint8_t outEndpoint();
+        bool configured();
+
+        void sendDescriptorSet();
+
+        /*
+         * Receive ring, filled from the OUT endpoint in the interrupt
+         * and drained by ‘read’.
+         */
+        uint8_t rxBuffer[USBVENDOR_RX_BUFFER_SIZE];
+        volatile uint16_t rxHead = 0;
+        volatile uint16_t rxTail = 0;
+        volatile bool rxPulling = false;
+
+        size_t rxPending();
+        size_t rxSpace();
+        void rxPull();
+        size_t rxRead(uint8_t* d, size_t len);
+
+        /*
+         * Transmit ring, filled by ‘write’ and drained into the IN
+         * endpoint from ‘write’ and the IN complete interrupt.
+         */
+        uint8_t txBuffer[USBVENDOR_TX_BUFFER_SIZE];
+        volatile uint16_t txHead = 0;
+        volatile uint16_t txTail = 0;
+        volatile bool txKicking = false;
+
+        size_t txPending();
+        size_t txSpace();
+        void txKick();
+
+        static void transcIn(void* arg, uint8_t ep);
+        static void transcOut(void* arg, uint8_t ep);
+};
+
+#endif
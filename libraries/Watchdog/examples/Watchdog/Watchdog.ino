@@ -0,0 +1,26 @@
+/*
+  Refresh a 2 second watchdog from loop(). Send any character on Serial
+  to make loop() hang; the watchdog resets the board, which tells so
+  after the restart.
+*/
+#include <Watchdog.h>
+
+void setup()
+{
+    Serial.begin(115200);
+    Serial.println(Watchdog.causedReset() ? "restarted by the watchdog" : "started");
+    Serial.print("timeout ");
+    Serial.print(Watchdog.begin(2000));
+    Serial.println(" ms");
+}
+
+void loop()
+{
+    if (Serial.available()) {
+        Serial.println("hanging");
+        while (true) {
+        }
+    }
+    Watchdog.refresh();
+    delay(100);
+}
@@ -38,12 +38,30 @@ TwoWire::TwoWire(uint8_t sda, uint8_t scl, int i2c_index)
     _i2c.sda = DIGITAL_TO_PINNAME(sda);
     _i2c.scl = DIGITAL_TO_PINNAME(scl);
 
+    _rx_buffer.buffer = _rx_storage;
+    _tx_buffer.buffer = _tx_storage;
+    _bufferLength = WIRE_BUFFER_LENGTH;
+
     _i2c.rx_buffer_ptr = _rx_buffer.buffer;
     _i2c.tx_buffer_ptr = _tx_buffer.buffer;
-    _i2c.tx_rx_buffer_size = (uint16_t) sizeof(_tx_buffer.buffer);
+    _i2c.tx_rx_buffer_size = _bufferLength;
+    _i2c.scl_rise_ns = 0;
+    _i2c.timeout_us = WIRE_I2C_TIMEOUT_US;
+    _i2c.auto_recover = 1;
+    memset(&_i2c.stats, 0, sizeof(_i2c.stats));
+    _timeoutsSeen = 0;
     _i2c.tx_count = 0;
     _i2c.rx_count = 0;
     _i2c.index = i2c_index;
+    _i2c.slave_transmit_callback = NULL;
+    _i2c.slave_receive_callback = NULL;
+    _i2c.master_state = 0;
+    _i2c.batch = NULL;
+    _i2c.regmap = NULL;
+
+    asyncCallback = NULL;
+    asyncArg = NULL;
+    asyncQuantity = 0;
 
     _rx_buffer.head = 0;
     _rx_buffer.tail = 0;
@@ -71,6 +89,7 @@ void TwoWire::begin()
 */
 void TwoWire::begin(uint8_t address)
 {
+    i2c_slave_register_map(&_i2c, NULL, 0, NULL, NULL);
     ownAddress = address << 1;
     i2c_init(&_i2c, _i2c.sda, _i2c.scl, ownAddress);
 
@@ -80,6 +99,27 @@ void TwoWire::begin(uint8_t address)
     i2c_attach_slave_rx_callback(&_i2c, &TwoWire::onReceiveService, this);
 }
 
+/*!
+    \brief      configure slave I2C serving a register map
+    \param[in]  address: slave address
+    \param[in]  map: the registers, read and written by the master from the interrupt
+    \param[in]  size: bytes in map, up to 65535, maps above 256 bytes take 2-byte register addresses
+    \param[in]  onWrite: called after the master stored data, may be NULL
+    \param[in]  arg: passed to onWrite
+    \param[out] none
+    \retval     none
+*/
+void TwoWire::beginRegisterMap(uint8_t address, uint8_t *map, size_t size, WireRegisterCallback onWrite, void *arg)
+{
+    if (size > 0xFFFF) {
+        size = 0xFFFF;
+    }
+    ownAddress = address << 1;
+    i2c_init(&_i2c, _i2c.sda, _i2c.scl, ownAddress);
+    i2c_slave_register_map(&_i2c, map, (uint16_t)size, onWrite, arg);
+    i2c_slaves_interrupt_enable(&_i2c);
+}
+
 void TwoWire::begin(int address)
 {
     begin((uint8_t)address);
@@ -91,40 +131,75 @@ void TwoWire::end(void)
     _rx_buffer.head = _rx_buffer.tail;
     //wait for any outstanding data to be sent
     flush();
+    i2c_master_async_wait(&_i2c);
     i2c_deinit(_i2c.i2c);
 }
 
-uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint32_t iaddress, uint8_t isize,
-                             uint8_t sendStop)
+/*!
+    \brief      set the size of the rx and tx buffers, used by requestFrom(), write() and slave mode
+    \param[in]  length: number of bytes, 1 to 65535
+    \param[out] none
+    \retval     the new size, 0 if it couldn't be allocated (the old buffers are kept then)
+*/
+size_t TwoWire::setBufferSize(size_t length)
 {
+    unsigned char *storage = NULL;
 
-    if (isize > 0) {
-        // send internal address; this mode allows sending a repeated start to access
-        // some devices' internal registers. This function is executed by the hardware
-        // TWI module on other processors (for example Due's TWI_IADR and TWI_MMR registers)
-
-        beginTransmission(address);
-
-        // the maximum size of internal address is 3 bytes
-        if (isize > 3) {
-            isize = 3;
-        }
-
-        // write internal register address - most significant byte first
-        while (isize-- > 0) {
-            write((uint8_t)(iaddress >> (isize * 8)));
+    if ((length == 0) || (length > 0xFFFF)) {
+        return 0;
+    }
+    i2c_master_async_wait(&_i2c);
+    if (length > WIRE_BUFFER_LENGTH) {
+        storage = (unsigned char *)malloc(2 * length);
+        if (storage == NULL) {
+            return 0;
         }
-        endTransmission(false);
     }
+    if (_rx_buffer.buffer != _rx_storage) {
+        free(_rx_buffer.buffer);
+    }
+    if (storage != NULL) {
+        _rx_buffer.buffer = storage;
+        _tx_buffer.buffer = storage + length;
+    } else {
+        _rx_buffer.buffer = _rx_storage;
+        _tx_buffer.buffer = _tx_storage;
+    }
+    _bufferLength = (uint16_t)length;
 
+    _rx_buffer.head = 0;
+    _rx_buffer.tail = 0;
+    _tx_buffer.head = 0;
+    _tx_buffer.tail = 0;
+    _i2c.rx_buffer_ptr = _rx_buffer.buffer;
+    _i2c.tx_buffer_ptr = _tx_buffer.buffer;
+    _i2c.tx_rx_buffer_size = _bufferLength;
+    _i2c.tx_count = 0;
+    _i2c.rx_count = 0;
+    return length;
+}
+
+size_t TwoWire::getBufferSize(void)
+{
+    return _bufferLength;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint32_t iaddress, uint8_t isize,
+                             uint8_t sendStop)
+{
+    i2c_master_async_wait(&_i2c);
     // clamp to buffer length
-    if (quantity > WIRE_BUFFER_LENGTH) {
-        quantity = WIRE_BUFFER_LENGTH;
+    if (quantity > _bufferLength) {
+        quantity = _bufferLength;
+    }
+    // the maximum size of internal address is 3 bytes
+    if (isize > 3) {
+        isize = 3;
     }
 
+    // the internal address, repeated start and read are done by the driver in one go
     _rx_buffer.head = 0;
-    if (I2C_OK == i2c_master_receive(&_i2c, address << 1, &_rx_buffer.buffer[_rx_buffer.head], quantity,
-                                     sendStop)) {
+    if (I2C_OK == i2c_mem_read(&_i2c, address << 1, iaddress, isize, _rx_buffer.buffer, quantity, sendStop)) {
         _rx_buffer.head = quantity;
     }
     // set rx buffer iterator vars
@@ -160,6 +235,8 @@ uint8_t TwoWire::requestFrom(int address, int quantity, int sendStop)
 */
 void TwoWire::beginTransmission(uint8_t address)
 {
+    // the buffer may still be going out from endTransmissionAsync()
+    i2c_master_async_wait(&_i2c);
     // indicate that we are transmitting
     transmitting = 1;
     // set address of targeted slave
@@ -196,6 +273,135 @@ uint8_t TwoWire::endTransmission(void)
     return endTransmission((uint8_t)true);
 }
 
+/*!
+    \brief      send the buffered bytes without waiting for the bus
+    \param[in]  callback: called from the I2C interrupt with the endTransmission() status
+    \param[in]  arg: passed to callback
+    \param[in]  sendStop: generate a STOP when done
+    \param[out] none
+    \retval     0 if the transfer was started, I2C_BUSY otherwise
+*/
+uint8_t TwoWire::endTransmissionAsync(WireAsyncCallback callback, void *arg, uint8_t sendStop)
+{
+    uint8_t ret;
+
+    i2c_master_async_wait(&_i2c);
+    asyncCallback = callback;
+    asyncArg = arg;
+    asyncQuantity = 0;
+    ret = i2c_master_transmit_async(&_i2c, txAddress, &_tx_buffer.buffer[_tx_buffer.tail], _i2c.tx_count,
+                                    sendStop, &TwoWire::onAsyncService, this);
+
+    _tx_buffer.head = 0;
+    _tx_buffer.tail = 0;
+    _i2c.tx_count = 0;
+    /* indicate that we are done transmitting */
+    transmitting = 0;
+    return ret;
+}
+
+/*!
+    \brief      read from a slave without waiting for the bus, the bytes are available() once
+                callback has run with status 0
+    \param[in]  address: the 7-bit slave address
+    \param[in]  quantity: number of bytes, clamped to the buffer size
+    \param[in]  callback: called from the I2C interrupt with the endTransmission() status
+    \param[in]  arg: passed to callback
+    \param[in]  sendStop: generate a STOP when done
+    \param[out] none
+    \retval     0 if the transfer was started, I2C_BUSY or I2C_ERROR otherwise
+*/
+uint8_t TwoWire::requestFromAsync(uint8_t address, uint8_t quantity, WireAsyncCallback callback, void *arg,
+                                  uint8_t sendStop)
+{
+    i2c_master_async_wait(&_i2c);
+    // clamp to buffer length
+    if (quantity > _bufferLength) {
+        quantity = _bufferLength;
+    }
+    _rx_buffer.head = 0;
+    _rx_buffer.tail = 0;
+    asyncCallback = callback;
+    asyncArg = arg;
+    asyncQuantity = quantity;
+    return i2c_master_receive_async(&_i2c, address << 1, _rx_buffer.buffer, quantity, sendStop,
+                                    &TwoWire::onAsyncService, this);
+}
+
+/*!
+    \brief      run a batch of transactions without waiting for the bus
+    \param[in]  list: the transactions, they and their buffers must stay valid until callback runs
+    \param[in]  count: number of transactions
+    \param[in]  callback: called from the I2C interrupt with the first error, 0 if all went through
+    \param[in]  arg: passed to callback
+    \param[out] none
+    \retval     0 if the batch was started, I2C_BUSY or I2C_ERROR otherwise
+*/
+uint8_t TwoWire::runTransactions(WireTransaction *list, size_t count, WireAsyncCallback callback, void *arg)
+{
+    if (count > 0xFFFF) {
+        return I2C_DATA_TOO_LONG;
+    }
+    i2c_master_async_wait(&_i2c);
+    asyncCallback = callback;
+    asyncArg = arg;
+    asyncQuantity = 0;
+    return i2c_master_batch_start(&_i2c, list, (uint16_t)count, &TwoWire::onAsyncService, this);
+}
+
+bool TwoWire::asyncPending(void)
+{
+    return i2c_master_async_busy(&_i2c) != 0;
+}
+
+/*!
+    \brief      read a register block straight into the caller's buffer
+    \param[in]  address: the 7-bit slave address
+    \param[in]  reg: the register address
+    \param[in]  regSize: bytes of reg sent (most significant first), up to WIRE_REGISTER_MAX_SIZE, 0 for none
+    \param[out] buffer: receives length bytes
+    \param[in]  length: number of bytes, 1 to 65535
+    \retval     the number of bytes read, 0 on failure
+*/
+size_t TwoWire::readInto(uint8_t address, uint32_t reg, uint8_t regSize, uint8_t *buffer, size_t length)
+{
+    if ((length == 0) || (length > 0xFFFF)) {
+        return 0;
+    }
+    if (I2C_OK != i2c_mem_read(&_i2c, address << 1, reg, regSize, buffer, (uint16_t)length, true)) {
+        return 0;
+    }
+    return length;
+}
+
+size_t TwoWire::readInto(uint8_t address, uint8_t reg, uint8_t *buffer, size_t length)
+{
+    return readInto(address, (uint32_t)reg, 1, buffer, length);
+}
+
+/*!
+    \brief      write a register block straight from the caller's buffer
+    \param[in]  address: the 7-bit slave address
+    \param[in]  reg: the register address
+    \param[in]  regSize: bytes of reg sent (most significant first), up to WIRE_REGISTER_MAX_SIZE, 0 for none
+    \param[in]  buffer: length bytes sent after the register address
+    \param[in]  length: number of bytes, up to 65535
+    \param[out] none
+    \retval     status as returned by endTransmission()
+*/
+uint8_t TwoWire::writeFrom(uint8_t address, uint32_t reg, uint8_t regSize, const uint8_t *buffer, size_t length)
+{
+    if (length > 0xFFFF) {
+        return I2C_DATA_TOO_LONG;
+    }
+    return i2c_mem_write(&_i2c, address << 1, reg, regSize, buffer, (uint16_t)length);
+}
+
+uint8_t TwoWire::writeFrom(uint8_t address, uint8_t reg, const uint8_t *buffer, size_t length)
+{
+    return writeFrom(address, (uint32_t)reg, 1, buffer, length);
+}
+
 // must be called in:
 // slave tx event callback
 // or after beginTransmission(address)
@@ -203,8 +409,12 @@ size_t TwoWire::write(uint8_t data)
 {
     size_t ret = 1;
     if (transmitting) {
+        // the buffer is sent in one go, so it does not wrap around
+        if (_tx_buffer.head >= _bufferLength) {
+            return 0;
+        }
         _tx_buffer.buffer[_tx_buffer.head] = data;
-        _tx_buffer.head = (_tx_buffer.head + 1) % WIRE_BUFFER_LENGTH;
+        _tx_buffer.head++;
         _i2c.tx_count++;
     } else {
         // in slave send mode
@@ -230,7 +440,10 @@ size_t TwoWire::write(const uint8_t *data, size_t quantity)
 
     if (transmitting) {
         for (i = 0; i < quantity; ++i) {
-            write(data[i]);
+            if (!write(data[i])) {
+                ret = i;
+                break;
+            }
         }
     } else {
         // in slave send mode
@@ -244,8 +457,8 @@ size_t TwoWire::write(const uint8_t *data, size_t quantity)
 
 int TwoWire::available(void)
 {
-    return ((unsigned int)(WIRE_BUFFER_LENGTH + _rx_buffer.head - _rx_buffer.tail)) %
-           WIRE_BUFFER_LENGTH;
+    // head is the number of bytes received, so a full buffer is not mistaken for an empty one
+    return _rx_buffer.head - _rx_buffer.tail;
 }
 
 int TwoWire::read(void)
@@ -256,7 +469,7 @@ int TwoWire::read(void)
 
         c = _rx_buffer.buffer[_rx_buffer.tail];
 
-        _rx_buffer.tail = (_rx_buffer.tail + 1) % WIRE_BUFFER_LENGTH;
+        _rx_buffer.tail++;
         return c;
     } else {
         /* TODO: there are no elements in the ringbuffer... think about better error handling here! */
@@ -293,6 +506,18 @@ void TwoWire::onReceiveService(void* pWireObj, uint8_t *inBytes, int numBytes)
     }
 }
 
+// behind the scenes function that is called when an asynchronous transfer is done
+void TwoWire::onAsyncService(void* pWireObj, i2c_status_enum status)
+{
+    TwoWire* pWire = (TwoWire*) pWireObj;
+    if ((I2C_OK == status) && pWire->asyncQuantity) {
+        pWire->_rx_buffer.head = pWire->asyncQuantity;
+    }
+    if (pWire->asyncCallback) {
+        pWire->asyncCallback(pWire->asyncArg, (uint8_t)status);
+    }
+}
+
 // behind the scenes function that is called when data is requested
 void TwoWire::onRequestService(void* pWireObj)
 {
@@ -336,3 +561,43 @@ void TwoWire::setClock(uint32_t clock_hz)
     i2c_enable(_i2c.i2c);
 }
 
+void TwoWire::setClock(uint32_t clock_hz, uint16_t riseTimeNs)
+{
+    _i2c.scl_rise_ns = riseTimeNs;
+    setClock(clock_hz);
+}
+
+void TwoWire::setWireTimeout(uint32_t timeout, bool reset_with_timeout)
+{
+    _i2c.timeout_us = timeout;
+    _i2c.auto_recover = reset_with_timeout ? 1 : 0;
+}
+
+// true if a transfer timed out since the flag was last cleared
+bool TwoWire::getWireTimeoutFlag(void)
+{
+    return _i2c.stats.timeouts != _timeoutsSeen;
+}
+
+void TwoWire::clearWireTimeoutFlag(void)
+{
+    _timeoutsSeen = _i2c.stats.timeouts;
+}
+
+bool TwoWire::recoverBus(void)
+{
+    i2c_master_async_wait(&_i2c);
+    return I2C_OK == i2c_bus_recover(&_i2c);
+}
+
+const WireStats &TwoWire::getStats(void)
+{
+    return _i2c.stats;
+}
+
+void TwoWire::resetStats(void)
+{
+    memset(&_i2c.stats, 0, sizeof(_i2c.stats));
+    _timeoutsSeen = 0;
+}
+
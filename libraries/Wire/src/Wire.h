@@ -32,8 +32,24 @@
 
 #define MASTER_ADDRESS 0x33
 
+/* called from the I2C interrupt when an asynchronous transfer is done, status is the
+ * endTransmission() return code */
+typedef void (*WireAsyncCallback)(void *arg, uint8_t status);
+/* one transaction of runTransactions(), see i2c_transaction_t */
+typedef i2c_transaction_t WireTransaction;
+typedef i2c_stats_t WireStats;
+/* called from the I2C interrupt after the master wrote length registers from reg on */
+typedef void (*WireRegisterCallback)(void *arg, uint16_t reg, uint16_t length);
+
+/* register addresses of readInto()/writeFrom() are at most this long */
+#define WIRE_REGISTER_MAX_SIZE I2C_MEM_ADDRESS_MAX_SIZE
+
+#if ASYNC_COROUTINES
+class AsyncWireTransfer;
+#endif
+
 typedef struct {
-    unsigned char buffer[WIRE_BUFFER_LENGTH];
+    unsigned char *buffer;
     int head;
     int tail;
 } ring_buffer;
@@ -51,10 +67,22 @@ class TwoWire : public Stream
 
         static void onRequestService(void* pWireObj);
         static void onReceiveService(void* pWireObj, uint8_t *, int);
+        static void onAsyncService(void* pWireObj, i2c_status_enum status);
+
+        WireAsyncCallback asyncCallback;
+        void *asyncArg;
+        uint8_t asyncQuantity;
+
+        /* buffers up to WIRE_BUFFER_LENGTH live here, larger ones come from setBufferSize() */
+        unsigned char _rx_storage[WIRE_BUFFER_LENGTH];
+        unsigned char _tx_storage[WIRE_BUFFER_LENGTH];
+        uint16_t _bufferLength;
+        /* stats.timeouts when the timeout flag was last cleared */
+        uint32_t _timeoutsSeen;
 
     protected:
-        ring_buffer _rx_buffer = {{0}, 0, 0};;
-        ring_buffer _tx_buffer = {{0}, 0, 0};;
+        ring_buffer _rx_buffer = {NULL, 0, 0};
+        ring_buffer _tx_buffer = {NULL, 0, 0};
         void (*user_onRequest)(void);
         void (*user_onReceive)(int);
 
@@ -65,8 +93,26 @@ class TwoWire : public Stream
         void begin();
         void begin(uint8_t address);
         void begin(int);
+        /* slave that looks like a register-mapped device, reads and writes of map are served from
+         * the interrupt with auto-increment, onWrite runs after each write */
+        void beginRegisterMap(uint8_t address, uint8_t *map, size_t size, WireRegisterCallback onWrite = NULL,
+                              void *arg = NULL);
         void end();
+        /* size of the rx and tx buffers, call before begin(). Returns the new size or 0 on failure */
+        size_t setBufferSize(size_t length);
+        size_t getBufferSize(void);
         void setClock(uint32_t);
+        /* riseTimeNs is the measured SCL rise time, it is compensated for in the clock period */
+        void setClock(uint32_t clock_hz, uint16_t riseTimeNs);
+        /* longest wait of the blocking calls in us, 0 for ever. With reset_with_timeout a bus left
+         * busy by a stuck slave is recovered on the next transfer */
+        void setWireTimeout(uint32_t timeout = WIRE_I2C_TIMEOUT_US, bool reset_with_timeout = true);
+        bool getWireTimeoutFlag(void);
+        void clearWireTimeoutFlag(void);
+        /* clock SCL until the slave holding SDA lets go, then restart the I2C. true if the bus is free */
+        bool recoverBus(void);
+        const WireStats &getStats(void);
+        void resetStats(void);
         void beginTransmission(uint8_t);
         void beginTransmission(int);
         uint8_t endTransmission(void);
@@ -76,6 +122,31 @@ class TwoWire : public Stream
         uint8_t requestFrom(uint8_t, uint8_t, uint32_t, uint8_t, uint8_t);
         uint8_t requestFrom(int, int);
         uint8_t requestFrom(int, int, int);
+        /* start the transfer and return at once, 0 if it was started. The tx buffer (or the rx
+         * buffer for requestFromAsync) belongs to the transfer until callback runs */
+        uint8_t endTransmissionAsync(WireAsyncCallback callback, void *arg = NULL, uint8_t sendStop = true);
+        uint8_t requestFromAsync(uint8_t address, uint8_t quantity, WireAsyncCallback callback, void *arg = NULL,
+                                 uint8_t sendStop = true);
+        bool asyncPending(void);
+#if ASYNC_COROUTINES
+        /* co_await forms of the above and of one transaction of runTransactions(): they let the other
+         * tasks run until the transfer is done and give its endTransmission() status. See Async.h */
+        AsyncWireTransfer endTransmissionAsync(void);
+        AsyncWireTransfer requestFromAsync(uint8_t address, uint8_t quantity);
+        AsyncWireTransfer transferAsync(uint8_t address, const uint8_t *txBuffer, size_t txLength,
+                                        uint8_t *rxBuffer, size_t rxLength);
+#endif
+        /* run the transactions back to back from the I2C interrupt, callback runs once for the batch
+         * with the first error or 0. Returns 0 if the batch was started */
+        uint8_t runTransactions(WireTransaction *list, size_t count, WireAsyncCallback callback, void *arg = NULL);
+        /* write the register address, then read length bytes straight into buffer with a repeated
+         * start. Returns the number of bytes read, 0 on failure */
+        size_t readInto(uint8_t address, uint8_t reg, uint8_t *buffer, size_t length);
+        size_t readInto(uint8_t address, uint32_t reg, uint8_t regSize, uint8_t *buffer, size_t length);
+        /* write the register address followed by length bytes from buffer in one transfer.
+         * Returns the endTransmission() status */
+        uint8_t writeFrom(uint8_t address, uint8_t reg, const uint8_t *buffer, size_t length);
+        uint8_t writeFrom(uint8_t address, uint32_t reg, uint8_t regSize, const uint8_t *buffer, size_t length);
         virtual size_t write(uint8_t);
         virtual size_t write(const uint8_t *, size_t);
         virtual int available(void);
@@ -104,6 +175,84 @@ class TwoWire : public Stream
         using Print::write;
 };
 
+#if ASYNC_COROUTINES
+/* awaitable of TwoWire's co_await transfers, completed from the I2C interrupt */
+class AsyncWireTransfer : public AsyncOperation<AsyncWireTransfer, uint8_t>
+{
+    public:
+        enum Kind { END_TRANSMISSION, REQUEST_FROM, TRANSACTION };
+
+        AsyncWireTransfer(TwoWire *wire, Kind kind, uint8_t address, const uint8_t *txBuffer, size_t txLength,
+                          uint8_t *rxBuffer, size_t rxLength)
+            : AsyncOperation(I2C_ERROR), wire(wire), kind(kind)
+        {
+            transaction.address = address;
+            transaction.tx_buffer = txBuffer;
+            transaction.tx_length = (uint16_t)txLength;
+            transaction.rx_buffer = rxBuffer;
+            transaction.rx_length = (uint16_t)rxLength;
+            transaction.status = I2C_OK;
+            if ((txLength > 0xFFFF) || (rxLength > 0xFFFF)) {
+                this->kind = TOO_LONG;
+            }
+        }
+        bool start(void)
+        {
+            uint8_t status;
+
+            switch (kind) {
+                case END_TRANSMISSION:
+                    status = wire->endTransmissionAsync(&AsyncWireTransfer::done, this);
+                    break;
+                case REQUEST_FROM:
+                    status = wire->requestFromAsync(transaction.address, (uint8_t)transaction.rx_length,
+                                                    &AsyncWireTransfer::done, this);
+                    break;
+                case TRANSACTION:
+                    status = wire->runTransactions(&transaction, 1, &AsyncWireTransfer::done, this);
+                    break;
+                default:
+                    status = I2C_DATA_TOO_LONG;
+                    break;
+            }
+            if (status != 0) {
+                result = status;
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        enum { TOO_LONG = TRANSACTION + 1 };
+
+        static void done(void *arg, uint8_t status)
+        {
+            ((AsyncWireTransfer *)arg)->complete(status);
+        }
+
+        TwoWire *wire;
+        uint8_t kind;
+        WireTransaction transaction;
+};
+
+inline AsyncWireTransfer TwoWire::endTransmissionAsync(void)
+{
+    return AsyncWireTransfer(this, AsyncWireTransfer::END_TRANSMISSION, 0, NULL, 0, NULL, 0);
+}
+
+inline AsyncWireTransfer TwoWire::requestFromAsync(uint8_t address, uint8_t quantity)
+{
+    return AsyncWireTransfer(this, AsyncWireTransfer::REQUEST_FROM, address, NULL, 0, NULL, quantity);
+}
+
+inline AsyncWireTransfer TwoWire::transferAsync(uint8_t address, const uint8_t *txBuffer, size_t txLength,
+                                                uint8_t *rxBuffer, size_t rxLength)
+{
+    return AsyncWireTransfer(this, AsyncWireTransfer::TRANSACTION, address, txBuffer, txLength, rxBuffer,
+                             rxLength);
+}
+#endif
+
 #if defined(HAVE_I2C)
 extern TwoWire Wire;
 #endif
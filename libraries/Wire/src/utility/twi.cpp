@@ -27,8 +27,10 @@ OF SUCH DAMAGE.
     Based on mbed-os\targets\TARGET_GigaDevice\TARGET_GD32F30X\i2c_api.c
 */
 
+#include "Arduino.h"
 #include "utility/twi.h"
 #include "pinmap.h"
+#include "os_event.h"
 #include "twi.h"
 
 typedef enum {
@@ -46,45 +48,129 @@ typedef enum {
 
 static struct i2c_s *obj_s_buf[I2C_NUM] = {NULL};
 
-#ifndef WIRE_I2C_FLAG_TIMEOUT
-#define WIRE_I2C_FLAG_TIMEOUT  (0xF0000U)
-#endif
+#define I2C_S(obj)    (struct i2c_s *) (obj)
 
-#ifndef WIRE_I2C_FLAG_TIMEOUT_BUSY
-#define WIRE_I2C_FLAG_TIMEOUT_BUSY WIRE_I2C_FLAG_TIMEOUT
-#endif
+/* asynchronous master transfer states */
+#define I2C_MASTER_IDLE     0U
+#define I2C_MASTER_START    1U
+#define I2C_MASTER_ADDRESS  2U
+#define I2C_MASTER_DATA     3U
 
-#ifndef WIRE_I2C_FLAG_TIMEOUT_START
-#define WIRE_I2C_FLAG_TIMEOUT_START WIRE_I2C_FLAG_TIMEOUT
+#if defined(GD32F1x0) || defined(GD32F3x0) || defined(GD32F4xx) || defined(GD32E23x)|| defined(GD32E50X)
+#define GD32_I2C_FLAG_IS_TRANSMTR_OR_RECVR I2C_FLAG_TR
+#else
+#define GD32_I2C_FLAG_IS_TRANSMTR_OR_RECVR I2C_FLAG_TRS
 #endif
 
-#ifndef WIRE_I2C_FLAG_TIMEOUT_STOP_BIT_RESET
-#define WIRE_I2C_FLAG_TIMEOUT_STOP_BIT_RESET WIRE_I2C_FLAG_TIMEOUT
-#endif
+/* half an SCL period of the bus recovery clocking, 100 kHz */
+#define I2C_RECOVERY_HALF_PERIOD_US  5U
+/* clocks it takes for any slave to let go of SDA */
+#define I2C_RECOVERY_CLOCKS          9U
 
-#ifndef WIRE_I2C_FLAG_TIMEOUT_ADDR_ACK
-#define WIRE_I2C_FLAG_TIMEOUT_ADDR_ACK WIRE_I2C_FLAG_TIMEOUT
+#if defined(GD32F30x) || defined(GD32F10x) || defined(GD32E50X)
+#define I2C_RECOVERY_PIN_FUNCTION    GD_PIN_FUNCTION3(PIN_MODE_OUT_OD, PIN_OTYPE_OD, 0)
+#else
+#define I2C_RECOVERY_PIN_FUNCTION    GD_PIN_FUNCTION3(PIN_MODE_OUTPUT, PIN_OTYPE_OD, 0)
 #endif
 
-#ifndef WIRE_I2C_FLAG_TIMEOUT_DATA_ACK
-#define WIRE_I2C_FLAG_TIMEOUT_DATA_ACK WIRE_I2C_FLAG_TIMEOUT
-#endif
+/** Check the bus timeout
+ *
+ * @param obj_s The I2C object
+ * @param start micros() when the wait began
+ * @return Non-zero once the timeout of the bus has passed
+ */
+static int i2c_timed_out(struct i2c_s *obj_s, uint32_t start)
+{
+    /* 0 waits for ever */
+    return (0U != obj_s->timeout_us) && (((uint32_t)micros() - start) > obj_s->timeout_us);
+}
 
-#ifndef WIRE_I2C_FLAG_TIMEOUT_BYTE_TRANSMITTED
-#define WIRE_I2C_FLAG_TIMEOUT_BYTE_TRANSMITTED WIRE_I2C_FLAG_TIMEOUT
-#endif
+/** Wait for a flag, at most the bus timeout
+ *
+ * @param obj_s  The I2C object
+ * @param flag   The flag
+ * @param status The level waited for
+ * @return Non-zero if the flag got there in time
+ */
+static int i2c_flag_wait(struct i2c_s *obj_s, i2c_flag_enum flag, FlagStatus status)
+{
+    uint32_t start = micros();
 
-#ifndef WIRE_I2C_FLAG_TIMEOUT_BYTE_RECEIVED
-#define WIRE_I2C_FLAG_TIMEOUT_BYTE_RECEIVED WIRE_I2C_FLAG_TIMEOUT
-#endif
+    while (i2c_flag_get(obj_s->i2c, flag) != status) {
+        if (i2c_timed_out(obj_s, start)) {
+            /* it may have come up while the time was checked */
+            return i2c_flag_get(obj_s->i2c, flag) == status;
+        }
+    }
+    return 1;
+}
 
-#define I2C_S(obj)    (struct i2c_s *) (obj)
+/** Wait for the address to be acknowledged
+ *
+ * A NACK sets AERR, so an absent device is known at the end of the address byte instead of after
+ * the bus timeout.
+ * @param obj_s The I2C object
+ * @return Non-zero if ADDSEND came up
+ */
+static int i2c_address_wait(struct i2c_s *obj_s)
+{
+    uint32_t start = micros();
+    uint32_t stat0;
 
-#if defined(GD32F1x0) || defined(GD32F3x0) || defined(GD32F4xx) || defined(GD32E23x)|| defined(GD32E50X)
-#define GD32_I2C_FLAG_IS_TRANSMTR_OR_RECVR I2C_FLAG_TR
-#else
-#define GD32_I2C_FLAG_IS_TRANSMTR_OR_RECVR I2C_FLAG_TRS
-#endif
+    do {
+        stat0 = I2C_STAT0(obj_s->i2c);
+        if (stat0 & I2C_STAT0_ADDSEND) {
+            return 1;
+        }
+    } while (!(stat0 & I2C_STAT0_AERR) && !i2c_timed_out(obj_s, start));
+
+    i2c_flag_clear(obj_s->i2c, I2C_FLAG_AERR);
+    return 0;
+}
+
+/** Count the outcome of a transfer in the bus statistics
+ *
+ * Arbitration loss and bus errors don't show up in the status of the blocking calls, their flags
+ * are picked up and cleared here.
+ * @param obj_s  The I2C object
+ * @param status The transfer status
+ * @return status
+ */
+static i2c_status_enum i2c_stats_count(struct i2c_s *obj_s, i2c_status_enum status)
+{
+    uint32_t stat0 = I2C_STAT0(obj_s->i2c);
+
+    switch (status) {
+        case I2C_NACK_ADDR:
+            obj_s->stats.nack_addr++;
+            break;
+        case I2C_NACK_DATA:
+            obj_s->stats.nack_data++;
+            break;
+        case I2C_TIMEOUT:
+            /* I2C_BUSY is counted by _i2c_busy_wait() */
+            obj_s->stats.timeouts++;
+            break;
+        default:
+            break;
+    }
+    if (stat0 & I2C_STAT0_LOSTARB) {
+        i2c_flag_clear(obj_s->i2c, I2C_FLAG_LOSTARB);
+        obj_s->stats.arbitration_lost++;
+    }
+    if (stat0 & I2C_STAT0_BERR) {
+        i2c_flag_clear(obj_s->i2c, I2C_FLAG_BERR);
+        obj_s->stats.bus_errors++;
+    }
+    return status;
+}
+
+static i2c_status_enum i2c_master_write_bytes(i2c_t *obj, uint8_t address, const uint8_t *prefix,
+                                              uint16_t prefix_length, const uint8_t *data, uint16_t length,
+                                              uint8_t stop);
+static i2c_status_enum i2c_master_read_bytes(i2c_t *obj, uint8_t address, uint8_t *data, uint16_t length,
+                                             int stop);
+static i2c_status_enum i2c_master_probe(i2c_t *obj, uint8_t address);
 
 /** Initialize the I2C peripheral
  *
@@ -104,6 +190,8 @@ void i2c_init(i2c_t *obj, PinName sda, PinName scl, uint8_t address)
 
     obj_s->sda = sda;
     obj_s->scl = scl;
+    obj_s->own_address = address;
+    obj_s->clock_hz = default_speed;
     obj_s->i2c = pinmap_merge(i2c_sda, i2c_scl);
 
     switch (obj_s->i2c) {
@@ -147,45 +235,44 @@ void i2c_init(i2c_t *obj, PinName sda, PinName scl, uint8_t address)
     obj_s_buf[obj_s->index] = obj_s;
 }
 
-/** Enable the I2C interrupt
+/** Enable the event and error lines of the I2C in the NVIC
  *
- * @param obj       The I2C object
+ * @param obj_s     The I2C object
  */
-void i2c_slaves_interrupt_enable(i2c_t *obj)
+static void i2c_nvic_enable(struct i2c_s *obj_s)
 {
-    struct i2c_s *obj_s = I2C_S(obj);
     switch (obj_s->i2c) {
         case I2C0:
             /* enable I2C0 interrupt */
-#if !defined(GD32E23x)
-            nvic_irq_enable(I2C0_EV_IRQn, 1, 3);
-            nvic_irq_enable(I2C0_ER_IRQn, 1, 2);
-#else 
-            nvic_irq_enable(I2C0_EV_IRQn, 1);
-            nvic_irq_enable(I2C0_ER_IRQn, 1);
-#endif           
+            irq_priority_enable(I2C0_EV_IRQn, IRQ_PRIO_I2C);
+            irq_priority_enable(I2C0_ER_IRQn, IRQ_PRIO_I2C);
             break;
         case I2C1:
             /* enable I2C1 interrupt */
-#if !defined(GD32E23x)
-            nvic_irq_enable(I2C1_EV_IRQn, 1, 3);
-            nvic_irq_enable(I2C1_ER_IRQn, 1, 2);
-#else 
-            nvic_irq_enable(I2C1_EV_IRQn, 1);
-            nvic_irq_enable(I2C1_ER_IRQn, 1);
-#endif           
+            irq_priority_enable(I2C1_EV_IRQn, IRQ_PRIO_I2C);
+            irq_priority_enable(I2C1_ER_IRQn, IRQ_PRIO_I2C);
             break;
 #ifdef I2C2
         case I2C2:
             /* enable I2C2 interrupt */
-            nvic_irq_enable(I2C2_EV_IRQn, 1, 3);
-            nvic_irq_enable(I2C2_ER_IRQn, 1, 2);
+            irq_priority_enable(I2C2_EV_IRQn, IRQ_PRIO_I2C);
+            irq_priority_enable(I2C2_ER_IRQn, IRQ_PRIO_I2C);
             break;
 #endif
         default:
             break;
     }
+}
 
+/** Enable the I2C interrupt
+ *
+ * @param obj       The I2C object
+ */
+void i2c_slaves_interrupt_enable(i2c_t *obj)
+{
+    struct i2c_s *obj_s = I2C_S(obj);
+
+    i2c_nvic_enable(obj_s);
     i2c_interrupt_enable(obj_s->i2c, I2C_INT_ERR);
     i2c_interrupt_enable(obj_s->i2c, I2C_INT_BUF);
     i2c_interrupt_enable(obj_s->i2c, I2C_INT_EV);
@@ -199,16 +286,20 @@ void i2c_slaves_interrupt_enable(i2c_t *obj)
  */
 i2c_status_enum i2c_byte_write(i2c_t *obj, int data)
 {
-    uint32_t timeout;
     struct i2c_s *obj_s = I2C_S(obj);
+    uint32_t start;
 
     I2C_DATA(obj_s->i2c) = (uint8_t)data;
 
     /* wait until the byte is transmitted */
-    timeout = WIRE_I2C_FLAG_TIMEOUT_BYTE_TRANSMITTED;
+    start = micros();
     while (((i2c_flag_get(obj_s->i2c, I2C_FLAG_TBE)) == RESET) &&
            ((i2c_flag_get(obj_s->i2c, I2C_FLAG_BTC)) == RESET)) {
-        if ((timeout--) == 0) {
+        if (i2c_flag_get(obj_s->i2c, I2C_FLAG_AERR)) {
+            i2c_flag_clear(obj_s->i2c, I2C_FLAG_AERR);
+            return I2C_NACK_DATA;
+        }
+        if (i2c_timed_out(obj_s, start)) {
             return I2C_TIMEOUT;
         }
     }
@@ -227,9 +318,9 @@ i2c_status_enum  i2c_stop(i2c_t *obj)
     i2c_stop_on_bus(obj_s->i2c);
 
     /* wait for STOP bit reset with timeout */
-    int timeout = WIRE_I2C_FLAG_TIMEOUT_STOP_BIT_RESET;
+    uint32_t start = micros();
     while ((I2C_CTL0(obj_s->i2c) & I2C_CTL0_STOP)) {
-        if ((timeout--) == 0) {
+        if (i2c_timed_out(obj_s, start)) {
             return I2C_TIMEOUT;
         }
     }
@@ -249,19 +340,52 @@ i2c_status_enum  i2c_stop(i2c_t *obj)
 i2c_status_enum i2c_master_transmit(i2c_t *obj, uint8_t address, uint8_t *data, uint16_t length,
                                     uint8_t stop)
 {
+    return i2c_master_transmit_prefixed(obj, address, NULL, 0, data, length, stop);
+}
 
-
+/** Write a prefix (e.g. a register address) and then bytes from another buffer in one transfer
+ *
+ * @param obj           The I2C object
+ * @param address       7-bit address (last bit is 0)
+ * @param prefix        The bytes sent first
+ * @param prefix_length Number of prefix bytes
+ * @param data          The buffer for sending after the prefix
+ * @param length        Number of bytes to write from data
+ * @param stop          Stop to be generated after the transfer is done
+ * @return Status
+ */
+i2c_status_enum i2c_master_transmit_prefixed(i2c_t *obj, uint8_t address, const uint8_t *prefix,
+                                             uint16_t prefix_length, const uint8_t *data, uint16_t length,
+                                             uint8_t stop)
+{
     /* When size is 0, this is usually an I2C scan / ping to check if device is there and ready */
-    if (length == 0) {
+    if ((prefix_length + length) == 0) {
         return i2c_wait_standby_state(obj, address);
     }
+    return i2c_stats_count(I2C_S(obj), i2c_master_write_bytes(obj, address, prefix, prefix_length, data, length,
+                                                              stop));
+}
 
+/** Write bytes at a given address, the body of i2c_master_transmit_prefixed()
+ *
+ * @param obj           The I2C object
+ * @param address       7-bit address (last bit is 0)
+ * @param prefix        The bytes sent first
+ * @param prefix_length Number of prefix bytes
+ * @param data          The buffer for sending after the prefix
+ * @param length        Number of bytes to write from data
+ * @param stop          Stop to be generated after the transfer is done
+ * @return Status
+ */
+static i2c_status_enum i2c_master_write_bytes(i2c_t *obj, uint8_t address, const uint8_t *prefix,
+                                              uint16_t prefix_length, const uint8_t *data, uint16_t length,
+                                              uint8_t stop)
+{
+    struct i2c_s *obj_s = I2C_S(obj);
     i2c_status_enum ret = I2C_OK;
-    uint32_t timeout = 0;
     uint32_t count = 0;
 
-
-
+    i2c_master_async_wait(obj);
     if (I2C_BUSY == _i2c_busy_wait(obj)) {
         return I2C_BUSY;
     }
@@ -270,9 +394,7 @@ i2c_status_enum i2c_master_transmit(i2c_t *obj, uint8_t address, uint8_t *data,
     i2c_start_on_bus(obj->i2c);
 
     /* ensure the i2c has been started successfully */
-    timeout = WIRE_I2C_FLAG_TIMEOUT_START;
-    while ((!i2c_flag_get(obj->i2c, I2C_FLAG_SBSEND)) && (--timeout != 0));
-    if (0 == timeout) {
+    if (!i2c_flag_wait(obj_s, I2C_FLAG_SBSEND, SET)) {
         return I2C_TIMEOUT;
     }
 
@@ -280,28 +402,27 @@ i2c_status_enum i2c_master_transmit(i2c_t *obj, uint8_t address, uint8_t *data,
     i2c_master_addressing(obj->i2c, address, I2C_TRANSMITTER);
 
     /* wait until I2C_FLAG_ADDSEND flag is set */
-    timeout = WIRE_I2C_FLAG_TIMEOUT_ADDR_ACK;
-    while ((!i2c_flag_get(obj->i2c, I2C_FLAG_ADDSEND)) && (--timeout != 0));
-    if (0 == timeout) {
+    if (!i2c_address_wait(obj_s)) {
         ret = I2C_NACK_ADDR;
     }
 
     /* clear ADDSEND */
     i2c_flag_clear(obj->i2c, I2C_FLAG_ADDSEND);
 
-
-
-    for (count = 0; count < length; count++) {
+    for (count = 0; count < prefix_length; count++) {
         if (I2C_OK != ret) {
             break;
         }
-        if (I2C_OK != i2c_byte_write(obj, data[count])) {
-            // If we didn't write the byte successfully,
-            // we really don't want to keep trying to write subsequent
-            // bytes
-
-            ret = I2C_NACK_DATA;
+        ret = i2c_byte_write(obj, prefix[count]);
+    }
+    for (count = 0; count < length; count++) {
+        if (I2C_OK != ret) {
+            break;
         }
+        // If we didn't write the byte successfully,
+        // we really don't want to keep trying to write subsequent
+        // bytes
+        ret = i2c_byte_write(obj, data[count]);
     }
     /* if not sequential write, then send stop */
     if (stop) {
@@ -329,11 +450,8 @@ static int i2c_byte_read(i2c_t *obj, int last)
     }
 
     /* wait until the byte is received */
-    uint32_t timeout = WIRE_I2C_FLAG_TIMEOUT_BYTE_RECEIVED;
-    while ((i2c_flag_get(obj_s->i2c, I2C_FLAG_RBNE)) == RESET) {
-        if ((timeout--) == 0) {
-            return -1;
-        }
+    if (!i2c_flag_wait(obj_s, I2C_FLAG_RBNE, SET)) {
+        return -1;
     }
     return (int)I2C_DATA(obj_s->i2c);
 }
@@ -350,10 +468,26 @@ static int i2c_byte_read(i2c_t *obj, int last)
 i2c_status_enum i2c_master_receive(i2c_t *obj, uint8_t address, uint8_t *data, uint16_t length,
                                    int stop)
 {
+    return i2c_stats_count(I2C_S(obj), i2c_master_read_bytes(obj, address, data, length, stop));
+}
+
+/** read bytes in master mode at a given address, the body of i2c_master_receive()
+ *
+ * @param obj     The I2C object
+ * @param address 7-bit address (last bit is 1)
+ * @param data    The buffer for receiving
+ * @param length  Number of bytes to read
+ * @param stop    Stop to be generated after the transfer is done
+ * @return status
+ */
+static i2c_status_enum i2c_master_read_bytes(i2c_t *obj, uint8_t address, uint8_t *data, uint16_t length,
+                                             int stop)
+{
+    struct i2c_s *obj_s = I2C_S(obj);
     i2c_status_enum ret = I2C_OK;
-    uint32_t timeout = 0;
     uint32_t count = 0;
 
+    i2c_master_async_wait(obj);
     if (I2C_BUSY == _i2c_busy_wait(obj)) {
         return I2C_BUSY;
     }
@@ -373,20 +507,15 @@ i2c_status_enum i2c_master_receive(i2c_t *obj, uint8_t address, uint8_t *data, u
         /* enable acknowledge */
         i2c_ack_config(obj->i2c, I2C_ACK_ENABLE);
     }
-    /* ensure the i2c has been started successfully */
-    timeout = WIRE_I2C_FLAG_TIMEOUT_START;
     /* generate a START condition */
     i2c_start_on_bus(obj->i2c);
-    while ((!i2c_flag_get(obj->i2c, I2C_FLAG_SBSEND)) && (--timeout != 0));
-    if (0 == timeout) {
+    /* ensure the i2c has been started successfully */
+    if (!i2c_flag_wait(obj_s, I2C_FLAG_SBSEND, SET)) {
         return I2C_TIMEOUT;
     }
     /* send slave address */
     i2c_master_addressing(obj->i2c, address, I2C_RECEIVER);
-    timeout = WIRE_I2C_FLAG_TIMEOUT_ADDR_ACK;
-    while ((!i2c_flag_get(obj->i2c, I2C_FLAG_ADDSEND)) && (--timeout != 0));
-
-    if (0 == timeout) {
+    if (!i2c_address_wait(obj_s)) {
         ret = I2C_NACK_ADDR;
     }
 
@@ -398,30 +527,19 @@ i2c_status_enum i2c_master_receive(i2c_t *obj, uint8_t address, uint8_t *data, u
             break;
         }
         if (length > 2 && count == (uint32_t)length - 3) {
-            timeout = WIRE_I2C_FLAG_TIMEOUT_DATA_ACK;
-
-            while ((!i2c_flag_get(obj->i2c, I2C_FLAG_BTC)) && (--timeout != 0));
-
-            if (0 == timeout) {
-                ret = I2C_NACK_DATA;
+            if (!i2c_flag_wait(obj_s, I2C_FLAG_BTC, SET)) {
+                ret = I2C_TIMEOUT;
             }
 
             i2c_ack_config(obj->i2c, I2C_ACK_DISABLE);
         } else if (2 == length && count == 0) {
-            timeout = WIRE_I2C_FLAG_TIMEOUT_DATA_ACK;
-
-            while ((!i2c_flag_get(obj->i2c, I2C_FLAG_BTC)) && (--timeout != 0));
-
-            if (0 == timeout) {
-                ret = I2C_NACK_DATA;
+            if (!i2c_flag_wait(obj_s, I2C_FLAG_BTC, SET)) {
+                ret = I2C_TIMEOUT;
             }
         }
 
-
-        timeout = WIRE_I2C_FLAG_TIMEOUT_BYTE_RECEIVED;
-        while ((!i2c_flag_get(obj->i2c, I2C_FLAG_RBNE)) && (--timeout != 0));
-        if (0 == timeout) {
-            ret = I2C_NACK_DATA;
+        if (!i2c_flag_wait(obj_s, I2C_FLAG_RBNE, SET)) {
+            ret = I2C_TIMEOUT;
         } else {
             data[count] = i2c_data_receive(obj->i2c);
         };
@@ -433,6 +551,76 @@ i2c_status_enum i2c_master_receive(i2c_t *obj, uint8_t address, uint8_t *data, u
     return ret;
 }
 
+/** Split a memory address into bytes, most significant first
+ *
+ * @param mem_address The memory address
+ * @param mem_size    Number of bytes, up to I2C_MEM_ADDRESS_MAX_SIZE
+ * @param prefix      Receives the bytes
+ */
+static void i2c_mem_address_get(uint32_t mem_address, uint8_t mem_size, uint8_t *prefix)
+{
+    uint8_t i;
+
+    for (i = 0; i < mem_size; i++) {
+        prefix[i] = (uint8_t)(mem_address >> ((mem_size - 1U - i) * 8U));
+    }
+}
+
+/** Read from a memory or register address of a device
+ *
+ * START, address + W, memory address, repeated START, address + R, data, STOP in one call
+ * @param obj         The I2C object
+ * @param address     7-bit address (last bit is 0)
+ * @param mem_address The memory or register address
+ * @param mem_size    Bytes of mem_address sent, up to I2C_MEM_ADDRESS_MAX_SIZE
+ * @param data        The buffer for receiving
+ * @param length      Number of bytes to read
+ * @param stop        Stop to be generated after the transfer is done
+ * @return status
+ */
+i2c_status_enum i2c_mem_read(i2c_t *obj, uint8_t address, uint32_t mem_address, uint8_t mem_size, uint8_t *data,
+                             uint16_t length, uint8_t stop)
+{
+    uint8_t prefix[I2C_MEM_ADDRESS_MAX_SIZE];
+    i2c_status_enum ret;
+
+    if (mem_size > I2C_MEM_ADDRESS_MAX_SIZE) {
+        return I2C_DATA_TOO_LONG;
+    }
+    if (mem_size > 0U) {
+        i2c_mem_address_get(mem_address, mem_size, prefix);
+        ret = i2c_master_transmit_prefixed(obj, address, prefix, mem_size, NULL, 0, 0);
+        if (I2C_OK != ret) {
+            /* don't leave the bus held after a NACK */
+            i2c_stop(obj);
+            return ret;
+        }
+    }
+    return i2c_master_receive(obj, address, data, length, stop);
+}
+
+/** Write to a memory or register address of a device
+ *
+ * @param obj         The I2C object
+ * @param address     7-bit address (last bit is 0)
+ * @param mem_address The memory or register address
+ * @param mem_size    Bytes of mem_address sent, up to I2C_MEM_ADDRESS_MAX_SIZE
+ * @param data        The bytes written after mem_address
+ * @param length      Number of bytes to write
+ * @return status
+ */
+i2c_status_enum i2c_mem_write(i2c_t *obj, uint8_t address, uint32_t mem_address, uint8_t mem_size,
+                              const uint8_t *data, uint16_t length)
+{
+    uint8_t prefix[I2C_MEM_ADDRESS_MAX_SIZE];
+
+    if (mem_size > I2C_MEM_ADDRESS_MAX_SIZE) {
+        return I2C_DATA_TOO_LONG;
+    }
+    i2c_mem_address_get(mem_address, mem_size, prefix);
+    return i2c_master_transmit_prefixed(obj, address, prefix, mem_size, data, length, 1);
+}
+
 /** Checks if target device is ready for communication
  *
  * @param obj     The I2C object
@@ -441,36 +629,46 @@ i2c_status_enum i2c_master_receive(i2c_t *obj, uint8_t address, uint8_t *data, u
  */
 i2c_status_enum i2c_wait_standby_state(i2c_t *obj, uint8_t address)
 {
+    return i2c_stats_count(I2C_S(obj), i2c_master_probe(obj, address));
+}
+
+/** Checks if target device is ready for communication, the body of i2c_wait_standby_state()
+ *
+ * @param obj     The I2C object
+ * @param address 7-bit address (last bit is 1)
+ * @return status
+ */
+static i2c_status_enum i2c_master_probe(i2c_t *obj, uint8_t address)
+{
+    struct i2c_s *obj_s = I2C_S(obj);
     __IO uint32_t val = 0;
     i2c_status_enum status = I2C_OK;
-    uint32_t timeout;
-
+    uint32_t start;
 
+    i2c_master_async_wait(obj);
     if (I2C_BUSY == _i2c_busy_wait(obj)) {
         return I2C_BUSY;
     }
 
     /* send a start condition to I2C bus */
     i2c_start_on_bus(obj->i2c);
-    timeout = WIRE_I2C_FLAG_TIMEOUT_START;
     /* wait until SBSEND bit is set */
-    while ((!i2c_flag_get(obj->i2c, I2C_FLAG_SBSEND)) && (--timeout != 0));
-    if (0 == timeout) {
+    if (!i2c_flag_wait(obj_s, I2C_FLAG_SBSEND, SET)) {
         status = I2C_TIMEOUT;
     }
 
     /* send slave address to I2C bus */
     i2c_master_addressing(obj->i2c, address, I2C_TRANSMITTER);
-    timeout = WIRE_I2C_FLAG_TIMEOUT_ADDR_ACK;
+    start = micros();
     /* keep looping till the address is acknowledged or the AERR flag is set (address not acknowledged at time) */
     do {
         /* get the current value of the I2C_STAT0 register */
         val = I2C_STAT0(obj->i2c);
 
-    } while ((0 == (val & (I2C_STAT0_ADDSEND | I2C_STAT0_AERR))) && (--timeout != 0));
+    } while ((0 == (val & (I2C_STAT0_ADDSEND | I2C_STAT0_AERR))) && !i2c_timed_out(obj_s, start));
 
     /* check if the ADDSEND flag has been set */
-    if (0 == timeout) {
+    if (0 == (val & (I2C_STAT0_ADDSEND | I2C_STAT0_AERR))) {
         status = I2C_TIMEOUT;
     } else if (val & I2C_STAT0_ADDSEND) {
 
@@ -498,6 +696,253 @@ i2c_status_enum i2c_wait_standby_state(i2c_t *obj, uint8_t address)
     return status;
 }
 
+/** Queue up an asynchronous master transfer and generate the START
+ *
+ * @param obj_s    The I2C object
+ * @param address  7-bit address (last bit is 0)
+ * @param data     The buffer to send from or receive into
+ * @param length   Number of bytes
+ * @param stop     Stop to be generated after the transfer is done
+ * @param receive  Non-zero for a read
+ * @param callback Called from the interrupt when the transfer is done
+ * @param arg      Passed to callback
+ * @return I2C_OK if the transfer was started
+ */
+static i2c_status_enum i2c_master_async_start(struct i2c_s *obj_s, uint8_t address, uint8_t *data,
+                                              uint16_t length, uint8_t stop, uint8_t receive,
+                                              i2c_master_callback_t callback, void *arg)
+{
+    uint32_t i2c = obj_s->i2c;
+
+    if (obj_s->master_state != I2C_MASTER_IDLE) {
+        return I2C_BUSY;
+    }
+    /* a bus still held from a transfer without STOP is restarted, anything else has to be idle */
+    if (i2c_flag_get(i2c, I2C_FLAG_I2CBSY) && !i2c_flag_get(i2c, I2C_FLAG_MASTER)) {
+        return I2C_BUSY;
+    }
+
+    obj_s->master_address = address;
+    obj_s->master_receive = receive;
+    obj_s->master_stop = stop;
+    obj_s->master_buffer = data;
+    obj_s->master_length = length;
+    obj_s->master_count = 0;
+    obj_s->master_callback = callback;
+    obj_s->master_arg = arg;
+
+    /* two byte reads NACK the byte in the shift register, see i2c_master_receive() */
+    i2c_ackpos_config(i2c, (receive && (2U == length)) ? I2C_ACKPOS_NEXT : I2C_ACKPOS_CURRENT);
+    i2c_ack_config(i2c, I2C_ACK_ENABLE);
+
+    obj_s->master_state = I2C_MASTER_START;
+    i2c_nvic_enable(obj_s);
+    I2C_CTL1(i2c) |= I2C_CTL1_EVIE | I2C_CTL1_ERRIE;
+    i2c_start_on_bus(i2c);
+    return I2C_OK;
+}
+
+/** Write bytes at a given address, driven by the I2C interrupts
+ *
+ * @param obj      The I2C object
+ * @param address  7-bit address (last bit is 0)
+ * @param data     The buffer for sending, must stay valid until callback runs
+ * @param length   Number of bytes to write, 0 to check the device is there
+ * @param stop     Stop to be generated after the transfer is done
+ * @param callback Called from the interrupt with the transfer status
+ * @param arg      Passed to callback
+ * @return I2C_OK if the transfer was started, I2C_BUSY otherwise
+ */
+i2c_status_enum i2c_master_transmit_async(i2c_t *obj, uint8_t address, uint8_t *data, uint16_t length,
+                                          uint8_t stop, i2c_master_callback_t callback, void *arg)
+{
+    struct i2c_s *obj_s = I2C_S(obj);
+
+    if (obj_s->batch != NULL) {
+        return I2C_BUSY;
+    }
+    return i2c_master_async_start(obj_s, address, data, length, stop, 0U, callback, arg);
+}
+
+/** Read bytes at a given address, driven by the I2C interrupts
+ *
+ * @param obj      The I2C object
+ * @param address  7-bit address (last bit is 1)
+ * @param data     The buffer for receiving, valid when callback runs
+ * @param length   Number of bytes to read, at least 1
+ * @param stop     Stop to be generated after the transfer is done
+ * @param callback Called from the interrupt with the transfer status
+ * @param arg      Passed to callback
+ * @return I2C_OK if the transfer was started, I2C_BUSY or I2C_ERROR otherwise
+ */
+i2c_status_enum i2c_master_receive_async(i2c_t *obj, uint8_t address, uint8_t *data, uint16_t length,
+                                         uint8_t stop, i2c_master_callback_t callback, void *arg)
+{
+    struct i2c_s *obj_s = I2C_S(obj);
+
+    if (0 == length) {
+        return I2C_ERROR;
+    }
+    if (obj_s->batch != NULL) {
+        return I2C_BUSY;
+    }
+    return i2c_master_async_start(obj_s, address, data, length, stop, 1U, callback, arg);
+}
+
+static void i2c_batch_irq(void *arg, i2c_status_enum status);
+
+/** Start the next transfer of the batch, or report the batch when there is none left
+ *
+ * @param obj_s The I2C object
+ * @param read  Non-zero to read the current transaction after its write went through
+ */
+static void i2c_batch_next(struct i2c_s *obj_s, uint8_t read)
+{
+    i2c_transaction_t *xfer;
+    i2c_master_callback_t callback;
+    i2c_status_enum status;
+    uint32_t start;
+
+    while (obj_s->batch_index < obj_s->batch_count) {
+        xfer = &obj_s->batch[obj_s->batch_index];
+        if (read) {
+            /* repeated start, the bus is still ours */
+            status = i2c_master_async_start(obj_s, xfer->address << 1, xfer->rx_buffer, xfer->rx_length, 1U, 1U,
+                                            i2c_batch_irq, obj_s);
+        } else {
+            /* the STOP of the previous transaction has to be out before the next START */
+            start = micros();
+            while ((I2C_CTL0(obj_s->i2c) & I2C_CTL0_STOP) && !i2c_timed_out(obj_s, start));
+            if ((xfer->tx_length > 0U) || (0U == xfer->rx_length)) {
+                status = i2c_master_async_start(obj_s, xfer->address << 1, (uint8_t *)xfer->tx_buffer,
+                                                xfer->tx_length, (0U == xfer->rx_length), 0U, i2c_batch_irq, obj_s);
+            } else {
+                status = i2c_master_async_start(obj_s, xfer->address << 1, xfer->rx_buffer, xfer->rx_length, 1U,
+                                                1U, i2c_batch_irq, obj_s);
+            }
+        }
+        if (I2C_OK == status) {
+            return;
+        }
+        xfer->status = status;
+        if (I2C_OK == obj_s->batch_status) {
+            obj_s->batch_status = status;
+        }
+        obj_s->batch_index++;
+        read = 0U;
+    }
+
+    callback = obj_s->batch_callback;
+    obj_s->batch = NULL;
+    if (callback != NULL) {
+        callback(obj_s->batch_arg, obj_s->batch_status);
+    }
+}
+
+/** A transfer of the batch is done
+ *
+ * @param arg    The I2C object
+ * @param status The transfer status
+ */
+static void i2c_batch_irq(void *arg, i2c_status_enum status)
+{
+    struct i2c_s *obj_s = I2C_S(arg);
+    i2c_transaction_t *xfer = &obj_s->batch[obj_s->batch_index];
+
+    if ((I2C_OK == status) && !obj_s->master_receive && (xfer->rx_length > 0U)) {
+        i2c_batch_next(obj_s, 1U);
+        return;
+    }
+    xfer->status = status;
+    if ((I2C_OK != status) && (I2C_OK == obj_s->batch_status)) {
+        obj_s->batch_status = status;
+    }
+    obj_s->batch_index++;
+    i2c_batch_next(obj_s, 0U);
+}
+
+/** Run a batch of transactions back to back from the I2C interrupt
+ *
+ * A failing transaction doesn't stop the batch, its status is recorded and the next one is started.
+ * @param obj      The I2C object
+ * @param list     The transactions, must stay valid until callback runs
+ * @param count    Number of transactions
+ * @param callback Called once all transactions are done, with the first error or I2C_OK
+ * @param arg      Passed to callback
+ * @return I2C_OK if the batch was started, I2C_BUSY or I2C_ERROR otherwise
+ */
+i2c_status_enum i2c_master_batch_start(i2c_t *obj, i2c_transaction_t *list, uint16_t count,
+                                       i2c_master_callback_t callback, void *arg)
+{
+    struct i2c_s *obj_s = I2C_S(obj);
+
+    if ((list == NULL) || (0U == count)) {
+        return I2C_ERROR;
+    }
+    if ((obj_s->master_state != I2C_MASTER_IDLE) || (obj_s->batch != NULL)) {
+        return I2C_BUSY;
+    }
+    obj_s->batch_count = count;
+    obj_s->batch_index = 0;
+    obj_s->batch_status = I2C_OK;
+    obj_s->batch_callback = callback;
+    obj_s->batch_arg = arg;
+    obj_s->batch = list;
+    i2c_batch_next(obj_s, 0U);
+    return I2C_OK;
+}
+
+/** Check for an asynchronous master transfer
+ *
+ * @param obj The I2C object
+ * @return Non-zero while the transfer is on the bus
+ */
+int i2c_master_async_busy(i2c_t *obj)
+{
+    struct i2c_s *obj_s = I2C_S(obj);
+
+    return (obj_s->master_state != I2C_MASTER_IDLE) || (obj_s->batch != NULL);
+}
+
+/** Wait for the asynchronous master transfer to finish
+ *
+ * @param obj The I2C object
+ */
+void i2c_master_async_wait(i2c_t *obj)
+{
+    struct i2c_s *obj_s = I2C_S(obj);
+
+    while ((obj_s->master_state != I2C_MASTER_IDLE) || (obj_s->batch != NULL)) {
+        os_event_wait();
+    }
+}
+
+/** Serve the master from a register map
+ *
+ * Everything is done in the interrupt without calling back for reads, so the bus isn't stretched.
+ * A write sets the register pointer with its first byte (two for maps above 256 bytes) and stores
+ * the rest from there on, a read returns bytes from the pointer on. Both auto-increment and wrap at
+ * the end of the map. Call before i2c_slaves_interrupt_enable().
+ * @param obj      The I2C object
+ * @param map      The register memory, NULL goes back to the slave callbacks
+ * @param size     Bytes in map
+ * @param callback Called after a write that stored data, may be NULL
+ * @param arg      Passed to callback
+ */
+void i2c_slave_register_map(i2c_t *obj, uint8_t *map, uint16_t size, i2c_regmap_callback_t callback, void *arg)
+{
+    struct i2c_s *obj_s = I2C_S(obj);
+
+    obj_s->regmap_size = size;
+    obj_s->regmap_pointer = 0;
+    obj_s->regmap_address_size = (size > 256U) ? 2U : 1U;
+    obj_s->regmap_address_count = 0;
+    obj_s->regmap_written = 0;
+    obj_s->regmap_callback = callback;
+    obj_s->regmap_arg = arg;
+    obj_s->regmap = (0U == size) ? NULL : map;
+}
+
 /** sets function called before a slave read operation
  *
  * @param obj      The I2C object
@@ -560,20 +1005,163 @@ i2c_status_enum i2c_slave_write_buffer(i2c_t *obj, uint8_t *data, uint16_t lengt
 
 i2c_status_enum _i2c_busy_wait(i2c_t *obj)
 {
+    /* still holding the bus after a transfer without STOP, the next START is a repeated one */
+    if (i2c_flag_get(obj->i2c, I2C_FLAG_MASTER)) {
+        return I2C_OK;
+    }
 
     /* wait until I2C_FLAG_I2CBSY flag is reset */
-    uint32_t timeout = WIRE_I2C_FLAG_TIMEOUT_BUSY;
-    while ((i2c_flag_get(obj->i2c, I2C_FLAG_I2CBSY)) && (--timeout != 0));
-    if (0 == timeout) {
+    if (i2c_flag_wait(obj, I2C_FLAG_I2CBSY, RESET)) {
+        return I2C_OK;
+    }
+    obj->stats.timeouts++;
+    /* a slave holding SDA low after a reset or a glitch keeps the bus busy for ever */
+    if (!obj->auto_recover || (I2C_OK != i2c_bus_recover(obj)) || i2c_flag_get(obj->i2c, I2C_FLAG_I2CBSY)) {
         return I2C_BUSY;
     }
-
     return I2C_OK;
 }
 
+/** Free a bus held by a slave and restart the I2C
+ *
+ * SCL is clocked as a GPIO until the slave lets go of SDA, a STOP is put on the bus and the I2C
+ * goes through a software reset with its clock and own address set up again.
+ * @param obj The I2C object
+ * @return I2C_OK if SDA is high afterwards, I2C_BUSY otherwise
+ */
+i2c_status_enum i2c_bus_recover(i2c_t *obj)
+{
+    struct i2c_s *obj_s = I2C_S(obj);
+    uint32_t scl_port = gpio_port[GD_PORT_GET(obj_s->scl)];
+    uint32_t scl_pin = gpio_pin[GD_PIN_GET(obj_s->scl)];
+    uint32_t sda_port = gpio_port[GD_PORT_GET(obj_s->sda)];
+    uint32_t sda_pin = gpio_pin[GD_PIN_GET(obj_s->sda)];
+    uint32_t ctl1 = I2C_CTL1(obj_s->i2c) & (I2C_CTL1_ERRIE | I2C_CTL1_EVIE | I2C_CTL1_BUFIE);
+    uint32_t i;
+    i2c_status_enum status;
+
+    i2c_disable(obj_s->i2c);
+    gpio_bit_set(scl_port, scl_pin);
+    gpio_bit_set(sda_port, sda_pin);
+    pin_function(obj_s->scl, I2C_RECOVERY_PIN_FUNCTION);
+    pin_function(obj_s->sda, I2C_RECOVERY_PIN_FUNCTION);
+
+    for (i = 0; (i < I2C_RECOVERY_CLOCKS) && (RESET == gpio_input_bit_get(sda_port, sda_pin)); i++) {
+        gpio_bit_reset(scl_port, scl_pin);
+        delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+        gpio_bit_set(scl_port, scl_pin);
+        delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+    }
+    /* STOP: SDA going high while SCL is high */
+    gpio_bit_reset(sda_port, sda_pin);
+    delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+    gpio_bit_set(sda_port, sda_pin);
+    delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+    status = (SET == gpio_input_bit_get(sda_port, sda_pin)) ? I2C_OK : I2C_BUSY;
+
+    pinmap_pinout(obj_s->sda, PinMap_I2C_SDA);
+    pinmap_pinout(obj_s->scl, PinMap_I2C_SCL);
+
+    /* the reset also clears a BSY flag left over from the stuck bus */
+    I2C_CTL0(obj_s->i2c) |= I2C_CTL0_SRESET;
+    I2C_CTL0(obj_s->i2c) &= ~I2C_CTL0_SRESET;
+    i2c_set_clock(obj, obj_s->clock_hz);
+    i2c_mode_addr_config(obj_s->i2c, I2C_I2CMODE_ENABLE, I2C_ADDFORMAT_7BITS, obj_s->own_address);
+    I2C_CTL1(obj_s->i2c) |= ctl1;
+    i2c_enable(obj_s->i2c);
+    i2c_ack_config(obj_s->i2c, I2C_ACK_ENABLE);
+
+    obj_s->stats.recoveries++;
+    return status;
+}
+
+/** Smallest CLKC whose SCL period, plus the rise time, is not shorter than period_ns
+ *
+ * @param pclk1     The I2C kernel clock
+ * @param period_ns The SCL period left after the rise time
+ * @param ratio     Kernel clocks per CLKC count and SCL period (2, 3 or 25)
+ * @return CLKC, not clamped
+ */
+static uint32_t i2c_clkc_get(uint32_t pclk1, uint32_t period_ns, uint32_t ratio)
+{
+    uint64_t div = (uint64_t)ratio * 1000000000U;
+
+    return (uint32_t)(((uint64_t)pclk1 * period_ns + div - 1U) / div);
+}
+
+/** Set the SCL clock
+ *
+ * i2c_clock_config() picks the mode, I2CCLK and the maximum rise time, CLKC is then recomputed
+ * here: rounded up so the bus never runs faster than asked, with the rise time of the bus (the
+ * high period only starts counting once SCL is seen high) taken off the period, and in fast mode
+ * with whichever of the 2 and 16/9 duty cycles gets closer to clock_hz.
+ * @param obj      The I2C object
+ * @param clock_hz The SCL clock, up to 1 MHz on parts with fast mode plus and 400 kHz otherwise
+ */
 void i2c_set_clock(i2c_t *obj, uint32_t clock_hz)
 {
-    i2c_clock_config(obj->i2c, clock_hz, I2C_DTCY_2);
+    struct i2c_s *obj_s = I2C_S(obj);
+    uint32_t i2c = obj_s->i2c;
+    uint32_t pclk1 = rcu_clock_freq_get(CK_APB1);
+    uint32_t period_ns, clkc, clkc_16_9, ckcfg;
+
+    if (0U == clock_hz) {
+        return;
+    }
+    obj_s->clock_hz = clock_hz;
+#if defined(I2C_FAST_MODE_PLUS_ENABLE) && (defined(I2C_FMPCFG) || defined(I2C_CTL2_FMPEN))
+    if (clock_hz > I2C_CLOCK_FAST_PLUS) {
+        clock_hz = I2C_CLOCK_FAST_PLUS;
+    }
+#else
+    if (clock_hz > I2C_CLOCK_FAST) {
+        clock_hz = I2C_CLOCK_FAST;
+    }
+#endif
+    i2c_clock_config(i2c, clock_hz, I2C_DTCY_2);
+
+    period_ns = 1000000000U / clock_hz;
+    if (obj_s->scl_rise_ns < (period_ns / 2U)) {
+        period_ns -= obj_s->scl_rise_ns;
+    }
+    ckcfg = I2C_CKCFG(i2c) & ~(I2C_CKCFG_CLKC | I2C_CKCFG_DTCY | I2C_CKCFG_FAST);
+    if (clock_hz <= I2C_CLOCK_STANDARD) {
+        clkc = i2c_clkc_get(pclk1, period_ns, 2U);
+        /* the CLKC in standard mode minimum value is 4 */
+        if (clkc < 4U) {
+            clkc = 4U;
+        }
+    } else {
+        clkc = i2c_clkc_get(pclk1, period_ns, 3U);
+        clkc_16_9 = i2c_clkc_get(pclk1, period_ns, 25U);
+        if (0U == clkc) {
+            clkc = 1U;
+        }
+        if (0U == clkc_16_9) {
+            clkc_16_9 = 1U;
+        }
+        ckcfg |= I2C_CKCFG_FAST;
+        /* shorter period without going above clock_hz */
+        if ((clkc_16_9 * 25U) < (clkc * 3U)) {
+            clkc = clkc_16_9;
+            ckcfg |= I2C_CKCFG_DTCY;
+        }
+    }
+    if (clkc > I2C_CKCFG_CLKC) {
+        clkc = I2C_CKCFG_CLKC;
+    }
+    I2C_CKCFG(i2c) = ckcfg | clkc;
+
+    /* i2c_clock_config() only ever turns fast mode plus on */
+#if defined(I2C_FAST_MODE_PLUS_ENABLE) && defined(I2C_FMPCFG)
+    if (clock_hz <= I2C_CLOCK_FAST) {
+        I2C_FMPCFG(i2c) &= ~I2C_FMPCFG_FMPEN;
+    }
+#elif defined(I2C_FAST_MODE_PLUS_ENABLE) && defined(I2C_CTL2_FMPEN)
+    if (clock_hz <= I2C_CLOCK_FAST) {
+        I2C_CTL2(i2c) &= ~I2C_CTL2_FMPEN;
+    }
+#endif
 }
 
 void i2c_err_handler(uint32_t i2c) 
@@ -615,6 +1203,209 @@ void i2c_err_handler(uint32_t i2c)
 }
 
 
+/** End the asynchronous master transfer and report it
+ *
+ * @param obj_s  The I2C object
+ * @param status The transfer status
+ */
+static void i2c_master_async_done(struct i2c_s *obj_s, i2c_status_enum status)
+{
+    uint32_t i2c = obj_s->i2c;
+
+    I2C_CTL1(i2c) &= ~I2C_CTL1_BUFIE;
+    /* slave mode keeps using the interrupts */
+    if ((obj_s->slave_receive_callback == NULL) && (obj_s->regmap == NULL)) {
+        I2C_CTL1(i2c) &= ~(I2C_CTL1_EVIE | I2C_CTL1_ERRIE);
+    }
+    /* reads have generated their STOP before the last byte came in */
+    if ((I2C_OK != status) || (obj_s->master_stop && !obj_s->master_receive)) {
+        i2c_stop_on_bus(i2c);
+    }
+    i2c_ackpos_config(i2c, I2C_ACKPOS_CURRENT);
+    i2c_ack_config(i2c, I2C_ACK_ENABLE);
+    i2c_stats_count(obj_s, status);
+
+    obj_s->master_state = I2C_MASTER_IDLE;
+    if (obj_s->master_callback != NULL) {
+        obj_s->master_callback(obj_s->master_arg, status);
+    }
+    os_event_signal();
+}
+
+/** Event interrupt of an asynchronous master transfer
+ *
+ * Reads follow the same ACK/STOP sequence as i2c_master_receive(): the buffer interrupt is turned
+ * off for the last three bytes (two or one for shorter reads) so that they are handled on BTC.
+ * @param obj_s The I2C object
+ */
+static void i2c_master_irq(struct i2c_s *obj_s)
+{
+    uint32_t i2c = obj_s->i2c;
+    uint32_t stat0 = I2C_STAT0(i2c);
+    uint32_t buffer_int = I2C_CTL1(i2c) & I2C_CTL1_BUFIE;
+    uint16_t remaining = obj_s->master_length - obj_s->master_count;
+
+    switch (obj_s->master_state) {
+        case I2C_MASTER_START:
+            if (stat0 & I2C_STAT0_SBSEND) {
+                i2c_master_addressing(i2c, obj_s->master_address,
+                                      obj_s->master_receive ? I2C_RECEIVER : I2C_TRANSMITTER);
+                obj_s->master_state = I2C_MASTER_ADDRESS;
+            }
+            break;
+        case I2C_MASTER_ADDRESS:
+            if (!(stat0 & I2C_STAT0_ADDSEND)) {
+                break;
+            }
+            if (obj_s->master_receive && (remaining <= 2U)) {
+                /* the NACK of the last byte must be set up before ADDSEND is cleared */
+                i2c_ack_config(i2c, I2C_ACK_DISABLE);
+            }
+            i2c_flag_clear(i2c, I2C_FLAG_ADDSEND);
+            obj_s->master_state = I2C_MASTER_DATA;
+            if (!obj_s->master_receive) {
+                if (0U == remaining) {
+                    i2c_master_async_done(obj_s, I2C_OK);
+                } else {
+                    I2C_CTL1(i2c) |= I2C_CTL1_BUFIE;
+                }
+            } else if (1U == remaining) {
+                if (obj_s->master_stop) {
+                    i2c_stop_on_bus(i2c);
+                }
+                I2C_CTL1(i2c) |= I2C_CTL1_BUFIE;
+            } else if (remaining > 3U) {
+                I2C_CTL1(i2c) |= I2C_CTL1_BUFIE;
+            }
+            break;
+        case I2C_MASTER_DATA:
+            if (!obj_s->master_receive) {
+                if (buffer_int && (stat0 & I2C_STAT0_TBE) && (remaining > 0U)) {
+                    i2c_data_transmit(i2c, obj_s->master_buffer[obj_s->master_count++]);
+                    if (1U == remaining) {
+                        /* only BTC of the last byte is of interest now */
+                        I2C_CTL1(i2c) &= ~I2C_CTL1_BUFIE;
+                    }
+                } else if ((stat0 & I2C_STAT0_BTC) && (0U == remaining)) {
+                    i2c_master_async_done(obj_s, I2C_OK);
+                }
+            } else if (buffer_int && (stat0 & I2C_STAT0_RBNE)) {
+                obj_s->master_buffer[obj_s->master_count++] = i2c_data_receive(i2c);
+                if (1U == remaining) {
+                    i2c_master_async_done(obj_s, I2C_OK);
+                } else if (4U == remaining) {
+                    I2C_CTL1(i2c) &= ~I2C_CTL1_BUFIE;
+                }
+            } else if (stat0 & I2C_STAT0_BTC) {
+                if (3U == remaining) {
+                    i2c_ack_config(i2c, I2C_ACK_DISABLE);
+                    obj_s->master_buffer[obj_s->master_count++] = i2c_data_receive(i2c);
+                } else if (2U == remaining) {
+                    if (obj_s->master_stop) {
+                        i2c_stop_on_bus(i2c);
+                    }
+                    obj_s->master_buffer[obj_s->master_count++] = i2c_data_receive(i2c);
+                    obj_s->master_buffer[obj_s->master_count++] = i2c_data_receive(i2c);
+                    i2c_master_async_done(obj_s, I2C_OK);
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/** Error interrupt of an asynchronous master transfer
+ *
+ * @param obj_s The I2C object
+ */
+static void i2c_master_err_irq(struct i2c_s *obj_s)
+{
+    if ((obj_s == NULL) || (obj_s->master_state == I2C_MASTER_IDLE)) {
+        return;
+    }
+    uint32_t i2c = obj_s->i2c;
+    uint32_t stat0 = I2C_STAT0(i2c);
+
+    if (stat0 & I2C_STAT0_AERR) {
+        i2c_flag_clear(i2c, I2C_FLAG_AERR);
+        i2c_master_async_done(obj_s, (obj_s->master_state == I2C_MASTER_DATA) ? I2C_NACK_DATA : I2C_NACK_ADDR);
+    } else if (stat0 & (I2C_STAT0_LOSTARB | I2C_STAT0_BERR)) {
+        /* the flags are counted and cleared by i2c_stats_count() */
+        i2c_master_async_done(obj_s, I2C_ERROR);
+    }
+}
+
+/** Report the registers the master stored since the last report
+ *
+ * @param obj_s The I2C object
+ */
+static void i2c_regmap_notify(struct i2c_s *obj_s)
+{
+    uint16_t written = obj_s->regmap_written;
+
+    if (0U == written) {
+        return;
+    }
+    obj_s->regmap_written = 0;
+    if (obj_s->regmap_callback != NULL) {
+        obj_s->regmap_callback(obj_s->regmap_arg, obj_s->regmap_first, written);
+    }
+}
+
+/** Event interrupt of the slave register map
+ *
+ * @param obj_s The I2C object
+ */
+static void i2c_regmap_irq(struct i2c_s *obj_s)
+{
+    uint32_t i2c = obj_s->i2c;
+    uint8_t data;
+
+    if (i2c_interrupt_flag_get(i2c, I2C_INT_FLAG_ADDSEND)) {
+        i2c_interrupt_flag_clear(i2c, I2C_INT_FLAG_ADDSEND);
+        /* a repeated start ends the write as well */
+        i2c_regmap_notify(obj_s);
+        obj_s->regmap_address_count = 0;
+        if (!i2c_flag_get(i2c, GD32_I2C_FLAG_IS_TRANSMTR_OR_RECVR)) {
+            obj_s->regmap_address_count = obj_s->regmap_address_size;
+        }
+    } else if ((i2c_interrupt_flag_get(i2c, I2C_INT_FLAG_TBE)) &&
+               (!i2c_interrupt_flag_get(i2c, I2C_INT_FLAG_AERR))) {
+        i2c_data_transmit(i2c, obj_s->regmap[obj_s->regmap_pointer]);
+        if (++obj_s->regmap_pointer >= obj_s->regmap_size) {
+            obj_s->regmap_pointer = 0;
+        }
+    } else if (i2c_interrupt_flag_get(i2c, I2C_INT_FLAG_RBNE)) {
+        data = i2c_data_receive(i2c);
+        if (obj_s->regmap_address_count > 0U) {
+            /* register address, most significant byte first */
+            if (obj_s->regmap_address_count == obj_s->regmap_address_size) {
+                obj_s->regmap_pointer = 0;
+            }
+            obj_s->regmap_pointer = (uint16_t)((obj_s->regmap_pointer << 8) | data);
+            if (--obj_s->regmap_address_count == 0U) {
+                obj_s->regmap_pointer %= obj_s->regmap_size;
+            }
+        } else {
+            if (0U == obj_s->regmap_written) {
+                obj_s->regmap_first = obj_s->regmap_pointer;
+            }
+            obj_s->regmap[obj_s->regmap_pointer] = data;
+            if (obj_s->regmap_written < obj_s->regmap_size) {
+                obj_s->regmap_written++;
+            }
+            if (++obj_s->regmap_pointer >= obj_s->regmap_size) {
+                obj_s->regmap_pointer = 0;
+            }
+        }
+    } else if (i2c_interrupt_flag_get(i2c, I2C_INT_FLAG_STPDET)) {
+        /* clear the STPDET bit */
+        i2c_enable(i2c);
+        i2c_regmap_notify(obj_s);
+    }
+}
+
 /** This function handles I2C interrupt handler
  *
  * @param i2c_periph The I2C peripheral
@@ -625,6 +1416,14 @@ static void i2c_irq(struct i2c_s *obj_s)
     if(obj_s == NULL) {
         return;
     }
+    if (obj_s->master_state != I2C_MASTER_IDLE) {
+        i2c_master_irq(obj_s);
+        return;
+    }
+    if (obj_s->regmap != NULL) {
+        i2c_regmap_irq(obj_s);
+        return;
+    }
     uint32_t i2c = obj_s->i2c;
     if (i2c_interrupt_flag_get(i2c, I2C_INT_FLAG_ADDSEND)) {
         /* clear the ADDSEND bit */
@@ -664,7 +1463,7 @@ static void i2c_irq(struct i2c_s *obj_s)
 /** Handle I2C0 event interrupt request
  *
  */
-extern "C" void I2C0_EV_IRQHandler(void)
+extern "C" __attribute__((used)) void I2C0_EV_IRQHandler(void)
 {
     i2c_irq(obj_s_buf[I2C0_INDEX]);
 }
@@ -672,8 +1471,9 @@ extern "C" void I2C0_EV_IRQHandler(void)
 /** handle I2C0 error interrupt request
  *
  */
-extern "C" void I2C0_ER_IRQHandler(void)
+extern "C" __attribute__((used)) void I2C0_ER_IRQHandler(void)
 {
+    i2c_master_err_irq(obj_s_buf[I2C0_INDEX]);
     i2c_err_handler(I2C0);
 }
 #endif
@@ -683,7 +1483,7 @@ extern "C" void I2C0_ER_IRQHandler(void)
 /** Handle I2C1 event interrupt request
  *
  */
-extern "C" void I2C1_EV_IRQHandler(void)
+extern "C" __attribute__((used)) void I2C1_EV_IRQHandler(void)
 {
     i2c_irq(obj_s_buf[I2C1_INDEX]);
 }
@@ -691,8 +1491,9 @@ extern "C" void I2C1_EV_IRQHandler(void)
 /** handle I2C1 error interrupt request
  *
  */
-extern "C" void I2C1_ER_IRQHandler(void)
+extern "C" __attribute__((used)) void I2C1_ER_IRQHandler(void)
 {
+    i2c_master_err_irq(obj_s_buf[I2C1_INDEX]);
     i2c_err_handler(I2C1);
 }
 #endif
@@ -701,7 +1502,7 @@ extern "C" void I2C1_ER_IRQHandler(void)
 /** Handle I2C2 event interrupt request
  *
  */
-extern "C" void I2C2_EV_IRQHandler(void)
+extern "C" __attribute__((used)) void I2C2_EV_IRQHandler(void)
 {
     i2c_irq(obj_s_buf[I2C2_INDEX]);
 }
@@ -709,8 +1510,9 @@ extern "C" void I2C2_EV_IRQHandler(void)
 /** handle I2C1 error interrupt request
  *
  */
-extern "C" void I2C2_ER_IRQHandler(void)
+extern "C" __attribute__((used)) void I2C2_ER_IRQHandler(void)
 {
+    i2c_master_err_irq(obj_s_buf[I2C2_INDEX]);
     i2c_err_handler(I2C2);
 }
 
@@ -38,6 +38,57 @@ OF SUCH DAMAGE.
 extern "C" {
 #endif
 
+/* longest memory/register address of i2c_mem_read()/i2c_mem_write() */
+#define I2C_MEM_ADDRESS_MAX_SIZE  4U
+
+/* default bus timeout in us of the blocking calls, see i2c_s.timeout_us */
+#ifndef WIRE_I2C_TIMEOUT_US
+#define WIRE_I2C_TIMEOUT_US   25000U
+#endif
+
+/* upper SCL clock of each bus mode */
+#define I2C_CLOCK_STANDARD    100000U
+#define I2C_CLOCK_FAST        400000U
+#define I2C_CLOCK_FAST_PLUS   1000000U
+
+typedef enum {
+    /* transfer status */
+    I2C_OK            = 0,
+    I2C_DATA_TOO_LONG = 1,
+    I2C_NACK_ADDR     = 2,
+    I2C_NACK_DATA     = 3,
+    I2C_ERROR         = 4,
+    I2C_TIMEOUT       = 5,
+    I2C_BUSY          = 6
+} i2c_status_enum;
+
+/* called from the I2C interrupt when an asynchronous master transfer is done */
+typedef void (*i2c_master_callback_t)(void *arg, i2c_status_enum status);
+
+/* One transaction of a batch: tx is written first (e.g. a register address), rx is then read after
+ * a repeated start. Either length may be 0, both 0 just checks the device answers */
+typedef struct {
+    uint8_t address;            /* 7-bit device address, not shifted */
+    const uint8_t *tx_buffer;
+    uint16_t tx_length;
+    uint8_t *rx_buffer;
+    uint16_t rx_length;
+    i2c_status_enum status;     /* result, set when the transaction is done */
+} i2c_transaction_t;
+
+/* called from the I2C interrupt after the master stored length bytes from register reg on */
+typedef void (*i2c_regmap_callback_t)(void *arg, uint16_t reg, uint16_t length);
+
+/* bus problems seen since the I2C was set up */
+typedef struct {
+    uint32_t nack_addr;         /* no device answered the address */
+    uint32_t nack_data;         /* a written byte was not acknowledged */
+    uint32_t arbitration_lost;
+    uint32_t bus_errors;        /* misplaced START or STOP */
+    uint32_t timeouts;          /* a flag didn't come up in timeout_us, or the bus stayed busy */
+    uint32_t recoveries;        /* runs of i2c_bus_recover() */
+} i2c_stats_t;
+
 typedef struct i2c_s i2c_t;
 
 struct i2c_s {
@@ -53,22 +104,51 @@ struct i2c_s {
     uint16_t   rx_count;
     /* TX and RX buffer are expected to be of this size */
     uint16_t tx_rx_buffer_size;
+    /* SCL rise time of the bus in ns, taken off the clock period by i2c_set_clock() */
+    uint16_t scl_rise_ns;
+    /* kept for the restart after a bus recovery */
+    uint32_t clock_hz;
+    uint8_t own_address;
+    /* longest wait for a flag in the blocking calls, 0 waits for ever */
+    uint32_t timeout_us;
+    /* run i2c_bus_recover() when the bus stays busy for timeout_us */
+    uint8_t auto_recover;
+    i2c_stats_t stats;
 
     void* pWireObj;
     void (*slave_transmit_callback)(void* pWireObj);
     void (*slave_receive_callback)(void* pWireObj, uint8_t *, int);
-};
 
-typedef enum {
-    /* transfer status */
-    I2C_OK            = 0,
-    I2C_DATA_TOO_LONG = 1,
-    I2C_NACK_ADDR     = 2,
-    I2C_NACK_DATA     = 3,
-    I2C_ERROR         = 4,
-    I2C_TIMEOUT       = 5,
-    I2C_BUSY          = 6
-} i2c_status_enum;
+    /* asynchronous master transfer, master_state is 0 while none is on the bus */
+    volatile uint8_t master_state;
+    uint8_t master_address;
+    uint8_t master_receive;
+    uint8_t master_stop;
+    uint8_t *master_buffer;
+    uint16_t master_length;
+    uint16_t master_count;
+    i2c_master_callback_t master_callback;
+    void *master_arg;
+
+    /* batch of transactions, NULL while none is running */
+    i2c_transaction_t *volatile batch;
+    uint16_t batch_count;
+    uint16_t batch_index;
+    i2c_status_enum batch_status;
+    i2c_master_callback_t batch_callback;
+    void *batch_arg;
+
+    /* slave register map, NULL when the slave callbacks serve the master */
+    uint8_t *regmap;
+    uint16_t regmap_size;
+    uint16_t regmap_pointer;
+    uint8_t regmap_address_size;
+    uint8_t regmap_address_count;
+    uint16_t regmap_first;
+    uint16_t regmap_written;
+    i2c_regmap_callback_t regmap_callback;
+    void *regmap_arg;
+};
 
 /* Initialize the I2C peripheral */
 void i2c_init(i2c_t *obj, PinName sda, PinName scl, uint8_t address);
@@ -77,13 +157,38 @@ void i2c_slaves_interrupt_enable(i2c_t *obj);
 /* Write one byte */
 i2c_status_enum i2c_master_transmit(i2c_t *obj, uint8_t dev_address, uint8_t *data, uint16_t size,
                                     uint8_t stop);
+/* Write prefix and then data in one transfer */
+i2c_status_enum i2c_master_transmit_prefixed(i2c_t *obj, uint8_t address, const uint8_t *prefix,
+                                             uint16_t prefix_length, const uint8_t *data, uint16_t length,
+                                             uint8_t stop);
 /* Write bytes at a given address */
 i2c_status_enum i2c_master_receive(i2c_t *obj, uint8_t address, uint8_t *data, uint16_t length,
                                    int stop);
+/* Write the memory address, then read with a repeated start */
+i2c_status_enum i2c_mem_read(i2c_t *obj, uint8_t address, uint32_t mem_address, uint8_t mem_size, uint8_t *data,
+                             uint16_t length, uint8_t stop);
+/* Write the memory address followed by data */
+i2c_status_enum i2c_mem_write(i2c_t *obj, uint8_t address, uint32_t mem_address, uint8_t mem_size,
+                              const uint8_t *data, uint16_t length);
+/* Start a write driven by the I2C interrupts, data must stay valid until callback runs */
+i2c_status_enum i2c_master_transmit_async(i2c_t *obj, uint8_t address, uint8_t *data, uint16_t length,
+                                          uint8_t stop, i2c_master_callback_t callback, void *arg);
+/* Start a read driven by the I2C interrupts, data is filled in when callback runs */
+i2c_status_enum i2c_master_receive_async(i2c_t *obj, uint8_t address, uint8_t *data, uint16_t length,
+                                         uint8_t stop, i2c_master_callback_t callback, void *arg);
+/* Run count transactions back to back from the I2C interrupt, callback gets the first error or I2C_OK */
+i2c_status_enum i2c_master_batch_start(i2c_t *obj, i2c_transaction_t *list, uint16_t count,
+                                       i2c_master_callback_t callback, void *arg);
+/* Non-zero while an asynchronous master transfer is on the bus */
+int i2c_master_async_busy(i2c_t *obj);
+/* Wait for the asynchronous master transfer to finish */
+void i2c_master_async_wait(i2c_t *obj);
 /* read bytes in master mode at a given address */
 i2c_status_enum i2c_wait_standby_state(i2c_t *obj, uint8_t address);
 /* Write bytes to master */
 i2c_status_enum i2c_slave_write_buffer(i2c_t *obj, uint8_t *data, uint16_t size);
+/* Serve the master from a register map inside the interrupt, see i2c_slave_register_map() */
+void i2c_slave_register_map(i2c_t *obj, uint8_t *map, uint16_t size, i2c_regmap_callback_t callback, void *arg);
 /* sets function called before a slave read operation */
 void i2c_attach_slave_rx_callback(i2c_t *obj, void (*function)(void*, uint8_t*, int), void* pWireObj);
 /* sets function called before a slave write operation */
@@ -92,6 +197,8 @@ void i2c_attach_slave_tx_callback(i2c_t *obj, void (*function)(void*), void* pWi
 void i2c_set_clock(i2c_t *obj, uint32_t clock_hz);
 /* Check to see if the I2C bus is busy */
 i2c_status_enum _i2c_busy_wait(i2c_t *obj);
+/* Clock a stuck slave off the bus and restart the I2C */
+i2c_status_enum i2c_bus_recover(i2c_t *obj);
 
 
 
@@ -55,7 +55,9 @@
 //#define __SYSTEM_CLOCK_72M_PLL_HXTAL            (uint32_t)(72000000)
 //#define __SYSTEM_CLOCK_120M_PLL_HXTAL           (uint32_t)(120000000)
 //#define __SYSTEM_CLOCK_168M_PLL_HXTAL           (uint32_t)(168000000)
+#if !defined(__PIO_DONT_SET_CLOCK_SOURCE__) // make this the default unless we tell it not to in the build settings
 #define __SYSTEM_CLOCK_180M_PLL_HXTAL           (uint32_t)(180000000)
+#endif
 
 
 #define SEL_IRC8M       0x00
@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+"""Turn the binary output of the DeferredLog library back into text.
+
+The target sends one frame per DLOG() call, COBS-encoded and ended by a 0
+byte: the address of the format string in the .gd32_log section of the ELF
+file, a timestamp in microseconds and the raw arguments. This script reads
+the format strings from the ELF file of the very same build and formats each
+frame the way printf would have on the target.
+
+    deferred_log.py firmware.elf --port /dev/ttyUSB0 --baud 115200
+    deferred_log.py firmware.elf capture.bin
+    some-swo-viewer | deferred_log.py firmware.elf -
+
+Reading a serial port needs pyserial; files and pipes need nothing but Python 3.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+LOG_SECTION = b".gd32_log"
+ID_DROPPED = 0xFFFFFFFF
+ID_TRUNCATED = 0x80000000
+
+# printf conversions: flags, width, precision, length, conversion
+CONVERSION = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|j|z|t|L)?([diouxXcspfFeEgGaA%])")
+
+
+def read_log_section(path):
+    """Return (address, bytes) of the .gd32_log section of an ELF file."""
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF":
+        raise SystemExit("%s is not an ELF file" % path)
+    is64 = elf[4] == 2
+    end = "<" if elf[5] == 1 else ">"
+    if is64:
+        shoff, = struct.unpack_from(end + "Q", elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(end + "HHH", elf, 0x3A)
+        header = end + "IIQQQQIIQQ"
+    else:
+        shoff, = struct.unpack_from(end + "I", elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(end + "HHH", elf, 0x2E)
+        header = end + "IIIIIIIIII"
+
+    sections = [struct.unpack_from(header, elf, shoff + i * shentsize) for i in range(shnum)]
+    names = sections[shstrndx]
+    for name, _type, _flags, addr, offset, size, _link, _info, _align, _entsize in sections:
+        start = names[4] + name
+        if elf[start:elf.index(b"\0", start)] == LOG_SECTION:
+            return addr, elf[offset:offset + size]
+    raise SystemExit("%s has no %s section, was DeferredLog used?" % (path, LOG_SECTION.decode()))
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError("bad COBS block")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class Decoder:
+    def __init__(self, elf):
+        self.base, self.strings = read_log_section(elf)
+
+    def format_string(self, ident):
+        offset = ident - self.base
+        if not 0 <= offset < len(self.strings):
+            return None
+        end = self.strings.index(b"\0", offset)
+        return self.strings[offset:end].decode("utf-8", "replace")
+
+    @staticmethod
+    def arguments(fmt, data, truncated=False):
+        """Split data by the conversions of fmt, the way DeferredLogger packed it.
+
+        A truncated frame ends after the last argument that fit, the line stops there."""
+        pos = 0
+        python = []
+        values = []
+        last = 0
+        for m in CONVERSION.finditer(fmt):
+            python.append(fmt[last:m.start()].replace("%", "%%"))
+            last = m.end()
+            flags, width, precision, length, conv = m.groups()
+            if conv == "%":
+                python.append("%%")
+                continue
+            if truncated and pos >= len(data):
+                python.append("<cut, frame full>")
+                last = len(fmt)
+                break
+            if "*" in (width, precision):
+                raise ValueError("'*' widths are not supported")
+            spec = "%" + flags + (width or "") + ("." + precision if precision else "")
+            if conv == "s":
+                size = data[pos]
+                values.append(data[pos + 1:pos + 1 + size].decode("utf-8", "replace"))
+                pos += 1 + size
+                python.append(spec + "s")
+            elif conv in "fFeEgGaA":
+                values.append(struct.unpack_from("<f", data, pos)[0])
+                pos += 4
+                python.append(spec + ("f" if conv in "aA" else conv))
+            elif length == "ll" or length == "j":
+                signed = conv in "di"
+                values.append(struct.unpack_from("<q" if signed else "<Q", data, pos)[0])
+                pos += 8
+                python.append(spec + ("d" if conv in "diu" else conv))
+            else:
+                signed = conv in "di"
+                value = struct.unpack_from("<i" if signed else "<I", data, pos)[0]
+                pos += 4
+                if conv == "c":
+                    values.append(chr(value & 0xFF))
+                    python.append(spec + "c")
+                elif conv == "p":
+                    values.append(value)
+                    python.append("0x%08x")
+                else:
+                    values.append(value)
+                    python.append(spec + ("d" if conv in "diu" else conv))
+        python.append(fmt[last:].replace("%", "%%"))
+        return "".join(python) % tuple(values)
+
+    def frame(self, frame):
+        if len(frame) < 8:
+            return "<short frame %s>" % frame.hex()
+        ident, stamp = struct.unpack_from("<II", frame)
+        args = frame[8:]
+        if ident == ID_DROPPED:
+            text = "<%u frames lost, buffer full>" % struct.unpack_from("<I", args)[0]
+        else:
+            truncated = bool(ident & ID_TRUNCATED)
+            ident &= ~ID_TRUNCATED
+            fmt = self.format_string(ident)
+            if fmt is None:
+                text = "<unknown ID 0x%08x, wrong ELF file?>" % ident
+            else:
+                try:
+                    text = self.arguments(fmt, args, truncated)
+                except (IndexError, struct.error, ValueError, TypeError):
+                    text = "<%r with arguments %s>" % (fmt, args.hex())
+        return "%10.6f %s" % (stamp / 1e6, text)
+
+
+def chunks(args):
+    if args.port:
+        import serial
+        with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+            while True:
+                yield port.read(256)
+    else:
+        stream = sys.stdin.buffer if args.input == "-" else open(args.input, "rb")
+        with stream:
+            while True:
+                data = stream.read1(256) if hasattr(stream, "read1") else stream.read(256)
+                if not data:
+                    return
+                yield data
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf", help="ELF file of the running firmware")
+    parser.add_argument("input", nargs="?", default="-", help="captured stream, - for stdin")
+    parser.add_argument("--port", help="serial port to read instead")
+    parser.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    decoder = Decoder(args.elf)
+    pending = bytearray()
+    # what comes before the first 0 byte may be the tail of a frame
+    synced = False
+    for data in chunks(args):
+        pending += data
+        while b"\0" in pending:
+            end = pending.index(b"\0")
+            encoded = bytes(pending[:end])
+            del pending[:end + 1]
+            if not encoded:
+                continue
+            try:
+                frame = cobs_decode(encoded)
+            except ValueError:
+                frame = None
+            if not synced:
+                synced = True
+                if frame is None or len(frame) < 8 or decoder.format_string(struct.unpack_from("<I", frame)[0] & ~ID_TRUNCATED) is None:
+                    continue
+            if frame is None:
+                print("<corrupt frame %s>" % encoded.hex(), flush=True)
+            else:
+                print(decoder.frame(frame), flush=True)
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except KeyboardInterrupt:
+        pass
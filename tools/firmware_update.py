@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+"""Send a firmware image to a sketch that calls FirmwareUpdate.poll().
+
+The sketch writes the image into its spare flash bank while it keeps
+running, checks its CRC-32 and, once it answers 'D', installs it on the
+next reset.
+
+    firmware_update.py --port /dev/ttyUSB0 build/sketch.ino.bin
+
+Needs pyserial.
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+
+def expect(port, wanted, what):
+    reply = port.read(1)
+    if reply == wanted:
+        return
+    if reply == b"E":
+        raise SystemExit("the board refused the %s" % what)
+    raise SystemExit("no answer to the %s (got %r)" % (what, reply))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("image", help="raw binary image, the .bin of the build")
+    parser.add_argument("--port", required=True, help="serial port of the board")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--chunk", type=int, default=64, help="FIRMWARE_UPDATE_CHUNK of the sketch")
+    args = parser.parse_args()
+
+    import serial
+
+    with open(args.image, "rb") as f:
+        image = f.read()
+    # erasing a page may take a while on the board
+    with serial.Serial(args.port, args.baud, timeout=2) as port:
+        port.reset_input_buffer()
+        port.write(b"GDFU" + struct.pack("<II", len(image), zlib.crc32(image) & 0xFFFFFFFF))
+        expect(port, b"R", "header")
+        for start in range(0, len(image), args.chunk):
+            port.write(image[start:start + args.chunk])
+            last = start + args.chunk >= len(image)
+            expect(port, b"D" if last else b"K", "image" if last else "chunk at %d" % start)
+            sys.stderr.write("\r%d / %d bytes" % (min(start + args.chunk, len(image)), len(image)))
+        sys.stderr.write("\ndone, the board installs the image on its next reset\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,477 @@
+/*
+    Copyright (c) 2020, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+/*
+ * Host (x86) build of the parts of the core that are pure logic: the
+ * ring buffers, Print number formatting, String, Stream parsing and the
+ * RTC calendar conversion. Each is checked against known results, then
+ * timed, so a regression in either shows up in CI before anything is
+ * flashed. Built and run by ‘make host-bench’; the exit status is the
+ * number of failed checks.
+ *
+ * Figures are nanoseconds per call on the build machine, the best of
+ * HOST_BENCH_BATCHES batches like the Benchmark library does on the
+ * target. They are for comparing two builds on one machine, not for
+ * predicting cycles on a GD32; the Benchmark library sketches do that.
+ * EPBuffer is left out, it is tied to the USB peripheral.
+ */
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "api/RingBuffer.h"
+#include "api/Print.h"
+#include "api/Stream.h"
+#include "api/String.h"
+#include "gd32/calendar.h"
+
+/* batches measure() takes the best of */
+#ifndef HOST_BENCH_BATCHES
+#define HOST_BENCH_BATCHES  5
+#endif
+
+using namespace arduino;
+
+static const auto start = std::chrono::steady_clock::now();
+
+/* Stream's timeouts count in these */
+extern "C" unsigned long millis(void)
+{
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - start).count();
+}
+
+extern "C" unsigned long micros(void)
+{
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start).count();
+}
+
+static int failures = 0;
+/* keeps the optimizer from dropping what a benchmark computes */
+static volatile uint32_t sink;
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        printf("FAIL  %s\n", what);
+        failures++;
+    }
+}
+
+static void checkText(const char *got, const char *want, const char *what)
+{
+    if (strcmp(got, want) != 0) {
+        printf("FAIL  %s: \"%s\", expected \"%s\"\n", what, got, want);
+        failures++;
+    }
+}
+
+/* best nanoseconds per call of fn over HOST_BENCH_BATCHES batches of count calls */
+static double measure(void (*fn)(void), uint32_t count)
+{
+    double best = 1e30;
+
+    for (int batch = 0; batch < HOST_BENCH_BATCHES; batch++) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < count; i++) {
+            fn();
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / count;
+        if (ns < best) {
+            best = ns;
+        }
+    }
+    return best;
+}
+
+static void run(const char *name, void (*fn)(void), uint32_t count = 100000)
+{
+    printf("%-40s %10.1f ns\n", name, measure(fn, count));
+}
+
+/* a Print that keeps the last line it was given */
+class TextPrint : public Print
+{
+    public:
+        size_t write(uint8_t c)
+        {
+            if (length < sizeof(text) - 1) {
+                text[length++] = (char)c;
+                text[length] = '\0';
+            }
+            return 1;
+        }
+        size_t write(const uint8_t *buffer, size_t size)
+        {
+            for (size_t i = 0; i < size; i++) {
+                write(buffer[i]);
+            }
+            return size;
+        }
+        const char *take(void)
+        {
+            length = 0;
+            return text;
+        }
+
+    private:
+        char text[64] = "";
+        size_t length = 0;
+};
+
+/* a Stream reading from a string, rewound for every parse */
+class TextStream : public Stream
+{
+    public:
+        void load(const char *s)
+        {
+            text = s;
+            position = 0;
+        }
+        int available(void)
+        {
+            return (int)(strlen(text) - position);
+        }
+        int read(void)
+        {
+            return text[position] ? (unsigned char)text[position++] : -1;
+        }
+        int peek(void)
+        {
+            return text[position] ? (unsigned char)text[position] : -1;
+        }
+        size_t write(uint8_t)
+        {
+            return 0;
+        }
+
+    private:
+        const char *text = "";
+        size_t position = 0;
+};
+
+/* ring buffers */
+
+static RingBufferN<256> ring;
+static SPSCRingBufferN<256> spsc;
+
+static void benchRingStoreRead(void)
+{
+    ring.store_char((uint8_t)sink);
+    sink = ring.read_char();
+}
+
+static void benchSpscPushPop(void)
+{
+    spsc.push((uint8_t)sink);
+    sink = spsc.pop();
+}
+
+static void benchSpscBlock(void)
+{
+    static uint8_t block[64];
+
+    spsc.push(block, sizeof(block));
+    sink = spsc.pop(block, sizeof(block));
+}
+
+static void checkRings(void)
+{
+    bool ok = true;
+
+    ring.clear();
+    spsc.clear();
+    /* several times round, so both wrap */
+    for (int i = 0; i < 1000; i++) {
+        ring.store_char((uint8_t)i);
+        spsc.push((uint8_t)i);
+        ok = ok && (ring.read_char() == (uint8_t)i) && (spsc.pop() == (uint8_t)i);
+    }
+    check(ok, "ring buffers keep order across the wrap");
+    for (int i = 0; i < 300; i++) {
+        ring.store_char((uint8_t)i);
+    }
+    check(ring.isFull() && ring.available() == 256, "RingBufferN stops at N");
+    ring.clear();
+
+    uint8_t in[300], out[300];
+    for (int i = 0; i < 300; i++) {
+        in[i] = (uint8_t)(i * 7);
+    }
+    check(spsc.push(in, 300) == 256, "SPSCRingBufferN block push stops at N");
+    check(spsc.pop(out, 300) == 256 && memcmp(in, out, 256) == 0, "SPSCRingBufferN block pop");
+    check(spsc.pop() == -1 && spsc.available() == 0, "SPSCRingBufferN empty");
+}
+
+/* Print */
+
+static TextPrint printer;
+
+static void benchPrintUnsigned(void)
+{
+    printer.print(4000000000UL);
+    sink = (uint32_t)printer.take()[0];
+}
+
+static void benchPrintSigned(void)
+{
+    printer.print(-123456L);
+    sink = (uint32_t)printer.take()[0];
+}
+
+static void benchPrintHex(void)
+{
+    printer.print(0xDEADBEEFUL, HEX);
+    sink = (uint32_t)printer.take()[0];
+}
+
+static void benchPrintFloat(void)
+{
+    printer.print(3.14159, 2);
+    sink = (uint32_t)printer.take()[0];
+}
+
+static void checkPrint(void)
+{
+    printer.print(4294967295UL);
+    checkText(printer.take(), "4294967295", "print(unsigned long)");
+    printer.print(-2147483647L - 1);
+    checkText(printer.take(), "-2147483648", "print(long)");
+    printer.print(0UL);
+    checkText(printer.take(), "0", "print(0)");
+    printer.print(0xDEADBEEFUL, HEX);
+    checkText(printer.take(), "DEADBEEF", "print(HEX)");
+    printer.print(5UL, BIN);
+    checkText(printer.take(), "101", "print(BIN)");
+    printer.print(3.14159, 2);
+    checkText(printer.take(), "3.14", "print(double, 2)");
+    printer.print(-0.5, 2);
+    checkText(printer.take(), "-0.50", "print(negative double)");
+    printer.print(2.5, 0);
+    checkText(printer.take(), "3", "print(double, 0) rounds");
+    printer.print(NAN);
+    checkText(printer.take(), "nan", "print(NAN)");
+    printer.printf("%hhu", 300);
+    checkText(printer.take(), "44", "printf(%hhu) narrows");
+    printer.printf("%hhd", 200);
+    checkText(printer.take(), "-56", "printf(%hhd) narrows");
+    printer.printf("%hd", 70000);
+    checkText(printer.take(), "4464", "printf(%hd) narrows");
+    printer.printf("%hx", 0x12345);
+    checkText(printer.take(), "2345", "printf(%hx) narrows");
+}
+
+/* String */
+
+static void benchStringFromNumber(void)
+{
+    String s(123456789UL);
+    sink = s.length();
+}
+
+static void benchStringConcat(void)
+{
+    String s;
+    for (int i = 0; i < 16; i++) {
+        s += (char)('a' + i);
+    }
+    sink = s.length();
+}
+
+static void benchStringIndexOf(void)
+{
+    static const String s("GET /index.html HTTP/1.1");
+    sink = s.indexOf("HTTP");
+}
+
+static void benchStringToInt(void)
+{
+    static const String s("-1234567");
+    sink = (uint32_t)s.toInt();
+}
+
+static void benchStringReplace(void)
+{
+    String s("a,b,c,d,e,f,g,h");
+    s.replace(",", ";");
+    sink = s.length();
+}
+
+static void checkString(void)
+{
+    checkText(String(-123).c_str(), "-123", "String(int)");
+    checkText(String(255, HEX).c_str(), "ff", "String(int, HEX)");
+    checkText(String(1.5f, 3).c_str(), "1.500", "String(float, 3)");
+    String s("hello");
+    s += " world";
+    s += 42;
+    checkText(s.c_str(), "hello world42", "String concat");
+    check(s.indexOf("world") == 6 && s.lastIndexOf('o') == 7, "String indexOf");
+    check(String("-1234567").toInt() == -1234567, "String toInt");
+    check(fabs(String("2.75").toFloat() - 2.75f) < 1e-6, "String toFloat");
+    String r("a,b,c");
+    r.replace(",", ", ");
+    checkText(r.c_str(), "a, b, c", "String replace");
+    checkText(String("  trim me ").substring(2, 6).c_str(), "trim", "String substring");
+}
+
+/* Stream */
+
+static TextStream stream;
+
+static void benchParseInt(void)
+{
+    stream.load("value=-123456;");
+    sink = (uint32_t)stream.parseInt();
+}
+
+static void benchParseFloat(void)
+{
+    stream.load("  3.14159,");
+    sink = (uint32_t)stream.parseFloat();
+}
+
+static void benchReadBytesUntil(void)
+{
+    char line[32];
+
+    stream.load("AT+CMD=1,2,3\r\nOK");
+    sink = stream.readBytesUntil('\n', line, sizeof(line));
+}
+
+static void checkStream(void)
+{
+    stream.setTimeout(0);
+    stream.load("abc -1234x");
+    check(stream.parseInt() == -1234, "Stream parseInt");
+    stream.load("1,234,567");
+    check(stream.parseInt(SKIP_ALL, ',') == 1234567, "Stream parseInt with ignore");
+    stream.load("  3.25;");
+    check(stream.parseFloat() == 3.25f, "Stream parseFloat");
+    stream.load("x");
+    check(stream.parseInt() == 0, "Stream parseInt without digits");
+
+    char line[16] = "";
+    stream.load("first line\nsecond");
+    size_t n = stream.readBytesUntil('\n', line, sizeof(line) - 1);
+    line[n] = '\0';
+    checkText(line, "first line", "Stream readBytesUntil");
+    check(stream.find("sec") && stream.read() == 'o', "Stream find");
+}
+
+/* calendar */
+
+static void benchMkTimtoStamp(void)
+{
+    static UTCTimeStruct t = { 2024, 2, 29, 12, 34, 56 };
+    sink = mkTimtoStamp(&t);
+}
+
+static void benchDateFromDays(void)
+{
+    UTCTimeStruct t;
+
+    calendar_dateFromDays(19782U + (sink & 1023U), &t);
+    sink = t.day;
+}
+
+/* rtc_getUTCTime() with the day cache missed */
+static void benchUtcFromStamp(void)
+{
+    uint32_t timestamp = 1709210096UL + sink;
+    uint32_t day = timestamp % SECONDS_PER_DAY;
+    UTCTimeStruct t;
+
+    t.hour = day / 3600;
+    t.minutes = (day % 3600) / 60;
+    t.seconds = day % 60;
+    calendar_dateFromDays(timestamp / SECONDS_PER_DAY, &t);
+    sink = t.day + t.seconds;
+}
+
+static void checkCalendar(void)
+{
+    bool roundTrip = true, matchesLibc = true;
+
+    /* every day the 32 bit counter reaches */
+    for (uint32_t days = 0; days < 0xFFFFFFFFUL / SECONDS_PER_DAY; days++) {
+        UTCTimeStruct t;
+        calendar_dateFromDays(days, &t);
+        t.hour = 23;
+        t.minutes = 59;
+        t.seconds = 59;
+        roundTrip = roundTrip && (mkTimtoStamp(&t) == days * SECONDS_PER_DAY + SECONDS_PER_DAY - 1);
+
+        time_t stamp = (time_t)days * SECONDS_PER_DAY;
+        struct tm tm;
+        gmtime_r(&stamp, &tm);
+        matchesLibc = matchesLibc && (t.year == tm.tm_year + 1900) && (t.month == tm.tm_mon + 1)
+                      && (t.day == tm.tm_mday)
+                      && (monthLength(IsLeapYear(t.year), t.month) >= t.day);
+    }
+    check(roundTrip, "mkTimtoStamp inverts calendar_dateFromDays");
+    check(matchesLibc, "calendar_dateFromDays matches gmtime");
+
+    UTCTimeStruct leap = { 2024, 2, 29, 12, 34, 56 };
+    check(mkTimtoStamp(&leap) == 1709210096UL, "mkTimtoStamp 2024-02-29 12:34:56");
+    check(monthLength(IsLeapYear(1900), 2) == 28 && monthLength(IsLeapYear(2000), 2) == 29, "monthLength");
+}
+
+int main(void)
+{
+    checkRings();
+    checkPrint();
+    checkString();
+    checkStream();
+    checkCalendar();
+
+    run("RingBufferN store_char + read_char", benchRingStoreRead);
+    run("SPSCRingBufferN push + pop", benchSpscPushPop);
+    run("SPSCRingBufferN 64 byte push + pop", benchSpscBlock);
+    run("Print unsigned long", benchPrintUnsigned);
+    run("Print long", benchPrintSigned);
+    run("Print HEX", benchPrintHex);
+    run("Print double, 2 digits", benchPrintFloat);
+    run("String(unsigned long)", benchStringFromNumber);
+    run("String += char x16", benchStringConcat);
+    run("String indexOf", benchStringIndexOf);
+    run("String toInt", benchStringToInt);
+    run("String replace", benchStringReplace);
+    run("Stream parseInt", benchParseInt);
+    run("Stream parseFloat", benchParseFloat);
+    run("Stream readBytesUntil", benchReadBytesUntil);
+    run("mkTimtoStamp", benchMkTimtoStamp);
+    run("calendar_dateFromDays", benchDateFromDays);
+    run("timestamp to UTCTimeStruct", benchUtcFromStamp);
+
+    printf("%d check(s) failed\n", failures);
+    return failures;
+}
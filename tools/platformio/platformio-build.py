@@ -25,12 +25,14 @@ kinds of creative coding, interactive objects, spaces or physical experiences.
 https://github.com/CommunityGD32Cores/GD32Core-New
 """
 
+import hashlib
 import json
+import os
 from os.path import isfile, isdir, join
 
 from platformio.util import get_systype
 
-from SCons.Script import COMMAND_LINE_TARGETS, DefaultEnvironment
+from SCons.Script import COMMAND_LINE_TARGETS, Copy, DefaultEnvironment, Mkdir
 
 env = DefaultEnvironment()
 platform = env.PioPlatform()
@@ -373,8 +375,40 @@ if "build.variant" in board_config:
     )
     env.BuildSources(join("$BUILD_DIR", "FrameworkArduinoVariant"), variant_dir)
 
-libs.append(env.BuildLibrary(
-    join("$BUILD_DIR", "FrameworkArduino"), join(FRAMEWORK_DIR, "cores", "arduino")
-))
+
+def get_core_cache_name():
+    # everything the core objects depend on: compiler flags, defines,
+    # include paths and the framework itself
+    key = "\n".join([
+        env.subst("$CCFLAGS $CFLAGS $CXXFLAGS $ASFLAGS"),
+        " ".join(str(d) for d in env.Flatten(env.get("CPPDEFINES", []))),
+        " ".join(env.subst(str(p)) for p in env.get("CPPPATH", [])),
+        str(platform.get_package_version("framework-arduinogd32")),
+    ])
+    opt = next((f for f in env.Flatten(env.get("CCFLAGS", [])) if str(f).startswith("-O")), "-O")
+    return "libcore_%s_%s_%s.a" % (
+        variant, str(opt)[1:], hashlib.sha1(key.encode()).hexdigest()[:10])
+
+
+# Precompiled core: with board_build.core_cache_dir (or GD32_CORE_CACHE_DIR)
+# set, the core archive is kept there under a name keyed by the variant and
+# the build flags, and every project built with the same flags links it
+# instead of compiling the core again.
+core_cache_dir = board_config.get(
+    "build.core_cache_dir", os.environ.get("GD32_CORE_CACHE_DIR", ""))
+cached_core = join(env.subst(core_cache_dir), get_core_cache_name()) if core_cache_dir else ""
+
+if cached_core and isfile(cached_core):
+    libs.append(env.File(cached_core))
+else:
+    core_lib = env.BuildLibrary(
+        join("$BUILD_DIR", "FrameworkArduino"), join(FRAMEWORK_DIR, "cores", "arduino")
+    )
+    if cached_core:
+        env.AddPostAction(core_lib, [
+            Mkdir(env.subst(core_cache_dir)),
+            Copy(cached_core, "$TARGET"),
+        ])
+    libs.append(core_lib)
 
 env.Prepend(LIBS=libs)
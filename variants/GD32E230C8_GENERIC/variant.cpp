@@ -33,45 +33,7 @@ extern "C" {
 
 /* digital pins for pinmap list */
 const PinName digital_pins[] = {
-    PORTC_13,
-    PORTC_14,
-    PORTC_15,
-    PORTF_0,
-    PORTF_1,
-    PORTB_2,
-    PORTB_10,
-    PORTB_11,
-    PORTB_12,
-    PORTB_13,
-    PORTB_14,
-    PORTB_15,
-    PORTA_8,
-    PORTA_9,
-    PORTA_10,
-    PORTA_11,
-    PORTA_12,
-    PORTA_13,
-    PORTF_6,
-    PORTF_7,
-    PORTA_14,
-    PORTA_15,
-    PORTB_3,
-    PORTB_4,
-    PORTB_5,
-    PORTB_6,
-    PORTB_7,
-    PORTB_8,
-    PORTB_9,
-    PORTA_0,
-    PORTA_1,
-    PORTA_2,
-    PORTA_3,
-    PORTA_4,
-    PORTA_5,
-    PORTA_6,
-    PORTA_7,
-    PORTB_0,
-    PORTB_1
+    DIGITAL_PINS_LIST
 };
 
 /* analog pins for pinmap list */
@@ -50,6 +50,24 @@ extern "C" {
 #define PA7 13
 #define PB1 14
 
+/* PinName of each digital pin, the digital_pins[] table of variant.cpp */
+#define DIGITAL_PINS_LIST \
+    PORTF_0,  \
+    PORTF_1,  \
+    PORTA_9,  \
+    PORTA_10, \
+    PORTA_13, \
+    PORTA_14, \
+    PORTA_0,  \
+    PORTA_1,  \
+    PORTA_2,  \
+    PORTA_3,  \
+    PORTA_4,  \
+    PORTA_5,  \
+    PORTA_6,  \
+    PORTA_7,  \
+    PORTB_1
+
 /* digital pins and analog pins number definitions */
 #define DIGITAL_PINS_NUM            15
 #define ANALOG_PINS_NUM             9
@@ -58,6 +58,32 @@ extern "C" {
 #define PB0 21
 #define PB1 22
 
+/* PinName of each digital pin, the digital_pins[] table of variant.cpp */
+#define DIGITAL_PINS_LIST \
+    PORTF_0,  \
+    PORTF_1,  \
+    PORTA_8,  \
+    PORTA_9,  \
+    PORTA_10, \
+    PORTA_13, \
+    PORTA_14, \
+    PORTA_15, \
+    PORTB_3,  \
+    PORTB_4,  \
+    PORTB_5,  \
+    PORTB_6,  \
+    PORTB_7,  \
+    PORTA_0,  \
+    PORTA_1,  \
+    PORTA_2,  \
+    PORTA_3,  \
+    PORTA_4,  \
+    PORTA_5,  \
+    PORTA_6,  \
+    PORTA_7,  \
+    PORTB_0,  \
+    PORTB_1
+
 /* digital pins and analog pins number definitions */
 #define DIGITAL_PINS_NUM            23
 #define ANALOG_PINS_NUM             10
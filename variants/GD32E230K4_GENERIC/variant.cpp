@@ -33,31 +33,7 @@ extern "C" {
 
 /* digital pins for pinmap list */
 const PinName digital_pins[] = {
-    PORTF_0,
-    PORTF_1,
-    PORTA_8,
-    PORTA_9,
-    PORTA_10,
-    PORTA_11,
-    PORTA_12,
-    PORTA_13,
-    PORTA_14,
-    PORTA_15,
-    PORTB_3,
-    PORTB_4,
-    PORTB_5,
-    PORTB_6,
-    PORTB_7,
-    PORTA_0,
-    PORTA_1,
-    PORTA_2,
-    PORTA_3,
-    PORTA_4,
-    PORTA_5,
-    PORTA_6,
-    PORTA_7,
-    PORTB_0,
-    PORTB_1
+    DIGITAL_PINS_LIST
 };
 
 /* analog pins for pinmap list */
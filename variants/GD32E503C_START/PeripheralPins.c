@@ -129,6 +129,15 @@ const PinMap PinMap_SPI_SSEL[] = {
     {NC,    NC,    0}
 };
 
+/* quad-SPI data lines 2 and 3 */
+const PinMap PinMap_SPI_IO2[] = {
+    {NC,    NC,    0}
+};
+
+const PinMap PinMap_SPI_IO3[] = {
+    {NC,    NC,    0}
+};
+
 /* CAN PinMap */
 const PinMap PinMap_CAN_RD[] = {
     {NC,    NC,    0}
@@ -0,0 +1,4 @@
+#ifndef _PINNAMESVAR_H_
+#define _PINNAMESVAR_H_
+
+#endif /* _PINNAMESVAR_H_ */
\ No newline at end of file
@@ -74,6 +74,48 @@ extern "C" {
 #define PA6 37
 #define PB0 38
 
+/* PinName of each digital pin, the digital_pins[] table of variant.cpp */
+#define DIGITAL_PINS_LIST \
+    PORTC_13, \
+    PORTC_14, \
+    PORTC_15, \
+    PORTF_0,  \
+    PORTF_1,  \
+    PORTB_2,  \
+    PORTB_10, \
+    PORTB_11, \
+    PORTB_12, \
+    PORTB_13, \
+    PORTB_14, \
+    PORTB_15, \
+    PORTA_8,  \
+    PORTA_9,  \
+    PORTA_10, \
+    PORTA_11, \
+    PORTA_12, \
+    PORTA_13, \
+    PORTF_6,  \
+    PORTF_7,  \
+    PORTA_14, \
+    PORTA_15, \
+    PORTB_3,  \
+    PORTB_4,  \
+    PORTB_5,  \
+    PORTB_6,  \
+    PORTB_7,  \
+    PORTB_8,  \
+    PORTB_9,  \
+    PORTA_4,  \
+    PORTA_1,  \
+    PORTA_5,  \
+    PORTA_0,  \
+    PORTB_1,  \
+    PORTA_3,  \
+    PORTA_7,  \
+    PORTA_2,  \
+    PORTA_6,  \
+    PORTB_0
+
 /* digital pins and analog pins number definitions */
 #define DIGITAL_PINS_NUM            39
 #define ANALOG_PINS_NUM             10
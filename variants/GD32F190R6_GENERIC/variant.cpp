@@ -33,61 +33,7 @@ extern "C" {
 
 /* digital pins for pinmap list */
 const PinName digital_pins[] = {
-    PORTC_13,
-    PORTC_14,
-    PORTC_15,
-    PORTF_0,
-    PORTF_1,
-    PORTF_4,
-    PORTF_5,
-    PORTB_2,
-    PORTB_10,
-    PORTB_11,
-    PORTB_12,
-    PORTB_13,
-    PORTB_14,
-    PORTB_15,
-    PORTC_6,
-    PORTC_7,
-    PORTC_8,
-    PORTC_9,
-    PORTA_8,
-    PORTA_9,
-    PORTA_10,
-    PORTA_11,
-    PORTA_12,
-    PORTA_13,
-    PORTF_6,
-    PORTF_7,
-    PORTA_14,
-    PORTA_15,
-    PORTC_10,
-    PORTC_11,
-    PORTC_12,
-    PORTD_2,
-    PORTB_3,
-    PORTB_4,
-    PORTB_5,
-    PORTB_6,
-    PORTB_7,
-    PORTB_8,
-    PORTB_9,
-    PORTA_0,
-    PORTA_1,
-    PORTA_2,
-    PORTA_3,
-    PORTA_4,
-    PORTA_5,
-    PORTA_6,
-    PORTA_7,
-    PORTB_0,
-    PORTB_1,
-    PORTC_0,
-    PORTC_1,
-    PORTC_2,
-    PORTC_3,
-    PORTC_4,
-    PORTC_5
+    DIGITAL_PINS_LIST
 };
 
 /* analog pins for pinmap list */
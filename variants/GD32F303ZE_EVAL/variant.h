@@ -62,6 +62,38 @@ extern "C" {
 #define PA4  27
 #define PA5  28
 
+/* PinName of each digital pin, the digital_pins[] table of variant.cpp */
+#define DIGITAL_PINS_LIST \
+    PORTA_3,    /* USART1_RX(TX)  Ardunio D0 */                      \
+    PORTA_2,    /* USART1_TX(RX)  Ardunio D1 */                      \
+    PORTE_4,                                        /* Ardunio D2 */ \
+    PORTD_12,   /* TIMER3_CH0(PWM)  Ardunio D3 */                    \
+    PORTB_3,                                        /* Ardunio D4 */ \
+    PORTC_7,    /* TIMER7_CH1(PWM)  Ardunio D5 */                    \
+    PORTB_0,    /* TIMER7_CH1_ON(PWM)  Ardunio D6 */                 \
+    PORTB_4,                                        /* Ardunio D7 */ \
+    PORTD_11,                                       /* Ardunio D8 */ \
+    PORTE_5,    /* TIMER8_CH0(PWM)  Ardunio D9 */                    \
+    PORTA_8,    /* TIMER0_CH0(PWM)/SPI0_NSS(SS)  Ardunio D10 */      \
+    PORTB_15,   /* TIMER11_CH1(PWM)/SPI1_MOSI(MOSI)  Ardunio D11 */  \
+    PORTB_14,   /* SPI1_MISO(MISO)  Ardunio D12 */                   \
+    PORTB_13,   /* SPI1_SCK(SCK)/LED_GREEN  Ardunio D13 */           \
+    PORTB_9,    /* I2C0_SDA(SDA)  Ardunio D14 */                     \
+    PORTB_8,    /* I2C0_SCL(SCL)  Ardunio D15 */                     \
+    PORTE_0,    /* LED_D1 */                                         \
+    PORTE_1,    /* LED_D2 */                                         \
+    PORTE_6,    /* LED_D3 */                                         \
+    PORTC_0,    /* ADC012_IN10  Ardunio A0 */                        \
+    PORTC_1,    /* ADC012_IN11  Ardunio A1 */                        \
+    PORTC_2,    /* ADC012_IN12  Ardunio A2 */                        \
+    PORTC_3,    /* ADC012_IN13  Ardunio A3 */                        \
+    PORTA_0,    /* ADC01_IN0  Ardunio A4 */                          \
+    PORTB_1,    /* ADC01_IN9  Ardunio A5 */                          \
+    PORTE_2,    /* KEY0 */                                           \
+    PORTE_7,    /* KEY1 */                                           \
+    PORTA_4,    /* DAC0 */                                           \
+    PORTA_5     /* DAC1 */
+
 /* digital pins and analog pins number definitions */
 #define DIGITAL_PINS_NUM        29
 #define ANALOG_PINS_NUM         8
@@ -121,6 +153,11 @@ extern "C" {
 #define ADC_RESOLUTION          10
 #define DAC_RESOLUTION          12
 
+/* the SRAM on NE0 behind the EXTRAM region of ldscript.ld, 512K x 16:
+   region, device, width, address lines, address setup, data setup,
+   write data setup and bus turnaround in ns, see exmc_config_t */
+#define EXTRAM_CONFIG           { 0U, EXMC_DEVICE_SRAM, 16U, 19U, 10U, 20U, 0U, 10U }
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -331,6 +331,19 @@ const PinMap PinMap_SPI_SSEL[] = {
     {NC,    NC,    0}
 };
 
+/* quad-SPI data lines 2 and 3 */
+const PinMap PinMap_SPI_IO2[] = {
+    {PORTA_2,  SPI0, 7},
+    {PORTB_6,  SPI0, 7 | (1 << 3)},    /* GPIO_SPI0_REMAP */
+    {NC,    NC,    0}
+};
+
+const PinMap PinMap_SPI_IO3[] = {
+    {PORTA_3,  SPI0, 7},
+    {PORTB_7,  SPI0, 7 | (1 << 3)},    /* GPIO_SPI0_REMAP */
+    {NC,    NC,    0}
+};
+
 /* CAN PinMap */
 const PinMap PinMap_CAN_RD[] = {
     {PORTA_11, CAN0, 3},
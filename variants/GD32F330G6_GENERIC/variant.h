@@ -58,6 +58,32 @@ extern "C" {
 #define PB0 21
 #define PA2 22
 
+/* PinName of each digital pin, the digital_pins[] table of variant.cpp */
+#define DIGITAL_PINS_LIST \
+    PORTF_0,  \
+    PORTF_1,  \
+    PORTA_7,  \
+    PORTA_8,  \
+    PORTA_9,  \
+    PORTA_10, \
+    PORTA_13, \
+    PORTA_14, \
+    PORTA_15, \
+    PORTB_3,  \
+    PORTB_4,  \
+    PORTB_5,  \
+    PORTB_6,  \
+    PORTB_7,  \
+    PORTA_0,  \
+    PORTA_3,  \
+    PORTA_6,  \
+    PORTA_1,  \
+    PORTA_5,  \
+    PORTB_1,  \
+    PORTA_4,  \
+    PORTB_0,  \
+    PORTA_2
+
 /* digital pins and analog pins number definitions */
 #define DIGITAL_PINS_NUM            23
 #define ANALOG_PINS_NUM             9